@@ -1154,7 +1154,7 @@ public:
   TBool(): Val(false){}
   TBool(const bool& _Val): Val(_Val){}
   operator bool() const {return Val;}
-  explicit TBool(TSIn& SIn){SIn.Load(Val);}
+  explicit TBool(TSIn& SIn): Val(false){SIn.Load(Val);}
   void Load(TSIn& SIn){SIn.Load(Val);}
   void Save(TSOut& SOut) const {SOut.Save(Val);}
   void LoadXml(const PXmlTok& XmlTok, const TStr& Nm);
@@ -1363,7 +1363,7 @@ public:
   TNum(): Val(0){}
   TNum(const int& _Val): Val(_Val){}
   operator int() const {return Val;}
-  explicit TNum(TSIn& SIn){ SIn.Load(Val); }
+  explicit TNum(TSIn& SIn): Val(0){ SIn.Load(Val); }
   void Load(TSIn& SIn){SIn.Load(Val);}
   void Save(TSOut& SOut) const {SOut.Save(Val);}
   void LoadXml(const PXmlTok& XmlTok, const TStr& Nm);
@@ -635,6 +635,70 @@ bool TMIn::GetNextLnBf(TChA& LnChA){
   return false;
 }
 
+/////////////////////////////////////////////////
+// Input-Memory-Mapped-File
+TMMapIn::TMMapIn(const TStr& FNm):
+  TSBase(FNm.CStr()), TSIn(FNm), Bf(NULL), BfC(0), BfL(0), MapP(false){
+  EAssertR(!FNm.Empty(), "Empty file-name.");
+#ifdef GLib_LINUX
+  const int FileId=open(FNm.CStr(), O_RDONLY);
+  EAssertR(FileId!=-1, "Can not open file '"+FNm+"'.");
+  struct stat FileStat;
+  if (fstat(FileId, &FileStat)==-1){
+    close(FileId); FailR(("Can not get size of file '"+FNm+"'.").CStr());}
+  BfL=int(FileStat.st_size);
+  if (BfL>0){
+    void* MapBf=mmap(0, BfL, PROT_READ, MAP_PRIVATE, FileId, 0);
+    close(FileId);
+    EAssertR(MapBf!=MAP_FAILED, "Can not map file '"+FNm+"'.");
+    // files are typically read from start to end
+    madvise(MapBf, BfL, MADV_SEQUENTIAL);
+    Bf=(char*)MapBf; MapP=true;
+  } else {
+    close(FileId);
+  }
+#else
+  TFIn FIn(FNm); BfL=FIn.Len();
+  Bf=new char[BfL>0?BfL:1]; FIn.GetBf(Bf, BfL);
+#endif
+}
+
+PSIn TMMapIn::New(const TStr& FNm){
+  return PSIn(new TMMapIn(FNm));
+}
+
+TMMapIn::~TMMapIn(){
+#ifdef GLib_LINUX
+  if (MapP){munmap(Bf, BfL);}
+#else
+  if (Bf!=NULL){delete[] Bf;}
+#endif
+}
+
+char TMMapIn::GetCh(){
+  EAssertR(BfC<BfL, "Reading beyond the end of stream.");
+  return Bf[BfC++];
+}
+
+char TMMapIn::PeekCh(){
+  EAssertR(BfC<BfL, "Reading beyond the end of stream.");
+  return Bf[BfC];
+}
+
+int TMMapIn::GetBf(const void* LBf, const TSize& LBfL){
+  EAssertR(TSize(BfC+LBfL)<=TSize(BfL), "Reading beyond the end of stream.");
+  int LBfS=0;
+  for (TSize LBfC=0; LBfC<LBfL; LBfC++){
+    LBfS+=(((char*)LBf)[LBfC]=Bf[BfC++]);}
+  return LBfS;
+}
+
+bool TMMapIn::GetNextLnBf(TChA& LnChA){
+  // not implemented
+  FailR(TStr::Fmt("TMMapIn::GetNextLnBf: not implemented").CStr());
+  return false;
+}
+
 /////////////////////////////////////////////////
 // Output-Memory
 void TMOut::Resize(const int& ReqLen){
@@ -424,6 +424,35 @@ public:
   char* GetBfAddr(){return Bf;}
 };
 
+/////////////////////////////////////////////////
+// Input-Memory-Mapped-File
+// file is mapped into memory on Linux, so pages are loaded only when read;
+// on other platforms the whole file is read into memory
+class TMMapIn: public TSIn{
+private:
+  char* Bf;
+  int BfC, BfL;
+  bool MapP;
+private:
+  TMMapIn();
+  TMMapIn(const TMMapIn&);
+  TMMapIn& operator=(const TMMapIn&);
+public:
+  TMMapIn(const TStr& FNm);
+  static PSIn New(const TStr& FNm);
+  ~TMMapIn();
+
+  bool Eof(){return BfC==BfL;}
+  int Len() const {return BfL-BfC;}
+  char GetCh();
+  char PeekCh();
+  int GetBf(const void* LBf, const TSize& LBfL);
+  void Reset(){Cs=TCs(); BfC=0;}
+  bool GetNextLnBf(TChA& LnChA);
+
+  char* GetBfAddr(){return Bf;}
+};
+
 /////////////////////////////////////////////////
 // Output-Memory
 class TMOut: public TSOut{
@@ -25,6 +25,9 @@ public:
     /// Register new object
     void Register(const TStr& TypeNm, TFun Fun) { TypeNmToFunH.AddDat(TypeNm, Fun); }
     
+    /// Check if the given type is registered
+    bool IsType(const TStr& TypeNm) const { return TypeNmToFunH.IsKey(TypeNm); }
+
     /// Get the function for given type
     TFun Fun(const TStr& TypeNm) {
         if (TypeNmToFunH.IsKey(TypeNm)) { return TypeNmToFunH.GetDat(TypeNm); }
@@ -166,6 +166,197 @@ void TSparseRowMatrix::Init() {
     }
 }
 
+///////////////////////////////////////////////////////////////////////
+// Compressed-Sparse-Matrix
+TCompressedSparseMatrix::TCompressedSparseMatrix(const TVec<TIntFltKdV>& ColSpVV, const int& _RowN):
+        TMatrix(), RowN(_RowN), ColN(ColSpVV.Len()) {
+
+    int64 Nnz = 0; int MxRowId = -1;
+    for (int ColId = 0; ColId < ColN; ColId++) {
+        const TIntFltKdV& ColV = ColSpVV[ColId];
+        for (int ElN = 0; ElN < ColV.Len(); ElN++) {
+            EAssertR(ColV[ElN].Key >= 0, "TCompressedSparseMatrix: negative row index");
+            MxRowId = TMath::Mx(MxRowId, ColV[ElN].Key.Val);
+        }
+        Nnz += ColV.Len();
+    }
+    EAssertR(Nnz < (int64)TInt::Mx, "TCompressedSparseMatrix: too many nonzero elements");
+    if (RowN == -1) {
+        RowN = MxRowId + 1;
+    } else {
+        EAssertR(MxRowId < RowN, "TCompressedSparseMatrix: row index out of range");
+    }
+
+    ColPtrV.Gen(ColN + 1, ColN + 1);
+    ColRowIdV.Gen((int)Nnz, 0);
+    ColValV.Gen((int)Nnz, 0);
+    ColPtrV[0] = 0;
+    for (int ColId = 0; ColId < ColN; ColId++) {
+        const TIntFltKdV& ColV = ColSpVV[ColId];
+        for (int ElN = 0; ElN < ColV.Len(); ElN++) {
+            ColRowIdV.Add(ColV[ElN].Key);
+            ColValV.Add(ColV[ElN].Dat);
+        }
+        ColPtrV[ColId + 1] = ColRowIdV.Len();
+    }
+    InitRows();
+}
+
+void TCompressedSparseMatrix::InitRows() {
+    // counting sort of the nonzeros by rows; going over columns in order
+    // keeps the column indices of each row sorted
+    const int Nnz = ColValV.Len();
+    RowPtrV.Gen(RowN + 1); RowPtrV.PutAll(0);
+    for (int ElN = 0; ElN < Nnz; ElN++) { RowPtrV[ColRowIdV[ElN] + 1]++; }
+    for (int RowId = 0; RowId < RowN; RowId++) { RowPtrV[RowId + 1] += RowPtrV[RowId]; }
+    RowColIdV.Gen(Nnz); RowValV.Gen(Nnz);
+    TIntV NextV(RowN); for (int RowId = 0; RowId < RowN; RowId++) { NextV[RowId] = RowPtrV[RowId]; }
+    for (int ColId = 0; ColId < ColN; ColId++) {
+        for (int ElN = ColPtrV[ColId]; ElN < ColPtrV[ColId + 1]; ElN++) {
+            const int Pos = NextV[ColRowIdV[ElN]]++;
+            RowColIdV[Pos] = ColId;
+            RowValV[Pos] = ColValV[ElN];
+        }
+    }
+}
+
+void TCompressedSparseMatrix::PMultiply(const TFltVV& B, int ColId, TFltV& Result) const {
+    EAssert(B.GetRows() >= ColN && Result.Len() >= RowN);
+    const int Rows = RowN;
+    #pragma omp parallel for if(GetNnz() >= ParMnFlops) schedule(static)
+    for (int RowId = 0; RowId < Rows; RowId++) {
+        double Sum = 0.0;
+        for (int ElN = RowPtrV[RowId]; ElN < RowPtrV[RowId + 1]; ElN++) {
+            Sum += RowValV[ElN] * B(RowColIdV[ElN], ColId);
+        }
+        Result[RowId] = Sum;
+    }
+}
+
+void TCompressedSparseMatrix::PMultiply(const TFltV& Vec, TFltV& Result) const {
+    EAssert(Vec.Len() >= ColN && Result.Len() >= RowN);
+    const int Rows = RowN;
+    #pragma omp parallel for if(GetNnz() >= ParMnFlops) schedule(static)
+    for (int RowId = 0; RowId < Rows; RowId++) {
+        double Sum = 0.0;
+        for (int ElN = RowPtrV[RowId]; ElN < RowPtrV[RowId + 1]; ElN++) {
+            Sum += RowValV[ElN] * Vec[RowColIdV[ElN]];
+        }
+        Result[RowId] = Sum;
+    }
+}
+
+void TCompressedSparseMatrix::PMultiplyT(const TFltVV& B, int ColId, TFltV& Result) const {
+    EAssert(B.GetRows() >= RowN && Result.Len() >= ColN);
+    const int Cols = ColN;
+    #pragma omp parallel for if(GetNnz() >= ParMnFlops) schedule(static)
+    for (int ColIdx = 0; ColIdx < Cols; ColIdx++) {
+        double Sum = 0.0;
+        for (int ElN = ColPtrV[ColIdx]; ElN < ColPtrV[ColIdx + 1]; ElN++) {
+            Sum += ColValV[ElN] * B(ColRowIdV[ElN], ColId);
+        }
+        Result[ColIdx] = Sum;
+    }
+}
+
+void TCompressedSparseMatrix::PMultiplyT(const TFltV& Vec, TFltV& Result) const {
+    EAssert(Vec.Len() >= RowN && Result.Len() >= ColN);
+    const int Cols = ColN;
+    #pragma omp parallel for if(GetNnz() >= ParMnFlops) schedule(static)
+    for (int ColIdx = 0; ColIdx < Cols; ColIdx++) {
+        double Sum = 0.0;
+        for (int ElN = ColPtrV[ColIdx]; ElN < ColPtrV[ColIdx + 1]; ElN++) {
+            Sum += ColValV[ElN] * Vec[ColRowIdV[ElN]];
+        }
+        Result[ColIdx] = Sum;
+    }
+}
+
+void TCompressedSparseMatrix::PMultiply(const TFltVV& B, TFltVV& Result) const {
+    // Result(i,:) = sum_k A(i,k) * B(k,:), rows of A are read from CSR
+    EAssert(B.GetRows() == ColN);
+    const int Rows = RowN, ColsB = B.GetCols();
+    if (Result.Empty()) {
+        Result.Gen(Rows, ColsB);
+    } else {
+        EAssert(Result.GetRows() == Rows && Result.GetCols() == ColsB);
+    }
+    if (ColsB == 0) { return; }
+    const bool ParP = (int64)GetNnz() * ColsB >= ParMnFlops;
+    #pragma omp parallel for if(ParP) schedule(dynamic, 64)
+    for (int RowId = 0; RowId < Rows; RowId++) {
+        TFlt* ResRow = &Result(RowId, 0);
+        for (int ColId = 0; ColId < ColsB; ColId++) { ResRow[ColId] = 0.0; }
+        for (int ElN = RowPtrV[RowId]; ElN < RowPtrV[RowId + 1]; ElN++) {
+            const double Val = RowValV[ElN];
+            const TFlt* BRow = &B(RowColIdV[ElN], 0);
+            for (int ColId = 0; ColId < ColsB; ColId++) {
+                ResRow[ColId].Val += Val * BRow[ColId].Val;
+            }
+        }
+    }
+}
+
+void TCompressedSparseMatrix::PMultiplyT(const TFltVV& B, TFltVV& Result) const {
+    // Result(j,:) = sum_k A(k,j) * B(k,:), columns of A are read from CSC
+    EAssert(B.GetRows() == RowN);
+    const int Cols = ColN, ColsB = B.GetCols();
+    if (Result.Empty()) {
+        Result.Gen(Cols, ColsB);
+    } else {
+        EAssert(Result.GetRows() == Cols && Result.GetCols() == ColsB);
+    }
+    if (ColsB == 0) { return; }
+    const bool ParP = (int64)GetNnz() * ColsB >= ParMnFlops;
+    #pragma omp parallel for if(ParP) schedule(dynamic, 64)
+    for (int ColIdx = 0; ColIdx < Cols; ColIdx++) {
+        TFlt* ResRow = &Result(ColIdx, 0);
+        for (int ColId = 0; ColId < ColsB; ColId++) { ResRow[ColId] = 0.0; }
+        for (int ElN = ColPtrV[ColIdx]; ElN < ColPtrV[ColIdx + 1]; ElN++) {
+            const double Val = ColValV[ElN];
+            const TFlt* BRow = &B(ColRowIdV[ElN], 0);
+            for (int ColId = 0; ColId < ColsB; ColId++) {
+                ResRow[ColId].Val += Val * BRow[ColId].Val;
+            }
+        }
+    }
+}
+
+void TCompressedSparseMatrix::GetColSpVV(TVec<TIntFltKdV>& ColSpVV) const {
+    ColSpVV.Gen(ColN);
+    for (int ColId = 0; ColId < ColN; ColId++) {
+        TIntFltKdV& ColV = ColSpVV[ColId];
+        ColV.Gen(ColPtrV[ColId + 1] - ColPtrV[ColId], 0);
+        for (int ElN = ColPtrV[ColId]; ElN < ColPtrV[ColId + 1]; ElN++) {
+            ColV.Add(TIntFltKd(ColRowIdV[ElN], ColValV[ElN]));
+        }
+    }
+}
+
+void TCompressedSparseMatrix::GetRowSpVV(TVec<TIntFltKdV>& RowSpVV) const {
+    RowSpVV.Gen(RowN);
+    for (int RowId = 0; RowId < RowN; RowId++) {
+        TIntFltKdV& RowV = RowSpVV[RowId];
+        RowV.Gen(RowPtrV[RowId + 1] - RowPtrV[RowId], 0);
+        for (int ElN = RowPtrV[RowId]; ElN < RowPtrV[RowId + 1]; ElN++) {
+            RowV.Add(TIntFltKd(RowColIdV[ElN], RowValV[ElN]));
+        }
+    }
+}
+
+void TCompressedSparseMatrix::Save(TSOut& SOut) const {
+    TMatrix::Save(SOut);
+    RowN.Save(SOut); ColN.Save(SOut);
+    ColPtrV.Save(SOut); ColRowIdV.Save(SOut); ColValV.Save(SOut);
+}
+
+void TCompressedSparseMatrix::Load(TSIn& SIn) {
+    TMatrix::Load(SIn);
+    RowN.Load(SIn); ColN.Load(SIn);
+    ColPtrV.Load(SIn); ColRowIdV.Load(SIn); ColValV.Load(SIn);
+    InitRows();
+}
+
 ///////////////////////////////////////////////////////////////////////
 // Full-Col-Matrix
 TFullColMatrix::TFullColMatrix(const TStr& MatlabMatrixFNm): TMatrix() {
@@ -758,6 +949,278 @@ bool TLinAlgCheck::IsOrthonormal(const TFltVV& Vecs, const double& Threshold) {
 	return TLinAlg::Frob(R) < Threshold;
 }
 
+///////////////////////////////////////////////////////////////////////
+// Dense matrix kernels
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	// SIMD through GCC/Clang vector extensions, AVX2 code path chosen at runtime
+	#define GLib_LINALG_VEC
+	#define GLib_LINALG_AVX2
+#elif defined(__GNUC__)
+	#define GLib_LINALG_VEC
+#endif
+
+#ifdef GLib_LINALG_VEC
+// four doubles, only 8-byte aligned so it can be loaded from anywhere
+typedef double TLinAlgV4 __attribute__((vector_size(32), aligned(8)));
+
+// shared body of the micro-kernels, compiled for the target of the caller
+static inline __attribute__((always_inline)) void TLinAlgMicroKernelBody(const int Depth,
+		const double* PackA, const double* PackB, double* AB) {
+
+	TLinAlgV4 C00 = { 0, 0, 0, 0 }, C01 = { 0, 0, 0, 0 };
+	TLinAlgV4 C10 = { 0, 0, 0, 0 }, C11 = { 0, 0, 0, 0 };
+	TLinAlgV4 C20 = { 0, 0, 0, 0 }, C21 = { 0, 0, 0, 0 };
+	TLinAlgV4 C30 = { 0, 0, 0, 0 }, C31 = { 0, 0, 0, 0 };
+	for (int DepthN = 0; DepthN < Depth; DepthN++) {
+		TLinAlgV4 PackB0, PackB1;
+		memcpy(&PackB0, PackB, sizeof(TLinAlgV4));
+		memcpy(&PackB1, PackB + 4, sizeof(TLinAlgV4));
+		const TLinAlgV4 A0 = { PackA[0], PackA[0], PackA[0], PackA[0] };
+		C00 += A0 * PackB0; C01 += A0 * PackB1;
+		const TLinAlgV4 A1 = { PackA[1], PackA[1], PackA[1], PackA[1] };
+		C10 += A1 * PackB0; C11 += A1 * PackB1;
+		const TLinAlgV4 A2 = { PackA[2], PackA[2], PackA[2], PackA[2] };
+		C20 += A2 * PackB0; C21 += A2 * PackB1;
+		const TLinAlgV4 A3 = { PackA[3], PackA[3], PackA[3], PackA[3] };
+		C30 += A3 * PackB0; C31 += A3 * PackB1;
+		PackA += 4; PackB += 8;
+	}
+	memcpy(AB, &C00, sizeof(TLinAlgV4)); memcpy(AB + 4, &C01, sizeof(TLinAlgV4));
+	memcpy(AB + 8, &C10, sizeof(TLinAlgV4)); memcpy(AB + 12, &C11, sizeof(TLinAlgV4));
+	memcpy(AB + 16, &C20, sizeof(TLinAlgV4)); memcpy(AB + 20, &C21, sizeof(TLinAlgV4));
+	memcpy(AB + 24, &C30, sizeof(TLinAlgV4)); memcpy(AB + 28, &C31, sizeof(TLinAlgV4));
+}
+#endif
+
+void TLinAlgKernel::MicroKernel(const int& Depth, const double* PackA, const double* PackB, double* AB) {
+#ifdef GLib_LINALG_VEC
+	TLinAlgMicroKernelBody(Depth, PackA, PackB, AB);
+#else
+	for (int ElN = 0; ElN < MR * NR; ElN++) { AB[ElN] = 0.0; }
+	for (int DepthN = 0; DepthN < Depth; DepthN++) {
+		for (int RowN = 0; RowN < MR; RowN++) {
+			const double Val = PackA[RowN];
+			for (int ColN = 0; ColN < NR; ColN++) {
+				AB[RowN * NR + ColN] += Val * PackB[ColN];
+			}
+		}
+		PackA += MR; PackB += NR;
+	}
+#endif
+}
+
+#ifdef GLib_LINALG_AVX2
+__attribute__((target("avx2")))
+#endif
+void TLinAlgKernel::MicroKernelAvx2(const int& Depth, const double* PackA, const double* PackB, double* AB) {
+#ifdef GLib_LINALG_AVX2
+	TLinAlgMicroKernelBody(Depth, PackA, PackB, AB);
+#else
+	MicroKernel(Depth, PackA, PackB, AB);
+#endif
+}
+
+TLinAlgKernel::TMicroKernel TLinAlgKernel::GetMicroKernel() {
+#ifdef GLib_LINALG_AVX2
+	static const bool Avx2P = __builtin_cpu_supports("avx2") != 0;
+	return Avx2P ? &MicroKernelAvx2 : &MicroKernel;
+#else
+	return &MicroKernel;
+#endif
+}
+
+void TLinAlgKernel::PackA(const bool& TransA, const double* A, const int& LdA, const int& RowN,
+		const int& Rows, const int& DepthN, const int& Depth, double* PackV) {
+
+	for (int StripN = 0; StripN < Rows; StripN += MR) {
+		const int StripRows = (Rows - StripN < MR) ? Rows - StripN : MR;
+		for (int ElN = 0; ElN < Depth; ElN++) {
+			for (int StripRowN = 0; StripRowN < StripRows; StripRowN++) {
+				const int64 Row = RowN + StripN + StripRowN, Col = DepthN + ElN;
+				*PackV++ = TransA ? A[Col * LdA + Row] : A[Row * LdA + Col];
+			}
+			for (int StripRowN = StripRows; StripRowN < MR; StripRowN++) { *PackV++ = 0.0; }
+		}
+	}
+}
+
+void TLinAlgKernel::PackB(const bool& TransB, const double* B, const int& LdB, const int& DepthN,
+		const int& Depth, const int& ColN, const int& Cols, double* PackV) {
+
+	for (int StripN = 0; StripN < Cols; StripN += NR) {
+		const int StripCols = (Cols - StripN < NR) ? Cols - StripN : NR;
+		for (int ElN = 0; ElN < Depth; ElN++) {
+			for (int StripColN = 0; StripColN < StripCols; StripColN++) {
+				const int64 Row = DepthN + ElN, Col = ColN + StripN + StripColN;
+				*PackV++ = TransB ? B[Col * LdB + Row] : B[Row * LdB + Col];
+			}
+			for (int StripColN = StripCols; StripColN < NR; StripColN++) { *PackV++ = 0.0; }
+		}
+	}
+}
+
+void TLinAlgKernel::Gemm(const bool& TransA, const bool& TransB, const int& M, const int& N,
+		const int& K, const double& Alpha, const double* A, const int& LdA, const double* B,
+		const int& LdB, const double& Beta, double* C, const int& LdC) {
+
+	if (M <= 0 || N <= 0) { return; }
+	// C := Beta * C, zero is set explicitly so that NaNs in C do not survive
+	if (Beta != 1.0) {
+		for (int RowN = 0; RowN < M; RowN++) {
+			double* CRow = C + (int64)RowN * LdC;
+			if (Beta == 0.0) {
+				for (int ColN = 0; ColN < N; ColN++) { CRow[ColN] = 0.0; }
+			} else {
+				for (int ColN = 0; ColN < N; ColN++) { CRow[ColN] *= Beta; }
+			}
+		}
+	}
+	if (K <= 0 || Alpha == 0.0) { return; }
+
+	const TMicroKernel Kernel = GetMicroKernel();
+	const bool ParP = (int64)M * N * K >= ParMnFlops;
+	const int RowBlocks = (M + MC - 1) / MC;
+	// packed B for one NC x KC block, all strips zero-padded to NR columns
+	const int BlockCols = (N < NC) ? N : NC;
+	TFltV PackBV((((BlockCols + NR - 1) / NR) * NR) * (K < KC ? K : KC));
+	double* PackBPt = &PackBV[0].Val;
+
+	for (int ColN = 0; ColN < N; ColN += NC) {
+		const int Cols = (N - ColN < NC) ? N - ColN : NC;
+		const int ColTasks = (Cols + NTask - 1) / NTask;
+		for (int DepthN = 0; DepthN < K; DepthN += KC) {
+			const int Depth = (K - DepthN < KC) ? K - DepthN : KC;
+			// pack the B block, one task of columns at a time
+			#pragma omp parallel for if(ParP) schedule(static)
+			for (int TaskN = 0; TaskN < ColTasks; TaskN++) {
+				const int TaskColN = TaskN * NTask;
+				const int TaskCols = (Cols - TaskColN < NTask) ? Cols - TaskColN : NTask;
+				PackB(TransB, B, LdB, DepthN, Depth, ColN + TaskColN, TaskCols, PackBPt + (int64)TaskColN * Depth);
+			}
+			// multiply each block of A with a part of the B block
+			#pragma omp parallel if(ParP)
+			{
+				TFltV PackAV(MC * Depth); double* PackAPt = &PackAV[0].Val;
+				double AB[MR * NR]; int PackedBlockN = -1;
+				#pragma omp for schedule(static)
+				for (int TaskN = 0; TaskN < RowBlocks * ColTasks; TaskN++) {
+					const int BlockN = TaskN / ColTasks;
+					const int RowN = BlockN * MC;
+					const int Rows = (M - RowN < MC) ? M - RowN : MC;
+					if (BlockN != PackedBlockN) {
+						PackA(TransA, A, LdA, RowN, Rows, DepthN, Depth, PackAPt);
+						PackedBlockN = BlockN;
+					}
+					const int TaskColN = (TaskN % ColTasks) * NTask;
+					const int TaskColEndN = (Cols - TaskColN < NTask) ? Cols : TaskColN + NTask;
+					for (int StripColN = TaskColN; StripColN < TaskColEndN; StripColN += NR) {
+						const int StripCols = (TaskColEndN - StripColN < NR) ? TaskColEndN - StripColN : NR;
+						const double* StripB = PackBPt + (int64)StripColN * Depth;
+						for (int StripRowN = 0; StripRowN < Rows; StripRowN += MR) {
+							const int StripRows = (Rows - StripRowN < MR) ? Rows - StripRowN : MR;
+							Kernel(Depth, PackAPt + (int64)StripRowN * Depth, StripB, AB);
+							// C += Alpha * AB, only the part of the tile inside C
+							double* CTile = C + (int64)(RowN + StripRowN) * LdC + ColN + StripColN;
+							for (int TileRowN = 0; TileRowN < StripRows; TileRowN++) {
+								double* CRow = CTile + (int64)TileRowN * LdC;
+								const double* ABRow = AB + TileRowN * NR;
+								for (int TileColN = 0; TileColN < StripCols; TileColN++) {
+									CRow[TileColN] += Alpha * ABRow[TileColN];
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+void TLinAlgKernel::Gemv(const bool& TransA, const int& M, const int& N, const double& Alpha,
+		const double* A, const int& LdA, const double* x, const double& Beta, double* y) {
+
+	const bool ParP = (int64)M * N >= ParMnFlops;
+	if (!TransA) {
+		// y(i) := Alpha * <A(i,:), x> + Beta * y(i), four rows at a time to reuse x
+		const int Quads = (M + 3) / 4;
+		#pragma omp parallel for if(ParP) schedule(static)
+		for (int QuadN = 0; QuadN < Quads; QuadN++) {
+			const int RowN = QuadN * 4;
+			const int Rows = (M - RowN < 4) ? M - RowN : 4;
+			const double* Row0 = A + (int64)RowN * LdA;
+			const double* Row1 = (Rows > 1) ? Row0 + LdA : Row0;
+			const double* Row2 = (Rows > 2) ? Row1 + LdA : Row0;
+			const double* Row3 = (Rows > 3) ? Row2 + LdA : Row0;
+			double Sum0 = 0.0, Sum1 = 0.0, Sum2 = 0.0, Sum3 = 0.0;
+			for (int ColN = 0; ColN < N; ColN++) {
+				const double Val = x[ColN];
+				Sum0 += Row0[ColN] * Val; Sum1 += Row1[ColN] * Val;
+				Sum2 += Row2[ColN] * Val; Sum3 += Row3[ColN] * Val;
+			}
+			const double SumV[4] = { Sum0, Sum1, Sum2, Sum3 };
+			for (int QuadRowN = 0; QuadRowN < Rows; QuadRowN++) {
+				double& Res = y[RowN + QuadRowN];
+				Res = Alpha * SumV[QuadRowN] + ((Beta == 0.0) ? 0.0 : Beta * Res);
+			}
+		}
+	} else {
+		// y := Alpha * A' * x + Beta * y, rows of A are added to y, y is split among threads
+		const int Chunks = (N + NTask - 1) / NTask;
+		#pragma omp parallel for if(ParP) schedule(static)
+		for (int ChunkN = 0; ChunkN < Chunks; ChunkN++) {
+			const int ColN = ChunkN * NTask;
+			const int Cols = (N - ColN < NTask) ? N - ColN : NTask;
+			double* ResV = y + ColN;
+			for (int ElN = 0; ElN < Cols; ElN++) {
+				ResV[ElN] = (Beta == 0.0) ? 0.0 : Beta * ResV[ElN];
+			}
+			for (int RowN = 0; RowN < M; RowN++) {
+				const double Val = Alpha * x[RowN];
+				const double* Row = A + (int64)RowN * LdA + ColN;
+				for (int ElN = 0; ElN < Cols; ElN++) { ResV[ElN] += Val * Row[ElN]; }
+			}
+		}
+	}
+}
+
+void TLinAlgKernel::Syrk(const bool& TransA, const int& N, const int& K, const double& Alpha,
+		const double* A, const int& LdA, const double& Beta, double* C, const int& LdC) {
+
+	if (N <= 0) { return; }
+	// upper triangle, one block of C per task; row RowN of op(A) starts at
+	// A + RowN (transposed) or A + RowN * LdA, and is column RowN of op(A)'
+	const int Blocks = (N + SyrkB - 1) / SyrkB;
+	const bool ParP = (int64)N * N * K >= 2 * ParMnFlops;
+	#pragma omp parallel for if(ParP) schedule(dynamic, 1)
+	for (int PairN = 0; PairN < Blocks * Blocks; PairN++) {
+		const int BlockRowN = PairN / Blocks, BlockColN = PairN % Blocks;
+		if (BlockColN < BlockRowN) { continue; }
+		const int RowN = BlockRowN * SyrkB, ColN = BlockColN * SyrkB;
+		const int Rows = (N - RowN < SyrkB) ? N - RowN : SyrkB;
+		const int Cols = (N - ColN < SyrkB) ? N - ColN : SyrkB;
+		const double* RowA = TransA ? A + RowN : A + (int64)RowN * LdA;
+		const double* ColA = TransA ? A + ColN : A + (int64)ColN * LdA;
+		Gemm(TransA, !TransA, Rows, Cols, K, Alpha, RowA, LdA, ColA, LdA, Beta,
+			C + (int64)RowN * LdC + ColN, LdC);
+	}
+	// lower triangle
+	for (int RowN = 1; RowN < N; RowN++) {
+		for (int ColN = 0; ColN < RowN; ColN++) {
+			C[(int64)RowN * LdC + ColN] = C[(int64)ColN * LdC + RowN];
+		}
+	}
+}
+
+TStr TLinAlgKernel::GetSimdNm() {
+#if defined(GLib_LINALG_AVX2)
+	return (GetMicroKernel() == &MicroKernelAvx2) ? "avx2" : "sse2";
+#elif defined(GLib_LINALG_VEC)
+	return "vec";
+#else
+	return "scalar";
+#endif
+}
+
 ////////////////////////////////////////////////////////////////////////
 //// Basic Linear Algebra Operations
 void TLinAlg::LinComb(const double& p, const TIntFltKdV& x, const double& q, const TIntFltKdV& y, TIntFltKdV& z) {
@@ -848,6 +1311,16 @@ double TLinAlg::EuclDist(const TFltPr& x, const TFltPr& y) {
 	return sqrt(TLinAlg::EuclDist2(x, y));
 }
 
+void TLinAlg::AddGram(const TFltVV& X, TFltVV& G) {
+	const int Rows = X.GetRows();
+	const int Cols = X.GetCols();
+
+	EAssertR(G.GetRows() == Rows && G.GetCols() == Rows, "TLinAlg::AddGram: dimension mismatch!");
+	if (Rows == 0 || Cols == 0) { return; }
+
+	TLinAlgKernel::Syrk(false, Rows, Cols, 1.0, &X(0,0).Val, Cols, 1.0, &G(0,0).Val, Rows);
+}
+
 void TLinAlg::Transpose(const TVec<TIntFltKdV>& A, TVec<TIntFltKdV>& At, int Rows){
 	// A is a sparse col matrix:
 	int Cols = A.Len();
@@ -891,16 +1364,9 @@ void TLinAlg::Multiply(const TVec<TIntFltKdV>& A, const TFltVV& B, TFltVV& C, co
 	if (C.Empty()) {
 		C.Gen(Rows, ColsB);
 	}
-	int RowsB = B.GetRows();
-	C.PutAll(0.0);
-	for (int ColN = 0; ColN < ColsB; ColN++) {
-		for (int RowN = 0; RowN < RowsB; RowN++) {
-			int Els = A[RowN].Len();
-			for (int ElN = 0; ElN < Els; ElN++) {
-				C.At(A[RowN][ElN].Key, ColN) += A[RowN][ElN].Dat * B.At(RowN, ColN);
-			}
-		}
-	}
+	// columns of A scatter into rows of C, so A is first converted to rows
+	// and then the rows of C are computed in parallel
+	TCompressedSparseMatrix(A, Rows).Multiply(B, C);
 }
 // SPARSECOLMAT-SPARSECOLMAT
 
@@ -272,6 +272,74 @@ public:
 	}
 };
 
+///////////////////////////////////////////////////////////////////////
+/// Compressed-Sparse-Matrix
+///  nonzeros are stored in compressed sparse column (CSC) and compressed
+///  sparse row (CSR) arrays, so both A * B and A' * B are computed one
+///  output row at a time, without write conflicts. Products run in
+///  parallel (OpenMP) once they are large enough.
+class TCompressedSparseMatrix : public TMatrix {
+public:
+	/// Products with fewer multiply-adds than this run in one thread
+	static const int64 ParMnFlops = 1 << 15;
+
+private:
+	// number of rows and columns of matrix
+	TInt RowN, ColN;
+	// CSC: nonzeros of column j are at [ColPtrV[j], ColPtrV[j+1])
+	TIntV ColPtrV;
+	TIntV ColRowIdV;
+	TFltV ColValV;
+	// CSR: nonzeros of row i are at [RowPtrV[i], RowPtrV[i+1])
+	TIntV RowPtrV;
+	TIntV RowColIdV;
+	TFltV RowValV;
+
+	/// Builds the CSR arrays from the CSC arrays
+	void InitRows();
+
+protected:
+	// Result = A * B(:,ColId)
+	virtual void PMultiply(const TFltVV& B, int ColId, TFltV& Result) const;
+	// Result = A * Vec
+	virtual void PMultiply(const TFltV& Vec, TFltV& Result) const;
+	// Result = A' * B(:,ColId)
+	virtual void PMultiplyT(const TFltVV& B, int ColId, TFltV& Result) const;
+	// Result = A' * Vec
+	virtual void PMultiplyT(const TFltV& Vec, TFltV& Result) const;
+	// Result = A * B
+	virtual void PMultiply(const TFltVV& B, TFltVV& Result) const;
+	// Result = A' * B
+	virtual void PMultiplyT(const TFltVV& B, TFltVV& Result) const;
+
+	int PGetRows() const { return RowN; }
+	int PGetCols() const { return ColN; }
+
+public:
+	TCompressedSparseMatrix(): TMatrix() {}
+	/// Converts a matrix given with sparse columns. When _RowN is -1 the
+	/// number of rows is one more than the largest row index.
+	TCompressedSparseMatrix(const TVec<TIntFltKdV>& ColSpVV, const int& _RowN = -1);
+
+	/// Number of nonzero elements
+	int GetNnz() const { return ColValV.Len(); }
+	/// CSC arrays, for solvers which go over the nonzeros of each column
+	const TIntV& GetColPtrV() const { return ColPtrV; }
+	const TIntV& GetColRowIdV() const { return ColRowIdV; }
+	const TFltV& GetColValV() const { return ColValV; }
+	/// CSR arrays, for solvers which go over the nonzeros of each row
+	const TIntV& GetRowPtrV() const { return RowPtrV; }
+	const TIntV& GetRowColIdV() const { return RowColIdV; }
+	const TFltV& GetRowValV() const { return RowValV; }
+	/// Converts back to sparse columns
+	void GetColSpVV(TVec<TIntFltKdV>& ColSpVV) const;
+	/// Sparse rows of the matrix
+	void GetRowSpVV(TVec<TIntFltKdV>& RowSpVV) const;
+
+	void Save(TSOut& SOut) const;
+	void Load(TSIn& SIn);
+};
+
 ///////////////////////////////////////////////////////////////////////
 // Full-Col-Matrix
 //  matrix is given with columns of full vectors
@@ -550,6 +618,8 @@ public:
 	TEMP_LA static TSizeTy GetMaxDimIdx(const TSparseV& SpVec);
 	// gets the maximal row index of a sparse column matrix
 	TEMP_LA static TSizeTy GetMaxDimIdx(const TSparseVV& SpMat);
+	// gets the number of stored elements of a sparse column matrix
+	TEMP_LA static int64 GetNnz(const TSparseVV& SpMat);
 
 	// TEST
 	/// find the index of maximum elements for a given row of X
@@ -574,6 +644,58 @@ public:
 	TEMP_LA	static void GetColMinIdxV(const TDenseVV& X, TVec<TNum<TSizeTy>, TSizeTy>& IdxV);
 };
 
+///////////////////////////////////////////////////////////////////////
+/// Dense matrix kernels, used by TLinAlg when BLAS is not compiled in.
+/// Matrices are row-major arrays with leading dimension (row stride) Ld.
+/// GEMM is cache blocked and register tiled, with an AVX2 micro-kernel
+/// selected at runtime when the CPU supports it, and runs blocks of the
+/// output in parallel (OpenMP) once the product is large enough.
+class TLinAlgKernel {
+private:
+	/// Register tile of the micro-kernel: MR x NR values of C
+	static const int MR = 4;
+	static const int NR = 8;
+	/// Cache blocks: MC x KC block of A for L2, KC x NR panel of B for L1
+	static const int MC = 96;
+	static const int KC = 256;
+	static const int NC = 2048;
+	/// Columns of C computed by one parallel task
+	static const int NTask = 256;
+	/// Block size of C in SYRK
+	static const int SyrkB = 128;
+	/// Products smaller than this number of multiply-adds run in one thread
+	static const int64 ParMnFlops = 64 * 64 * 64;
+
+	/// Micro-kernel: AB := PackA * PackB for one MR x NR tile
+	typedef void (*TMicroKernel)(const int& Depth, const double* PackA, const double* PackB, double* AB);
+	static void MicroKernel(const int& Depth, const double* PackA, const double* PackB, double* AB);
+	static void MicroKernelAvx2(const int& Depth, const double* PackA, const double* PackB, double* AB);
+	static TMicroKernel GetMicroKernel();
+
+	/// Packs rows [RowN, RowN+Rows) x depth [DepthN, DepthN+Depth) of op(A) into MR-row strips
+	static void PackA(const bool& TransA, const double* A, const int& LdA, const int& RowN,
+		const int& Rows, const int& DepthN, const int& Depth, double* PackV);
+	/// Packs depth [DepthN, DepthN+Depth) x columns [ColN, ColN+Cols) of op(B) into NR-column strips
+	static void PackB(const bool& TransB, const double* B, const int& LdB, const int& DepthN,
+		const int& Depth, const int& ColN, const int& Cols, double* PackV);
+
+public:
+	/// C := Alpha * op(A) * op(B) + Beta * C, where op(A) is M x K and op(B) is K x N
+	static void Gemm(const bool& TransA, const bool& TransB, const int& M, const int& N,
+		const int& K, const double& Alpha, const double* A, const int& LdA, const double* B,
+		const int& LdB, const double& Beta, double* C, const int& LdC);
+	/// y := Alpha * op(A) * x + Beta * y, where A is M x N
+	static void Gemv(const bool& TransA, const int& M, const int& N, const double& Alpha,
+		const double* A, const int& LdA, const double* x, const double& Beta, double* y);
+	/// C := Alpha * op(A) * op(A)' + Beta * C, where op(A) is N x K. Only the upper
+	/// triangle is computed, and then copied to the lower one.
+	static void Syrk(const bool& TransA, const int& N, const int& K, const double& Alpha,
+		const double* A, const int& LdA, const double& Beta, double* C, const int& LdC);
+
+	/// Name of the micro-kernel selected for this CPU
+	static TStr GetSimdNm();
+};
+
 ///////////////////////////////////////////////////////////////////////
 // Basic Linear Algebra operations
 class TLinAlg {
@@ -902,6 +1024,9 @@ public:
 	/// D = alpha * A(') * B(') + beta * C(')
     TEMP_LA	static void Gemm(const double& Alpha, const TDenseVV& A, const TDenseVV& B, const double& Beta,
 		const TDenseVV& C, TDenseVV& D, const int& TransposeFlags);
+	/// G := G + X * X', where G is symmetric. Only the upper triangle of the product
+	/// is computed (in parallel for large matrices) and then mirrored.
+	static void AddGram(const TFltVV& X, TFltVV& G);
 
 	/// transpose matrix - B = A'
     TEMP_LA	static void Transpose(const TDenseVV& A, TDenseVV& B);
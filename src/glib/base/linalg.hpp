@@ -366,6 +366,15 @@ TSizeTy TLinAlgSearch::GetMaxDimIdx(const TVec<TVec<TKeyDat<TNum<TSizeTy>, TNum<
 	return MaxDim;
 }
 
+template <class TType, class TSizeTy, bool ColMajor>
+int64 TLinAlgSearch::GetNnz(const TVec<TVec<TKeyDat<TNum<TSizeTy>, TNum<TType>>, TSizeTy>, TSizeTy>& SpMat) {
+	int64 Nnz = 0;
+	for (TSizeTy ColN = 0; ColN < SpMat.Len(); ColN++) {
+		Nnz += SpMat[ColN].Len();
+	}
+	return Nnz;
+}
+
 template <class TType, class TSizeTy, bool ColMajor>
 TSizeTy TLinAlgSearch::GetRowMaxIdx(const TVVec<TNum<TType>, TSizeTy, ColMajor>& X,
 		const TSizeTy& RowN) {
@@ -1464,17 +1473,7 @@ void TLinAlg::Multiply(const TVVec<TNum<TType>, TSizeTy, ColMajor>& A,
 		const TVec<TNum<TType>, TSizeTy>& x, TVec<TNum<TType>, TSizeTy>& y) {
 	if (y.Empty()) { y.Gen(A.GetRows()); }
 	EAssert(A.GetCols() == x.Len() && A.GetRows() == y.Len());
-#ifdef BLAS
 	TLinAlg::Multiply(A, x, y, TLinAlgBlasTranspose::NOTRANS, 1.0, 0.0);
-#else
-	TSizeTy n = A.GetRows(), m = A.GetCols();
-	for (TSizeTy i = 0; i < n; i++) {
-		y[i] = 0.0;
-		for (TSizeTy j = 0; j < m; j++) {
-			y[i] += A(i, j) * x[j];
-        }
-	}
-#endif
 }
 
 // TEST
@@ -1882,13 +1881,46 @@ void TLinAlg::MultiplyFS(TVVec<TType, TSizeTy, ColMajor>& B, const TTriple<TVec<
 template <class TType, class TSizeTy, bool ColMajor>
 void TLinAlg::MultiplySF(const TTriple<TVec<TNum<TSizeTy>, TSizeTy>, TVec<TNum<TSizeTy>, TSizeTy>, TVec<TType, TSizeTy>>& A, const TVVec<TType, TSizeTy, false>& B,
 	TVVec<TType, TSizeTy, ColMajor>& C, const TStr& transa, const int& format) {
-	throw TExcept::New("TLinAlg::MultiplySF(const TTriple<TVec<TNum<TSizeTy>, TSizeTy>, TVec<TNum<TSizeTy>, TSizeTy>, TVec<TType, TSizeTy>>& A, const TVVec<TType, TSizeTy, false>& B, TVVec<TType, TSizeTy, ColMajor>& C, const TStr& transa, const int& format) not implemented yet!");
+	// A is in coordinate format (format == 0) with row indices in Val1, or in CSR format
+	// with row pointers in Val1; both have column indices in Val2 and values in Val3
+	const bool TransA = transa != "N";
+	EAssert(A.Val2.Len() == A.Val3.Len() && B.GetCols() == C.GetCols());
+	EAssert(format == 0 ? A.Val1.Len() == A.Val3.Len() : A.Val1.Len() > 0);
+	C.PutAll(0.0);
+	const TSizeTy Cols = B.GetCols();
+	// coordinate format is walked as a single row of all the elements
+	const TSizeTy Rows = (format == 0) ? 1 : A.Val1.Len() - 1;
+	for (TSizeTy RowN = 0; RowN < Rows; RowN++) {
+		const TSizeTy StartN = (format == 0) ? 0 : (TSizeTy)A.Val1[RowN];
+		const TSizeTy EndN = (format == 0) ? A.Val3.Len() : (TSizeTy)A.Val1[RowN + 1];
+		for (TSizeTy ElN = StartN; ElN < EndN; ElN++) {
+			// C(i,:) += A(i,j) * B(j,:), or C(j,:) += A(i,j) * B(i,:) for A'
+			const TSizeTy ARowN = (format == 0) ? (TSizeTy)A.Val1[ElN] : RowN;
+			const TSizeTy AColN = A.Val2[ElN];
+			const TSizeTy CRowN = TransA ? AColN : ARowN;
+			const TSizeTy BRowN = TransA ? ARowN : AColN;
+			EAssert(CRowN < C.GetRows() && BRowN < B.GetRows());
+			const TType Val = A.Val3[ElN];
+			for (TSizeTy ColN = 0; ColN < Cols; ColN++) {
+				C(CRowN, ColN) += Val * B(BRowN, ColN);
+			}
+		}
+	}
 }
 
 template <class IndexType, class TType, class TSizeTy, bool ColMajor>
 void TLinAlg::MultiplyFS(TVVec<TType, TSizeTy, ColMajor>& B, const TTriple<TVec<IndexType, TSizeTy>, TVec<IndexType, TSizeTy>, TVec<TType, TSizeTy>>& A,
 	TVVec<TType, TSizeTy, ColMajor>& C) {
-	throw TExcept::New("TLinAlg::MultiplyFS(TVVec<TType, TSizeTy, ColMajor>& B, const TTriple<TVec<IndexType, TSizeTy>, TVec<IndexType, TSizeTy>, TVec<TType, TSizeTy>>& A, TVVec<TType, TSizeTy, ColMajor>& C) not implemented yet!");
+	// C := B * A, with A in coordinate format
+	EAssert(A.Val1.Len() == A.Val2.Len() && A.Val2.Len() == A.Val3.Len());
+	EAssert(B.GetRows() == C.GetRows());
+	C.PutAll(0.0);
+	const TSizeTy Rows = B.GetRows(), Nonzeros = A.Val3.Len();
+	for (TSizeTy RowN = 0; RowN < Rows; RowN++) {
+		for (TSizeTy ElN = 0; ElN < Nonzeros; ElN++) {
+			C(RowN, A.Val2[ElN]) += B(RowN, A.Val1[ElN]) * A.Val3[ElN];
+		}
+	}
 }
 
 #endif
@@ -1939,12 +1971,7 @@ template <class TType, class TSizeTy, bool ColMajor>
 void TLinAlg::MultiplyT(const TVVec<TNum<TType>, TSizeTy, ColMajor>& A, const TVec<TNum<TType>, TSizeTy>& x, TVec<TNum<TType>, TSizeTy>& y) {
 	if (y.Empty()) y.Gen(A.GetCols());
 	EAssert(A.GetRows() == x.Len() && A.GetCols() == y.Len());
-	TSizeTy n = A.GetCols(), m = A.GetRows();
-	for (TSizeTy i = 0; i < n; i++) {
-		y[i] = 0.0;
-		for (TSizeTy j = 0; j < m; j++)
-			y[i] += A(j, i) * x[j];
-	}
+	TLinAlg::Multiply(A, x, y, TLinAlgBlasTranspose::TRANS, 1.0, 0.0);
 }
 
 #ifdef BLAS
@@ -2036,7 +2063,40 @@ template <class TType, class TSizeTy, bool ColMajor>
 inline void TLinAlg::Multiply(const TVVec<TNum<TType>, TSizeTy, ColMajor>& A,
 	const TVVec<TNum<TType>, TSizeTy, ColMajor>& B, TVVec<TNum<TType>,
 	TSizeTy, ColMajor>& C, const int& BlasTransposeFlagA, const int& BlasTransposeFlagB) {
-	throw TExcept::New("TLinAlg::Multiply(const TVVec<TNum<TType>, TSizeTy, ColMajor>& A, const TVVec<TNum<TType>, TSizeTy, ColMajor>& B, TVVec<TNum<TType>, TSizeTy, ColMajor>& C, const int& BlasTransposeFlagA, const int& BlasTransposeFlagB) not implemented yet!");
+	const bool TransA = BlasTransposeFlagA == TLinAlgBlasTranspose::TRANS;
+	const bool TransB = BlasTransposeFlagB == TLinAlgBlasTranspose::TRANS;
+	const TSizeTy m = TransA ? A.GetCols() : A.GetRows();
+	const TSizeTy k = TransA ? A.GetRows() : A.GetCols();
+	const TSizeTy n = TransB ? B.GetRows() : B.GetCols();
+	EAssert(k == (TransB ? B.GetCols() : B.GetRows()));
+	EAssert(m == C.GetRows() && n == C.GetCols());
+	if (m == 0 || n == 0) { return; }
+	if (k == 0) { C.PutAll(0.0); return; }
+
+	if (TypeCheck::is_double<TType>::value) {
+		const double* APt = (const double*)&A(0, 0).Val;
+		const double* BPt = (const double*)&B(0, 0).Val;
+		double* CPt = (double*)&C(0, 0).Val;
+		const int lda = (int)(ColMajor ? A.GetRows() : A.GetCols());
+		const int ldb = (int)(ColMajor ? B.GetRows() : B.GetCols());
+		const int ldc = (int)(ColMajor ? C.GetRows() : C.GetCols());
+		if (ColMajor) {
+			// column-major matrices are transposed row-major ones: C' = op(B)' * op(A)'
+			TLinAlgKernel::Gemm(TransB, TransA, (int)n, (int)m, (int)k, 1.0, BPt, ldb, APt, lda, 0.0, CPt, ldc);
+		} else {
+			TLinAlgKernel::Gemm(TransA, TransB, (int)m, (int)n, (int)k, 1.0, APt, lda, BPt, ldb, 0.0, CPt, ldc);
+		}
+	} else {
+		for (TSizeTy RowN = 0; RowN < m; RowN++) {
+			for (TSizeTy ColN = 0; ColN < n; ColN++) {
+				TType Sum = 0.0;
+				for (TSizeTy ElN = 0; ElN < k; ElN++) {
+					Sum += (TransA ? A(ElN, RowN) : A(RowN, ElN)) * (TransB ? B(ColN, ElN) : B(ElN, ColN));
+				}
+				C(RowN, ColN) = Sum;
+			}
+		}
+	}
 }
 
 #endif
@@ -2109,7 +2169,39 @@ void TLinAlg::Multiply(const TVVec<TNum<TType>, TSizeTy, ColMajor>& A, const TVe
 //Andrej ToDo In the future replace TType with TNum<type> and change double to type
 template <class TType, class TSizeTy, bool ColMajor>
 void TLinAlg::Multiply(const TVVec<TNum<TType>, TSizeTy, ColMajor>& A, const TVec<TNum<TType>, TSizeTy>& x, TVec<TNum<TType>, TSizeTy>& y, const int& BlasTransposeFlagA, TType alpha, TType beta) {
-	throw TExcept::New("TLinAlg::Multiply(const TVVec<TNum<TType>, TSizeTy, ColMajor>& A, const TVec<TNum<TType>, TSizeTy>& x, TVec<TNum<TType>, TSizeTy>& y, const int& BlasTransposeFlagA, TType alpha, TType beta) not implemented yet!");
+	TSizeTy m = A.GetRows();
+	TSizeTy n = A.GetCols();
+	const bool TransA = BlasTransposeFlagA != 0;
+	if (TransA) {//A'*x n*m x m -> n
+		EAssertR(x.Len() == m, "TLinAlg::Multiply: Invalid dimension of input vector!");
+		if (y.Len() != n) { y.Gen(n, n); }
+	}
+	else{//A*x  m x n * n -> m
+		EAssertR(x.Len() == n, "TLinAlg::Multiply: Invalid dimension of input vector!");
+		if (y.Len() != m) { y.Gen(m, m); }
+	}
+	if (y.Empty()) { return; }
+
+	if (TypeCheck::is_double<TType>::value && m > 0 && n > 0) {
+		const double* APt = (const double*)&A(0, 0).Val;
+		const double* xPt = (const double*)&x[0].Val;
+		double* yPt = (double*)&y[0].Val;
+		if (ColMajor) {
+			// column-major A is a transposed row-major n x m matrix
+			TLinAlgKernel::Gemv(!TransA, (int)n, (int)m, (double)alpha, APt, (int)m, xPt, (double)beta, yPt);
+		} else {
+			TLinAlgKernel::Gemv(TransA, (int)m, (int)n, (double)alpha, APt, (int)n, xPt, (double)beta, yPt);
+		}
+	} else {
+		const TSizeTy Len = TransA ? n : m, Depth = TransA ? m : n;
+		for (TSizeTy ElN = 0; ElN < Len; ElN++) {
+			TType Sum = 0.0;
+			for (TSizeTy DepthN = 0; DepthN < Depth; DepthN++) {
+				Sum += (TransA ? A(DepthN, ElN) : A(ElN, DepthN)) * x[DepthN];
+			}
+			y[ElN] = alpha * Sum + ((beta == TType(0.0)) ? TType(0.0) : beta * y[ElN]);
+		}
+	}
 }
 
 #endif
@@ -2121,22 +2213,7 @@ void TLinAlg::Multiply(const TVVec<TNum<TType>, TSizeTy, ColMajor>& A,
 
     EAssert(A.GetRows() == C.GetRows() && B.GetCols() == C.GetCols() &&
     		A.GetCols() == B.GetRows());
-#ifdef BLAS
 	TLinAlg::Multiply(A, B, C, TLinAlgBlasTranspose::NOTRANS, TLinAlgBlasTranspose::NOTRANS);
-#else
-	TSizeTy RowsA = A.GetRows();
-	TSizeTy ColsA = A.GetCols();
-	TSizeTy ColsB = B.GetCols();
-	C.PutAll(0.0);
-	for (TSizeTy RowN = 0; RowN < RowsA; RowN++) {
-		for (TSizeTy ColAN = 0; ColAN < ColsA; ColAN++) {
-			TType Weight = A(RowN, ColAN);
-			for (TSizeTy ColBN = 0; ColBN < ColsB; ColBN++) {
-				C(RowN, ColBN) += Weight * B(ColAN, ColBN);
-			}
-		}
-	}
-#endif
 }
 
 template <class TType, class TSizeTy, bool ColMajor>
@@ -2148,14 +2225,15 @@ void TLinAlg::MultiplyT(const TVVec<TNum<TType>, TSizeTy, ColMajor>& A,
 #ifdef BLAS
 	TLinAlg::Multiply(A, B, C, TLinAlgBlasTranspose::TRANS, TLinAlgBlasTranspose::NOTRANS);
 #else
-	TSizeTy n = C.GetRows(), m = C.GetCols(), l = A.GetRows(); TType sum;
-	for (TSizeTy i = 0; i < n; i++) {
-		for (TSizeTy j = 0; j < m; j++) {
-			sum = 0.0;
-			for (TSizeTy k = 0; k < l; k++)
-				sum += A(k, i)*B(k, j);
-			C(i, j) = sum;
-		}
+	if (&A == &B && TypeCheck::is_double<TType>::value && A.GetRows() > 0 && A.GetCols() > 0) {
+		// Gram matrix A' * A is symmetric, only half of it is computed;
+		// column-major A is a transposed row-major matrix, where A' * A = A * A'
+		const int lda = (int)(ColMajor ? A.GetRows() : A.GetCols());
+		const int ldc = (int)(ColMajor ? C.GetRows() : C.GetCols());
+		TLinAlgKernel::Syrk(!ColMajor, (int)A.GetCols(), (int)A.GetRows(), 1.0,
+			(const double*)&A(0, 0).Val, lda, 0.0, (double*)&C(0, 0).Val, ldc);
+	} else {
+		TLinAlg::Multiply(A, B, C, TLinAlgBlasTranspose::TRANS, TLinAlgBlasTranspose::NOTRANS);
 	}
 #endif
 }
@@ -2224,7 +2302,9 @@ void TLinAlg::Multiply(const TTriple<TVec<TNum<TSizeTy>, TSizeTy>, TVec<TNum<TSi
 	TSizeTy MaxRowN = A.Val1[A.Val1.GetMxValN()];
 	TSizeTy MaxColN = A.Val2[A.Val2.GetMxValN()];
 	EAssert(B.GetCols() == C.GetCols() && (MaxRowN + 1) <= C.GetRows() && (MaxColN + 1) <= B.GetRows());
-	for (TSizeTy ColN = 0; ColN < B.GetCols(); ColN++) {
+	const TSizeTy ColsB = B.GetCols();
+	#pragma omp parallel for if((int64)Nonzeros * ColsB >= TCompressedSparseMatrix::ParMnFlops)
+	for (TSizeTy ColN = 0; ColN < ColsB; ColN++) {
 		for (TSizeTy ElN = 0; ElN < Nonzeros; ElN++) {
 			C.At(A.Val1[ElN], ColN) += A.Val3[ElN] * B.At(A.Val2[ElN], ColN);
 		}
@@ -2249,7 +2329,9 @@ void TLinAlg::MultiplyT(const TTriple<TVec<TNum<TSizeTy>, TSizeTy>, TVec<TNum<TS
 	TSizeTy MaxRowN = A.Val1[A.Val1.GetMxValN()];
 	TSizeTy MaxColN = A.Val2[A.Val2.GetMxValN()];
 	EAssert(B.GetCols() == C.GetCols() && (MaxColN + 1) <= C.GetRows() && (MaxRowN + 1) <= B.GetRows());
-	for (TSizeTy ColN = 0; ColN < B.GetCols(); ColN++) {
+	const TSizeTy ColsB = B.GetCols();
+	#pragma omp parallel for if((int64)Nonzeros * ColsB >= TCompressedSparseMatrix::ParMnFlops)
+	for (TSizeTy ColN = 0; ColN < ColsB; ColN++) {
 		for (TSizeTy ElN = 0; ElN < Nonzeros; ElN++) {
 			C.At(A.Val2[ElN], ColN) += A.Val3[ElN] * B.At(A.Val1[ElN], ColN);
 		}
@@ -2277,13 +2359,16 @@ void TLinAlg::Multiply(const TFltVV& A, const TVec<TIntFltKdV>& B, TFltVV& C) {
 	EAssert(TLinAlgSearch::GetMaxDimIdx(B) + 1 <= A.GetCols());
 	int Cols = B.Len();
 	int Rows = A.GetRows();
-	C.PutAll(0.0);
+	// rows of C are independent
+	#pragma omp parallel for if((int64)TLinAlgSearch::GetNnz(B) * Rows >= TCompressedSparseMatrix::ParMnFlops)
 	for (int RowN = 0; RowN < Rows; RowN++) {
 		for (int ColN = 0; ColN < Cols; ColN++) {
+			double Val = 0.0;
 			int Els = B[ColN].Len();
 			for (int ElN = 0; ElN < Els; ElN++) {
-				C.At(RowN, ColN) += A.At(RowN, B[ColN][ElN].Key) * B[ColN][ElN].Dat;
+				Val += A.At(RowN, B[ColN][ElN].Key) * B[ColN][ElN].Dat;
 			}
+			C.At(RowN, ColN) = Val;
 		}
 	}
 }
@@ -2317,12 +2402,24 @@ void TLinAlg::MultiplyT(const TVVec<TNum<TType>, TSizeTy, ColMajor>& A,
 	EAssert(TLinAlgSearch::GetMaxDimIdx(B) + 1 <= A.GetRows());
 	TSizeTy Cols = B.Len();
 	TSizeTy Rows = A.GetCols();
-	C.PutAll(0.0);
-	for (TSizeTy RowN = 0; RowN < Rows; RowN++) {
+	// each column of C is a combination of rows of A, accumulated in a
+	// thread-local buffer so that A is read along its rows
+	#pragma omp parallel if((int64)TLinAlgSearch::GetNnz(B) * Rows >= TCompressedSparseMatrix::ParMnFlops)
+	{
+		TVec<TNum<TType>, TSizeTy> ColV(Rows);
+		#pragma omp for schedule(dynamic, 16)
 		for (TSizeTy ColN = 0; ColN < Cols; ColN++) {
+			ColV.PutAll(0.0);
 			TSizeTy Els = B[ColN].Len();
 			for (TSizeTy ElN = 0; ElN < Els; ElN++) {
-				C.At(RowN, ColN) += A.At(B[ColN][ElN].Key, RowN) * B[ColN][ElN].Dat;
+				const TSizeTy Key = B[ColN][ElN].Key;
+				const TType Dat = B[ColN][ElN].Dat;
+				for (TSizeTy RowN = 0; RowN < Rows; RowN++) {
+					ColV[RowN] += A.At(Key, RowN) * Dat;
+				}
+			}
+			for (TSizeTy RowN = 0; RowN < Rows; RowN++) {
+				C.At(RowN, ColN) = ColV[RowN];
 			}
 		}
 	}
@@ -2345,11 +2442,15 @@ void TLinAlg::MultiplyT(const TVec<TVec<TKeyDat<TNum<TSizeTy>, TNum<TType>>, TSi
 		EAssert(C.GetRows() == ColsA && C.GetCols() == ColsB);
 	}
 	C.PutAll(0.0);
+	// row RowN of C is a combination of the rows of B picked by column RowN of A
+	#pragma omp parallel for if((int64)TLinAlgSearch::GetNnz(A) * ColsB >= TCompressedSparseMatrix::ParMnFlops) schedule(dynamic, 16)
 	for (TSizeTy RowN = 0; RowN < ColsA; RowN++) {
-		for (TSizeTy ColN = 0; ColN < ColsB; ColN++) {
-			TSizeTy Els = A[RowN].Len();
-			for (TSizeTy ElN = 0; ElN < Els; ElN++) {
-				C.At(RowN, ColN) += A[RowN][ElN].Dat * B.At(A[RowN][ElN].Key, ColN);
+		TSizeTy Els = A[RowN].Len();
+		for (TSizeTy ElN = 0; ElN < Els; ElN++) {
+			const TSizeTy Key = A[RowN][ElN].Key;
+			const TType Dat = A[RowN][ElN].Dat;
+			for (TSizeTy ColN = 0; ColN < ColsB; ColN++) {
+				C.At(RowN, ColN) += Dat * B.At(Key, ColN);
 			}
 		}
 	}
@@ -2365,7 +2466,9 @@ void TLinAlg::Multiply(const TVVec<TNum<TType>, TSizeTy, ColMajor>& A,
     TSizeTy Cols = B.Len();
 
     C.Gen(Cols);
+    #pragma omp parallel for if((int64)TLinAlgSearch::GetNnz(B) * Rows >= TCompressedSparseMatrix::ParMnFlops) schedule(dynamic, 16)
     for (TSizeTy ColN = 0; ColN < Cols; ColN++) {
+        C[ColN].Gen(Rows, 0);
         for (TSizeTy RowN = 0; RowN < Rows; RowN++) {
             TType Val = 0.0;
             TSizeTy Els = B[ColN].Len();
@@ -2391,6 +2494,7 @@ void TLinAlg::MultiplyT(const TVec<TVec<TKeyDat<TNum<TSizeTy>, TNum<TType>>, TSi
 	else {
 		EAssert(ColsA == C.GetRows() && ColsB == C.GetCols());
 	}
+	#pragma omp parallel for if((int64)ColsA * ColsB >= TCompressedSparseMatrix::ParMnFlops / 16) schedule(dynamic, 16)
 	for (TSizeTy RowN = 0; RowN < ColsA; RowN++) {
 		for (TSizeTy ColN = 0; ColN < ColsB; ColN++) {
 			C.At(RowN, ColN) = TLinAlg::DotProduct(A[RowN], B[ColN]);
@@ -2411,6 +2515,7 @@ void TLinAlg::MultiplyT(const TVec<TVec<TKeyDat<TNum<TSizeTy>, TNum<TType>>, TSi
     else {
         EAssert(ColsA == c.Len());
     }
+    #pragma omp parallel for if((int64)ColsA * b.Len() >= TCompressedSparseMatrix::ParMnFlops)
     for (TSizeTy RowN = 0; RowN < ColsA; RowN++) {
         c[RowN] = TLinAlg::DotProduct(A[RowN], b);
     }
@@ -2432,6 +2537,7 @@ void TLinAlg::MultiplyT(const TVVec<TNum<TType>, TSizeTy, ColMajor>& A,
         EAssert(ColsA == c.Len());
     }
     c.PutAll(0.0);
+    #pragma omp parallel for if((int64)ColsA * b.Len() >= TCompressedSparseMatrix::ParMnFlops)
     for (TSizeTy ColN = 0; ColN < ColsA; ColN++) {
         int Els = b.Len();
         for (TSizeTy ElN = 0; ElN < Els; ElN++) {
@@ -2454,12 +2560,14 @@ void TLinAlg::MultiplyT(const TVec<TVec<TKeyDat<TNum<TSizeTy>, TNum<TType>>,TSiz
     else {
         EAssert(ColsA == c.Len());
     }
-    c.PutAll(0.0);
+    #pragma omp parallel for if(TLinAlgSearch::GetNnz(A) >= TCompressedSparseMatrix::ParMnFlops)
     for (TSizeTy ColN = 0; ColN < ColsA; ColN++) {
+        TType Val = 0.0;
         TSizeTy Els = A[ColN].Len();
         for (TSizeTy ElN = 0; ElN < Els; ElN++) {
-            c[ColN] += A[ColN][ElN].Dat * b[A[ColN][ElN].Key];
+            Val += A[ColN][ElN].Dat * b[A[ColN][ElN].Key];
         }
+        c[ColN] = Val;
     }
 }
 
@@ -2495,6 +2603,30 @@ void TLinAlg::Gemm(const double& Alpha, const TVVec<TNum<TType>, TSizeTy, ColMaj
 	// assertions for dimensions
 	EAssert(a_j == c_j && b_i == c_i && a_i == b_j && c_i == d_i && c_j == d_j);
 
+	// D := op(C), then D := Alpha * op(A) * op(B) + Beta * D, when D does not overlap the inputs
+	if (TypeCheck::is_double<TType>::value && a_i > 0 && a_j > 0 && b_i > 0 &&
+			&D != &A && &D != &B && (&D != &C || !tC)) {
+		if (&D != &C) {
+			for (TSizeTy j = 0; j < d_j; j++) {
+				for (TSizeTy i = 0; i < d_i; i++) {
+					D.At(j, i) = tC ? C.At(i, j) : C.At(j, i);
+				}
+			}
+		}
+		const double* APt = (const double*)&A(0, 0).Val;
+		const double* BPt = (const double*)&B(0, 0).Val;
+		double* DPt = (double*)&D(0, 0).Val;
+		const int lda = (int)(ColMajor ? A.GetRows() : A.GetCols());
+		const int ldb = (int)(ColMajor ? B.GetRows() : B.GetCols());
+		const int ldd = (int)(ColMajor ? D.GetRows() : D.GetCols());
+		if (ColMajor) {
+			TLinAlgKernel::Gemm(tB, tA, (int)b_i, (int)a_j, (int)a_i, Alpha, BPt, ldb, APt, lda, Beta, DPt, ldd);
+		} else {
+			TLinAlgKernel::Gemm(tA, tB, (int)a_j, (int)b_i, (int)a_i, Alpha, APt, lda, BPt, ldb, Beta, DPt, ldd);
+		}
+		return;
+	}
+
 	double Aij, Bij, Cij;
 
 	// rows of D
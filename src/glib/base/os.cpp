@@ -763,7 +763,7 @@ uint64 TSysTm::GetPerfTimerTicks(){
   struct timespec ts;
   int ErrCd=clock_gettime(CLOCK_MONOTONIC, &ts);
   //Assert(ErrCd==0); //J: vcasih se prevede in ne dela
-  if (ErrCd != 0) {
+  if (ErrCd == 0) {
     return (uint64)ts.tv_sec*1000000000ll + (uint64)ts.tv_nsec; }
   else {
     struct timeval tv;
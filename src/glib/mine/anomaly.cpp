@@ -8,9 +8,256 @@
 
 namespace TAnomalyDetection {
 
+/////////////////////////////////////////////
+/// Hierarchical Navigable Small World graph
+double THnswIndex::GetDist(const TVec<TIntFltKdV>& VecV, const TIntFltKdV& Vec,
+        const double& Norm, const int& ElId) const {
+
+    return Norm - 2 * TLinAlg::DotProduct(Vec, VecV[ElId]) + NormV[ElId];
+}
+
+int THnswIndex::GetRndLevel() {
+    // exponentially decaying probability of higher layers, normalized by 1/ln(M)
+    const double Level = -log(Rnd.GetUniDev()) / log((double)TInt::GetMx(M, 2));
+    return TInt::GetMn((int)floor(Level), 16);
+}
+
+void THnswIndex::SearchLayerGreedy(const TVec<TIntFltKdV>& VecV, const TIntFltKdV& Vec,
+        const double& Norm, const int& Layer, int& CurId, double& CurDist) const {
+
+    bool ChangedP = true;
+    while (ChangedP) {
+        ChangedP = false;
+        const TIntV& LinkV = LinkVVV[CurId][Layer];
+        for (int LinkN = 0; LinkN < LinkV.Len(); LinkN++) {
+            const int NeighId = LinkV[LinkN];
+            const double Dist = GetDist(VecV, Vec, Norm, NeighId);
+            if (Dist < CurDist) { CurId = NeighId; CurDist = Dist; ChangedP = true; }
+        }
+    }
+}
+
+void THnswIndex::SearchLayer(const TVec<TIntFltKdV>& VecV, const TIntFltKdV& Vec, const double& Norm,
+        const int& StartId, const double& StartDist, const int& Ef, const int& Layer,
+        const int& IgnoreId, TFltIntKdV& NearV) const {
+
+    // candidates to expand, keyed by negative distance so the closest is on top
+    THeap<TFltIntKd> CandH;
+    // best elements found so far, the farthest is on top
+    THeap<TFltIntKd> ResH;
+    TIntSet VisitedSet;
+
+    VisitedSet.AddKey(StartId);
+    CandH.PushHeap(TFltIntKd(-StartDist, StartId));
+    if (StartId != IgnoreId && !DelV[StartId]) { ResH.PushHeap(TFltIntKd(StartDist, StartId)); }
+    while (!CandH.Empty()) {
+        const TFltIntKd Cand = CandH.PopHeap();
+        // all remaining candidates are farther than the worst result
+        if (ResH.Len() >= Ef && -Cand.Key > ResH.TopHeap().Key) { break; }
+        const TIntV& LinkV = LinkVVV[Cand.Dat][Layer];
+        for (int LinkN = 0; LinkN < LinkV.Len(); LinkN++) {
+            const int NeighId = LinkV[LinkN];
+            if (VisitedSet.IsKey(NeighId)) { continue; }
+            VisitedSet.AddKey(NeighId);
+            const double Dist = GetDist(VecV, Vec, Norm, NeighId);
+            if (ResH.Len() < Ef || Dist < ResH.TopHeap().Key) {
+                CandH.PushHeap(TFltIntKd(-Dist, NeighId));
+                // removed and ignored elements only help navigation
+                if (NeighId == IgnoreId || DelV[NeighId]) { continue; }
+                ResH.PushHeap(TFltIntKd(Dist, NeighId));
+                if (ResH.Len() > Ef) { ResH.PopHeap(); }
+            }
+        }
+    }
+    NearV = ResH();
+    NearV.Sort(true);
+}
+
+void THnswIndex::SelectNeighbors(const TVec<TIntFltKdV>& VecV, const TFltIntKdV& CandV,
+        const int& MxLinks, TIntV& NeighV) const {
+
+    NeighV.Clr();
+    // take candidates in order of distance, skipping those that are closer to an
+    // already selected neighbor than to the element; this keeps links in all directions
+    for (int CandN = 0; CandN < CandV.Len() && NeighV.Len() < MxLinks; CandN++) {
+        const int CandId = CandV[CandN].Dat;
+        const TIntFltKdV& CandVec = VecV[CandId];
+        bool KeepP = true;
+        for (int NeighN = 0; NeighN < NeighV.Len(); NeighN++) {
+            if (GetDist(VecV, CandVec, NormV[CandId], NeighV[NeighN]) < CandV[CandN].Key) {
+                KeepP = false; break;
+            }
+        }
+        if (KeepP) { NeighV.Add(CandId); }
+    }
+}
+
+void THnswIndex::AddLink(const TVec<TIntFltKdV>& VecV, const int& FromId, const int& ToId, const int& Layer) {
+    TIntV& LinkV = LinkVVV[FromId][Layer];
+    if (LinkV.IsIn(ToId)) { return; }
+    if (LinkV.Len() < GetMxLinks(Layer)) { LinkV.Add(ToId); return; }
+    // over capacity, select again among the old links and the new one
+    const TIntFltKdV& Vec = VecV[FromId];
+    TFltIntKdV CandV(LinkV.Len() + 1, 0);
+    CandV.Add(TFltIntKd(GetDist(VecV, Vec, NormV[FromId], ToId), ToId));
+    for (int LinkN = 0; LinkN < LinkV.Len(); LinkN++) {
+        CandV.Add(TFltIntKd(GetDist(VecV, Vec, NormV[FromId], LinkV[LinkN]), LinkV[LinkN]));
+    }
+    CandV.Sort(true);
+    SelectNeighbors(VecV, CandV, GetMxLinks(Layer), LinkV);
+}
+
+void THnswIndex::Link(const TVec<TIntFltKdV>& VecV, const int& ElId, TFltIntKdV& NearV) {
+    NearV.Clr();
+    // first element becomes the entry point
+    if (EntryId == -1 || EntryId == ElId) { EntryId = ElId; return; }
+
+    const TIntFltKdV& Vec = VecV[ElId];
+    const double Norm = NormV[ElId];
+    const int Level = LevelV[ElId];
+    const int TopLevel = LevelV[EntryId];
+    // descend through the layers above the element's top layer
+    int CurId = EntryId; double CurDist = GetDist(VecV, Vec, Norm, CurId);
+    for (int Layer = TopLevel; Layer > Level; Layer--) {
+        SearchLayerGreedy(VecV, Vec, Norm, Layer, CurId, CurDist);
+    }
+    // connect on the remaining layers
+    for (int Layer = TInt::GetMn(Level, TopLevel); Layer >= 0; Layer--) {
+        SearchLayer(VecV, Vec, Norm, CurId, CurDist, EfConstruction, Layer, ElId, NearV);
+        TIntV& LinkV = LinkVVV[ElId][Layer];
+        SelectNeighbors(VecV, NearV, M, LinkV);
+        for (int LinkN = 0; LinkN < LinkV.Len(); LinkN++) {
+            AddLink(VecV, LinkV[LinkN], ElId, Layer);
+        }
+        // continue on the lower layer from the closest element
+        if (!NearV.Empty()) { CurId = NearV[0].Dat; CurDist = NearV[0].Key; }
+    }
+    if (Level > TopLevel) { EntryId = ElId; }
+}
+
+THnswIndex::THnswIndex(const int& _M, const int& _EfConstruction, const int& _EfSearch):
+        M(_M), EfConstruction(_EfConstruction), EfSearch(_EfSearch), EntryId(-1), Rnd(0) {
+
+    EAssertR(M >= 2, "THnswIndex: M must be at least 2");
+    EAssertR(EfConstruction >= 1 && EfSearch >= 1, "THnswIndex: candidate list sizes must be positive");
+}
+
+THnswIndex::THnswIndex(TSIn& SIn): M(SIn), EfConstruction(SIn), EfSearch(SIn), NormV(SIn),
+    LevelV(SIn), LinkVVV(SIn), DelV(SIn), EntryId(SIn), Rnd(SIn) { }
+
+void THnswIndex::Save(TSOut& SOut) const {
+    M.Save(SOut);
+    EfConstruction.Save(SOut);
+    EfSearch.Save(SOut);
+    NormV.Save(SOut);
+    LevelV.Save(SOut);
+    LinkVVV.Save(SOut);
+    DelV.Save(SOut);
+    EntryId.Save(SOut);
+    Rnd.Save(SOut);
+}
+
+void THnswIndex::Add(const TVec<TIntFltKdV>& VecV, const int& ElId, TFltIntKdV& NearV) {
+    EAssertR(ElId == Len(), "THnswIndex::Add: elements must be added in order");
+    const int Level = GetRndLevel();
+    NormV.Add(TLinAlg::Norm2(VecV[ElId]));
+    LevelV.Add(Level);
+    LinkVVV.Add(TVec<TIntV>(Level + 1));
+    DelV.Add(false);
+    Link(VecV, ElId, NearV);
+}
+
+void THnswIndex::Replace(const TVec<TIntFltKdV>& VecV, const int& ElId, TFltIntKdV& NearV) {
+    NormV[ElId] = TLinAlg::Norm2(VecV[ElId]);
+    DelV[ElId] = false;
+    // drop the links of the old vector; its neighbors lose their link to it, so give
+    // each of them the closest of the other old neighbors instead
+    for (int Layer = 0; Layer <= LevelV[ElId]; Layer++) {
+        TIntV OldNeighV = LinkVVV[ElId][Layer];
+        LinkVVV[ElId][Layer].Clr();
+        for (int NeighN = 0; NeighN < OldNeighV.Len(); NeighN++) {
+            const int NeighId = OldNeighV[NeighN];
+            TIntV& LinkV = LinkVVV[NeighId][Layer];
+            const int LinkN = LinkV.SearchForw(ElId);
+            if (LinkN == -1) { continue; }
+            LinkV.Del(LinkN);
+            const TIntFltKdV& NeighVec = VecV[NeighId];
+            int BestId = -1; double BestDist = TFlt::Mx;
+            for (int OtherN = 0; OtherN < OldNeighV.Len(); OtherN++) {
+                const int OtherId = OldNeighV[OtherN];
+                if (OtherId == NeighId || DelV[OtherId] || LinkV.IsIn(OtherId)) { continue; }
+                const double Dist = GetDist(VecV, NeighVec, NormV[NeighId], OtherId);
+                if (Dist < BestDist) { BestId = OtherId; BestDist = Dist; }
+            }
+            if (BestId != -1) { LinkV.Add(BestId); }
+        }
+    }
+    // searches cannot start from the element being relinked, pick another on the highest layer
+    if (EntryId == ElId) {
+        for (int OtherId = 0; OtherId < Len(); OtherId++) {
+            if (OtherId == ElId) { continue; }
+            if (EntryId == ElId || LevelV[OtherId] > LevelV[EntryId]) { EntryId = OtherId; }
+        }
+    }
+    Link(VecV, ElId, NearV);
+}
+
+void THnswIndex::Search(const TVec<TIntFltKdV>& VecV, const TIntFltKdV& Vec, const int& K,
+        TFltIntKdV& NearV, const int& IgnoreId) const {
+
+    NearV.Clr();
+    if (EntryId == -1) { return; }
+    const double Norm = TLinAlg::Norm2(Vec);
+    int CurId = EntryId; double CurDist = GetDist(VecV, Vec, Norm, CurId);
+    for (int Layer = LevelV[EntryId]; Layer > 0; Layer--) {
+        SearchLayerGreedy(VecV, Vec, Norm, Layer, CurId, CurDist);
+    }
+    SearchLayer(VecV, Vec, Norm, CurId, CurDist, TInt::GetMx(EfSearch, K), 0, IgnoreId, NearV);
+    if (NearV.Len() > K) { NearV.Del(K, NearV.Len() - 1); }
+}
+
 /////////////////////////////////////////////
 /// Nearest Neighbor based Annomaly Detection.
+void TNearestNeighbor::GetNearest(const TIntFltKdV& Vec, int& NearColN, double& NearDist,
+        const int& IgnoreColId) const {
+
+    NearColN = -1; NearDist = TFlt::Mx;
+    if (UseAnn()) {
+        TFltIntKdV NearV;
+        Index.Search(Mat, Vec, 1, NearV, IgnoreColId);
+        if (!NearV.Empty()) { NearColN = NearV[0].Dat; NearDist = NearV[0].Key; }
+        return;
+    }
+    const double Norm = TLinAlg::Norm2(Vec);
+    for (int ColN = 0; ColN < Mat.Len(); ColN++) {
+        if (ColN == IgnoreColId) { continue; }
+        const double Dist = Norm - 2 * TLinAlg::DotProduct(Vec, Mat[ColN]) + TLinAlg::Norm2(Mat[ColN]);
+        if (Dist < NearDist) { NearColN = ColN; NearDist = Dist; }
+    }
+}
+
+void TNearestNeighbor::UpdateDistance(const int& ColId, const TFltIntKdV& NearV) {
+    if (!UseAnn()) { UpdateDistance(ColId); return; }
+    // new vector can only become the nearest neighbor of its own neighbors
+    for (int NearN = 0; NearN < NearV.Len(); NearN++) {
+        const int ColN = NearV[NearN].Dat;
+        const double Dist = NearV[NearN].Key;
+        if (Dist < DistV[ColN]) { DistV[ColN] = Dist; DistColV[ColN] = ColId; }
+    }
+    // remember new neighbor
+    DistV[ColId] = NearV.Empty() ? TFlt::Mx : NearV[0].Key.Val;
+    DistColV[ColId] = NearV.Empty() ? -1 : NearV[0].Dat.Val;
+}
+
 void TNearestNeighbor::UpdateDistance(const int& ColId, const int& IgnoreCol) {
+    if (UseAnn()) {
+        // ignored column was already removed from the index
+        int NearColN; double NearDist;
+        GetNearest(Mat[ColId], NearColN, NearDist, ColId);
+        DistV[ColId] = NearDist;
+        DistColV[ColId] = NearColN;
+        return;
+    }
     // get vector we update distances for and precompute its norm
     const TIntFltKdV& ColVec = Mat[ColId];
     const double ColNorm = TLinAlg::Norm2(ColVec);
@@ -36,17 +283,26 @@ void TNearestNeighbor::UpdateDistance(const int& ColId, const int& IgnoreCol) {
 void TNearestNeighbor::UpdateThreshold() {
     ThresholdV.Gen(RateV.Len(), 0);
     // sort distances
-    TFltV SortedV = DistV; SortedV.Sort(true);
+    TFltV SortedV = DistV; TRnd Rnd(1);
     // establish thrashold for each rate
     for (const double Rate : RateV) {
         // element Id corresponding to Rate-th percentile
         const int Elt = (int)floor((1.0 - Rate) * SortedV.Len());
+        // partition around it instead of sorting, as on each update only
+        // the element at position Elt is needed
+        int MnValN = 0, MxValN = SortedV.Len() - 1;
+        while (MnValN < MxValN) {
+            const int SplitValN = SortedV.Partition(MnValN, MxValN, true, Rnd);
+            if (Elt <= SplitValN) { MxValN = SplitValN; } else { MnValN = SplitValN + 1; }
+        }
         // remember the distance as threshold
         ThresholdV.Add(SortedV[Elt]);
     }
 }
 
 void TNearestNeighbor::Forget(const int& ColId) {
+    // vector should not be found by the index anymore
+    if (AnnP) { Index.Del(ColId); }
     // identify which vectors we should update
     TIntV CheckV;
     for (int ColN = 0; ColN < Mat.Len(); ColN++) {
@@ -62,8 +318,9 @@ void TNearestNeighbor::Forget(const int& ColId) {
     }
 }
 
-TNearestNeighbor::TNearestNeighbor(const TFltV& _RateV, const int& _WindowSize):
-        RateV(_RateV), WindowSize(_WindowSize) {
+TNearestNeighbor::TNearestNeighbor(const TFltV& _RateV, const int& _WindowSize, const int& AnnEfSearch,
+        const int& AnnM, const int& AnnEfConstruction): RateV(_RateV), WindowSize(_WindowSize),
+        AnnP(AnnEfSearch > 0) {
 
     // assert rate parameter range
     for (const double Rate : RateV) {
@@ -74,12 +331,36 @@ TNearestNeighbor::TNearestNeighbor(const TFltV& _RateV, const int& _WindowSize):
     DistV.Gen(WindowSize, 0);
     DistColV.Gen(WindowSize, 0);
 	IDVec.Gen(WindowSize, 0);
+    // prepare approximate index
+    if (AnnP) { Index = THnswIndex(AnnM, AnnEfConstruction, AnnEfSearch); }
 }
 
-TNearestNeighbor::TNearestNeighbor(TSIn& SIn): RateV(SIn), WindowSize(SIn), Mat(SIn),
-    DistV(SIn), DistColV(SIn), ThresholdV(SIn), InitVecs(SIn), NextCol(SIn), IDVec(SIn) { }
+TNearestNeighbor::TNearestNeighbor(TSIn& SIn) {
+    // models saved before the approximate index was added start with the
+    // (non-negative) capacity of the rate vector, newer ones with -1
+    const int Format = TInt(SIn);
+    if (Format >= 0) {
+        const int Rates = TInt(SIn); RateV.Gen(Rates);
+        for (int RateN = 0; RateN < Rates; RateN++) { RateV[RateN] = TFlt(SIn); }
+    } else {
+        RateV.Load(SIn);
+    }
+    WindowSize.Load(SIn);
+    Mat.Load(SIn);
+    DistV.Load(SIn);
+    DistColV.Load(SIn);
+    ThresholdV.Load(SIn);
+    InitVecs.Load(SIn);
+    NextCol.Load(SIn);
+    IDVec.Load(SIn);
+    if (Format < 0) {
+        AnnP.Load(SIn);
+        if (AnnP) { Index = THnswIndex(SIn); }
+    }
+}
 
 void TNearestNeighbor::Save(TSOut& SOut) {
+    TInt(-1).Save(SOut);
     RateV.Save(SOut);
     WindowSize.Save(SOut);
     Mat.Save(SOut);
@@ -89,6 +370,8 @@ void TNearestNeighbor::Save(TSOut& SOut) {
     InitVecs.Save(SOut);
     NextCol.Save(SOut);
 	IDVec.Save(SOut);
+    AnnP.Save(SOut);
+    if (AnnP) { Index.Save(SOut); }
 }
 
 void TNearestNeighbor::PartialFit(const TIntFltKdV& Vec, const int& RecId) {
@@ -99,7 +382,12 @@ void TNearestNeighbor::PartialFit(const TIntFltKdV& Vec, const int& RecId) {
         // make sure we are very far from everything for update distance to kick in
         DistV.Add(TFlt::Mx); DistColV.Add(InitVecs);
         // update distance for new vector
-        UpdateDistance(InitVecs);
+        if (AnnP) {
+            TFltIntKdV NearV; Index.Add(Mat, InitVecs, NearV);
+            UpdateDistance(InitVecs, NearV);
+        } else {
+            UpdateDistance(InitVecs);
+        }
         // move onwards
         InitVecs++;
         // check if we are initialized
@@ -113,7 +401,12 @@ void TNearestNeighbor::PartialFit(const TIntFltKdV& Vec, const int& RecId) {
         DistV[NextCol] = TFlt::Mx;
         DistColV[NextCol] = NextCol;
         // update distance for overwriten vector
-        UpdateDistance(NextCol);
+        if (AnnP) {
+            TFltIntKdV NearV; Index.Replace(Mat, NextCol, NearV);
+            UpdateDistance(NextCol, NearV);
+        } else {
+            UpdateDistance(NextCol);
+        }
         // establish new threshold
         UpdateThreshold();
         // move onwards
@@ -123,11 +416,8 @@ void TNearestNeighbor::PartialFit(const TIntFltKdV& Vec, const int& RecId) {
 }
 
 double TNearestNeighbor::DecisionFunction(const TIntFltKdV& Vec) const {
-    double NearDist = TFlt::Mx;
-    for (const TIntFltKdV& Col : Mat) {
-        const double Dist = TLinAlg::Norm2(Vec) - 2 * TLinAlg::DotProduct(Vec, Col) + TLinAlg::Norm2(Col);
-        if (Dist < NearDist) { NearDist = Dist; }
-    }
+    int NearColN; double NearDist;
+    GetNearest(Vec, NearColN, NearDist);
     return NearDist;
 }
 
@@ -147,11 +437,8 @@ PJsonVal TNearestNeighbor::Explain(const TIntFltKdV& Vec) const {
 	// if not initialized, return null (JSON)
 	if (!IsInit()) { return TJsonVal::NewNull(); }
 	// find nearest neighbor
-	double NearDist = TFlt::Mx; int NearColN = -1;
-	for (int ColN = 0; ColN < Mat.Len(); ColN++) {
-		const double Dist = TLinAlg::Norm2(Vec) - 2 * TLinAlg::DotProduct(Vec, Mat[ColN]) + TLinAlg::Norm2(Mat[ColN]);
-		if (Dist < NearDist) { NearDist = Dist; NearColN = ColN; }
-	}
+	int NearColN; double NearDist;
+	GetNearest(Vec, NearColN, NearDist);
     const TIntFltKdV& NearVec = Mat[NearColN];
 	// generate JSon explanations
 	PJsonVal ResVal = TJsonVal::NewObj();
@@ -10,6 +10,86 @@
 /// Annomaly Detection methods
 namespace TAnomalyDetection {
 
+/////////////////////////////////////////////
+/// Hierarchical Navigable Small World graph (Malkov and Yashunin, 2016).
+/// Approximate nearest neighbor index over sparse vectors using squared Euclidean
+/// distance. The index keeps only the graph and the norms; the vectors are owned by
+/// the caller and passed to each call, elements are identified by their position.
+/// An element can be removed and overwritten in place, which is what a sliding
+/// window needs.
+class THnswIndex {
+private:
+    /// Maximal number of links per element on the upper layers, layer 0 allows 2*M
+    TInt M;
+    /// Size of the candidate list when linking new elements
+    TInt EfConstruction;
+    /// Size of the candidate list when searching, trades recall for speed
+    TInt EfSearch;
+    /// Squared norm of each element
+    TFltV NormV;
+    /// Top layer of each element
+    TIntV LevelV;
+    /// Links of each element, one vector of neighbor ids per layer
+    TVec<TVec<TIntV> > LinkVVV;
+    /// Removed elements, still used for navigation but never returned
+    TBoolV DelV;
+    /// Element on the top layer where all searches start (-1 when empty)
+    TInt EntryId;
+    /// Random generator for layer assignment
+    TRnd Rnd;
+
+    /// Squared distance between Vec (with squared norm Norm) and element ElId
+    double GetDist(const TVec<TIntFltKdV>& VecV, const TIntFltKdV& Vec,
+        const double& Norm, const int& ElId) const;
+    /// Maximal number of links of an element on the given layer
+    int GetMxLinks(const int& Layer) const { return Layer == 0 ? 2 * M : M.Val; }
+    /// Draw the top layer for a new element
+    int GetRndLevel();
+    /// Greedy walk towards Vec on a single layer, updates CurId and CurDist
+    void SearchLayerGreedy(const TVec<TIntFltKdV>& VecV, const TIntFltKdV& Vec,
+        const double& Norm, const int& Layer, int& CurId, double& CurDist) const;
+    /// Best-first search on a single layer, returns up to Ef elements sorted by distance.
+    /// Removed elements and IgnoreId are traversed but not returned.
+    void SearchLayer(const TVec<TIntFltKdV>& VecV, const TIntFltKdV& Vec, const double& Norm,
+        const int& StartId, const double& StartDist, const int& Ef, const int& Layer,
+        const int& IgnoreId, TFltIntKdV& NearV) const;
+    /// Pick at most MxLinks diverse neighbors from candidates sorted by distance
+    void SelectNeighbors(const TVec<TIntFltKdV>& VecV, const TFltIntKdV& CandV,
+        const int& MxLinks, TIntV& NeighV) const;
+    /// Add link FromId -> ToId, prune the links of FromId when over capacity
+    void AddLink(const TVec<TIntFltKdV>& VecV, const int& FromId, const int& ToId, const int& Layer);
+    /// Connect element ElId to the graph on all its layers, NearV gets the closest
+    /// elements found on the bottom layer
+    void Link(const TVec<TIntFltKdV>& VecV, const int& ElId, TFltIntKdV& NearV);
+
+public:
+    THnswIndex(): M(16), EfConstruction(100), EfSearch(50), EntryId(-1), Rnd(0) { }
+    THnswIndex(const int& _M, const int& _EfConstruction, const int& _EfSearch);
+
+    THnswIndex(TSIn& SIn);
+    void Save(TSOut& SOut) const;
+
+    /// Number of elements, including the removed ones
+    int Len() const { return NormV.Len(); }
+    /// Index element VecV[ElId], where ElId must equal Len(). NearV gets up to EfConstruction
+    /// closest elements found while linking, as (distance, id) pairs sorted by distance.
+    void Add(const TVec<TIntFltKdV>& VecV, const int& ElId, TFltIntKdV& NearV);
+    /// Exclude element from search results until it is replaced
+    void Del(const int& ElId) { DelV[ElId] = true; }
+    /// Element VecV[ElId] was overwritten with a new vector, relink it. NearV as in Add.
+    void Replace(const TVec<TIntFltKdV>& VecV, const int& ElId, TFltIntKdV& NearV);
+    /// Approximate K nearest elements to Vec as (distance, id) pairs sorted by distance,
+    /// element IgnoreId is never returned
+    void Search(const TVec<TIntFltKdV>& VecV, const TIntFltKdV& Vec, const int& K,
+        TFltIntKdV& NearV, const int& IgnoreId = -1) const;
+
+    // parameters
+    int GetM() const { return M; }
+    int GetEfConstruction() const { return EfConstruction; }
+    int GetEfSearch() const { return EfSearch; }
+    void SetEfSearch(const int& _EfSearch) { EfSearch = _EfSearch; }
+};
+
 /////////////////////////////////////////////
 /// Nearest Neighbor based Annomaly Detection.
 /// Anomaly detector that checks if the test point is too far from the nearest known point/.
@@ -33,9 +113,20 @@ private:
     TInt NextCol;
 	/// ID vector
 	TIntV IDVec;
-    
+    /// Use the approximate index instead of scanning all the columns
+    TBool AnnP;
+    /// Approximate nearest neighbor index over the columns of Mat
+    THnswIndex Index;
+
+    /// Can queries go through the index, for small neighborhoods the exact scan is as fast
+    bool UseAnn() const { return AnnP && Mat.Len() > Index.GetEfSearch(); }
+    /// Nearest column to Vec, ignoring column IgnoreColId
+    void GetNearest(const TIntFltKdV& Vec, int& NearColN, double& NearDist, const int& IgnoreColId = -1) const;
     /// Update all distances as if Mat[ColId] is new vector, ignoring column IgnoreColId
     void UpdateDistance(const int& ColId, const int& IgnoreColId = -1);
+    /// Same as UpdateDistance for a new vector Mat[ColId] with neighbors NearV found by the
+    /// index; only these are checked for having Mat[ColId] as their new nearest neighbor
+    void UpdateDistance(const int& ColId, const TFltIntKdV& NearV);
     /// Forget vector Mat[ColId] from the nearest neighbors
     void Forget(const int& ColId);
     /// Update thresholds
@@ -43,7 +134,10 @@ private:
 
 public:
     TNearestNeighbor() { }
-    TNearestNeighbor(const TFltV& _RateV, const int& WindowSize);
+    /// AnnEfSearch > 0 enables the approximate index with the given search list size
+    /// (higher is more accurate and slower), 0 keeps exact search over the whole window
+    TNearestNeighbor(const TFltV& _RateV, const int& WindowSize, const int& AnnEfSearch = 0,
+        const int& AnnM = 16, const int& AnnEfConstruction = 100);
 
     TNearestNeighbor(TSIn& SIn);
     void Save(TSOut& SOut);
@@ -68,6 +162,8 @@ public:
     double GetRate(const int& RateN) const { return RateV[RateN]; }
     double GetThreshold(const int& RateN) const { return IsInit() ? ThresholdV[RateN].Val : 0.0; }
     int GetWindowSize() const { return WindowSize; }
+    bool IsAnn() const { return AnnP; }
+    const THnswIndex& GetIndex() const { return Index; }
 };
 
 };
\ No newline at end of file
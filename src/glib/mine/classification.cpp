@@ -35,21 +35,16 @@ void TLogReg::Save(TSOut& SOut) const {
 }
 
 
-void TLogReg::Fit(const TFltVV& _X, const TFltV& y, const double& Eps) {
-	TFltVV X(_X);
-
-	if (IncludeIntercept) {
-		// add 1s into the last row
-		X.AddXDim();
-		for (int i = 0; i < X.GetCols(); i++) {
-			X(X.GetRows()-1, i) = 1;
-		}
-	}
+void TLogReg::Fit(const TFltVV& X, const TFltV& y, const double& Eps, const bool& WarmStart) {
+	Fit(TFltVVBatchSrc::New(X), y, Eps, WarmStart);
+}
 
-	const int NInst = X.GetCols();
-	const int Dim = X.GetRows();
-	const int OrigDim = IncludeIntercept ? Dim-1 : Dim;
-	EAssertR(NInst == y.Len(), "TLogReg::Fit the number of instances in X.GetCols() and y.Len() do not match");
+void TLogReg::Fit(const PFtrBatchSrc& BatchSrc, const TFltV& y, const double& Eps,
+		const bool& WarmStart) {
+	const int NInst = BatchSrc->GetInsts();
+	const int OrigDim = BatchSrc->GetDim();
+	const int Dim = IncludeIntercept ? OrigDim+1 : OrigDim;
+	EAssertR(NInst == y.Len(), "TLogReg::Fit the number of instances and y.Len() do not match");
 	// minimize the following objective function:
 	// L(w) = (sum(log(1 + exp(w*x_i)) - y_i*w*x_i) + lambda*beta*beta'/2) / m
 	// using Newton-Raphson algorithm:
@@ -58,26 +53,23 @@ void TLogReg::Fit(const TFltVV& _X, const TFltV& y, const double& Eps) {
 	// H(w) = X*W*X^(-1) + lambda*I
 	// where H is the Hessian at point w, g is the gradient of the objective function at point w
 	// W is a diagonal matrix defined as W_ii = p_i(1 - p_i)
+	// H and g are sums over instances, so we go over the instances in chunks
 
 	// temporary variables
 	TFltV ProbV(NInst, NInst);					// vector of probabilities
 	TFltV PrevProbV(NInst, NInst);				// vector of probs in the previous step, used to terminate the procedure
 	TFltV DeltaWgtV(Dim, Dim);					// the step used to update the weights
-	TFltV YMinP(NInst, NInst);
 	TFltV GradV(Dim, Dim);						// gradient
-	TFltVV XTimesW(Dim, NInst);					// temporary variable to compute (X*W)*X'
 	TFltVV H(Dim, Dim);							// Hessian
-	TFltVV X_t(X.GetCols(), X.GetRows());	TLinAlg::Transpose(X, X_t);		// the transposed instance matrix
-	TVec<TIntFltKdV> WgtColSpVV(NInst, NInst);	// weight matrix
+	const int ChunkInsts = BatchSrc->GetPassInsts();
+	TFltVV X;									// instances of the current chunk
+	TFltV ChunkProbV, YMinP, SqrtWV, ChunkGradV(Dim);
 
-	// generate weight matrix with only ones on the diagonal
-	// so you don't recreate all the object every iteration
-	for (int i = 0; i < NInst; i++) {
-		WgtColSpVV[i].Add(TIntFltKd(i, 1));
+	// a warm start is only possible from weights of the same dimension
+	if (!WarmStart || WgtV.Len() != Dim) {
+		WgtV.Gen(Dim);
 	}
 
-	WgtV.Gen(Dim);
-
 	// perform the algorithm
 	double Diff = TFlt::NInf;
 	double AbsDiff;
@@ -87,31 +79,52 @@ void TLogReg::Fit(const TFltVV& _X, const TFltV& y, const double& Eps) {
 			Notify->OnNotifyFmt(TNotifyType::ntInfo, "Step: %d, diff: %.3f", k, Diff);
 		}
 
-		// compute the probabilities p_i = 1 / (1 + exp(-w*x_i)) and
-		// compute the weight matrix diagonal W_ii = p_i(1 - p_i)
-		TLinAlg::Multiply(X_t, WgtV, ProbV);
-		for (int i = 0; i < NInst; i++) {
-			ProbV[i] = 1 / (1 + TMath::Power(TMath::E, -ProbV[i]));
-			WgtColSpVV[i][0].Dat = ProbV[i]*(1 - ProbV[i]);
-		}
+		H.PutAll(0); GradV.PutAll(0);
+		for (int FirstInstN = 0; FirstInstN < NInst; FirstInstN += ChunkInsts) {
+			const int Insts = TInt::GetMn(ChunkInsts, NInst - FirstInstN);
+			BatchSrc->GetRange(FirstInstN, Insts, X);
+			if (IncludeIntercept) {
+				// add 1s into the last row
+				X.AddXDim();
+				for (int i = 0; i < Insts; i++) {
+					X(Dim-1, i) = 1;
+				}
+			}
 
-		// compute the Hessian H = X*W*X' + lambda*I
-		// 1) compute X*W
-		TLinAlg::Multiply(X, WgtColSpVV, XTimesW);
-		// 2) compute H = (X*W)*X'
-		TLinAlg::Multiply(XTimesW, X_t, H);
-		// 3) add lambda to the diagonal of H, exclude the punishment for the intercept
-		for (int i = 0; i < OrigDim; i++) {
-			H(i,i) += Lambda;
-		}
+			const bool ParP = (int64) Insts * Dim >= ParMnEls;
+
+			// compute the probabilities p_i = 1 / (1 + exp(-w*x_i))
+			TLinAlg::MultiplyT(X, WgtV, ChunkProbV);
+			YMinP.Gen(Insts);
+			SqrtWV.Gen(Insts);
+			#pragma omp parallel for if(ParP) schedule(static)
+			for (int i = 0; i < Insts; i++) {
+				ChunkProbV[i] = 1 / (1 + TMath::Power(TMath::E, -ChunkProbV[i]));
+				ProbV[FirstInstN + i] = ChunkProbV[i];
+				// compute (y - p)
+				YMinP[i] = y[FirstInstN + i] - ChunkProbV[i];
+				SqrtWV[i] = TMath::Sqrt(ChunkProbV[i]*(1 - ChunkProbV[i]));
+			}
 
-		// compute the gradient g(w) = X*(y - p)' + lambda * w
-		// 1) compute (y - p)
-		TLinAlg::LinComb(1, y, -1, ProbV, YMinP);
-		// 2) compute X*(y - p)
-		TLinAlg::Multiply(X, YMinP, GradV);
-		// 3) add lambda * w, exclude the punishment for the intercept
+			// compute the gradient part X*(y - p)'
+			TLinAlg::Multiply(X, YMinP, ChunkGradV);
+			TLinAlg::AddVec(1.0, ChunkGradV, GradV, GradV);
+
+			// compute the Hessian part X*W*X' = (X*sqrt(W))*(X*sqrt(W))',
+			// where W_ii = p_i(1 - p_i), the Hessian is symmetric so only
+			// half of the product is computed
+			#pragma omp parallel for if(ParP) schedule(static)
+			for (int j = 0; j < Dim; j++) {
+				for (int i = 0; i < Insts; i++) {
+					X(j, i) *= SqrtWV[i];
+				}
+			}
+			TLinAlg::AddGram(X, H);
+		}
+		// add lambda to the diagonal of H and lambda * w to the gradient,
+		// exclude the punishment for the intercept
 		for (int i = 0; i < OrigDim; i++) {
+			H(i,i) += Lambda;
 			GradV[i] += Lambda*WgtV[i];
 		}
 
@@ -501,7 +514,7 @@ void TDecisionTree::TNode::Fit(const TFltVV& FtrVV, const TFltV& ClassV, const T
 
 	{
 		int TotalPos = 0;
-		double BestScore = TFlt::NInf, CutVal = TFlt::NInf, Score = TFlt::NInf;
+		double BestScore = TFlt::NInf;
 
 		for (int i = 0; i < NExamples; i++) {
 			AssertR(0 <= InstNV[i] && InstNV[i] < FtrVV.GetCols(), "Invalid instance index: " + TInt::GetStr(InstNV[i]) + "!");
@@ -511,32 +524,51 @@ void TDecisionTree::TNode::Fit(const TFltVV& FtrVV, const TFltV& ClassV, const T
 		ClassHist[0] = 1 - double(TotalPos) / NExamples;
 		ClassHist[1] = 1 - ClassHist[0];
 
-		TFltIntPrV ValClassPrV(NExamples);
+		// find the best cut of each feature, the features are independent so
+		// the search is done in parallel on large nodes
+		TFltV FtrScoreV(Dim), FtrCutValV(Dim);
 
-		// get the best score and cut value
-		int InstN;
-		for (int FtrN = 0; FtrN < Dim; FtrN++) {
-			double FtrSum = 0;
+		#pragma omp parallel if((int64) NExamples * Dim >= ParMnEls)
+		{
+			TFltIntPrV ValClassPrV(NExamples);
 
-			for (int i = 0; i < NExamples; i++) {
-				InstN = InstNV[i];
+			int InstN;
+			double CutVal, Score;
 
-				AssertR(0 <= InstN && InstN < FtrVV.GetCols(), "Invalid instance index: " + TInt::GetStr(InstN) + "!");
+			#pragma omp for schedule(dynamic)
+			for (int FtrN = 0; FtrN < Dim; FtrN++) {
+				double FtrSum = 0;
 
-				ValClassPrV[i].Val1 = FtrVV(FtrN, InstN);
-				ValClassPrV[i].Val2 = (int) ClassV[InstN];
-				FtrSum += FtrVV(FtrN, InstN);
-			}
+				for (int i = 0; i < NExamples; i++) {
+					InstN = InstNV[i];
 
-			ValClassPrV.Sort(true);	// have to sort to speed up the calculation
+					AssertR(0 <= InstN && InstN < FtrVV.GetCols(), "Invalid instance index: " + TInt::GetStr(InstN) + "!");
 
-			if (CanSplitNumFtr(ValClassPrV, TotalPos, CutVal, Score) && Score > BestScore) {
-				BestScore = Score;
-				CutFtrN = FtrN;
-				CutFtrVal = CutVal;
+					ValClassPrV[i].Val1 = FtrVV(FtrN, InstN);
+					ValClassPrV[i].Val2 = (int) ClassV[InstN];
+					FtrSum += FtrVV(FtrN, InstN);
+				}
+
+				ValClassPrV.Sort(true);	// have to sort to speed up the calculation
+
+				if (CanSplitNumFtr(ValClassPrV, TotalPos, CutVal, Score)) {
+					FtrScoreV[FtrN] = Score;
+					FtrCutValV[FtrN] = CutVal;
+				} else {
+					FtrScoreV[FtrN] = TFlt::NInf;
+				}
+
+				FtrHist[FtrN] = FtrSum / NExamples;
 			}
+		}
 
-			FtrHist[FtrN] = FtrSum / NExamples;
+		// get the best score and cut value, the first feature wins ties
+		for (int FtrN = 0; FtrN < Dim; FtrN++) {
+			if (FtrScoreV[FtrN] > BestScore) {
+				BestScore = FtrScoreV[FtrN];
+				CutFtrN = FtrN;
+				CutFtrVal = FtrCutValV[FtrN];
+			}
 		}
 	}
 
@@ -640,6 +672,48 @@ bool TDecisionTree::TNode::CanSplitNumFtr(const TFltIntPrV& ValClassPrV, const i
 	return Score != TFlt::NInf;
 }
 
+bool TDecisionTree::TNode::CanSplitHist(const TIntV& CountV, const TIntV& PosV, const int& TotalPos,
+		int& CutBinN, double& Score) const {
+	const int Bins = CountV.Len();
+
+	Score = TFlt::NInf;
+	int S0Len = 0;	// the number of instances in the left set
+	int PosS0 = 0;	// the number of positive instances in the left set
+
+	int PrevBinN = -1;
+	for (int BinN = 0; BinN < Bins; BinN++) {
+		const int& Count = CountV[BinN];
+		const int& Pos = PosV[BinN];
+
+		// empty bins do not move the cut
+		if (Count == 0) { continue; }
+
+		if (PrevBinN >= 0) {
+			// as with sorted values, there is no need to cut between two
+			// bins which hold only instances of the same class
+			const int& PrevCount = CountV[PrevBinN];
+			const int& PrevPos = PosV[PrevBinN];
+			const bool SameClassP = (PrevPos == 0 && Pos == 0) ||
+					(PrevPos == PrevCount && Pos == Count);
+
+			if (!SameClassP) {
+				const double CurrScore = Tree->GetSplitScore(S0Len, NExamples - S0Len, PosS0, TotalPos - PosS0);
+
+				if (CurrScore > Score) {
+					Score = CurrScore;
+					CutBinN = PrevBinN;
+				}
+			}
+		}
+
+		S0Len += Count;
+		PosS0 += Pos;
+		PrevBinN = BinN;
+	}
+
+	return Score != TFlt::NInf;
+}
+
 void TDecisionTree::TNode::CalcCorrFtrV(const TFltVV& FtrVV, const TIntV& InstNV) {
 	if (Tree->IsCalcCorr()) {
 		const int Dim = FtrVV.GetRows();
@@ -716,20 +790,94 @@ void TDecisionTree::TNode::CleanUp() {
 
 ///////////////////////////////////////////
 // Decision Tree
+TDecisionTree::TFtrBins::TFtrBins(const TFltVV& FtrVV, const int& MxBins):
+		BinVV(FtrVV.GetRows(), FtrVV.GetCols()),
+		CutValVV(FtrVV.GetRows()) {
+
+	EAssert(0 < MxBins && MxBins <= MxHistBins);
+
+	const int Dim = FtrVV.GetRows();
+	const int NInst = FtrVV.GetCols();
+
+	#pragma omp parallel for schedule(dynamic)
+	for (int FtrN = 0; FtrN < Dim; FtrN++) {
+		TFltV SortedV(NInst);
+		for (int InstN = 0; InstN < NInst; InstN++) {
+			SortedV[InstN] = FtrVV(FtrN, InstN);
+		}
+		SortedV.Sort(true);
+
+		int Distinct = 1;
+		for (int ValN = 1; ValN < NInst; ValN++) {
+			if (SortedV[ValN] != SortedV[ValN-1]) { Distinct++; }
+		}
+
+		// the largest value of each bin except the last one
+		TFltV UpperV;
+		TFltV& CutValV = CutValVV[FtrN];
+
+		if (Distinct <= MxBins) {
+			// one bin per value, the cuts are the same as on sorted values
+			for (int ValN = 1; ValN < NInst; ValN++) {
+				if (SortedV[ValN] != SortedV[ValN-1]) {
+					UpperV.Add(SortedV[ValN-1]);
+					CutValV.Add((SortedV[ValN-1] + SortedV[ValN]) / 2);
+				}
+			}
+		} else {
+			// quantile bins, equal values always fall into the same bin
+			int NextValN = 0;
+			for (int BinN = 1; BinN < MxBins; BinN++) {
+				int ValN = int(int64(BinN) * NInst / MxBins) - 1;
+				if (ValN < NextValN) { continue; }
+
+				while (ValN+1 < NInst && SortedV[ValN+1] == SortedV[ValN]) { ValN++; }
+				if (ValN+1 >= NInst) { break; }
+
+				UpperV.Add(SortedV[ValN]);
+				CutValV.Add((SortedV[ValN] + SortedV[ValN+1]) / 2);
+				NextValN = ValN+1;
+			}
+		}
+
+		// the bin of a value is the first bin whose largest value is not smaller
+		for (int InstN = 0; InstN < NInst; InstN++) {
+			const double Val = FtrVV(FtrN, InstN);
+
+			int MnBinN = 0, MxBinN = UpperV.Len();
+			while (MnBinN < MxBinN) {
+				const int MidBinN = (MnBinN + MxBinN) / 2;
+				if (UpperV[MidBinN] < Val) {
+					MnBinN = MidBinN+1;
+				} else {
+					MxBinN = MidBinN;
+				}
+			}
+
+			BinVV(FtrN, InstN) = TUCh(uchar(MnBinN));
+		}
+	}
+}
+
 TDecisionTree::TDecisionTree(const PDtSplitCriteria& _SplitCriteria, const PDtPruneCriteria& _PruneCriteria,
-			const PDtGrowCriteria& _GrowCriteria, const bool& _CalcCorr):
+			const PDtGrowCriteria& _GrowCriteria, const bool& _CalcCorr, const int& _MxBins):
 		Root(nullptr),
 		SplitCriteria(_SplitCriteria),
 		PruneCriteria(_PruneCriteria),
 		GrowCriteria(_GrowCriteria),
-		CalcCorr(_CalcCorr) {}
+		CalcCorr(_CalcCorr),
+		MxBins() {
+
+	SetMxBins(_MxBins);
+}
 
 TDecisionTree::TDecisionTree(TSIn& SIn):
 		Root(nullptr),
 		SplitCriteria(TDtSplitCriteria::Load(SIn)),
 		PruneCriteria(TDtPruneCriteria::Load(SIn)),
 		GrowCriteria(TDtGrowCriteria::Load(SIn)),
-		CalcCorr(SIn) {
+		CalcCorr(SIn),
+		MxBins() {
 
 	const TBool LoadRoot(SIn);
 	if (LoadRoot) {
@@ -742,7 +890,8 @@ TDecisionTree::TDecisionTree(const TDecisionTree& Other):
 		SplitCriteria(Other.SplitCriteria),
 		PruneCriteria(Other.PruneCriteria),
 		GrowCriteria(Other.GrowCriteria),
-		CalcCorr(Other.CalcCorr) {
+		CalcCorr(Other.CalcCorr),
+		MxBins(Other.MxBins) {
 
 	if (Other.HasRoot()) {
 		Root = new TNode(this);
@@ -756,7 +905,8 @@ TDecisionTree::TDecisionTree(TDecisionTree&& Other):
 		SplitCriteria(),
 		PruneCriteria(),
 		GrowCriteria(),
-		CalcCorr(Other.CalcCorr) {
+		CalcCorr(Other.CalcCorr),
+		MxBins(Other.MxBins) {
 	std::swap(Root, Other.Root);
 	std::swap(SplitCriteria, Other.SplitCriteria);
 	std::swap(PruneCriteria, Other.PruneCriteria);
@@ -776,6 +926,7 @@ TDecisionTree& TDecisionTree::operator =(const TDecisionTree& Tree) {
 		PruneCriteria = Tree.PruneCriteria;
 		GrowCriteria = Tree.GrowCriteria;
 		CalcCorr = Tree.CalcCorr;
+		MxBins = Tree.MxBins;
 
 		if (Tree.HasRoot()) {
 			Root = new TNode(this);
@@ -795,6 +946,7 @@ TDecisionTree& TDecisionTree::operator =(TDecisionTree&& Tree) {
 		std::swap(PruneCriteria, Tree.PruneCriteria);
 		std::swap(GrowCriteria, Tree.GrowCriteria);
 		std::swap(CalcCorr, Tree.CalcCorr);
+		std::swap(MxBins, Tree.MxBins);
 
 		if (HasRoot()) {
 			Root->SetTree(this);
@@ -822,12 +974,21 @@ void TDecisionTree::Save(TSOut& SOut) const {
 void TDecisionTree::Fit(const TFltVV& FtrVV, const TFltV& ClassV, const PNotify& Notify) {
 	Notify->OnNotifyFmt(TNotifyType::ntInfo, "Building a decision tree on %d instances ...", FtrVV.GetCols());
 
-	Grow(FtrVV, ClassV, Notify);
+	if (MxBins > 0) {
+		GrowHist(FtrVV, ClassV, Notify);
+	} else {
+		Grow(FtrVV, ClassV, Notify);
+	}
 	Prune(Notify);
 
 	Notify->OnNotifyFmt(TNotifyType::ntInfo, "Done!");
 }
 
+void TDecisionTree::SetMxBins(const int& _MxBins) {
+	EAssertR(0 <= _MxBins && _MxBins <= MxHistBins, "The number of bins should be between 0 and " + TInt::GetStr(MxHistBins) + "!");
+	MxBins = _MxBins;
+}
+
 double TDecisionTree::Predict(const TFltV& FtrV) const {
 	EAssert(HasRoot());
 	return Root->Predict(FtrV);
@@ -855,6 +1016,165 @@ void TDecisionTree::Grow(const TFltVV& FtrVV, const TFltV& ClassV, const PNotify
 	Root->Fit(FtrVV, ClassV, RangeV);
 }
 
+void TDecisionTree::GrowHist(const TFltVV& FtrVV, const TFltV& ClassV, const PNotify& Notify) {
+	CleanUp();
+
+	const int Dim = FtrVV.GetRows();
+	const int NInst = FtrVV.GetCols();
+
+	EAssertR(NInst > 0, "Cannot grow a decision tree without instances!");
+
+	Notify->OnNotifyFmt(TNotifyType::ntInfo, "Binning %d features into at most %d bins ...", Dim, MxBins.Val);
+	const TFtrBins FtrBins(FtrVV, MxBins);
+
+	// the nodes of the current level and their instances
+	Root = new TNode(this);
+
+	TVec<TNode*> NodeV(1, 0);	NodeV.Add(Root);
+	TVec<TIntV> NodeInstNVV(1);	TLinAlgTransform::RangeV(NInst, NodeInstNVV[0]);
+
+	int Level = 0;
+	while (!NodeV.Empty()) {
+		const int Nodes = NodeV.Len();
+
+		Notify->OnNotifyFmt(TNotifyType::ntInfo, "Splitting %d nodes on level %d ...", Nodes, Level);
+
+		// the class distribution of each node
+		TIntV TotalPosV(Nodes);
+		for (int NodeN = 0; NodeN < Nodes; NodeN++) {
+			TNode* Node = NodeV[NodeN];
+			const TIntV& InstNV = NodeInstNVV[NodeN];
+
+			int TotalPos = 0;
+			for (int i = 0; i < InstNV.Len(); i++) {
+				TotalPos += (int) ClassV[InstNV[i]];
+			}
+
+			Node->NExamples = InstNV.Len();
+			Node->ClassHist.Gen(2);
+			Node->ClassHist[0] = 1 - double(TotalPos) / Node->NExamples;
+			Node->ClassHist[1] = 1 - Node->ClassHist[0];
+			Node->FtrHist.Gen(Dim);
+
+			TotalPosV[NodeN] = TotalPos;
+		}
+
+		// the best cut of each (node, feature) pair, all the pairs
+		// of the level are independent
+		TFltV ScoreV(Nodes*Dim);
+		TIntV CutBinNV(Nodes*Dim);
+
+		#pragma omp parallel for schedule(dynamic)
+		for (int PairN = 0; PairN < Nodes*Dim; PairN++) {
+			const int NodeN = PairN / Dim;
+			const int FtrN = PairN % Dim;
+
+			TNode* Node = NodeV[NodeN];
+			const TIntV& InstNV = NodeInstNVV[NodeN];
+			const int NodeInsts = InstNV.Len();
+
+			double FtrSum = 0;
+			ScoreV[PairN] = TFlt::NInf;
+
+			if (Node->ShouldGrow()) {
+				// the class histogram over the bins of the feature
+				const int Bins = FtrBins.GetBins(FtrN);
+				TIntV CountV(Bins), PosV(Bins);
+
+				int InstN, BinN;
+				for (int i = 0; i < NodeInsts; i++) {
+					InstN = InstNV[i];
+					BinN = FtrBins.BinVV(FtrN, InstN).Val;
+
+					CountV[BinN]++;
+					PosV[BinN] += (int) ClassV[InstN];
+					FtrSum += FtrVV(FtrN, InstN);
+				}
+
+				int CutBinN;
+				double Score;
+				if (Node->CanSplitHist(CountV, PosV, TotalPosV[NodeN], CutBinN, Score)) {
+					ScoreV[PairN] = Score;
+					CutBinNV[PairN] = CutBinN;
+				}
+			} else {
+				for (int i = 0; i < NodeInsts; i++) {
+					FtrSum += FtrVV(FtrN, InstNV[i]);
+				}
+			}
+
+			Node->FtrHist[FtrN] = FtrSum / NodeInsts;
+		}
+
+		// select the best feature of each node, the first feature wins ties
+		// as when growing on sorted values
+		TVec<TNode*> SplitNodeV;
+		TIntV SplitNodeNV, SplitCutBinNV;
+		for (int NodeN = 0; NodeN < Nodes; NodeN++) {
+			TNode* Node = NodeV[NodeN];
+
+			double BestScore = TFlt::NInf;
+			int CutBinN = -1;
+			for (int FtrN = 0; FtrN < Dim; FtrN++) {
+				const int PairN = NodeN*Dim + FtrN;
+				if (ScoreV[PairN] > BestScore) {
+					BestScore = ScoreV[PairN];
+					Node->CutFtrN = FtrN;
+					CutBinN = CutBinNV[PairN];
+				}
+			}
+
+			if (Node->CutFtrN >= 0) {
+				Node->CutFtrVal = FtrBins.CutValVV[Node->CutFtrN][CutBinN];
+				SplitNodeV.Add(Node);
+				SplitNodeNV.Add(NodeN);
+				SplitCutBinNV.Add(CutBinN);
+			}
+		}
+
+		const int SplitNodes = SplitNodeV.Len();
+
+		// the correlations are only needed on the nodes which are split
+		if (IsCalcCorr()) {
+			#pragma omp parallel for schedule(dynamic)
+			for (int SplitN = 0; SplitN < SplitNodes; SplitN++) {
+				SplitNodeV[SplitN]->CalcCorrFtrV(FtrVV, NodeInstNVV[SplitNodeNV[SplitN]]);
+			}
+		}
+
+		// split the instances, the bins give the same split as the cut values
+		TVec<TNode*> ChildV(2*SplitNodes, 0);
+		TVec<TIntV> ChildInstNVV(2*SplitNodes);
+		for (int SplitN = 0; SplitN < SplitNodes; SplitN++) {
+			TNode* Node = SplitNodeV[SplitN];
+			const TIntV& InstNV = NodeInstNVV[SplitNodeNV[SplitN]];
+			const int& CutBinN = SplitCutBinNV[SplitN];
+
+			TIntV& LeftInstNV = ChildInstNVV[2*SplitN];
+			TIntV& RightInstNV = ChildInstNVV[2*SplitN+1];
+
+			for (int i = 0; i < InstNV.Len(); i++) {
+				const int& InstN = InstNV[i];
+				if (FtrBins.BinVV(Node->CutFtrN, InstN).Val <= CutBinN) {
+					LeftInstNV.Add(InstN);
+				} else {
+					RightInstNV.Add(InstN);
+				}
+			}
+
+			Node->Left = new TNode(this);
+			Node->Right = new TNode(this);
+
+			ChildV.Add(Node->Left);
+			ChildV.Add(Node->Right);
+		}
+
+		NodeV.MoveFrom(ChildV);
+		NodeInstNVV.MoveFrom(ChildInstNVV);
+		Level++;
+	}
+}
+
 void TDecisionTree::Prune(const PNotify& Notify) {
 	if (HasRoot()) {
 //		Notify->OnNotifyFmt(TNotifyType::ntInfo, "Prunning ...");
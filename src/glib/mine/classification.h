@@ -12,6 +12,9 @@ namespace TClassification {
 // Logistic Regression using the Newton-Raphson method
 class TLogReg {
 private:
+	// the smallest number of values in a chunk for which the instances are processed in parallel
+	static const int ParMnEls = 1 << 15;
+
 	double Lambda;
 	TFltV WgtV;
 
@@ -28,8 +31,14 @@ public:
 	void Save(TSOut& SOut) const;
 
 	// Fits the regression model. The method assumes that the instances are stored in the
-	// columns of the matrix X and the responses are stored in vector y.
-	void Fit(const TFltVV& X, const TFltV& y, const double& Eps=1e-3);
+	// columns of the matrix X and the responses are stored in vector y. With WarmStart
+	// Newton's method starts from the current weights, which makes refitting for a
+	// series of lambdas on the same data fast.
+	void Fit(const TFltVV& X, const TFltV& y, const double& Eps=1e-3, const bool& WarmStart=false);
+	// Fits the regression model on instances read from BatchSrc a chunk at a time, only
+	// the Hessian and per-instance probabilities are kept in memory.
+	void Fit(const PFtrBatchSrc& BatchSrc, const TFltV& y, const double& Eps=1e-3,
+			const bool& WarmStart=false);
 	// returns the expected response for the given feature vector
 	double Predict(const TFltV& x) const;
 
@@ -207,6 +216,9 @@ private:
 
 		bool CanSplitNumFtr(const TFltIntPrV& ValClassPrV, const int& TotalPos,
 				double& CutVal, double& Score) const;
+		/// finds the best cut on a histogram of a binned feature, returns the last bin of the left child
+		bool CanSplitHist(const TIntV& CountV, const TIntV& PosV, const int& TotalPos,
+				int& CutBinN, double& Score) const;
 		void CalcCorrFtrV(const TFltVV& FtrVV, const TIntV& InstNV);
 		void Split(const TFltVV& FtrVV, const TFltV& ClassV, const TIntV& InstNV);
 
@@ -220,6 +232,26 @@ private:
 		void CleanUp();
 	};
 
+	/// Feature values quantized into at most 256 bins per feature. Built once
+	/// before the tree is grown in histogram mode.
+	class TFtrBins {
+	public:
+		/// bin of each value (Dim x NInst)
+		TVVec<TUCh> BinVV;
+		/// for each feature the cut value between consecutive bins
+		TVec<TFltV> CutValVV;
+
+		/// features with at most MxBins distinct values get a bin per value,
+		/// otherwise the bins hold roughly equal numbers of instances
+		TFtrBins(const TFltVV& FtrVV, const int& MxBins);
+
+		int GetBins(const int& FtrN) const { return CutValVV[FtrN].Len() + 1; }
+	};
+
+	/// the smallest number of values in a node for which the features are
+	/// searched for the best cut in parallel
+	static const int ParMnEls = 1 << 15;
+
 	TNode* Root;
 
 	PDtSplitCriteria SplitCriteria;
@@ -227,12 +259,18 @@ private:
 	PDtGrowCriteria GrowCriteria;
 
 	TBool CalcCorr;
+	/// maximum number of histogram bins per feature, 0 for exact splits on sorted
+	/// values; a fitting option which is not saved with the model
+	TInt MxBins;
 
 public:
+	/// the largest supported number of bins in histogram mode
+	static const int MxHistBins = 256;
+
 	TDecisionTree(const PDtSplitCriteria& SplitCriteria=TInfoGain::New(),
 			const PDtPruneCriteria& PruneCriteria=TDtMinExamplesPrune::New(1),
 			const PDtGrowCriteria& GrowCriteria=TDtGrowCriteria::New(),
-			const bool& CalcCorr=false);
+			const bool& CalcCorr=false, const int& MxBins=0);
 	TDecisionTree(TSIn& SIn);
 	TDecisionTree(const TDecisionTree& Other);
 #ifdef GLib_CPP11
@@ -247,14 +285,21 @@ public:
 
 	void Save(TSOut& SOut) const;
 
+	/// grows the tree on instances in the columns of FtrVV. When MxBins > 0 the
+	/// features are binned first and the nodes of each level are split in parallel
 	void Fit(const TFltVV& FtrVV, const TFltV& ClassV, const PNotify& Notify=TNotify::NullNotify);
 	double Predict(const TFltV& FtrV) const;
 
+	int GetMxBins() const { return MxBins; }
+	void SetMxBins(const int& _MxBins);
+
 	PJsonVal GetJson() const;
 	PJsonVal ExplainPositive() const;
 
 private:
 	void Grow(const TFltVV& FtrVV, const TFltV& ClassV, const PNotify& Notify);
+	/// grows the tree level by level using class histograms of binned features
+	void GrowHist(const TFltVV& FtrVV, const TFltV& ClassV, const PNotify& Notify);
 	void Prune(const PNotify& Notify);
 
 	double GetSplitScore(const int& LeftLen, const int& RightLen, const int& LeftPosN,
@@ -17,6 +17,9 @@ private:
     TCRef CRef;
     friend class TPt<TDist>;
 public:
+    /// distance matrices with fewer elements than this are computed in a single thread
+    static const int ParMnEls = 1 << 15;
+
     virtual ~TDist() {}
 
     virtual void Save(TSOut& SOut) const { GetType().Save(SOut); }
@@ -187,9 +190,10 @@ void TEuclDist::GetDist2VV(const TXMatType& X, const TYMatType& Y, const TFltV&
     const int Rows = D.GetRows();
     const int Cols = D.GetCols();
 
-    for (int RowN = 0; RowN < Rows; RowN++) {
-        for (int ColN = 0; ColN < Cols; ColN++) {
-            D.PutXY(RowN, ColN, NormX2[RowN] - 2 * D(RowN, ColN) + NormY2[ColN]);
+    #pragma omp parallel for if((int64)Rows * Cols >= ParMnEls) schedule(static)
+    for (int ColN = 0; ColN < Cols; ColN++) {
+        for (int RowN = 0; RowN < Rows; RowN++) {
+            D(RowN, ColN) = NormX2[RowN] - 2 * D(RowN, ColN) + NormY2[ColN];
         }
     }
 }
@@ -293,9 +297,10 @@ void TCosDist::GetDistVV(const TXMatType& X, const TYMatType& Y, const TFltV& No
     const int Rows = D.GetRows();
     const int Cols = D.GetCols();
 
-    for (int RowN = 0; RowN < Rows; RowN++) {
-        for (int ColN = 0; ColN < Cols; ColN++) {
-            D.PutXY(RowN, ColN, 1 - D(RowN, ColN) / NormX2[RowN] / NormY2[ColN]);
+    #pragma omp parallel for if((int64)Rows * Cols >= ParMnEls) schedule(static)
+    for (int ColN = 0; ColN < Cols; ColN++) {
+        for (int RowN = 0; RowN < Rows; RowN++) {
+            D(RowN, ColN) = 1 - D(RowN, ColN) / NormX2[RowN] / NormY2[ColN];
         }
     }
 }
@@ -371,6 +376,15 @@ public:
     /// assign methods
     template<class TDataType>
     void Assign(const TDataType& FtrVV, TIntV& AssignV) const;
+    /// assigns all the instances of the source, reading it in chunks. MedoidV holds
+    /// the instance closest to each of the centroids
+    void Assign(const PFtrBatchSrc& BatchSrc, TIntV& AssignV, TIntV& MedoidV) const;
+
+    /// selects K initial centroids with k-means|| (scalable k-means++). Each of the
+    /// Rounds passes over the source samples about OverSample*K candidates, the
+    /// candidates are then reduced to K with weighted k-means++
+    void SelectInitCentroidsPar(const PFtrBatchSrc& BatchSrc, const int& K,
+            TCentroidType& InitCentroidVV, const int& Rounds=5, const double& OverSample=2);
 
     /// distance methods
     /// returns the distance to the specified centroid
@@ -392,13 +406,13 @@ public:
     inline void RemoveCentroids(const TIntV& CentroidIdV);
 
 protected:
-    /// can still optimize
     template<class TDataType>
-    void UpdateCentroids(const TDataType& FtrVV, const int& NInst, TIntV& AssignV,
-            const TFltV& OnesN, const TIntV& RangeN, TFltV& TempK, TCentroidType& TempDxKV,
-            TVec<TIntFltKdV>& TempKxKSpVV, const TFltV& NormX2, TFltV& NormC2,
+    void UpdateCentroids(const TDataType& FtrVV, const int& Dim, TIntV& AssignV,
+            TFltV& TempK, TCentroidType& TempDxKV, const TFltV& NormX2, TFltV& NormC2,
             const bool& AllowEmptyP);
 
+    /// draws K distinct random instances out of NInst
+    void SelectRndInsts(const int& K, const int& NInst, TIntV& InstNV);
     template<class TDataType>
     void SelectInitCentroids(const TDataType& FtrVV, const int& K, const int& NInst);
     template<class TDataType>
@@ -421,8 +435,31 @@ protected:
     /// get column/cluster of the matrix
     static void GetCol(const TFltVV& FtrVV, const int& ColN, TFltV& Col);
     static void GetCol(const TVec<TIntFltKdV>& FtrVV, const int& ColN, TIntFltKdV& Col);
+    /// copies the centroids into a dense d x k matrix
+    static void ToDense(const TFltVV& FtrVV, const int& Dim, TFltVV& DenseVV);
+    static void ToDense(const TVec<TIntFltKdV>& FtrVV, const int& Dim, TFltVV& DenseVV);
+
+    /// closest row of the k x n distance matrix for each instance (column) and
+    /// the distance to it, computed in parallel
+    static void GetAssignV(const TFltVV& ClustDistVV, TIntV& AssignV, TFltV& MnDistV);
+    /// sums of the instances assigned to each cluster (columns of the d x k matrix
+    /// SumVV) and the sizes of the clusters
+    static void GetClustSumVV(const TFltVV& FtrVV, const TIntV& AssignV, const int& K,
+            const int& Dim, TFltVV& SumVV, TFltV& CountV);
+    static void GetClustSumVV(const TVec<TIntFltKdV>& FtrVV, const TIntV& AssignV, const int& K,
+            const int& Dim, TFltVV& SumVV, TFltV& CountV);
+
+    /// goes over the source and finds the closest column of CVV for each instance and
+    /// the squared distance to it. NearestV holds the instance closest to each column
+    template<class TDataType, class TCMatType>
+    void GetClosestV(const PFtrBatchSrc& BatchSrc, const TCMatType& CVV, TIntV& ClosestV,
+            TFltV& MnDist2V, TIntV& NearestV) const;
 
 private:
+    template<class TDataType>
+    void SelectInitCentroidsPar(const PFtrBatchSrc& BatchSrc, const int& K, const int& Rounds,
+            const double& OverSample, TCentroidType& InitCentroidVV);
+
     inline void SelectRndCentroid(const TFltVV& FtrVV, const int& CentroidN);
     inline void SelectRndCentroid(const TVec<TIntFltKdV>& FtrVV, const int& CentroidN);
 
@@ -470,7 +507,22 @@ public:
     void Apply(const TVec<TIntFltKdV>& FtrVV, const bool& AllowEmptyP=true, const int& MaxIter = 10000,
              const PNotify& Notify=TNotify::NullNotify, const TInitCentroidMatType& InitCentroidMat = TInitCentroidMatType());
 
+    /// mini-batch k-means (Sculley, 2010). Each iteration samples BatchSize instances from
+    /// the source, assigns them and moves their centroids towards them with a per-centroid
+    /// learning rate. Stops after MaxIter iterations or when the smoothed inertia of the
+    /// batches stops improving. Random instances are used as initial centroids when
+    /// InitCentroidMat is empty.
+    void ApplyMiniBatch(const PFtrBatchSrc& BatchSrc, const int& BatchSize, const int& MaxIter=10000,
+            const PNotify& Notify=TNotify::NullNotify, const TCentroidType& InitCentroidMat=TCentroidType());
+
 protected:
+    /// number of iterations without improvement after which mini-batch k-means stops
+    static const int MxNoImprovIters = 10;
+
+    template<class TDataType>
+    void ApplyMiniBatch(const PFtrBatchSrc& BatchSrc, const int& BatchSize, const int& MaxIter,
+            const PNotify& Notify, const TCentroidType& InitCentroidMat);
+
 
     template<class TDataType, class TInitCentroidType>
     void Apply(const TDataType& FtrVV, const int& NInst, const int& Dim, const bool& AllowEmptyP,
@@ -605,7 +657,117 @@ template <class TCentroidType>
 template <class TMatType>
 void TAbsKMeans<TCentroidType>::Assign(const TMatType& FtrVV, TIntV& AssignV) const {
     TFltVV DistVV;	Dist->GetDist2VV(CentroidVV, FtrVV, DistVV);
-    TLinAlgSearch::GetColMinIdxV(DistVV, AssignV);
+    TFltV MnDistV;	GetAssignV(DistVV, AssignV, MnDistV);
+}
+
+template <class TCentroidType>
+void TAbsKMeans<TCentroidType>::Assign(const PFtrBatchSrc& BatchSrc, TIntV& AssignV, TIntV& MedoidV) const {
+    TFltV MnDist2V;
+    if (BatchSrc->IsSparse()) {
+        GetClosestV<TVec<TIntFltKdV>>(BatchSrc, CentroidVV, AssignV, MnDist2V, MedoidV);
+    } else {
+        GetClosestV<TFltVV>(BatchSrc, CentroidVV, AssignV, MnDist2V, MedoidV);
+    }
+}
+
+template <class TCentroidType>
+void TAbsKMeans<TCentroidType>::SelectInitCentroidsPar(const PFtrBatchSrc& BatchSrc, const int& K,
+        TCentroidType& InitCentroidVV, const int& Rounds, const double& OverSample) {
+    EAssertR(K <= BatchSrc->GetInsts(), "TAbsKMeans::SelectInitCentroidsPar: more centroids than instances!");
+    EAssertR(Rounds >= 0 && OverSample > 0, "TAbsKMeans::SelectInitCentroidsPar: invalid parameters!");
+
+    if (BatchSrc->IsSparse()) {
+        SelectInitCentroidsPar<TVec<TIntFltKdV>>(BatchSrc, K, Rounds, OverSample, InitCentroidVV);
+    } else {
+        SelectInitCentroidsPar<TFltVV>(BatchSrc, K, Rounds, OverSample, InitCentroidVV);
+    }
+}
+
+template <class TCentroidType>
+template <class TDataType>
+void TAbsKMeans<TCentroidType>::SelectInitCentroidsPar(const PFtrBatchSrc& BatchSrc, const int& K,
+        const int& Rounds, const double& OverSample, TCentroidType& InitCentroidVV) {
+    const int NInst = BatchSrc->GetInsts();
+
+    // I. oversample candidates, the first one is uniformly random and each round
+    // adds instances with probability proportional to the squared distance to the
+    // closest candidate so far
+    TIntV CandNV;
+    TFltV MnDist2V(NInst);	MnDist2V.PutAll(TFlt::Mx);
+    TIntV ClosestV(NInst);
+    TIntV NewCandNV;		NewCandNV.Add(Rnd.GetUniDevInt(NInst));
+
+    TIntV NewClosestV, NearestV;
+    TFltV NewMnDist2V;
+    for (int RoundN = 0; RoundN <= Rounds && !NewCandNV.Empty(); RoundN++) {
+        TDataType NewCandVV;	BatchSrc->GetBatch(NewCandNV, NewCandVV);
+        GetClosestV<TDataType>(BatchSrc, NewCandVV, NewClosestV, NewMnDist2V, NearestV);
+
+        double Phi = 0;
+        for (int InstN = 0; InstN < NInst; InstN++) {
+            if (NewMnDist2V[InstN] < MnDist2V[InstN]) {
+                MnDist2V[InstN] = TFlt::GetMx(NewMnDist2V[InstN], 0.0);
+                ClosestV[InstN] = CandNV.Len() + NewClosestV[InstN];
+            }
+            Phi += MnDist2V[InstN];
+        }
+        CandNV.AddV(NewCandNV);
+        NewCandNV.Clr();
+
+        if (RoundN == Rounds || Phi <= 0) { break; }
+        const double SampleMult = OverSample * K / Phi;
+        for (int InstN = 0; InstN < NInst; InstN++) {
+            if (Rnd.GetUniDev() < SampleMult * MnDist2V[InstN]) { NewCandNV.Add(InstN); }
+        }
+    }
+
+    // the candidates are weighted by the number of instances closest to them
+    TFltV WeightV(CandNV.Len());
+    for (int InstN = 0; InstN < NInst; InstN++) {
+        WeightV[ClosestV[InstN]]++;
+    }
+    // degenerate data (too few distinct instances), fill up with random instances
+    while (CandNV.Len() < K) {
+        CandNV.Add(Rnd.GetUniDevInt(NInst));
+        WeightV.Add(1);
+    }
+
+    // II. reduce the candidates to K centroids with weighted k-means++
+    const int Cands = CandNV.Len();
+    TDataType CandVV;	BatchSrc->GetBatch(CandNV, CandVV);
+
+    TFltV CandMnDist2V(Cands);	CandMnDist2V.PutAll(TFlt::Mx);
+    TFltV ProbV = WeightV;
+    TIntV InitNV(K, 0);
+    TFltVV DistVV;
+    for (int ClustN = 0; ClustN < K; ClustN++) {
+        // sample the next centroid
+        const double ProbSum = TLinAlg::SumVec(ProbV);
+        int SelCandN = Cands - 1;
+        if (ProbSum > 0) {
+            const double Rand = Rnd.GetUniDev() * ProbSum;
+            double CumSum = 0;
+            for (int CandN = 0; CandN < Cands; CandN++) {
+                CumSum += ProbV[CandN];
+                if (Rand < CumSum) { SelCandN = CandN; break; }
+            }
+        } else {
+            SelCandN = Rnd.GetUniDevInt(Cands);
+        }
+        InitNV.Add(CandNV[SelCandN]);
+
+        if (ClustN == K - 1) { break; }
+
+        // update the distances of the candidates to the closest selected centroid
+        TDataType SelVV;	BatchSrc->GetBatch(TIntV::GetV(CandNV[SelCandN]), SelVV);
+        Dist->GetDist2VV(SelVV, CandVV, DistVV);
+        for (int CandN = 0; CandN < Cands; CandN++) {
+            CandMnDist2V[CandN] = TFlt::GetMn(CandMnDist2V[CandN], TFlt::GetMx(DistVV(0, CandN), 0.0));
+            ProbV[CandN] = WeightV[CandN] * CandMnDist2V[CandN];
+        }
+    }
+
+    BatchSrc->GetBatch(InitNV, InitCentroidVV);
 }
 
 template<class TCentroidType>
@@ -658,26 +820,24 @@ inline void TAbsKMeans<TCentroidType>::SelectRndCentroid(const TVec<TIntFltKdV>&
 
 template<class TCentroidType>
 template<class TDataType>
-inline void TAbsKMeans<TCentroidType>::UpdateCentroids(const TDataType& FtrVV, const int& NInst, TIntV& AssignV,
-    const TFltV& OnesN, const TIntV& RangeN, TFltV& TempK, TCentroidType& TempDxKV,
-    TVec<TIntFltKdV>& TempKxKSpVV, const TFltV& NormX2, TFltV& NormC2, const bool& AllowEmptyP) {
+inline void TAbsKMeans<TCentroidType>::UpdateCentroids(const TDataType& FtrVV, const int& Dim, TIntV& AssignV,
+    TFltV& TempK, TCentroidType& TempDxKV, const TFltV& NormX2, TFltV& NormC2, const bool& AllowEmptyP) {
 
     const int K = GetDataCount(CentroidVV);
-
-    // I. create a sparse matrix (coordinate representation) that encodes the closest centroids
-    TSparseColMatrix AssignMat(NInst, K);
+    const int NInst = AssignV.Len();
 
     bool ExistsEmpty;
     int LoopN = 0;
     do {
         ExistsEmpty = false;
 
-        TSparseOps<TInt, TFlt>::CoordinateCreateSparseColMatrix(RangeN, AssignV, OnesN, AssignMat.ColSpVV, K);
-
-        // II. compute the number of points that belong to each centroid, invert
-        AssignMat.MultiplyT(OnesN, TempK);
+        // I. compute the number of points that belong to each centroid
+        TempK.Gen(K);
+        for (int InstN = 0; InstN < NInst; InstN++) {
+            TempK[AssignV[InstN]]++;
+        }
 
-        // invert
+        // II. invert
         for (int ClustN = 0; ClustN < K; ClustN++) {
             // check if the cluster is empty, if we don't allow empty clusters, select a
             // random point as the centroid
@@ -695,14 +855,17 @@ inline void TAbsKMeans<TCentroidType>::UpdateCentroids(const TDataType& FtrVV, c
 
 
     // III. compute the centroids
-    // compute: CentroidMat = ((FtrVV * AssignIdxMat) + CentroidMat) * ColSumDiag;
-    TLinAlgTransform::Diag(TempK, TempKxKSpVV);
-
-    // 1) FtrVV * AssignIdxMat
-    TLinAlg::Multiply(FtrVV, AssignMat.ColSpVV, TempDxKV);
-    // 2) (FtrVV * AssignIdxMat) + CentroidMat
+    // compute: CentroidMat = (ClustSumMat + CentroidMat) * ColSumDiag;
+    TVec<TIntFltKdV> TempKxKSpVV;	TLinAlgTransform::Diag(TempK, TempKxKSpVV);
+
+    // 1) sums of the points in each cluster
+    TFltVV ClustSumVV;
+    TFltV CountV;
+    GetClustSumVV(FtrVV, AssignV, K, Dim, ClustSumVV, CountV);
+    InitCentroids(TempDxKV, ClustSumVV);
+    // 2) ClustSumMat + CentroidMat
     TLinAlg::LinComb(1, TempDxKV, 1, CentroidVV, TempDxKV);
-    // 3) ((FtrVV * AssignIdxMat) + CentroidMat) * ColSumDiag
+    // 3) (ClustSumMat + CentroidMat) * ColSumDiag
     TLinAlg::Multiply(TempDxKV, TempKxKSpVV, CentroidVV);
 }
 
@@ -777,13 +940,10 @@ void TAbsKMeans<TCentroidType>::InitCentroids(TVec<TIntFltKdV>& CentroidVV, cons
 }
 
 template<class TCentroidType>
-template<class TDataType>
-inline void TAbsKMeans<TCentroidType>::SelectInitCentroids(const TDataType& FtrVV,
-        const int& K, const int& NInst) {
-
+void TAbsKMeans<TCentroidType>::SelectRndInsts(const int& K, const int& NInst, TIntV& CentroidNV) {
     EAssertR(NInst >= K, "TStateIdentifier::SelectInitCentroids: The number of initial centroids should be less than the number of data points!");
 
-    TIntV CentroidNV(K);
+    CentroidNV.Gen(K);
 
     // generate k random elements
     if (K < NInst / 2) {
@@ -813,7 +973,13 @@ inline void TAbsKMeans<TCentroidType>::SelectInitCentroids(const TDataType& FtrV
             CentroidNV[i] = PermV[i];
         }
     }
+}
 
+template<class TCentroidType>
+template<class TDataType>
+inline void TAbsKMeans<TCentroidType>::SelectInitCentroids(const TDataType& FtrVV,
+        const int& K, const int& NInst) {
+    TIntV CentroidNV;	SelectRndInsts(K, NInst, CentroidNV);
     InitCentroids(CentroidVV, FtrVV, CentroidNV, K);
 }
 
@@ -828,7 +994,7 @@ template<class TDataType>
 inline void TAbsKMeans<TCentroidType>::Assign(const TDataType& FtrVV, const TFltV& NormX2, const TFltV& NormC2,
     TIntV& AssignV) const {
     TFltVV DistVV;	Dist->GetDist2VV(CentroidVV, FtrVV, NormC2, NormX2, DistVV);
-    TLinAlgSearch::GetColMinIdxV(DistVV, AssignV);
+    TFltV MnDistV;	GetAssignV(DistVV, AssignV, MnDistV);
 }
 
 template<class TCentroidType>
@@ -884,6 +1050,177 @@ void TAbsKMeans<TCentroidType>::GetCol(const TVec<TIntFltKdV>& FtrVV, const int&
     Col = FtrVV[ColN];
 }
 
+template <class TCentroidType>
+void TAbsKMeans<TCentroidType>::ToDense(const TFltVV& FtrVV, const int& Dim, TFltVV& DenseVV) {
+    EAssertR(FtrVV.GetRows() == Dim, "TAbsKMeans::ToDense: invalid dimension!");
+    DenseVV = FtrVV;
+}
+
+template <class TCentroidType>
+void TAbsKMeans<TCentroidType>::ToDense(const TVec<TIntFltKdV>& FtrVV, const int& Dim, TFltVV& DenseVV) {
+    TLinAlgTransform::Full(FtrVV, DenseVV, Dim);
+}
+
+template <class TCentroidType>
+void TAbsKMeans<TCentroidType>::GetAssignV(const TFltVV& ClustDistVV, TIntV& AssignV, TFltV& MnDistV) {
+    const int K = ClustDistVV.GetRows();
+    const int NInst = ClustDistVV.GetCols();
+
+    AssignV.Gen(NInst);
+    MnDistV.Gen(NInst);
+
+    // each thread scans a contiguous range of columns
+    #pragma omp parallel for if((int64)K * NInst >= TDist::ParMnEls) schedule(static)
+    for (int InstN = 0; InstN < NInst; InstN++) {
+        double MnDist = TFlt::Mx;
+        int MnClustN = -1;
+        for (int ClustN = 0; ClustN < K; ClustN++) {
+            const double Dist = ClustDistVV(ClustN, InstN);
+            if (Dist < MnDist) {
+                MnDist = Dist;
+                MnClustN = ClustN;
+            }
+        }
+        AssignV[InstN] = MnClustN;
+        MnDistV[InstN] = MnDist;
+    }
+
+    EAssertR(AssignV.SearchForw(-1) == -1, "Minimum index not set!");
+}
+
+template <class TCentroidType>
+void TAbsKMeans<TCentroidType>::GetClustSumVV(const TFltVV& FtrVV, const TIntV& AssignV,
+        const int& K, const int& Dim, TFltVV& SumVV, TFltV& CountV) {
+    const int NInst = AssignV.Len();
+
+    SumVV.Gen(Dim, K);
+    CountV.Gen(K);
+    for (int InstN = 0; InstN < NInst; InstN++) {
+        CountV[AssignV[InstN]]++;
+    }
+
+    // the rows are split between the threads, so each row of SumVV is a
+    // partial sum owned by a single thread and the matrix is read row by row
+    #pragma omp parallel for if((int64)Dim * NInst >= TDist::ParMnEls) schedule(static)
+    for (int RowN = 0; RowN < Dim; RowN++) {
+        for (int InstN = 0; InstN < NInst; InstN++) {
+            SumVV(RowN, AssignV[InstN]) += FtrVV(RowN, InstN);
+        }
+    }
+}
+
+template <class TCentroidType>
+void TAbsKMeans<TCentroidType>::GetClustSumVV(const TVec<TIntFltKdV>& FtrVV, const TIntV& AssignV,
+        const int& K, const int& Dim, TFltVV& SumVV, TFltV& CountV) {
+    const int NInst = AssignV.Len();
+
+    SumVV.Gen(Dim, K);
+    CountV.Gen(K);
+    for (int InstN = 0; InstN < NInst; InstN++) {
+        CountV[AssignV[InstN]]++;
+    }
+
+    // each thread accumulates the instances of its range in a k x d partial sum,
+    // the partial sums are merged in a fixed order so the result does not depend
+    // on the scheduling. The number of threads is limited so the partial sums take
+    // at most ~256MB
+    int Threads = 1;
+#ifdef GLib_OPENMP
+    int64 Nnz = 0;
+    for (int InstN = 0; InstN < NInst; InstN++) { Nnz += FtrVV[InstN].Len(); }
+    if (Nnz >= TDist::ParMnEls) {
+        const int64 MxThreads = (int64(1) << 25) / TMath::Mx<int64>(int64(K) * Dim, 1);
+        Threads = int(TMath::Mx<int64>(TMath::Mn<int64>(omp_get_max_threads(), MxThreads), 1));
+    }
+#endif
+    if (Threads == 1) {
+        for (int InstN = 0; InstN < NInst; InstN++) {
+            const TIntFltKdV& FtrV = FtrVV[InstN];
+            const int ClustN = AssignV[InstN];
+            for (int ElN = 0; ElN < FtrV.Len(); ElN++) {
+                SumVV(FtrV[ElN].Key, ClustN) += FtrV[ElN].Dat;
+            }
+        }
+        return;
+    }
+
+    TVec<TFltVV> PartSumVV(Threads);
+    #pragma omp parallel num_threads(Threads)
+    {
+        int ThreadN = 0;
+#ifdef GLib_OPENMP
+        ThreadN = omp_get_thread_num();
+#endif
+        TFltVV& ThreadSumVV = PartSumVV[ThreadN];
+        ThreadSumVV.Gen(K, Dim);
+
+        #pragma omp for schedule(static)
+        for (int InstN = 0; InstN < NInst; InstN++) {
+            const TIntFltKdV& FtrV = FtrVV[InstN];
+            const int ClustN = AssignV[InstN];
+            for (int ElN = 0; ElN < FtrV.Len(); ElN++) {
+                ThreadSumVV(ClustN, FtrV[ElN].Key) += FtrV[ElN].Dat;
+            }
+        }
+    }
+
+    // merge
+    #pragma omp parallel for num_threads(Threads) schedule(static)
+    for (int RowN = 0; RowN < Dim; RowN++) {
+        for (int ThreadN = 0; ThreadN < Threads; ThreadN++) {
+            const TFltVV& ThreadSumVV = PartSumVV[ThreadN];
+            if (ThreadSumVV.Empty()) { continue; }
+            for (int ClustN = 0; ClustN < K; ClustN++) {
+                SumVV(RowN, ClustN) += ThreadSumVV(ClustN, RowN);
+            }
+        }
+    }
+}
+
+template <class TCentroidType>
+template <class TDataType, class TCMatType>
+void TAbsKMeans<TCentroidType>::GetClosestV(const PFtrBatchSrc& BatchSrc, const TCMatType& CVV,
+        TIntV& ClosestV, TFltV& MnDist2V, TIntV& NearestV) const {
+    const int NInst = BatchSrc->GetInsts();
+    const int PassInsts = BatchSrc->GetPassInsts();
+    const int Cols = GetDataCount(CVV);
+
+    ClosestV.Gen(NInst);
+    MnDist2V.Gen(NInst);
+    NearestV.Gen(Cols);		NearestV.PutAll(-1);
+    TFltV NearestDist2V(Cols);	NearestDist2V.PutAll(TFlt::Mx);
+
+    TFltV NormC2;	Dist->UpdateNormC2(CVV, NormC2);
+
+    TDataType BatchVV;
+    TFltV NormX2, BatchMnDist2V;
+    TIntV BatchClosestV;
+    TFltVV DistVV;
+    for (int FirstInstN = 0; FirstInstN < NInst; FirstInstN += PassInsts) {
+        const int Insts = TInt::GetMn(PassInsts, NInst - FirstInstN);
+
+        BatchSrc->GetRange(FirstInstN, Insts, BatchVV);
+        Dist->UpdateNormX2(BatchVV, NormX2);
+        Dist->GetDist2VV(CVV, BatchVV, NormC2, NormX2, DistVV);
+        GetAssignV(DistVV, BatchClosestV, BatchMnDist2V);
+
+        for (int InstN = 0; InstN < Insts; InstN++) {
+            ClosestV[FirstInstN + InstN] = BatchClosestV[InstN];
+            MnDist2V[FirstInstN + InstN] = BatchMnDist2V[InstN];
+        }
+
+        #pragma omp parallel for if((int64)Cols * Insts >= TDist::ParMnEls) schedule(static)
+        for (int ColN = 0; ColN < Cols; ColN++) {
+            for (int InstN = 0; InstN < Insts; InstN++) {
+                if (DistVV(ColN, InstN) < NearestDist2V[ColN]) {
+                    NearestDist2V[ColN] = DistVV(ColN, InstN);
+                    NearestV[ColN] = FirstInstN + InstN;
+                }
+            }
+        }
+    }
+}
+
 template<class TCentroidType>
 TDnsKMeans<TCentroidType>::TDnsKMeans(const int& _K, const TRnd& Rnd, const PDist& Dist) :
         TAbsKMeans<TCentroidType>(Rnd, Dist),
@@ -954,16 +1291,14 @@ void TDnsKMeans<TCentroidType>::Apply(const TDataType& FtrVV, const int& NInst,
     TIntV* Temp;
 
     // constant reused variables
-    TFltV OnesN;			TLinAlgTransform::OnesV(NInst, OnesN);
     TFltV NormX2;			TAbsKMeans<TCentroidType>::Dist->UpdateNormX2(FtrVV, NormX2);
-    TIntV RangeN(NInst);	TLinAlgTransform::RangeV(NInst, RangeN);
 
     // reused variables
     TFltVV ClustDistVV(K, NInst);		// (dimension k x n)
+    TFltV MinClustDistV;				// (dimension n)
     TFltV NormC2(K);
     TFltV TempK(K);						// (dimension k)
     TCentroidType TempDxK;				// (dimension d x k)
-    TVec<TIntFltKdV> TempKxKSpVV(K);	// (dimension k x k)
 
     // select initial centroids
     if (InitCentroidMat.Empty()) {
@@ -982,8 +1317,8 @@ void TDnsKMeans<TCentroidType>::Apply(const TDataType& FtrVV, const int& NInst,
         TAbsKMeans<TCentroidType>::Dist->UpdateNormC2(TAbsKMeans<TCentroidType>::CentroidVV, NormC2);
         TAbsKMeans<TCentroidType>::Dist->GetDist2VV(TAbsKMeans<TCentroidType>::CentroidVV, FtrVV, NormC2, NormX2, ClustDistVV);
 
-        TLinAlgSearch::GetColMinIdxV(ClustDistVV, *AssignIdxVPtr);
-        
+        TAbsKMeans<TCentroidType>::GetAssignV(ClustDistVV, *AssignIdxVPtr, MinClustDistV);
+
         // if the assignment hasn't changed then terminate the loop
         if (*AssignIdxVPtr == *OldAssignIdxVPtr) {
             Notify->OnNotifyFmt(TNotifyType::ntInfo, "Converged at iteration: %d", IterN);
@@ -991,7 +1326,7 @@ void TDnsKMeans<TCentroidType>::Apply(const TDataType& FtrVV, const int& NInst,
         }
 
         // recompute the means
-        TAbsKMeans<TCentroidType>::UpdateCentroids(FtrVV, NInst, *AssignIdxVPtr, OnesN, RangeN, TempK, TempDxK, TempKxKSpVV, NormX2, NormC2, AllowEmptyP);
+        TAbsKMeans<TCentroidType>::UpdateCentroids(FtrVV, Dim, *AssignIdxVPtr, TempK, TempDxK, NormX2, NormC2, AllowEmptyP);
 
         // swap the old and new assign vectors
         Temp = AssignIdxVPtr;
@@ -1000,6 +1335,107 @@ void TDnsKMeans<TCentroidType>::Apply(const TDataType& FtrVV, const int& NInst,
     }
 }
 
+template<class TCentroidType>
+void TDnsKMeans<TCentroidType>::ApplyMiniBatch(const PFtrBatchSrc& BatchSrc, const int& BatchSize,
+        const int& MaxIter, const PNotify& Notify, const TCentroidType& InitCentroidMat) {
+    EAssertR(BatchSrc->GetDim() > 0, "The input matrix doesn't have any features!");
+    EAssertR(BatchSize > 0, "The batch size should be positive!");
+
+    if (BatchSrc->IsSparse()) {
+        ApplyMiniBatch<TVec<TIntFltKdV>>(BatchSrc, BatchSize, MaxIter, Notify, InitCentroidMat);
+    } else {
+        ApplyMiniBatch<TFltVV>(BatchSrc, BatchSize, MaxIter, Notify, InitCentroidMat);
+    }
+}
+
+template<class TCentroidType>
+template<class TDataType>
+void TDnsKMeans<TCentroidType>::ApplyMiniBatch(const PFtrBatchSrc& BatchSrc, const int& BatchSize,
+        const int& MaxIter, const PNotify& Notify, const TCentroidType& InitCentroidMat) {
+    typedef TAbsKMeans<TCentroidType> TBase;
+
+    const int NInst = BatchSrc->GetInsts();
+    const int Dim = BatchSrc->GetDim();
+    EAssertR(K <= NInst, "Matrix should have more columns than K!");
+
+    Notify->OnNotify(TNotifyType::ntInfo, "Executing mini-batch KMeans ...");
+
+    // the centroids are kept dense while learning (dimension d x k)
+    TFltVV WorkCentroidVV;
+    if (InitCentroidMat.Empty()) {
+        TIntV CentroidNV;	TBase::SelectRndInsts(K, NInst, CentroidNV);
+        BatchSrc->GetBatch(CentroidNV, WorkCentroidVV);
+    } else {
+        EAssertR(TBase::GetDataCount(InitCentroidMat) == K, "Number of columns must be equal to K!");
+        TBase::ToDense(InitCentroidMat, Dim, WorkCentroidVV);
+    }
+
+    // weight of the exponentially smoothed batch inertia
+    const double Alpha = TFlt::GetMn(1.0, 2.0 * BatchSize / (NInst + 1));
+
+    // number of instances that have moved each of the centroids
+    TFltV ClustInstsV(K);
+    // reused variables
+    TIntV BatchNV(BatchSize);
+    TDataType BatchVV;
+    TFltV NormX2, NormC2;
+    TFltVV ClustDistVV, SumVV;
+    TIntV AssignV;
+    TFltV MinClustDistV, CountV;
+
+    double EwaInertia = 0, BestInertia = TFlt::Mx;
+    int NoImprovIters = 0;
+    for (int IterN = 0; IterN < MaxIter; IterN++) {
+        if (IterN % 100 == 0) { Notify->OnNotifyFmt(TNotifyType::ntInfo, "%d", IterN); }
+
+        // sample the batch, sorted so the source is read in order
+        for (int SampleN = 0; SampleN < BatchSize; SampleN++) {
+            BatchNV[SampleN] = TBase::Rnd.GetUniDevInt(NInst);
+        }
+        BatchNV.Sort();
+        BatchSrc->GetBatch(BatchNV, BatchVV);
+
+        // assign the batch
+        TBase::Dist->UpdateNormX2(BatchVV, NormX2);
+        TBase::Dist->UpdateNormC2(WorkCentroidVV, NormC2);
+        TBase::Dist->GetDist2VV(WorkCentroidVV, BatchVV, NormC2, NormX2, ClustDistVV);
+        TBase::GetAssignV(ClustDistVV, AssignV, MinClustDistV);
+
+        // move the centroids towards the means of their instances in the batch,
+        // the learning rate of each centroid is 1 / (number of its instances so far)
+        TBase::GetClustSumVV(BatchVV, AssignV, K, Dim, SumVV, CountV);
+        for (int ClustN = 0; ClustN < K; ClustN++) {
+            ClustInstsV[ClustN] += CountV[ClustN];
+        }
+        #pragma omp parallel for if((int64)Dim * K >= TDist::ParMnEls) schedule(static)
+        for (int RowN = 0; RowN < Dim; RowN++) {
+            for (int ClustN = 0; ClustN < K; ClustN++) {
+                if (CountV[ClustN] == 0.0) { continue; }
+                WorkCentroidVV(RowN, ClustN) += (SumVV(RowN, ClustN) -
+                    CountV[ClustN] * WorkCentroidVV(RowN, ClustN)) / ClustInstsV[ClustN];
+            }
+        }
+
+        // stop when the smoothed inertia of the batches stops improving
+        double Inertia = 0;
+        for (int SampleN = 0; SampleN < BatchSize; SampleN++) {
+            Inertia += TFlt::GetMx(MinClustDistV[SampleN], 0.0);
+        }
+        Inertia /= BatchSize;
+        EwaInertia = IterN == 0 ? Inertia : (1 - Alpha) * EwaInertia + Alpha * Inertia;
+
+        if (EwaInertia < BestInertia) {
+            BestInertia = EwaInertia;
+            NoImprovIters = 0;
+        } else if (++NoImprovIters >= MxNoImprovIters) {
+            Notify->OnNotifyFmt(TNotifyType::ntInfo, "Converged at iteration: %d", IterN);
+            break;
+        }
+    }
+
+    TBase::SelectInitCentroids(WorkCentroidVV);
+}
+
 template<class TCentroidType>
 TDpMeans<TCentroidType>::TDpMeans(const TFlt& _Lambda, const TInt& _MnClusts, const TInt& _MxClusts,
     const TRnd& Rnd, const PDist& Dist) :
@@ -1067,9 +1503,7 @@ inline void TDpMeans<TCentroidType>::Apply(const TDataType& FtrVV, const int& NI
     TAbsKMeans<TCentroidType>::SelectInitCentroids(FtrVV, MnClusts, NInst);
 
     // const variables, reused throughtout the procedure
-    TFltV OnesN;			TLinAlgTransform::OnesV(NInst, OnesN);
     TFltV NormX2;			TAbsKMeans<TCentroidType>::Dist->UpdateNormX2(FtrVV, NormX2);
-    TIntV RangeN(NInst);	TLinAlgTransform::RangeV(NInst, RangeN);
 
 
     // temporary reused variables
@@ -1079,7 +1513,6 @@ inline void TDpMeans<TCentroidType>::Apply(const TDataType& FtrVV, const int& NI
     TFltV NormC2(K);					// (dimension k)
     TFltV TempK(K);						// (dimension k)
     TCentroidType TempDxK;				// (dimension d x k)
-    TVec<TIntFltKdV> TempKxKSpVV(K);	// (dimension k x k)
 
     int IterN = 0;
     while (IterN++ < MaxIter) {
@@ -1088,19 +1521,16 @@ inline void TDpMeans<TCentroidType>::Apply(const TDataType& FtrVV, const int& NI
         // compute the distance matrix to all the centroids and assignments
         TAbsKMeans<TCentroidType>::Dist->UpdateNormC2(TAbsKMeans<TCentroidType>::CentroidVV, NormC2);
         TAbsKMeans<TCentroidType>::Dist->GetDist2VV(TAbsKMeans<TCentroidType>::CentroidVV, FtrVV, NormC2, NormX2, ClustDistVV);
-        TLinAlgSearch::GetColMinIdxV(ClustDistVV, *AssignIdxVPtr);
+        TAbsKMeans<TCentroidType>::GetAssignV(ClustDistVV, *AssignIdxVPtr, MinClustDistV);
 
         // check if we need to increase the number of centroids
         if (K < MxClusts) {
-            TLinAlgSearch::GetColMinV(ClustDistVV, MinClustDistV);
-
             const int NewCentrIdx = TLinAlgSearch::GetMaxIdx(MinClustDistV);
             const double MaxDist = MinClustDistV[NewCentrIdx];
 
             if (MaxDist > LambdaSq) {
                 K++;
                 AddCentroid(FtrVV, ClustDistVV, NormC2, TempK, TempDxK, NewCentrIdx);
-                TempKxKSpVV.Gen(K);
                 (*AssignIdxVPtr)[NewCentrIdx] = K - 1;
                 Notify->OnNotifyFmt(TNotifyType::ntInfo, "Max distance to centroid: %.3f, number of clusters: %d ...", TMath::Sqrt(MaxDist), K);
             }
@@ -1113,7 +1543,7 @@ inline void TDpMeans<TCentroidType>::Apply(const TDataType& FtrVV, const int& NI
         }
 
         // recompute the centroids
-        TAbsKMeans<TCentroidType>::UpdateCentroids(FtrVV, NInst, *AssignIdxVPtr, OnesN, RangeN, TempK, TempDxK, TempKxKSpVV, NormX2, NormC2, AllowEmptyP);
+        TAbsKMeans<TCentroidType>::UpdateCentroids(FtrVV, Dim, *AssignIdxVPtr, TempK, TempDxK, NormX2, NormC2, AllowEmptyP);
 
         // swap old and new assign vectors
         Temp = AssignIdxVPtr;
@@ -0,0 +1,57 @@
+/**
+ * Copyright (c) 2015, Jozef Stefan Institute, Quintelligence d.o.o. and contributors
+ * All rights reserved.
+ *
+ * This source code is licensed under the FreeBSD license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+///////////////////////////////////////////////////////////////////////
+// Dense matrix batch source
+void TFltVVBatchSrc::GetBatch(const TIntV& InstNV, TFltVV& BatchVV) const {
+    const int Rows = FtrVV.GetRows(), Insts = InstNV.Len();
+    BatchVV.Gen(Rows, Insts);
+    for (int RowN = 0; RowN < Rows; RowN++) {
+        for (int InstN = 0; InstN < Insts; InstN++) {
+            BatchVV(RowN, InstN) = FtrVV(RowN, InstNV[InstN]);
+        }
+    }
+}
+
+void TFltVVBatchSrc::GetBatch(const TIntV& InstNV, TVec<TIntFltKdV>& BatchVV) const {
+    const int Rows = FtrVV.GetRows(), Insts = InstNV.Len();
+    BatchVV.Gen(Insts);
+    for (int InstN = 0; InstN < Insts; InstN++) {
+        const int ColN = InstNV[InstN];
+        for (int RowN = 0; RowN < Rows; RowN++) {
+            const double Val = FtrVV(RowN, ColN);
+            if (Val != 0.0) { BatchVV[InstN].Add(TIntFltKd(RowN, Val)); }
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////
+// Sparse matrix batch source
+TSpVVBatchSrc::TSpVVBatchSrc(const TVec<TIntFltKdV>& _FtrVV, const int& _Dim):
+        FtrVV(_FtrVV), Dim(_Dim == -1 ? TLinAlgSearch::GetMaxDimIdx(_FtrVV) + 1 : _Dim) {
+    EAssertR(TLinAlgSearch::GetMaxDimIdx(FtrVV) < Dim, "TSpVVBatchSrc: index out of dimension");
+}
+
+void TSpVVBatchSrc::GetBatch(const TIntV& InstNV, TFltVV& BatchVV) const {
+    const int Insts = InstNV.Len();
+    BatchVV.Gen(Dim, Insts);
+    for (int InstN = 0; InstN < Insts; InstN++) {
+        const TIntFltKdV& FtrV = FtrVV[InstNV[InstN]];
+        for (int ElN = 0; ElN < FtrV.Len(); ElN++) {
+            BatchVV(FtrV[ElN].Key, InstN) = FtrV[ElN].Dat;
+        }
+    }
+}
+
+void TSpVVBatchSrc::GetBatch(const TIntV& InstNV, TVec<TIntFltKdV>& BatchVV) const {
+    const int Insts = InstNV.Len();
+    BatchVV.Gen(Insts);
+    for (int InstN = 0; InstN < Insts; InstN++) {
+        BatchVV[InstN] = FtrVV[InstNV[InstN]];
+    }
+}
@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) 2015, Jozef Stefan Institute, Quintelligence d.o.o. and contributors
+ * All rights reserved.
+ *
+ * This source code is licensed under the FreeBSD license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef FTRBATCH_H
+#define FTRBATCH_H
+
+///////////////////////////////////////////////////////////////////////
+/// Feature batch source.
+/// Gives access to a dataset a batch of instances at a time, so learners
+/// which go over the data in mini-batches do not need the whole feature
+/// matrix in memory. Instances are numbered 0..GetInsts()-1 and batches
+/// are returned with one instance per column.
+ClassTP(TFtrBatchSrc, PFtrBatchSrc)//{
+public:
+    virtual ~TFtrBatchSrc() { }
+
+    /// number of instances
+    virtual int GetInsts() const = 0;
+    /// dimension of the feature vectors
+    virtual int GetDim() const = 0;
+    /// true when the instances are better kept in sparse form
+    virtual bool IsSparse() const = 0;
+
+    /// feature vectors of instances InstNV as columns of BatchVV
+    virtual void GetBatch(const TIntV& InstNV, TFltVV& BatchVV) const = 0;
+    /// feature vectors of instances InstNV as sparse columns
+    virtual void GetBatch(const TIntV& InstNV, TVec<TIntFltKdV>& BatchVV) const = 0;
+
+    /// feature vectors of the consecutive instances [FirstInstN, FirstInstN + Insts)
+    template <class TMatType>
+    void GetRange(const int& FirstInstN, const int& Insts, TMatType& BatchVV) const;
+    /// number of instances to read at a time when going over all of them,
+    /// keeps dense batches at about 64MB
+    int GetPassInsts() const {
+        return TInt::GetMx(1024, TInt::GetMn(65536, (1 << 23) / TInt::GetMx(GetDim(), 1))); }
+};
+
+template <class TMatType>
+void TFtrBatchSrc::GetRange(const int& FirstInstN, const int& Insts, TMatType& BatchVV) const {
+    TIntV InstNV(Insts, 0);
+    for (int InstN = FirstInstN; InstN < FirstInstN + Insts; InstN++) { InstNV.Add(InstN); }
+    GetBatch(InstNV, BatchVV);
+}
+
+///////////////////////////////////////////////////////////////////////
+/// Batch source over a dense matrix with instances as columns. The matrix
+/// is not copied and must outlive the source.
+class TFltVVBatchSrc : public TFtrBatchSrc {
+private:
+    const TFltVV& FtrVV;
+
+    TFltVVBatchSrc(const TFltVV& _FtrVV): FtrVV(_FtrVV) { }
+public:
+    static PFtrBatchSrc New(const TFltVV& FtrVV) { return new TFltVVBatchSrc(FtrVV); }
+
+    int GetInsts() const { return FtrVV.GetCols(); }
+    int GetDim() const { return FtrVV.GetRows(); }
+    bool IsSparse() const { return false; }
+
+    void GetBatch(const TIntV& InstNV, TFltVV& BatchVV) const;
+    void GetBatch(const TIntV& InstNV, TVec<TIntFltKdV>& BatchVV) const;
+};
+
+///////////////////////////////////////////////////////////////////////
+/// Batch source over a sparse matrix with instances as columns. The matrix
+/// is not copied and must outlive the source.
+class TSpVVBatchSrc : public TFtrBatchSrc {
+private:
+    const TVec<TIntFltKdV>& FtrVV;
+    const int Dim;
+
+    TSpVVBatchSrc(const TVec<TIntFltKdV>& _FtrVV, const int& _Dim);
+public:
+    /// when Dim is -1 the dimension is one more than the largest index in FtrVV
+    static PFtrBatchSrc New(const TVec<TIntFltKdV>& FtrVV, const int& Dim = -1) {
+        return new TSpVVBatchSrc(FtrVV, Dim); }
+
+    int GetInsts() const { return FtrVV.Len(); }
+    int GetDim() const { return Dim; }
+    bool IsSparse() const { return true; }
+
+    void GetBatch(const TIntV& InstNV, TFltVV& BatchVV) const;
+    void GetBatch(const TIntV& InstNV, TVec<TIntFltKdV>& BatchVV) const;
+};
+
+#endif
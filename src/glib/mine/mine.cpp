@@ -30,6 +30,7 @@
 
 // feature-generator
 #include "ftrgen.cpp"
+#include "ftrbatch.cpp"
 
 // Linear-Algebra
 #include "bowlinalg.cpp"
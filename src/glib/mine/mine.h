@@ -34,6 +34,7 @@
 
 // feature-generator
 #include "ftrgen.h"
+#include "ftrbatch.h"
 
 // Linear-Algebra
 #include "bowlinalg.h"
@@ -9,6 +9,135 @@
 ///////////////////////////////////////////
 // Non-negative matrix factorization
 
+void TNmf::ParallelALS(const TCompressedSparseMatrix& A, const int& R, TFltVV& U, TFltVV& V, TFltV& LossV,
+		const int& MaxIter, const double& Eps, const double& Lambda, const PNotify& Notify) {
+
+	const int Rows = A.GetRows();
+	const int Cols = A.GetCols();
+
+	EAssert(0 < R && R <= Rows && R <= Cols);
+	EAssertR(Lambda >= 0.0, "TNmf::ParallelALS: Lambda should be nonnegative!");
+	Notify->OnNotify(TNotifyType::ntInfo, "Executing NMF ...");
+
+	const bool ParP = (int64)A.GetNnz() * R >= ParMnEls;
+
+	// initialize the matrices U and V, V is kept transposed during the
+	// iterations, so that both half-steps solve for rows of a matrix
+	InitializeUV(Rows, Cols, R, U, V);
+	TFltVV VT; TLinAlg::Transpose(V, VT);
+
+	LossV.Clr();
+	int IterN = 0;
+	do {
+		// updating U, one row per user over the CSR arrays
+		SolveRowsCCD(A.GetRowPtrV(), A.GetRowColIdV(), A.GetRowValV(), VT, Lambda, ParP, U);
+		// updating V, one row of V' per item over the CSC arrays
+		const double SqErr = SolveRowsCCD(A.GetColPtrV(), A.GetColRowIdV(), A.GetColValV(), U, Lambda, ParP, VT);
+		// the residuals of the last half-step are those of the current U and V
+		const double Loss = 0.5 * SqErr + 0.5 * Lambda * (TLinAlg::Frob2(U) + TLinAlg::Frob2(VT));
+		LossV.Add(Loss);
+
+		if (IterN % 10 == 0) { Notify->OnNotifyFmt(TNotifyType::ntInfo, "%d: %g", IterN, Loss); }
+		// check for stopping condition
+		if (IterN > 0 && LossV[IterN-1] - Loss <= Eps * LossV[IterN-1]) {
+			Notify->OnNotifyFmt(TNotifyType::ntInfo, "Converged at iteration: %d", IterN);
+			break;
+		}
+	} while (++IterN < MaxIter);
+
+	TLinAlg::Transpose(VT, V);
+}
+
+void TNmf::ParallelALS(const TVec<TIntFltKdV>& A, const int& R, TFltVV& U, TFltVV& V, TFltV& LossV,
+		const int& MaxIter, const double& Eps, const double& Lambda, const PNotify& Notify) {
+	ParallelALS(TCompressedSparseMatrix(A, NumOfRows(A)), R, U, V, LossV, MaxIter, Eps, Lambda, Notify);
+}
+
+void TNmf::ParallelALS(const TFltVV& A, const int& R, TFltVV& U, TFltVV& V, TFltV& LossV,
+		const int& MaxIter, const double& Eps, const double& Lambda, const PNotify& Notify) {
+	// only the nonzero elements are observed
+	const int Rows = A.GetRows();
+	const int Cols = A.GetCols();
+	TVec<TIntFltKdV> ColSpVV(Cols);
+	for (int ColN = 0; ColN < Cols; ColN++) {
+		for (int RowN = 0; RowN < Rows; RowN++) {
+			if (A(RowN, ColN) != 0.0) { ColSpVV[ColN].Add(TIntFltKd(RowN, A(RowN, ColN))); }
+		}
+	}
+	ParallelALS(TCompressedSparseMatrix(ColSpVV, Rows), R, U, V, LossV, MaxIter, Eps, Lambda, Notify);
+}
+
+double TNmf::SolveRowsCCD(const TIntV& PtrV, const TIntV& IdV, const TFltV& ValV,
+		const TFltVV& Y, const double& Lambda, const bool& ParP, TFltVV& X) {
+
+	const int Rows = X.GetRows();
+	const int R = X.GetCols();
+	// squared errors of each row, summed in order so the loss does not
+	// depend on the number of threads
+	TFltV SqErrV(Rows);
+
+	#pragma omp parallel if(ParP)
+	{
+		TFltV ResV;		// residuals of the observations of the current row
+		TFltV ObsYV;	// Y(j_e,k) of the observations, stored by k, so the sweeps read memory in order
+		TFltV DenV(R);
+		#pragma omp for schedule(dynamic, 64)
+		for (int RowN = 0; RowN < Rows; RowN++) {
+			const int FirstElN = PtrV[RowN];
+			const int Els = PtrV[RowN+1] - FirstElN;
+			// without observations only the regularization is left
+			if (Els == 0) {
+				for (int k = 0; k < R; k++) { X(RowN, k) = 0.0; }
+				continue;
+			}
+
+			if (ResV.Len() < Els) { ResV.Gen(Els); ObsYV.Gen(Els * R); }
+			for (int ElN = 0; ElN < Els; ElN++) {
+				const int Id = IdV[FirstElN + ElN];
+				for (int k = 0; k < R; k++) { ObsYV[k*Els + ElN] = Y(Id, k); }
+			}
+			// r_e = a_e - X(i,:) * Y(j_e,:)
+			for (int ElN = 0; ElN < Els; ElN++) {
+				double Pred = 0;
+				for (int k = 0; k < R; k++) { Pred += X(RowN, k) * ObsYV[k*Els + ElN]; }
+				ResV[ElN] = ValV[FirstElN + ElN] - Pred;
+			}
+			// Lambda + sum_e y_e^2 does not change during the sweeps
+			for (int k = 0; k < R; k++) {
+				const double* YKV = &ObsYV[k*Els].Val;
+				double Den = Lambda;
+				for (int ElN = 0; ElN < Els; ElN++) { Den += YKV[ElN] * YKV[ElN]; }
+				DenV[k] = Den;
+			}
+
+			for (int SweepN = 0; SweepN < CCDSweeps; SweepN++) {
+				for (int k = 0; k < R; k++) {
+					// minimize over X(i,k) with the others fixed and project to x >= 0:
+					// x = [sum_e (r_e + X(i,k) * y_e) * y_e / (Lambda + sum_e y_e^2)]+
+					const double* YKV = &ObsYV[k*Els].Val;
+					const double OldX = X(RowN, k);
+					double Num = 0;
+					for (int ElN = 0; ElN < Els; ElN++) {
+						Num += (ResV[ElN] + OldX * YKV[ElN]) * YKV[ElN];
+					}
+					const double NewX = DenV[k] > 0.0 ? TMath::Mx(0.0, Num / DenV[k]) : 0.0;
+					const double Delta = NewX - OldX;
+					if (Delta != 0.0) {
+						for (int ElN = 0; ElN < Els; ElN++) { ResV[ElN] -= Delta * YKV[ElN]; }
+						X(RowN, k) = NewX;
+					}
+				}
+			}
+
+			double SqErr = 0;
+			for (int ElN = 0; ElN < Els; ElN++) { SqErr += ResV[ElN] * ResV[ElN]; }
+			SqErrV[RowN] = SqErr;
+		}
+	}
+
+	return TLinAlg::SumVec(SqErrV);
+}
+
 void TNmf::InitializeUV(const int& Rows, const int& Cols, const int& R, TFltVV& U, TFltVV& V) {
 	U.Gen(Rows, R); TLinAlgTransform::FillRnd(U);
 	V.Gen(R, Cols); TLinAlgTransform::FillRnd(V);
@@ -34,7 +34,27 @@ public:
 	static void WeightedCFO(const TMatType& A, const int& R, TFltVV& U, TFltVV& V, const int& MaxIter = 10000,
 		const double& Eps = 1e-3, const PNotify& TNotify = TNotify::NullNotify);
 
+	// calculates the Weighted NMF using alternating nonnegative least squares, where only the
+	// nonzero elements of A are observed (the same weights as in WeightedCFO). Each half-step solves
+	// for all the rows of U (columns of V) in parallel over the CSR (CSC) arrays of A, using cyclic
+	// coordinate descent on each row. Minimizes 1/2 * ||W o (A - U*V)||^2 + Lambda/2 * (||U||^2 + ||V||^2)
+	// and stops when the relative decrease of the loss falls below Eps. The loss after each
+	// iteration is stored in LossV.
+	static void ParallelALS(const TCompressedSparseMatrix& A, const int& R, TFltVV& U, TFltVV& V, TFltV& LossV,
+		const int& MaxIter = 100, const double& Eps = 1e-4, const double& Lambda = 0.01,
+		const PNotify& Notify = TNotify::NullNotify);
+	static void ParallelALS(const TVec<TIntFltKdV>& A, const int& R, TFltVV& U, TFltVV& V, TFltV& LossV,
+		const int& MaxIter = 100, const double& Eps = 1e-4, const double& Lambda = 0.01,
+		const PNotify& Notify = TNotify::NullNotify);
+	static void ParallelALS(const TFltVV& A, const int& R, TFltVV& U, TFltVV& V, TFltV& LossV,
+		const int& MaxIter = 100, const double& Eps = 1e-4, const double& Lambda = 0.01,
+		const PNotify& Notify = TNotify::NullNotify);
+
 private:
+	// the solver runs in one thread when A has fewer nonzeros times R than this
+	static const int ParMnEls = 1 << 15;
+	// number of coordinate descent sweeps over each row in one half-step of ParallelALS
+	static const int CCDSweeps = 3;
 	//============================================================
 	// HELPER FUNCTIONS
 	//============================================================
@@ -60,6 +80,12 @@ private:
 	static double WeightedProjectedGradientNorm(const TMatType& A, const int& R, 
 		const TMatType& W, const TFltVV& U, const TFltVV& V);
 
+	// sets each row X(i,:) to the nonnegative regularized least squares fit of its observations
+	// Val[e] ~ X(i,:) * Y(Id[e],:), e in [Ptr[i], Ptr[i+1]), with CCDSweeps sweeps of coordinate
+	// descent starting from the current X(i,:); returns the sum of squared residuals
+	static double SolveRowsCCD(const TIntV& PtrV, const TIntV& IdV, const TFltV& ValV,
+		const TFltVV& Y, const double& Lambda, const bool& ParP, TFltVV& X);
+
 	// update scaling for better stability of matrices
 	static void UpdateScale(TFltVV& U, TFltVV& V);
 
@@ -160,7 +160,125 @@ void TPropHazards::PredictInternal(const TFltVV& X, TFltV& IntensV) const {
 /////////////////////////////////////////////
 // Ridge Regression
 void TRidgeReg::Fit(const TFltVV& X, const TFltV& y) {
-    TNumericalStuff::LeastSquares(X, y, Gamma, WgtV);
+    if (X.GetRows() < X.GetCols()) {
+        // primal problem, solved through the cached normal equations
+        Fit(TFltVVBatchSrc::New(X), y);
+    } else {
+        ClrCache();
+        TNumericalStuff::LeastSquares(X, y, Gamma, WgtV);
+    }
+}
+
+void TRidgeReg::Fit(const PFtrBatchSrc& BatchSrc, const TFltV& y) {
+    const int Insts = BatchSrc->GetInsts();
+    const int Feats = BatchSrc->GetDim();
+    EAssertR(Insts == y.Len(), "TRidgeReg::Fit: number of instances does not match the number of targets (length of y)");
+    ClrCache();
+    if (Insts <= Feats) {
+        // A * A' is singular for Gamma == 0, solve the dual problem on all the
+        // instances, the same as when fitting a matrix
+        TFltVV X; BatchSrc->GetRange(0, Insts, X);
+        TNumericalStuff::LeastSquares(X, y, Gamma, WgtV);
+        return;
+    }
+    // x = (A * A' + Gamma^2 * I)^{-1} A * b, where A * A' and A * b are
+    // summed over chunks of instances
+    GramVV.Gen(Feats, Feats);
+    AbV.Gen(Feats);
+    const int ChunkInsts = BatchSrc->GetPassInsts();
+    TFltVV ChunkVV; TFltV ChunkYV, ChunkAb(Feats);
+    for (int FirstInstN = 0; FirstInstN < Insts; FirstInstN += ChunkInsts) {
+        const int LastInstN = TInt::GetMn(FirstInstN + ChunkInsts, Insts) - 1;
+        BatchSrc->GetRange(FirstInstN, LastInstN - FirstInstN + 1, ChunkVV);
+        // AAt += A_chunk * A_chunk'
+        TLinAlg::AddGram(ChunkVV, GramVV);
+        // Ab += A_chunk * b_chunk
+        y.GetSubValV(FirstInstN, LastInstN, ChunkYV);
+        TLinAlg::Multiply(ChunkVV, ChunkYV, ChunkAb);
+        TLinAlg::AddVec(1.0, ChunkAb, AbV, AbV);
+    }
+    SolveCached();
+}
+
+void TRidgeReg::Refit(const double& _Gamma) {
+    EAssertR(IsRefittable(), "TRidgeReg::Refit: the model should first be fitted on data with fewer features than instances");
+    Gamma = _Gamma;
+    SolveCached();
+}
+
+void TRidgeReg::GetRegPath(const TFltV& GammaV, TFltVV& WgtVV) {
+    EAssertR(IsRefittable(), "TRidgeReg::GetRegPath: the model should first be fitted on data with fewer features than instances");
+    Decompose();
+
+    const int Feats = GramVV.GetRows();
+    const int Gammas = GammaV.Len();
+
+    WgtVV.Gen(Feats, Gammas);
+    #pragma omp parallel for schedule(static)
+    for (int GammaN = 0; GammaN < Gammas; GammaN++) {
+        TFltV PathWgtV;
+        SolveDecomposed(GammaV[GammaN], PathWgtV);
+        WgtVV.SetCol(GammaN, PathWgtV);
+    }
+}
+
+void TRidgeReg::ClrCache() {
+    GramVV.Clr();
+    AbV.Clr();
+    EigVecVV.Clr();
+    EigValV.Clr();
+    ProjAbV.Clr();
+}
+
+void TRidgeReg::SolveCached() {
+    const int Feats = GramVV.GetRows();
+    TFltVV AAt(GramVV);
+    for (int FtrN = 0; FtrN < Feats; FtrN++) {
+        AAt(FtrN, FtrN) += Gamma * Gamma;
+    }
+    WgtV.Gen(Feats);
+    TNumericalStuff::SolveLinearSystem(AAt, AbV, WgtV);
+}
+
+void TRidgeReg::Decompose() {
+    if (!EigValV.Empty()) { return; }
+
+    const int Feats = GramVV.GetRows();
+    // Householder reduction followed by the QL algorithm, the diagonal
+    // and subdiagonal are indexed from 1
+    EigVecVV = GramVV;
+    TFltV DiagV(Feats+1), SubDiagV(Feats+1);
+    TNumericalStuff::SymetricToTridiag(EigVecVV, Feats, DiagV, SubDiagV);
+    TNumericalStuff::EigSymmetricTridiag(DiagV, SubDiagV, Feats, EigVecVV);
+
+    EigValV.Gen(Feats);
+    for (int EigN = 0; EigN < Feats; EigN++) {
+        EigValV[EigN] = DiagV[EigN+1];
+    }
+
+    ProjAbV.Gen(Feats);
+    TLinAlg::MultiplyT(EigVecVV, AbV, ProjAbV);
+}
+
+void TRidgeReg::SolveDecomposed(const double& _Gamma, TFltV& _WgtV) const {
+    const int Feats = EigValV.Len();
+
+    // x = Q * diag(1 / (s + Gamma^2)) * Q' * A * b, directions where the
+    // system is singular up to rounding errors are left out
+    double MxEigVal = 0;
+    for (int EigN = 0; EigN < Feats; EigN++) {
+        MxEigVal = TFlt::GetMx(MxEigVal, EigValV[EigN]);
+    }
+    const double MnDenom = 1e-12 * MxEigVal;
+
+    TFltV ScaledV(Feats);
+    for (int EigN = 0; EigN < Feats; EigN++) {
+        const double Denom = EigValV[EigN] + _Gamma * _Gamma;
+        ScaledV[EigN] = Denom > MnDenom ? ProjAbV[EigN] / Denom : 0.0;
+    }
+
+    _WgtV.Gen(Feats);
+    TLinAlg::Multiply(EigVecVV, ScaledV, _WgtV);
 }
 
 double TRidgeReg::Predict(const TFltV& x) const {
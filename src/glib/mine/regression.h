@@ -44,19 +44,56 @@ class TRidgeReg {
 private:
     TFlt Gamma;
     TFltV WgtV;
-    
+
+    /// normal equations of the last fit, A * A' and A * b, kept so the model
+    /// can be refitted for a different gamma without going over the data
+    TFltVV GramVV;
+    TFltV AbV;
+    /// eigendecomposition A * A' = Q * diag(s) * Q', computed for the first
+    /// regularization path and shared by all the following ones
+    TFltVV EigVecVV;
+    TFltV EigValV;
+    /// Q' * A * b
+    TFltV ProjAbV;
+
 public:
     TRidgeReg(const double& _Gamma): Gamma(_Gamma) { }
     TRidgeReg(TSIn& SIn) : Gamma(SIn), WgtV(SIn) { }
-    
+
     void Save(TSOut& SOut) const { Gamma.Save(SOut); WgtV.Save(SOut); }
-    
+
+    /// fits the model on instances in the columns of X, the normal equations are
+    /// cached when there are fewer features than instances
     void Fit(const TFltVV& X, const TFltV& y);
+    /// fits the model on instances read from BatchSrc a chunk at a time, solves
+    /// the primal normal equations so only a Dim x Dim matrix is kept in memory;
+    /// when there are no more instances than features, all the instances are
+    /// read and the dual problem is solved instead
+    void Fit(const PFtrBatchSrc& BatchSrc, const TFltV& y);
     double Predict(const TFltV& x) const;
-    
+
+    /// true when the normal equations of the last fit are cached
+    bool IsRefittable() const { return !GramVV.Empty(); }
+    /// sets gamma and recomputes the weights from the cached normal equations
+    void Refit(const double& Gamma);
+    /// computes the weights for each value of gamma into the columns of WgtVV from
+    /// the eigendecomposition of the cached normal equations, each value costs
+    /// O(Dim^2) once the decomposition is done; the model itself is not changed
+    void GetRegPath(const TFltV& GammaV, TFltVV& WgtVV);
+
     const TFltV& GetWgtV() const { return WgtV; }
     double GetGamma() const { return Gamma; }
     void SetGamma(const double& _Gamma) { Gamma = _Gamma; }
+
+private:
+    /// clears the cached normal equations and their decomposition
+    void ClrCache();
+    /// solves the cached normal equations for the current gamma
+    void SolveCached();
+    /// decomposes the cached Gram matrix if it is not decomposed yet
+    void Decompose();
+    /// weights for the given gamma from the decomposition
+    void SolveDecomposed(const double& Gamma, TFltV& WgtV) const;
 };
 
 
@@ -197,22 +197,6 @@ PJsonVal TSumSpVec::GetJson() const {
 
 /////////////////////////////////////////////////
 // Online Min
-void TMin::AddVal(const double& InVal, const uint64& InTmMSecs) {
-    // First we remove all old min candidates that are bigger then the latest value
-    while (!AllValV.Empty() && AllValV.Last().Val1 >= InVal) {
-        AllValV.DelLast();
-    }
-    // Then we remember the new minimum candidate
-    AllValV.Add(TFltUInt64Pr(InVal, InTmMSecs));    
-}
-
-void TMin::DelVal(const uint64& OutTmMSecs) {
-    // forget all candidates older then the outgoing timestamp
-    while (AllValV[0].Val2 <= OutTmMSecs) {
-        AllValV.Del(0);
-    }
-}
-
 void TMin::Load(TSIn& SIn) {
     *this = TMin(SIn);
 }
@@ -220,16 +204,16 @@ void TMin::Load(TSIn& SIn) {
 void TMin::Save(TSOut& SOut) const {
     Min.Save(SOut);
     TmMSecs.Save(SOut);
-    AllValV.Save(SOut);
+    CandQ.Save(SOut);
 }
 
 void TMin::Update(const double& InVal, const uint64& InTmMSecs, const TFltV& OutValV, const TUInt64V& OutTmMSecsV) {
     /// Add new candidates
-    AddVal(InVal, InTmMSecs);
+    CandQ.Add(InVal, InTmMSecs);
     /// Forget old candidates
-    if (!OutTmMSecsV.Empty()) { DelVal(OutTmMSecsV.Last()); }
+    CandQ.DelUntil(OutTmMSecsV);
     /// smallest candidate is the current min
-    Min = AllValV[0].Val1;
+    Min = CandQ.Empty() ? TFlt::Mx : CandQ.GetVal();
     /// remember the current timestamp
     TmMSecs = InTmMSecs;
 }
@@ -237,35 +221,18 @@ void TMin::Update(const double& InVal, const uint64& InTmMSecs, const TFltV& Out
 void TMin::Update(const TFltV& InValV, const TUInt64V& InTmMSecsV, const TFltV& OutValV, const TUInt64V& OutTmMSecsV) {
     /// Add new candidates
     for (int InValN = 0; InValN < InValV.Len(); InValN++) {
-        AddVal(InValV[InValN], InTmMSecsV[InValN]);
+        CandQ.Add(InValV[InValN], InTmMSecsV[InValN]);
     }
     /// Forget old candidates
-    if (!OutTmMSecsV.Empty()) { DelVal(OutTmMSecsV.Last()); }
+    CandQ.DelUntil(OutTmMSecsV);
     /// smallest candidate is the current min
-    Min = AllValV[0].Val1;
+    Min = CandQ.Empty() ? TFlt::Mx : CandQ.GetVal();
     /// remember the current timestamp if we have any new ones
     if (!InTmMSecsV.Empty()) { TmMSecs = InTmMSecsV.Last(); }
 }
 
 /////////////////////////////////////////////////
 // Online Max 
-void TMax::AddVal(const double& InVal, const uint64& InTmMSecs) {
-    // First we remove all old max candidates that are bigger then the latest value
-    while (!AllValV.Empty() && AllValV[AllValV.Len() - 1].Val1 <= InVal) {
-        AllValV.DelLast();
-    }
-    // Then we remember the new maximum candidate
-    AllValV.Add(TFltUInt64Pr(InVal, InTmMSecs));
-}
-
-void TMax::DelVal(const uint64& OutTmMSecs) {
-    // forget all candidates older then the outgoing timestamp
-    while (AllValV[0].Val2 <= OutTmMSecs) {
-        // pop front
-        AllValV.Del(0);
-    }    
-}
-
 void TMax::Load(TSIn& SIn) {
     *this = TMax(SIn);
 }
@@ -274,15 +241,16 @@ void TMax::Save(TSOut& SOut) const {
     // parameters
     Max.Save(SOut);
     TmMSecs.Save(SOut);
-    AllValV.Save(SOut);
+    CandQ.Save(SOut);
 }
+
 void TMax::Update(const double& InVal, const uint64& InTmMSecs, const TFltV& OutValV, const TUInt64V& OutTmMSecsV){
     /// Add new candidates
-    AddVal(InVal, InTmMSecs);
+    CandQ.Add(InVal, InTmMSecs);
     /// Forget old candidates
-    if (!OutTmMSecsV.Empty()) { DelVal(OutTmMSecsV.Last()); }
+    CandQ.DelUntil(OutTmMSecsV);
     /// largest candidate is the current max
-    Max = AllValV[0].Val1;
+    Max = CandQ.Empty() ? TFlt::Mn : CandQ.GetVal();
     /// remember the current timestamp
     TmMSecs = InTmMSecs;
 }
@@ -290,12 +258,12 @@ void TMax::Update(const double& InVal, const uint64& InTmMSecs, const TFltV& Out
 void TMax::Update(const TFltV& InValV, const TUInt64V& InTmMSecsV, const TFltV& OutValV, const TUInt64V& OutTmMSecsV) {
     /// Add new candidates
     for (int InValN = 0; InValN < InValV.Len(); InValN++) {
-        AddVal(InValV[InValN], InTmMSecsV[InValN]);
+        CandQ.Add(InValV[InValN], InTmMSecsV[InValN]);
     }
     /// Forget old candidates
-    if (!OutTmMSecsV.Empty()) { DelVal(OutTmMSecsV.Last()); }
+    CandQ.DelUntil(OutTmMSecsV);
     /// largest candidate is the current max
-    Max = AllValV[0].Val1;
+    Max = CandQ.Empty() ? TFlt::Mn : CandQ.GetVal();
     /// remember the current timestamp if we have any new ones
     if (!InTmMSecsV.Empty()) { TmMSecs = InTmMSecsV.Last(); }
 }
@@ -881,46 +849,69 @@ bool TLinear::CanInterpolate(const uint64& Tm) const {
 }
 
 ///////////////////////////////////////////////////////////////////
-// Neural Networks - Neuron
-TRnd TNNet::TNeuron::Rnd = 0;
-
-TNNet::TNeuron::TNeuron(){
+// Neural Networks - Fully connected layer
+TNNet::TLayer::TLayer(const int& InDim, const int& OutDim, const TTFunc& _TFunc):
+        WgtVV(OutDim, InDim),
+        BiasV(OutDim),
+        TFunc(_TFunc),
+        WgtGradVV(OutDim, InDim),
+        BiasGradV(OutDim) { }
+
+TNNet::TLayer::TLayer(TSIn& SIn):
+        WgtVV(SIn),
+        BiasV(SIn),
+        TFunc(LoadEnum<TTFunc>(SIn)),
+        WgtStepVV(SIn),
+        BiasStepV(SIn),
+        WgtSqVV(SIn),
+        BiasSqV(SIn),
+        WgtGradVV(WgtVV.GetRows(), WgtVV.GetCols()),
+        BiasGradV(BiasV.Len()) { }
+
+void TNNet::TLayer::Save(TSOut& SOut) const {
+    WgtVV.Save(SOut);
+    BiasV.Save(SOut);
+    SaveEnum<TTFunc>(SOut, TFunc);
+    WgtStepVV.Save(SOut);
+    BiasStepV.Save(SOut);
+    WgtSqVV.Save(SOut);
+    BiasSqV.Save(SOut);
+}
+
+void TNNet::TLayer::FeedFwd(const TFltVV& InVV, TFltVV& _SumVV, TFltVV& _OutVV) const {
+    const int Rows = GetOutDim(), Cols = InVV.GetCols();
+    _SumVV.Gen(Rows, Cols);
+    _OutVV.Gen(Rows, Cols);
+    TLinAlg::Multiply(WgtVV, InVV, _SumVV);
+    for (int RowN = 0; RowN < Rows; RowN++) {
+        for (int ColN = 0; ColN < Cols; ColN++) {
+            _SumVV(RowN, ColN) += BiasV[RowN];
+            _OutVV(RowN, ColN) = TransferFcn(TFunc, _SumVV(RowN, ColN));
+        }
+    }
 }
 
-TNNet::TNeuron::TNeuron(TInt OutputsN, TInt MyId, TTFunc TransFunc){
-
-    TFuncNm = TransFunc;
-    for(int c = 0; c < OutputsN; ++c){
-        // define the edges, 0 element is weight, 1 element is weight delta
-        TFlt RandWeight = RandomWeight();
-        OutEdgeV.Add(TIntFltFltTr(c, RandWeight, 0.0));
-        SumDeltaWeight.Add(0.0);
+void TNNet::TLayer::MultiplyDeriv() {
+    for (int RowN = 0; RowN < DeltaVV.GetRows(); RowN++) {
+        for (int ColN = 0; ColN < DeltaVV.GetCols(); ColN++) {
+            DeltaVV(RowN, ColN) *= TransferFcnDeriv(TFunc, SumVV(RowN, ColN), OutVV(RowN, ColN));
+        }
     }
-
-    Id = MyId;
-}
-TNNet::TNeuron::TNeuron(TSIn& SIn){
-    OutputVal.Load(SIn);
-    Gradient.Load(SIn);
-    TFuncNm = LoadEnum<TTFunc>(SIn);
-    SumDeltaWeight.Load(SIn);
-    OutEdgeV.Load(SIn);
-    Id.Load(SIn);
 }
 
-void TNNet::TNeuron::FeedFwd(const TLayer& PrevLayer){
-    TFlt SumIn = 0.0;
-    // get the previous layer's outputs and sum them up
-    for(int NeuronN = 0; NeuronN < PrevLayer.GetNeuronN(); ++NeuronN){
-        SumIn += PrevLayer.GetOutVal(NeuronN) * 
-                PrevLayer.GetWeight(NeuronN, Id);
+void TNNet::TLayer::InitOpt(const TNNetOpt& Opt) {
+    WgtStepVV.Gen(GetOutDim(), GetInDim());
+    BiasStepV.Gen(GetOutDim());
+    if (Opt == nnoAdam) {
+        WgtSqVV.Gen(GetOutDim(), GetInDim());
+        BiasSqV.Gen(GetOutDim());
+    } else {
+        WgtSqVV.Clr(); BiasSqV.Clr();
     }
-    // not sure if static. maybe different fcn for output nodes
-    OutputVal = TNeuron::TransferFcn(SumIn);
 }
 
-TFlt TNNet::TNeuron::TransferFcn(TFlt Sum){
-    switch (TFuncNm){
+double TNNet::TLayer::TransferFcn(const TTFunc& TFunc, const double& Sum) {
+    switch (TFunc){
         case tanHyper:
             // tanh output range [-1.0..1.0]
             // training data should be scaled to what the transfer function can handle
@@ -941,221 +932,268 @@ TFlt TNNet::TNeuron::TransferFcn(TFlt Sum){
            // training data should be scaled to what the transfer function can handle
            return (Sum / 2.0) / (1.0 + fabs(Sum)) + 0.5;
         case linear:
-            return Sum;         
+            return Sum;
+        case relu:
+            // rectified linear unit, output range [0.0..inf]
+            return Sum > 0.0 ? Sum : 0.0;
     };
     throw TExcept::New("Unknown transfer function type");
 }
 
-TFlt TNNet::TNeuron::TransferFcnDeriv(TFlt Sum){
-    switch (TFuncNm){
+double TNNet::TLayer::TransferFcnDeriv(const TTFunc& TFunc, const double& Sum, const double& Out) {
+    switch (TFunc){
         case tanHyper:
-            // tanh derivative approximation
-            return 1.0 - tanh(Sum) * tanh(Sum);
+            return 1.0 - Out * Out;
         case softPlus:
             // softplus derivative
             return 1.0 / (1.0 + exp(-Sum));
-        case sigmoid:{
-           double Fun = 1.0 / (1.0 + exp(-Sum));
-           return Fun * (1.0 - Fun);
-        }
+        case sigmoid:
+           return Out * (1.0 - Out);
         case fastTanh:
            return 1.0 / ((1.0 + fabs(Sum)) * (1.0 + fabs(Sum)));
         case fastSigmoid:
            return 1.0 / (2.0 * (1.0 + fabs(Sum)) * (1.0 + fabs(Sum)));
         case linear:
-            return 1;         
+            return 1;
+        case relu:
+            return Sum > 0.0 ? 1.0 : 0.0;
     };
     throw TExcept::New("Unknown transfer function type");
 }
 
-void TNNet::TNeuron::CalcOutGradient(TFlt TargVal){
-    TFlt Delta = TargVal - OutputVal;
-    // TODO: different ways of calculating gradients
-    Gradient = Delta * TNeuron::TransferFcnDeriv(OutputVal);
-}
-
-void TNNet::TNeuron::CalcHiddenGradient(const TLayer& NextLayer){
-    // calculate error by summing the derivatives of the weights next layer
-    TFlt DerivsOfWeights = SumDOW(NextLayer);
-    Gradient = DerivsOfWeights * TNeuron::TransferFcnDeriv(OutputVal);
-}
-
-TFlt TNNet::TNeuron::SumDOW(const TLayer& NextLayer) const{
-    TFlt sum = 0.0;
-    // sum our contributions of the errors at the nodes we feed
-    for(int NeuronN = 0; NeuronN < NextLayer.GetNeuronN() - 1; ++NeuronN){
-        // weight from us to next layer neuron times its gradient
-        sum += GetWeight(NeuronN) * NextLayer.GetGradient(NeuronN);
-    }
-
-    return sum;
-}
-
-void TNNet::TNeuron::UpdateInputWeights(TLayer& PrevLayer, const TFlt& LearnRate, const TFlt& Momentum, const TBool& UpdateWeights){
-    // the weights to be updated are in the OutEdgeV
-    // in the neurons in the preceding layer
-    for(int NeuronN = 0; NeuronN < PrevLayer.GetNeuronN(); ++NeuronN){
-        TNeuron& Neuron = PrevLayer.GetNeuron(NeuronN);
-        TFlt OldDeltaWeight = Neuron.GetDeltaWeight(Id);
-        //TFlt OldWeight = Neuron.GetWeight(Id);
-        TFlt OldSumDeltaWeight = Neuron.GetSumDeltaWeight(Id);
-        
-        TFlt NewDeltaWeight = 
-                // individual input magnified by the gradient and train rate
-                LearnRate
-                * Neuron.GetOutVal()
-                * Gradient
-                // add momentum = fraction of previous delta weight, if we are not in batch mode
-                + (UpdateWeights  && OldSumDeltaWeight == 0.0 ? Momentum : TFlt())
-                * OldDeltaWeight;
-        
-        if(UpdateWeights){
-            if(OldSumDeltaWeight != 0.0){
-                NewDeltaWeight = OldSumDeltaWeight + NewDeltaWeight;
-                Neuron.SetSumDeltaWeight(Id, 0.0);
-            }
-            Neuron.SetDeltaWeight(Id, NewDeltaWeight);
-            Neuron.UpdateWeight(Id, NewDeltaWeight);
-       }
-        else{
-            Neuron.SumDeltaWeights(Id, NewDeltaWeight);
-        }
-    }
-}
-void TNNet::TNeuron::Save(TSOut& SOut) {
-    OutputVal.Save(SOut);
-    Gradient.Save(SOut);
-    SaveEnum<TTFunc>(SOut, TFuncNm);
-    SumDeltaWeight.Save(SOut);
-    OutEdgeV.Save(SOut);
-    Id.Save(SOut);
-}
-    
-/////////////////////////////////////////////////////////////////////////
-//// Neural Networks - Layer of Neurons
-// TODO: why do we need this empty constructor?
-TNNet::TLayer::TLayer(){
-}
-
-TNNet::TLayer::TLayer(const TInt& NeuronsN, const TInt& OutputsN, const TTFunc& TransFunc){
-    // Add neurons to the layer, plus bias neuron
-    for(int NeuronN = 0; NeuronN <= NeuronsN; ++NeuronN){
-        NeuronV.Add(TNeuron(OutputsN, NeuronN, TransFunc));
-        // debugging
-        /*printf("Made a neuron!");
-        printf(" Neuron N: %d", NeuronN);
-        printf(" Neuron H: %d", NeuronV.Len());
-        printf("\n");*/
-    } 
-    // Force the bias node's output value to 1.0
-    NeuronV.Last().SetOutVal(1.0);
-    //printf("\n");
-}
-TNNet::TLayer::TLayer(TSIn& SIn){
-    NeuronV.Load(SIn);
-}
-void TNNet::TLayer::Save(TSOut& SOut) {
-    NeuronV.Save(SOut);
-}
-
 /////////////////////////////////////////////////////////////////////////
 //// Neural Networks - Neural Net
 TNNet::TNNet(const TIntV& LayoutV, const TFlt& _LearnRate, 
             const TFlt& _Momentum, const TTFunc& TFuncHiddenL,
-            const TTFunc& TFuncOutL){
-    // get number of layers
-    int LayersN = LayoutV.Len();
-    LearnRate = _LearnRate;
-    Momentum = _Momentum;
-    // create each layer
-    for(int LayerN = 0; LayerN < LayersN; ++LayerN){
-        // Get number of neurons in the next layer
-        // set number of output connections, if output layer then no output connections
-        TInt OutputsN = LayerN == LayersN - 1 ? TInt(0) : LayoutV[LayerN + 1];
+            const TTFunc& TFuncOutL, const TNNetOpt& _Opt):
+        InDim(LayoutV.Empty() ? 0 : LayoutV[0].Val),
+        LearnRate(_LearnRate),
+        Momentum(_Momentum),
+        Opt(_Opt),
+        Steps(0) {
+
+    EAssertR(LayoutV.Len() >= 2, "The layout must have at least the input and the output layer!");
+    TRnd Rnd(0);
+    // create each layer, the input layer has no weights
+    for (int LayerN = 1; LayerN < LayoutV.Len(); LayerN++) {
+        EAssertR(LayoutV[LayerN] > 0, "Each layer must have at least one neuron!");
         // set transfer functions for hidden and output layers
-        TTFunc TransFunc = LayerN == LayersN - 1 ? TFuncOutL : TFuncHiddenL;
-        TInt NeuronsN = LayoutV[LayerN];
-        // Add a layer to the net
-        LayerV.Add(TLayer(NeuronsN, OutputsN, TransFunc));
-        //for debugging
-        //printf("LayerV.Len(): %d \n", LayerV.Len() );
+        const TTFunc TransFunc = LayerN == LayoutV.Len() - 1 ? TFuncOutL : TFuncHiddenL;
+        TLayer& Layer = LayerV[LayerV.Add(TLayer(LayoutV[LayerN - 1], LayoutV[LayerN], TransFunc))];
+        for (int RowN = 0; RowN < Layer.GetOutDim(); RowN++) {
+            for (int ColN = 0; ColN < Layer.GetInDim(); ColN++) {
+                Layer.WgtVV(RowN, ColN) = Rnd.GetUniDev();
+            }
+            Layer.BiasV[RowN] = Rnd.GetUniDev();
+        }
+        Layer.InitOpt(Opt);
     }
 }
 
-TNNet::TNNet(TSIn& SIn):
-        LearnRate(SIn),
-        Momentum(SIn) {
-    LayerV.Load(SIn);
+TNNet::TNNet(TSIn& SIn): TNNet(SIn, TFlt(SIn)) { }
+
+TNNet::TNNet(TSIn& SIn, const TFlt& _LearnRate):
+        LearnRate(_LearnRate),
+        Momentum(SIn),
+        Opt(nnoSgd),
+        Steps(0) {
+
+    const int Format = TInt(SIn);
+    if (Format >= 0) {
+        LoadNeuronLayers(SIn);
+    } else {
+        Opt = LoadEnum<TNNetOpt>(SIn);
+        Steps.Load(SIn);
+        InDim.Load(SIn);
+        LayerV.Load(SIn);
+    }
 }
 
 PNNet TNNet::Load(TSIn& SIn) {
     return new TNNet(SIn);
 }
 
+void TNNet::LoadNeuronLayers(TSIn& SIn) {
+    // each neuron kept the weights of its outgoing edges, the last neuron of
+    // each layer is the bias neuron
+    const int Layers = TInt(SIn);
+    TVec<TVec<TVec<TIntFltFltTr> > > EdgeVVV(Layers);
+    TVec<TTFunc> TFuncV(Layers);
+    for (int LayerN = 0; LayerN < Layers; LayerN++) {
+        TInt MxNeurons(SIn); const int Neurons = TInt(SIn);
+        EdgeVVV[LayerN].Gen(Neurons);
+        for (int NeuronN = 0; NeuronN < Neurons; NeuronN++) {
+            TFlt OutputVal(SIn), Gradient(SIn);
+            TFuncV[LayerN] = LoadEnum<TTFunc>(SIn);
+            TFltV SumDeltaWeight(SIn);
+            EdgeVVV[LayerN][NeuronN].Load(SIn);
+            TInt Id(SIn);
+        }
+    }
+    EAssertR(Layers >= 2, "The layout must have at least the input and the output layer!");
+
+    InDim = EdgeVVV[0].Len() - 1;
+    for (int LayerN = 1; LayerN < Layers; LayerN++) {
+        const TVec<TVec<TIntFltFltTr> >& PrevEdgeVV = EdgeVVV[LayerN - 1];
+        const int Ins = PrevEdgeVV.Len() - 1, Outs = EdgeVVV[LayerN].Len() - 1;
+        TLayer& Layer = LayerV[LayerV.Add(TLayer(Ins, Outs, TFuncV[LayerN]))];
+        Layer.InitOpt(Opt);
+        for (int RowN = 0; RowN < Outs; RowN++) {
+            // weight and last weight change of the edge
+            for (int ColN = 0; ColN < Ins; ColN++) {
+                Layer.WgtVV(RowN, ColN) = PrevEdgeVV[ColN][RowN].Val2;
+                Layer.WgtStepVV(RowN, ColN) = PrevEdgeVV[ColN][RowN].Val3;
+            }
+            Layer.BiasV[RowN] = PrevEdgeVV[Ins][RowN].Val2;
+            Layer.BiasStepV[RowN] = PrevEdgeVV[Ins][RowN].Val3;
+        }
+    }
+}
+
 void TNNet::FeedFwd(const TFltV& InValV){
     // check if number of input values same as number of input neurons
-    EAssertR(InValV.Len() == LayerV[0].GetNeuronN() - 1, "InValV must be of equal length than the first layer!");
-    // assign input values to input neurons
-    for(int InputN = 0; InputN < InValV.Len(); ++InputN){
-        LayerV[0].SetOutVal(InputN, InValV[InputN]);
+    EAssertR(InValV.Len() == InDim, "InValV must be of equal length than the first layer!");
+    TFltVV InValVV(InValV.Len(), 1);
+    for (int InputN = 0; InputN < InValV.Len(); InputN++) {
+        InValVV(InputN, 0) = InValV[InputN];
     }
+    FeedFwd(InValVV);
+}
 
+void TNNet::FeedFwd(const TFltVV& InValVV) {
+    EAssertR(InValVV.GetRows() == InDim, "InValV must be of equal length than the first layer!");
+    InVV = InValVV;
     // forward propagation
-    for(int LayerN = 1; LayerN < LayerV.Len(); ++LayerN){
-        TLayer& PrevLayer = LayerV[LayerN - 1];
-        for(int NeuronN = 0; NeuronN < LayerV[LayerN].GetNeuronN() - 1; ++NeuronN){
-            LayerV[LayerN].FeedFwd(NeuronN, PrevLayer);
-        }
+    for (int LayerN = 0; LayerN < LayerV.Len(); LayerN++) {
+        TLayer& Layer = LayerV[LayerN];
+        const TFltVV& PrevOutVV = LayerN == 0 ? InVV : LayerV[LayerN - 1].OutVV;
+        Layer.FeedFwd(PrevOutVV, Layer.SumVV, Layer.OutVV);
     }
 }
 
 void TNNet::BackProp(const TFltV& TargValV, const TBool& UpdateWeights){
-    // calculate overall net error (RMS of output neuron errors)
-    TLayer& OutputLayer = LayerV.Last();
-    Error = 0.0;
+    EAssertR(TargValV.Len() == LayerV.Last().GetOutDim(), "TargValV must be of equal length than the last layer!");
+    TFltVV TargValVV(TargValV.Len(), 1);
+    for (int OutN = 0; OutN < TargValV.Len(); OutN++) {
+        TargValVV(OutN, 0) = TargValV[OutN];
+    }
+    BackProp(TargValVV, UpdateWeights);
+}
 
-    EAssertR(TargValV.Len() == OutputLayer.GetNeuronN() - 1, "TargValV must be of equal length than the last layer!");
-    for(int NeuronN = 0; NeuronN < OutputLayer.GetNeuronN() - 1; ++NeuronN){
-        TFlt Delta = TargValV[NeuronN] - OutputLayer.GetOutVal(NeuronN);
-        Error += Delta * Delta;
+void TNNet::BackProp(const TFltVV& TargValVV, const TBool& UpdateWeights) {
+    TLayer& OutputLayer = LayerV.Last();
+    EAssertR(TargValVV.GetRows() == OutputLayer.GetOutDim(), "TargValV must be of equal length than the last layer!");
+    EAssertR(!OutputLayer.OutVV.Empty() && TargValVV.GetCols() == OutputLayer.OutVV.GetCols(),
+        "The number of targets must be equal to the number of examples of the last feed forward step!");
+    const int Cols = TargValVV.GetCols();
+
+    // gradients of the squared error on the output layer
+    OutputLayer.DeltaVV.Gen(OutputLayer.GetOutDim(), Cols);
+    TLinAlg::LinComb(1.0, OutputLayer.OutVV, -1.0, TargValVV, OutputLayer.DeltaVV);
+    OutputLayer.MultiplyDeriv();
+    // gradients on hidden layers
+    for (int LayerN = LayerV.Len() - 1; LayerN > 0; LayerN--) {
+        const TLayer& Layer = LayerV[LayerN];
+        TLayer& PrevLayer = LayerV[LayerN - 1];
+        PrevLayer.DeltaVV.Gen(PrevLayer.GetOutDim(), Cols);
+        TLinAlg::Multiply(Layer.WgtVV, Layer.DeltaVV, PrevLayer.DeltaVV, TLinAlg::TRANS, TLinAlg::NOTRANS);
+        PrevLayer.MultiplyDeriv();
     }
-    Error /= OutputLayer.GetNeuronN() - 1;
-    Error = sqrt(Error); // RMS
-    
-    // recent avg error measurement
-    RecentAvgError = (RecentAvgError * RecentAvgSmoothingFactor + Error)
-            / (RecentAvgSmoothingFactor + 1.0);
-    // Calculate output layer gradients
-    for(int NeuronN = 0; NeuronN < OutputLayer.GetNeuronN() - 1; ++NeuronN){
-        OutputLayer.CalcOutGradient(NeuronN, TargValV[NeuronN]);
-    }        
-    // Calculate gradients on hidden layers
-    for(int LayerN = LayerV.Len() - 2; LayerN > 0; --LayerN){
-        TLayer& HiddenLayer = LayerV[LayerN];
-        TLayer& NextLayer = LayerV[LayerN + 1];
-
-        for(int NeuronN = 0; NeuronN < HiddenLayer.GetNeuronN() - 1; ++NeuronN){
-            HiddenLayer.CalcHiddenGradient(NeuronN, NextLayer);
+    // accumulate the gradients of the weights
+    for (int LayerN = 0; LayerN < LayerV.Len(); LayerN++) {
+        TLayer& Layer = LayerV[LayerN];
+        const TFltVV& PrevOutVV = LayerN == 0 ? InVV : LayerV[LayerN - 1].OutVV;
+        TLinAlg::Gemm(1.0, Layer.DeltaVV, PrevOutVV, 1.0, Layer.WgtGradVV, Layer.WgtGradVV, TLinAlg::GEMM_B_T);
+        for (int RowN = 0; RowN < Layer.GetOutDim(); RowN++) {
+            for (int ColN = 0; ColN < Cols; ColN++) {
+                Layer.BiasGradV[RowN] += Layer.DeltaVV(RowN, ColN);
+            }
         }
-
     }
-    // For all layers from output to first hidden layer
-    // update connection weights
-    for(int LayerN = LayerV.Len() - 1; LayerN > 0; --LayerN){
+
+    if (UpdateWeights) { ApplyGradients(); }
+}
+
+void TNNet::ApplyGradients() {
+    // Adam parameters, see Kingma and Ba: Adam: A Method for Stochastic Optimization
+    const double Beta1 = 0.9, Beta2 = 0.999, AdamEps = 1e-8;
+    Steps++;
+    const double Corr1 = 1.0 - TMath::Power(Beta1, Steps), Corr2 = 1.0 - TMath::Power(Beta2, Steps);
+    auto Update = [&](TFlt& Wgt, TFlt& Step, TFlt* Sq, TFlt& Grad) {
+        if (Opt == nnoAdam) {
+            Step = Beta1 * Step + (1.0 - Beta1) * Grad;
+            *Sq = Beta2 * (*Sq) + (1.0 - Beta2) * Grad * Grad;
+            Wgt -= LearnRate * (Step / Corr1) / (TMath::Sqrt(*Sq / Corr2) + AdamEps);
+        } else {
+            // fraction of the previous step plus the gradient step
+            Step = Momentum * Step - LearnRate * Grad;
+            Wgt += Step;
+        }
+        Grad = 0.0;
+    };
+    for (int LayerN = 0; LayerN < LayerV.Len(); LayerN++) {
         TLayer& Layer = LayerV[LayerN];
-        TLayer& PrevLayer = LayerV[LayerN - 1];
+        const bool AdamP = Opt == nnoAdam;
+        for (int RowN = 0; RowN < Layer.GetOutDim(); RowN++) {
+            for (int ColN = 0; ColN < Layer.GetInDim(); ColN++) {
+                Update(Layer.WgtVV(RowN, ColN), Layer.WgtStepVV(RowN, ColN),
+                    AdamP ? &Layer.WgtSqVV(RowN, ColN) : nullptr, Layer.WgtGradVV(RowN, ColN));
+            }
+            Update(Layer.BiasV[RowN], Layer.BiasStepV[RowN],
+                AdamP ? &Layer.BiasSqV[RowN] : nullptr, Layer.BiasGradV[RowN]);
+        }
+    }
+}
 
-        for(int NeuronN = 0; NeuronN < Layer.GetNeuronN() - 1; ++NeuronN){
-            Layer.UpdateInputWeights(NeuronN, PrevLayer, LearnRate, Momentum, UpdateWeights);
+void TNNet::Fit(const TFltVV& InValVV, const TFltVV& TargValVV, const int& BatchSize) {
+    EAssertR(InValVV.GetCols() == TargValVV.GetCols(), "The number of inputs and targets must be equal!");
+    const int Cols = InValVV.GetCols();
+    if (BatchSize <= 0 || BatchSize >= Cols) {
+        FeedFwd(InValVV);
+        BackProp(TargValVV);
+        return;
+    }
+    TFltVV InBatchVV, TargBatchVV;
+    for (int FirstColN = 0; FirstColN < Cols; FirstColN += BatchSize) {
+        const int BatchCols = TInt::GetMn(BatchSize, Cols - FirstColN);
+        InBatchVV.Gen(InValVV.GetRows(), BatchCols);
+        TargBatchVV.Gen(TargValVV.GetRows(), BatchCols);
+        for (int ColN = 0; ColN < BatchCols; ColN++) {
+            for (int RowN = 0; RowN < InValVV.GetRows(); RowN++) {
+                InBatchVV(RowN, ColN) = InValVV(RowN, FirstColN + ColN);
+            }
+            for (int RowN = 0; RowN < TargValVV.GetRows(); RowN++) {
+                TargBatchVV(RowN, ColN) = TargValVV(RowN, FirstColN + ColN);
+            }
         }
+        FeedFwd(InBatchVV);
+        BackProp(TargBatchVV);
     }
 }
 
 void TNNet::GetResults(TFltV& ResultV) const{
-    ResultV.Clr(true, -1);
+    const TLayer& OutputLayer = LayerV.Last();
+    if (OutputLayer.OutVV.Empty()) {
+        ResultV.Gen(OutputLayer.GetOutDim());
+    } else {
+        OutputLayer.OutVV.GetCol(OutputLayer.OutVV.GetCols() - 1, ResultV);
+    }
+}
 
-    for(int NeuronN = 0; NeuronN < LayerV.Last().GetNeuronN() - 1; ++NeuronN){
-        ResultV.Add(LayerV.Last().GetOutVal(NeuronN));
+void TNNet::Predict(const TFltVV& InValVV, TFltVV& ResultVV) const {
+    EAssertR(InValVV.GetRows() == InDim, "InValV must be of equal length than the first layer!");
+    TFltVV PrevOutVV = InValVV, SumVV;
+    for (int LayerN = 0; LayerN < LayerV.Len(); LayerN++) {
+        LayerV[LayerN].FeedFwd(PrevOutVV, SumVV, ResultVV);
+        if (LayerN < LayerV.Len() - 1) { PrevOutVV = ResultVV; }
+    }
+}
+
+void TNNet::SetOpt(const TNNetOpt& NewOpt) {
+    if (NewOpt == Opt) { return; }
+    Opt = NewOpt; Steps = 0;
+    for (int LayerN = 0; LayerN < LayerV.Len(); LayerN++) {
+        LayerV[LayerN].InitOpt(Opt);
     }
 }
 
@@ -1164,6 +1202,12 @@ void TNNet::Save(TSOut& SOut) const {
     // Save model variables
     LearnRate.Save(SOut);
     Momentum.Save(SOut);
+    // the per-neuron format saved the (non-negative) capacity of its vector
+    // of layers here, the layer matrix format is marked with -1
+    TInt(-1).Save(SOut);
+    SaveEnum<TNNetOpt>(SOut, Opt);
+    Steps.Save(SOut);
+    InDim.Save(SOut);
     LayerV.Save(SOut);
 }
 
@@ -1181,6 +1225,8 @@ TStr TNNet::GetFunction(const TTFunc& FuncEnum) {
         FuncString = "fastSigmoid";
     } else if (FuncEnum == TSignalProc::TTFunc::linear) {
         FuncString = "linear";
+    } else if (FuncEnum == TSignalProc::TTFunc::relu) {
+        FuncString = "relu";
     } else {
         throw TExcept::New("Unknown transfer function type " + FuncString);
     }
@@ -1365,8 +1411,7 @@ PJsonVal TOnlineHistogram::SaveJson() const {
     return Result;
 }
 
-void TTDigest::Update(const double& V, const double& Count) {
-    Updates++;
+void TTDigest::AddTemp(const double& V, const double& Count) {
     if (TempLast >= TempWeight.Len()) {
         MergeValues();
     }
@@ -1374,9 +1419,38 @@ void TTDigest::Update(const double& V, const double& Count) {
     TempWeight[N_] = Count;
     TempMean[N_] = V;
     UnmergedSum += Count;
+}
+
+void TTDigest::Update(const double& V, const double& Count) {
+    Updates++;
+    AddTemp(V, Count);
+    MergeValues();
+}
+
+void TTDigest::UpdateV(const TFltV& ValV) {
+    for (int ValN = 0; ValN < ValV.Len(); ValN++) {
+        Updates++;
+        AddTemp(ValV[ValN], 1.0);
+    }
     MergeValues();
 }
 
+void TTDigest::Merge(const TTDigest& TDigest) {
+    // centroids of the other digest are added as weighted points
+    if (TDigest.TotalSum > 0.0) {
+        for (int CentroidN = 0; CentroidN <= TDigest.Last; CentroidN++) {
+            AddTemp(TDigest.Mean[CentroidN], TDigest.Weight[CentroidN]);
+        }
+    }
+    for (int TempN = 0; TempN < TDigest.TempLast; TempN++) {
+        AddTemp(TDigest.TempMean[TempN], TDigest.TempWeight[TempN]);
+    }
+    Updates += TDigest.Updates;
+    MergeValues();
+    Min = TMath::Mn(Min, TDigest.Min);
+    Max = TMath::Mx(Max, TDigest.Max);
+}
+
 int TTDigest::GetClusters() const {
     return Mean.Len();
 }
@@ -1414,7 +1488,16 @@ void TTDigest::MergeValues() {
 
     double Sum = 0;
 
-    TempMean.Sort();
+    // sort only the values added since last merge, together with their weights
+    TFltPrV TempMeanWeightV(TempLast, 0);
+    for (int TempN = 0; TempN < TempLast; TempN++) {
+        TempMeanWeightV.Add(TFltPr(TempMean[TempN], TempWeight[TempN]));
+    }
+    TempMeanWeightV.Sort();
+    for (int TempN = 0; TempN < TempLast; TempN++) {
+        TempMean[TempN] = TempMeanWeightV[TempN].Val1;
+        TempWeight[TempN] = TempMeanWeightV[TempN].Val2;
+    }
 
     TInt LastN = 0;
     if (TotalSum > 0.0) {
@@ -1490,9 +1573,11 @@ void TTDigest::MergeValues() {
 
 double TTDigest::MergeCentroid(double& Sum, double& K1, double& Wt, double& Ut) {
     double K2 = Integrate((double)Nc, Sum/TotalSum);
-        if (K2 - K1 <= 1.0 || MergeWeight[Last] == 0.0) {
+        if (K2 - K1 <= 1.0 || MergeWeight[Last] == 0.0 || Last + 1 >= MergeWeight.Len()) {
             // merge into existing centroid if centroid index difference (k2-k1)
-            // is within 1 or if current centroid is empty
+            // is within 1 or if current centroid is empty; heavy weighted points
+            // (e.g. centroids of a merged digest) could otherwise create more
+            // centroids than there is space for
             MergeWeight[Last] += Wt;
             MergeMean[Last] += (Ut - MergeMean[Last]) * Wt / MergeWeight[Last];
         } else {
@@ -1608,6 +1693,187 @@ void TTDigest::Init(const int& N) {
     }
 }
 
+///////////////////////////////
+/// HyperLogLog
+double THyperLogLog::GetAlpha(const int& Regs) {
+    if (Regs <= 16) { return 0.673; }
+    if (Regs <= 32) { return 0.697; }
+    if (Regs <= 64) { return 0.709; }
+    return 0.7213 / (1.0 + 1.079 / (double)Regs);
+}
+
+THyperLogLog::THyperLogLog(const int& _Bits): Bits(_Bits) {
+    EAssertR(4 <= Bits && Bits <= 20, "THyperLogLog: number of bits must be between 4 and 20");
+    RegV.Gen(1 << Bits); RegV.PutAll(0);
+}
+
+uint64 THyperLogLog::GetHash(const TStr& Str) {
+    // FNV-1a, followed by a finalizer to spread the bits
+    uint64 Hash = 14695981039346656037ULL;
+    const char* CStr = Str.CStr();
+    const int Len = Str.Len();
+    for (int ChN = 0; ChN < Len; ChN++) {
+        Hash ^= (uint64)(uchar)CStr[ChN];
+        Hash *= 1099511628211ULL;
+    }
+    return GetHash(Hash);
+}
+
+uint64 THyperLogLog::GetHash(const uint64& Val) {
+    // splitmix64 finalizer
+    uint64 Hash = Val + 0x9E3779B97F4A7C15ULL;
+    Hash = (Hash ^ (Hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    Hash = (Hash ^ (Hash >> 27)) * 0x94D049BB133111EBULL;
+    return Hash ^ (Hash >> 31);
+}
+
+void THyperLogLog::Add(const uint64& Hash) {
+    // first bits select the register ...
+    const int RegN = (int)(Hash >> (64 - Bits));
+    // ... rank is position of first set bit in the rest
+    uint64 Rest = (Hash << Bits) | ((uint64)1 << (Bits - 1));
+    uchar Rank = 1;
+    while ((Rest & 0x8000000000000000ULL) == 0) { Rank++; Rest <<= 1; }
+    if (RegV[RegN].Val < Rank) { RegV[RegN] = Rank; }
+}
+
+void THyperLogLog::Merge(const THyperLogLog& HyperLogLog) {
+    EAssertR(Bits == HyperLogLog.Bits, "THyperLogLog: cannot merge sketches with different number of bits");
+    for (int RegN = 0; RegN < RegV.Len(); RegN++) {
+        if (RegV[RegN].Val < HyperLogLog.RegV[RegN].Val) { RegV[RegN] = HyperLogLog.RegV[RegN]; }
+    }
+}
+
+double THyperLogLog::GetCount() const {
+    const int Regs = RegV.Len();
+    double InvSum = 0.0; int Zeros = 0;
+    for (int RegN = 0; RegN < Regs; RegN++) {
+        InvSum += 1.0 / (double)((uint64)1 << RegV[RegN].Val);
+        if (RegV[RegN].Val == 0) { Zeros++; }
+    }
+    const double Estimate = GetAlpha(Regs) * (double)Regs * (double)Regs / InvSum;
+    // use linear counting for small cardinalities
+    if (Estimate <= 2.5 * (double)Regs && Zeros > 0) {
+        return (double)Regs * TMath::Log((double)Regs / (double)Zeros);
+    }
+    return Estimate;
+}
+
+///////////////////////////////
+/// Count-Min sketch
+TCountMinSketch::TCountMinSketch(const int& _Width, const int& _Depth): Width(_Width), Depth(_Depth) {
+    EAssertR(Width > 0 && Depth > 0, "TCountMinSketch: width and depth must be positive");
+    CountV.Gen(Width * Depth); CountV.PutAll(0);
+}
+
+TCountMinSketch TCountMinSketch::New(const double& Eps, const double& Delta) {
+    EAssertR(0.0 < Eps && Eps < 1.0, "TCountMinSketch: eps must be between 0 and 1");
+    EAssertR(0.0 < Delta && Delta < 1.0, "TCountMinSketch: delta must be between 0 and 1");
+    const int Width = (int)ceil(TMath::E / Eps);
+    const int Depth = (int)ceil(TMath::Log(1.0 / Delta));
+    return TCountMinSketch(Width, TInt::GetMx(Depth, 1));
+}
+
+int TCountMinSketch::GetColN(const uint64& Hash, const int& RowN) const {
+    // double hashing, second hash taken from the upper half and forced odd
+    const uint64 Hash1 = Hash & 0xFFFFFFFFULL;
+    const uint64 Hash2 = (Hash >> 32) | 1ULL;
+    return (int)((Hash1 + (uint64)RowN * Hash2) % (uint64)Width.Val);
+}
+
+void TCountMinSketch::Add(const uint64& Hash, const uint64& Count) {
+    for (int RowN = 0; RowN < Depth; RowN++) {
+        CountV[RowN * Width + GetColN(Hash, RowN)] += Count;
+    }
+    Total += Count;
+}
+
+uint64 TCountMinSketch::GetCount(const uint64& Hash) const {
+    uint64 MnCount = TUInt64::Mx;
+    for (int RowN = 0; RowN < Depth; RowN++) {
+        MnCount = TMath::Mn(MnCount, CountV[RowN * Width + GetColN(Hash, RowN)].Val);
+    }
+    return MnCount;
+}
+
+void TCountMinSketch::Merge(const TCountMinSketch& Sketch) {
+    EAssertR(Width == Sketch.Width && Depth == Sketch.Depth,
+        "TCountMinSketch: cannot merge sketches with different dimensions");
+    for (int CountN = 0; CountN < CountV.Len(); CountN++) {
+        CountV[CountN] += Sketch.CountV[CountN];
+    }
+    Total += Sketch.Total;
+}
+
+///////////////////////////////
+/// Heavy hitters
+THeavyHitters::THeavyHitters(const int& _TopK, const double& Eps, const double& Delta):
+    TopK(_TopK), MxCands(4 * _TopK), Sketch(TCountMinSketch::New(Eps, Delta)) {
+
+    EAssertR(TopK > 0, "THeavyHitters: k must be positive");
+}
+
+void THeavyHitters::Trim() {
+    // keep only the MxCands candidates with largest counts
+    TVec<TPair<TUInt64, TStr> > CountValV(CandH.Len(), 0);
+    int KeyId = CandH.FFirstKeyId();
+    while (CandH.FNextKeyId(KeyId)) {
+        CountValV.Add(TPair<TUInt64, TStr>(CandH[KeyId], CandH.GetKey(KeyId)));
+    }
+    CountValV.Sort(false);
+    CandH.Clr();
+    const int Cands = TInt::GetMn(MxCands, CountValV.Len());
+    for (int CandN = 0; CandN < Cands; CandN++) {
+        CandH.AddDat(CountValV[CandN].Val2, CountValV[CandN].Val1);
+    }
+    MnCandCount = (Cands < MxCands) ? 0 : CountValV[Cands - 1].Val1.Val;
+}
+
+void THeavyHitters::Add(const TStr& Str, const uint64& Count) {
+    const uint64 Hash = THyperLogLog::GetHash(Str);
+    Sketch.Add(Hash, Count);
+    const uint64 Estimate = Sketch.GetCount(Hash);
+    const int KeyId = CandH.GetKeyId(Str);
+    if (KeyId != -1) {
+        // already a candidate, just update the estimate
+        CandH[KeyId] = Estimate;
+    } else if (Estimate > MnCandCount) {
+        CandH.AddDat(Str, Estimate);
+        // let the table grow a bit before trimming, to amortize the sort
+        if (CandH.Len() > 2 * MxCands) { Trim(); }
+    }
+}
+
+void THeavyHitters::Merge(const THeavyHitters& HeavyHitters) {
+    EAssertR(TopK == HeavyHitters.TopK, "THeavyHitters: cannot merge instances with different k");
+    Sketch.Merge(HeavyHitters.Sketch);
+    // union of candidates, counts re-estimated from the merged sketch
+    int KeyId = HeavyHitters.CandH.FFirstKeyId();
+    while (HeavyHitters.CandH.FNextKeyId(KeyId)) {
+        CandH.AddKey(HeavyHitters.CandH.GetKey(KeyId));
+    }
+    KeyId = CandH.FFirstKeyId();
+    while (CandH.FNextKeyId(KeyId)) {
+        CandH[KeyId] = Sketch.GetCount(THyperLogLog::GetHash(CandH.GetKey(KeyId)));
+    }
+    Trim();
+}
+
+void THeavyHitters::GetTopK(TStrV& ValV, TUInt64V& CountV) const {
+    TVec<TPair<TUInt64, TStr> > CountValV(CandH.Len(), 0);
+    int KeyId = CandH.FFirstKeyId();
+    while (CandH.FNextKeyId(KeyId)) {
+        CountValV.Add(TPair<TUInt64, TStr>(CandH[KeyId], CandH.GetKey(KeyId)));
+    }
+    CountValV.Sort(false);
+    const int Vals = TInt::GetMn(TopK, CountValV.Len());
+    ValV.Gen(Vals, 0); CountV.Gen(Vals, 0);
+    for (int ValN = 0; ValN < Vals; ValN++) {
+        ValV.Add(CountValV[ValN].Val2);
+        CountV.Add(CountValV[ValN].Val1);
+    }
+}
+
 TChiSquare::TChiSquare(const PJsonVal& ParamVal): P(TFlt::PInf) {
     // P value is set to infinity by default (null hypothesis is not rejected)
     EAssertR(ParamVal->IsObjKey("degreesOfFreedom"), "TChiSquare: degreesOfFreedom key missing!");
@@ -180,6 +180,298 @@ public:
     PJsonVal GetJson() const;
 };
 
+/////////////////////////////////////////////////
+/// Ring buffer.
+/// Double-ended queue over a power-of-two sized circular array. Push and pop
+/// on both ends are O(1) and do not allocate, except when the buffer grows.
+/// Clearing keeps the memory, so the buffer can be reused without allocations.
+/// Serialized in the same layout as TQQueue.
+template <class TVal>
+class TRingBuf {
+private:
+    /// Circular storage, length is zero or a power of two
+    TVec<TVal> ValV;
+    /// Position of the oldest element
+    TInt FirstValN;
+    /// Number of elements in the buffer
+    TInt Vals;
+
+    /// Position mask, valid when storage is not empty
+    int GetMask() const { return ValV.Len() - 1; }
+    /// Double the storage, moving the oldest element to the start
+    void Grow();
+
+public:
+    TRingBuf(): FirstValN(0), Vals(0) { }
+    TRingBuf(TSIn& SIn): FirstValN(0), Vals(0) { Load(SIn); }
+
+    /// Load from stream (TQQueue layout)
+    void Load(TSIn& SIn);
+    /// Save to stream (TQQueue layout)
+    void Save(TSOut& SOut) const;
+
+    /// Check if buffer is empty
+    bool Empty() const { return Vals == 0; }
+    /// Number of elements in the buffer
+    int Len() const { return Vals; }
+    /// Remove all elements, keeping the memory
+    void Clr() { FirstValN = 0; Vals = 0; }
+
+    /// Add element after the newest one
+    void Push(const TVal& Val) {
+        if (Vals == ValV.Len()) { Grow(); }
+        ValV[(FirstValN + Vals) & GetMask()] = Val; Vals++; }
+    /// Remove the oldest element
+    void PopFront() { Assert(!Empty()); FirstValN = (FirstValN + 1) & GetMask(); Vals--; }
+    /// Remove the newest element
+    void PopBack() { Assert(!Empty()); Vals--; }
+
+    /// The oldest element
+    const TVal& Front() const { Assert(!Empty()); return ValV[FirstValN]; }
+    /// The newest element
+    const TVal& Back() const { Assert(!Empty()); return ValV[(FirstValN + Vals - 1) & GetMask()]; }
+    /// ValN-th element, counting from the oldest
+    const TVal& operator[](const int& ValN) const {
+        Assert(0 <= ValN && ValN < Vals); return ValV[(FirstValN + ValN) & GetMask()]; }
+
+    /// Copy elements to a vector, from oldest to newest
+    void GetValV(TVec<TVal>& _ValV) const;
+};
+
+template <class TVal>
+void TRingBuf<TVal>::Grow() {
+    const int NewLen = ValV.Empty() ? 16 : 2 * ValV.Len();
+    TVec<TVal> NewValV(NewLen);
+    for (int ValN = 0; ValN < Vals; ValN++) {
+        NewValV[ValN] = ValV[(FirstValN + ValN) & GetMask()];
+    }
+    ValV.MoveFrom(NewValV);
+    FirstValN = 0;
+}
+
+template <class TVal>
+void TRingBuf<TVal>::Load(TSIn& SIn) {
+    // TQQueue layout: MxLast, MxLen, Last, Next, ValV
+    TInt MxLast(SIn), MxLen(SIn), Last(SIn), Next(SIn);
+    TVec<TVal> QueueV(SIn);
+    const int QueueVals = (Last >= Next) ? (Last - Next) : (QueueV.Len() - (Next - Last));
+    Clr();
+    for (int ValN = 0; ValN < QueueVals; ValN++) {
+        Push(QueueV[(Next + ValN) % QueueV.Len()]);
+    }
+}
+
+template <class TVal>
+void TRingBuf<TVal>::Save(TSOut& SOut) const {
+    // TQQueue layout with elements from the start and one spare slot
+    TVec<TVal> QueueV(Vals + 1);
+    for (int ValN = 0; ValN < Vals; ValN++) { QueueV[ValN] = (*this)[ValN]; }
+    TInt(64).Save(SOut); TInt(-1).Save(SOut);
+    TInt(Vals).Save(SOut); TInt(0).Save(SOut);
+    QueueV.Save(SOut);
+}
+
+template <class TVal>
+void TRingBuf<TVal>::GetValV(TVec<TVal>& _ValV) const {
+    _ValV.Reserve(Vals, Vals);
+    for (int ValN = 0; ValN < Vals; ValN++) { _ValV[ValN] = (*this)[ValN]; }
+}
+
+/////////////////////////////////////////////////
+/// Monotonic deque for sliding window extremes.
+/// Keeps (value, timestamp) candidates ordered by timestamp, for which
+/// TCmp(older, newer) holds for every neighbouring pair. The front is the
+/// window extreme (TLss gives minimum, TGtr gives maximum). Each value is
+/// added and removed at most once, so updates are O(1) amortized. Late values,
+/// older than the newest candidate, are inserted at their position in O(n).
+/// Serialized as TFltUInt64PrV.
+template <class TCmp>
+class TMonoDeque {
+private:
+    /// Candidates, oldest at the front
+    TRingBuf<TFltUInt64Pr> CandQ;
+
+public:
+    TMonoDeque() { }
+    TMonoDeque(TSIn& SIn) { Load(SIn); }
+
+    /// Load from stream
+    void Load(TSIn& SIn) {
+        TFltUInt64PrV CandV(SIn); CandQ.Clr();
+        for (int CandN = 0; CandN < CandV.Len(); CandN++) { CandQ.Push(CandV[CandN]); } }
+    /// Save to stream
+    void Save(TSOut& SOut) const { TFltUInt64PrV CandV; CandQ.GetValV(CandV); CandV.Save(SOut); }
+
+    /// Check if there are no candidates
+    bool Empty() const { return CandQ.Empty(); }
+    /// Number of candidates
+    int Len() const { return CandQ.Len(); }
+    /// Remove all candidates
+    void Clr() { CandQ.Clr(); }
+
+    /// Add new value, dropping candidates it dominates
+    void Add(const double& Val, const uint64& TmMSecs) {
+        if (!CandQ.Empty() && TmMSecs < CandQ.Back().Val2) { AddLate(Val, TmMSecs); return; }
+        while (!CandQ.Empty() && !TCmp()(CandQ.Back().Val1, Val)) { CandQ.PopBack(); }
+        CandQ.Push(TFltUInt64Pr(Val, TmMSecs)); }
+    /// Add value older than the newest candidate
+    void AddLate(const double& Val, const uint64& TmMSecs);
+    /// Forget candidates with timestamp up to and including given one
+    void DelUntil(const uint64& TmMSecs) {
+        while (!CandQ.Empty() && CandQ.Front().Val2 <= TmMSecs) { CandQ.PopFront(); } }
+    /// Forget candidates with timestamp up to and including the largest given one
+    void DelUntil(const TUInt64V& TmMSecsV) {
+        uint64 MxTmMSecs = 0;
+        for (int TmN = 0; TmN < TmMSecsV.Len(); TmN++) { MxTmMSecs = TMath::Mx<uint64>(MxTmMSecs, TmMSecsV[TmN]); }
+        if (!TmMSecsV.Empty()) { DelUntil(MxTmMSecs); } }
+    /// Current window extreme
+    double GetVal() const { return CandQ.Front().Val1; }
+};
+
+template <class TCmp>
+void TMonoDeque<TCmp>::AddLate(const double& Val, const uint64& TmMSecs) {
+    TFltUInt64PrV CandV; CandQ.GetValV(CandV);
+    // first candidate which stays in the window at least as long as the new value
+    int NextCandN = 0;
+    while (NextCandN < CandV.Len() && CandV[NextCandN].Val2 < TmMSecs) { NextCandN++; }
+    // new value is dominated by it
+    if (NextCandN < CandV.Len() && !TCmp()(Val, CandV[NextCandN].Val1)) { return; }
+    // older candidates dominated by the new value
+    int PrevCandN = NextCandN;
+    while (PrevCandN > 0 && !TCmp()(CandV[PrevCandN - 1].Val1, Val)) { PrevCandN--; }
+    CandQ.Clr();
+    for (int CandN = 0; CandN < PrevCandN; CandN++) { CandQ.Push(CandV[CandN]); }
+    CandQ.Push(TFltUInt64Pr(Val, TmMSecs));
+    for (int CandN = NextCandN; CandN < CandV.Len(); CandN++) { CandQ.Push(CandV[CandN]); }
+}
+
+/////////////////////////////////////////////////
+/// Reordering buffer for event-time processing.
+/// Holds values arriving out of timestamp order and releases them sorted by
+/// timestamp once the watermark passes them. The watermark trails the largest
+/// timestamp seen so far by the allowed lateness and never moves back. Values
+/// older than the watermark cannot be placed in order anymore and are rejected
+/// as late. When more than MxLen values are pending, the oldest are released
+/// early and the watermark moves up to them. Values with equal timestamps are
+/// released in the order they arrived.
+template <class TVal>
+class TReorderBuf {
+private:
+    /// Pending value with its timestamp and arrival number
+    typedef TPair<TUInt64Pr, TVal> TTmVal;
+    /// Puts the oldest pending value on top of the heap
+    class TTmCmp {
+    public:
+        bool operator()(const TTmVal& TmVal1, const TTmVal& TmVal2) const { return TmVal1.Val1 > TmVal2.Val1; }
+    };
+
+    /// How far behind the largest timestamp the watermark is, in milliseconds
+    TUInt64 AllowedLatenessMSecs;
+    /// Maximal number of pending values
+    TInt MxLen;
+    /// Pending values, oldest on top
+    THeap<TTmVal, TTmCmp> PendingHeap;
+    /// Arrival number of the next value
+    TUInt64 NextSeq;
+    /// Did we see any value yet
+    TBool InitP;
+    /// Largest timestamp seen so far
+    TUInt64 MxTmMSecs;
+    /// Values with older timestamps are late
+    TUInt64 WatermarkMSecs;
+    /// Number of rejected late values
+    TUInt64 LateVals;
+
+public:
+    TReorderBuf(const uint64& _AllowedLatenessMSecs = 0, const int& _MxLen = TInt::Mx):
+        AllowedLatenessMSecs(_AllowedLatenessMSecs), MxLen(_MxLen) { }
+    TReorderBuf(TSIn& SIn) { Load(SIn); }
+
+    /// Load from stream
+    void Load(TSIn& SIn);
+    /// Save to stream
+    void Save(TSOut& SOut) const;
+
+    /// Number of pending values
+    int Len() const { return PendingHeap.Len(); }
+    /// Check if there are no pending values
+    bool Empty() const { return PendingHeap.Empty(); }
+    /// Forget pending values and timestamps, keeps parameters
+    void Clr();
+
+    /// How far behind the largest timestamp the watermark is, in milliseconds
+    uint64 GetAllowedLatenessMSecs() const { return AllowedLatenessMSecs; }
+    /// Values with older timestamps are late
+    uint64 GetWatermarkMSecs() const { return WatermarkMSecs; }
+    /// Number of rejected late values
+    uint64 GetLateVals() const { return LateVals; }
+
+    /// Add new value. Returns false and ignores the value when it is late.
+    bool Add(const uint64& TmMSecs, const TVal& Val);
+    /// Move the watermark forward, e.g. when time passes without new values
+    void SetWatermarkMSecs(const uint64& TmMSecs) {
+        if (TmMSecs > WatermarkMSecs) { WatermarkMSecs = TmMSecs; } }
+    /// Release all pending values, e.g. at the end of a stream
+    void SetWatermarkMx() { if (!Empty()) { SetWatermarkMSecs(MxTmMSecs); } }
+    /// Is the oldest pending value ready to be released
+    bool IsNext() const {
+        return !Empty() && (PendingHeap.TopHeap().Val1.Val1 <= WatermarkMSecs || Len() > MxLen); }
+    /// Release the oldest pending value. Returns false when no value is ready.
+    bool Next(uint64& TmMSecs, TVal& Val);
+};
+
+template <class TVal>
+void TReorderBuf<TVal>::Load(TSIn& SIn) {
+    AllowedLatenessMSecs.Load(SIn);
+    MxLen.Load(SIn);
+    TVec<TTmVal> PendingV(SIn);
+    PendingHeap = THeap<TTmVal, TTmCmp>(PendingV);
+    NextSeq.Load(SIn);
+    InitP.Load(SIn);
+    MxTmMSecs.Load(SIn);
+    WatermarkMSecs.Load(SIn);
+    LateVals.Load(SIn);
+}
+
+template <class TVal>
+void TReorderBuf<TVal>::Save(TSOut& SOut) const {
+    AllowedLatenessMSecs.Save(SOut);
+    MxLen.Save(SOut);
+    PendingHeap().Save(SOut);
+    NextSeq.Save(SOut);
+    InitP.Save(SOut);
+    MxTmMSecs.Save(SOut);
+    WatermarkMSecs.Save(SOut);
+    LateVals.Save(SOut);
+}
+
+template <class TVal>
+void TReorderBuf<TVal>::Clr() {
+    PendingHeap().Clr();
+    NextSeq = 0; InitP = false;
+    MxTmMSecs = 0; WatermarkMSecs = 0; LateVals = 0;
+}
+
+template <class TVal>
+bool TReorderBuf<TVal>::Add(const uint64& TmMSecs, const TVal& Val) {
+    if (InitP && TmMSecs < WatermarkMSecs) { LateVals++; return false; }
+    InitP = true;
+    PendingHeap.PushHeap(TTmVal(TUInt64Pr(TmMSecs, NextSeq++), Val));
+    if (TmMSecs > MxTmMSecs) { MxTmMSecs = TmMSecs; }
+    if (MxTmMSecs >= AllowedLatenessMSecs) { SetWatermarkMSecs(MxTmMSecs - AllowedLatenessMSecs); }
+    return true;
+}
+
+template <class TVal>
+bool TReorderBuf<TVal>::Next(uint64& TmMSecs, TVal& Val) {
+    if (!IsNext()) { return false; }
+    TTmVal TmVal = PendingHeap.PopHeap();
+    TmMSecs = TmVal.Val1.Val1; Val = TmVal.Val2;
+    // released early because of the size limit, later values must not be older
+    SetWatermarkMSecs(TmMSecs);
+    return true;
+}
+
 /////////////////////////////////////////////////
 /// Sliding Window Min
 class TMin {
@@ -188,18 +480,12 @@ private:
     TFlt Min;
     /// Timestamp of current min value
     TUInt64 TmMSecs;
-    /// Sorted vector of potential min candidates.
-    /// TODO: Replace TVec with TQQueue
-    TFltUInt64PrV AllValV;
-
-    /// Add new value
-    void AddVal(const double& InVal, const uint64& InTmMSecs);
-    /// Delete old value (we just care for its timestamp)
-    void DelVal(const uint64& OutTmMSecs);
-    
+    /// Increasing sequence of potential min candidates
+    TMonoDeque<TLss<double> > CandQ;
+
 public:
     TMin(): Min(TFlt::Mx) { }
-    TMin(TSIn& SIn): Min(SIn), TmMSecs(SIn), AllValV(SIn) { }
+    TMin(TSIn& SIn): Min(SIn), TmMSecs(SIn), CandQ(SIn) { }
 
     /// Loading from binary stream
     void Load(TSIn& SIn);
@@ -209,7 +495,7 @@ public:
     /// Check if we saw at least one value
     bool IsInit() const { return (TmMSecs > 0); }
     /// Resets the model state
-    void Reset() { Min = TFlt::Mx; TmMSecs = 0; }
+    void Reset() { Min = TFlt::Mx; TmMSecs = 0; CandQ.Clr(); }
     /// Update with a value to add and values to delete    
     void Update(const double& InVal, const uint64& InTmMSecs,
         const TFltV& OutValV, const TUInt64V& OutTmMSecs);
@@ -227,22 +513,16 @@ public:
 // Sliding Window Max
 class TMax {
 private:
-    /// current computed SUM value 
+    /// current computed max value
     TFlt Max;
-    /// timestamp of current MA    
+    /// timestamp of current max value
     TUInt64 TmMSecs;
-    /// Sorted vector of potential min candidates.
-    /// TODO: Replace TVec with TQQueue
-    TFltUInt64PrV AllValV;
-
-    /// Add new value
-    void AddVal(const double& InVal, const uint64& InTmMSecs);
-    /// Delete old value (we just care for its timestamp)
-    void DelVal(const uint64& OutTmMSecs);
-    
+    /// Decreasing sequence of potential max candidates
+    TMonoDeque<TGtr<double> > CandQ;
+
 public:
     TMax(): Max(TFlt::Mn) { };
-    TMax(TSIn& SIn): Max(SIn), TmMSecs(SIn), AllValV(SIn) { }
+    TMax(TSIn& SIn): Max(SIn), TmMSecs(SIn), CandQ(SIn) { }
 
     /// Loading from binary stream
     void Load(TSIn& SIn);
@@ -252,7 +532,7 @@ public:
     /// Check if we saw at least one value
     bool IsInit() const { return (TmMSecs > 0); }
     /// Resets the model state
-    void Reset() { Max = TFlt::Mn; TmMSecs = 0; }
+    void Reset() { Max = TFlt::Mn; TmMSecs = 0; CandQ.Clr(); }
     /// Update with a value to add and values to delete
     void Update(const double& InVal, const uint64& InTmMSecs,
         const TFltV& OutValV, const TUInt64V& OutTmMSecs);
@@ -287,6 +567,7 @@ private:
     
     double GetNi(const double& Alpha, const double& Mi);
 public:
+    TEma(): Type(etPreviousPoint), TmInterval(1.0) { }
     TEma(const double& _Decay, const TEmaType& _Type, 
         const uint64& _InitMinMSecs, const double& _TmInterval);
     TEma(const TEmaType& _Type, const uint64& _InitMinMSecs,
@@ -654,6 +935,7 @@ public:
 
     virtual void SetNextInterpTm(const uint64& Time) = 0;
     virtual double Interpolate(const uint64& Time) const = 0;
+    // once true, must stay true when newer points are added (TMerger relies on it)
     virtual bool CanInterpolate(const uint64& Time) const = 0;
     virtual void AddPoint(const double& Val, const uint64& Tm) = 0;
 };
@@ -736,133 +1018,124 @@ public:
 
 /////////////////////////////////////////
 // Neural Networks - Neural Net
-typedef enum { tanHyper, sigmoid, fastTanh, fastSigmoid, linear, softPlus } TTFunc;
-//class TNNet {
+typedef enum { tanHyper, sigmoid, fastTanh, fastSigmoid, linear, softPlus, relu } TTFunc;
+/// Weight update rules of TNNet: gradient descent with momentum or Adam
+typedef enum { nnoSgd, nnoAdam } TNNetOpt;
+
+/// Feed forward neural network trained with back propagation of the squared
+/// error. The weights of each layer are kept in a dense matrix and examples go
+/// through the network in batches with one example per column, so forward and
+/// backward passes are matrix products.
 ClassTP(TNNet, PNNet) //{
 private:
     /////////////////////////////////////////
-    // Neural Networks - Neuron
-    class TLayer;    
-    class TNeuron {
-    private:
-        static TRnd Rnd; //TODO: initialize it in the constructor with the 0
-
-        TFlt RandomWeight(void) { return TFlt(Rnd.GetUniDev()); }
-        TFlt TransferFcn(TFlt Sum);
-        TFlt TransferFcnDeriv(TFlt Sum); // for back propagation learning
-        // sum derivatives of weights in the next layer
-        TFlt SumDOW(const TLayer& NextLayer) const;
-        TFlt OutputVal;
-        TFlt Gradient;
-        TTFunc TFuncNm; // transfer function name
-        TFltV SumDeltaWeight;
-        // hash containing weight[0] and delta weight[1] for each outgoing edge
-        TVec<TIntFltFltTr> OutEdgeV; 
-        // Id of this neuron
-        TInt Id;
-
-    public:
-        TNeuron();
-        TNeuron(TInt OutputsN, TInt MyId, TTFunc TransFunc);
-        TNeuron(TSIn& SIn);
-
-        void SetOutVal(const TFlt& Val) { OutputVal = Val; }
-        void SetDeltaWeight(const TInt& InNodeId, const TFlt& Val) { OutEdgeV[InNodeId].Val3 = Val; }
-        void SetSumDeltaWeight(const TInt& InNodeId, const TFlt& Val) { SumDeltaWeight[InNodeId] = Val; }
-        void SumDeltaWeights(const TInt& InNodeId, const TFlt& Val) { SumDeltaWeight[InNodeId] += Val; }
-        void UpdateWeight(const TInt& InNodeId, const TFlt& Val) { OutEdgeV[InNodeId].Val2 += Val; }
-        void UpdateInputWeights(TLayer& PrevLayer, const TFlt& LearnRate, const TFlt& Momentum, const TBool& UpdateWeights);
-
-        TFlt GetOutVal(void) const { return OutputVal; }
-        TFlt GetGradient(void) const { return Gradient; }
-        TFlt GetDeltaWeight(const TInt& InNodeId) { return OutEdgeV[InNodeId].Val3; };
-        TFlt GetWeight(const TInt& InNodeId) const { return OutEdgeV[InNodeId].Val2; };
-        TFlt GetSumDeltaWeight(const TInt& InNodeId) const { return SumDeltaWeight[InNodeId]; };
-
-        void FeedFwd(const TLayer& PrevLayer);
-        void CalcOutGradient(TFlt TargVal);
-        void CalcHiddenGradient(const TLayer& NextLayer);
-        // Save the model
-        void Save(TSOut& SOut);
-
-        const TTFunc& GetFunction() { return TFuncNm; }
-    };
-
-    /////////////////////////////////////////
-    // Neural Networks - Layer of neurons
+    // Neural Networks - Fully connected layer
     class TLayer {
-    private:
-        TVec<TNeuron> NeuronV;
-
     public:
-        TLayer();
-        TLayer(const TInt& NeuronsN, const TInt& OutputsN, const TTFunc& TransFunc);
+        TFltVV WgtVV;       // weights, rows are outputs and columns inputs
+        TFltV BiasV;        // bias of each output
+        TTFunc TFunc;       // transfer function
+        // optimizer state: last step (momentum) or first moment (Adam)
+        TFltVV WgtStepVV; TFltV BiasStepV;
+        // optimizer state: second moment (Adam)
+        TFltVV WgtSqVV; TFltV BiasSqV;
+        // gradients accumulated since the last weight update
+        TFltVV WgtGradVV; TFltV BiasGradV;
+        // last batch, one example per column
+        TFltVV SumVV;       // weighted sums of the inputs
+        TFltVV OutVV;       // outputs of the transfer function
+        TFltVV DeltaVV;     // gradient of the error with respect to SumVV
+
+        TLayer(): TFunc(linear) { }
+        TLayer(const int& InDim, const int& OutDim, const TTFunc& _TFunc);
         TLayer(TSIn& SIn);
-
-        int GetNeuronN() const { return NeuronV.Len(); };
-        TNeuron& GetNeuron(const TInt& NeuronN) { return NeuronV[NeuronN]; };
-        TFlt GetOutVal(const TInt& NeuronN) const { return NeuronV[NeuronN].GetOutVal(); };
-        TFlt GetGradient(const TInt& NeuronN) const { return NeuronV[NeuronN].GetGradient(); };
-        TFlt GetWeight(const TInt& NeuronN, const TInt TargetId) const { return NeuronV[NeuronN].GetWeight(TargetId); };
-
-        void SetOutVal(const TInt& NeuronN, const TFlt& Val) { NeuronV[NeuronN].SetOutVal(Val); };
-        void UpdateInputWeights(const TInt& NeuronN, TLayer& PrevLayer,
-        const TFlt& LearnRate, const TFlt& Momentum,
-        const TBool& UpdateWeights) { NeuronV[NeuronN].UpdateInputWeights(PrevLayer, LearnRate, Momentum, UpdateWeights); };
-
-        void CalcOutGradient(int& NeuronN, const TFlt& TargVal) { NeuronV[NeuronN].CalcOutGradient(TargVal); };
-        void CalcHiddenGradient(int& NeuronN, const TLayer& NextLayer) { NeuronV[NeuronN].CalcHiddenGradient(NextLayer); };
-        void FeedFwd(const TInt& NeuronN, const TLayer& PrevLayer) { NeuronV[NeuronN].FeedFwd(PrevLayer); };
-        // Save the model
-        void Save(TSOut& SOut);
+        void Save(TSOut& SOut) const;
+
+        int GetInDim() const { return WgtVV.GetCols(); }
+        int GetOutDim() const { return WgtVV.GetRows(); }
+        /// weighted sums and outputs for the columns of InVV
+        void FeedFwd(const TFltVV& InVV, TFltVV& _SumVV, TFltVV& _OutVV) const;
+        /// multiplies DeltaVV with the derivative of the transfer function
+        void MultiplyDeriv();
+        /// clears the optimizer state for the given optimizer
+        void InitOpt(const TNNetOpt& Opt);
+
+        static double TransferFcn(const TTFunc& TFunc, const double& Sum);
+        // for back propagation learning, Out is the transfer function at Sum
+        static double TransferFcnDeriv(const TTFunc& TFunc, const double& Sum, const double& Out);
     };
 
-    TVec<TLayer> LayerV; 
-    TFlt LearnRate; // [0.0..1.0] learning rate 
-    TFlt Momentum; // [0.0..n] multiplier of last weight change
-    TFlt Error;
-    TFlt RecentAvgError;
-    TFlt RecentAvgSmoothingFactor;
+    TInt InDim;         // number of input neurons
+    TVec<TLayer> LayerV; // hidden and output layers
+    TFlt LearnRate;     // [0.0..1.0] learning rate
+    TFlt Momentum;      // [0.0..n] multiplier of last weight change
+    TNNetOpt Opt;       // weight update rule
+    TInt Steps;         // number of weight updates, used by Adam
+    TFltVV InVV;        // inputs of the last batch
 
+    /// loads the format of the per-neuron implementation, the capacity of its
+    /// vector of layers has already been read
+    void LoadNeuronLayers(TSIn& SIn);
+    /// applies and clears the accumulated gradients
+    void ApplyGradients();
 
 public:
     // constructor
     TNNet(const TIntV& LayoutV, const TFlt& _LearnRate = 0.1, 
             const TFlt& _Momentum = 0.5, const TTFunc& TFuncHiddenL = tanHyper,
-            const TTFunc& TFuncOutL = tanHyper);
-    TNNet(TSIn& SIn); // JOST: A rabim tudi nov PNNet za ta konstruktor?===
+            const TTFunc& TFuncOutL = tanHyper, const TNNetOpt& _Opt = nnoSgd);
+    /// loads the model, also models saved by the per-neuron implementation
+    TNNet(TSIn& SIn);
+    /// loads the model whose learning rate has already been read from the stream
+    TNNet(TSIn& SIn, const TFlt& _LearnRate);
     static PNNet New(const TIntV& LayoutV, const TFlt& _LearnRate = 0.1, 
             const TFlt& _Momentum = 0.5, const TTFunc& TFuncHiddenL = tanHyper,
-            const TTFunc& TFuncOutL = tanHyper)
-            { return new TNNet(LayoutV, _LearnRate, _Momentum, TFuncHiddenL, TFuncOutL); }
+            const TTFunc& TFuncOutL = tanHyper, const TNNetOpt& _Opt = nnoSgd)
+            { return new TNNet(LayoutV, _LearnRate, _Momentum, TFuncHiddenL, TFuncOutL, _Opt); }
     static PNNet Load(TSIn& SIn);
+    static PNNet Load(TSIn& SIn, const TFlt& LearnRate) { return new TNNet(SIn, LearnRate); }
     // Feed forward step
     void FeedFwd(const TFltV& InValV);
-    // Back propagation step
+    /// Feed forward step for a batch with one example per column
+    void FeedFwd(const TFltVV& InValVV);
+    // Back propagation step, when UpdateWeights is false the gradients are
+    // accumulated and applied together with the next update
     void BackProp(const TFltV& TargValV, const TBool& UpdateWeights = true);
-    // TODO: try to make backprop in less for loops
+    /// Back propagation step for the batch of the last FeedFwd, the gradients
+    /// of the examples are summed
+    void BackProp(const TFltVV& TargValVV, const TBool& UpdateWeights = true);
+    /// Trains on the columns of InValVV, one weight update per BatchSize
+    /// columns or one for all of them when BatchSize <= 0
+    void Fit(const TFltVV& InValVV, const TFltVV& TargValVV, const int& BatchSize = -1);
+    // Results of the last example of the last feed forward step
     void GetResults(TFltV& ResultV) const;
+    /// Outputs for the columns of InValVV, does not change the model
+    void Predict(const TFltVV& InValVV, TFltVV& ResultVV) const;
     // Set learn rate
     void SetLearnRate(const TFlt& NewLearnRate) { LearnRate = NewLearnRate; };
     // set momentum
     void SetMomentum(const TFlt& NewMomentum) { Momentum = NewMomentum; }
+    /// sets the weight update rule, clears the state of the previous one
+    void SetOpt(const TNNetOpt& NewOpt);
     // Save the model
     void Save(TSOut& SOut) const;
 
     void GetLayout(TIntV& layout) {
-        layout.Gen(LayerV.Len());
+        layout.Gen(LayerV.Len() + 1);
+        layout[0] = InDim;
         for (int i = 0; i < LayerV.Len(); i++) {
-            layout[i] = LayerV[i].GetNeuronN() - 1;
+            layout[i + 1] = LayerV[i].GetOutDim();
         }
     }
     TFlt GetLearnRate() { return LearnRate; }
     TFlt GetMomentum() { return Momentum; }
+    TNNetOpt GetOpt() const { return Opt; }
     TStr GetTFuncHidden() { 
-        TStr FuncHidden = GetFunction(LayerV[1].GetNeuron(0).GetFunction());
+        TStr FuncHidden = GetFunction(LayerV[0].TFunc);
         return FuncHidden;
     };
     TStr GetTFuncOut() {
-        TStr FuncOut = GetFunction(LayerV[LayerV.Len() - 1].GetNeuron(0).GetFunction());
+        TStr FuncOut = GetFunction(LayerV.Last().TFunc);
         return FuncOut;
     }
     TStr GetFunction(const TTFunc& Func);
@@ -1042,6 +1315,8 @@ private:
     double Boundary(const int& I, const int& J, const TFltV& U, const TFltV& W) const;
 
     void Init(const int& N);
+    // Add weighted point to the temp buffer, merging the buffer if full
+    void AddTemp(const double& V, const double& Count);
 public:
     /// Constructs uninitialized object
     TTDigest() {
@@ -1077,6 +1352,15 @@ public:
     // Argument *count* is the integer number of occurrences to add.
     // If not provided, *count* defaults to 1.
     void Update(const double& V, const double& Count = 1);
+    // Add a vector of values to the t-digest. Values are merged into
+    // centroids only when the temp buffer fills up, which is much faster
+    // than calling Update for each value.
+    void UpdateV(const TFltV& ValV);
+    // Merge centroids of another t-digest into this one. Used to combine
+    // digests computed over disjoint parts of the data.
+    void Merge(const TTDigest& TDigest);
+    // Total weight of the added values
+    double GetCount() const { return TotalSum + UnmergedSum; }
     bool IsInit() const { return Updates >= MinPointsInit; }
     void MergeValues();
     /// Prints the model
@@ -1087,6 +1371,148 @@ public:
     void SaveState(TSOut& SOut) const;
 };
 
+/////////////////////////////////////////////////
+/// HyperLogLog.
+///   Approximate number of distinct values in a stream, using 2^Bits one-byte
+///   registers. Relative standard error is 1.04 / sqrt(2^Bits). Two sketches with
+///   the same number of bits can be merged, giving the sketch of the union.
+///   Paper: Flajolet et al. - http://algo.inria.fr/flajolet/Publications/FlFuGaMe07.pdf
+class THyperLogLog {
+private:
+    /// Number of bits used for register index
+    TInt Bits;
+    /// Registers, holding maximal rank seen for each bucket
+    TUChV RegV;
+
+    /// Bias correction constant for the given number of registers
+    static double GetAlpha(const int& Regs);
+
+public:
+    /// Constructs sketch with 2^Bits registers
+    THyperLogLog(const int& _Bits = 14);
+    /// Constructs from stream
+    THyperLogLog(TSIn& SIn): Bits(SIn), RegV(SIn) { }
+
+    /// Loads the sketch from stream
+    void Load(TSIn& SIn) { Bits.Load(SIn); RegV.Load(SIn); }
+    /// Saves the sketch to stream
+    void Save(TSOut& SOut) const { Bits.Save(SOut); RegV.Save(SOut); }
+
+    /// 64-bit hash of a string, used for feeding strings to sketches
+    static uint64 GetHash(const TStr& Str);
+    /// 64-bit hash of an integer, used for feeding integers to sketches
+    static uint64 GetHash(const uint64& Val);
+
+    /// Adds value given by its 64-bit hash
+    void Add(const uint64& Hash);
+    /// Adds string value
+    void Add(const TStr& Str) { Add(GetHash(Str)); }
+    /// Merges registers of another sketch with the same number of bits
+    void Merge(const THyperLogLog& HyperLogLog);
+    /// Resets the sketch
+    void Clr() { RegV.PutAll(0); }
+
+    /// Estimated number of distinct values
+    double GetCount() const;
+    /// Relative standard error of the estimate
+    double GetRelErr() const { return 1.04 / TMath::Sqrt((double)RegV.Len()); }
+};
+
+/////////////////////////////////////////////////
+/// Count-Min sketch.
+///   Approximate frequencies of values in a stream using Depth rows of Width
+///   counters. Estimates never underestimate and, with probability 1 - Delta, 
+///   overestimate by at most Eps * N, where N is the total count, Width = e / Eps
+///   and Depth = ln(1 / Delta). Sketches with the same dimensions can be merged.
+///   Paper: Cormode, Muthukrishnan - http://dimacs.rutgers.edu/~graham/pubs/papers/cm-full.pdf
+class TCountMinSketch {
+private:
+    /// Number of counters in a row
+    TInt Width;
+    /// Number of rows
+    TInt Depth;
+    /// Counters, row by row
+    TUInt64V CountV;
+    /// Total count of all added values
+    TUInt64 Total;
+
+    /// Counter position in the given row for the given hash
+    int GetColN(const uint64& Hash, const int& RowN) const;
+
+public:
+    /// Constructs sketch with the given dimensions
+    TCountMinSketch(const int& _Width = 2718, const int& _Depth = 5);
+    /// Constructs sketch with given error bound Eps * N, holding with probability 1 - Delta
+    static TCountMinSketch New(const double& Eps, const double& Delta);
+    /// Constructs from stream
+    TCountMinSketch(TSIn& SIn): Width(SIn), Depth(SIn), CountV(SIn), Total(SIn) { }
+
+    /// Loads the sketch from stream
+    void Load(TSIn& SIn) { Width.Load(SIn); Depth.Load(SIn); CountV.Load(SIn); Total.Load(SIn); }
+    /// Saves the sketch to stream
+    void Save(TSOut& SOut) const { Width.Save(SOut); Depth.Save(SOut); CountV.Save(SOut); Total.Save(SOut); }
+
+    /// Adds value given by its 64-bit hash, see THyperLogLog::GetHash
+    void Add(const uint64& Hash, const uint64& Count = 1);
+    /// Estimated count of the value with given hash
+    uint64 GetCount(const uint64& Hash) const;
+    /// Merges counters of another sketch with same dimensions
+    void Merge(const TCountMinSketch& Sketch);
+    /// Resets the sketch
+    void Clr() { CountV.PutAll(0); Total = 0; }
+
+    /// Total count of all added values
+    uint64 GetTotal() const { return Total; }
+    /// Upper bound on overestimate of counts, holds with probability 1 - e^(-Depth)
+    double GetErr() const { return TMath::E * (double)Total / (double)Width; }
+};
+
+/////////////////////////////////////////////////
+/// Heavy hitters.
+///   Approximate top-k most frequent values of a stream. Counts are estimated
+///   by Count-Min sketch, candidates for the top-k are kept in a small hash table
+///   of bounded size. Two instances with same parameters can be merged.
+class THeavyHitters {
+private:
+    /// Number of most frequent values we are interested in
+    TInt TopK;
+    /// Maximal number of candidates kept
+    TInt MxCands;
+    /// Frequency estimates
+    TCountMinSketch Sketch;
+    /// Candidates for the top-k values with their estimated counts
+    TStrUInt64H CandH;
+    /// Smallest estimated count among candidates, used to filter new candidates
+    TUInt64 MnCandCount;
+
+    /// Removes candidates with smallest counts so that at most MxCands remain
+    void Trim();
+
+public:
+    /// Constructs heavy hitters for top-k values with given Count-Min error bounds
+    THeavyHitters(const int& _TopK = 10, const double& Eps = 0.001, const double& Delta = 0.01);
+    /// Constructs from stream
+    THeavyHitters(TSIn& SIn): TopK(SIn), MxCands(SIn), Sketch(SIn), CandH(SIn), MnCandCount(SIn) { }
+
+    /// Loads from stream
+    void Load(TSIn& SIn) { *this = THeavyHitters(SIn); }
+    /// Saves to stream
+    void Save(TSOut& SOut) const { TopK.Save(SOut); MxCands.Save(SOut);
+        Sketch.Save(SOut); CandH.Save(SOut); MnCandCount.Save(SOut); }
+
+    /// Adds value
+    void Add(const TStr& Str, const uint64& Count = 1);
+    /// Merges another instance with same parameters
+    void Merge(const THeavyHitters& HeavyHitters);
+
+    /// Gets top-k values and their estimated counts, sorted by count
+    void GetTopK(TStrV& ValV, TUInt64V& CountV) const;
+    /// Total count of all added values
+    uint64 GetTotal() const { return Sketch.GetTotal(); }
+    /// Upper bound on overestimate of counts
+    double GetErr() const { return Sketch.GetErr(); }
+};
+
 /////////////////////////////////////////////////
 /// Chi square
 class TChiSquare {
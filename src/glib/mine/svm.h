@@ -49,6 +49,38 @@ public:
     }
 };
 
+/// Parameters of the parallel stochastic subgradient solvers
+class TParSgdParam {
+public:
+    /// Number of threads, 0 uses all available
+    TInt Threads;
+    /// Threads update the shared weight vector as they go (hogwild). Faster,
+    /// but the result depends on the scheduling of the threads.
+    TBool HogwildP;
+    /// Stop sampling examples with no loss in several consecutive samplings
+    TBool ShrinkP;
+    /// Number of consecutive samplings with no loss before an example is shrunk
+    TInt ShrinkAfter;
+    /// Fraction of examples held out for early stopping, 0 disables it
+    TFlt ValidFrac;
+    /// Number of iterations between two validation checks
+    TInt ValidIters;
+    /// Number of validation checks without improvement before stopping
+    TInt ValidPatience;
+
+    TParSgdParam(): Threads(1), HogwildP(false), ShrinkP(false), ShrinkAfter(3),
+        ValidFrac(0.0), ValidIters(100), ValidPatience(5) { }
+
+    /// Number of threads to use
+    int GetThreads() const {
+#ifdef GLib_OPENMP
+        return Threads > 0 ? Threads.Val : omp_get_max_threads();
+#else
+        return 1;
+#endif
+    }
+};
+
 // LIBSVM for Eps-Support Vector Regression for sparse input
 inline TLinModel LibSvmSolveRegression(const TVec<TIntFltKdV>& VecV, const TFltV& TargetV,
         const double& Eps, const double& Cost, PNotify DebugNotify, PNotify ErrorNotify) {
@@ -640,6 +672,417 @@ inline TLinModel SolveRegression(const TVecV& VecV, const int& Dims, const int&
 	return TLinModel(WgtV);
 }
 
+///////////////////////////////
+// Helpers for the parallel solvers
+
+/// Adds k * X(:,ColN) to the shared vector z without locking
+inline void AtomicAddVec(const double& k, const TFltVV& X, const int& ColN, TFltV& z) {
+    const int Rows = X.GetRows();
+    for (int RowN = 0; RowN < Rows; RowN++) {
+        const double Val = k * X(RowN, ColN);
+        double& Ref = z[RowN].Val;
+#ifdef GLib_OPENMP
+        #pragma omp atomic
+#endif
+        Ref += Val;
+    }
+}
+
+/// Adds k * X[ColN] to the shared vector z without locking
+inline void AtomicAddVec(const double& k, const TVec<TIntFltKdV>& X, const int& ColN, TFltV& z) {
+    const TIntFltKdV& Vec = X[ColN];
+    for (int ElN = 0; ElN < Vec.Len(); ElN++) {
+        const double Val = k * Vec[ElN].Dat;
+        double& Ref = z[Vec[ElN].Key].Val;
+#ifdef GLib_OPENMP
+        #pragma omp atomic
+#endif
+        Ref += Val;
+    }
+}
+
+/// Adds the updates (coefficient, column) to z. Each thread owns a range of
+/// dimensions and applies the updates in their order, so the result does not
+/// depend on the number of threads.
+inline void AddUpdates(const TFltVV& X, const TVec<TPair<TFlt, TInt> >& UpdateV,
+        TFltV& z, const int& Threads) {
+
+    const int Dims = z.Len();
+    #pragma omp parallel for num_threads(Threads) if(Threads > 1) schedule(static)
+    for (int BlockN = 0; BlockN < Threads; BlockN++) {
+        const int MnDim = int(int64(Dims) * BlockN / Threads);
+        const int MxDim = int(int64(Dims) * (BlockN + 1) / Threads);
+        for (int UpdateN = 0; UpdateN < UpdateV.Len(); UpdateN++) {
+            const double k = UpdateV[UpdateN].Val1; const int ColN = UpdateV[UpdateN].Val2;
+            for (int DimN = MnDim; DimN < MxDim; DimN++) {
+                z[DimN] += k * X(DimN, ColN);
+            }
+        }
+    }
+}
+
+/// Adds the updates (coefficient, column) to z. Each thread owns a range of
+/// dimensions and applies the updates in their order, so the result does not
+/// depend on the number of threads.
+inline void AddUpdates(const TVec<TIntFltKdV>& X, const TVec<TPair<TFlt, TInt> >& UpdateV,
+        TFltV& z, const int& Threads) {
+
+    const int Dims = z.Len();
+    #pragma omp parallel for num_threads(Threads) if(Threads > 1) schedule(static)
+    for (int BlockN = 0; BlockN < Threads; BlockN++) {
+        const int MnDim = int(int64(Dims) * BlockN / Threads);
+        const int MxDim = int(int64(Dims) * (BlockN + 1) / Threads);
+        for (int UpdateN = 0; UpdateN < UpdateV.Len(); UpdateN++) {
+            const double k = UpdateV[UpdateN].Val1;
+            const TIntFltKdV& Vec = X[UpdateV[UpdateN].Val2];
+            // find the first element in our range
+            int ElN = 0, MxElN = Vec.Len();
+            while (ElN < MxElN) {
+                const int MidN = (ElN + MxElN) / 2;
+                if (Vec[MidN].Key < MnDim) { ElN = MidN + 1; } else { MxElN = MidN; }
+            }
+            for (; ElN < Vec.Len() && Vec[ElN].Key < MxDim; ElN++) {
+                z[Vec[ElN].Key] += k * Vec[ElN].Dat;
+            }
+        }
+    }
+}
+
+/// Examples of SolveParSgd kept in a matrix
+template <class TVecV>
+class TSgdMatData {
+private:
+    const TVecV& VecV;
+public:
+    typedef TVecV TDataVV;
+
+    TSgdMatData(const TVecV& _VecV): VecV(_VecV) { }
+    /// makes the examples VecNV available, nothing to do as all are in memory
+    void Load(const TIntV& VecNV) { }
+    /// matrix with the examples of the last Load
+    const TVecV& GetVecV() const { return VecV; }
+    /// column of GetVecV() holding the ElN-th example of the last Load
+    int GetColN(const TIntV& VecNV, const int& ElN) const { return VecNV[ElN]; }
+};
+
+/// Examples of SolveParSgd read from a batch source, only the current batch
+/// is kept in memory
+template <class TVecV>
+class TSgdSrcData {
+private:
+    PFtrBatchSrc BatchSrc;
+    TVecV BatchVV;
+public:
+    typedef TVecV TDataVV;
+
+    TSgdSrcData(const PFtrBatchSrc& _BatchSrc): BatchSrc(_BatchSrc) { }
+    /// reads the examples VecNV from the source
+    void Load(const TIntV& VecNV) { BatchSrc->GetBatch(VecNV, BatchVV); }
+    /// matrix with the examples of the last Load
+    const TVecV& GetVecV() const { return BatchVV; }
+    /// column of GetVecV() holding the ElN-th example of the last Load
+    int GetColN(const TIntV& VecNV, const int& ElN) const { return ElN; }
+};
+
+/// Parallel mini-batch stochastic subgradient solver shared by SolveClassifyPar
+/// and SolveRegressionPar. Margins of a batch are computed in parallel against
+/// the weights of the previous iteration and the updates are then applied by
+/// dimension ranges, which gives the same result for any number of threads.
+/// With Param.HogwildP threads instead update the shared weights as they go.
+/// Examples are accessed through TData (TSgdMatData or TSgdSrcData), which
+/// loads the examples of each batch before they are used.
+template <class TData>
+TLinModel SolveParSgd(TData& Data, const int& Dims, const int& Vecs,
+        const TFltV& TargetV, const bool& ClassifyP, const double& Cost,
+        const double& UnbalanceWgt, const double& Eps, const int& MxMSecs,
+        const int& MxIter, const double& MnDiff, const int& SampleSize,
+        const TParSgdParam& Param, const PNotify& Notify) {
+
+    // asserts for input parameters
+    EAssertR(Dims > 0, "Dimensionality must be positive!");
+    EAssertR(Vecs > 0, "Number of vectors must be positive!");
+    EAssertR(Vecs == TargetV.Len(), "Number of vectors must be equal to the number of targets!");
+    EAssertR(Cost > 0.0, "Cost parameter must be positive!");
+    EAssertR(SampleSize > 0, "Sampling size must be positive!");
+    EAssertR(MxIter > 1, "Number of iterations to small!");
+    EAssertR(0.0 <= Param.ValidFrac && Param.ValidFrac < 1.0, "Validation fraction must be in [0, 1)!");
+
+    const int Threads = Param.GetThreads();
+    Notify->OnStatusFmt("Parallel SGD: %d threads%s%s", Threads,
+        Param.HogwildP ? ", hogwild" : "", Param.ShrinkP ? ", shrinking" : "");
+
+    TRnd Rnd(1);
+    // hold out the validation examples
+    TIntV ValidVecIdV; TBoolV TrainP(Vecs);
+    for (int VecN = 0; VecN < Vecs; VecN++) {
+        TrainP[VecN] = Param.ValidFrac == 0.0 || Rnd.GetUniDev() >= Param.ValidFrac;
+        if (!TrainP[VecN]) { ValidVecIdV.Add(VecN); }
+    }
+    // split training vectors into groups we sample from: positive and negative
+    // for classification, one group for regression
+    const int Groups = ClassifyP ? 2 : 1;
+    TVec<TIntV> PoolV(Groups); TIntV PoolPosV(Vecs); PoolPosV.PutAll(-1);
+    for (int VecN = 0; VecN < Vecs; VecN++) {
+        if (!TrainP[VecN]) { continue; }
+        const int GroupN = (ClassifyP && TargetV[VecN] <= 0.0) ? 1 : 0;
+        PoolPosV[VecN] = PoolV[GroupN].Add(VecN);
+    }
+    TIntV GroupVecsV(Groups);
+    for (int GroupN = 0; GroupN < Groups; GroupN++) { GroupVecsV[GroupN] = PoolV[GroupN].Len(); }
+    const int TrainVecs = TLinAlg::SumVec(GroupVecsV);
+    EAssertR(TrainVecs > 0, "No training vectors left after holding out the validation set!");
+    // sampling ratio between positive and negative, see SolveClassify
+    const double SamplingRatio = ClassifyP ? (double(GroupVecsV[0]) * UnbalanceWgt) /
+        (double(GroupVecsV[0]) * UnbalanceWgt + double(GroupVecsV[1])) : 1.0;
+
+    const double Lambda = 1.0 / (double(TrainVecs) * Cost);
+    // we start with random normal vector of appropriate length
+    TFltV WgtV(Dims); TLinAlgTransform::FillRnd(WgtV, Rnd); TLinAlg::Normalize(WgtV);
+    TLinAlg::MultiplyScalar(1.0 / (2.0 * TMath::Sqrt(Lambda)), WgtV, WgtV);
+    TFltV NewWgtV(Dims);
+
+    // loss of an example and the coefficient of its subgradient
+    auto GetLossCoef = [&](const int& VecN, const double& Pred, double& Coef) {
+        const double Target = TargetV[VecN];
+        if (ClassifyP) {
+            const double CfyVal = Target * Pred;
+            Coef = CfyVal < 1.0 ? Target : 0.0;
+            return TMath::Mx(0.0, 1.0 - CfyVal);
+        } else {
+            const double Loss = Target - Pred;
+            Coef = Loss > Eps ? 1.0 : (Loss < -Eps ? -1.0 : 0.0);
+            return TMath::Mx(0.0, TFlt::Abs(Loss) - Eps);
+        }
+    };
+    // mean loss on the validation set, summed in a fixed order
+    TFltV ValidLossV(ValidVecIdV.Len());
+    auto GetValidLoss = [&](const TFltV& _WgtV) {
+        const int ChunkLen = TInt::GetMx(SampleSize, 1024);
+        for (int FirstN = 0; FirstN < ValidVecIdV.Len(); FirstN += ChunkLen) {
+            TIntV ChunkV; ValidVecIdV.GetSubValV(FirstN, TInt::GetMn(FirstN + ChunkLen, ValidVecIdV.Len()) - 1, ChunkV);
+            Data.Load(ChunkV);
+            const typename TData::TDataVV& VecV = Data.GetVecV();
+            #pragma omp parallel for num_threads(Threads) if(Threads > 1) schedule(static)
+            for (int ElN = 0; ElN < ChunkV.Len(); ElN++) {
+                double Coef;
+                ValidLossV[FirstN + ElN] = GetLossCoef(ChunkV[ElN],
+                    TLinAlg::DotProduct(VecV, Data.GetColN(ChunkV, ElN), _WgtV), Coef);
+            }
+        }
+        return TLinAlg::SumVec(ValidLossV) / double(ValidVecIdV.Len());
+    };
+    // puts back all the shrunk examples
+    TIntV InactiveV(Vecs); bool ShrunkP = false;
+    auto Unshrink = [&]() {
+        for (int GroupN = 0; GroupN < Groups; GroupN++) { PoolV[GroupN].Clr(false); }
+        for (int VecN = 0; VecN < Vecs; VecN++) {
+            if (!TrainP[VecN]) { continue; }
+            const int GroupN = (ClassifyP && TargetV[VecN] <= 0.0) ? 1 : 0;
+            PoolPosV[VecN] = PoolV[GroupN].Add(VecN);
+        }
+        InactiveV.PutAll(0); ShrunkP = false;
+    };
+
+    const bool ValidP = !ValidVecIdV.Empty();
+    TFltV BestWgtV; double BestLoss = TFlt::Mx; int NoImprovChecks = 0;
+    TTmTimer Timer(MxMSecs); int Iters = 0; double Diff = 1.0;
+    Notify->OnStatusFmt("Limits: %d iterations, %.3f seconds, %.8f weight difference", MxIter, (double)MxMSecs / 1000.0, MnDiff);
+    if (ValidP) { Notify->OnStatusFmt("Holding out %d examples for validation", ValidVecIdV.Len()); }
+    auto ProgressNotify = [&]() {
+        Notify->OnStatusFmt("  %d iterations, %.3f seconds, last weight difference %g, active %d/%d",
+            Iters, Timer.GetStopWatch().GetMSec() / 1000.0, Diff,
+            PoolV[0].Len() + (Groups == 2 ? PoolV[1].Len() : 0), TrainVecs);
+    };
+
+    TIntV SampleV(SampleSize), SampleGroupV(SampleSize); TFltV CoefV(SampleSize);
+    TVec<TPair<TFlt, TInt> > UpdateV(SampleSize, 0);
+    for (int IterN = 0; IterN < MxIter; IterN++) {
+        if (IterN % 100 == 0) { ProgressNotify(); }
+
+        // tells how much we can move
+        const double Nu = 1.0 / (Lambda * double(IterN + 2));
+        const double VecUpdate = Nu / double(SampleSize);
+        // shrunk examples have no loss, so we scale the updates by the active
+        // fraction of each group to keep the subgradient estimate unbiased
+        TFltV GroupUpdateV(Groups);
+        for (int GroupN = 0; GroupN < Groups; GroupN++) {
+            GroupUpdateV[GroupN] = GroupVecsV[GroupN] > 0 ? VecUpdate *
+                double(PoolV[GroupN].Len()) / double(GroupVecsV[GroupN]) : 0.0;
+        }
+        // draw the sample, from the other class when all of one are shrunk
+        for (int SampleN = 0; SampleN < SampleSize; SampleN++) {
+            int GroupN = (Groups == 2 && Rnd.GetUniDev() > SamplingRatio) ? 1 : 0;
+            if (PoolV[GroupN].Empty()) { GroupN = 1 - GroupN; }
+            const TIntV& Pool = PoolV[GroupN];
+            SampleGroupV[SampleN] = GroupN;
+            SampleV[SampleN] = Pool[Rnd.GetUniDevInt(Pool.Len())];
+        }
+        Data.Load(SampleV);
+        const typename TData::TDataVV& VecV = Data.GetVecV();
+
+        // initialize updated normal vector
+        TLinAlg::MultiplyScalar(1.0 - Nu * Lambda, WgtV, NewWgtV);
+        if (Param.HogwildP) {
+            // threads update the shared vector without waiting for each other
+            #pragma omp parallel for num_threads(Threads) if(Threads > 1) schedule(static)
+            for (int SampleN = 0; SampleN < SampleSize; SampleN++) {
+                const int ColN = Data.GetColN(SampleV, SampleN);
+                double Coef; GetLossCoef(SampleV[SampleN], TLinAlg::DotProduct(VecV, ColN, NewWgtV), Coef);
+                CoefV[SampleN] = Coef;
+                if (Coef != 0.0) {
+                    AtomicAddVec(GroupUpdateV[SampleGroupV[SampleN]] * Coef, VecV, ColN, NewWgtV);
+                }
+            }
+        } else {
+            // margins with respect to the previous solution
+            #pragma omp parallel for num_threads(Threads) if(Threads > 1) schedule(static)
+            for (int SampleN = 0; SampleN < SampleSize; SampleN++) {
+                const int ColN = Data.GetColN(SampleV, SampleN);
+                double Coef; GetLossCoef(SampleV[SampleN], TLinAlg::DotProduct(VecV, ColN, WgtV), Coef);
+                CoefV[SampleN] = Coef;
+            }
+            UpdateV.Clr(false);
+            for (int SampleN = 0; SampleN < SampleSize; SampleN++) {
+                if (CoefV[SampleN] != 0.0) {
+                    UpdateV.Add(TPair<TFlt, TInt>(GroupUpdateV[SampleGroupV[SampleN]] * CoefV[SampleN],
+                        Data.GetColN(SampleV, SampleN)));
+                }
+            }
+            AddUpdates(VecV, UpdateV, NewWgtV, Threads);
+        }
+
+        // shrink examples which keep having no loss
+        int UpdateCount = 0;
+        for (int SampleN = 0; SampleN < SampleSize; SampleN++) {
+            const int VecN = SampleV[SampleN];
+            if (CoefV[SampleN] != 0.0) { UpdateCount++; InactiveV[VecN] = 0; continue; }
+            if (!Param.ShrinkP || PoolPosV[VecN] < 0) { continue; }
+            if (++InactiveV[VecN] >= Param.ShrinkAfter) {
+                TIntV& Pool = PoolV[SampleGroupV[SampleN]];
+                const int PosN = PoolPosV[VecN];
+                Pool[PosN] = Pool.Last(); PoolPosV[Pool[PosN]] = PosN;
+                Pool.DelLast(); PoolPosV[VecN] = -1;
+                ShrunkP = true;
+            }
+        }
+        // all examples of a group got shrunk
+        for (int GroupN = 0; GroupN < Groups; GroupN++) {
+            if (PoolV[GroupN].Empty() && GroupVecsV[GroupN] > 0) { Unshrink(); break; }
+        }
+
+        if (ClassifyP) {
+            // project the current solution on to a ball
+            const double WgtNorm = 1.0 / (TLinAlg::Norm(NewWgtV) * TMath::Sqrt(Lambda));
+            if (WgtNorm < 1.0) { TLinAlg::MultiplyScalar(WgtNorm, NewWgtV, NewWgtV); }
+        }
+        // compute the difference with respect to the previous iteration
+        Diff = 2.0 * TLinAlg::EuclDist(WgtV, NewWgtV) / (TLinAlg::Norm(WgtV) + TLinAlg::Norm(NewWgtV));
+        WgtV = NewWgtV;
+
+        // count
+        Iters++;
+        // check stopping criteria with respect to time
+        if (Timer.IsTimeUp()) {
+            Notify->OnStatusFmt("Finishing due to reached time limit of %.3f seconds", (double)MxMSecs / 1000.0);
+            break;
+        }
+        // check stopping criteria with respect to the validation loss
+        if (ValidP && Iters % Param.ValidIters == 0) {
+            const double Loss = GetValidLoss(WgtV);
+            if (Loss < BestLoss) {
+                BestLoss = Loss; BestWgtV = WgtV; NoImprovChecks = 0;
+            } else if (++NoImprovChecks >= Param.ValidPatience) {
+                Notify->OnStatusFmt("Finishing due to no improvement of validation loss %g", BestLoss);
+                break;
+            }
+        }
+        // check stopping criteria with respect to result difference
+        if ((!ClassifyP || UpdateCount > 0) && Diff < MnDiff) {
+            if (ShrunkP) {
+                // converged on the active examples, check again on all of them
+                Unshrink();
+            } else {
+                Notify->OnStatusFmt("Finishing due to reached difference limit of %g", MnDiff);
+                break;
+            }
+        }
+    }
+    if (Iters == MxIter) {
+        Notify->OnStatusFmt("Finished due to iteration limit of %d", Iters);
+    }
+    ProgressNotify();
+
+    // return the solution with the lowest validation loss
+    if (ValidP && !BestWgtV.Empty() && GetValidLoss(WgtV) > BestLoss) {
+        WgtV = BestWgtV;
+    }
+    return TLinModel(WgtV);
+}
+
+/// Parallel version of SolveClassify, see SolveParSgd and TParSgdParam
+template <class TVecV>
+TLinModel SolveClassifyPar(const TVecV& VecV, const int& Dims, const int& Vecs,
+        const TFltV& TargetV, const double& Cost, const double& UnbalanceWgt,
+        const int& MxMSecs, const int& MxIter, const double& MnDiff,
+        const int& SampleSize, const TParSgdParam& Param, const PNotify& Notify = TStdNotify::New()) {
+
+    Notify->OnStatusFmt("SVM parameters: c=%.2f, j=%.2f", Cost, UnbalanceWgt);
+    TSgdMatData<TVecV> Data(VecV);
+    return SolveParSgd(Data, Dims, Vecs, TargetV, true, Cost, UnbalanceWgt, 0.0,
+        MxMSecs, MxIter, MnDiff, SampleSize, Param, Notify);
+}
+
+/// Parallel version of SolveRegression, see SolveParSgd and TParSgdParam
+template <class TVecV>
+TLinModel SolveRegressionPar(const TVecV& VecV, const int& Dims, const int& Vecs,
+        const TFltV& TargetV, const double& Cost, const double& Eps,
+        const int& MxMSecs, const int& MxIter, const double& MnDiff,
+        const int& SampleSize, const TParSgdParam& Param, const PNotify& Notify) {
+
+    EAssertR(MnDiff >= 0, "Min difference must be nonnegative!");
+    TSgdMatData<TVecV> Data(VecV);
+    return SolveParSgd(Data, Dims, Vecs, TargetV, false, Cost, 1.0, Eps,
+        MxMSecs, MxIter, MnDiff, SampleSize, Param, Notify);
+}
+
+/// SolveClassifyPar reading the examples from a batch source, one batch of
+/// SampleSize examples per iteration
+inline TLinModel SolveClassifyPar(const PFtrBatchSrc& BatchSrc, const TFltV& TargetV,
+        const double& Cost, const double& UnbalanceWgt, const int& MxMSecs, const int& MxIter,
+        const double& MnDiff, const int& SampleSize, const TParSgdParam& Param,
+        const PNotify& Notify = TStdNotify::New()) {
+
+    Notify->OnStatusFmt("SVM parameters: c=%.2f, j=%.2f", Cost, UnbalanceWgt);
+    if (BatchSrc->IsSparse()) {
+        TSgdSrcData<TVec<TIntFltKdV> > Data(BatchSrc);
+        return SolveParSgd(Data, BatchSrc->GetDim(), BatchSrc->GetInsts(), TargetV, true, Cost,
+            UnbalanceWgt, 0.0, MxMSecs, MxIter, MnDiff, SampleSize, Param, Notify);
+    } else {
+        TSgdSrcData<TFltVV> Data(BatchSrc);
+        return SolveParSgd(Data, BatchSrc->GetDim(), BatchSrc->GetInsts(), TargetV, true, Cost,
+            UnbalanceWgt, 0.0, MxMSecs, MxIter, MnDiff, SampleSize, Param, Notify);
+    }
+}
+
+/// SolveRegressionPar reading the examples from a batch source, one batch of
+/// SampleSize examples per iteration
+inline TLinModel SolveRegressionPar(const PFtrBatchSrc& BatchSrc, const TFltV& TargetV,
+        const double& Cost, const double& Eps, const int& MxMSecs, const int& MxIter,
+        const double& MnDiff, const int& SampleSize, const TParSgdParam& Param,
+        const PNotify& Notify) {
+
+    EAssertR(MnDiff >= 0, "Min difference must be nonnegative!");
+    if (BatchSrc->IsSparse()) {
+        TSgdSrcData<TVec<TIntFltKdV> > Data(BatchSrc);
+        return SolveParSgd(Data, BatchSrc->GetDim(), BatchSrc->GetInsts(), TargetV, false, Cost,
+            1.0, Eps, MxMSecs, MxIter, MnDiff, SampleSize, Param, Notify);
+    } else {
+        TSgdSrcData<TFltVV> Data(BatchSrc);
+        return SolveParSgd(Data, BatchSrc->GetDim(), BatchSrc->GetInsts(), TargetV, false, Cost,
+            1.0, Eps, MxMSecs, MxIter, MnDiff, SampleSize, Param, Notify);
+    }
+}
+
 };
 
 #endif
@@ -146,18 +146,33 @@ TNodeJsSvmModel::TNodeJsSvmModel(const PJsonVal& ParamVal):
 }
 
 TNodeJsSvmModel::TNodeJsSvmModel(TSIn& SIn):
-        Algorithm(SIn),
-        SvmCost(TFlt(SIn)),
-        SvmUnbalance(TFlt(SIn)),
-        SvmEps(TFlt(SIn)),
-        SampleSize(TInt(SIn)),
-        MxIter(TInt(SIn)),
-        MxTime(TInt(SIn)),
-        MnDiff(TFlt(SIn)),
-        Verbose(TBool(SIn)),
-        Notify(TNotify::NullNotify),
-        Model(SIn) {
-
+        Notify(TNotify::NullNotify) {
+
+	// models saved before parallel SGD support start with the (non-negative)
+	// length of the algorithm name, newer models with -1
+	const int Format = TInt(SIn);
+	if (Format >= 0) {
+		char* AlgorithmCStr; SIn.Load(AlgorithmCStr, Format, Format);
+		Algorithm = AlgorithmCStr; delete[] AlgorithmCStr;
+	} else {
+		Algorithm.Load(SIn);
+	}
+	SvmCost = TFlt(SIn);
+	SvmUnbalance = TFlt(SIn);
+	SvmEps = TFlt(SIn);
+	SampleSize = TInt(SIn);
+	MxIter = TInt(SIn);
+	MxTime = TInt(SIn);
+	MnDiff = TFlt(SIn);
+	Verbose = TBool(SIn);
+	Model = TSvm::TLinModel(SIn);
+	if (Format < 0) {
+		ParParam.Threads.Load(SIn);
+		ParParam.HogwildP.Load(SIn);
+		ParParam.ShrinkP.Load(SIn);
+		ParParam.ValidFrac.Load(SIn);
+		ParParam.ValidPatience.Load(SIn);
+	}
 	if (Verbose) { Notify = TNotify::StdNotify; }
 }
 
@@ -354,6 +369,20 @@ void TNodeJsSvmModel::UpdateParams(const PJsonVal& ParamVal) {
 		Verbose = ParamVal->GetObjBool("verbose");
 		Notify = Verbose ? TNotify::StdNotify : TNotify::NullNotify;
 	}
+	if (ParamVal->IsObjKey("threads")) {
+		ParParam.Threads = ParamVal->GetObjInt("threads");
+		EAssertR(ParParam.Threads >= 0, "SVM: threads must be nonnegative!");
+	}
+	if (ParamVal->IsObjKey("hogwild")) ParParam.HogwildP = ParamVal->GetObjBool("hogwild");
+	if (ParamVal->IsObjKey("shrinking")) ParParam.ShrinkP = ParamVal->GetObjBool("shrinking");
+	if (ParamVal->IsObjKey("validationFraction")) {
+		ParParam.ValidFrac = ParamVal->GetObjNum("validationFraction");
+		EAssertR(0.0 <= ParParam.ValidFrac && ParParam.ValidFrac < 1.0, "SVM: validationFraction must be in [0, 1)!");
+	}
+	if (ParamVal->IsObjKey("validationPatience")) {
+		ParParam.ValidPatience = ParamVal->GetObjInt("validationPatience");
+		EAssertR(ParParam.ValidPatience > 0, "SVM: validationPatience must be positive!");
+	}
 }
 
 PJsonVal TNodeJsSvmModel::GetParams() const {
@@ -368,11 +397,17 @@ PJsonVal TNodeJsSvmModel::GetParams() const {
 	ParamVal->AddToObj("maxTime", MxTime / 1000); // convert from miliseconds to seconds
 	ParamVal->AddToObj("minDiff", MnDiff);
 	ParamVal->AddToObj("verbose", Verbose);
+	ParamVal->AddToObj("threads", ParParam.Threads);
+	ParamVal->AddToObj("hogwild", ParParam.HogwildP);
+	ParamVal->AddToObj("shrinking", ParParam.ShrinkP);
+	ParamVal->AddToObj("validationFraction", ParParam.ValidFrac);
+	ParamVal->AddToObj("validationPatience", ParParam.ValidPatience);
 
 	return ParamVal;
 }
 
 void TNodeJsSvmModel::Save(TSOut& SOut) const {
+	TInt(-1).Save(SOut);
 	Algorithm.Save(SOut);
 	TFlt(SvmCost).Save(SOut);
 	TFlt(SvmUnbalance).Save(SOut);
@@ -383,12 +418,167 @@ void TNodeJsSvmModel::Save(TSOut& SOut) const {
 	TFlt(MnDiff).Save(SOut);
 	TBool(Verbose).Save(SOut);
 	Model.Save(SOut);
+	ParParam.Threads.Save(SOut);
+	ParParam.HogwildP.Save(SOut);
+	ParParam.ShrinkP.Save(SOut);
+	ParParam.ValidFrac.Save(SOut);
+	ParParam.ValidPatience.Save(SOut);
 }
 
 void TNodeJsSvmModel::ClrModel() {
 	Model = TSvm::TLinModel();
 }
 
+bool TNodeJsSvmModel::IsParSgd() const {
+	return ParParam.Threads != 1 || ParParam.HogwildP || ParParam.ShrinkP || ParParam.ValidFrac > 0.0;
+}
+
+template <class TVecV>
+TSvm::TLinModel TNodeJsSvmModel::FitSgd(const TVecV& VecV, const int& Dims, const TFltV& TargetV, const bool& ClassifyP) const {
+	const int Vecs = TargetV.Len();
+	if (ClassifyP) {
+		return IsParSgd() ?
+			TSvm::SolveClassifyPar(VecV, Dims, Vecs, TargetV, SvmCost, SvmUnbalance, MxTime, MxIter, MnDiff, SampleSize, ParParam, Notify) :
+			TSvm::SolveClassify(VecV, Dims, Vecs, TargetV, SvmCost, SvmUnbalance, MxTime, MxIter, MnDiff, SampleSize, Notify);
+	} else {
+		return IsParSgd() ?
+			TSvm::SolveRegressionPar(VecV, Dims, Vecs, TargetV, SvmCost, SvmEps, MxTime, MxIter, MnDiff, SampleSize, ParParam, Notify) :
+			TSvm::SolveRegression(VecV, Dims, Vecs, TargetV, SvmCost, SvmEps, MxTime, MxIter, MnDiff, SampleSize, Notify);
+	}
+}
+
+TSvm::TLinModel TNodeJsSvmModel::Fit(const TVec<TIntFltKdV>& VecV, const TFltV& TargetV, const bool& ClassifyP) const {
+	EAssertR(VecV.Len() == TargetV.Len(), "The number of examples and targets must be equal!");
+	if (Algorithm == "SGD") {
+		return FitSgd(VecV, TLinAlgSearch::GetMaxDimIdx(VecV) + 1, TargetV, ClassifyP);
+	}
+	else if (Algorithm == "PR_LOQO") {
+		PSVMTrainSet TrainSet = TRefSparseTrainSet::New(VecV, TargetV);
+		PSVMModel SvmModel = ClassifyP ?
+			TSVMModel::NewClsLinear(TrainSet, SvmCost, SvmUnbalance, TIntV(), TSVMLearnParam::Lin(MxTime, Verbose ? 2 : 0)) :
+			TSVMModel::NewRegLinear(TrainSet, SvmEps, SvmCost, TIntV(), TSVMLearnParam::Lin(MxTime, Verbose ? 2 : 0));
+		return TSvm::TLinModel(SvmModel->GetWgtV(), SvmModel->GetThresh());
+	}
+	else if (Algorithm == "LIBSVM") {
+		return ClassifyP ?
+			TSvm::LibSvmSolveClassify(VecV, TargetV, SvmCost, TQm::TEnv::Debug, TQm::TEnv::Error) :
+			TSvm::LibSvmSolveRegression(VecV, TargetV, SvmEps, SvmCost, TQm::TEnv::Debug, TQm::TEnv::Error);
+	}
+	else {
+		throw TExcept::New("unknown algorithm " + Algorithm);
+	}
+}
+
+TSvm::TLinModel TNodeJsSvmModel::Fit(const TFltVV& VecV, const TFltV& TargetV, const bool& ClassifyP) const {
+	EAssertR(VecV.GetCols() == TargetV.Len(), "The number of examples and targets must be equal!");
+	if (Algorithm == "SGD") {
+		return FitSgd(VecV, VecV.GetRows(), TargetV, ClassifyP);
+	}
+	else if (Algorithm == "PR_LOQO") {
+		PSVMTrainSet TrainSet = TRefDenseTrainSet::New(VecV, TargetV);
+		PSVMModel SvmModel = ClassifyP ?
+			TSVMModel::NewClsLinear(TrainSet, SvmCost, SvmUnbalance, TIntV(), TSVMLearnParam::Lin(MxTime, Verbose ? 2 : 0)) :
+			TSVMModel::NewRegLinear(TrainSet, SvmEps, SvmCost, TIntV(), TSVMLearnParam::Lin(MxTime, Verbose ? 2 : 0));
+		return TSvm::TLinModel(SvmModel->GetWgtV(), SvmModel->GetThresh());
+	}
+	else if (Algorithm == "LIBSVM") {
+		return ClassifyP ?
+			TSvm::LibSvmSolveClassify(VecV, TargetV, SvmCost, TQm::TEnv::Debug, TQm::TEnv::Error) :
+			TSvm::LibSvmSolveRegression(VecV, TargetV, SvmEps, SvmCost, TQm::TEnv::Debug, TQm::TEnv::Error);
+	}
+	else {
+		throw TExcept::New("unknown algorithm " + Algorithm);
+	}
+}
+
+TSvm::TLinModel TNodeJsSvmModel::Fit(const PFtrBatchSrc& BatchSrc, const TFltV& TargetV, const bool& ClassifyP) const {
+	EAssertR(BatchSrc->GetInsts() == TargetV.Len(), "The number of examples and targets must be equal!");
+	if (Algorithm == "SGD" && IsParSgd()) {
+		// the parallel solver only needs one batch at a time
+		return ClassifyP ?
+			TSvm::SolveClassifyPar(BatchSrc, TargetV, SvmCost, SvmUnbalance, MxTime, MxIter, MnDiff, SampleSize, ParParam, Notify) :
+			TSvm::SolveRegressionPar(BatchSrc, TargetV, SvmCost, SvmEps, MxTime, MxIter, MnDiff, SampleSize, ParParam, Notify);
+	}
+	else {
+		// the sequential solver (e.g. the norm trick and the stopping rule of SVR)
+		// and the other algorithms need all the examples, same as for a matrix
+		TVec<TIntFltKdV> VecV; BatchSrc->GetRange(0, BatchSrc->GetInsts(), VecV);
+		return Fit(VecV, TargetV, ClassifyP);
+	}
+}
+
+TNodeJsSvmModel::TFitTask::TFitTask(const v8::FunctionCallbackInfo<v8::Value>& Args, const bool& _ClassifyP):
+		TNodeTask(Args),
+		JsModelObj(),
+		JsModel(nullptr),
+		JsFltVV(nullptr),
+		JsSpVV(nullptr),
+		JsRecSet(nullptr),
+		JsFtrSpace(nullptr),
+		JsTargetV(nullptr),
+		ClassifyP(_ClassifyP) {
+
+	const TStr FunNm = ClassifyP ? "SVC.fit" : "SVR.fit";
+	EAssertR(Args.Length() >= 2, FunNm + ": expecting 2 arguments!");
+
+	JsModelObj.Reset(v8::Isolate::GetCurrent(), Args.Holder());
+	JsModel = ObjectWrap::Unwrap<TNodeJsSvmModel>(Args.Holder());
+
+	int TargetArgN = 1;
+	if (TNodeJsUtil::IsArgWrapObj<TNodeJsSpMat>(Args, 0)) {
+		JsSpVV = TNodeJsUtil::GetArgUnwrapObj<TNodeJsSpMat>(Args, 0);
+	}
+	else if (TNodeJsUtil::IsArgWrapObj<TNodeJsFltVV>(Args, 0)) {
+		JsFltVV = TNodeJsUtil::GetArgUnwrapObj<TNodeJsFltVV>(Args, 0);
+	}
+	else if (TNodeJsUtil::IsArgWrapObj<TNodeJsRecSet>(Args, 0)) {
+		JsRecSet = TNodeJsUtil::UnwrapCheckWatcher<TNodeJsRecSet>(Args[0]->ToObject());
+		EAssertR(TNodeJsUtil::IsArgWrapObj<TNodeJsFtrSpace>(Args, 1), FunNm + ": second argument expected to be a FeatureSpace when fitting a RecordSet!");
+		JsFtrSpace = TNodeJsUtil::GetArgUnwrapObj<TNodeJsFtrSpace>(Args, 1);
+		EAssertR(JsFtrSpace->FtrSpace->IsStartStore(JsRecSet->RecSet->GetStore()->GetStoreId()),
+			FunNm + ": record's and feature extractor's store/source must be the same!");
+		TargetArgN = 2;
+	}
+	else {
+		throw TExcept::New(FunNm + ": Unsupported first argument");
+	}
+
+	// check target vector is actually a vector
+	EAssertR(TNodeJsUtil::IsArgWrapObj<TNodeJsFltV>(Args, TargetArgN), FunNm + ": target argument expected to be la.Vector!");
+	JsTargetV = TNodeJsUtil::GetArgUnwrapObj<TNodeJsFltV>(Args, TargetArgN);
+}
+
+TNodeJsSvmModel::TFitTask::~TFitTask() {
+	JsModelObj.Reset();
+}
+
+v8::Handle<v8::Function> TNodeJsSvmModel::TFitTask::GetCallback(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+	return TNodeJsUtil::GetArgFun(Args, TNodeJsUtil::IsArgWrapObj<TNodeJsRecSet>(Args, 0) ? 3 : 2);
+}
+
+void TNodeJsSvmModel::TFitTask::Run() {
+	try {
+		if (JsRecSet != nullptr) {
+			PFtrBatchSrc BatchSrc = TQm::TFtrSpaceBatchSrc::New(JsFtrSpace->FtrSpace,
+				JsRecSet->RecSet, true, -1, JsModel->ParParam.GetThreads());
+			JsModel->Model = JsModel->Fit(BatchSrc, JsTargetV->Vec, ClassifyP);
+		} else if (JsSpVV != nullptr) {
+			JsModel->Model = JsModel->Fit(JsSpVV->Mat, JsTargetV->Vec, ClassifyP);
+		} else {
+			JsModel->Model = JsModel->Fit(JsFltVV->Mat, JsTargetV->Vec, ClassifyP);
+		}
+	}
+	catch (const PExcept& Except) {
+		SetExcept(TExcept::New(Except->GetMsgStr(), ClassifyP ? "SVC.fit" : "SVR.fit"));
+	}
+}
+
+v8::Local<v8::Value> TNodeJsSvmModel::TFitTask::WrapResult() {
+	v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+	v8::EscapableHandleScope HandleScope(Isolate);
+	return HandleScope.Escape(v8::Local<v8::Object>::New(Isolate, JsModelObj));
+}
+
 ///////////////////////////////
 // QMiner-JavaScript-Support-Vector-Classification
 
@@ -408,6 +598,7 @@ void TNodeJsSVC::Init(v8::Handle<v8::Object> exports) {
 	NODE_SET_PROTOTYPE_METHOD(tpl, "decisionFunction", _decisionFunction);
 	NODE_SET_PROTOTYPE_METHOD(tpl, "predict", _predict);
 	NODE_SET_PROTOTYPE_METHOD(tpl, "fit", _fit);
+	NODE_SET_PROTOTYPE_METHOD(tpl, "fitAsync", _fitAsync);
 
 	// properties
 	tpl->InstanceTemplate()->SetAccessor(v8::String::NewFromUtf8(Isolate, "weights"), _weights);
@@ -415,71 +606,6 @@ void TNodeJsSVC::Init(v8::Handle<v8::Object> exports) {
 	exports->Set(v8::String::NewFromUtf8(Isolate, "SVC"), tpl->GetFunction());
 }
 
-void TNodeJsSVC::fit(const v8::FunctionCallbackInfo<v8::Value>& Args) {
-	v8::Isolate* Isolate = v8::Isolate::GetCurrent();
-	v8::HandleScope HandleScope(Isolate);
-
-	EAssertR(Args.Length() == 2, "SVC.fit: expecting 2 arguments!");
-
-	try {
-		TNodeJsSvmModel* JsModel = ObjectWrap::Unwrap<TNodeJsSvmModel>(Args.Holder());
-
-		// check target vector is actually a vector
-		EAssertR(TNodeJsUtil::IsArgWrapObj<TNodeJsFltV>(Args, 1), "SVC.fit: second argument expected to be la.Vector!");
-		TFltV& ClsV = TNodeJsUtil::GetArgUnwrapObj<TNodeJsFltV>(Args, 1)->Vec;
-
-		if (TNodeJsUtil::IsArgWrapObj<TNodeJsSpMat>(Args, 0)) {
-			TVec<TIntFltKdV>& VecV = ObjectWrap::Unwrap<TNodeJsSpMat>(Args[0]->ToObject())->Mat;
-			if (JsModel->Algorithm == "SGD") {
-				JsModel->Model = TSvm::SolveClassify<TVec<TIntFltKdV>>(VecV, TLinAlgSearch::GetMaxDimIdx(VecV) + 1,
-					VecV.Len(), ClsV, JsModel->SvmCost, JsModel->SvmUnbalance, JsModel->MxTime,
-					JsModel->MxIter, JsModel->MnDiff, JsModel->SampleSize, JsModel->Notify);
-			}
-			else if (JsModel->Algorithm == "PR_LOQO") {
-				PSVMTrainSet TrainSet = TRefSparseTrainSet::New(VecV, ClsV);
-				PSVMModel SvmModel = TSVMModel::NewClsLinear(TrainSet, JsModel->SvmCost, JsModel->SvmUnbalance,
-					TIntV(), TSVMLearnParam::Lin(JsModel->MxTime, JsModel->Verbose ? 2 : 0));
-				JsModel->Model = TSvm::TLinModel(SvmModel->GetWgtV(), SvmModel->GetThresh());
-			}
-			else if (JsModel->Algorithm == "LIBSVM") {
-				JsModel->Model = TSvm::LibSvmSolveClassify(VecV, ClsV, JsModel->SvmCost,
-					TQm::TEnv::Debug, TQm::TEnv::Error);
-			}
-			else {
-				throw TExcept::New("SVC.fit: unknown algorithm " + JsModel->Algorithm);
-			}
-		}
-		else if (TNodeJsUtil::IsArgWrapObj<TNodeJsFltVV>(Args, 0)) {
-			TFltVV& VecV = ObjectWrap::Unwrap<TNodeJsFltVV>(Args[0]->ToObject())->Mat;
-			if (JsModel->Algorithm == "SGD") {
-				JsModel->Model = TSvm::SolveClassify<TFltVV>(VecV, VecV.GetRows(),
-					VecV.GetCols(), ClsV, JsModel->SvmCost, JsModel->SvmUnbalance, JsModel->MxTime,
-					JsModel->MxIter, JsModel->MnDiff, JsModel->SampleSize, JsModel->Notify);
-			}
-			else if (JsModel->Algorithm == "PR_LOQO") {
-				PSVMTrainSet TrainSet = TRefDenseTrainSet::New(VecV, ClsV);
-				PSVMModel SvmModel = TSVMModel::NewClsLinear(TrainSet, JsModel->SvmCost, JsModel->SvmUnbalance,
-					TIntV(), TSVMLearnParam::Lin(JsModel->MxTime, JsModel->Verbose ? 2 : 0));
-				JsModel->Model = TSvm::TLinModel(SvmModel->GetWgtV(), SvmModel->GetThresh());
-			}
-			else if (JsModel->Algorithm == "LIBSVM") {
-				JsModel->Model = TSvm::LibSvmSolveClassify(VecV, ClsV, JsModel->SvmCost,
-					TQm::TEnv::Debug, TQm::TEnv::Error);
-			}
-			else {
-				throw TExcept::New("SVC.fit: unknown algorithm " + JsModel->Algorithm);
-			}
-		}
-		else {
-			throw TExcept::New("SVC.fit: Unsupported first argument");
-		}
-		Args.GetReturnValue().Set(Args.Holder());
-	}
-	catch (const PExcept& Except) {
-		throw TExcept::New(Except->GetMsgStr(), "SVC.fit");
-	}
-}
-
 ///////////////////////////////
 // QMiner-JavaScript-Support-Vector-Regression
 
@@ -499,6 +625,7 @@ void TNodeJsSVR::Init(v8::Handle<v8::Object> exports) {
 	NODE_SET_PROTOTYPE_METHOD(tpl, "decisionFunction", _decisionFunction);
 	NODE_SET_PROTOTYPE_METHOD(tpl, "predict", _decisionFunction);
 	NODE_SET_PROTOTYPE_METHOD(tpl, "fit", _fit);
+	NODE_SET_PROTOTYPE_METHOD(tpl, "fitAsync", _fitAsync);
 
 	// properties
 	tpl->InstanceTemplate()->SetAccessor(v8::String::NewFromUtf8(Isolate, "weights"), _weights);
@@ -506,72 +633,6 @@ void TNodeJsSVR::Init(v8::Handle<v8::Object> exports) {
 	exports->Set(v8::String::NewFromUtf8(Isolate, "SVR"), tpl->GetFunction());
 }
 
-void TNodeJsSVR::fit(const v8::FunctionCallbackInfo<v8::Value>& Args) {
-	v8::Isolate* Isolate = v8::Isolate::GetCurrent();
-	v8::HandleScope HandleScope(Isolate);
-
-	EAssertR(Args.Length() == 2, "SVR.fit: expecting 2 arguments!");
-
-	try {
-		TNodeJsSvmModel* JsModel = ObjectWrap::Unwrap<TNodeJsSvmModel>(Args.Holder());
-
-		// check target vector is actually a vector
-		EAssertR(TNodeJsUtil::IsArgWrapObj<TNodeJsFltV>(Args, 1), "SVR.fit: second argument expected to be la.Vector!");
-		TFltV& ClsV = TNodeJsUtil::GetArgUnwrapObj<TNodeJsFltV>(Args, 1)->Vec;
-
-
-		if (TNodeJsUtil::IsArgWrapObj<TNodeJsSpMat>(Args, 0)) {
-			TVec<TIntFltKdV>& VecV = ObjectWrap::Unwrap<TNodeJsSpMat>(Args[0]->ToObject())->Mat;
-			if (JsModel->Algorithm == "SGD") {
-				JsModel->Model = TSvm::SolveRegression<TVec<TIntFltKdV>>(VecV, TLinAlgSearch::GetMaxDimIdx(VecV) + 1,
-					VecV.Len(), ClsV, JsModel->SvmCost, JsModel->SvmEps, JsModel->MxTime,
-					JsModel->MxIter, JsModel->MnDiff, JsModel->SampleSize, JsModel->Notify);
-			}
-			else if (JsModel->Algorithm == "PR_LOQO") {
-				PSVMTrainSet TrainSet = TRefSparseTrainSet::New(VecV, ClsV);
-				PSVMModel SvmModel = TSVMModel::NewRegLinear(TrainSet, JsModel->SvmEps, JsModel->SvmCost,
-					TIntV(), TSVMLearnParam::Lin(JsModel->MxTime, JsModel->Verbose ? 2 : 0));
-				JsModel->Model = TSvm::TLinModel(SvmModel->GetWgtV(), SvmModel->GetThresh());
-			}
-			else if (JsModel->Algorithm == "LIBSVM") {
-				JsModel->Model = TSvm::LibSvmSolveRegression(VecV, ClsV, JsModel->SvmEps, JsModel->SvmCost,
-					TQm::TEnv::Debug, TQm::TEnv::Error);
-			}
-			else {
-				throw TExcept::New("SVR.fit: unknown algorithm " + JsModel->Algorithm);
-			}
-		}
-		else if (TNodeJsUtil::IsArgWrapObj<TNodeJsFltVV>(Args, 0)) {
-			TFltVV& VecV = ObjectWrap::Unwrap<TNodeJsFltVV>(Args[0]->ToObject())->Mat;
-			if (JsModel->Algorithm == "SGD") {
-				JsModel->Model = TSvm::SolveRegression<TFltVV>(VecV, VecV.GetRows(),
-					VecV.GetCols(), ClsV, JsModel->SvmCost, JsModel->SvmEps, JsModel->MxTime,
-					JsModel->MxIter, JsModel->MnDiff, JsModel->SampleSize, JsModel->Notify);
-			}
-			else if (JsModel->Algorithm == "PR_LOQO") {
-				PSVMTrainSet TrainSet = TRefDenseTrainSet::New(VecV, ClsV);
-				PSVMModel SvmModel = TSVMModel::NewRegLinear(TrainSet, JsModel->SvmEps, JsModel->SvmCost,
-					TIntV(), TSVMLearnParam::Lin(JsModel->MxTime, JsModel->Verbose ? 2 : 0));
-				JsModel->Model = TSvm::TLinModel(SvmModel->GetWgtV(), SvmModel->GetThresh());
-			}
-			else if (JsModel->Algorithm == "LIBSVM") {
-				JsModel->Model = TSvm::LibSvmSolveRegression(VecV, ClsV, JsModel->SvmEps, JsModel->SvmCost,
-					TQm::TEnv::Debug, TQm::TEnv::Error);
-			}
-			else {
-				throw TExcept::New("SVR.fit: unknown algorithm " + JsModel->Algorithm);
-			}
-		}
-		else {
-			throw TExcept::New("SVR.fit: Unsupported first argument");
-		}
-		Args.GetReturnValue().Set(Args.Holder());
-	}
-	catch (const PExcept& Except) {
-		throw TExcept::New(Except->GetMsgStr(), "SVR.fit");
-	}
-}
-
 /////////////////////////////////////////////
 // Ridge Regression
 void TNodeJsRidgeReg::Init(v8::Handle<v8::Object> exports) {
@@ -587,6 +648,7 @@ void TNodeJsRidgeReg::Init(v8::Handle<v8::Object> exports) {
 	NODE_SET_PROTOTYPE_METHOD(tpl, "getParams", _getParams);
 	NODE_SET_PROTOTYPE_METHOD(tpl, "setParams", _setParams);
 	NODE_SET_PROTOTYPE_METHOD(tpl, "fit", _fit);
+	NODE_SET_PROTOTYPE_METHOD(tpl, "regularizationPath", _regularizationPath);
 	NODE_SET_PROTOTYPE_METHOD(tpl, "decisionFunction", _predict);
 	NODE_SET_PROTOTYPE_METHOD(tpl, "predict", _predict);
 	NODE_SET_PROTOTYPE_METHOD(tpl, "save", _save);
@@ -648,7 +710,12 @@ void TNodeJsRidgeReg::setParams(const v8::FunctionCallbackInfo<v8::Value>& Args)
 		// set the parameters
 		PJsonVal ParamVal = TNodeJsUtil::GetArgJson(Args, 0);
 		const double Gamma = ParamVal->GetObjNum("gamma");
-		JsModel->Model.SetGamma(Gamma);
+		if (JsModel->Model.IsRefittable()) {
+			// the data need not be passed again
+			JsModel->Model.Refit(Gamma);
+		} else {
+			JsModel->Model.SetGamma(Gamma);
+		}
 
 		Args.GetReturnValue().Set(Args.Holder());
 	}
@@ -665,6 +732,20 @@ void TNodeJsRidgeReg::fit(const v8::FunctionCallbackInfo<v8::Value>& Args) {
 
 	TNodeJsRidgeReg* JsModel = ObjectWrap::Unwrap<TNodeJsRidgeReg>(Args.Holder());
 
+	if (TNodeJsUtil::IsArgWrapObj<TNodeJsRecSet>(Args, 0)) {
+		// extract the features of the records a chunk at a time
+		EAssertR(Args.Length() >= 3, "RidgeReg.fit: expects 3 arguments when fitting a RecordSet!");
+		TNodeJsRecSet* JsRecSet = TNodeJsUtil::UnwrapCheckWatcher<TNodeJsRecSet>(Args[0]->ToObject());
+		EAssertR(TNodeJsUtil::IsArgWrapObj<TNodeJsFtrSpace>(Args, 1), "RidgeReg.fit: second argument expected to be a FeatureSpace when fitting a RecordSet!");
+		TNodeJsFtrSpace* JsFtrSpace = TNodeJsUtil::GetArgUnwrapObj<TNodeJsFtrSpace>(Args, 1);
+		EAssertR(JsFtrSpace->FtrSpace->IsStartStore(JsRecSet->RecSet->GetStore()->GetStoreId()),
+			"RidgeReg.fit: record's and feature extractor's store/source must be the same!");
+		TNodeJsFltV* ResponseJsV = ObjectWrap::Unwrap<TNodeJsFltV>(Args[2]->ToObject());
+		JsModel->Model.Fit(TQm::TFtrSpaceBatchSrc::New(JsFtrSpace->FtrSpace, JsRecSet->RecSet, false), ResponseJsV->Vec);
+		Args.GetReturnValue().Set(Args.Holder());
+		return;
+	}
+
 	// get the arguments
 	TNodeJsFltVV* InstanceMat = ObjectWrap::Unwrap<TNodeJsFltVV>(Args[0]->ToObject());
 	TNodeJsFltV* ResponseJsV = ObjectWrap::Unwrap<TNodeJsFltV>(Args[1]->ToObject());
@@ -674,6 +755,27 @@ void TNodeJsRidgeReg::fit(const v8::FunctionCallbackInfo<v8::Value>& Args) {
 	Args.GetReturnValue().Set(Args.Holder());
 }
 
+void TNodeJsRidgeReg::regularizationPath(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+	v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+	v8::HandleScope HandleScope(Isolate);
+
+	EAssertR(Args.Length() == 1, "RidgeReg.regularizationPath: expects 1 argument!");
+
+	TNodeJsRidgeReg* JsModel = ObjectWrap::Unwrap<TNodeJsRidgeReg>(Args.Holder());
+
+	TFltV GammaV;
+	if (TNodeJsUtil::IsArgWrapObj<TNodeJsFltV>(Args, 0)) {
+		GammaV = TNodeJsUtil::GetArgUnwrapObj<TNodeJsFltV>(Args, 0)->Vec;
+	} else {
+		TNodeJsUtil::GetArgFltV(Args, 0, GammaV);
+	}
+
+	TFltVV WgtVV;
+	JsModel->Model.GetRegPath(GammaV, WgtVV);
+
+	Args.GetReturnValue().Set(TNodeJsFltVV::New(WgtVV));
+}
+
 void TNodeJsRidgeReg::predict(const v8::FunctionCallbackInfo<v8::Value>& Args) {
 	v8::Isolate* Isolate = v8::Isolate::GetCurrent();
 	v8::HandleScope HandleScope(Isolate);
@@ -926,14 +1028,32 @@ void TNodeJsNNAnomalies::SetParams(const PJsonVal& ParamVal) {
     }
     // if empty, use 0.05
     if (RateV.Empty()) { RateV.Add(0.05); }
+    // parse approximate index parameters, exact search when not given
+    int AnnEfSearch = 0, AnnM = 16, AnnEfConstruction = 100;
+    if (ParamVal->IsObjKey("ann")) {
+        PJsonVal AnnVal = ParamVal->GetObjKey("ann");
+        AnnEfSearch = AnnVal->GetObjInt("efSearch", 50);
+        AnnM = AnnVal->GetObjInt("M", AnnM);
+        AnnEfConstruction = AnnVal->GetObjInt("efConstruction", AnnEfConstruction);
+        EAssertR(AnnEfSearch > 0, "NearestNeighborAD: ann.efSearch must be positive!");
+    }
     // create model
-	Model = TAnomalyDetection::TNearestNeighbor(RateV, ParamVal->GetObjInt("windowSize", 100));
+	Model = TAnomalyDetection::TNearestNeighbor(RateV, ParamVal->GetObjInt("windowSize", 100),
+        AnnEfSearch, AnnM, AnnEfConstruction);
 }
 
 PJsonVal TNodeJsNNAnomalies::GetParams() const {
 	PJsonVal ParamVal = TJsonVal::NewObj();
 	ParamVal->AddToObj("rate", TJsonVal::NewArr(Model.GetRateV()));
 	ParamVal->AddToObj("windowSize", Model.GetWindowSize());
+    if (Model.IsAnn()) {
+        const TAnomalyDetection::THnswIndex& Index = Model.GetIndex();
+        PJsonVal AnnVal = TJsonVal::NewObj();
+        AnnVal->AddToObj("efSearch", Index.GetEfSearch());
+        AnnVal->AddToObj("M", Index.GetM());
+        AnnVal->AddToObj("efConstruction", Index.GetEfConstruction());
+        ParamVal->AddToObj("ann", AnnVal);
+    }
 	return ParamVal;
 }
 
@@ -1408,17 +1528,31 @@ void TNodeJsLogReg::fit(const v8::FunctionCallbackInfo<v8::Value>& Args) {
 
 	TNodeJsLogReg* JsModel = ObjectWrap::Unwrap<TNodeJsLogReg>(Args.Holder());
 
+	if (TNodeJsUtil::IsArgWrapObj<TNodeJsRecSet>(Args, 0)) {
+		// extract the features of the records a chunk at a time
+		EAssertR(Args.Length() >= 3, "logreg.fit: expects at least 3 arguments when fitting a RecordSet!");
+		TNodeJsRecSet* JsRecSet = TNodeJsUtil::UnwrapCheckWatcher<TNodeJsRecSet>(Args[0]->ToObject());
+		EAssertR(TNodeJsUtil::IsArgWrapObj<TNodeJsFtrSpace>(Args, 1), "logreg.fit: second argument expected to be a FeatureSpace when fitting a RecordSet!");
+		TNodeJsFtrSpace* JsFtrSpace = TNodeJsUtil::GetArgUnwrapObj<TNodeJsFtrSpace>(Args, 1);
+		EAssertR(JsFtrSpace->FtrSpace->IsStartStore(JsRecSet->RecSet->GetStore()->GetStoreId()),
+			"logreg.fit: record's and feature extractor's store/source must be the same!");
+		TNodeJsFltV* ResponseJsV = ObjectWrap::Unwrap<TNodeJsFltV>(Args[2]->ToObject());
+		PFtrBatchSrc BatchSrc = TQm::TFtrSpaceBatchSrc::New(JsFtrSpace->FtrSpace, JsRecSet->RecSet, false);
+
+		const double ConvergEps = TNodeJsUtil::GetArgFlt(Args, 3, 1e-3);
+		const bool WarmStart = TNodeJsUtil::GetArgBool(Args, 4, false);
+		JsModel->LogReg.Fit(BatchSrc, ResponseJsV->Vec, ConvergEps, WarmStart);
+		Args.GetReturnValue().Set(Args.Holder());
+		return;
+	}
+
 	// get the arguments
 	TNodeJsFltVV* InstanceMat = ObjectWrap::Unwrap<TNodeJsFltVV>(Args[0]->ToObject());
 	TNodeJsFltV* ResponseJsV = ObjectWrap::Unwrap<TNodeJsFltV>(Args[1]->ToObject());
 
-	if (Args.Length() > 2) {
-		const double ConvergEps = TNodeJsUtil::GetArgFlt(Args, 2);
-		JsModel->LogReg.Fit(InstanceMat->Mat, ResponseJsV->Vec, ConvergEps);
-	}
-	else {
-		JsModel->LogReg.Fit(InstanceMat->Mat, ResponseJsV->Vec);
-	}
+	const double ConvergEps = TNodeJsUtil::GetArgFlt(Args, 2, 1e-3);
+	const bool WarmStart = TNodeJsUtil::GetArgBool(Args, 3, false);
+	JsModel->LogReg.Fit(InstanceMat->Mat, ResponseJsV->Vec, ConvergEps, WarmStart);
 
 	Args.GetReturnValue().Set(Args.Holder());
 }
@@ -1468,6 +1602,197 @@ void TNodeJsLogReg::save(const v8::FunctionCallbackInfo<v8::Value>& Args) {
 	Args.GetReturnValue().Set(Args[0]);
 }
 
+////////////////////////////////////////////////////////
+// Decision Tree
+TNodeJsDecisionTree::TNodeJsDecisionTree(const PJsonVal& ArgVal):
+		ParamVal(GetParamVal(ArgVal)),
+		Tree(NewTree(ParamVal)) {}
+
+TNodeJsDecisionTree::TNodeJsDecisionTree(TSIn& SIn):
+		ParamVal(TJsonVal::Load(SIn)),
+		Tree(SIn) {
+
+	Tree.SetMxBins(ParamVal->GetObjInt("maxBins"));
+}
+
+void TNodeJsDecisionTree::Init(v8::Handle<v8::Object> exports) {
+	v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+	v8::HandleScope HandleScope(Isolate);
+
+	v8::Local<v8::FunctionTemplate> tpl = v8::FunctionTemplate::New(Isolate, TNodeJsUtil::_NewJs<TNodeJsDecisionTree>);
+	tpl->SetClassName(v8::String::NewFromUtf8(Isolate, GetClassId().CStr()));
+	// ObjectWrap uses the first internal field to store the wrapped pointer.
+	tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+	// Add all methods, getters and setters here.
+	NODE_SET_PROTOTYPE_METHOD(tpl, "getParams", _getParams);
+	NODE_SET_PROTOTYPE_METHOD(tpl, "setParams", _setParams);
+	NODE_SET_PROTOTYPE_METHOD(tpl, "fit", _fit);
+	NODE_SET_PROTOTYPE_METHOD(tpl, "predict", _predict);
+	NODE_SET_PROTOTYPE_METHOD(tpl, "getModel", _getModel);
+	NODE_SET_PROTOTYPE_METHOD(tpl, "save", _save);
+
+	exports->Set(v8::String::NewFromUtf8(Isolate, GetClassId().CStr()),
+		tpl->GetFunction());
+}
+
+TNodeJsDecisionTree* TNodeJsDecisionTree::NewFromArgs(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+	EAssertR(Args.Length() < 2, "new DecisionTree: expecting 0 or 1 parameter!");
+
+	if (Args.Length() > 0 && TNodeJsUtil::IsArgWrapObj(Args, 0, TNodeJsFIn::GetClassId())) {
+		// load the model from the input stream
+		TNodeJsFIn* JsFIn = ObjectWrap::Unwrap<TNodeJsFIn>(Args[0]->ToObject());
+		return new TNodeJsDecisionTree(*JsFIn->SIn);
+	}
+	else if (Args.Length() == 0 || TNodeJsUtil::IsArgObj(Args, 0)) {
+		PJsonVal ArgJson = Args.Length() > 0 ? TNodeJsUtil::GetArgJson(Args, 0) : TJsonVal::NewObj();
+		return new TNodeJsDecisionTree(ArgJson);
+	}
+	else {
+		throw TExcept::New("new DecisionTree: wrong arguments in constructor!");
+	}
+}
+
+PJsonVal TNodeJsDecisionTree::GetParamVal(const PJsonVal& ArgVal) {
+	const double MinClassProb = ArgVal->GetObjNum("minClassProb", 0);
+
+	PJsonVal ParamVal = TJsonVal::NewObj();
+	ParamVal->AddToObj("splitCriteria", ArgVal->GetObjStr("splitCriteria", "infoGain"));
+	ParamVal->AddToObj("minExamples", ArgVal->GetObjInt("minExamples", 0));
+	ParamVal->AddToObj("minPosProb", ArgVal->GetObjNum("minPosProb", MinClassProb));
+	ParamVal->AddToObj("minNegProb", ArgVal->GetObjNum("minNegProb", MinClassProb));
+	ParamVal->AddToObj("calcCorr", ArgVal->GetObjBool("calcCorr", false));
+	ParamVal->AddToObj("maxBins", ArgVal->GetObjInt("maxBins", 0));
+
+	return ParamVal;
+}
+
+TClassification::TDecisionTree TNodeJsDecisionTree::NewTree(const PJsonVal& ParamVal) {
+	const TStr& SplitCriteriaStr = ParamVal->GetObjStr("splitCriteria");
+
+	TClassification::PDtSplitCriteria SplitCriteria;
+	if (SplitCriteriaStr == "infoGain") {
+		SplitCriteria = TClassification::TInfoGain::New();
+	} else if (SplitCriteriaStr == "gainRatio") {
+		SplitCriteria = new TClassification::TGainRatio;
+	} else {
+		throw TExcept::New("DecisionTree: unknown split criteria: " + SplitCriteriaStr);
+	}
+
+	return TClassification::TDecisionTree(SplitCriteria, TClassification::TDtMinExamplesPrune::New(1),
+		TClassification::TDtGrowCriteria::New(ParamVal->GetObjNum("minPosProb"), ParamVal->GetObjNum("minNegProb"),
+			ParamVal->GetObjInt("minExamples")), ParamVal->GetObjBool("calcCorr"), ParamVal->GetObjInt("maxBins"));
+}
+
+void TNodeJsDecisionTree::getParams(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+	v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+	v8::HandleScope HandleScope(Isolate);
+
+	TNodeJsDecisionTree* JsModel = ObjectWrap::Unwrap<TNodeJsDecisionTree>(Args.Holder());
+	Args.GetReturnValue().Set(TNodeJsUtil::ParseJson(Isolate, JsModel->ParamVal));
+}
+
+void TNodeJsDecisionTree::setParams(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+	v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+	v8::HandleScope HandleScope(Isolate);
+
+	EAssertR(Args.Length() == 1, "DecisionTree.setParams: expects 1 argument!");
+	EAssertR(TNodeJsUtil::IsArgJson(Args, 0), "DecisionTree.setParams: first argument should be a Javascript object!");
+
+	TNodeJsDecisionTree* JsModel = ObjectWrap::Unwrap<TNodeJsDecisionTree>(Args.Holder());
+	PJsonVal NewParamVal = TNodeJsUtil::GetArgJson(Args, 0);
+
+	// the parameters which are not given keep their values
+	PJsonVal ArgVal = TJsonVal::NewObj();
+	for (int KeyN = 0; KeyN < JsModel->ParamVal->GetObjKeys(); KeyN++) {
+		const TStr& Key = JsModel->ParamVal->GetObjKey(KeyN);
+		ArgVal->AddToObj(Key, JsModel->ParamVal->GetObjKey(Key));
+	}
+	for (int KeyN = 0; KeyN < NewParamVal->GetObjKeys(); KeyN++) {
+		const TStr& Key = NewParamVal->GetObjKey(KeyN);
+		ArgVal->AddToObj(Key, NewParamVal->GetObjKey(Key));
+	}
+	// minClassProb sets the limits of both classes
+	if (NewParamVal->IsObjKey("minClassProb")) {
+		if (!NewParamVal->IsObjKey("minPosProb")) { ArgVal->AddToObj("minPosProb", NewParamVal->GetObjNum("minClassProb")); }
+		if (!NewParamVal->IsObjKey("minNegProb")) { ArgVal->AddToObj("minNegProb", NewParamVal->GetObjNum("minClassProb")); }
+	}
+	PJsonVal ParamVal = GetParamVal(ArgVal);
+
+	JsModel->Tree = NewTree(ParamVal);
+	JsModel->ParamVal = ParamVal;
+
+	Args.GetReturnValue().Set(Args.Holder());
+}
+
+void TNodeJsDecisionTree::fit(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+	v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+	v8::HandleScope HandleScope(Isolate);
+
+	EAssertR(Args.Length() == 2, "DecisionTree.fit: expects 2 arguments!");
+	EAssertR(TNodeJsUtil::IsArgWrapObj<TNodeJsFltVV>(Args, 0), "DecisionTree.fit: the first argument should be a matrix!");
+	EAssertR(TNodeJsUtil::IsArgWrapObj<TNodeJsFltV>(Args, 1), "DecisionTree.fit: the second argument should be a vector!");
+
+	TNodeJsDecisionTree* JsModel = ObjectWrap::Unwrap<TNodeJsDecisionTree>(Args.Holder());
+	const TFltVV& FtrVV = TNodeJsUtil::GetArgUnwrapObj<TNodeJsFltVV>(Args, 0)->Mat;
+	const TFltV& ClassV = TNodeJsUtil::GetArgUnwrapObj<TNodeJsFltV>(Args, 1)->Vec;
+
+	EAssertR(FtrVV.GetCols() == ClassV.Len(), "DecisionTree.fit: the number of instances and classes do not match!");
+
+	JsModel->Tree.Fit(FtrVV, ClassV);
+
+	Args.GetReturnValue().Set(Args.Holder());
+}
+
+void TNodeJsDecisionTree::predict(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+	v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+	v8::HandleScope HandleScope(Isolate);
+
+	EAssertR(Args.Length() == 1, "DecisionTree.predict: expects 1 argument!");
+
+	TNodeJsDecisionTree* JsModel = ObjectWrap::Unwrap<TNodeJsDecisionTree>(Args.Holder());
+
+	if (TNodeJsUtil::IsArgWrapObj<TNodeJsFltV>(Args, 0)) {
+		const TFltV& FtrV = TNodeJsUtil::GetArgUnwrapObj<TNodeJsFltV>(Args, 0)->Vec;
+		Args.GetReturnValue().Set(v8::Number::New(Isolate, JsModel->Tree.Predict(FtrV)));
+	}
+	else if (TNodeJsUtil::IsArgWrapObj<TNodeJsFltVV>(Args, 0)) {
+		const TFltVV& FtrVV = TNodeJsUtil::GetArgUnwrapObj<TNodeJsFltVV>(Args, 0)->Mat;
+		TFltV ResV(FtrVV.GetCols(), 0), FtrV;
+		for (int ColN = 0; ColN < FtrVV.GetCols(); ColN++) {
+			FtrVV.GetCol(ColN, FtrV);
+			ResV.Add(JsModel->Tree.Predict(FtrV));
+		}
+		Args.GetReturnValue().Set(TNodeJsFltV::New(ResV));
+	}
+	else {
+		throw TExcept::New("DecisionTree.predict: the argument should be a vector or a matrix!");
+	}
+}
+
+void TNodeJsDecisionTree::getModel(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+	v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+	v8::HandleScope HandleScope(Isolate);
+
+	TNodeJsDecisionTree* JsModel = ObjectWrap::Unwrap<TNodeJsDecisionTree>(Args.Holder());
+	Args.GetReturnValue().Set(TNodeJsUtil::ParseJson(Isolate, JsModel->Tree.GetJson()));
+}
+
+void TNodeJsDecisionTree::save(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+	v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+	v8::HandleScope HandleScope(Isolate);
+
+	EAssertR(Args.Length() == 1, "DecisionTree.save: expects 1 argument!");
+
+	TNodeJsDecisionTree* JsModel = ObjectWrap::Unwrap<TNodeJsDecisionTree>(Args.Holder());
+	TNodeJsFOut* JsFOut = ObjectWrap::Unwrap<TNodeJsFOut>(Args[0]->ToObject());
+
+	JsModel->ParamVal->Save(*JsFOut->SOut);
+	JsModel->Tree.Save(*JsFOut->SOut);
+
+	Args.GetReturnValue().Set(Args[0]);
+}
+
 ////////////////////////////////////////////////////////
 // Proportional Hazards Model
 void TNodeJsPropHaz::Init(v8::Handle<v8::Object> exports) {
@@ -1613,6 +1938,7 @@ void TNodeJsPropHaz::save(const v8::FunctionCallbackInfo<v8::Value>& Args) {
 // Neural Network model
 TNodeJsNNet::TNodeJsNNet(const PJsonVal& ParamVal) {
 	TIntV LayoutV;
+	TSignalProc::TNNetOpt Opt;
 	double LearnRate;
 	double Momentum;
 	TSignalProc::TTFunc TFuncHiddenL;
@@ -1631,9 +1957,11 @@ TNodeJsNNet::TNodeJsNNet(const PJsonVal& ParamVal) {
 	Momentum = ParamVal->GetObjNum("momentum", 0.5);
 	TFuncHiddenL = ExtractFuncFromString(ParamVal->GetObjStr("tFuncHidden", "tanHyper"));
 	TFuncOutL = ExtractFuncFromString(ParamVal->GetObjStr("tFuncOut", "tanHyper"));
+	Opt = ExtractOptFromString(ParamVal->GetObjStr("optimizer", "sgd"));
+	BatchSize = ParamVal->GetObjInt("batchSize", 0);
 
 	try {
-		Model = TSignalProc::TNNet::New(LayoutV, LearnRate, Momentum, TFuncHiddenL, TFuncOutL);
+		Model = TSignalProc::TNNet::New(LayoutV, LearnRate, Momentum, TFuncHiddenL, TFuncOutL, Opt);
 	}
 	catch (const PExcept& Except) {
 		throw TExcept::New(Except->GetMsgStr(), Except->GetLocStr());
@@ -1641,9 +1969,17 @@ TNodeJsNNet::TNodeJsNNet(const PJsonVal& ParamVal) {
 
 }
 
-TNodeJsNNet::TNodeJsNNet(TSIn& SIn) {
+TNodeJsNNet::TNodeJsNNet(TSIn& SIn): BatchSize(0) {
 	try {
-		Model = TSignalProc::TNNet::Load(SIn);
+		// models saved before the batch size was added start with the learning
+		// rate of the network, newer models with -1, which is not a learning rate
+		const TFlt Format(SIn);
+		if (Format >= 0.0) {
+			Model = TSignalProc::TNNet::Load(SIn, Format);
+		} else {
+			Model = TSignalProc::TNNet::Load(SIn);
+			BatchSize.Load(SIn);
+		}
 	}
 	catch (const PExcept& Except) {
 		throw TExcept::New(Except->GetMsgStr(), Except->GetLocStr());
@@ -1723,20 +2059,8 @@ void TNodeJsNNet::fit(const v8::FunctionCallbackInfo<v8::Value>& Args) {
 
 			EAssertR(JsVVecIn->Mat.GetCols() == JsVVecTarget->Mat.GetCols(), "NNet.fit: Column dimension not equal!");
 
-			for (int ColN = 0; ColN < JsVVecIn->Mat.GetCols(); ColN++){
-				TFltV InFltV;
-				JsVVecIn->Mat.GetCol(ColN, InFltV);
-				Model->Model->FeedFwd(InFltV);
-				// then check how we performed and learn
-				TFltV TargFltV;
-				JsVVecTarget->Mat.GetCol(ColN, TargFltV);
-				if (ColN == JsVVecIn->Mat.GetCols() - 1){
-					Model->Model->BackProp(TargFltV);
-				}
-				else {
-					Model->Model->BackProp(TargFltV, false);
-				}
-			}
+			// one weight update per batch of columns
+			Model->Model->Fit(JsVVecIn->Mat, JsVVecTarget->Mat, Model->BatchSize);
 		}
 		else {
 			// TODO: throw an error
@@ -1758,8 +2082,16 @@ void TNodeJsNNet::predict(const v8::FunctionCallbackInfo<v8::Value>& Args) {
 	try {
 		TNodeJsNNet* Model = ObjectWrap::Unwrap<TNodeJsNNet>(Args.Holder());
 
+		if (TNodeJsUtil::IsArgWrapObj(Args, 0, TNodeJsFltVV::GetClassId())) {
+			TNodeJsFltVV* JsMat = ObjectWrap::Unwrap<TNodeJsFltVV>(Args[0]->ToObject());
+			TFltVV ResultVV;
+			Model->Model->Predict(JsMat->Mat, ResultVV);
+			Args.GetReturnValue().Set(TNodeJsFltVV::New(ResultVV));
+			return;
+		}
+
 		EAssertR(TNodeJsUtil::IsArgWrapObj(Args, 0, TNodeJsFltV::GetClassId()),
-			"NNet.predict: The first argument must be a JsTFltV (js linalg full vector)");
+			"NNet.predict: The first argument must be a JsTFltV or JsTFltVV (js linalg full vector or matrix)");
 		TNodeJsFltV* JsVec = ObjectWrap::Unwrap<TNodeJsFltV>(Args[0]->ToObject());
 
 		Model->Model->FeedFwd(JsVec->Vec);
@@ -1795,6 +2127,8 @@ void TNodeJsNNet::getParams(const v8::FunctionCallbackInfo<v8::Value>& Args) {
 	ParamVal->AddToObj("momentum", JsModel->Model->GetMomentum());
 	ParamVal->AddToObj("tFuncHidden", JsModel->Model->GetTFuncHidden());
 	ParamVal->AddToObj("tFuncOut", JsModel->Model->GetTFuncOut());
+	ParamVal->AddToObj("optimizer", JsModel->Model->GetOpt() == TSignalProc::TNNetOpt::nnoAdam ? "adam" : "sgd");
+	ParamVal->AddToObj("batchSize", JsModel->BatchSize.Val);
 
 	Args.GetReturnValue().Set(TNodeJsUtil::ParseJson(Isolate, ParamVal));
 }
@@ -1818,6 +2152,12 @@ void TNodeJsNNet::setParams(const v8::FunctionCallbackInfo<v8::Value>& Args) {
 	if (ParamVal->IsObjKey("momentum")) {
 		Model->Model->SetMomentum(ParamVal->GetObjNum("momentum"));
 	}
+	if (ParamVal->IsObjKey("optimizer")) {
+		Model->Model->SetOpt(Model->ExtractOptFromString(ParamVal->GetObjStr("optimizer")));
+	}
+	if (ParamVal->IsObjKey("batchSize")) {
+		Model->BatchSize = ParamVal->GetObjInt("batchSize");
+	}
 	if (ParamVal->IsObjKey("layout")) {
 		ParamVal->GetObjIntV("layout", LayoutV);
 	}
@@ -1829,7 +2169,7 @@ void TNodeJsNNet::setParams(const v8::FunctionCallbackInfo<v8::Value>& Args) {
 
 	if (ParamVal->IsObjKey("layout") || ParamVal->IsObjKey("tFuncHidden") || ParamVal->IsObjKey("TFuncOut")) {
 		Model->Model = TSignalProc::TNNet::New(LayoutV, Model->Model->GetLearnRate(), Model->Model->GetMomentum(),
-			TFuncHiddenL, TFuncOutL);
+			TFuncHiddenL, TFuncOutL, Model->Model->GetOpt());
 	}
 
 	Args.GetReturnValue().Set(Args.Holder());
@@ -1847,7 +2187,9 @@ void TNodeJsNNet::save(const v8::FunctionCallbackInfo<v8::Value>& Args) {
 
 		PSOut SOut = JsFOut->SOut;
 
+		TFlt(-1.0).Save(*SOut);
 		Model->Model->Save(*SOut);
+		Model->BatchSize.Save(*SOut);
 
 		Args.GetReturnValue().Set(Args[0]);
 	}
@@ -1878,6 +2220,9 @@ TSignalProc::TTFunc TNodeJsNNet::ExtractFuncFromString(const TStr& FuncString) {
 	else if (FuncString == "linear") {
 		TFunc = TSignalProc::TTFunc::linear;
 	}
+	else if (FuncString == "relu") {
+		TFunc = TSignalProc::TTFunc::relu;
+	}
 	else {
 		throw TExcept::New("Unknown transfer function type " + FuncString);
 	}
@@ -1885,6 +2230,18 @@ TSignalProc::TTFunc TNodeJsNNet::ExtractFuncFromString(const TStr& FuncString) {
 	return TFunc;
 }
 
+TSignalProc::TNNetOpt TNodeJsNNet::ExtractOptFromString(const TStr& OptString) {
+	if (OptString == "sgd") {
+		return TSignalProc::TNNetOpt::nnoSgd;
+	}
+	else if (OptString == "adam") {
+		return TSignalProc::TNNetOpt::nnoAdam;
+	}
+	else {
+		throw TExcept::New("Unknown optimizer " + OptString);
+	}
+}
+
 ///////////////////////////////
 // QMiner-JavaScript-Tokenizer
 
@@ -2193,7 +2550,10 @@ TNodeJsKMeans::TNodeJsKMeans(const PJsonVal& ParamVal) :
         Dist(nullptr),
         CentType(TCentroidType::ctDense),
         Model(nullptr),
-        Verbose(false) {
+        Verbose(false),
+        BatchSize(0),
+        ParInitP(false),
+        Threads(1) {
     UpdateParams(ParamVal);
 }
 
@@ -2210,7 +2570,10 @@ TNodeJsKMeans::TNodeJsKMeans(const PJsonVal& ParamVal, const TFltVV& Mat) :
         Dist(nullptr),
         CentType(TCentroidType::ctDense),
         Model(nullptr),
-        Verbose(false) {
+        Verbose(false),
+        BatchSize(0),
+        ParInitP(false),
+        Threads(1) {
     UpdateParams(ParamVal);
 }
 
@@ -2227,22 +2590,32 @@ TNodeJsKMeans::TNodeJsKMeans(const PJsonVal& ParamVal, const TVec<TIntFltKdV>& M
         Dist(nullptr),
         CentType(TCentroidType::ctDense),
         Model(nullptr),
-        Verbose(false) {
+        Verbose(false),
+        BatchSize(0),
+        ParInitP(false),
+        Threads(1) {
     UpdateParams(ParamVal);
 }
 
 TNodeJsKMeans::TNodeJsKMeans(TSIn& SIn) :
-        Iter(TInt(SIn)),
-        K(TInt(SIn)),
-        AllowEmptyP(SIn),
-        AssignV(SIn),
-        Medoids(SIn),
-        FitIdx(SIn),
-        DenseFitMatrix(SIn),
-        SparseFitMatrix(SIn),
-        DistType(LoadEnum<TDistanceType>(SIn)),
-        CentType(LoadEnum<TCentroidType>(SIn)),
-        Verbose(TBool(SIn)) {
+        BatchSize(0),
+        ParInitP(false),
+        Threads(1) {
+    // models saved before mini-batch support start with the (non-negative)
+    // number of iterations, newer models with -1
+    const int Format = TInt(SIn);
+    Iter = (Format >= 0) ? Format : TInt(SIn).Val;
+    K = TInt(SIn);
+    AllowEmptyP.Load(SIn);
+    AssignV.Load(SIn);
+    Medoids.Load(SIn);
+    FitIdx.Load(SIn);
+    DenseFitMatrix.Load(SIn);
+    SparseFitMatrix.Load(SIn);
+    DistType = LoadEnum<TDistanceType>(SIn);
+    CentType = LoadEnum<TCentroidType>(SIn);
+    Verbose = TBool(SIn);
+
     if (DistType == TDistanceType::dtEuclid) {
         Dist = new TClustering::TEuclDist;
     } else if (DistType == TDistanceType::dtCos) {
@@ -2258,6 +2631,11 @@ TNodeJsKMeans::TNodeJsKMeans(TSIn& SIn) :
     } else {
         throw TExcept::New("KMeans load constructor: loading invalid KMeans model!");
     }
+    if (Format < 0) {
+        BatchSize.Load(SIn);
+        ParInitP.Load(SIn);
+        Threads.Load(SIn);
+    }
 
     Notify = Verbose ? TNotify::StdNotify : TNotify::NullNotify;
 }
@@ -2292,6 +2670,24 @@ void TNodeJsKMeans::UpdateParams(const PJsonVal& ParamVal) {
         }
     }
     if (ParamVal->IsObjKey("verbose")) { Verbose = ParamVal->GetObjBool("verbose"); }
+    if (ParamVal->IsObjKey("batchSize")) {
+        BatchSize = ParamVal->GetObjInt("batchSize");
+        EAssertR(BatchSize >= 0, "Update KMeans Exception: batchSize must not be negative!");
+    }
+    if (ParamVal->IsObjKey("init")) {
+        TStr InitStr = ParamVal->GetObjStr("init");
+        if (InitStr == "random") {
+            ParInitP = false;
+        } else if (InitStr == "kmeans||") {
+            ParInitP = true;
+        } else {
+            throw TExcept::New("Update KMeans Exception: init must be random or kmeans||!");
+        }
+    }
+    if (ParamVal->IsObjKey("threads")) {
+        Threads = ParamVal->GetObjInt("threads");
+        EAssertR(Threads > 0, "Update KMeans Exception: threads must be positive!");
+    }
 
     if (DistType == TDistanceType::dtEuclid) {
         Dist = new TClustering::TEuclDist;
@@ -2307,6 +2703,7 @@ void TNodeJsKMeans::UpdateParams(const PJsonVal& ParamVal) {
 }
 
 void TNodeJsKMeans::Save(TSOut& SOut) const {
+    TInt(-1).Save(SOut);
     TInt(Iter).Save(SOut);
     TInt(K).Save(SOut);
     AllowEmptyP.Save(SOut);
@@ -2323,6 +2720,9 @@ void TNodeJsKMeans::Save(TSOut& SOut) const {
     } else if (CentType == TCentroidType::ctSparse) {
         ((TClustering::TDnsKMeans<TVec<TIntFltKdV>>*)Model)->Save(SOut);
     }
+    BatchSize.Save(SOut);
+    ParInitP.Save(SOut);
+    Threads.Save(SOut);
 }
 
 void TNodeJsKMeans::CleanUp() {
@@ -2435,6 +2835,9 @@ void TNodeJsKMeans::getParams(const v8::FunctionCallbackInfo<v8::Value>& Args) {
         JsObj->Set(v8::Handle<v8::String>(v8::String::NewFromUtf8(Isolate, "k")), v8::Integer::New(Isolate, JsKMeans->K));
         JsObj->Set(v8::Handle<v8::String>(v8::String::NewFromUtf8(Isolate, "verbose")), v8::Boolean::New(Isolate, JsKMeans->Verbose));
         JsObj->Set(v8::Handle<v8::String>(v8::String::NewFromUtf8(Isolate, "allowEmpty")), v8::Boolean::New(Isolate, JsKMeans->AllowEmptyP));
+        JsObj->Set(v8::Handle<v8::String>(v8::String::NewFromUtf8(Isolate, "batchSize")), v8::Integer::New(Isolate, JsKMeans->BatchSize));
+        JsObj->Set(v8::Handle<v8::String>(v8::String::NewFromUtf8(Isolate, "init")), v8::String::NewFromUtf8(Isolate, JsKMeans->ParInitP ? "kmeans||" : "random"));
+        JsObj->Set(v8::Handle<v8::String>(v8::String::NewFromUtf8(Isolate, "threads")), v8::Integer::New(Isolate, JsKMeans->Threads));
 
         if (!JsKMeans->FitIdx.Empty()) {
             v8::Handle<v8::Array> FitIdx = v8::Array::New(Isolate, JsKMeans->FitIdx.Len());
@@ -2522,8 +2925,10 @@ TNodeJsKMeans::TFitTask::TFitTask(const v8::FunctionCallbackInfo<v8::Value>& Arg
         JsKMeans(nullptr),
         JsFltVV(nullptr),
         JsSpVV(nullptr),
+        JsRecSet(nullptr),
         JsIntV(nullptr),
-        JsArr(nullptr) {
+        JsArr(nullptr),
+        JsFtrSpace(nullptr) {
 
     JsKMeans = ObjectWrap::Unwrap<TNodeJsKMeans>(Args.Holder());
 
@@ -2533,11 +2938,18 @@ TNodeJsKMeans::TFitTask::TFitTask(const v8::FunctionCallbackInfo<v8::Value>& Arg
     else if (TNodeJsUtil::IsArgWrapObj<TNodeJsSpMat>(Args, 0)) {
         JsSpVV = TNodeJsUtil::GetArgUnwrapObj<TNodeJsSpMat>(Args, 0);
     }
+    else if (TNodeJsUtil::IsArgWrapObj<TNodeJsRecSet>(Args, 0)) {
+        JsRecSet = TNodeJsUtil::UnwrapCheckWatcher<TNodeJsRecSet>(Args[0]->ToObject());
+        EAssertR(TNodeJsUtil::IsArgWrapObj<TNodeJsFtrSpace>(Args, 1), "KMeans.fit: second argument expected to be a FeatureSpace when fitting a RecordSet!");
+        JsFtrSpace = TNodeJsUtil::GetArgUnwrapObj<TNodeJsFtrSpace>(Args, 1);
+        EAssertR(JsFtrSpace->FtrSpace->IsStartStore(JsRecSet->RecSet->GetStore()->GetStoreId()),
+            "KMeans.fit: record's and feature extractor's store/source must be the same!");
+    }
     else {
-        throw TExcept::New("KMeans.fit: argument not a sparse or dense matrix!");
+        throw TExcept::New("KMeans.fit: argument not a sparse or dense matrix or a record set!");
     }
 
-    if (Args.Length() >= 2 && !TNodeJsUtil::IsArgFun(Args, 1)) {
+    if (JsRecSet == nullptr && Args.Length() >= 2 && !TNodeJsUtil::IsArgFun(Args, 1)) {
         if (TNodeJsUtil::IsArgWrapObj<TNodeJsIntV>(Args, 1)) {
             JsIntV = TNodeJsUtil::GetArgUnwrapObj<TNodeJsIntV>(Args, 1);
         }
@@ -2563,12 +2975,119 @@ v8::Handle<v8::Function> TNodeJsKMeans::TFitTask::GetCallback(const v8::Function
     }
 }
 
+void TNodeJsKMeans::TFitTask::GetFitStart(const PFtrBatchSrc& BatchSrc, TFltVV& InitCentroidVV) const {
+    if (!JsKMeans->DenseFitMatrix.Empty()) {
+        EAssertR(JsKMeans->DenseFitMatrix.GetCols() == JsKMeans->K, "Number of columns must be equal to number of centroids!");
+        InitCentroidVV = JsKMeans->DenseFitMatrix;
+    }
+    else if (!JsKMeans->SparseFitMatrix.Empty()) {
+        EAssertR(JsKMeans->SparseFitMatrix.Len() == JsKMeans->K, "Number of columns must be equal to number of centroids!");
+        TLinAlgTransform::Full(JsKMeans->SparseFitMatrix, InitCentroidVV, BatchSrc->GetDim());
+    }
+    else if (!JsKMeans->FitIdx.Empty()) {
+        EAssertR(JsKMeans->FitIdx.Len() == JsKMeans->K, "Length of fitIdx must be equal to number of centroids!");
+        EAssertR(JsKMeans->FitIdx.GetMxVal() < BatchSrc->GetInsts(), "Maximum index in fitIdx must not be greater to the number of columns!");
+        BatchSrc->GetBatch(JsKMeans->FitIdx, InitCentroidVV);
+    }
+}
+
+void TNodeJsKMeans::TFitTask::GetFitStart(const PFtrBatchSrc& BatchSrc, TVec<TIntFltKdV>& InitCentroidVV) const {
+    if (!JsKMeans->SparseFitMatrix.Empty()) {
+        EAssertR(JsKMeans->SparseFitMatrix.Len() == JsKMeans->K, "Number of columns must be equal to number of centroids!");
+        InitCentroidVV = JsKMeans->SparseFitMatrix;
+    }
+    else if (!JsKMeans->DenseFitMatrix.Empty()) {
+        EAssertR(JsKMeans->DenseFitMatrix.GetCols() == JsKMeans->K, "Number of columns must be equal to number of centroids!");
+        TLinAlgTransform::Sparse(JsKMeans->DenseFitMatrix, InitCentroidVV);
+    }
+    else if (!JsKMeans->FitIdx.Empty()) {
+        EAssertR(JsKMeans->FitIdx.Len() == JsKMeans->K, "Length of fitIdx must be equal to number of centroids!");
+        EAssertR(JsKMeans->FitIdx.GetMxVal() < BatchSrc->GetInsts(), "Maximum index in fitIdx must not be greater to the number of columns!");
+        BatchSrc->GetBatch(JsKMeans->FitIdx, InitCentroidVV);
+    }
+}
+
+template <class TCentroid>
+void TNodeJsKMeans::TFitTask::FitBatch(TClustering::TDnsKMeans<TCentroid>* KMeans, const PFtrBatchSrc& BatchSrc) {
+    // initial centroids
+    TCentroid InitCentroidVV;
+    GetFitStart(BatchSrc, InitCentroidVV);
+    if (InitCentroidVV.Empty() && JsKMeans->ParInitP) {
+        KMeans->SelectInitCentroidsPar(BatchSrc, JsKMeans->K, InitCentroidVV);
+    }
+
+    if (JsKMeans->BatchSize > 0) {
+        KMeans->ApplyMiniBatch(BatchSrc, JsKMeans->BatchSize, JsKMeans->Iter, JsKMeans->Notify, InitCentroidVV);
+    }
+    else if (BatchSrc->IsSparse()) {
+        // full batches need all the examples
+        TVec<TIntFltKdV> FtrVV;	BatchSrc->GetRange(0, BatchSrc->GetInsts(), FtrVV);
+        KMeans->Apply(FtrVV, JsKMeans->AllowEmptyP, JsKMeans->Iter, JsKMeans->Notify, InitCentroidVV);
+    }
+    else {
+        TFltVV FtrVV;	BatchSrc->GetRange(0, BatchSrc->GetInsts(), FtrVV);
+        KMeans->Apply(FtrVV, JsKMeans->AllowEmptyP, JsKMeans->Iter, JsKMeans->Notify, InitCentroidVV);
+    }
+
+    // assignments and medoids, read the examples again in chunks
+    KMeans->Assign(BatchSrc, JsKMeans->AssignV, JsKMeans->Medoids);
+
+    // medoids as record ids
+    const TIntV* RecIdV = nullptr;
+    if (JsRecSet != nullptr) {
+        TUInt64V RecSetIdV; JsRecSet->RecSet->GetRecIdV(RecSetIdV);
+        for (int MedN = 0; MedN < JsKMeans->Medoids.Len(); MedN++) {
+            JsKMeans->Medoids[MedN] = (int)RecSetIdV[JsKMeans->Medoids[MedN]];
+        }
+    }
+    else if (JsIntV != nullptr) {
+        RecIdV = &JsIntV->Vec;
+    }
+    else if (JsArr != nullptr) {
+        RecIdV = &JsArr->Vec;
+    }
+    if (RecIdV != nullptr) {
+        EAssertR(RecIdV->Len() == BatchSrc->GetInsts(), "KMeans.fit: RecordIds.length must be equal to number of columns of X!");
+        for (int MedN = 0; MedN < JsKMeans->Medoids.Len(); MedN++) {
+            JsKMeans->Medoids[MedN] = (*RecIdV)[JsKMeans->Medoids[MedN]];
+        }
+    }
+}
+
 void TNodeJsKMeans::TFitTask::Run() {
+#ifdef GLib_OPENMP
+    // clustering loops run with the default number of threads of the calling
+    // thread, so they use the same number of threads as feature extraction
+    const int PrevThreads = omp_get_max_threads();
+    omp_set_num_threads(TInt::GetMx(JsKMeans->Threads, 1));
+#endif
     try {
        // delete the previous model
        JsKMeans->CleanUp();
        // create a new model
-       if (JsKMeans->CentType == TCentroidType::ctDense) {
+       if (JsRecSet != nullptr || JsKMeans->BatchSize > 0) {
+           // examples are read through a batch source
+           PFtrBatchSrc BatchSrc;
+           if (JsRecSet != nullptr) {
+               const bool SparseP = JsKMeans->CentType == TCentroidType::ctSparse;
+               BatchSrc = TQm::TFtrSpaceBatchSrc::New(JsFtrSpace->FtrSpace, JsRecSet->RecSet, SparseP, -1, JsKMeans->Threads);
+           } else if (JsFltVV != nullptr) {
+               BatchSrc = TFltVVBatchSrc::New(JsFltVV->Mat);
+           } else {
+               BatchSrc = TSpVVBatchSrc::New(JsSpVV->Mat, JsSpVV->Rows);
+           }
+
+           if (JsKMeans->CentType == TCentroidType::ctDense) {
+               TClustering::TDenseKMeans* KMeans = new TClustering::TDenseKMeans(JsKMeans->K, TRnd(0), JsKMeans->Dist);
+               JsKMeans->Model = (void*) KMeans;
+               FitBatch(KMeans, BatchSrc);
+           } else {
+               TClustering::TSparseKMeans* KMeans = new TClustering::TSparseKMeans(JsKMeans->K, TRnd(0), JsKMeans->Dist);
+               JsKMeans->Model = (void*) KMeans;
+               FitBatch(KMeans, BatchSrc);
+           }
+       }
+       else if (JsKMeans->CentType == TCentroidType::ctDense) {
            TClustering::TDenseKMeans* KMeans = new TClustering::TDenseKMeans(JsKMeans->K, TRnd(0), JsKMeans->Dist);
 
            JsKMeans->Model = (void*) KMeans;
@@ -2591,6 +3110,11 @@ void TNodeJsKMeans::TFitTask::Run() {
                    TLinAlg::SubMat(JsFltVV->Mat, JsKMeans->FitIdx, InitCentroidMat);
                    KMeans->Apply(JsFltVV->Mat, JsKMeans->AllowEmptyP, JsKMeans->Iter, JsKMeans->Notify, InitCentroidMat);
                }
+               else if (JsKMeans->ParInitP) {
+                   TFltVV InitCentroidMat;
+                   KMeans->SelectInitCentroidsPar(TFltVVBatchSrc::New(JsFltVV->Mat), JsKMeans->K, InitCentroidMat);
+                   KMeans->Apply(JsFltVV->Mat, JsKMeans->AllowEmptyP, JsKMeans->Iter, JsKMeans->Notify, InitCentroidMat);
+               }
                else {
                    KMeans->Apply(JsFltVV->Mat, JsKMeans->AllowEmptyP, JsKMeans->Iter, JsKMeans->Notify);
                }
@@ -2643,6 +3167,11 @@ void TNodeJsKMeans::TFitTask::Run() {
                    }
                    KMeans->Apply(JsSpVV->Mat, JsKMeans->AllowEmptyP, JsKMeans->Iter, JsKMeans->Notify, InitCentroidMat);
                }
+               else if (JsKMeans->ParInitP) {
+                   TFltVV InitCentroidMat;
+                   KMeans->SelectInitCentroidsPar(TSpVVBatchSrc::New(JsSpVV->Mat, JsSpVV->Rows), JsKMeans->K, InitCentroidMat);
+                   KMeans->Apply(JsSpVV->Mat, JsKMeans->AllowEmptyP, JsKMeans->Iter, JsKMeans->Notify, InitCentroidMat);
+               }
                else {
                    KMeans->Apply(JsSpVV->Mat, JsKMeans->AllowEmptyP, JsKMeans->Iter, JsKMeans->Notify);
                }
@@ -2705,6 +3234,11 @@ void TNodeJsKMeans::TFitTask::Run() {
                    }
                    KMeans->Apply(JsFltVV->Mat, JsKMeans->AllowEmptyP, JsKMeans->Iter, JsKMeans->Notify, InitCentroidMat);
                }
+               else if (JsKMeans->ParInitP) {
+                   TVec<TIntFltKdV> InitCentroidMat;
+                   KMeans->SelectInitCentroidsPar(TFltVVBatchSrc::New(JsFltVV->Mat), JsKMeans->K, InitCentroidMat);
+                   KMeans->Apply(JsFltVV->Mat, JsKMeans->AllowEmptyP, JsKMeans->Iter, JsKMeans->Notify, InitCentroidMat);
+               }
                else {
                    KMeans->Apply(JsFltVV->Mat, JsKMeans->AllowEmptyP, JsKMeans->Iter, JsKMeans->Notify);
                }
@@ -2757,6 +3291,11 @@ void TNodeJsKMeans::TFitTask::Run() {
                    }
                    KMeans->Apply(JsSpVV->Mat, JsKMeans->AllowEmptyP, JsKMeans->Iter, JsKMeans->Notify, InitCentroidMat);
                }
+               else if (JsKMeans->ParInitP) {
+                   TVec<TIntFltKdV> InitCentroidMat;
+                   KMeans->SelectInitCentroidsPar(TSpVVBatchSrc::New(JsSpVV->Mat, JsSpVV->Rows), JsKMeans->K, InitCentroidMat);
+                   KMeans->Apply(JsSpVV->Mat, JsKMeans->AllowEmptyP, JsKMeans->Iter, JsKMeans->Notify, InitCentroidMat);
+               }
                else {
                    KMeans->Apply(JsSpVV->Mat, JsKMeans->AllowEmptyP, JsKMeans->Iter, JsKMeans->Notify);
                }
@@ -2797,6 +3336,9 @@ void TNodeJsKMeans::TFitTask::Run() {
         if (JsArr != nullptr) { delete JsArr; }
         SetExcept(Except);
     }
+#ifdef GLib_OPENMP
+    omp_set_num_threads(PrevThreads);
+#endif
 }
 
 void TNodeJsKMeans::predict(const v8::FunctionCallbackInfo<v8::Value>& Args) {
@@ -3010,17 +3552,28 @@ TNodeJsRecommenderSys::TNodeJsRecommenderSys(const PJsonVal& ParamVal) :
 	K(2),
 	Tol(1e-3),
 	Verbose(false),
+	Algorithm("cfo"),
+	Lambda(0.01),
 	Notify(TNotify::NullNotify) {
 	UpdateParams(ParamVal);
 }
 
 TNodeJsRecommenderSys::TNodeJsRecommenderSys(TSIn& SIn) :
-	Iter(TInt(SIn)),
-	K(TInt(SIn)),
-	Tol(TFlt(SIn)),
-	Verbose(TBool(SIn)),
-	U(SIn),
-	V(SIn) {
+	Algorithm("cfo"),
+	Lambda(0.01) {
+	// models saved before the 'als' algorithm start with the (non-negative)
+	// number of iterations, newer models with -1
+	const int Format = TInt(SIn);
+	Iter = (Format >= 0) ? Format : TInt(SIn).Val;
+	K = TInt(SIn);
+	Tol = TFlt(SIn);
+	Verbose = TBool(SIn);
+	U.Load(SIn);
+	V.Load(SIn);
+	if (Format < 0) {
+		Algorithm.Load(SIn);
+		Lambda = TFlt(SIn);
+	}
 	Notify = Verbose ? TNotify::StdNotify : TNotify::NullNotify;
 }
 
@@ -3029,6 +3582,12 @@ void TNodeJsRecommenderSys::UpdateParams(const PJsonVal& ParamVal) {
 	if (ParamVal->IsObjKey("k")) { K = ParamVal->GetObjInt("k"); }
 	if (ParamVal->IsObjKey("tol")) { Tol = ParamVal->GetObjNum("tol"); }
 	if (ParamVal->IsObjKey("verbose")) { Verbose = ParamVal->GetObjBool("verbose"); }
+	if (ParamVal->IsObjKey("algorithm")) {
+		const TStr NewAlgorithm = ParamVal->GetObjStr("algorithm");
+		EAssertR(NewAlgorithm == "cfo" || NewAlgorithm == "als", "RecommenderSys: unknown algorithm " + NewAlgorithm + "!");
+		Algorithm = NewAlgorithm;
+	}
+	if (ParamVal->IsObjKey("lambda")) { Lambda = ParamVal->GetObjNum("lambda"); }
 
 	Notify = Verbose ? TNotify::StdNotify : TNotify::NullNotify;
 }
@@ -3039,17 +3598,22 @@ PJsonVal TNodeJsRecommenderSys::GetParams() const {
 	ParamVal->AddToObj("k", K);
 	ParamVal->AddToObj("tol", Tol);
 	ParamVal->AddToObj("verbose", Verbose);
+	ParamVal->AddToObj("algorithm", Algorithm);
+	ParamVal->AddToObj("lambda", Lambda);
 	
 	return ParamVal;
 }
 
 void TNodeJsRecommenderSys::Save(TSOut& SOut) const {
+	TInt(-1).Save(SOut);
 	TInt(Iter).Save(SOut);
 	TInt(K).Save(SOut);
 	TFlt(Tol).Save(SOut);
 	TBool(Verbose).Save(SOut);
 	U.Save(SOut);
 	V.Save(SOut);
+	Algorithm.Save(SOut);
+	TFlt(Lambda).Save(SOut);
 }
 
 void TNodeJsRecommenderSys::Init(v8::Handle<v8::Object> exports) {
@@ -3142,6 +3706,7 @@ void TNodeJsRecommenderSys::getModel(const v8::FunctionCallbackInfo<v8::Value>&
 	v8::Local<v8::Object> JsObj = v8::Object::New(Isolate); // Result 
 	JsObj->Set(v8::Handle<v8::String>(v8::String::NewFromUtf8(Isolate, "U")), TNodeJsFltVV::New(JsRecSys->U));
 	JsObj->Set(v8::Handle<v8::String>(v8::String::NewFromUtf8(Isolate, "V")), TNodeJsFltVV::New(JsRecSys->V));
+	JsObj->Set(v8::Handle<v8::String>(v8::String::NewFromUtf8(Isolate, "loss")), TNodeJsFltV::New(JsRecSys->LossV));
 	Args.GetReturnValue().Set(JsObj);
 }
 
@@ -3175,18 +3740,34 @@ v8::Handle<v8::Function> TNodeJsRecommenderSys::TFitTask::GetCallback(const v8::
 
 void TNodeJsRecommenderSys::TFitTask::Run() {
 	try {
-		// if argument is a dense matrix
-		if (JsFltVV != nullptr) {
-			TNmf::WeightedCFO(JsFltVV->Mat, JsRecSys->K, JsRecSys->U, JsRecSys->V, JsRecSys->Iter, JsRecSys->Tol, 
-				JsRecSys->Notify);
-		}
-		// if argument is a sparse matrix
-		else if (JsSpVV != nullptr) {
-			TNmf::WeightedCFO(JsSpVV->Mat, JsRecSys->K, JsRecSys->U, JsRecSys->V, JsRecSys->Iter, JsRecSys->Tol,
-				JsRecSys->Notify);
+		if (JsRecSys->Algorithm == "als") {
+			if (JsFltVV != nullptr) {
+				TNmf::ParallelALS(JsFltVV->Mat, JsRecSys->K, JsRecSys->U, JsRecSys->V, JsRecSys->LossV,
+					JsRecSys->Iter, JsRecSys->Tol, JsRecSys->Lambda, JsRecSys->Notify);
+			}
+			else if (JsSpVV != nullptr) {
+				TNmf::ParallelALS(TCompressedSparseMatrix(JsSpVV->Mat, JsSpVV->Rows), JsRecSys->K, JsRecSys->U,
+					JsRecSys->V, JsRecSys->LossV, JsRecSys->Iter, JsRecSys->Tol, JsRecSys->Lambda, JsRecSys->Notify);
+			}
+			else {
+				throw TExcept::New("RecommenderSys.fit: argument not a sparse or dense matrix");
+			}
 		}
 		else {
-			throw TExcept::New("RecommenderSys.fit: argument not a sparse or dense matrix");
+			JsRecSys->LossV.Clr();
+			// if argument is a dense matrix
+			if (JsFltVV != nullptr) {
+				TNmf::WeightedCFO(JsFltVV->Mat, JsRecSys->K, JsRecSys->U, JsRecSys->V, JsRecSys->Iter, JsRecSys->Tol, 
+					JsRecSys->Notify);
+			}
+			// if argument is a sparse matrix
+			else if (JsSpVV != nullptr) {
+				TNmf::WeightedCFO(JsSpVV->Mat, JsRecSys->K, JsRecSys->U, JsRecSys->V, JsRecSys->Iter, JsRecSys->Tol,
+					JsRecSys->Notify);
+			}
+			else {
+				throw TExcept::New("RecommenderSys.fit: argument not a sparse or dense matrix");
+			}
 		}
 	}
 	catch (const PExcept& Except) {
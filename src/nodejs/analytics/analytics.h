@@ -8,6 +8,10 @@
 #ifndef ANALYTICS_H_
 #define ANALYTICS_H_
 
+// defined in qm_nodejs.h, which is included after this file
+class TNodeJsRecSet;
+class TNodeJsFtrSpace;
+
 /**
  * Analytics module.
  * @module analytics
@@ -98,6 +102,8 @@ private:
 	double MnDiff;
 	bool Verbose;
 	PNotify Notify;
+	// parallel SGD parameters
+	TSvm::TParSgdParam ParParam;
 
 	// model
 	TSvm::TLinModel Model;
@@ -107,6 +113,27 @@ private:
 
 	static TNodeJsSvmModel* NewFromArgs(const v8::FunctionCallbackInfo<v8::Value>& Args);
 
+protected:
+	/// Fits the model in the background, shared by SVC and SVR
+	class TFitTask : public TNodeTask {
+		v8::Persistent<v8::Object> JsModelObj;
+		TNodeJsSvmModel* JsModel;
+		TNodeJsFltVV* JsFltVV;
+		TNodeJsSpMat* JsSpVV;
+		TNodeJsRecSet* JsRecSet;
+		TNodeJsFtrSpace* JsFtrSpace;
+		TNodeJsFltV* JsTargetV;
+		bool ClassifyP;
+
+	public:
+		TFitTask(const v8::FunctionCallbackInfo<v8::Value>& Args, const bool& _ClassifyP);
+		~TFitTask();
+
+		v8::Handle<v8::Function> GetCallback(const v8::FunctionCallbackInfo<v8::Value>& Args);
+		void Run();
+		v8::Local<v8::Value> WrapResult();
+	};
+
 public:
 	//- `params = svmModel.getParams()` -- returns the parameters of this model as a Javascript object
 	JsDeclareFunction(getParams);
@@ -128,6 +155,18 @@ private:
 	PJsonVal GetParams() const;
 	void Save(TSOut& SOut) const;
 	void ClrModel();
+
+	/// true when one of the parallel SGD options is set
+	bool IsParSgd() const;
+	/// fits the model with the selected algorithm
+	TSvm::TLinModel Fit(const TFltVV& VecV, const TFltV& TargetV, const bool& ClassifyP) const;
+	TSvm::TLinModel Fit(const TVec<TIntFltKdV>& VecV, const TFltV& TargetV, const bool& ClassifyP) const;
+	/// fits the model on examples read from a batch source, parallel SGD reads
+	/// one batch at a time while the other algorithms read all the examples
+	TSvm::TLinModel Fit(const PFtrBatchSrc& BatchSrc, const TFltV& TargetV, const bool& ClassifyP) const;
+	/// fits the model with the (parallel) stochastic subgradient solver
+	template <class TVecV>
+	TSvm::TLinModel FitSgd(const TVecV& VecV, const int& Dims, const TFltV& TargetV, const bool& ClassifyP) const;
 };
 
 ///////////////////////////////
@@ -143,6 +182,11 @@ private:
 * @property  {number} [svcParam.maxTime=1] - Maximum runtime in seconds.
 * @property  {number} [svcParam.minDiff=1e-6] - Stopping criterion tolerance.
 * @property  {boolean} [svcParam.verbose=false] - Toggle verbose output in the console.
+* @property  {number} [svcParam.threads=1] - Number of threads used by the SGD algorithm, 0 uses all cores. The result does not depend on the number of threads unless `hogwild` is set.
+* @property  {boolean} [svcParam.hogwild=false] - Threads update the model as they go, without waiting for each other. Faster, but the result is not reproducible.
+* @property  {boolean} [svcParam.shrinking=false] - Stop sampling examples which are correctly classified outside the margin several times in a row.
+* @property  {number} [svcParam.validationFraction=0] - Fraction of examples held out to stop the training once the loss on them stops improving. 0 disables early stopping.
+* @property  {number} [svcParam.validationPatience=5] - Number of validation checks (one every 100 iterations) without improvement before the training stops.
 */
 
 /**
@@ -187,7 +231,7 @@ public:
 	* // returns { algorithm: 'SGD' c: 5, j: 10, batchSize: 2000, maxIterations: 12000, maxTime: 2, minDiff: 1e-10, verbose: true }
 	* var json = SVC.getParams(); 
 	*/
-	//# exports.SVC.prototype.getParams = function() { return { algorithm: '', c: 0, j: 0, batchSize: 0, maxIterations: 0, maxTime: 0, minDiff: 0, verbose: true } };
+	//# exports.SVC.prototype.getParams = function() { return { algorithm: '', c: 0, j: 0, batchSize: 0, maxIterations: 0, maxTime: 0, minDiff: 0, verbose: true, threads: 1, hogwild: false, shrinking: false, validationFraction: 0, validationPatience: 5 } };
 
 	/**
 	* Sets the SVC parameters.
@@ -302,7 +346,11 @@ public:
 	
 	/**
 	* Fits a SVM classification model, given column examples in a matrix and vector of targets.
-	* @param {module:la.Matrix | module:la.SparseMatrix} X - Input feature matrix where columns correspond to feature vectors.
+	* The examples can also be given as a record set and a feature space. Features are then extracted
+	* as they are needed, so with the SGD algorithm the feature matrix is never built in memory.
+	* @param {module:la.Matrix | module:la.SparseMatrix | module:qm.RecordSet} X - Input feature matrix where columns correspond to feature vectors,
+	* or a record set of examples.
+	* @param {module:qm.FeatureSpace} [featureSpace] - Feature space used to extract the features when X is a record set.
 	* @param {module:la.Vector} y - Input vector of targets, one for each column of X.
 	* @returns {module:analytics.SVC} Self.
 	* @example
@@ -316,9 +364,29 @@ public:
 	* var vec = new la.Vector([1, 1, -1, -1]);
 	* // fit the model
 	* SVC.fit(matrix, vec); // creates a model, where the hyperplane has the normal semi-equal to [1, 1]
+	* @example <caption> Asynchronous function </caption>
+	* // import the analytics and la modules
+	* var analytics = require('qminer').analytics;
+	* var la = require('qminer').la;
+	* // create a new SVC object which trains on all cores
+	* var SVC = new analytics.SVC({ threads: 0 });
+	* // create the matrix containing the input features and the input vector for each matrix.
+	* var matrix = new la.Matrix([[1, 0, -1, 0], [0, 1, 0, -1]]);
+	* var vec = new la.Vector([1, 1, -1, -1]);
+	* // fit the model in the background
+	* SVC.fitAsync(matrix, vec, function (err) {
+	*     if (err) { console.log(err); }
+	*     // successful calculation
+	* });
 	*/
-	//# exports.SVC.prototype.fit = function(X, y) { return Object.create(require('qminer').analytics.SVC.prototype); }
-	JsDeclareFunction(fit);
+	//# exports.SVC.prototype.fit = function(X, featureSpace, y) { return Object.create(require('qminer').analytics.SVC.prototype); }
+	JsDeclareSyncAsync(fit, fitAsync, TClassifyTask);
+
+private:
+	class TClassifyTask : public TFitTask {
+	public:
+		TClassifyTask(const v8::FunctionCallbackInfo<v8::Value>& Args): TFitTask(Args, true) { }
+	};
 };
 
 ///////////////////////////////
@@ -334,6 +402,11 @@ public:
 * @property  {number} [svrParam.maxTime=1.0] - Maximum runtime in seconds.
 * @property  {number} [svrParam.minDiff=1e-6] - Stopping criterion tolerance.
 * @property  {boolean} [svrParam.verbose=false] - Toggle verbose output in the console.
+* @property  {number} [svrParam.threads=1] - Number of threads used by the SGD algorithm, 0 uses all cores. The result does not depend on the number of threads unless `hogwild` is set.
+* @property  {boolean} [svrParam.hogwild=false] - Threads update the model as they go, without waiting for each other. Faster, but the result is not reproducible.
+* @property  {boolean} [svrParam.shrinking=false] - Stop sampling examples which are inside the epsilon tube several times in a row.
+* @property  {number} [svrParam.validationFraction=0] - Fraction of examples held out to stop the training once the loss on them stops improving. 0 disables early stopping.
+* @property  {number} [svrParam.validationPatience=5] - Number of validation checks (one every 100 iterations) without improvement before the training stops.
 */
 
 /**
@@ -377,7 +450,7 @@ public:
 	* // get the parameters of SVR
 	* var params = SVR.getParams();
 	*/
-	//# exports.SVR.prototype.getParams = function() { return { c: 0, eps: 0, batchSize: 0, maxIterations: 0, maxTime: 0, minDiff: 0, verbose: true } };
+	//# exports.SVR.prototype.getParams = function() { return { c: 0, eps: 0, batchSize: 0, maxIterations: 0, maxTime: 0, minDiff: 0, verbose: true, threads: 1, hogwild: false, shrinking: false, validationFraction: 0, validationPatience: 5 } };
 
 	/**
 	* Sets the SVR parameters.
@@ -472,8 +545,11 @@ public:
 	//# exports.SVR.prototype.predict = function(X) { return (X instanceof require('qminer').la.Vector | X instanceof require('qminer').la.SparseVector) ? 0 : Object.create(require('qminer').la.Vector.prototype); }
 
 	/**
-	* fits an SVM regression model, given column examples in a matrix and vector of targets
-	* @param {module:la.Matrix | module:la.SparseMatrix} X - Input feature matrix where columns correspond to feature vectors.
+	* fits an SVM regression model, given column examples in a matrix and vector of targets.
+	* The examples can also be given as a record set and a feature space, see {@link module:analytics.SVC#fit}.
+	* @param {module:la.Matrix | module:la.SparseMatrix | module:qm.RecordSet} X - Input feature matrix where columns correspond to feature vectors,
+	* or a record set of examples.
+	* @param {module:qm.FeatureSpace} [featureSpace] - Feature space used to extract the features when X is a record set.
 	* @param {module:la.Vector} y - Input vector of targets, one for each column of X.
 	* @returns {module:analytics.SVR} Self.
 	* @example
@@ -487,9 +563,29 @@ public:
 	* var vector = new la.Vector([1, 1]);
 	* // create the model by fitting the values
 	* SVR.fit(matrix, vector);
+	* @example <caption> Asynchronous function </caption>
+	* // import the modules
+	* var analytics = require('qminer').analytics;
+	* var la = require('qminer').la;
+	* // create a new SVR object which trains on two threads
+	* var SVR = new analytics.SVR({ c: 10, threads: 2 });
+	* // create a matrix and vector for the model
+	* var matrix = new la.Matrix([[1, -1], [1, 1]]);
+	* var vector = new la.Vector([1, 1]);
+	* // fit the model in the background
+	* SVR.fitAsync(matrix, vector, function (err) {
+	*     if (err) { console.log(err); }
+	*     // successful calculation
+	* });
 	*/
-	//# exports.SVR.prototype.fit = function(X, y) { return Object.create(require('qminer').analytics.SVR.prototype); }
-	JsDeclareFunction(fit);	
+	//# exports.SVR.prototype.fit = function(X, featureSpace, y) { return Object.create(require('qminer').analytics.SVR.prototype); }
+	JsDeclareSyncAsync(fit, fitAsync, TRegressTask);
+
+private:
+	class TRegressTask : public TFitTask {
+	public:
+		TRegressTask(const v8::FunctionCallbackInfo<v8::Value>& Args): TFitTask(Args, false) { }
+	};
 };
 
 /////////////////////////////////////////////
@@ -566,7 +662,8 @@ public:
 	JsDeclareFunction(getParams);
 
 	/**
-	* Set the parameters.
+	* Set the parameters. When the model was fitted on data with fewer features than instances,
+	* the weights are recomputed for the new gamma without going over the data again.
 	* @param {(number|Object)} gamma - The new parameter for the model, given as a number or as a json object.
 	* @returns {module:analytics.RidgeReg} Self. The parameter is set to gamma.
 	* @example
@@ -582,8 +679,11 @@ public:
 
     /**
      * Fits a column matrix of feature vectors X onto the response variable y.
+     * When X is a record set, the features are extracted with featureSpace a chunk of records
+     * at a time and the feature matrix is never built in memory.
      *
-     * @param {module:la.Matrix} X - Column matrix which stores the feature vectors.
+     * @param {module:la.Matrix | module:qm.RecordSet} X - Column matrix which stores the feature vectors, or a record set.
+     * @param {module:qm.FeatureSpace} [featureSpace] - Feature space used when X is a record set.
      * @param {module:la.Vector} y - Response variable.
      * @returns {module:analytics.RidgeReg} Self. The model is fitted by X and y.
 	 * @example
@@ -599,9 +699,31 @@ public:
 	 * // the weights of the model are 2, 1
 	 * regmod.fit(X, y);
      */
-    //# exports.RidgeReg.prototype.fit = function(X, y) { return Object.create(require('qminer').analytics.RidgeReg.prototype); }
+    //# exports.RidgeReg.prototype.fit = function(X, featureSpace, y) { return Object.create(require('qminer').analytics.RidgeReg.prototype); }
     JsDeclareFunction(fit);
 
+    /**
+     * Computes the weights for several values of gamma at once. Uses the data of the last fit, which
+     * should have fewer features than instances; the matrix is decomposed once and reused for all the
+     * values, so long regularization paths are cheap. The model is not changed.
+     *
+     * @param {(module:la.Vector | Array<number>)} gammas - Values of gamma.
+     * @returns {module:la.Matrix} The weights, one column per value of gamma.
+	 * @example
+	 * // import modules
+	 * var analytics = require('qminer').analytics;
+	 * var la = require('qminer').la;
+	 * // create and fit a new Ridge Regression object
+	 * var regmod = new analytics.RidgeReg({ gamma: 1 });
+	 * var X = la.randn(5, 100);
+	 * var y = la.randn(100);
+	 * regmod.fit(X, y);
+	 * // get the weights for three values of gamma
+	 * var W = regmod.regularizationPath([0.1, 1, 10]);
+     */
+    //# exports.RidgeReg.prototype.regularizationPath = function(gammas) { return Object.create(require('qminer').la.Matrix.prototype); }
+    JsDeclareFunction(regularizationPath);
+
     /**
      * Returns the expected response for the provided feature vector.
      *
@@ -877,6 +999,12 @@ public:
 * A Json object used for the creation of the {@link module:analytics.NearestNeighborAD}.
 * @param {number} [rate=0.05] - The expected fracton of emmited anomalies (0.05 -> 5% of cases will be classified as anomalies).
 * @param {number} [windowSize=100] - Number of most recent instances kept in the model.
+* @param {Object} [ann] - When given, nearest neighbors are found with an approximate index (HNSW graph) instead
+* of comparing against all the instances in the window. Useful for windows beyond a few thousand instances.
+* @param {number} [ann.efSearch=50] - Size of the candidate list when searching. Higher values give more accurate
+* distances at a slower speed. For windows not larger than efSearch the exact search is used.
+* @param {number} [ann.M=16] - Maximal number of links per instance in the graph.
+* @param {number} [ann.efConstruction=100] - Size of the candidate list when adding instances to the graph.
 */
 
 /**
@@ -1373,9 +1501,14 @@ public:
 
 	/**
 	 * Fits a column matrix of feature vectors X onto the response variable y.
-	 * @param {module:la.Matrix} X - the column matrix which stores the feature vectors.
+	 * When X is a record set, the features are extracted with featureSpace a chunk of records
+	 * at a time and the feature matrix is never built in memory.
+	 * @param {module:la.Matrix | module:qm.RecordSet} X - the column matrix which stores the feature vectors, or a record set.
+	 * @param {module:qm.FeatureSpace} [featureSpace] - the feature space used when X is a record set.
 	 * @param {module:la.Vector} y - the response variable.
-	 * @param {number} [eps] - the epsilon used for convergence.
+	 * @param {number} [eps=1e-3] - the epsilon used for convergence.
+	 * @param {boolean} [warmStart=false] - if true, Newton's method starts from the current weights instead of zeros,
+	 * which makes refitting on the same data for a series of lambdas fast.
 	 * @returns {module:analytics.LogReg} Self.
 	 * @example
 	 * // import modules
@@ -1391,7 +1524,7 @@ public:
 	 *     logreg.fit(mat, vec);
 	 * }
 	 */
-	//# exports.LogReg.prototype.fit = function (X, y, eps) { return Object.create(require('qminer').analytics.LogReg.prototype); }
+	//# exports.LogReg.prototype.fit = function (X, featureSpace, y, eps, warmStart) { return Object.create(require('qminer').analytics.LogReg.prototype); }
 	JsDeclareFunction(fit);
 
 	/**
@@ -1457,6 +1590,151 @@ public:
 	JsDeclareFunction(save);
 };
 
+/////////////////////////////////////////////
+// Decision Tree
+
+/**
+* @typedef {Object} decisionTreeParam
+* The Json constructor parameters for {@link module:analytics.DecisionTree}.
+* @property {string} [splitCriteria='infoGain'] - The criteria used to select the cut, one of 'infoGain' or 'gainRatio'.
+* @property {number} [minExamples=0] - Nodes with at most this many examples are not split.
+* @property {number} [minClassProb=0] - Nodes where the probability of either class is at most this value are not split.
+* Use <code>minPosProb</code> and <code>minNegProb</code> to set the limits for each class separately.
+* @property {boolean} [calcCorr=false] - If true, the correlations between the cut feature and other features are
+* calculated in each node.
+* @property {number} [maxBins=0] - If greater than 0, each feature is first quantized into at most <code>maxBins</code>
+* (up to 256) bins and the cuts are searched on class histograms, in parallel over the nodes of each level. If 0, the
+* cuts are searched on the sorted feature values.
+*/
+
+/**
+ * Binary decision tree classifier. The classes are 0 and 1.
+ * @constructor
+ * @param {(module:analytics~decisionTreeParam|module:fs.FIn)} [opts] - The options used for initialization or the input stream from which the model is loaded. If this parameter is an input stream than no other parameters are required.
+ * @example
+ * // import analytics module
+ * var analytics = require('qminer').analytics;
+ * // create a decision tree which quantizes the features into 64 bins
+ * var tree = new analytics.DecisionTree({ minExamples: 10, maxBins: 64 });
+ */
+//# exports.DecisionTree = function (opts) { return Object.create(require('qminer').analytics.DecisionTree.prototype); }
+class TNodeJsDecisionTree : public node::ObjectWrap {
+	friend class TNodeJsUtil;
+public:
+	static void Init(v8::Handle<v8::Object> exports);
+	static const TStr GetClassId() { return "DecisionTree"; }
+
+private:
+	PJsonVal ParamVal;
+	TClassification::TDecisionTree Tree;
+
+	TNodeJsDecisionTree(const PJsonVal& ParamVal);
+	TNodeJsDecisionTree(TSIn& SIn);
+
+	static TNodeJsDecisionTree* NewFromArgs(const v8::FunctionCallbackInfo<v8::Value>& Args);
+
+	/// fills in the defaults of the missing parameters
+	static PJsonVal GetParamVal(const PJsonVal& ArgVal);
+	/// creates an empty tree from the parameters
+	static TClassification::TDecisionTree NewTree(const PJsonVal& ParamVal);
+
+public:
+
+	/**
+	* Gets the parameters.
+	* @returns {module:analytics~decisionTreeParam} The parameters of the model.
+	* @example
+	* // import analytics module
+	* var analytics = require('qminer').analytics;
+	* // create the decision tree
+	* var tree = new analytics.DecisionTree({ maxBins: 64 });
+	* // get the parameters of the model
+	* var param = tree.getParams(); // returns { splitCriteria: 'infoGain', minExamples: 0, minPosProb: 0, minNegProb: 0, calcCorr: false, maxBins: 64 }
+	*/
+	//# exports.DecisionTree.prototype.getParams = function () { return { splitCriteria: 'infoGain', minExamples: 0, minPosProb: 0, minNegProb: 0, calcCorr: false, maxBins: 0 } };
+	JsDeclareFunction(getParams);
+
+	/**
+	* Sets the parameters. The parameters which are not given keep their values. The tree is
+	* cleared and has to be fitted again.
+	* @param {module:analytics~decisionTreeParam} param - The new parameters.
+	* @returns {module:analytics.DecisionTree} Self. The parameters are updated.
+	* @example
+	* // import analytics module
+	* var analytics = require('qminer').analytics;
+	* // create the decision tree
+	* var tree = new analytics.DecisionTree();
+	* // switch to histogram splits
+	* tree.setParams({ maxBins: 128 });
+	*/
+	//# exports.DecisionTree.prototype.setParams = function (param) { return Object.create(require('qminer').analytics.DecisionTree.prototype); }
+	JsDeclareFunction(setParams);
+
+	/**
+	 * Grows the tree on a column matrix of feature vectors X and their classes y.
+	 * @param {module:la.Matrix} X - the column matrix which stores the feature vectors.
+	 * @param {module:la.Vector} y - the classes, 0 or 1.
+	 * @returns {module:analytics.DecisionTree} Self.
+	 * @example
+	 * // import modules
+	 * var analytics = require('qminer').analytics;
+	 * var la = require('qminer').la;
+	 * // create the decision tree
+	 * var tree = new analytics.DecisionTree();
+	 * // create the input matrix and vector for fitting the model
+	 * var mat = new la.Matrix([[1, 2, 3, 4], [0, 1, 0, 1]]);
+	 * var vec = new la.Vector([0, 0, 1, 1]);
+	 * // fit the model
+	 * tree.fit(mat, vec);
+	 */
+	//# exports.DecisionTree.prototype.fit = function (X, y) { return Object.create(require('qminer').analytics.DecisionTree.prototype); }
+	JsDeclareFunction(fit);
+
+	/**
+	 * Returns the probability of class 1 for the provided feature vector or for each column of a matrix.
+	 * @param {module:la.Vector | module:la.Matrix} x - the feature vector or the column matrix of feature vectors.
+	 * @returns {number | module:la.Vector} the probability of class 1 in the leaf of each feature vector.
+	 * @example
+	 * // import modules
+	 * var analytics = require('qminer').analytics;
+	 * var la = require('qminer').la;
+	 * // create and fit the decision tree
+	 * var tree = new analytics.DecisionTree();
+	 * tree.fit(new la.Matrix([[1, 2, 3, 4], [0, 1, 0, 1]]), new la.Vector([0, 0, 1, 1]));
+	 * // get the prediction
+	 * var prediction = tree.predict(new la.Vector([3.5, 0]));
+	 */
+	//# exports.DecisionTree.prototype.predict = function (x) { return 0.0; }
+	JsDeclareFunction(predict);
+
+	/**
+	 * Returns the structure of the tree. Each node holds the number of examples, the class and
+	 * feature histograms, the cut and its children.
+	 * @returns {Object} The root node of the tree.
+	 */
+	//# exports.DecisionTree.prototype.getModel = function () { return {}; }
+	JsDeclareFunction(getModel);
+
+	/**
+	 * Saves the model into the output stream.
+	 * @param {module:fs.FOut} fout - the output stream.
+	 * @returns {module:fs.FOut} The output stream fout.
+	 * @example
+	 * // import modules
+	 * var analytics = require('qminer').analytics;
+	 * var fs = require('qminer').fs;
+	 * // create the decision tree and save it
+	 * var tree = new analytics.DecisionTree({ maxBins: 32 });
+	 * var fout = fs.openWrite('tree_example.bin');
+	 * tree.save(fout);
+	 * fout.close();
+	 * // load the tree from the input stream
+	 * var tree2 = new analytics.DecisionTree(fs.openRead('tree_example.bin'));
+	 */
+	//# exports.DecisionTree.prototype.save = function (fout) { return Object.create(require('qminer').fs.FOut.prototype); }
+	JsDeclareFunction(save);
+};
+
 /////////////////////////////////////////////
 // Proportional Hazards Model
 
@@ -1622,8 +1900,10 @@ public:
 * @property {module:la.IntVector} [layout] - The integer vector with the corresponding values of the number of neutrons. Default is the integer vector [1, 2 ,1].
 * @property {number} [learnRate = 0.1] - The learning rate.
 * @property {number} [momentum = 0.5] - The momentum of optimization.
-* @property {string} [tFuncHidden = 'tanHyper'] - The function.
-* @property {string} [tFuncOut = 'tanHyper'] - The function.
+* @property {string} [tFuncHidden = 'tanHyper'] - The transfer function of the hidden layers. The possible options are 'tanHyper', 'sigmoid', 'fastTanh', 'fastSigmoid', 'linear', 'softPlus' and 'relu'.
+* @property {string} [tFuncOut = 'tanHyper'] - The transfer function of the output layer. The options are the same as for tFuncHidden.
+* @property {string} [optimizer = 'sgd'] - The weight update rule: 'sgd' (gradient descent with momentum) or 'adam'.
+* @property {number} [batchSize = 0] - The number of columns per weight update when fitting on a matrix. If <= 0, the whole matrix is used for one update.
 */
 
 /**
@@ -1637,6 +1917,7 @@ class TNodeJsNNet : public node::ObjectWrap {
 	friend class TNodeJsUtil;
 private:
 	TSignalProc::PNNet Model;
+	TInt BatchSize;
 
 	TNodeJsNNet(const PJsonVal& ParamVal);
 	TNodeJsNNet(TSIn& SIn);
@@ -1657,7 +1938,7 @@ public:
 	* // get the parameters
 	* var params = nnet.getParams();
 	*/
-	//# exports.NNet.prototype.getParams = function () { return { layout: Object.create(require('qminer').la.IntVector.prototype), learnRate: 0.0, momentum: 0.0, tFuncHidden: "", TFuncOut: "" }; }
+	//# exports.NNet.prototype.getParams = function () { return { layout: Object.create(require('qminer').la.IntVector.prototype), learnRate: 0.0, momentum: 0.0, tFuncHidden: "", TFuncOut: "", optimizer: "", batchSize: 0 }; }
 	JsDeclareFunction(getParams);
 
 	/**
@@ -1699,8 +1980,9 @@ public:
 	
 	/**
 	* Sends the vector through the model and get the prediction.
-	* @param {module:la.Vector} vec - The sent vector.
-	* @returns {number} The prediction of the vector vec.
+	* @param {(module:la.Vector|module:la.Matrix)} vec - The sent vector or a matrix whose columns are the input vectors.
+	* @returns {(module:la.Vector|module:la.Matrix)} The prediction of the vector vec. If vec is a matrix, the columns of the
+	* returned matrix are the predictions of the corresponding columns.
 	* @example
 	* // import modules
 	* var analytics = require('qminer').analytics;
@@ -1717,7 +1999,7 @@ public:
 	* // predict the value
 	* var prediction = nnet.predict(test);
 	*/
-	//# exports.NNet.prototype.predict = function (vec) { return 0.0; }
+	//# exports.NNet.prototype.predict = function (vec) { return Object.create(require('qminer').la.Vector.prototype); }
 	JsDeclareFunction(predict);
 
 	/**
@@ -1748,6 +2030,7 @@ public:
 	JsDeclareFunction(save);
  private:
 	TSignalProc::TTFunc ExtractFuncFromString(const TStr& FuncString);
+	TSignalProc::TNNetOpt ExtractOptFromString(const TStr& OptString);
 };
 
 /////////////////////////////////////////////
@@ -2012,9 +2295,15 @@ private:
 
 /**
 * @typedef {Object} KMeansParameters
-* @property {number} [iter=10000] - The maximum number of iterations.
+* @property {number} [iter=10000] - The maximum number of iterations. With mini-batches it is the maximum number of batches.
 * @property {number} [k=2] - The number of centroids.
 * @property {boolean} [allowEmpty=true] - wether to allow empty clusters to be generated
+* @property {number} [batchSize=0] - The number of examples in a mini-batch. With 0 each iteration uses all the examples,
+* otherwise mini-batch KMeans is used, which reads the examples a batch at a time and stops when the smoothed
+* inertia of the batches stops improving.
+* @property {string} [init="random"] - The initialization of the centroids, when neither `fitIdx` nor `fitStart` are given.
+* Options: "random" (random examples) or "kmeans||" (scalable KMeans++).
+* @property {number} [threads=1] - The number of threads used for clustering and, when fitting on a record set, for extracting features.
 * @property {string} [centroidType="Dense"] - The type of centroids. Options: "Dense" or "Sparse".
 * @property {string} [distanceType="Euclid"] - The distance type used at the calculations. Options: "Euclid" or "Cos".
 * @property {boolean} [verbose=false] - If false, the console output is supressed.
@@ -2069,6 +2358,13 @@ private:
     bool Verbose;
     PNotify Notify;
 
+    /// mini-batch size, 0 for full batches
+    TInt BatchSize;
+    /// use k-means|| initialization
+    TBool ParInitP;
+    /// number of threads used for clustering and feature extraction
+    TInt Threads;
+
     TNodeJsKMeans(const PJsonVal& ParamVal);
     TNodeJsKMeans(const PJsonVal& ParamVal, const TFltVV& Mat);
     TNodeJsKMeans(const PJsonVal& ParamVal, const TVec<TIntFltKdV>& Mat);
@@ -2083,15 +2379,25 @@ private:
         // first argument
         TNodeJsFltVV*  JsFltVV;
         TNodeJsSpMat*  JsSpVV;
+        TNodeJsRecSet* JsRecSet;
         // second argument
         TNodeJsIntV*   JsIntV;
         TNodeJsIntV*   JsArr;
+        TNodeJsFtrSpace* JsFtrSpace;
 
     public:
         TFitTask(const v8::FunctionCallbackInfo<v8::Value>& Args);
 
         v8::Handle<v8::Function> GetCallback(const v8::FunctionCallbackInfo<v8::Value>& Args);
         void Run();
+
+    private:
+        /// fits the model reading the examples from a batch source
+        template <class TCentroid>
+        void FitBatch(TClustering::TDnsKMeans<TCentroid>* KMeans, const PFtrBatchSrc& BatchSrc);
+        /// initial centroids given by fitStart or fitIdx
+        void GetFitStart(const PFtrBatchSrc& BatchSrc, TFltVV& InitCentroidVV) const;
+        void GetFitStart(const PFtrBatchSrc& BatchSrc, TVec<TIntFltKdV>& InitCentroidVV) const;
     };
 
 public:
@@ -2107,7 +2413,7 @@ public:
     * // get the parameters
     * var json = KMeans.getParams();
     */
-    //# exports.KMeans.prototype.getParams = function () { return { iter: 10000, k: 2, distanceType: "Euclid", centroidType: "Dense", verbose: false }; }
+    //# exports.KMeans.prototype.getParams = function () { return { iter: 10000, k: 2, distanceType: "Euclid", centroidType: "Dense", verbose: false, batchSize: 0, init: "random", threads: 1 }; }
     JsDeclareFunction(getParams);
     
     /**
@@ -2127,7 +2433,12 @@ public:
 
     /**
      * Computes the centroids.
-     * @param {(module:la.Matrix | module:la.SparseMatrix)} X - Matrix whose columns correspond to examples.
+     * @param {(module:la.Matrix | module:la.SparseMatrix | module:qm.RecordSet)} X - Matrix whose columns correspond to examples,
+     * or a record set. Features of the records are extracted with `featureSpace` a batch at a time, so the full feature matrix
+     * is only built when `batchSize` is 0. The representation of the features follows `centroidType`.
+     * @param {(Array.<number> | module:la.IntVector | module:qm.FeatureSpace)} [recordIds] - The record ids of the examples,
+     * used for {@link module:analytics.KMeans#medoids}. When X is a record set this is the feature space used to extract the
+     * features and the medoids are the ids of the records.
      * @returns {module:analytics.KMeans} Self. It stores the info about the new model.
      * @example <caption> Asynchronous function </caption>
      * // import analytics module
@@ -2152,8 +2463,17 @@ public:
      * var X = new la.Matrix([[1, -2, -1], [1, 1, -3]]);
      * // create the model with the matrix X
      * KMeans.fit(X);
+     *
+     * @example <caption> Mini-batches </caption>
+     * var analytics = require('qminer').analytics;
+     * // mini-batch KMeans with k-means|| initialization
+     * var KMeans = new analytics.KMeans({ k: 3, batchSize: 100, init: "kmeans||" });
+     * // create a matrix to be fitted
+     * var X = new la.Matrix([[1, -2, -1], [1, 1, -3]]);
+     * // create the model with the matrix X
+     * KMeans.fit(X);
      */
-    //# exports.KMeans.prototype.fit = function (X) { return Object.create(require('qminer').analytics.KMeans.prototype); }
+    //# exports.KMeans.prototype.fit = function (X, recordIds) { return Object.create(require('qminer').analytics.KMeans.prototype); }
     JsDeclareSyncAsync(fit, fitAsync, TFitTask);
 
     /**
@@ -2266,6 +2586,11 @@ private:
 * @property {number} [k=2] - The number of centroids.
 * @property {number} [tol=1e-3] - The tolerance.
 * @property {boolean} [verbose=false] - If false, the console output is supressed.
+* @property {string} [algorithm='cfo'] - The factorization algorithm. Possible options are:
+* <br>1. 'cfo' - gradient projection with coordinate search,
+* <br>2. 'als' - alternating least squares, where the rows of U and the columns of V are solved for in parallel. It is
+* much faster on large sparse matrices; fitting stops when the relative decrease of the loss falls below tol.
+* @property {number} [lambda=0.01] - The regularization parameter of the 'als' algorithm.
 */
 
 /**
@@ -2295,10 +2620,14 @@ private:
 	int K;
 	double Tol;
 	bool Verbose;
+	TStr Algorithm;
+	double Lambda;
 	PNotify Notify;
 
 	TFltVV U;
 	TFltVV V;
+	// loss after each iteration of the last 'als' fit
+	TFltV LossV;
 	
 	TNodeJsRecommenderSys(const PJsonVal& ParamVal);
 	TNodeJsRecommenderSys(TSIn& SIn);
@@ -2331,7 +2660,7 @@ public:
 	* // get the parameters
 	* var json = recSys.getParams();
 	*/
-	//# exports.RecommenderSys.prototype.getParams = function () { return { iter: 10000, k: 2, tol: 1e-3, verbose: false }; }
+	//# exports.RecommenderSys.prototype.getParams = function () { return { iter: 10000, k: 2, tol: 1e-3, verbose: false, algorithm: 'cfo', lambda: 0.01 }; }
 	JsDeclareFunction(getParams);
 
 	/**
@@ -2352,7 +2681,7 @@ public:
 	/**
 	 * Gets the model.
 	 * @returns {Object} An object <b>json</b> containing the matrices json.U and json.V, for which the product gives the approximation of the fitted 
-	 * matrix.
+	 * matrix, and the vector json.loss with the loss after each iteration of the 'als' algorithm.
 	 * @example
 	 * // import modules
 	 * //var analytics = require('qminer').analytics;
@@ -73,14 +73,9 @@ void TNodeJsLinAlg::TSVDTask::Run() {
 			TLinAlg::ComputeThinSVD(Mat, k, URef, sRef, VRef, Iters, Tol);
 		}
 		else if (JsSpVV != nullptr) {
-			if (JsSpVV->Rows != -1) {
-				TSparseColMatrix Mat(JsSpVV->Mat, JsSpVV->Rows, JsSpVV->Mat.Len());
-				TLinAlg::ComputeThinSVD(Mat, k, URef, sRef, VRef, Iters, Tol);
-			}
-			else {
-				TSparseColMatrix Mat(JsSpVV->Mat);
-				TLinAlg::ComputeThinSVD(Mat, k, URef, sRef, VRef, Iters, Tol);
-			}
+			// rows == -1 takes the number of rows from the largest row index
+			TCompressedSparseMatrix Mat(JsSpVV->Mat, JsSpVV->Rows);
+			TLinAlg::ComputeThinSVD(Mat, k, URef, sRef, VRef, Iters, Tol);
 		}
 		else {
 			throw TExcept::New("svd: expects dense or sparse matrix!");
@@ -91,6 +91,7 @@ void InitAnalytics(Handle<Object> Exports, const TStr& NsNm) {
     TNodeJsNNAnomalies::Init(NsObj);
 	TNodeJsRecLinReg::Init(NsObj);
 	TNodeJsLogReg::Init(NsObj);
+	TNodeJsDecisionTree::Init(NsObj);
 	TNodeJsPropHaz::Init(NsObj);
 	TNodeJsNNet::Init(NsObj);
 	TNodeJsTokenizer::Init(NsObj);
@@ -295,8 +295,16 @@ void TNodeJsBase::Init(v8::Handle<v8::Object> exports) {
     NODE_SET_PROTOTYPE_METHOD(tpl, "garbageCollect", _garbageCollect);
     NODE_SET_PROTOTYPE_METHOD(tpl, "partialFlush", _partialFlush);
     NODE_SET_PROTOTYPE_METHOD(tpl, "getStats", _getStats);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "setStreamAggrStats", _setStreamAggrStats);
     NODE_SET_PROTOTYPE_METHOD(tpl, "getStreamAggr", _getStreamAggr);
     NODE_SET_PROTOTYPE_METHOD(tpl, "getStreamAggrNames", _getStreamAggrNames);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "flushStreamAggrs", _flushStreamAggrs);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "saveStreamAggrState", _saveStreamAggrState);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "loadStreamAggrState", _loadStreamAggrState);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "createView", _createView);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "view", _view);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "deleteView", _deleteView);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "getViewNames", _getViewNames);
 
     // This has to be last, otherwise the properties won't show up on the object in JavaScript  
     // Constructor is used when creating the object from C++
@@ -673,6 +681,15 @@ void TNodeJsBase::getStats(const v8::FunctionCallbackInfo<v8::Value>& Args) {
     Args.GetReturnValue().Set(TNodeJsUtil::ParseJson(Isolate, res));
 }
 
+void TNodeJsBase::setStreamAggrStats(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+    v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope HandleScope(Isolate);
+
+    TNodeJsBase* JsBase = TNodeJsUtil::UnwrapCheckWatcher<TNodeJsBase>(Args.Holder());
+    JsBase->Base->SetStreamAggrStatP(TNodeJsUtil::GetArgBool(Args, 0));
+    Args.GetReturnValue().Set(v8::Undefined(Isolate));
+}
+
 void TNodeJsBase::getStreamAggr(const v8::FunctionCallbackInfo<v8::Value>& Args) {
     v8::Isolate* Isolate = v8::Isolate::GetCurrent();
     v8::HandleScope HandleScope(Isolate);
@@ -701,6 +718,101 @@ void TNodeJsBase::getStreamAggrNames(const v8::FunctionCallbackInfo<v8::Value>&
     Args.GetReturnValue().Set(TNodeJsUtil::GetStrArr(StreamAggrNmV));
 }
 
+void TNodeJsBase::flushStreamAggrs(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+    v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope HandleScope(Isolate);
+
+    TNodeJsBase* JsBase = TNodeJsUtil::UnwrapCheckWatcher<TNodeJsBase>(Args.Holder());
+    JsBase->Base->FlushStreamAggrs();
+    Args.GetReturnValue().Set(v8::Undefined(Isolate));
+}
+
+void TNodeJsBase::saveStreamAggrState(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+    v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope HandleScope(Isolate);
+
+    TNodeJsBase* JsBase = TNodeJsUtil::UnwrapCheckWatcher<TNodeJsBase>(Args.Holder());
+    const TStr SnapFPath = TNodeJsUtil::GetArgStr(Args, 0);
+    // optional list of aggregates, default is the list from the previous save
+    TStrV AggrNmV;
+    if (!TNodeJsUtil::IsArgNullOrUndef(Args, 1)) {
+        PJsonVal AggrNmVal = TNodeJsUtil::GetArgJson(Args, 1);
+        QmAssertR(AggrNmVal->IsArr(), "base.saveStreamAggrState: names should be an array of strings");
+        AggrNmVal->GetArrStrV(AggrNmV);
+    }
+    PJsonVal ResVal = JsBase->Base->SaveStreamAggrState(SnapFPath, AggrNmV);
+    Args.GetReturnValue().Set(TNodeJsUtil::ParseJson(Isolate, ResVal));
+}
+
+void TNodeJsBase::loadStreamAggrState(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+    v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope HandleScope(Isolate);
+
+    TNodeJsBase* JsBase = TNodeJsUtil::UnwrapCheckWatcher<TNodeJsBase>(Args.Holder());
+    const TStr SnapFPath = TNodeJsUtil::GetArgStr(Args, 0);
+    const bool MMapP = TNodeJsUtil::GetArgBool(Args, 1, true);
+    PJsonVal ResVal = JsBase->Base->LoadStreamAggrState(SnapFPath, MMapP);
+    Args.GetReturnValue().Set(TNodeJsUtil::ParseJson(Isolate, ResVal));
+}
+
+void TNodeJsBase::createView(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+    v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope HandleScope(Isolate);
+
+    // unwrap
+    TNodeJsBase* JsBase = TNodeJsUtil::UnwrapCheckWatcher<TNodeJsBase>(Args.Holder());
+    TWPt<TQm::TBase> Base = JsBase->Base;
+
+    const TStr ViewNm = TNodeJsUtil::GetArgStr(Args, 0);
+    PJsonVal QueryVal = TNodeJsUtil::GetArgJson(Args, 1);
+    // create the view and return its current content
+    TWPt<TQm::TQueryView> QueryView = Base->AddQueryView(ViewNm, QueryVal);
+    TQm::PRecSet RecSet = QueryView->GetRecSet()->Clone();
+    Args.GetReturnValue().Set(TNodeJsUtil::NewInstance<TNodeJsRecSet>(new TNodeJsRecSet(RecSet, JsBase->Watcher)));
+}
+
+void TNodeJsBase::view(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+    v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope HandleScope(Isolate);
+
+    // unwrap
+    TNodeJsBase* JsBase = TNodeJsUtil::UnwrapCheckWatcher<TNodeJsBase>(Args.Holder());
+    TWPt<TQm::TBase> Base = JsBase->Base;
+
+    const TStr ViewNm = TNodeJsUtil::GetArgStr(Args, 0);
+    if (Base->IsQueryView(ViewNm)) {
+        // view's record set is shared, give javascript its own copy
+        TQm::PRecSet RecSet = Base->GetQueryView(ViewNm)->GetRecSet()->Clone();
+        Args.GetReturnValue().Set(TNodeJsUtil::NewInstance<TNodeJsRecSet>(new TNodeJsRecSet(RecSet, JsBase->Watcher)));
+    } else {
+        Args.GetReturnValue().Set(v8::Null(Isolate));
+    }
+}
+
+void TNodeJsBase::deleteView(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+    v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope HandleScope(Isolate);
+
+    // unwrap
+    TNodeJsBase* JsBase = TNodeJsUtil::UnwrapCheckWatcher<TNodeJsBase>(Args.Holder());
+    TWPt<TQm::TBase> Base = JsBase->Base;
+
+    const TStr ViewNm = TNodeJsUtil::GetArgStr(Args, 0);
+    Base->DelQueryView(ViewNm);
+    Args.GetReturnValue().Set(v8::Undefined(Isolate));
+}
+
+void TNodeJsBase::getViewNames(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+    v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope HandleScope(Isolate);
+
+    // unwrap
+    TNodeJsBase* JsBase = TNodeJsUtil::UnwrapCheckWatcher<TNodeJsBase>(Args.Holder());
+    TWPt<TQm::TBase> Base = JsBase->Base;
+
+    Args.GetReturnValue().Set(TNodeJsUtil::GetStrArr(Base->GetQueryViewNmV()));
+}
+
 ///////////////////////////////
 // NodeJs QMiner Store
 v8::Persistent<v8::Function> TNodeJsStore::Constructor;
@@ -728,6 +840,9 @@ void TNodeJsStore::Init(v8::Handle<v8::Object> exports) {
     NODE_SET_PROTOTYPE_METHOD(tpl, "key", _key);
     NODE_SET_PROTOTYPE_METHOD(tpl, "resetStreamAggregates", _resetStreamAggregates);
     NODE_SET_PROTOTYPE_METHOD(tpl, "getStreamAggrNames", _getStreamAggrNames);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "setStreamAggrBatchSize", _setStreamAggrBatchSize);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "setStreamAggrThreads", _setStreamAggrThreads);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "getStreamAggrStats", _getStreamAggrStats);
     NODE_SET_PROTOTYPE_METHOD(tpl, "toJSON", _toJSON);
     NODE_SET_PROTOTYPE_METHOD(tpl, "clear", _clear);
     NODE_SET_PROTOTYPE_METHOD(tpl, "getVector", _getVector);
@@ -1221,6 +1336,35 @@ void TNodeJsStore::getStreamAggrNames(const v8::FunctionCallbackInfo<v8::Value>&
     }		
 }		
 
+void TNodeJsStore::setStreamAggrBatchSize(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+    v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope HandleScope(Isolate);
+
+    TNodeJsStore* JsStore = TNodeJsUtil::UnwrapCheckWatcher<TNodeJsStore>(Args.Holder());
+    const int BatchSize = TNodeJsUtil::GetArgInt32(Args, 0);
+    JsStore->Store->GetBase()->SetStreamAggrBatchSize(JsStore->Store->GetStoreId(), BatchSize);
+    Args.GetReturnValue().Set(v8::Undefined(Isolate));
+}
+
+void TNodeJsStore::setStreamAggrThreads(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+    v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope HandleScope(Isolate);
+
+    TNodeJsStore* JsStore = TNodeJsUtil::UnwrapCheckWatcher<TNodeJsStore>(Args.Holder());
+    const int Threads = TNodeJsUtil::GetArgInt32(Args, 0);
+    JsStore->Store->GetBase()->GetStreamAggrSet(JsStore->Store->GetStoreId())->SetThreads(Threads);
+    Args.GetReturnValue().Set(v8::Undefined(Isolate));
+}
+
+void TNodeJsStore::getStreamAggrStats(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+    v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope HandleScope(Isolate);
+
+    TNodeJsStore* JsStore = TNodeJsUtil::UnwrapCheckWatcher<TNodeJsStore>(Args.Holder());
+    PJsonVal StatVal = JsStore->Store->GetBase()->GetStreamAggrSet(JsStore->Store->GetStoreId())->GetStatJson();
+    Args.GetReturnValue().Set(TNodeJsUtil::ParseJson(Isolate, StatVal));
+}
+
 void TNodeJsStore::toJSON(const v8::FunctionCallbackInfo<v8::Value>& Args) {
     v8::Isolate* Isolate = v8::Isolate::GetCurrent();
     v8::HandleScope HandleScope(Isolate);
@@ -2435,14 +2579,12 @@ void TNodeJsRecSet::aggr(const v8::FunctionCallbackInfo<v8::Value>& Args) {
             Args.GetReturnValue().Set(v8::Null(Isolate));
             return;
         }
-        // compute new aggregates
-        v8::Local<v8::Array> AggrValV = v8::Array::New(Isolate, QueryAggrV.Len());
-        for (int QueryAggrN = 0; QueryAggrN < QueryAggrV.Len(); QueryAggrN++) {
-            const TQm::TQueryAggr& QueryAggr = QueryAggrV[QueryAggrN];
-            // compute aggregate
-            TQm::PAggr Aggr = TQm::TAggr::New(Base, RecSet, QueryAggr);
+        // compute new aggregates, in one pass over the record set where possible
+        TVec<TQm::PAggr> AggrV; TQm::TAggr::New(Base, RecSet, QueryAggrV, AggrV);
+        v8::Local<v8::Array> AggrValV = v8::Array::New(Isolate, AggrV.Len());
+        for (int AggrN = 0; AggrN < AggrV.Len(); AggrN++) {
             // serialize to json
-            AggrValV->Set(QueryAggrN, TNodeJsUtil::ParseJson(Isolate, Aggr->SaveJson()));
+            AggrValV->Set(AggrN, TNodeJsUtil::ParseJson(Isolate, AggrV[AggrN]->SaveJson()));
         }
         // return aggregates
         if (AggrValV->Length() == 1) {
@@ -4134,7 +4276,7 @@ void TNodeJsFtrSpace::extractSparseMatrix(const v8::FunctionCallbackInfo<v8::Val
     v8::Isolate* Isolate = v8::Isolate::GetCurrent();
     v8::HandleScope HandleScope(Isolate);
 
-    QmAssertR(Args.Length() == 1 || Args.Length() == 2, "Should have 1  or 2 arguments!");
+    QmAssertR(1 <= Args.Length() && Args.Length() <= 3, "Should have 1, 2 or 3 arguments!");
 
     TVec<TIntFltKdV> SpMat;
 
@@ -4148,6 +4290,7 @@ void TNodeJsFtrSpace::extractSparseMatrix(const v8::FunctionCallbackInfo<v8::Val
 
     const int FtrExtN = TNodeJsUtil::GetArgInt32(Args, 1, -1);
     EAssertR(-1 <= FtrExtN && FtrExtN < JsFtrSpace->FtrSpace->GetFtrExts(), "FeatureSpace.extractSparseMatrix: invalid feature extractor ID!");
+    const int Threads = TNodeJsUtil::GetArgInt32(Args, 2, 1);
 
     if (TNodeJsUtil::IsArgWrapObj<TNodeJsRecSet>(Args, 0)) {
         TNodeJsRecSet* RecSet = TNodeJsUtil::UnwrapCheckWatcher<TNodeJsRecSet>(Args[0]->ToObject());
@@ -4155,7 +4298,7 @@ void TNodeJsFtrSpace::extractSparseMatrix(const v8::FunctionCallbackInfo<v8::Val
         EAssertR(JsFtrSpace->FtrSpace->IsStartStore(RecSet->RecSet->GetStore()->GetStoreId()),
             "FeatureSpace.extractSparseMatrix: record's and feature extractor's store/source must be the same!");
 
-        JsFtrSpace->FtrSpace->GetSpVV(RecSet->RecSet, SpMat, FtrExtN);
+        JsFtrSpace->FtrSpace->GetSpVV(RecSet->RecSet, SpMat, FtrExtN, Threads);
     } else if (TNodeJsUtil::IsArgJson(Args, 0)) {
         PJsonVal Json = TNodeJsUtil::GetArgJson(Args, 0);
         EAssertR(Json->IsArr(), "FeatureSpace.extractSparseMatrix: expected record set or a JSON array");
@@ -4178,7 +4321,7 @@ void TNodeJsFtrSpace::extractMatrix(const v8::FunctionCallbackInfo<v8::Value>& A
     v8::Isolate* Isolate = v8::Isolate::GetCurrent();
     v8::HandleScope HandleScope(Isolate);
 
-    QmAssertR(Args.Length() == 1 || Args.Length() == 2, "Should have 1  or 2 arguments!");
+    QmAssertR(1 <= Args.Length() && Args.Length() <= 3, "Should have 1, 2 or 3 arguments!");
 
     TFltVV Mat;
 
@@ -4192,6 +4335,7 @@ void TNodeJsFtrSpace::extractMatrix(const v8::FunctionCallbackInfo<v8::Value>& A
 
     const int FtrExtN = TNodeJsUtil::GetArgInt32(Args, 1, -1);
     EAssertR(-1 <= FtrExtN && FtrExtN < JsFtrSpace->FtrSpace->GetFtrExts(), "FeatureSpace.extractMatrix: invalid feature extractor ID!");
+    const int Threads = TNodeJsUtil::GetArgInt32(Args, 2, 1);
 
     if (TNodeJsUtil::IsArgWrapObj<TNodeJsRecSet>(Args, 0)) {
         TNodeJsRecSet* RecSet = TNodeJsUtil::UnwrapCheckWatcher<TNodeJsRecSet>(Args[0]->ToObject());
@@ -4199,7 +4343,7 @@ void TNodeJsFtrSpace::extractMatrix(const v8::FunctionCallbackInfo<v8::Value>& A
         EAssertR(JsFtrSpace->FtrSpace->IsStartStore(RecSet->RecSet->GetStore()->GetStoreId()),
             "FeatureSpace.extractMatrix: record's and feature extractor's store/source must be the same!");
 
-        JsFtrSpace->FtrSpace->GetFullVV(RecSet->RecSet, Mat, FtrExtN);
+        JsFtrSpace->FtrSpace->GetFullVV(RecSet->RecSet, Mat, FtrExtN, Threads);
     }
     else if (TNodeJsUtil::IsArgJson(Args, 0)) {
         PJsonVal Json = TNodeJsUtil::GetArgJson(Args, 0);
@@ -591,11 +591,35 @@ private:
     JsDeclareFunction(partialFlush);
 
     /**
-    * Retrieves performance statistics for qminer.
+    * Retrieves performance statistics for qminer. When enabled with {@link module:qm.Base#setStreamAggrStats},
+    * the `streamAggrs` property holds latency statistics of stream aggregates for each store.
     */
     //# exports.Base.prototype.getStats = function () { }
     JsDeclareFunction(getStats);
 
+    /**
+    * Enables or disables measuring latency of stream aggregates. When enabled, each call to each
+    * aggregate is timed and counted, with latency percentiles available through {@link module:qm.Base#getStats}
+    * and {@link module:qm.Store#getStreamAggrStats}. Enabling starts with empty statistics. Disabled by default.
+    * @param {boolean} enable - Measure latency of stream aggregates.
+    * @example
+    * var qm = require('qminer');
+    * var base = new qm.Base({
+    *    mode: 'createClean',
+    *    schema: [{ name: 'Ticks', fields: [{ name: 'Value', type: 'float' }, { name: 'Time', type: 'datetime' }] }]
+    * });
+    * var store = base.store('Ticks');
+    * store.addStreamAggr({ name: 'tick', type: 'timeSeriesTick', store: 'Ticks', timestamp: 'Time', value: 'Value' });
+    * base.setStreamAggrStats(true);
+    * store.push({ Value: 1, Time: '2015-06-10T14:13:32.0' });
+    * // latency percentiles of the tick aggregate, in milliseconds
+    * var tickStats = base.getStats().streamAggrs[0].aggregates[0].onAddRec;
+    * console.log(tickStats.p99MSecs);
+    * base.close();
+    */
+    //# exports.Base.prototype.setStreamAggrStats = function (enable) { }
+    JsDeclareFunction(setStreamAggrStats);
+
     /**
     * Gets the stream aggregate of the given name.
     * @param {string} saName - The name of the stream aggregate.
@@ -610,6 +634,98 @@ private:
     */
     //# exports.Base.prototype.getStreamAggrNames = function () { return [""]; }
     JsDeclareFunction(getStreamAggrNames);  
+
+    /**
+    * Updates stream aggregates with records still waiting in batches (see {@link module:qm.Store#setStreamAggrBatchSize}).
+    * Call it before reading stream aggregates when batching is enabled.
+    */
+    //# exports.Base.prototype.flushStreamAggrs = function () { }
+    JsDeclareFunction(flushStreamAggrs);
+
+    /**
+    * Saves states of stream aggregates to an incremental snapshot. The snapshot is a folder
+    * with one chunk file for each aggregate. When saving again to the same folder, only aggregates
+    * updated since the previous save are written, the other chunks are kept.
+    * @param {string} path - Folder of the snapshot.
+    * @param {Array.<string>} [names] - Names of the aggregates to save. The snapshot keeps only these.
+    * Defaults to the aggregates from the previous save to the same folder.
+    * @returns {Object} Object with `generation` (number of saves), `written` and `reused` (names of the
+    * aggregates written and kept from the previous save) and `bytes` (size of the written state).
+    * @example
+    * var qm = require('qminer');
+    * var base = new qm.Base({
+    *    mode: 'createClean',
+    *    schema: [{ name: 'Ticks', fields: [{ name: 'Value', type: 'float' }, { name: 'Time', type: 'datetime' }] }]
+    * });
+    * var store = base.store('Ticks');
+    * store.addStreamAggr({ name: 'tick', type: 'timeSeriesTick', store: 'Ticks', timestamp: 'Time', value: 'Value' });
+    * store.addStreamAggr({ name: 'window', type: 'timeSeriesWinBuf', store: 'Ticks', timestamp: 'Time', value: 'Value', winsize: 2000 });
+    * store.push({ Value: 1, Time: '2015-06-10T14:13:32.0' });
+    * base.saveStreamAggrState('./snapshot', ['tick', 'window']);
+    * // later saves only write aggregates which changed
+    * base.saveStreamAggrState('./snapshot');
+    * base.close();
+    */
+    //# exports.Base.prototype.saveStreamAggrState = function (path, names) { return {}; }
+    JsDeclareFunction(saveStreamAggrState);
+
+    /**
+    * Loads states of stream aggregates from a snapshot created with {@link module:qm.Base#saveStreamAggrState}.
+    * Aggregates must already exist in the base and have the same type as when saved, aggregates
+    * from the snapshot which are not in the base are skipped.
+    * @param {string} path - Folder of the snapshot.
+    * @param {boolean} [mmap=true] - Map chunk files into memory instead of reading them.
+    * @returns {Object} Object with `generation` of the snapshot, `loaded` and `skipped` (names of the aggregates).
+    */
+    //# exports.Base.prototype.loadStreamAggrState = function (path, mmap) { return {}; }
+    JsDeclareFunction(loadStreamAggrState);
+
+    /**
+    * Creates a materialized view: named result of a query, kept up to date as records are
+    * added, updated or deleted. Views are saved together with the base.
+    * @param {string} name - The name of the view.
+    * @param {module:qm~QueryObject} query - query language JSON object.
+    * @returns {module:qm.RecordSet} The records currently matching the query.
+    * @example
+    * // import qm module
+    * var qm = require('qminer');
+    * // create a base with a store of people
+    * var base = new qm.Base({
+    *    mode: "createClean",
+    *    schema: [{ name: "People", fields: [{ name: "Name", type: "string" }, { name: "Gender", type: "string" }],
+    *       keys: [{ field: "Gender", type: "value" }] }]
+    * });
+    * // create a view with all the women
+    * base.createView("women", { $from: "People", Gender: "Female" });
+    * base.store("People").push({ Name: "Jane", Gender: "Female" });
+    * // the view already contains the new record
+    * var women = base.view("women"); // women.length === 1
+    * base.close();
+    */
+    //# exports.Base.prototype.createView = function (name, query) { return Object.create(require('qminer').RecordSet.prototype); }
+    JsDeclareFunction(createView);
+
+    /**
+    * Gets the current content of the materialized view.
+    * @param {string} name - The name of the view.
+    * @returns {(module:qm.RecordSet | null)} The records matching the view query. If the view does not exist, it returns null.
+    */
+    //# exports.Base.prototype.view = function (name) { return Object.create(require('qminer').RecordSet.prototype); }
+    JsDeclareFunction(view);
+
+    /**
+    * Deletes the materialized view.
+    * @param {string} name - The name of the view.
+    */
+    //# exports.Base.prototype.deleteView = function (name) { }
+    JsDeclareFunction(deleteView);
+
+    /**
+    * Gets an array of the materialized view names in the base.
+    * @returns {Array.<string>} The array containing the view names.
+    */
+    //# exports.Base.prototype.getViewNames = function () { return [""]; }
+    JsDeclareFunction(getViewNames);
     //!JSIMPLEMENT:src/qminer/qminer.js    
 };
 
@@ -1077,6 +1193,58 @@ private:
     */		
     //# exports.Store.prototype.getStreamAggrNames = function () { return [""]; }		
     JsDeclareFunction(getStreamAggrNames);		
+
+    /**
+    * Sets the number of records collected before the stream aggregates of the store are updated.
+    * Batches amortize per-record overhead when all the aggregates can process them in one step;
+    * otherwise records are still passed one by one. Aggregates do not see records waiting in the
+    * current batch until it is full or {@link module:qm.Base#flushStreamAggrs} is called.
+    * @param {number} batchSize - Number of records in a batch, 1 disables batching.
+    * @example
+    * // import qm module
+    * var qm = require('qminer');
+    * // create a base with a time series store
+    * var base = new qm.Base({
+    *    mode: "createClean",
+    *    schema: [{
+    *        name: "Ticks",
+    *        fields: [{ name: "Time", type: "datetime" }, { name: "Value", type: "float" }]
+    *    }]
+    * });
+    * var store = base.store("Ticks");
+    * store.addStreamAggr({ name: "buffer", type: "timeSeriesWinBuf", store: "Ticks", timestamp: "Time", value: "Value", winsize: 60000 });
+    * store.addStreamAggr({ name: "sum", type: "winBufSum", inAggr: "buffer" });
+    * // update aggregates every 100 records
+    * store.setStreamAggrBatchSize(100);
+    * // ... push records, then make sure all of them reached the aggregates
+    * base.flushStreamAggrs();
+    * base.close();
+    */
+    //# exports.Store.prototype.setStreamAggrBatchSize = function (batchSize) { }
+    JsDeclareFunction(setStreamAggrBatchSize);
+
+    /**
+    * Sets the number of threads used to update the stream aggregates of the store. With more than one
+    * thread, aggregates are ordered by their input aggregates and independent ones (e.g. separate
+    * window buffer and moving average chains) are updated in parallel. Results are the same as with
+    * serial updates. Aggregates which are not thread-safe (e.g. JavaScript aggregates) are always
+    * updated serially, and stores which keep records in a disk cache disable parallel updates.
+    * @param {number} threads - Number of threads, 1 for serial updates in the order aggregates were added.
+    */
+    //# exports.Store.prototype.setStreamAggrThreads = function (threads) { }
+    JsDeclareFunction(setStreamAggrThreads);
+
+    /**
+    * Returns time spent in each stream aggregate connected to the store, measured while
+    * enabled with {@link module:qm.Base#setStreamAggrStats}.
+    * @returns {Array.<Object>} Array with one object per aggregate, containing its `name`, `type`, total number
+    * of `calls` and `totalMSecs` time spent in the calls. For each kind of call the aggregate received (`onAddRec`,
+    * `onAddRecs`, `onUpdateRec`, `onDeleteRec`, `onTime`, `onStep`), there is an object with number of `calls`,
+    * `totalMSecs`, `avgMSecs`, `maxMSecs`, latency percentiles `p50MSecs`, `p90MSecs`, `p99MSecs`, `p999MSecs`
+    * and `callsPerSec` throughput.
+    */
+    //# exports.Store.prototype.getStreamAggrStats = function () { return [{}]; }
+    JsDeclareFunction(getStreamAggrStats);
 		
    /**
     * Returns the store as a JSON.
@@ -2488,6 +2656,8 @@ public:
     ~TJsRecFilter() { Callback.Reset(); }
     /// Filter function
     bool Filter(const TQm::TRec& Rec) const;
+    /// Callback can only be called from the main thread
+    bool IsThreadSafe() const { return false; }
 };
 
 ///////////////////////////////
@@ -2582,6 +2752,8 @@ public:
     void InvFullV(const TFltV& FullV, int& Offset, TFltV& InvV) const {
         throw TExcept::New("Not implemented yet!", "TJsFuncFtrExt::InvFullV"); }
     double GetVal(const double& InVal) const { throw TExcept::New("Not implemented!"); }
+    // callback can only be called from the main thread
+    bool PrepConcurrentRead() const { return false; }
 
     // flat feature extraction
     void ExtractFltV(const TQm::TRec& FtrRec, TFltV& FltV) const;
@@ -3343,6 +3515,8 @@ public:
     * Extracts the sparse feature vectors from the record set and returns them as columns of the sparse matrix.
     * @param {module:qm.RecordSet} rs - The given record set.
     * @param {number} [featureExtractorId] - when given, only use specified feature extractor
+    * @param {number} [threads=1] - number of threads used for extraction. Falls back to one thread when the store
+    * keeps fields in disk cache or when feature extractors cannot run in parallel (e.g. text, random, jsfunc).
     * @returns {module:la.SparseMatrix} The sparse matrix, where the i-th column is the sparse feature vector of the i-th record in rs.
     * @example
     * // import qm module
@@ -3371,14 +3545,15 @@ public:
     * var sparseMatrix = ftr.extractSparseMatrix(base.store("Class").allRecords);
     * base.close();
     */
-    //# exports.FeatureSpace.prototype.extractSparseMatrix = function (rs) { return Object.create(require('qminer').la.SparseMatrix.prototype); };
+    //# exports.FeatureSpace.prototype.extractSparseMatrix = function (rs, featureExtractorId, threads) { return Object.create(require('qminer').la.SparseMatrix.prototype); };
     JsDeclareFunction(extractSparseMatrix);
 
     /**
     * Extracts the feature vectors from the recordset and returns them as columns of a dense matrix.
     * @param {module:qm.RecordSet} rs - The given record set.
     * @param {number} [featureExtractorId] - when given, only use specified feature extractor.
-
+    * @param {number} [threads=1] - number of threads used for extraction. Falls back to one thread when the store
+    * keeps fields in disk cache or when feature extractors cannot run in parallel (e.g. text, random, jsfunc).
     * @returns {module:la.Matrix} The dense matrix, where the i-th column is the feature vector of the i-th record in rs.
     * @example
     * // import qm module
@@ -3410,7 +3585,7 @@ public:
     * var matrix = ftr.extractMatrix(base.store("Class").allRecords);
     * base.close();
     */
-    //# exports.FeatureSpace.prototype.extractMatrix = function (rs) { return Object.create(require('qminer').la.Matrix.prototype); };
+    //# exports.FeatureSpace.prototype.extractMatrix = function (rs, featureExtractorId, threads) { return Object.create(require('qminer').la.Matrix.prototype); };
     JsDeclareFunction(extractMatrix);
 
     JsDeclareAsyncFunction(extractMatrixAsync, TExtractMatrixTask);
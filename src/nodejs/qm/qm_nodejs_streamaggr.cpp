@@ -64,6 +64,11 @@ void TNodeJsStreamAggr::Init(v8::Handle<v8::Object> exports) {
     
     NODE_SET_PROTOTYPE_METHOD(tpl, "getFeatureSpace", _getFeatureSpace);
 
+    NODE_SET_PROTOTYPE_METHOD(tpl, "getKeys", _getKeys);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "getKeyFloat", _getKeyFloat);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "getKeyFloatVector", _getKeyFloatVector);
+    NODE_SET_PROTOTYPE_METHOD(tpl, "getKeyTimestamp", _getKeyTimestamp);
+
     // Properties
     tpl->InstanceTemplate()->SetAccessor(v8::String::NewFromUtf8(Isolate, "name"), _name);
     tpl->InstanceTemplate()->SetAccessor(v8::String::NewFromUtf8(Isolate, "val"), _val);
@@ -160,6 +165,7 @@ void TNodeJsStreamAggr::reset(const v8::FunctionCallbackInfo<v8::Value>& Args) {
 
     // unwrap
     TNodeJsStreamAggr* JsSA = ObjectWrap::Unwrap<TNodeJsStreamAggr>(Args.Holder());
+    JsSA->SA->SetUpdated();
     JsSA->SA->Reset();
 
     Args.GetReturnValue().Set(Args.Holder());
@@ -173,6 +179,7 @@ void TNodeJsStreamAggr::onTime(const v8::FunctionCallbackInfo<v8::Value>& Args)
     TNodeJsStreamAggr* JsSA = ObjectWrap::Unwrap<TNodeJsStreamAggr>(Args.Holder());
     QmAssertR(Args.Length() == 1 && Args[0]->IsNumber(), "sa.onTime should take one argument of type TUInt64");
     const uint64 Time = TNodeJsUtil::GetArgTmMSecs(Args, 0);
+    JsSA->SA->SetUpdated();
     JsSA->SA->OnTime(Time);
 
     Args.GetReturnValue().Set(Args.Holder());
@@ -187,6 +194,7 @@ void TNodeJsStreamAggr::onAdd(const v8::FunctionCallbackInfo<v8::Value>& Args) {
 
     QmAssertR(Args.Length() == 1 && Args[0]->IsObject(), "sa.onAdd should take one argument of type TNodeJsRec");
     TNodeJsRec* JsRec = TNodeJsUtil::UnwrapCheckWatcher<TNodeJsRec>(Args[0]->ToObject());
+    JsSA->SA->SetUpdated();
     JsSA->SA->OnAddRec(JsRec->Rec);
 
     Args.GetReturnValue().Set(Args.Holder());
@@ -200,6 +208,7 @@ void TNodeJsStreamAggr::onUpdate(const v8::FunctionCallbackInfo<v8::Value>& Args
     TNodeJsStreamAggr* JsSA = ObjectWrap::Unwrap<TNodeJsStreamAggr>(Args.Holder());
     QmAssertR(Args.Length() == 1 && Args[0]->IsObject(), "sa.onUpdate should take one argument of type TNodeJsRec");
     TNodeJsRec* JsRec = TNodeJsUtil::UnwrapCheckWatcher<TNodeJsRec>(Args[0]->ToObject());
+    JsSA->SA->SetUpdated();
     JsSA->SA->OnUpdateRec(JsRec->Rec);
 
     Args.GetReturnValue().Set(Args.Holder());
@@ -213,6 +222,7 @@ void TNodeJsStreamAggr::onDelete(const v8::FunctionCallbackInfo<v8::Value>& Args
     TNodeJsStreamAggr* JsSA = ObjectWrap::Unwrap<TNodeJsStreamAggr>(Args.Holder());
     QmAssertR(Args.Length() == 1 && Args[0]->IsObject(), "sa.onDelete should take one argument of type TNodeJsRec");
     TNodeJsRec* JsRec = TNodeJsUtil::UnwrapCheckWatcher<TNodeJsRec>(Args[0]->ToObject());
+    JsSA->SA->SetUpdated();
     JsSA->SA->OnDeleteRec(JsRec->Rec);
 
     Args.GetReturnValue().Set(Args.Holder());
@@ -254,6 +264,7 @@ void TNodeJsStreamAggr::load(const v8::FunctionCallbackInfo<v8::Value>& Args) {
     TNodeJsFIn* JsFIn = TNodeJsUtil::GetArgUnwrapObj<TNodeJsFIn>(Args, 0);
 
     // save
+    JsSA->SA->SetUpdated();
     JsSA->SA->LoadState(*JsFIn->SIn);
 
     Args.GetReturnValue().Set(Args.Holder());
@@ -601,6 +612,69 @@ void TNodeJsStreamAggr::getValueVector(const v8::FunctionCallbackInfo<v8::Value>
     }
 }
 
+void TNodeJsStreamAggr::getKeys(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+    v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope HandleScope(Isolate);
+
+    // unwrap
+    TNodeJsStreamAggr* JsSA = ObjectWrap::Unwrap<TNodeJsStreamAggr>(Args.Holder());
+    // try to cast as IKeyed
+    TWPt<TQm::TStreamAggrOut::IKeyed> Aggr = dynamic_cast<TQm::TStreamAggrOut::IKeyed*>(JsSA->SA());
+    if (Aggr.Empty()) {
+        throw TQm::TQmExcept::New("TNodeJsStreamAggr::getKeys : stream aggregate does not implement IKeyed: " + JsSA->SA->GetAggrNm());
+    }
+    TStrV KeyV;
+    Aggr->GetKeyV(KeyV);
+    Args.GetReturnValue().Set(TNodeJsUtil::GetStrArr(KeyV));
+}
+
+void TNodeJsStreamAggr::getKeyFloat(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+    v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope HandleScope(Isolate);
+
+    // unwrap
+    TNodeJsStreamAggr* JsSA = ObjectWrap::Unwrap<TNodeJsStreamAggr>(Args.Holder());
+    const TStr Key = TNodeJsUtil::GetArgStr(Args, 0);
+    // try to cast as IKeyed
+    TWPt<TQm::TStreamAggrOut::IKeyed> Aggr = dynamic_cast<TQm::TStreamAggrOut::IKeyed*>(JsSA->SA());
+    if (Aggr.Empty()) {
+        throw TQm::TQmExcept::New("TNodeJsStreamAggr::getKeyFloat : stream aggregate does not implement IKeyed: " + JsSA->SA->GetAggrNm());
+    }
+    Args.GetReturnValue().Set(v8::Number::New(Isolate, Aggr->GetKeyFlt(Key)));
+}
+
+void TNodeJsStreamAggr::getKeyFloatVector(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+    v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope HandleScope(Isolate);
+
+    // unwrap
+    TNodeJsStreamAggr* JsSA = ObjectWrap::Unwrap<TNodeJsStreamAggr>(Args.Holder());
+    const TStr Key = TNodeJsUtil::GetArgStr(Args, 0);
+    // try to cast as IKeyed
+    TWPt<TQm::TStreamAggrOut::IKeyed> Aggr = dynamic_cast<TQm::TStreamAggrOut::IKeyed*>(JsSA->SA());
+    if (Aggr.Empty()) {
+        throw TQm::TQmExcept::New("TNodeJsStreamAggr::getKeyFloatVector : stream aggregate does not implement IKeyed: " + JsSA->SA->GetAggrNm());
+    }
+    TFltV Res;
+    Aggr->GetKeyFltV(Key, Res);
+    Args.GetReturnValue().Set(TNodeJsVec<TFlt, TAuxFltV>::New(Res));
+}
+
+void TNodeJsStreamAggr::getKeyTimestamp(const v8::FunctionCallbackInfo<v8::Value>& Args) {
+    v8::Isolate* Isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope HandleScope(Isolate);
+
+    // unwrap
+    TNodeJsStreamAggr* JsSA = ObjectWrap::Unwrap<TNodeJsStreamAggr>(Args.Holder());
+    const TStr Key = TNodeJsUtil::GetArgStr(Args, 0);
+    // try to cast as IKeyed
+    TWPt<TQm::TStreamAggrOut::IKeyed> Aggr = dynamic_cast<TQm::TStreamAggrOut::IKeyed*>(JsSA->SA());
+    if (Aggr.Empty()) {
+        throw TQm::TQmExcept::New("TNodeJsStreamAggr::getKeyTimestamp : stream aggregate does not implement IKeyed: " + JsSA->SA->GetAggrNm());
+    }
+    Args.GetReturnValue().Set(v8::Number::New(Isolate, (double)Aggr->GetKeyTmMSecs(Key)));
+}
+
 void TNodeJsStreamAggr::name(v8::Local<v8::String> Name, const v8::PropertyCallbackInfo<v8::Value>& Info) {
     v8::Isolate* Isolate = v8::Isolate::GetCurrent();
     v8::HandleScope HandleScope(Isolate);
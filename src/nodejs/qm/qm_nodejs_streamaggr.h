@@ -91,6 +91,8 @@
 * @property {module:qm~StreamAggregateMovingCorrelation} cor - The moving correlation type.
 * @property {module:qm~StreamAggregateResampler} res - The resampler type.
 * @property {module:qm~StreamAggregateMerger} mer - The merger type.
+* @property {module:qm~StreamAggregateReorderBuffer} reorderBuffer - The reorder buffer type.
+* @property {module:qm~StreamAggregateKeyed} keyed - The keyed (per-key state) type.
 * @property {module:qm~StreamAggregateHistogram} hist - The online histogram type.
 * @property {module:qm~StreamAggregateSlottedHistogram} slotted-hist - The online slotted-histogram type.
 * @property {module:qm~StreamAggregateVecDiff} vec-diff - The difference of two vectors (e.g. online histograms) type.
@@ -108,6 +110,8 @@
 * @property {string} StreamAggregateTimeSeriesWindow.value - The field of the store, where it takes the values.
 * @property {number} StreamAggregateTimeSeriesWindow.winsize - The size of the window, in milliseconds.
 * @property {number} StreamAggregateTimeSeriesWindow.delay - Delay in milliseconds.
+* @property {boolean} [StreamAggregateTimeSeriesWindow.cache=false] - Keep timestamps and values of the records in the window in memory.
+* Records are then read from the store only once, and can be removed from the store (e.g. by the store window) before they leave the buffer.
 * @example 
 * // import the qm module
 * var qm = require('qminer');
@@ -914,6 +918,8 @@
 * <br> The 'previous' type interpolates with the previous value.
 * @property {boolean} StreamAggregateResampler.createStore - If the outStore must be created.
 * @property {number} StreamAggregateResampler.interval - The size/frequency the interpolated values should be given.
+* @property {boolean} [StreamAggregateResampler.columnar=false] - Interpolate all fields together, for all the output records
+* between two input records at once. Supports 'previous', 'linear' and 'current' interpolators. The output is the same as without it.
 * @example
 * // import the qm module
 * var qm = require('qminer');
@@ -959,7 +965,8 @@
 /**
 * @typedef {module:qm.StreamAggr} StreamAggregateMerger
 * This stream aggregator represents the merger aggregator. It merges records from two or more stores into a new store
-* depending on the timestamp. No methods are implemented for this aggregator.
+* depending on the timestamp. No methods are implemented for this aggregator. Method {@link module:qm.StreamAggr#saveJson}
+* returns `lag`, an object with the number of milliseconds each input (by `outField`) is behind the newest merged record.
 * <image src="pictures/merger.gif" alt="Merger Animation">
 * @property {string} StreamAggregateMerger.name - The given name for the stream aggregator.
 * @property {string} StreamAggregateMerger.type - The type of the stream aggregator. It must be equal to <b>'merger'</b>.
@@ -972,6 +979,9 @@
 * <br> outField (string) - The field name of outStore, into which it saves the values.
 * <br> interpolation (string) - The type of the interpolation. The options are: 'previous', 'next' and 'linear'.
 * <br> timestamp (string) - The field name of source, where the timestamp is saved. 
+* @property {number} [StreamAggregateMerger.allowedLateness] - When given, input records are reordered by timestamp
+* before merging. Records can arrive at most `allowedLateness` milliseconds after a newer record, later records are ignored.
+* @property {number} [StreamAggregateMerger.maxPending] - Maximal number of records waiting for reordering. Used together with `allowedLateness`.
 * @example
 * // import the qm module
 * var qm = require('qminer');
@@ -1019,6 +1029,70 @@
 * base.close();
 */
 
+/**
+* @typedef {module:qm.StreamAggr} StreamAggregateReorderBuffer
+* This stream aggregator copies records arriving out of order to another store, sorted by timestamp.
+* A record is copied once the watermark, the newest timestamp seen minus the allowed lateness, passes it.
+* Aggregates attached to the output store, such as time series windows, therefore see an ordered stream.
+* Records older than the watermark are late: they are ignored or copied immediately, depending on `lateRecords`.
+* Fields with the same name in both stores are copied.
+* @property {string} StreamAggregateReorderBuffer.name - The given name for the stream aggregator.
+* @property {string} StreamAggregateReorderBuffer.type - The type of the stream aggregator. It must be equal to <b>'reorderBuffer'</b>.
+* @property {string} StreamAggregateReorderBuffer.store - The name of the store from which it takes the records.
+* @property {string} StreamAggregateReorderBuffer.outStore - The name of the store where it saves the sorted records.
+* @property {string} StreamAggregateReorderBuffer.timestamp - The store field from which it takes the timestamps.
+* @property {number} [StreamAggregateReorderBuffer.allowedLateness=0] - How many milliseconds a record can be late.
+* @property {number} [StreamAggregateReorderBuffer.maxPending] - Maximal number of waiting records. When full, the oldest record is copied.
+* @property {string} [StreamAggregateReorderBuffer.lateRecords='drop'] - What to do with late records: 'drop' or 'forward'.
+* @example
+* // import the qm module
+* var qm = require('qminer');
+* // create a base with an input and a sorted store
+* var base = new qm.Base({
+*    mode: "createClean",
+*    schema: [
+*    { name: "Readings", fields: [{ name: "Value", type: "float" }, { name: "Time", type: "datetime" }] },
+*    { name: "Sorted", fields: [{ name: "Value", type: "float" }, { name: "Time", type: "datetime" }] }
+*    ]
+* });
+* // records can arrive up to 5 seconds out of order
+* var reorder = base.store("Readings").addStreamAggr({
+*    name: 'reorder',
+*    type: 'reorderBuffer',
+*    store: 'Readings',
+*    outStore: 'Sorted',
+*    timestamp: 'Time',
+*    allowedLateness: 5000
+* });
+* base.store("Readings").push({ Value: 2, Time: '2015-06-10T14:13:34.000' });
+* base.store("Readings").push({ Value: 1, Time: '2015-06-10T14:13:32.000' });
+* base.store("Readings").push({ Value: 3, Time: '2015-06-10T14:13:40.000' });
+* // base.store("Sorted") now holds the first two records, sorted by time
+* base.close();
+*/
+
+/**
+* @typedef {module:qm.StreamAggr} StreamAggregateKeyed
+* This stream aggregator keeps a separate statistic for each value of the key field, e.g. a moving average
+* for each device. It uses far less memory than an aggregator per key. Values are read with
+* {@link module:qm.StreamAggr#getKeys}, {@link module:qm.StreamAggr#getKeyFloat},
+* {@link module:qm.StreamAggr#getKeyFloatVector} and {@link module:qm.StreamAggr#getKeyTimestamp}.
+* @property {string} StreamAggregateKeyed.name - The given name for the stream aggregator.
+* @property {string} StreamAggregateKeyed.type - The type of the stream aggregator. It must be equal to <b>'keyed'</b>.
+* @property {string} StreamAggregateKeyed.store - The name of the store from which it takes the data.
+* @property {string} StreamAggregateKeyed.key - The store field with the key.
+* @property {string} StreamAggregateKeyed.timestamp - The store field with the timestamp.
+* @property {string} StreamAggregateKeyed.value - The store field with the value.
+* @property {string} StreamAggregateKeyed.aggr - The statistic kept for each key: 'winBuf' (values in the window),
+* 'sum', 'ma', 'var', 'min', 'max', 'ema', 'tdigest' or 'histogram'. Parameters of 'ema', 'tdigest' and 'histogram'
+* are the same as for the standalone stream aggregators.
+* @property {number} [StreamAggregateKeyed.winsize] - The size of the window in milliseconds. Required for 'winBuf',
+* 'sum', 'ma', 'var', 'min' and 'max', optional for 'histogram'. Windows move with the records of their key.
+* @property {number} [StreamAggregateKeyed.idleTimeout] - Keys without records for this many milliseconds are removed.
+* @example
+* // look at the example for getKeys
+*/
+
 /**
 * @typedef {module:qm.StreamAggr} StreamAggregateHistogram
 * This stream aggregator represents an online histogram. It can connect to a buffered aggregate (such as {@link module:qm~StreamAggregateTimeSeriesWindow})
@@ -2000,6 +2074,74 @@ public:
     //# exports.StreamAggr.prototype.getFeatureSpace = function() { return Object.create(require('qminer').FeatureSpace.prototype); };
     JsDeclareFunction(getFeatureSpace);
 
+    /**
+    * Returns the keys of a keyed stream aggregator. See {@link module:qm~StreamAggregateKeyed}.
+    * @returns {Array.<string>} Keys with state in the aggregator.
+    * @example
+    * // import qm module
+    * var qm = require('qminer');
+    * // create a simple base containing one store
+    * var base = new qm.Base({
+    *    mode: 'createClean',
+    *    schema: [{
+    *        name: 'Readings',
+    *        fields: [
+    *            { name: 'Device', type: 'string' },
+    *            { name: 'Value', type: 'float' },
+    *            { name: 'Time', type: 'datetime' }
+    *        ]
+    *    }]
+    * });
+    * // moving average over the last minute for each device
+    * var keyed = base.store('Readings').addStreamAggr({
+    *    type: 'keyed',
+    *    store: 'Readings',
+    *    key: 'Device',
+    *    timestamp: 'Time',
+    *    value: 'Value',
+    *    aggr: 'ma',
+    *    winsize: 60000
+    * });
+    * base.store('Readings').push({ Device: 'a', Value: 1, Time: '2015-06-10T14:13:32.0' });
+    * base.store('Readings').push({ Device: 'b', Value: 5, Time: '2015-06-10T14:13:33.0' });
+    * base.store('Readings').push({ Device: 'a', Value: 3, Time: '2015-06-10T14:13:34.0' });
+    * var keys = keyed.getKeys(); // returns ['a', 'b']
+    * var avgA = keyed.getKeyFloat('a'); // returns 2
+    * base.close();
+    */
+    //# exports.StreamAggr.prototype.getKeys = function () { return [""]; };
+    JsDeclareFunction(getKeys);
+
+    /**
+    * Returns the value of the key's statistic in a keyed stream aggregator.
+    * @param {string} key - The key.
+    * @returns {number} The value for the key.
+    * @example
+    * // look at the example for getKeys
+    */
+    //# exports.StreamAggr.prototype.getKeyFloat = function (key) { return 0; };
+    JsDeclareFunction(getKeyFloat);
+
+    /**
+    * Returns window values, quantiles or histogram counts of the key in a keyed stream aggregator.
+    * @param {string} key - The key.
+    * @returns {module:la.Vector} The values for the key.
+    * @example
+    * // look at the example for getKeys
+    */
+    //# exports.StreamAggr.prototype.getKeyFloatVector = function (key) { return Object.create(require('qminer').la.Vector.prototype); };
+    JsDeclareFunction(getKeyFloatVector);
+
+    /**
+    * Returns the timestamp of the key's last record in a keyed stream aggregator.
+    * @param {string} key - The key.
+    * @returns {number} The timestamp of the key's last record.
+    * @example
+    * // look at the example for getKeys
+    */
+    //# exports.StreamAggr.prototype.getKeyTimestamp = function (key) { return 0; };
+    JsDeclareFunction(getKeyTimestamp);
+
     /**
     * Returns the name of the stream aggregate.
     */
@@ -16,32 +16,191 @@
 namespace TQm {
 
 namespace TAggrs {
-    
+
+///////////////////////////////
+// QMiner-Aggregator-Fused
+TFusedAggr::TFusedAggr(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const TJoinSeq& _JoinSeq, const int& _FieldId, const TStr& _FieldNm):
+            TAggr(Base, AggrNm), JoinSeq(_JoinSeq), FieldId(_FieldId), FieldNm(_FieldNm) {
+
+    // prepare join path string, if necessary
+    JoinPathStr = JoinSeq.GetJoinPathStr(Base);
+}
+
+void TFusedAggr::ParseJson(const TWPt<TBase>& Base, const uint& StoreId,
+        const PJsonVal& JsonVal, TJoinSeq& JoinSeq, int& FieldId) {
+
+    // parse join
+    JoinSeq = JsonVal->IsObjKey("join") ?
+        TJoinSeq(Base, StoreId, JsonVal->GetObjKey("join")) : TJoinSeq(StoreId);
+    // get the field
+    const TStr FieldNm = JsonVal->GetObjStr("field");
+    // assert if valid field
+    TWPt<TStore> Store = JoinSeq.GetEndStore(Base);
+    QmAssert(Store->IsFieldNm(FieldNm));
+    // get the field id
+    FieldId = Store->GetFieldId(FieldNm);
+}
+
+///////////////////////////////
+// QMiner-Aggregator-Fused-Executor
+int TFusedAggrExec::TCol::GetVals() const {
+    switch (ValType) {
+        case fvtStr: return StrV.Len();
+        case fvtFlt: return FltV.Len();
+        case fvtTm: return TmV.Len();
+    }
+    return 0;
+}
+
+TFusedAggrExec::TFusedAggrExec(const TWPt<TBase>& _Base, const PRecSet& _RecSet,
+    const int& _Threads, const int& _BatchSize): Base(_Base), RecSet(_RecSet),
+        Threads(TInt::GetMx(_Threads, 1)), BatchSize(TInt::GetMx(_BatchSize, 1)) { }
+
+int TFusedAggrExec::GetColN(const TJoinSeq& JoinSeq, const int& FieldId, const TFusedValType& ValType) {
+    QmAssertR(JoinSeq.GetStartStoreId() == RecSet->GetStoreId(),
+        "[TFusedAggrExec] Aggregate join does not start in record set store");
+    // get join path index
+    const TIntPrV& JoinIdV = JoinSeq.GetJoinIdV();
+    if (!JoinIdVH.IsKey(JoinIdV)) { JoinIdVH.AddDat(JoinIdV, JoinIdVH.Len()); }
+    const int JoinN = JoinIdVH.GetDat(JoinIdV);
+    // check if we already read the field
+    for (int ColN = 0; ColN < ColV.Len(); ColN++) {
+        const TCol& Col = ColV[ColN];
+        if (Col.JoinN == JoinN && Col.FieldId == FieldId && Col.ValType == ValType) { return ColN; }
+    }
+    // new column
+    TWPt<TStore> Store = JoinSeq.GetEndStore(Base);
+    const TFieldDesc& FieldDesc = Store->GetFieldDesc(FieldId);
+    QmAssertR(ValType != fvtTm || FieldDesc.IsTm(), "[TFusedAggrExec] Expected TTm type, but found " + FieldDesc.GetFieldTypeStr());
+    ColV.Add(TCol(JoinN, FieldId, ValType, TFieldReader(Store->GetStoreId(), FieldId, FieldDesc)));
+    return ColV.Len() - 1;
+}
+
+void TFusedAggrExec::AddAggr(const PAggr& Aggr) {
+    TWPt<TFusedAggr> FusedAggr = dynamic_cast<TFusedAggr*>(Aggr());
+    QmAssertR(!FusedAggr.Empty(), "[TFusedAggrExec] Aggregate " + Aggr->GetAggrNm() + " cannot be fused");
+    AggrColNV.Add(GetColN(FusedAggr->GetJoinSeq(), FusedAggr->GetFieldId(), FusedAggr->GetValType()));
+    AggrV.Add(FusedAggr);
+}
+
+void TFusedAggrExec::ReadBatch(const int& MnRecN, const int& MxRecN) {
+    // forget previous batch
+    for (int ColN = 0; ColN < ColV.Len(); ColN++) { ColV[ColN].Clr(); }
+    // paths to join
+    TVec<TIntPrV> JoinIdVV; JoinIdVH.GetKeyV(JoinIdVV);
+    TVec<PRecSet> JoinRecSetV(JoinIdVV.Len());
+    for (int RecN = MnRecN; RecN < MxRecN; RecN++) {
+        const TRec Rec = RecSet->GetRec(RecN);
+        // execute each join path once per record
+        for (int JoinN = 0; JoinN < JoinIdVV.Len(); JoinN++) {
+            JoinRecSetV[JoinN] = JoinIdVV[JoinN].Empty() ?
+                PRecSet() : Rec.DoJoin(Base, JoinIdVV[JoinN]);
+        }
+        // read each column once per record
+        for (int ColN = 0; ColN < ColV.Len(); ColN++) {
+            TCol& Col = ColV[ColN];
+            const PRecSet& JoinRecSet = JoinRecSetV[Col.JoinN];
+            if (Col.ValType == fvtStr) {
+                // same as TMultinomial, all joined records are used
+                if (JoinRecSet.Empty()) { Col.Reader.GetStrV(Rec, Col.StrV); }
+                else { Col.Reader.GetStrV(JoinRecSet, Col.StrV); }
+            } else if (Col.ValType == fvtFlt) {
+                // same as TNumeric, only first joined record is used
+                if (JoinRecSet.Empty()) {
+                    Col.FltV.Add(Col.Reader.GetFlt(Rec));
+                } else if (!JoinRecSet->Empty()) {
+                    Col.FltV.Add(Col.Reader.GetFlt(JoinRecSet->GetRec(0)));
+                }
+            } else if (Col.ValType == fvtTm) {
+                if (JoinRecSet.Empty()) {
+                    TTm FieldTm; Rec.GetFieldTm(Col.FieldId, FieldTm);
+                    Col.TmV.Add(FieldTm);
+                } else {
+                    for (int JoinRecN = 0; JoinRecN < JoinRecSet->GetRecs(); JoinRecN++) {
+                        TTm FieldTm; JoinRecSet->GetRec(JoinRecN).GetFieldTm(Col.FieldId, FieldTm);
+                        Col.TmV.Add(FieldTm);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void TFusedAggrExec::FeedAggr(const TCol& Col, const int& MnValN, const int& MxValN, TFusedAggr& Aggr) {
+    if (Col.ValType == fvtStr) {
+        for (int ValN = MnValN; ValN < MxValN; ValN++) { Aggr.AddStr(Col.StrV[ValN]); }
+    } else if (Col.ValType == fvtFlt) {
+        for (int ValN = MnValN; ValN < MxValN; ValN++) { Aggr.AddFlt(Col.FltV[ValN]); }
+    } else if (Col.ValType == fvtTm) {
+        for (int ValN = MnValN; ValN < MxValN; ValN++) { Aggr.AddTm(Col.TmV[ValN]); }
+    }
+}
+
+void TFusedAggrExec::Exec() {
+    if (AggrV.Empty()) { return; }
+    // partial states for additional threads, first thread updates aggregates directly
+    TVec<TVec<PAggr> > ThreadAggrVV(Threads - 1);
+    for (int ThreadN = 1; ThreadN < Threads; ThreadN++) {
+        for (int AggrN = 0; AggrN < AggrV.Len(); AggrN++) {
+            ThreadAggrVV[ThreadN - 1].Add(AggrV[AggrN]->Clone());
+        }
+    }
+    // go over records in batches
+    const int Recs = RecSet->GetRecs();
+    for (int MnRecN = 0; MnRecN < Recs; MnRecN += BatchSize) {
+        const int MxRecN = TInt::GetMn(MnRecN + BatchSize, Recs);
+        // store access is not thread safe, so records are read by one thread ...
+        ReadBatch(MnRecN, MxRecN);
+        // ... and values are fed to aggregates in parallel, each thread takes
+        // its own share of each column
+        #pragma omp parallel for num_threads(Threads.Val) schedule(static, 1)
+        for (int ThreadN = 0; ThreadN < Threads; ThreadN++) {
+            for (int AggrN = 0; AggrN < AggrV.Len(); AggrN++) {
+                const TCol& Col = ColV[AggrColNV[AggrN]];
+                const int Vals = Col.GetVals();
+                const int MnValN = (int)((int64)Vals * ThreadN / Threads);
+                const int MxValN = (int)((int64)Vals * (ThreadN + 1) / Threads);
+                TFusedAggr& Aggr = (ThreadN == 0) ? *AggrV[AggrN] :
+                    *dynamic_cast<TFusedAggr*>(ThreadAggrVV[ThreadN - 1][AggrN]());
+                FeedAggr(Col, MnValN, MxValN, Aggr);
+            }
+        }
+    }
+    // merge partial states in thread order and finalize
+    for (int AggrN = 0; AggrN < AggrV.Len(); AggrN++) {
+        for (int ThreadN = 1; ThreadN < Threads; ThreadN++) {
+            AggrV[AggrN]->Merge(*dynamic_cast<TFusedAggr*>(ThreadAggrVV[ThreadN - 1][AggrN]()));
+        }
+        AggrV[AggrN]->Finish();
+    }
+}
+
 ///////////////////////////////
 // QMiner-Aggregator-Count
+TCount::TCount(const TWPt<TBase>& Base, const TStr& AggrNm, const TJoinSeq& JoinSeq,
+    const int& FieldId): TFusedAggr(Base, AggrNm, JoinSeq, FieldId, "Multinomial[" +
+        JoinSeq.GetEndStore(Base)->GetFieldNm(FieldId) + "]") { }
+
 TCount::TCount(const TWPt<TBase>& Base, const TStr& AggrNm,
-        const PRecSet& RecSet, const PFtrExt& FtrExt): TAggr(Base, AggrNm) {
+        const PRecSet& RecSet, const PFtrExt& FtrExt): 
+            TFusedAggr(Base, AggrNm, FtrExt->GetJoinSeq(RecSet->GetStoreId()), -1, FtrExt->GetNm()) {
 
-    // prepare join path string, if necessary
-    JoinPathStr = FtrExt->GetJoinSeq(RecSet->GetStoreId()).GetJoinPathStr(Base);
-    // prepare field name
-    FieldNm = FtrExt->GetNm();
     // prepare 
     const int Recs = RecSet->GetRecs();
     for (int RecN = 0; RecN < Recs; RecN++) {
         TStrV FtrValV; FtrExt->ExtractStrV(RecSet->GetRec(RecN), FtrValV);
         for (int FtrValN = 0; FtrValN < FtrValV.Len(); FtrValN++) {
-            ValH.AddDat(FtrValV[FtrValN])++; Count++;
+            AddStr(FtrValV[FtrValN]);
         }
     }
-    ValH.SortByDat(false);
+    Finish();
 }
 
 TCount::TCount(const TWPt<TBase>& Base, const TStr& AggrNm, 
-        const PRecSet& RecSet, const int& KeyId): TAggr(Base, AggrNm) {
+        const PRecSet& RecSet, const int& KeyId): TFusedAggr(Base, AggrNm,
+            TJoinSeq(RecSet->GetStoreId()), -1, Base->GetIndexVoc()->GetKeyNm(KeyId)) {
 
-    // prepare key name
-    FieldNm = Base->GetIndexVoc()->GetKeyNm(KeyId);
     // prepare counts
     TUInt64IntKdV ResV = RecSet->GetRecIdFqV();
     if (!ResV.IsSorted()) { ResV.Sort(); }
@@ -58,6 +217,8 @@ TCount::TCount(const TWPt<TBase>& Base, const TStr& AggrNm,
         ValH.AddDat(WordStr) = WordFq; Count += WordFq;
     }
     ValH.SortByDat(false);
+    // key counts have no join path
+    JoinPathStr = TStr();
 }
 
 PAggr TCount::New(const TWPt<TBase>& Base, const TStr& AggrNm,
@@ -73,23 +234,33 @@ PAggr TCount::New(const TWPt<TBase>& Base, const TStr& AggrNm,
         // forward the call
         return New(Base, AggrNm, RecSet, KeyId);
     } else {
-        // we aggregate over a field, first parse join
-        TJoinSeq JoinSeq = JsonVal->IsObjKey("join") ?
-            TJoinSeq(Base, RecSet->GetStoreId(), JsonVal->GetObjKey("join")) :
-            TJoinSeq(RecSet->GetStoreId());
-        // get the field
-        const TStr FieldNm = JsonVal->GetObjStr("field");
-        // assert if valid field
-        TWPt<TStore> Store = JoinSeq.GetEndStore(Base);
-        QmAssert(Store->IsFieldNm(FieldNm));
-        // get the field id
-        const int FieldId = Store->GetFieldId(FieldNm);
-        // prepare feature extractor
-        PFtrExt FtrExt = TFtrExts::TMultinomial::New(Base, JoinSeq, FieldId);
-        return New(Base, AggrNm, RecSet, FtrExt);
+        // we aggregate over a field
+        PAggr Aggr = NewFused(Base, AggrNm, RecSet->GetStoreId(), JsonVal);
+        TFusedAggrExec Exec(Base, RecSet); Exec.AddAggr(Aggr); Exec.Exec();
+        return Aggr;
     }
 }
 
+PAggr TCount::NewFused(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const uint& StoreId, const PJsonVal& JsonVal) {
+
+    // counts over index keys are computed from the index
+    if (JsonVal->IsObjKey("key")) { return PAggr(); }
+    // parse join and field
+    TJoinSeq JoinSeq; int FieldId;
+    ParseJson(Base, StoreId, JsonVal, JoinSeq, FieldId);
+    return new TCount(Base, AggrNm, JoinSeq, FieldId);
+}
+
+void TCount::Merge(const TFusedAggr& Aggr) {
+    const TCount& CountAggr = dynamic_cast<const TCount&>(Aggr);
+    int ValKeyId = CountAggr.ValH.FFirstKeyId();
+    while (CountAggr.ValH.FNextKeyId(ValKeyId)) {
+        ValH.AddDat(CountAggr.ValH.GetKey(ValKeyId)) += CountAggr.ValH[ValKeyId];
+    }
+    Count += CountAggr.Count;
+}
+
 PJsonVal TCount::SaveJson() const { 
     PJsonVal ResVal = TJsonVal::NewObj();
     ResVal->AddToObj("type", "count");
@@ -115,60 +286,192 @@ PJsonVal TCount::SaveJson() const {
 
 ///////////////////////////////
 // QMiner-Aggregator-Histogram
+THistogram::THistogram(const TWPt<TBase>& Base, const TStr& AggrNm, const TJoinSeq& JoinSeq,
+    const int& FieldId, const int& _Buckets, const bool& _BinnedP): TFusedAggr(Base, AggrNm,
+        JoinSeq, FieldId, "Numeric[" + JoinSeq.GetEndStore(Base)->GetFieldNm(FieldId) + "]"),
+            Buckets(_Buckets), BinnedP(_BinnedP), FineBins(2 * TInt::GetMx(2048, 128 * _Buckets)) { }
+
 THistogram::THistogram(const TWPt<TBase>& Base, const TStr& AggrNm,
-        const PRecSet& RecSet, const PFtrExt& FtrExt, const int& Buckets):
-            TAggr(Base, AggrNm) {
+        const PRecSet& RecSet, const PFtrExt& FtrExt, const int& _Buckets):
+            TFusedAggr(Base, AggrNm, FtrExt->GetJoinSeq(RecSet->GetStoreId()), -1,
+                FtrExt->GetNm()), Buckets(_Buckets), BinnedP(false),
+                    FineBins(2 * TInt::GetMx(2048, 128 * _Buckets)) {
 
-    // prepare join path string, if necessary
-    JoinPathStr = FtrExt->GetJoinSeq(RecSet->GetStoreId()).GetJoinPathStr(Base);
-    // prepare field name
-    FieldNm = FtrExt->GetNm();
-    // if empty result set no need to do histogams
-    if (RecSet->Empty()) { return; }
-    // find min and max for histogram
-    double MnVal = TFlt::Mx, MxVal = TFlt::Mn;
+    // collect values
     const int Recs = RecSet->GetRecs();
     for (int RecN = 0; RecN < Recs; RecN++) {
         TFltV FtrValV; FtrExt->ExtractFltV(RecSet->GetRec(RecN), FtrValV);
         for (int FtrValN = 0; FtrValN < FtrValV.Len(); FtrValN++) {
-            const double Val = FtrValV[FtrValN];
-            MnVal = TFlt::GetMn(MnVal, Val);
-            MxVal = TFlt::GetMx(MxVal, Val);
+            AddFlt(FtrValV[FtrValN]);
         }
     }
-    // compute histogram
-    Mom = TMom::New(); Sum = 0.0;
-    Hist = THist(MnVal, MxVal, Buckets);
-    for (int RecN = 0; RecN < Recs; RecN++) {
-        TFltV FtrValV; FtrExt->ExtractFltV(RecSet->GetRec(RecN), FtrValV);
-        for (int FtrValN = 0; FtrValN < FtrValV.Len(); FtrValN++) {
-            const double FtrVal = FtrValV[FtrValN].Val;
-            Mom->Add(FtrVal); Sum += FtrVal;
-            Hist.Add(FtrValV[FtrValN], true); 
-        }
-    }
-    Mom->Def();
+    Finish();
 }
 
 PAggr THistogram::New(const TWPt<TBase>& Base, const TStr& AggrNm,
         const PRecSet& RecSet, const PJsonVal& JsonVal) {
 
-    // parse join
-    TJoinSeq JoinSeq = JsonVal->IsObjKey("join") ?
-        TJoinSeq(Base, RecSet->GetStoreId(), JsonVal->GetObjKey("join")) :
-        TJoinSeq(RecSet->GetStoreId());
-    // first get the field
-    const TStr FieldNm = JsonVal->GetObjStr("field");
-    // assert if valid field
-    TWPt<TStore> Store = JoinSeq.GetEndStore(Base);
-    QmAssert(Store->IsFieldNm(FieldNm));
-    // get the field id
-    const int FieldId = Store->GetFieldId(FieldNm);
+    PAggr Aggr = NewFused(Base, AggrNm, RecSet->GetStoreId(), JsonVal);
+    TFusedAggrExec Exec(Base, RecSet); Exec.AddAggr(Aggr); Exec.Exec();
+    return Aggr;
+}
+
+PAggr THistogram::NewFused(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const uint& StoreId, const PJsonVal& JsonVal) {
+
+    // parse join and field
+    TJoinSeq JoinSeq; int FieldId;
+    ParseJson(Base, StoreId, JsonVal, JoinSeq, FieldId);
     // get the number of buckets
     const int Buckets = TFlt::Round(JsonVal->GetObjNum("buckets", 10.0));
-    // prepare feature extractor
-    PFtrExt FtrExt = TFtrExts::TNumeric::New(Base, JoinSeq, FieldId);
-    return New(Base, AggrNm, RecSet, FtrExt, Buckets);
+    QmAssertR(Buckets > 0, "Histogram aggregate: number of buckets must be positive");
+    // approximate histogram with bounded state
+    const bool BinnedP = JsonVal->GetObjBool("binned", false);
+    return new THistogram(Base, AggrNm, JoinSeq, FieldId, Buckets, BinnedP);
+}
+
+int THistogram::GetFineN(const double& Val) const {
+    const int FineN = (int)floor((Val - FineMn) / FineWidth);
+    return TInt::GetMx(0, TInt::GetMn(FineN, FineBins - 1));
+}
+
+void THistogram::ExtendFine(const double& Val, const double& MnWidth) {
+    const int HalfBins = FineBins / 2;
+    while (FineWidth < MnWidth || Val < FineMn || Val >= FineMn + FineWidth * FineBins) {
+        // join neighbouring bins into one half of the range, the other half is empty
+        const bool LeftP = Val < FineMn;
+        const int FirstN = LeftP ? HalfBins : 0;
+        TUInt64V JoinedV(FineBins); JoinedV.PutAll(0);
+        for (int BinN = 0; BinN < HalfBins; BinN++) {
+            JoinedV[FirstN + BinN] = FineV[2*BinN] + FineV[2*BinN + 1];
+        }
+        FineV = JoinedV;
+        if (LeftP) { FineMn -= FineWidth * FineBins; }
+        FineWidth *= 2.0;
+    }
+}
+
+void THistogram::AddFine(const double& Val, const uint64& Cnt) {
+    // first value is kept only by the statistics
+    if (Count == 0) { return; }
+    if (FineV.Empty()) {
+        // all the values so far are equal to MnVal
+        if (Val == MnVal) { return; }
+        // second distinct value gives the initial range
+        FineMn = TFlt::GetMn(MnVal, Val);
+        FineWidth = TFlt::GetMx(fabs(Val - MnVal) / (FineBins - 1), DBL_MIN);
+        FineV.Gen(FineBins); FineV.PutAll(0);
+        FineV[GetFineN(MnVal)] += Count;
+    }
+    ExtendFine(Val, 0.0);
+    FineV[GetFineN(Val)] += Cnt;
+}
+
+void THistogram::AddStats(const uint64& Cnt, const double& _Sum, const double& _Mean,
+        const double& _M2, const double& _MnVal, const double& _MxVal) {
+
+    if (Cnt == 0) { return; }
+    if (Count == 0) {
+        MnVal = _MnVal; MxVal = _MxVal;
+    } else {
+        MnVal = TFlt::GetMn(MnVal, _MnVal);
+        MxVal = TFlt::GetMx(MxVal, _MxVal);
+    }
+    // parallel update of mean and sum of squared differences from the mean
+    const double NewCount = (double)Count + (double)Cnt;
+    const double Delta = _Mean - Mean;
+    M2 += _M2 + Delta * Delta * (double)Count * (double)Cnt / NewCount;
+    Mean += Delta * (double)Cnt / NewCount;
+    Sum += _Sum;
+    Count += Cnt;
+}
+
+void THistogram::AddFlt(const double& Flt) {
+    if (!BinnedP) { ValV.Add(Flt); return; }
+    // values outside the double range cannot be bucketed
+    if (!TFlt::IsNum(Flt)) { return; }
+    AddFine(Flt, 1);
+    AddStats(1, Flt, Flt, 0.0, Flt, Flt);
+}
+
+void THistogram::Merge(const TFusedAggr& Aggr) {
+    const THistogram& HistAggr = dynamic_cast<const THistogram&>(Aggr);
+    if (!BinnedP) { ValV.AddV(HistAggr.ValV); return; }
+    if (HistAggr.Count == 0) { return; }
+    if (HistAggr.FineV.Empty()) {
+        // the other part has only one distinct value
+        AddFine(HistAggr.MnVal, HistAggr.Count);
+    } else if (FineV.Empty()) {
+        // take the bins of the other part and add our values to them
+        const uint64 OldCount = Count; const double OldVal = MnVal;
+        FineMn = HistAggr.FineMn; FineWidth = HistAggr.FineWidth; FineV = HistAggr.FineV;
+        if (OldCount > 0) {
+            ExtendFine(OldVal, 0.0);
+            FineV[GetFineN(OldVal)] += OldCount;
+        }
+    } else {
+        // re-bucket the other bins by their centers into bins at least as wide
+        for (int BinN = 0; BinN < FineBins; BinN++) {
+            if (HistAggr.FineV[BinN] == 0) { continue; }
+            const double BinVal = HistAggr.FineMn + (BinN + 0.5) * HistAggr.FineWidth;
+            ExtendFine(BinVal, HistAggr.FineWidth);
+            FineV[GetFineN(BinVal)] += HistAggr.FineV[BinN];
+        }
+    }
+    AddStats(HistAggr.Count, HistAggr.Sum, HistAggr.Mean, HistAggr.M2, HistAggr.MnVal, HistAggr.MxVal);
+}
+
+void THistogram::Finish() {
+    if (!BinnedP) {
+        // if empty result set no need to do histogams
+        if (ValV.Empty()) { return; }
+        // find min and max for histogram
+        double MnVal = TFlt::Mx, MxVal = TFlt::Mn;
+        for (int ValN = 0; ValN < ValV.Len(); ValN++) {
+            MnVal = TFlt::GetMn(MnVal, ValV[ValN]);
+            MxVal = TFlt::GetMx(MxVal, ValV[ValN]);
+        }
+        // compute histogram
+        Mom = TMom::New(); Sum = 0.0;
+        Hist = THist(MnVal, MxVal, Buckets);
+        for (int ValN = 0; ValN < ValV.Len(); ValN++) {
+            const double Val = ValV[ValN];
+            Mom->Add(Val); Sum += Val;
+            Hist.Add(Val, true);
+        }
+        Mom->Def();
+        // values not needed anymore
+        ValV.Clr();
+        return;
+    }
+    // if empty result set no need to do histogams
+    if (Count == 0) { return; }
+    // re-bucket the fine bins over [min, max]
+    BucketSize = (MxVal == MnVal) ? 1.0 : (1.01 * double(MxVal - MnVal) / double(Buckets));
+    BucketV.Gen(Buckets); BucketV.PutAll(0);
+    if (FineV.Empty()) {
+        BucketV[0] = Count;
+        Median = MnVal;
+        return;
+    }
+    const double HalfCount = 0.5 * (double)Count;
+    double CumCount = 0.0; bool MedianP = false;
+    for (int BinN = 0; BinN < FineBins; BinN++) {
+        const uint64 BinCount = FineV[BinN];
+        if (BinCount == 0) { continue; }
+        const double BinVal = FineMn + (BinN + 0.5) * FineWidth;
+        const int BucketN = (int)floor((BinVal - MnVal) / BucketSize);
+        BucketV[TInt::GetMx(0, TInt::GetMn(BucketN, Buckets - 1))] += BinCount;
+        // median is interpolated inside the bin where the count passes one half
+        if (!MedianP && CumCount + (double)BinCount > HalfCount) {
+            const double BinMedian = FineMn + (BinN + (HalfCount - CumCount) / (double)BinCount) * FineWidth;
+            Median = TFlt::GetMx(MnVal, TFlt::GetMn(MxVal, BinMedian));
+            MedianP = true;
+        }
+        CumCount += (double)BinCount;
+    }
+    // fine bins are not needed anymore
+    FineV.Clr();
 }
 
 PJsonVal THistogram::SaveJson() const { 
@@ -177,25 +480,53 @@ PJsonVal THistogram::SaveJson() const {
     ResVal->AddToObj("field", FieldNm);
     ResVal->AddToObj("join", JoinPathStr);
 
-    if (Mom.Empty()) { return ResVal; }
+    if (!BinnedP) {
+        if (Mom.Empty()) { return ResVal; }
+
+        ResVal->AddToObj("count", Mom->GetVals());
+        ResVal->AddToObj("sum", Sum);
+        ResVal->AddToObj("min", Mom->GetMn());
+        ResVal->AddToObj("max", Mom->GetMx());
+        ResVal->AddToObj("mean", Mom->GetMean());
+        ResVal->AddToObj("stdev", Mom->GetSDev());
+        ResVal->AddToObj("median", Mom->GetMedian());
+
+        TJsonValV ValValV;
+        double PercentSum = 0.0;
+        for (int BucketN = 0; BucketN < Hist.GetBuckets(); BucketN++) {
+            const double Percent = 100.0 * Hist.GetBucketValPerc(BucketN);
+            PercentSum += Percent;
+            PJsonVal ValVal = TJsonVal::NewObj();
+            ValVal->AddToObj("min", Hist.GetBucketMn(BucketN));
+            ValVal->AddToObj("max", Hist.GetBucketMx(BucketN));
+            ValVal->AddToObj("frequency", Hist.GetBucketVal(BucketN));
+            ValVal->AddToObj("precent", double(TFlt::Round(Percent*100.0))/100.0);
+            ValVal->AddToObj("percentSum", PercentSum);
+            ValValV.Add(ValVal);
+        }
+        ResVal->AddToObj("values", ValValV);
+        return ResVal;
+    }
+
+    if (Count == 0) { return ResVal; }
 
-    ResVal->AddToObj("count", Mom->GetVals());
+    ResVal->AddToObj("count", Count.Val);
     ResVal->AddToObj("sum", Sum);
-    ResVal->AddToObj("min", Mom->GetMn());
-    ResVal->AddToObj("max", Mom->GetMx());
-    ResVal->AddToObj("mean", Mom->GetMean());
-    ResVal->AddToObj("stdev", Mom->GetSDev());
-    ResVal->AddToObj("median", Mom->GetMedian());
+    ResVal->AddToObj("min", MnVal);
+    ResVal->AddToObj("max", MxVal);
+    ResVal->AddToObj("mean", Mean);
+    ResVal->AddToObj("stdev", sqrt(M2 / (double)Count));
+    ResVal->AddToObj("median", Median);
 
     TJsonValV ValValV;
     double PercentSum = 0.0;
-    for (int BucketN = 0; BucketN < Hist.GetBuckets(); BucketN++) {
-        const double Percent = 100.0 * Hist.GetBucketValPerc(BucketN);
+    for (int BucketN = 0; BucketN < BucketV.Len(); BucketN++) {
+        const double Percent = 100.0 * double(BucketV[BucketN]) / double(Count);
         PercentSum += Percent;
         PJsonVal ValVal = TJsonVal::NewObj();
-        ValVal->AddToObj("min", Hist.GetBucketMn(BucketN));
-        ValVal->AddToObj("max", Hist.GetBucketMx(BucketN));
-        ValVal->AddToObj("frequency", Hist.GetBucketVal(BucketN));
+        ValVal->AddToObj("min", MnVal + BucketN * BucketSize);
+        ValVal->AddToObj("max", MnVal + (BucketN + 1) * BucketSize);
+        ValVal->AddToObj("frequency", BucketV[BucketN].Val);
         ValVal->AddToObj("precent", double(TFlt::Round(Percent*100.0))/100.0);
         ValVal->AddToObj("percentSum", PercentSum);
         ValValV.Add(ValVal);
@@ -392,13 +723,7 @@ PJsonVal TTimeLine::GetJsonList(const TStrH& StrH) const {
     return JsonVal;
 }
 
-TTimeLine::TTimeLine(const TWPt<TBase>& Base, const TStr& AggrNm,
-        const PRecSet& RecSet, const PFtrExt& FtrExt): TAggr(Base, AggrNm) {
-
-    // prepare join path string, if necessary
-    JoinPathStr = FtrExt->GetJoinSeq(RecSet->GetStoreId()).GetJoinPathStr(Base);
-    // prepare field name
-    FieldNm = FtrExt->GetNm();
+void TTimeLine::InitH() {
     // initialize hash-tables
     for (int MonthN = 0; MonthN < 12; MonthN++) {
         MonthH.AddKey(TTmInfo::GetMonthNm(MonthN+1)); }
@@ -406,43 +731,74 @@ TTimeLine::TTimeLine(const TWPt<TBase>& Base, const TStr& AggrNm,
         DayOfWeekH.AddKey(TTmInfo::GetDayOfWeekNm(DayOfWeekN+1)); }
     for (int HourOfDayN = 0; HourOfDayN < 24; HourOfDayN++) {
         HourOfDayH.AddKey(TInt::GetStr(HourOfDayN)); }
+}
+
+TTimeLine::TTimeLine(const TWPt<TBase>& Base, const TStr& AggrNm, const TJoinSeq& JoinSeq,
+        const int& FieldId): TFusedAggr(Base, AggrNm, JoinSeq, FieldId, "Multinomial[" +
+            JoinSeq.GetEndStore(Base)->GetFieldNm(FieldId) + "]") {
+
+    InitH();
+}
+
+TTimeLine::TTimeLine(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const PRecSet& RecSet, const PFtrExt& FtrExt): TFusedAggr(Base, AggrNm,
+            FtrExt->GetJoinSeq(RecSet->GetStoreId()), -1, FtrExt->GetNm()) {
+
+    InitH();
     // prepare peichart
     const int Recs = RecSet->GetRecs();
     for (int RecN = 0; RecN < Recs; RecN++) {
         TTmV FtrValV; FtrExt->ExtractTmV(RecSet->GetRec(RecN), FtrValV);
         for (int FtrValN = 0; FtrValN < FtrValV.Len(); FtrValN++) {
-            const TTm& Tm = FtrValV[FtrValN]; 
-            if (Tm.IsDef()) {
-                TSecTm SecTm(Tm); Count++;
-                TStr DateStr = Tm.GetWebLogDateStr();
-                AbsDateH.AddDat(DateStr)++;
-                MonthH.AddDat(SecTm.GetMonthNm())++;
-                DayOfWeekH.AddDat(SecTm.GetDayOfWeekNm())++;
-                if (0 <= Tm.GetHour() && Tm.GetHour() < 24) { 
-                    HourOfDayH[Tm.GetHour()]++; }
-            }
+            AddTm(FtrValV[FtrValN]);
         }
     }
-    AbsDateH.SortByKey(true);
+    Finish();
 }
 
 PAggr TTimeLine::New(const TWPt<TBase>& Base, const TStr& AggrNm, 
         const PRecSet& RecSet, const PJsonVal& JsonVal) {
 
-    // parse join
-    TJoinSeq JoinSeq = JsonVal->IsObjKey("join") ?
-        TJoinSeq(Base, RecSet->GetStoreId(), JsonVal->GetObjKey("join")) :
-        TJoinSeq(RecSet->GetStoreId());
-    // get the field
-    const TStr FieldNm = JsonVal->GetObjStr("field");
-    // assert if valid field
-    TWPt<TStore> Store = JoinSeq.GetEndStore(Base);
-    QmAssert(Store->IsFieldNm(FieldNm));
-    // get the field id
-    const int FieldId = Store->GetFieldId(FieldNm);
-    // is there a join?
-    PFtrExt FtrExt = TFtrExts::TMultinomial::New(Base, JoinSeq, FieldId);
-    return New(Base, AggrNm, RecSet, FtrExt);
+    PAggr Aggr = NewFused(Base, AggrNm, RecSet->GetStoreId(), JsonVal);
+    TFusedAggrExec Exec(Base, RecSet); Exec.AddAggr(Aggr); Exec.Exec();
+    return Aggr;
+}
+
+PAggr TTimeLine::NewFused(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const uint& StoreId, const PJsonVal& JsonVal) {
+
+    // parse join and field
+    TJoinSeq JoinSeq; int FieldId;
+    ParseJson(Base, StoreId, JsonVal, JoinSeq, FieldId);
+    return new TTimeLine(Base, AggrNm, JoinSeq, FieldId);
+}
+
+void TTimeLine::AddTm(const TTm& Tm) {
+    if (Tm.IsDef()) {
+        TSecTm SecTm(Tm); Count++;
+        TStr DateStr = Tm.GetWebLogDateStr();
+        AbsDateH.AddDat(DateStr)++;
+        MonthH.AddDat(SecTm.GetMonthNm())++;
+        DayOfWeekH.AddDat(SecTm.GetDayOfWeekNm())++;
+        if (0 <= Tm.GetHour() && Tm.GetHour() < 24) { 
+            HourOfDayH[Tm.GetHour()]++; }
+    }
+}
+
+void TTimeLine::Merge(const TFusedAggr& Aggr) {
+    const TTimeLine& TimeLine = dynamic_cast<const TTimeLine&>(Aggr);
+    int KeyId = TimeLine.AbsDateH.FFirstKeyId();
+    while (TimeLine.AbsDateH.FNextKeyId(KeyId)) {
+        AbsDateH.AddDat(TimeLine.AbsDateH.GetKey(KeyId)) += TimeLine.AbsDateH[KeyId];
+    }
+    // fixed buckets have the same keys in all partial states
+    for (int MonthN = 0; MonthN < MonthH.Len(); MonthN++) {
+        MonthH[MonthN] += TimeLine.MonthH[MonthN]; }
+    for (int DayOfWeekN = 0; DayOfWeekN < DayOfWeekH.Len(); DayOfWeekN++) {
+        DayOfWeekH[DayOfWeekN] += TimeLine.DayOfWeekH[DayOfWeekN]; }
+    for (int HourOfDayN = 0; HourOfDayN < HourOfDayH.Len(); HourOfDayN++) {
+        HourOfDayH[HourOfDayN] += TimeLine.HourOfDayH[HourOfDayN]; }
+    Count += TimeLine.Count;
 }
 
 PJsonVal TTimeLine::SaveJson() const { 
@@ -475,48 +831,51 @@ PJsonVal TTimeSpan::GetJsonList(const TUInt64H& DataH) const {
     return JsonVal;
 }
 
+TTimeSpan::TTimeSpan(const TWPt<TBase>& Base, const TStr& AggrNm, const TJoinSeq& JoinSeq,
+    const int& FieldId, const uint64 _SlotLen): TFusedAggr(Base, AggrNm, JoinSeq, FieldId,
+        "Multinomial[" + JoinSeq.GetEndStore(Base)->GetFieldNm(FieldId) + "]"), SlotLen(_SlotLen) { }
+
 TTimeSpan::TTimeSpan(const TWPt<TBase>& Base, const TStr& AggrNm,
     const PRecSet& RecSet, const PFtrExt& FtrExt, const uint64 _SlotLen) 
-    : TAggr(Base, AggrNm), SlotLen(_SlotLen) {
+    : TFusedAggr(Base, AggrNm, FtrExt->GetJoinSeq(RecSet->GetStoreId()), -1,
+        FtrExt->GetNm()), SlotLen(_SlotLen) {
 
-    // prepare join path string, if necessary
-    JoinPathStr = FtrExt->GetJoinSeq(RecSet->GetStoreId()).GetJoinPathStr(Base);
-    // prepare field name
-    FieldNm = FtrExt->GetNm();
     // prepare peichart
     const int Recs = RecSet->GetRecs();
     for (int RecN = 0; RecN < Recs; RecN++) {
         TTmV FtrValV; FtrExt->ExtractTmV(RecSet->GetRec(RecN), FtrValV);
         for (int FtrValN = 0; FtrValN < FtrValV.Len(); FtrValN++) {
-            const TTm& Tm = FtrValV[FtrValN];
-            if (Tm.IsDef()) {
-                uint64 slot = TTm::GetMSecsFromTm(Tm) / SlotLen;
-                CountsH.AddDat(slot)++;
-            }
+            AddTm(FtrValV[FtrValN]);
         }
     }
-    CountsH.SortByKey(true);
+    Finish();
 }
 
 PAggr TTimeSpan::New(const TWPt<TBase>& Base, const TStr& AggrNm,
     const PRecSet& RecSet, const PJsonVal& JsonVal) {
 
-    // parse join
-    TJoinSeq JoinSeq = JsonVal->IsObjKey("join") ?
-        TJoinSeq(Base, RecSet->GetStoreId(), JsonVal->GetObjKey("join")) :
-        TJoinSeq(RecSet->GetStoreId());
-    // get the field
-    const TStr FieldNm = JsonVal->GetObjStr("field");
-    // get the field
+    PAggr Aggr = NewFused(Base, AggrNm, RecSet->GetStoreId(), JsonVal);
+    TFusedAggrExec Exec(Base, RecSet); Exec.AddAggr(Aggr); Exec.Exec();
+    return Aggr;
+}
+
+PAggr TTimeSpan::NewFused(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const uint& StoreId, const PJsonVal& JsonVal) {
+
+    // parse join and field
+    TJoinSeq JoinSeq; int FieldId;
+    ParseJson(Base, StoreId, JsonVal, JoinSeq, FieldId);
+    // get the slot length
     const TUInt64 SlotLen = JsonVal->GetObjUInt64("slot_length");
-    // assert if valid field
-    TWPt<TStore> Store = JoinSeq.GetEndStore(Base);
-    QmAssert(Store->IsFieldNm(FieldNm));
-    // get the field id
-    const int FieldId = Store->GetFieldId(FieldNm);
-    // is there a join?
-    PFtrExt FtrExt = TFtrExts::TMultinomial::New(Base, JoinSeq, FieldId);
-    return New(Base, AggrNm, RecSet, FtrExt, SlotLen);
+    return new TTimeSpan(Base, AggrNm, JoinSeq, FieldId, SlotLen);
+}
+
+void TTimeSpan::Merge(const TFusedAggr& Aggr) {
+    const TTimeSpan& TimeSpan = dynamic_cast<const TTimeSpan&>(Aggr);
+    int KeyId = TimeSpan.CountsH.FFirstKeyId();
+    while (TimeSpan.CountsH.FNextKeyId(KeyId)) {
+        CountsH.AddDat(TimeSpan.CountsH.GetKey(KeyId)) += TimeSpan.CountsH[KeyId];
+    }
 }
 
 PJsonVal TTimeSpan::SaveJson() const {
@@ -529,6 +888,518 @@ PJsonVal TTimeSpan::SaveJson() const {
     return ResVal;
 }
 
+///////////////////////////////
+// QMiner-Aggregator-Distinct
+TDistinct::TDistinct(const TWPt<TBase>& Base, const TStr& AggrNm, const TJoinSeq& JoinSeq,
+    const int& FieldId, const int& _Bits): TFusedAggr(Base, AggrNm, JoinSeq, FieldId,
+        "Multinomial[" + JoinSeq.GetEndStore(Base)->GetFieldNm(FieldId) + "]"), Bits(_Bits),
+            HyperLogLog(_Bits) { }
+
+PAggr TDistinct::New(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const PRecSet& RecSet, const PJsonVal& JsonVal) {
+
+    PAggr Aggr = NewFused(Base, AggrNm, RecSet->GetStoreId(), JsonVal);
+    TFusedAggrExec Exec(Base, RecSet); Exec.AddAggr(Aggr); Exec.Exec();
+    return Aggr;
+}
+
+PAggr TDistinct::NewFused(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const uint& StoreId, const PJsonVal& JsonVal) {
+
+    // parse join and field
+    TJoinSeq JoinSeq; int FieldId;
+    ParseJson(Base, StoreId, JsonVal, JoinSeq, FieldId);
+    // get the sketch precision
+    const int Bits = TFlt::Round(JsonVal->GetObjNum("precision", 14.0));
+    QmAssertR(4 <= Bits && Bits <= 20, "[TDistinct] Precision must be between 4 and 20");
+    return new TDistinct(Base, AggrNm, JoinSeq, FieldId, Bits);
+}
+
+void TDistinct::Merge(const TFusedAggr& Aggr) {
+    const TDistinct& Distinct = dynamic_cast<const TDistinct&>(Aggr);
+    HyperLogLog.Merge(Distinct.HyperLogLog);
+    Count += Distinct.Count;
+}
+
+PJsonVal TDistinct::SaveJson() const {
+    PJsonVal ResVal = TJsonVal::NewObj();
+    ResVal->AddToObj("type", "distinct");
+    ResVal->AddToObj("field", FieldNm);
+    ResVal->AddToObj("join", JoinPathStr);
+    ResVal->AddToObj("count", Count);
+    // estimate can not exceed number of values
+    const double Distinct = (Count > 0) ? TFlt::GetMn(HyperLogLog.GetCount(), (double)Count) : 0.0;
+    ResVal->AddToObj("distinct", floor(Distinct + 0.5));
+    ResVal->AddToObj("relErr", HyperLogLog.GetRelErr());
+    return ResVal;
+}
+
+///////////////////////////////
+// QMiner-Aggregator-TopK
+TTopK::TTopK(const TWPt<TBase>& Base, const TStr& AggrNm, const TJoinSeq& JoinSeq,
+    const int& FieldId, const int& _TopK, const double& _Eps, const double& _Delta):
+        TFusedAggr(Base, AggrNm, JoinSeq, FieldId, "Multinomial[" +
+            JoinSeq.GetEndStore(Base)->GetFieldNm(FieldId) + "]"), TopK(_TopK),
+            Eps(_Eps), Delta(_Delta), HeavyHitters(_TopK, _Eps, _Delta) { }
+
+PAggr TTopK::New(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const PRecSet& RecSet, const PJsonVal& JsonVal) {
+
+    PAggr Aggr = NewFused(Base, AggrNm, RecSet->GetStoreId(), JsonVal);
+    TFusedAggrExec Exec(Base, RecSet); Exec.AddAggr(Aggr); Exec.Exec();
+    return Aggr;
+}
+
+PAggr TTopK::NewFused(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const uint& StoreId, const PJsonVal& JsonVal) {
+
+    // parse join and field
+    TJoinSeq JoinSeq; int FieldId;
+    ParseJson(Base, StoreId, JsonVal, JoinSeq, FieldId);
+    // get the parameters
+    const int TopK = TFlt::Round(JsonVal->GetObjNum("k", 10.0));
+    const double Eps = JsonVal->GetObjNum("eps", 0.001);
+    const double Delta = JsonVal->GetObjNum("delta", 0.01);
+    QmAssertR(TopK > 0, "[TTopK] Parameter k must be positive");
+    QmAssertR(0.0 < Eps && Eps < 1.0, "[TTopK] Parameter eps must be between 0 and 1");
+    QmAssertR(0.0 < Delta && Delta < 1.0, "[TTopK] Parameter delta must be between 0 and 1");
+    return new TTopK(Base, AggrNm, JoinSeq, FieldId, TopK, Eps, Delta);
+}
+
+void TTopK::Merge(const TFusedAggr& Aggr) {
+    HeavyHitters.Merge(dynamic_cast<const TTopK&>(Aggr).HeavyHitters);
+}
+
+PJsonVal TTopK::SaveJson() const {
+    PJsonVal ResVal = TJsonVal::NewObj();
+    ResVal->AddToObj("type", "topk");
+    ResVal->AddToObj("field", FieldNm);
+    ResVal->AddToObj("join", JoinPathStr);
+    ResVal->AddToObj("count", HeavyHitters.GetTotal());
+    // frequencies are overestimated by at most error with probability 1 - delta
+    ResVal->AddToObj("error", HeavyHitters.GetErr());
+    ResVal->AddToObj("delta", Delta);
+    TStrV ValV; TUInt64V CountV;
+    HeavyHitters.GetTopK(ValV, CountV);
+    PJsonVal ValsVal = TJsonVal::NewArr();
+    for (int ValN = 0; ValN < ValV.Len(); ValN++) {
+        PJsonVal EltVal = TJsonVal::NewObj("value", ValV[ValN]);
+        EltVal->AddToObj("frequency", CountV[ValN]);
+        ValsVal->AddToArr(EltVal);
+    }
+    ResVal->AddToObj("values", ValsVal);
+    return ResVal;
+}
+
+///////////////////////////////
+// QMiner-Aggregator-Quantiles
+TQuantiles::TQuantiles(const TWPt<TBase>& Base, const TStr& AggrNm, const TJoinSeq& JoinSeq,
+    const int& FieldId, const TFltV& _QuantileV, const int& _Clusters):
+        TFusedAggr(Base, AggrNm, JoinSeq, FieldId, "Numeric[" +
+            JoinSeq.GetEndStore(Base)->GetFieldNm(FieldId) + "]"), QuantileV(_QuantileV),
+            Clusters(_Clusters), MnVal(TFlt::Mx), MxVal(TFlt::Mn), TDigest(_Clusters) { }
+
+PAggr TQuantiles::New(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const PRecSet& RecSet, const PJsonVal& JsonVal) {
+
+    PAggr Aggr = NewFused(Base, AggrNm, RecSet->GetStoreId(), JsonVal);
+    TFusedAggrExec Exec(Base, RecSet); Exec.AddAggr(Aggr); Exec.Exec();
+    return Aggr;
+}
+
+PAggr TQuantiles::NewFused(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const uint& StoreId, const PJsonVal& JsonVal) {
+
+    // parse join and field
+    TJoinSeq JoinSeq; int FieldId;
+    ParseJson(Base, StoreId, JsonVal, JoinSeq, FieldId);
+    // get the quantiles
+    TFltV QuantileV;
+    if (JsonVal->IsObjKey("quantiles")) {
+        JsonVal->GetObjFltV("quantiles", QuantileV);
+    } else {
+        QuantileV = TFltV::GetV(0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.99);
+    }
+    for (int QuantileN = 0; QuantileN < QuantileV.Len(); QuantileN++) {
+        QmAssertR(0.0 <= QuantileV[QuantileN] && QuantileV[QuantileN] <= 1.0,
+            "[TQuantiles] Quantiles must be between 0 and 1");
+    }
+    const int Clusters = TFlt::Round(JsonVal->GetObjNum("clusters", 100.0));
+    QmAssertR(Clusters > 0, "[TQuantiles] Number of clusters must be positive");
+    return new TQuantiles(Base, AggrNm, JoinSeq, FieldId, QuantileV, Clusters);
+}
+
+void TQuantiles::FlushBuf() {
+    if (BufValV.Empty()) { return; }
+    TDigest.UpdateV(BufValV);
+    BufValV.Clr(false);
+}
+
+void TQuantiles::AddFlt(const double& Flt) {
+    // merging into centroids is linear in their number, so values are added in batches
+    BufValV.Add(Flt); Count++;
+    if (BufValV.Len() >= MxBufVals) { FlushBuf(); }
+    MnVal = TFlt::GetMn(MnVal, Flt);
+    MxVal = TFlt::GetMx(MxVal, Flt);
+}
+
+void TQuantiles::Merge(const TFusedAggr& Aggr) {
+    const TQuantiles& Quantiles = dynamic_cast<const TQuantiles&>(Aggr);
+    FlushBuf();
+    if (!Quantiles.BufValV.Empty()) { TDigest.UpdateV(Quantiles.BufValV); }
+    TDigest.Merge(Quantiles.TDigest);
+    Count += Quantiles.Count;
+    MnVal = TFlt::GetMn(MnVal, Quantiles.MnVal);
+    MxVal = TFlt::GetMx(MxVal, Quantiles.MxVal);
+}
+
+PJsonVal TQuantiles::SaveJson() const {
+    PJsonVal ResVal = TJsonVal::NewObj();
+    ResVal->AddToObj("type", "quantiles");
+    ResVal->AddToObj("field", FieldNm);
+    ResVal->AddToObj("join", JoinPathStr);
+    ResVal->AddToObj("count", Count);
+
+    if (Count == 0) { return ResVal; }
+
+    ResVal->AddToObj("min", MnVal);
+    ResVal->AddToObj("max", MxVal);
+    PJsonVal QuantilesVal = TJsonVal::NewArr();
+    for (int QuantileN = 0; QuantileN < QuantileV.Len(); QuantileN++) {
+        const double Quantile = QuantileV[QuantileN];
+        // t-digest interpolates, make sure estimate stays in the value range
+        const double Val = (Quantile <= 0.0) ? MnVal.Val : ((Quantile >= 1.0) ? MxVal.Val :
+            TFlt::GetMx(MnVal, TFlt::GetMn(MxVal, TDigest.GetQuantile(Quantile))));
+        PJsonVal EltVal = TJsonVal::NewObj("quantile", Quantile);
+        EltVal->AddToObj("value", Val);
+        QuantilesVal->AddToArr(EltVal);
+    }
+    ResVal->AddToObj("quantiles", QuantilesVal);
+    return ResVal;
+}
+
+///////////////////////////////
+// QMiner-Aggregator-GroupBy
+bool TGroupBy::TKeyCol::GetCode(const TRec& Rec, uint64& Code) {
+    if (!Rec.IsDef() || Rec.IsFieldNull(FieldId)) { return false; }
+    if (KeyType == gbktStr) {
+        Code = (uint64)StrSet.AddKey(Reader.GetStr(Rec));
+    } else if (KeyType == gbktFlt) {
+        double Flt = Reader.GetFlt(Rec);
+        if (TFlt::IsNan(Flt)) { return false; }
+        if (Bucket > 0.0) { Flt = floor(Flt / Bucket) * Bucket; }
+        // -0.0 and 0.0 have different bit patterns, but belong to the same group
+        if (Flt == 0.0) { Flt = 0.0; }
+        memcpy(&Code, &Flt, sizeof(double));
+    } else if (KeyType == gbktTm) {
+        const uint64 MSecs = Reader.GetTmMSecs(Rec);
+        Code = (Bucket > 0.0) ? (MSecs / (uint64)Bucket.Val) : MSecs;
+    }
+    return true;
+}
+
+int TGroupBy::TKeyCol::Cmp(const uint64& Code1, const uint64& Code2) const {
+    if (Code1 == Code2) { return 0; }
+    if (KeyType == gbktStr) {
+        return (StrSet.GetKey((int)Code1) < StrSet.GetKey((int)Code2)) ? -1 : 1;
+    } else if (KeyType == gbktFlt) {
+        double Flt1, Flt2;
+        memcpy(&Flt1, &Code1, sizeof(double));
+        memcpy(&Flt2, &Code2, sizeof(double));
+        return (Flt1 < Flt2) ? -1 : 1;
+    }
+    return (Code1 < Code2) ? -1 : 1;
+}
+
+PJsonVal TGroupBy::TKeyCol::GetJson(const uint64& Code) const {
+    if (KeyType == gbktStr) {
+        return TJsonVal::NewStr(StrSet.GetKey((int)Code));
+    } else if (KeyType == gbktFlt) {
+        double Flt; memcpy(&Flt, &Code, sizeof(double));
+        return TJsonVal::NewNum(Flt);
+    }
+    const uint64 MSecs = (Bucket > 0.0) ? (Code * (uint64)Bucket.Val) : Code;
+    return TJsonVal::NewNum((double)TTm::GetUnixMSecsFromWinMSecs(MSecs));
+}
+
+TGroupBy::TGroupH::TGroupH(const int& _KeyLen, const int& ExpGroups): KeyLen(_KeyLen) {
+    int Slots = 16; while (Slots < 2 * ExpGroups) { Slots *= 2; }
+    SlotV.Gen(Slots); SlotV.PutAll(-1);
+}
+
+uint64 TGroupBy::TGroupH::GetHash(const TUInt64V& Key) const {
+    uint64 Hash = 0;
+    for (int KeyN = 0; KeyN < KeyLen; KeyN++) {
+        Hash = TSignalProc::THyperLogLog::GetHash(Hash ^ Key[KeyN].Val);
+    }
+    return Hash;
+}
+
+bool TGroupBy::TGroupH::IsKey(const int& GroupN, const TUInt64V& Key) const {
+    const int KeyOffset = GroupN * KeyLen;
+    for (int KeyN = 0; KeyN < KeyLen; KeyN++) {
+        if (KeyV[KeyOffset + KeyN].Val != Key[KeyN].Val) { return false; }
+    }
+    return true;
+}
+
+void TGroupBy::TGroupH::Resize() {
+    SlotV.Gen(2 * SlotV.Len()); SlotV.PutAll(-1);
+    const uint64 Mask = (uint64)(SlotV.Len() - 1);
+    for (int GroupN = 0; GroupN < HashV.Len(); GroupN++) {
+        uint64 SlotN = HashV[GroupN] & Mask;
+        while (SlotV[(int)SlotN].Val != -1) { SlotN = (SlotN + 1) & Mask; }
+        SlotV[(int)SlotN] = GroupN;
+    }
+}
+
+int TGroupBy::TGroupH::AddKey(const TUInt64V& Key) {
+    const uint64 Hash = GetHash(Key);
+    const uint64 Mask = (uint64)(SlotV.Len() - 1);
+    uint64 SlotN = Hash & Mask;
+    while (SlotV[(int)SlotN].Val != -1) {
+        const int GroupN = SlotV[(int)SlotN];
+        if (HashV[GroupN].Val == Hash && IsKey(GroupN, Key)) { return GroupN; }
+        SlotN = (SlotN + 1) & Mask;
+    }
+    // new group
+    const int GroupN = HashV.Len();
+    SlotV[(int)SlotN] = GroupN; HashV.Add(Hash); KeyV.AddV(Key);
+    // keep load factor below one half, so probe sequences stay short
+    if (2 * HashV.Len() > SlotV.Len()) { Resize(); }
+    return GroupN;
+}
+
+int TGroupBy::TRowCmp::Cmp(const int& RowN1, const int& RowN2) const {
+    const int Keys = KeyColV.Len();
+    for (int KeyN = 0; KeyN < Keys; KeyN++) {
+        const int CmpRes = KeyColV[KeyN].Cmp(KeyV[RowN1 * Keys + KeyN], KeyV[RowN2 * Keys + KeyN]);
+        if (CmpRes != 0) { return CmpRes; }
+    }
+    return 0;
+}
+
+int TGroupBy::GetJoinN(const TJoinSeq& JoinSeq) {
+    const TIntPrV& JoinIdV = JoinSeq.GetJoinIdV();
+    if (!JoinIdVH.IsKey(JoinIdV)) { JoinIdVH.AddDat(JoinIdV, JoinIdVH.Len()); }
+    return JoinIdVH.GetDat(JoinIdV);
+}
+
+void TGroupBy::GetJoinRecV(const TRec& Rec, TVec<TRec>& JoinRecV) const {
+    // execute each join path once per record, first joined record is used
+    for (int JoinN = 0; JoinN < JoinIdVH.Len(); JoinN++) {
+        const TIntPrV& JoinIdV = JoinIdVH.GetKey(JoinN);
+        JoinRecV[JoinN] = JoinIdV.Empty() ? Rec : Rec.DoSingleJoin(GetBase(), JoinIdV);
+    }
+}
+
+bool TGroupBy::ReadKey(const TVec<TRec>& JoinRecV, TUInt64V& Key) {
+    for (int KeyColN = 0; KeyColN < KeyColV.Len(); KeyColN++) {
+        TKeyCol& KeyCol = KeyColV[KeyColN];
+        if (!KeyCol.GetCode(JoinRecV[KeyCol.JoinN], Key[KeyColN].Val)) { return false; }
+    }
+    return true;
+}
+
+void TGroupBy::ReadVal(const TVec<TRec>& JoinRecV, TFltV& ValV, TBoolV& ValPV) const {
+    for (int ValColN = 0; ValColN < ValColV.Len(); ValColN++) {
+        const TValCol& ValCol = ValColV[ValColN];
+        if (ValCol.FieldId == -1) { ValV[ValColN] = 1.0; ValPV[ValColN] = true; continue; }
+        const TRec& Rec = JoinRecV[ValCol.JoinN];
+        ValPV[ValColN] = Rec.IsDef() && !Rec.IsFieldNull(ValCol.FieldId);
+        ValV[ValColN] = ValPV[ValColN] ? ValCol.Reader.GetFlt(Rec) : 0.0;
+    }
+}
+
+void TGroupBy::AddGroup() {
+    for (int ValColN = 0; ValColN < ValColV.Len(); ValColN++) {
+        CountV.Add(0.0); SumV.Add(0.0); SqSumV.Add(0.0);
+        MnV.Add(TFlt::Mx); MxV.Add(TFlt::Mn);
+    }
+    Groups++;
+}
+
+void TGroupBy::UpdateGroup(const int& GroupN, const TFltV& ValV, const TBoolV& ValPV) {
+    const int Vals = ValColV.Len();
+    for (int ValColN = 0; ValColN < Vals; ValColN++) {
+        if (!ValPV[ValColN]) { continue; }
+        const double Val = ValV[ValColN];
+        const int StateN = GroupN * Vals + ValColN;
+        CountV[StateN] += 1.0; SumV[StateN] += Val; SqSumV[StateN] += Val * Val;
+        if (Val < MnV[StateN]) { MnV[StateN] = Val; }
+        if (Val > MxV[StateN]) { MxV[StateN] = Val; }
+    }
+}
+
+PJsonVal TGroupBy::GetValJson(const int& GroupN, const int& ValColN) const {
+    const int StateN = GroupN * ValColV.Len() + ValColN;
+    const double Count = CountV[StateN];
+    const TGroupByValAggr ValAggr = ValColV[ValColN].ValAggr;
+    if (ValAggr == gbvaCount) { return TJsonVal::NewNum(Count); }
+    if (ValAggr == gbvaSum) { return TJsonVal::NewNum(SumV[StateN]); }
+    // remaining aggregates are not defined when group has no values
+    if (Count == 0.0) { return TJsonVal::NewNull(); }
+    if (ValAggr == gbvaMin) { return TJsonVal::NewNum(MnV[StateN]); }
+    if (ValAggr == gbvaMax) { return TJsonVal::NewNum(MxV[StateN]); }
+    const double Mean = SumV[StateN] / Count;
+    if (ValAggr == gbvaMean) { return TJsonVal::NewNum(Mean); }
+    // population variance
+    return TJsonVal::NewNum(TFlt::GetMx(SqSumV[StateN] / Count - Mean * Mean, 0.0));
+}
+
+void TGroupBy::ExecHash(const PRecSet& RecSet) {
+    TGroupH GroupH(KeyColV.Len());
+    TVec<TRec> JoinRecV(JoinIdVH.Len());
+    TUInt64V Key(KeyColV.Len()); TFltV ValV(ValColV.Len()); TBoolV ValPV(ValColV.Len());
+    const int Recs = RecSet->GetRecs();
+    for (int RecN = 0; RecN < Recs; RecN++) {
+        GetJoinRecV(RecSet->GetRec(RecN), JoinRecV);
+        if (!ReadKey(JoinRecV, Key)) { continue; }
+        const int GroupN = GroupH.AddKey(Key);
+        if (GroupN == Groups) { AddGroup(); }
+        ReadVal(JoinRecV, ValV, ValPV);
+        UpdateGroup(GroupN, ValV, ValPV);
+    }
+    GroupKeyV = GroupH.GetKeyV();
+}
+
+void TGroupBy::ExecSort(const PRecSet& RecSet) {
+    const int Keys = KeyColV.Len(), Vals = ValColV.Len();
+    // collect keys and values of all records with a key
+    TUInt64V RowKeyV; TFltV RowValV; TBoolV RowValPV;
+    TVec<TRec> JoinRecV(JoinIdVH.Len());
+    TUInt64V Key(Keys); TFltV ValV(Vals); TBoolV ValPV(Vals);
+    const int Recs = RecSet->GetRecs();
+    for (int RecN = 0; RecN < Recs; RecN++) {
+        GetJoinRecV(RecSet->GetRec(RecN), JoinRecV);
+        if (!ReadKey(JoinRecV, Key)) { continue; }
+        ReadVal(JoinRecV, ValV, ValPV);
+        RowKeyV.AddV(Key); RowValV.AddV(ValV); RowValPV.AddV(ValPV);
+    }
+    // sort rows by key, unless they already come sorted
+    const int Rows = RowKeyV.Len() / Keys;
+    TRowCmp RowCmp(KeyColV, RowKeyV);
+    TIntV RowNV(Rows, 0);
+    bool SortedP = true;
+    for (int RowN = 0; RowN < Rows; RowN++) {
+        if (RowN > 0 && RowCmp.Cmp(RowN - 1, RowN) > 0) { SortedP = false; }
+        RowNV.Add(RowN);
+    }
+    if (!SortedP) { RowNV.SortCmp(RowCmp); }
+    // aggregate runs of rows with equal keys
+    for (int RowNN = 0; RowNN < Rows; RowNN++) {
+        const int RowN = RowNV[RowNN];
+        if (RowNN == 0 || RowCmp.Cmp(RowNV[RowNN - 1], RowN) != 0) {
+            for (int KeyN = 0; KeyN < Keys; KeyN++) { GroupKeyV.Add(RowKeyV[RowN * Keys + KeyN]); }
+            AddGroup();
+        }
+        for (int ValN = 0; ValN < Vals; ValN++) {
+            ValV[ValN] = RowValV[RowN * Vals + ValN];
+            ValPV[ValN] = RowValPV[RowN * Vals + ValN];
+        }
+        UpdateGroup(Groups - 1, ValV, ValPV);
+    }
+}
+
+TGroupBy::TGroupBy(const TWPt<TBase>& Base, const TStr& AggrNm, const PRecSet& RecSet,
+        const PJsonVal& JsonVal): TAggr(Base, AggrNm) {
+
+    const uint StoreId = RecSet->GetStoreId();
+    // parse keys, each is given by field name or by object with field, join and bucket
+    QmAssertR(JsonVal->IsObjKey("keys"), "[TGroupBy] Missing keys");
+    PJsonVal KeysVal = JsonVal->GetObjKey("keys");
+    if (!KeysVal->IsArr()) { PJsonVal KeyVal = KeysVal; KeysVal = TJsonVal::NewArr(); KeysVal->AddToArr(KeyVal); }
+    QmAssertR(KeysVal->GetArrVals() > 0, "[TGroupBy] At least one key required");
+    for (int KeyN = 0; KeyN < KeysVal->GetArrVals(); KeyN++) {
+        PJsonVal KeyVal = KeysVal->GetArrVal(KeyN);
+        if (KeyVal->IsStr()) { KeyVal = TJsonVal::NewObj("field", KeyVal->GetStr()); }
+        const TJoinSeq JoinSeq = KeyVal->IsObjKey("join") ?
+            TJoinSeq(Base, StoreId, KeyVal->GetObjKey("join")) : TJoinSeq(StoreId);
+        TWPt<TStore> Store = JoinSeq.GetEndStore(Base);
+        const TStr FieldNm = KeyVal->GetObjStr("field");
+        QmAssertR(Store->IsFieldNm(FieldNm), "[TGroupBy] Unknown key field " + FieldNm);
+        const int FieldId = Store->GetFieldId(FieldNm);
+        const TFieldDesc& FieldDesc = Store->GetFieldDesc(FieldId);
+        TFieldReader Reader(Store->GetStoreId(), FieldId, FieldDesc);
+        // strings are grouped by value, numbers and times can be bucketed
+        TKeyType KeyType = gbktStr;
+        if (FieldDesc.IsTm()) { KeyType = gbktTm; }
+        else if (FieldDesc.IsStr()) { KeyType = gbktStr; }
+        else if (Reader.IsFlt()) { KeyType = gbktFlt; }
+        else { QmAssertR(Reader.IsStr(), "[TGroupBy] Unsupported key field type " + FieldDesc.GetFieldTypeStr()); }
+        const double Bucket = KeyVal->GetObjNum("bucket", 0.0);
+        QmAssertR(Bucket >= 0.0, "[TGroupBy] Bucket must be positive");
+        QmAssertR(Bucket == 0.0 || KeyType != gbktStr, "[TGroupBy] Bucketing not supported for key field " + FieldNm);
+        const TStr KeyNm = KeyVal->GetObjStr("name", FieldNm);
+        KeyColV.Add(TKeyCol(GetJoinN(JoinSeq), FieldId, KeyNm, KeyType, Bucket, Reader));
+    }
+    // parse values, default is number of records in a group
+    PJsonVal ValsVal = JsonVal->IsObjKey("values") ? JsonVal->GetObjKey("values") : TJsonVal::NewArr();
+    if (!ValsVal->IsArr()) { PJsonVal ValVal = ValsVal; ValsVal = TJsonVal::NewArr(); ValsVal->AddToArr(ValVal); }
+    if (ValsVal->GetArrVals() == 0) { ValsVal->AddToArr(TJsonVal::NewObj("aggr", TStr("count"))); }
+    for (int ValN = 0; ValN < ValsVal->GetArrVals(); ValN++) {
+        PJsonVal ValVal = ValsVal->GetArrVal(ValN);
+        const TStr ValAggrStr = ValVal->GetObjStr("aggr", "count");
+        TGroupByValAggr ValAggr = gbvaCount;
+        if (ValAggrStr == "count") { ValAggr = gbvaCount; }
+        else if (ValAggrStr == "sum") { ValAggr = gbvaSum; }
+        else if (ValAggrStr == "min") { ValAggr = gbvaMin; }
+        else if (ValAggrStr == "max") { ValAggr = gbvaMax; }
+        else if (ValAggrStr == "mean") { ValAggr = gbvaMean; }
+        else if (ValAggrStr == "variance") { ValAggr = gbvaVar; }
+        else { throw TQmExcept::New("[TGroupBy] Unknown value aggregate " + ValAggrStr); }
+        if (!ValVal->IsObjKey("field")) {
+            // no field, count records in group
+            QmAssertR(ValAggr == gbvaCount, "[TGroupBy] Missing field for value aggregate " + ValAggrStr);
+            ValColV.Add(TValCol(0, -1, ValVal->GetObjStr("name", "count"), ValAggr, TFieldReader()));
+            continue;
+        }
+        const TJoinSeq JoinSeq = ValVal->IsObjKey("join") ?
+            TJoinSeq(Base, StoreId, ValVal->GetObjKey("join")) : TJoinSeq(StoreId);
+        TWPt<TStore> Store = JoinSeq.GetEndStore(Base);
+        const TStr FieldNm = ValVal->GetObjStr("field");
+        QmAssertR(Store->IsFieldNm(FieldNm), "[TGroupBy] Unknown value field " + FieldNm);
+        const int FieldId = Store->GetFieldId(FieldNm);
+        TFieldReader Reader(Store->GetStoreId(), FieldId, Store->GetFieldDesc(FieldId));
+        QmAssertR(Reader.IsFlt(), "[TGroupBy] Value field " + FieldNm + " must be numeric");
+        const TStr ValNm = ValVal->GetObjStr("name", FieldNm + "_" + ValAggrStr);
+        ValColV.Add(TValCol(GetJoinN(JoinSeq), FieldId, ValNm, ValAggr, Reader));
+    }
+    // execute
+    const TStr StrategyStr = JsonVal->GetObjStr("strategy", "hash");
+    QmAssertR(StrategyStr == "hash" || StrategyStr == "sort", "[TGroupBy] Unknown strategy " + StrategyStr);
+    SortP = (StrategyStr == "sort");
+    if (SortP) { ExecSort(RecSet); } else { ExecHash(RecSet); }
+}
+
+PJsonVal TGroupBy::SaveJson() const {
+    PJsonVal ResVal = TJsonVal::NewObj();
+    ResVal->AddToObj("type", "groupby");
+    ResVal->AddToObj("groups", Groups);
+    // column names, keys first
+    PJsonVal ColsVal = TJsonVal::NewArr();
+    for (int KeyColN = 0; KeyColN < KeyColV.Len(); KeyColN++) {
+        ColsVal->AddToArr(KeyColV[KeyColN].Nm); }
+    for (int ValColN = 0; ValColN < ValColV.Len(); ValColN++) {
+        ColsVal->AddToArr(ValColV[ValColN].Nm); }
+    ResVal->AddToObj("columns", ColsVal);
+    // one row per group
+    PJsonVal RowsVal = TJsonVal::NewArr();
+    const int Keys = KeyColV.Len();
+    for (int GroupN = 0; GroupN < Groups; GroupN++) {
+        PJsonVal RowVal = TJsonVal::NewArr();
+        for (int KeyColN = 0; KeyColN < Keys; KeyColN++) {
+            RowVal->AddToArr(KeyColV[KeyColN].GetJson(GroupKeyV[GroupN * Keys + KeyColN]));
+        }
+        for (int ValColN = 0; ValColN < ValColV.Len(); ValColN++) {
+            RowVal->AddToArr(GetValJson(GroupN, ValColN));
+        }
+        RowsVal->AddToArr(RowVal);
+    }
+    ResVal->AddToObj("rows", RowsVal);
+    return ResVal;
+}
+
 }
 
 namespace TStreamAggrs {
@@ -578,6 +1449,22 @@ void TTimeSeriesTick::OnAddRec(const TRec& Rec) {
     InitP = true;
 }
 
+void TTimeSeriesTick::OnAddRecs(const PRecSet& RecSet) {
+    const int Recs = RecSet->GetRecs();
+    if (Recs == 0) { return; }
+    // extract all values once, dependent aggregates read them from here
+    BatchValV.Reserve(Recs, Recs); BatchTmMSecsV.Reserve(Recs, Recs);
+    for (int RecN = 0; RecN < Recs; RecN++) {
+        const TRec Rec = RecSet->GetRec(RecN);
+        BatchValV[RecN] = ValReader.GetFlt(Rec);
+        BatchTmMSecsV[RecN] = Rec.GetFieldTmMSecs(TimeFieldId);
+    }
+    // last record is the current tick
+    TickVal = BatchValV.Last();
+    TmMSecs = BatchTmMSecsV.Last();
+    InitP = true;
+}
+
 void TTimeSeriesTick::OnTime(const uint64& Time) {
     TmMSecs = Time;
 }
@@ -710,12 +1597,23 @@ void TEma::OnStep() {
     }
 }
 
+void TEma::OnAddRecs(const PRecSet& RecSet) {
+    if (InAggrBatch.Empty()) { TStreamAggr::OnAddRecs(RecSet); return; }
+    if (!InAggr->IsInit()) { return; }
+    TFltV ValV; InAggrBatch->GetBatchFltV(ValV);
+    TUInt64V TmMSecsV; InAggrBatch->GetBatchTmMSecsV(TmMSecsV);
+    for (int ValN = 0; ValN < ValV.Len(); ValN++) {
+        Ema.Update(ValV[ValN], TmMSecsV[ValN]);
+    }
+}
+
 TEma::TEma(const TWPt<TBase>& Base, const PJsonVal& ParamVal):
         TStreamAggr(Base, ParamVal), Ema(ParamVal) {
 
     InAggr = ParseAggr(ParamVal, "inAggr");
     InAggrTm = Cast<TStreamAggrOut::ITm>(InAggr);
     InAggrFlt = Cast<TStreamAggrOut::IFlt>(InAggr);
+    InAggrBatch = Cast<TStreamAggrOut::IFltTmBatch>(InAggr, false);
 }
 
 PStreamAggr TEma::New(const TWPt<TBase>& Base, const PJsonVal& ParamVal) {
@@ -1034,6 +1932,13 @@ TMerger::TMerger(const TWPt<TQm::TBase>& Base, const PJsonVal& ParamVal):
     }
     /// we are almost done
     InitMerger(Base, OutStoreNm, TimeFieldNm, CreateStoreP, Past, InterpNmV);
+    // optional reordering of input points arriving out of order
+    if (ParamVal->IsObjKey("allowedLateness")) {
+        ReorderP = true;
+        const int MxPending = ParamVal->GetObjInt("maxPending", TInt::Mx);
+        QmAssertR(MxPending > 0, "[TMerger] maxPending must be positive");
+        ReorderBuf = TSignalProc::TReorderBuf<TInPt>(ParamVal->GetObjUInt64("allowedLateness"), MxPending);
+    }
 }
 
 PStreamAggr TMerger::New(const TWPt<TBase>& Base, const PJsonVal& ParamVal) {
@@ -1066,17 +1971,38 @@ void TMerger::CreateStore(const TStr& NewStoreNm, const TStr& NewTimeFieldNm){
 }
 
 void TMerger::LoadState(TSIn& SIn) {
-    TSignalProc::TLinkedBuffer<TUInt64> _Buff(SIn);
-    Buff = _Buff;
+    // state saved before reordering and input lags starts with the (non-negative)
+    // length of the buffer, newer state starts with the format marker -1
+    const int Format = TInt(SIn);
+    if (Format >= 0) {
+        Buff.Clr();
+        for (int ValN = 0; ValN < Format; ValN++) { Buff.Add(TUInt64(SIn)); }
+    } else {
+        TSignalProc::TLinkedBuffer<TUInt64> _Buff(SIn);
+        Buff = _Buff;
+    }
     SignalsPresentV.Load(SIn);
     SignalsPresent.Load(SIn);
     NextInterpTm.Load(SIn);
     PrevInterpTm.Load(SIn);
     OnlyPast.Load(SIn);
     PrevInterpPt.Load(SIn);
+    if (Format < 0) {
+        ReorderP.Load(SIn);
+        ReorderBuf.Load(SIn);
+        InLastTmV.Load(SIn);
+        LastTm.Load(SIn);
+    } else {
+        // nothing pending, lags are reported again after the next point of each input
+        ReorderBuf.Clr();
+        InLastTmV.PutAll(0);
+        LastTm = 0;
+    }
+    ReadyInterps = 0;
 }
 
 void TMerger::SaveState(TSOut& SOut) const {
+    TInt(-1).Save(SOut);
     Buff.Save(SOut);
     SignalsPresentV.Save(SOut);
     SignalsPresent.Save(SOut);
@@ -1084,12 +2010,27 @@ void TMerger::SaveState(TSOut& SOut) const {
     PrevInterpTm.Save(SOut);
     OnlyPast.Save(SOut);
     PrevInterpPt.Save(SOut);
+    ReorderP.Save(SOut);
+    ReorderBuf.Save(SOut);
+    InLastTmV.Save(SOut);
+    LastTm.Save(SOut);
 }
 
 PJsonVal TMerger::SaveJson(const int& Limit) const {
     PJsonVal Val = TJsonVal::NewObj();
     Val->AddToObj("Val", 0);
     Val->AddToObj("Time", 0);
+    if (ReorderP) {
+        Val->AddToObj("pending", ReorderBuf.Len());
+        Val->AddToObj("late", ReorderBuf.GetLateVals());
+    }
+    // how far behind the newest merged point is each input
+    PJsonVal LagVal = TJsonVal::NewObj();
+    for (int InterpN = 0; InterpN < NInFlds; InterpN++) {
+        if (InLastTmV[InterpN] == 0) { continue; }
+        LagVal->AddToObj(OutFldNmV[InterpN], (uint64)(LastTm - InLastTmV[InterpN]));
+    }
+    Val->AddToObj("lag", LagVal);
     return Val;
 }
 
@@ -1143,7 +2084,7 @@ void TMerger::InitMerger(const TWPt<TQm::TBase> Base, const TStr& OutStoreNm,
         OutStore = Base->GetStoreByStoreNm(OutStoreNm);
     }
 
-    NextInterpTm = TUInt64::Mx;
+    SetNextInterpTm(TUInt64::Mx);
     PrevInterpTm = TUInt64::Mx;
     NInFlds = InterpV.Len();
 
@@ -1152,6 +2093,7 @@ void TMerger::InitMerger(const TWPt<TQm::TBase> Base, const TStr& OutStoreNm,
     PrevInterpPt = TTriple<TUInt64, TFltV, TUInt64>(TUInt64::Mx, TFltV(), TUInt64::Mx);
 
     TimeFieldId = OutStore->GetFieldId(OutTmFieldNm);
+    SourceJoinId = OutStore->IsJoinNm("source") ? OutStore->GetJoinId("source") : -1;
 
     QmAssertR(InterpV.Len() == FieldMapV.Len(), "Invalid number of interpolators: " + TInt::GetStr(InterpV.Len()));
 
@@ -1161,6 +2103,7 @@ void TMerger::InitMerger(const TWPt<TQm::TBase> Base, const TStr& OutStoreNm,
     }
 
     SignalsPresentV.Gen(NInFlds);
+    InLastTmV.Gen(NInFlds);
 }
 
 void TMerger::OnAddRec(const TQm::TRec& Rec) {
@@ -1178,8 +2121,32 @@ void TMerger::OnAddRec(const TQm::TRec& Rec) {
     }
 }
 
+void TMerger::OnAddRecs(const TQm::PRecSet& RecSet) {
+    if (RecSet->Empty()) { return; }
+    // all records in a batch come from the same store
+    const uint StoreId = RecSet->GetStoreId();
+    const TIntSet& FieldMapIdxSet = StoreIdFldIdVH.GetDat(StoreId);
+    for (int RecN = 0; RecN < RecSet->GetRecs(); RecN++) {
+        const TRec Rec = RecSet->GetRec(RecN);
+        int KeyId = FieldMapIdxSet.FFirstKeyId();
+        while (FieldMapIdxSet.FNextKeyId(KeyId)) {
+            OnAddRec(Rec, FieldMapIdxSet.GetKey(KeyId));
+        }
+    }
+}
+
 void TMerger::OnTime(const uint64& TmMsec) {
-    QmAssertR(false, "Merger::OnTime(const uint64& TmMsec) not supported.");
+    QmAssertR(ReorderP, "Merger::OnTime(const uint64& TmMsec) only supported with allowedLateness.");
+    // time passed without new points, move the watermark
+    const uint64 AllowedLatenessMSecs = ReorderBuf.GetAllowedLatenessMSecs();
+    if (TmMsec >= AllowedLatenessMSecs) { ReorderBuf.SetWatermarkMSecs(TmMsec - AllowedLatenessMSecs); }
+    MergeReordered();
+}
+
+void TMerger::Flush() {
+    if (!ReorderP) { return; }
+    ReorderBuf.SetWatermarkMx();
+    MergeReordered();
 }
 
 void TMerger::OnStep() {
@@ -1202,9 +2169,28 @@ void TMerger::OnAddRec(const TQm::TRec& Rec, const int& FieldMapIdx) {
     // extract the value
     const TFlt RecVal = JoinRec.GetFieldFlt(FieldMapV[FieldMapIdx].InFldId);
 
+    if (ReorderP) {
+        // points older than the watermark are ignored, merged records cannot be changed anymore
+        ReorderBuf.Add(RecTm, TInPt(InterpIdx, RecVal, Rec.GetRecId()));
+        MergeReordered();
+    } else {
+        Merge(InterpIdx, RecTm, RecVal, Rec.GetRecId());
+    }
+}
+
+void TMerger::MergeReordered() {
+    uint64 RecTm; TInPt InPt;
+    while (ReorderBuf.Next(RecTm, InPt)) {
+        Merge(InPt.Val1, RecTm, InPt.Val2, InPt.Val3);
+    }
+}
+
+void TMerger::Merge(const int& InterpIdx, const uint64& RecTm, const TFlt& RecVal, const uint64& RecId) {
     QmAssertR(NextInterpTm == TUInt64::Mx || RecTm >= NextInterpTm, "Timestamp of the next record is lower then the current interpolation time!");
 
     AddToBuff(InterpIdx, RecTm, RecVal);
+    InLastTmV[InterpIdx] = RecTm;
+    if (RecTm > LastTm) { LastTm = RecTm; }
 
     // checks
     if (!CheckInitialized(InterpIdx, RecTm)) { return; }
@@ -1219,7 +2205,7 @@ void TMerger::OnAddRec(const TQm::TRec& Rec, const int& FieldMapIdx) {
         }
 
         // add the record to the output store
-        AddRec(ValV, NextInterpTm, Rec);
+        AddRec(ValV, NextInterpTm, RecId);
         // update the next interpolation time
         UpdateNextInterpTm();
     }
@@ -1245,30 +2231,30 @@ void TMerger::AddToStore(const TFltV& InterpValV, const uint64 InterpTm, const u
     }
 
     uint64 NewRecId = OutStore->AddRec(JsonVal);
-    if (OutStore->IsJoinNm("source")) {
-        OutStore->AddJoin(OutStore->GetJoinId("source"), NewRecId, RecId, 1);
+    if (SourceJoinId != -1) {
+        OutStore->AddJoin(SourceJoinId, NewRecId, RecId, 1);
     }
 }
 
-void TMerger::AddRec(const TFltV& InterpValV, const uint64 InterpTm, const TQm::TRec& Rec) {
+void TMerger::AddRec(const TFltV& InterpValV, const uint64 InterpTm, const uint64& RecId) {
     if (OnlyPast) {
         // we need to wait until we get at least one future point before
         // committing the interpolation
         if (Buff.Len() > 1) {   // we already have a future point
-            AddToStore(InterpValV, InterpTm, Rec.GetRecId());
+            AddToStore(InterpValV, InterpTm, RecId);
             PrevInterpPt = TTriple<TUInt64, TFltV, TUInt64>(TUInt64::Mx, TFltV(), TUInt64::Mx);
         }
         else if (PrevInterpPt.Val1 != TUInt64::Mx && PrevInterpPt.Val1 != InterpTm) {
             AddToStore(PrevInterpPt.Val2, PrevInterpPt.Val1, PrevInterpPt.Val3);
-            PrevInterpPt = TTriple<TUInt64, TFltV, TUInt64>(InterpTm, InterpValV, Rec.GetRecId());
+            PrevInterpPt = TTriple<TUInt64, TFltV, TUInt64>(InterpTm, InterpValV, RecId);
         }
         else {
             // don't add to store, we need to see if the next value will have
             // the same time stamp
-            PrevInterpPt = TTriple<TUInt64, TFltV, TUInt64>(InterpTm, InterpValV, Rec.GetRecId());
+            PrevInterpPt = TTriple<TUInt64, TFltV, TUInt64>(InterpTm, InterpValV, RecId);
         }
     } else {
-        AddToStore(InterpValV, InterpTm, Rec.GetRecId());
+        AddToStore(InterpValV, InterpTm, RecId);
     }
 }
 
@@ -1297,8 +2283,9 @@ bool TMerger::CanInterpolate() {
     if (NextInterpTm == TUInt64::Mx) { return false; }  // this happens when all time series had the same timestamp in the previous iteration
     if (!OnlyPast && NextInterpTm == PrevInterpTm) { return false; }    // avoid duplicates when extrapolating future values
 
-    for (int i = 0; i < NInFlds; i++) {
-        if (!InterpV[i]->CanInterpolate(NextInterpTm)) {
+    // only the first interpolator which was not ready can block us
+    for (; ReadyInterps < NInFlds; ReadyInterps++) {
+        if (!InterpV[ReadyInterps]->CanInterpolate(NextInterpTm)) {
             return false;
         }
     }
@@ -1308,7 +2295,7 @@ bool TMerger::CanInterpolate() {
 
 void TMerger::UpdateNextInterpTm() {
     PrevInterpTm = NextInterpTm;
-    NextInterpTm = Buff.Len() > 1 ? Buff.GetOldest(1).Val : TUInt64::Mx;
+    SetNextInterpTm(Buff.Len() > 1 ? Buff.GetOldest(1).Val : TUInt64::Mx);
 
     QmAssertR(PrevInterpTm <= NextInterpTm, "The previous interpolation time is greater than the current interpolation time current: " + TUInt64::GetStr(PrevInterpTm) + ", next: " + TUInt64::GetHexStr(NextInterpTm) + "TMerger::UpdateNextInterpTm()");
 
@@ -1329,7 +2316,7 @@ bool TMerger::CheckInitialized(const int& InterpIdx, const uint64& RecTm) {
 
         if (!AllSignalsPresent()) { return false; } // should not continue
 
-        NextInterpTm = RecTm;
+        SetNextInterpTm(RecTm);
         ShiftBuff();
     }
 
@@ -1341,12 +2328,12 @@ void TMerger::HandleEdgeCases(const uint64& RecTm) {
     // the next interpolation time is not set
     if (NextInterpTm == TUInt64::Mx) {
         EAssertR(Buff.Len() == 1, "TMerger::HandleEdgeCases: The buffer is not empty even though it should be!");
-        NextInterpTm = RecTm;
+        SetNextInterpTm(RecTm);
         UpdateInterpolators();
     }
     // duplicate value when extrapolating future
     if (!OnlyPast && NextInterpTm == PrevInterpTm) {
-        NextInterpTm = TUInt64::Mx;
+        SetNextInterpTm(TUInt64::Mx);
         Buff.DelOldest();
     }
 }
@@ -1355,6 +2342,7 @@ void TMerger::HandleEdgeCases(const uint64& RecTm) {
 // Resampler
 void TResampler::OnAddRec(const TRec& Rec) {
     QmAssertR(Rec.GetStoreId() == InStore->GetStoreId(), "Wrong store calling OnAddRec in Resampler");
+    if (ColumnarP) { OnAddRecColumnar(Rec); return; }
     // get record time
     const uint64 RecTmMSecs = Rec.GetFieldTmMSecs(TimeFieldId);
 
@@ -1398,8 +2386,8 @@ void TResampler::OnAddRec(const TRec& Rec) {
         //TODO use TRec instead of PJsonVal
         // add new record
         uint64 NewRecId = OutStore->AddRec(JsonVal);
-        if (OutStore->IsJoinNm("source")) {
-            OutStore->AddJoin(OutStore->GetJoinId("source"), NewRecId, Rec.GetRecId(), 1);
+        if (SourceJoinId != -1) {
+            OutStore->AddJoin(SourceJoinId, NewRecId, Rec.GetRecId(), 1);
         }
 
         InterpPointMSecs += IntervalMSecs;
@@ -1408,6 +2396,91 @@ void TResampler::OnAddRec(const TRec& Rec) {
     RefreshInterpolators(RecTmMSecs);
 }
 
+void TResampler::OnAddRecColumnar(const TRec& Rec) {
+    const uint64 RecTmMSecs = Rec.GetFieldTmMSecs(TimeFieldId);
+    const int Cols = ColFieldNV.Len();
+    // same timestamp is only allowed with the same values, as with interpolators
+    if (Points > 0 && RecTmMSecs == LastTmMSecs) {
+        for (int ColN = 0; ColN < Cols; ColN++) {
+            QmAssertR(Rec.GetFieldFlt(InFieldIdV[ColFieldNV[ColN]]) == LastValV[ColN],
+                "TResampler: new record has the same timestamp and different values as the last one!");
+        }
+        return;
+    }
+    QmAssertR(Points == 0 || RecTmMSecs > LastTmMSecs, "TResampler: new record has a timestamp lower then the last one!");
+    // the last point becomes the previous one
+    if (Points > 0) { PrevTmMSecs = LastTmMSecs; PrevValV.Swap(LastValV); }
+    LastTmMSecs = RecTmMSecs;
+    for (int ColN = 0; ColN < Cols; ColN++) {
+        LastValV[ColN] = Rec.GetFieldFlt(InFieldIdV[ColFieldNV[ColN]]);
+    }
+    if (Points < 2) { Points++; }
+
+    // only do this first time when interpolation time not defined
+    if (InterpPointMSecs == 0) { InterpPointMSecs = RecTmMSecs; }
+    // ticks before the first point can never be interpolated
+    const uint64 SpanStartMSecs = (Points > 1) ? PrevTmMSecs : LastTmMSecs;
+    if (InterpPointMSecs < SpanStartMSecs) {
+        if (!UpdatedP) {
+            InfoLog("Warning: resampler: start interpolation time is lower than the first record time, cannot interpolate. If future timestamps will keep increasing it might be possible that the resampler will be stuck and unable to interpolate.");
+        }
+        UpdatedP = true;
+        return;
+    }
+    UpdatedP = true;
+    if (InterpPointMSecs > RecTmMSecs) { return; }
+
+    // interpolate ticks up to the new point, in spans which keep SpanValV small
+    const TStr& TimeFieldNm = InStore->GetFieldNm(TimeFieldId);
+    // other fields are taken from the existing record, same for all new records
+    PJsonVal JsonVal = Rec.GetJson(GetBase(), true, false, false, false, false);
+    const uint64 SpanTicks = (uint64)TInt::GetMx(1, 0x10000 / TInt::GetMx(1, Cols));
+    uint64 Ticks = (RecTmMSecs - InterpPointMSecs) / IntervalMSecs + 1;
+    while (Ticks > 0) {
+        const int Span = (int)TMath::Mn(Ticks, SpanTicks);
+        InterpolateSpan(InterpPointMSecs, Span);
+        for (int TickN = 0; TickN < Span; TickN++) {
+            JsonVal->AddToObj(TimeFieldNm, TTm::GetTmFromMSecs(InterpPointMSecs).GetWebLogDateTimeStr(true, "T", true));
+            const TFlt* ValV = SpanValV.BegI() + TickN * Cols;
+            for (int ColN = 0; ColN < Cols; ColN++) {
+                EAssertR(!TFlt::IsNan(ValV[ColN]), "TResampler: interpolated to a NaN value!");
+                JsonVal->AddToObj(ColFieldNmV[ColN], ValV[ColN]);
+            }
+            const uint64 NewRecId = OutStore->AddRec(JsonVal);
+            if (SourceJoinId != -1) {
+                OutStore->AddJoin(SourceJoinId, NewRecId, Rec.GetRecId(), 1);
+            }
+            InterpPointMSecs += IntervalMSecs;
+        }
+        Ticks -= Span;
+    }
+}
+
+void TResampler::InterpolateSpan(const uint64& StartMSecs, const int& Ticks) {
+    const int Cols = ColFieldNV.Len();
+    SpanValV.Gen(Ticks * Cols, Ticks * Cols);
+    const TFlt* PrevV = PrevValV.BegI();
+    const TFlt* LastV = LastValV.BegI();
+    for (int TickN = 0; TickN < Ticks; TickN++) {
+        const uint64 TickMSecs = StartMSecs + TickN * IntervalMSecs;
+        TFlt* ValV = SpanValV.BegI() + TickN * Cols;
+        if (TickMSecs == LastTmMSecs) {
+            // at the last point, previous point fields keep the value before it (when there is one)
+            const TFlt* PrevPtV = (Points > 1) ? PrevV : LastV;
+            for (int ColN = 0; ColN < LinearFlds; ColN++) { ValV[ColN] = LastV[ColN]; }
+            for (int ColN = LinearFlds; ColN < LinearFlds + PrevFlds; ColN++) { ValV[ColN] = PrevPtV[ColN]; }
+            for (int ColN = LinearFlds + PrevFlds; ColN < Cols; ColN++) { ValV[ColN] = LastV[ColN]; }
+        } else {
+            // between the previous and the last point, same weight for all linear fields
+            const double Weight = (double)(TickMSecs - PrevTmMSecs) / (LastTmMSecs - PrevTmMSecs);
+            for (int ColN = 0; ColN < LinearFlds; ColN++) {
+                ValV[ColN] = PrevV[ColN] + Weight * (LastV[ColN] - PrevV[ColN]);
+            }
+            for (int ColN = LinearFlds; ColN < Cols; ColN++) { ValV[ColN] = PrevV[ColN]; }
+        }
+    }
+}
+
 void TResampler::OnTime(const uint64& TmMsec) { QmAssertR(false, "TResampler::OnTime(const uint64& TmMsec): not supported."); }
 void TResampler::OnStep() { QmAssertR(false, "TResampler::OnStep(): should not be executed."); }
 
@@ -1488,6 +2561,25 @@ TResampler::TResampler(const TWPt<TBase>& Base, const PJsonVal& ParamVal) : TStr
         InterpPointMSecs = TTm::GetMSecsFromTm(StartTm);
     }
     IntervalMSecs = TJsonVal::GetMSecsFromJsonVal(ParamVal->GetObjKey("interval"));
+    SourceJoinId = OutStore->IsJoinNm("source") ? OutStore->GetJoinId("source") : -1;
+    // columnar mode keeps values of all fields together, grouped by interpolator type
+    ColumnarP = ParamVal->GetObjBool("columnar", false);
+    if (ColumnarP) {
+        const TStr TypeNmV[] = { TSignalProc::TLinear::GetType(),
+            TSignalProc::TPreviousPoint::GetType(), TSignalProc::TCurrentPoint::GetType() };
+        for (const TStr& TypeNm : TypeNmV) {
+            for (int FieldN = 0; FieldN < FieldArrVal->GetArrVals(); FieldN++) {
+                if (FieldArrVal->GetArrVal(FieldN)->GetObjStr("interpolator") != TypeNm) { continue; }
+                ColFieldNV.Add(FieldN);
+                ColFieldNmV.Add(InStore->GetFieldNm(InFieldIdV[FieldN]));
+            }
+            if (TypeNm == TSignalProc::TLinear::GetType()) { LinearFlds = ColFieldNV.Len(); }
+            else if (TypeNm == TSignalProc::TPreviousPoint::GetType()) { PrevFlds = ColFieldNV.Len() - LinearFlds; }
+        }
+        QmAssertR(ColFieldNV.Len() == InFieldIdV.Len(), "TResampler: columnar mode supports only "
+            "linear, previous and current point interpolators");
+        PrevValV.Gen(ColFieldNV.Len()); LastValV.Gen(ColFieldNV.Len());
+    }
 }
 
 PStreamAggr TResampler::New(const TWPt<TBase>& Base, const PJsonVal& ParamVal) {
@@ -1495,15 +2587,42 @@ PStreamAggr TResampler::New(const TWPt<TBase>& Base, const PJsonVal& ParamVal) {
 }
 
 void TResampler::LoadState(TSIn& SIn) {
-    InterpolatorV.Load(SIn);
+    // state saved before the columnar mode starts with the (non-negative) capacity
+    // of the vector of interpolators, newer state starts with the format marker -1
+    const int Format = TInt(SIn);
+    if (Format >= 0) {
+        const int Interpolators = TInt(SIn); InterpolatorV.Gen(Interpolators);
+        for (int InterpolatorN = 0; InterpolatorN < Interpolators; InterpolatorN++) {
+            InterpolatorV[InterpolatorN] = TSignalProc::PInterpolator(SIn);
+        }
+    } else {
+        InterpolatorV.Load(SIn);
+    }
     InterpPointMSecs.Load(SIn);
     UpdatedP.Load(SIn);
+    if (Format < 0) {
+        Points.Load(SIn);
+        PrevTmMSecs.Load(SIn);
+        LastTmMSecs.Load(SIn);
+        PrevValV.Load(SIn);
+        LastValV.Load(SIn);
+    } else {
+        // columnar mode did not exist, it starts without input points
+        Points = 0; PrevTmMSecs = 0; LastTmMSecs = 0;
+        PrevValV.PutAll(0.0); LastValV.PutAll(0.0);
+    }
 }
 
 void TResampler::SaveState(TSOut& SOut) const {
+    TInt(-1).Save(SOut);
     InterpolatorV.Save(SOut);
     InterpPointMSecs.Save(SOut);
     UpdatedP.Save(SOut);
+    Points.Save(SOut);
+    PrevTmMSecs.Save(SOut);
+    LastTmMSecs.Save(SOut);
+    PrevValV.Save(SOut);
+    LastValV.Save(SOut);
 }
 
 PJsonVal TResampler::SaveJson(const int& Limit) const {
@@ -1512,6 +2631,100 @@ PJsonVal TResampler::SaveJson(const int& Limit) const {
 }
 
 
+
+///////////////////////////////
+// Reorder buffer
+TReorderBuffer::TReorderBuffer(const TWPt<TBase>& Base, const PJsonVal& ParamVal): TStreamAggr(Base, ParamVal) {
+    const TStr InStoreNm = ParamVal->GetObjStr("store");
+    const TStr OutStoreNm = ParamVal->GetObjStr("outStore");
+    QmAssertR(InStoreNm != OutStoreNm, "[TReorderBuffer] Input and output store should not be the same!");
+    InStore = Base->GetStoreByStoreNm(InStoreNm);
+    OutStore = Base->GetStoreByStoreNm(OutStoreNm);
+    // time field
+    const TStr TimeFieldNm = ParamVal->GetObjStr("timestamp");
+    TimeFieldId = InStore->GetFieldId(TimeFieldNm);
+    QmAssertR(InStore->GetFieldDesc(TimeFieldId).IsTm(), "[TReorderBuffer] field " + TimeFieldNm + " not of type 'datetime'");
+    QmAssertR(OutStore->IsFieldNm(TimeFieldNm), "[TReorderBuffer] output store has no field " + TimeFieldNm);
+    // fields present in both stores
+    for (int FieldId = 0; FieldId < InStore->GetFields(); FieldId++) {
+        const TFieldDesc& FieldDesc = InStore->GetFieldDesc(FieldId);
+        if (FieldDesc.IsInternal() || !OutStore->IsFieldNm(FieldDesc.GetFieldNm())) { continue; }
+        FieldIdPrV.Add(TIntPr(FieldId, OutStore->GetFieldId(FieldDesc.GetFieldNm())));
+    }
+    // watermark parameters
+    const uint64 AllowedLatenessMSecs = ParamVal->GetObjUInt64("allowedLateness", 0);
+    const int MxPending = ParamVal->GetObjInt("maxPending", TInt::Mx);
+    QmAssertR(MxPending > 0, "[TReorderBuffer] maxPending must be positive");
+    ReorderBuf = TSignalProc::TReorderBuf<TUInt64>(AllowedLatenessMSecs, MxPending);
+    const TStr LateNm = ParamVal->GetObjStr("lateRecords", "drop");
+    QmAssertR(LateNm == "drop" || LateNm == "forward", "[TReorderBuffer] Unknown lateRecords value " + LateNm);
+    ForwardLateP = (LateNm == "forward");
+}
+
+PStreamAggr TReorderBuffer::New(const TWPt<TBase>& Base, const PJsonVal& ParamVal) {
+    return new TReorderBuffer(Base, ParamVal);
+}
+
+void TReorderBuffer::AddToOutStore(const uint64& RecId) {
+    // record is read when released, so it must still be in the input store
+    QmAssertR(InStore->IsRecId(RecId), "[TReorderBuffer] Record " + TUInt64::GetStr(RecId) +
+        " no longer in the input store, its window is too small for allowedLateness");
+    PJsonVal RecVal = TJsonVal::NewObj();
+    for (const TIntPr& FieldIdPr : FieldIdPrV) {
+        if (InStore->IsFieldNull(RecId, FieldIdPr.Val1)) { continue; }
+        RecVal->AddToObj(OutStore->GetFieldNm(FieldIdPr.Val2), InStore->GetFieldJson(RecId, FieldIdPr.Val1));
+    }
+    OutStore->AddRec(RecVal);
+}
+
+void TReorderBuffer::Release() {
+    uint64 TmMSecs; TUInt64 RecId;
+    while (ReorderBuf.Next(TmMSecs, RecId)) { AddToOutStore(RecId); }
+}
+
+void TReorderBuffer::OnAddRec(const TRec& Rec) {
+    QmAssertR(Rec.GetStoreId() == InStore->GetStoreId(), "[TReorderBuffer] Wrong store calling OnAddRec");
+    const uint64 RecId = Rec.GetRecId();
+    if (!ReorderBuf.Add(Rec.GetFieldTmMSecs(TimeFieldId), RecId) && ForwardLateP) {
+        AddToOutStore(RecId); ForwardedLate++;
+    }
+    Release();
+}
+
+void TReorderBuffer::OnTime(const uint64& TmMsec) {
+    const uint64 AllowedLatenessMSecs = ReorderBuf.GetAllowedLatenessMSecs();
+    if (TmMsec >= AllowedLatenessMSecs) { ReorderBuf.SetWatermarkMSecs(TmMsec - AllowedLatenessMSecs); }
+    Release();
+}
+
+void TReorderBuffer::Flush() {
+    ReorderBuf.SetWatermarkMx();
+    Release();
+}
+
+void TReorderBuffer::Reset() {
+    ReorderBuf.Clr();
+    ForwardedLate = 0;
+}
+
+void TReorderBuffer::LoadState(TSIn& SIn) {
+    ReorderBuf.Load(SIn);
+    ForwardedLate.Load(SIn);
+}
+
+void TReorderBuffer::SaveState(TSOut& SOut) const {
+    ReorderBuf.Save(SOut);
+    ForwardedLate.Save(SOut);
+}
+
+PJsonVal TReorderBuffer::SaveJson(const int& Limit) const {
+    PJsonVal Val = TJsonVal::NewObj();
+    Val->AddToObj("pending", ReorderBuf.Len());
+    Val->AddToObj("watermark", TTm::GetTmFromMSecs(ReorderBuf.GetWatermarkMSecs()).GetWebLogDateTimeStr(true, "T"));
+    Val->AddToObj("late", ReorderBuf.GetLateVals());
+    Val->AddToObj("forwarded", ForwardedLate);
+    return Val;
+}
 ///////////////////////////////
 // Dense Feature Extractor Stream Aggregate (extracts TFltV from records)
 void TFtrExtAggr::OnAddRec(const TRec& Rec) {
@@ -1560,6 +2773,20 @@ void TOnlineHistogram::OnStep() {
     }
 }
 
+void TOnlineHistogram::OnAddRecs(const PRecSet& RecSet) {
+    if (BufferedP) {
+        // input window reports all the batch changes at once
+        OnStep();
+    } else if (!InAggrBatch.Empty()) {
+        TFltV ValV; InAggrBatch->GetBatchFltV(ValV);
+        for (int ValN = 0; ValN < ValV.Len(); ValN++) {
+            Model.Increment(ValV[ValN]);
+        }
+    } else {
+        TStreamAggr::OnAddRecs(RecSet);
+    }
+}
+
 TOnlineHistogram::TOnlineHistogram(const TWPt<TBase>& Base, const PJsonVal& ParamVal):
         TStreamAggr(Base, ParamVal), Model(ParamVal) {
     
@@ -1567,6 +2794,7 @@ TOnlineHistogram::TOnlineHistogram(const TWPt<TBase>& Base, const PJsonVal& Para
     InAggr = ParseAggr(ParamVal, "inAggr");
     InAggrFlt = Cast<TStreamAggrOut::IFlt>(InAggr, false);
     InAggrFltIO = Cast<TStreamAggrOut::IFltIO>(InAggr, false);   
+    InAggrBatch = Cast<TStreamAggrOut::IFltTmBatch>(InAggr, false);
     /// Check if at least one cast is OK
     if (!InAggrFlt.Empty()) {
         // all cool
@@ -1605,11 +2833,20 @@ void TTDigest::Add(const TFlt& Val) {
     }
 }
 
+void TTDigest::OnAddRecs(const PRecSet& RecSet) {
+    if (InAggrBatch.Empty()) { TStreamAggr::OnAddRecs(RecSet); return; }
+    TFltV ValV; InAggrBatch->GetBatchFltV(ValV);
+    for (int ValN = 0; ValN < ValV.Len(); ValN++) {
+        Add(ValV[ValN]);
+    }
+}
+
 TTDigest::TTDigest(const TWPt<TBase>& Base, const PJsonVal& ParamVal):
         TStreamAggr(Base, ParamVal), Model(ParamVal) {
 
     InAggr = ParseAggr(ParamVal, "inAggr");
     InAggrFlt = Cast<TStreamAggrOut::IFlt>(InAggr);
+    InAggrBatch = Cast<TStreamAggrOut::IFltTmBatch>(InAggr, false);
     // prase model parameters
     ParamVal->GetObjFltV("quantiles", QuantileV);
 }
@@ -1872,6 +3109,7 @@ void TRecFilterAggr::OnAddRec(const TRec& Rec) {
     for (const PRecFilter& Filter : FilterV) {
         if (!Filter->Filter(Rec)) { return; }
     }
+    Aggr->SetUpdated();
     Aggr->OnAddRec(Rec);
 }
 
@@ -1890,5 +3128,257 @@ TRecFilterAggr::TRecFilterAggr(const TWPt<TBase>& Base, const PJsonVal& ParamVal
     Aggr = ParseAggr(ParamVal, "aggr");
 }
 
+///////////////////////////////
+/// Keyed stream aggregate
+TKeyed::TKeyed(const TWPt<TBase>& Base, const PJsonVal& ParamVal): TStreamAggr(Base, ParamVal) {
+    // input store and fields
+    Store = Base->GetStoreByStoreNm(ParamVal->GetObjStr("store"));
+    const TStr KeyFieldNm = ParamVal->GetObjStr("key");
+    KeyFieldId = Store->GetFieldId(KeyFieldNm);
+    const TStr TimeFieldNm = ParamVal->GetObjStr("timestamp");
+    TimeFieldId = Store->GetFieldId(TimeFieldNm);
+    QmAssertR(Store->GetFieldDesc(TimeFieldId).IsTm(), "[TKeyed] field " + TimeFieldNm + " not of type 'datetime'");
+    const TStr ValFieldNm = ParamVal->GetObjStr("value");
+    const int ValFieldId = Store->GetFieldId(ValFieldNm);
+    ValReader = TFieldReader(Store->GetStoreId(), ValFieldId, Store->GetFieldDesc(ValFieldId));
+    QmAssertR(ValReader.IsFlt(), "[TKeyed] field " + ValFieldNm + " cannot be casted to 'double'");
+    // statistic
+    StatNm = ParamVal->GetObjStr("aggr");
+    if (StatNm == "winBuf") { Stat = ksWinBuf; }
+    else if (StatNm == "sum") { Stat = ksSum; }
+    else if (StatNm == "ma") { Stat = ksMa; }
+    else if (StatNm == "var") { Stat = ksVar; }
+    else if (StatNm == "min") { Stat = ksMin; }
+    else if (StatNm == "max") { Stat = ksMax; }
+    else if (StatNm == "ema") { Stat = ksEma; }
+    else if (StatNm == "tdigest") { Stat = ksTDigest; }
+    else if (StatNm == "histogram") { Stat = ksHist; }
+    else { throw TQmExcept::New("[TKeyed] Unknown aggr " + StatNm); }
+    StatParamVal = ParamVal;
+    WinSizeMSecs = ParamVal->GetObjUInt64("winsize", 0);
+    QmAssertR(WinSizeMSecs > 0 || Stat == ksEma || Stat == ksTDigest || Stat == ksHist,
+        "[TKeyed] aggr " + StatNm + " requires winsize");
+    QmAssertR(WinSizeMSecs == 0 || (Stat != ksEma && Stat != ksTDigest),
+        "[TKeyed] aggr " + StatNm + " cannot forget values, winsize not supported");
+    if (Stat == ksTDigest) { ParamVal->GetObjFltV("quantiles", QuantileV); }
+    // check statistic parameters before the first key
+    if (Stat == ksEma) { TSignalProc::TEma Ema(StatParamVal); }
+    if (Stat == ksHist) { TSignalProc::TOnlineHistogram Hist(StatParamVal); }
+    IdleMSecs = ParamVal->GetObjUInt64("idleTimeout", 0);
+}
+
+PStreamAggr TKeyed::New(const TWPt<TBase>& Base, const PJsonVal& ParamVal) {
+    return new TKeyed(Base, ParamVal);
+}
+
+int TKeyed::AddKey(const TStr& Key) {
+    int SlotN;
+    if (!FreeSlotV.Empty()) {
+        SlotN = FreeSlotV.Last(); FreeSlotV.DelLast();
+        SlotKeyV[SlotN] = Key;
+    } else {
+        SlotN = SlotKeyV.Add(Key);
+        SlotTmMSecsV.Add(0);
+        if (WinSizeMSecs > 0) { SlotWinV.Add(); }
+        switch (Stat) {
+            case ksSum: SumV.Add(); break;
+            case ksMa: MaV.Add(); break;
+            case ksVar: VarV.Add(); break;
+            case ksMin: MinV.Add(); break;
+            case ksMax: MaxV.Add(); break;
+            case ksEma: EmaV.Add(); break;
+            case ksTDigest: TDigestV.Add(); break;
+            case ksHist: HistV.Add(); break;
+            default: break;
+        }
+    }
+    InitSlot(SlotN);
+    KeySlotH.AddDat(Key, SlotN);
+    return SlotN;
+}
+
+void TKeyed::InitSlot(const int& SlotN) {
+    SlotTmMSecsV[SlotN] = 0;
+    if (WinSizeMSecs > 0) { SlotWinV[SlotN].Clr(); }
+    switch (Stat) {
+        case ksSum: SumV[SlotN].Reset(); break;
+        case ksMa: MaV[SlotN].Reset(); break;
+        case ksVar: VarV[SlotN].Reset(); break;
+        case ksMin: MinV[SlotN].Reset(); break;
+        case ksMax: MaxV[SlotN].Reset(); break;
+        case ksEma: EmaV[SlotN] = TSignalProc::TEma(StatParamVal); break;
+        case ksTDigest: TDigestV[SlotN] = TKeyTDigest::New(StatParamVal); break;
+        case ksHist: HistV[SlotN] = TSignalProc::TOnlineHistogram(StatParamVal); break;
+        default: break;
+    }
+}
+
+void TKeyed::DelKey(const TStr& Key) {
+    const int SlotN = KeySlotH.GetDat(Key);
+    KeySlotH.DelKey(Key);
+    SlotKeyV[SlotN].Clr();
+    FreeSlotV.Add(SlotN);
+    // release memory not needed by the free slot
+    if (WinSizeMSecs > 0) { SlotWinV[SlotN] = TSignalProc::TRingBuf<TUInt64FltPr>(); }
+    if (Stat == ksTDigest) { TDigestV[SlotN] = NULL; }
+    if (Stat == ksHist) { HistV[SlotN] = TSignalProc::TOnlineHistogram(); }
+}
+
+void TKeyed::DelIdleKeys() {
+    TStrV IdleKeyV; uint64 MnTmMSecs = TmMSecs;
+    int KeyId = KeySlotH.FFirstKeyId();
+    while (KeySlotH.FNextKeyId(KeyId)) {
+        const uint64 SlotTmMSecs = SlotTmMSecsV[KeySlotH[KeyId]];
+        if (SlotTmMSecs + IdleMSecs < TmMSecs) {
+            IdleKeyV.Add(KeySlotH.GetKey(KeyId));
+        } else if (SlotTmMSecs < MnTmMSecs) {
+            MnTmMSecs = SlotTmMSecs;
+        }
+    }
+    for (const TStr& Key : IdleKeyV) { DelKey(Key); }
+    // next key becomes idle after the oldest remaining one; scanning all the keys
+    // is limited to once per eighth of the timeout
+    NextIdleTmMSecs = TMath::Mx(MnTmMSecs + IdleMSecs + 1, TmMSecs + IdleMSecs / 8);
+}
+
+int TKeyed::GetKeySlotN(const TStr& Key) const {
+    const int KeyId = KeySlotH.GetKeyId(Key);
+    QmAssertR(KeyId != -1, "[TKeyed] Unknown key " + Key);
+    return KeySlotH[KeyId];
+}
+
+void TKeyed::SetTmMSecs(const uint64& _TmMSecs) {
+    if (_TmMSecs > TmMSecs) { TmMSecs = _TmMSecs; }
+    if (IdleMSecs > 0 && TmMSecs >= NextIdleTmMSecs) { DelIdleKeys(); }
+}
+
+void TKeyed::Update(const int& SlotN, const double& Val, const uint64& ValTmMSecs) {
+    if (ValTmMSecs > SlotTmMSecsV[SlotN]) { SlotTmMSecsV[SlotN] = ValTmMSecs; }
+    OutValV.Clr(false); OutTmMSecsV.Clr(false);
+    if (WinSizeMSecs > 0) {
+        // same window as time series window buffer, which follows the last timestamp
+        TSignalProc::TRingBuf<TUInt64FltPr>& WinBuf = SlotWinV[SlotN];
+        WinBuf.Push(TUInt64FltPr(ValTmMSecs, Val));
+        const uint64 LastTmMSecs = SlotTmMSecsV[SlotN];
+        while (!WinBuf.Empty() && WinBuf.Front().Val1 + WinSizeMSecs < LastTmMSecs) {
+            OutValV.Add(WinBuf.Front().Val2); OutTmMSecsV.Add(WinBuf.Front().Val1);
+            WinBuf.PopFront();
+        }
+    }
+    switch (Stat) {
+        case ksSum: SumV[SlotN].Update(Val, ValTmMSecs, OutValV, OutTmMSecsV); break;
+        case ksMa: MaV[SlotN].Update(Val, ValTmMSecs, OutValV, OutTmMSecsV); break;
+        case ksVar: VarV[SlotN].Update(Val, ValTmMSecs, OutValV, OutTmMSecsV); break;
+        case ksMin: MinV[SlotN].Update(Val, ValTmMSecs, OutValV, OutTmMSecsV); break;
+        case ksMax: MaxV[SlotN].Update(Val, ValTmMSecs, OutValV, OutTmMSecsV); break;
+        case ksEma: EmaV[SlotN].Update(Val, ValTmMSecs); break;
+        case ksTDigest: TDigestV[SlotN]->Add(Val); break;
+        case ksHist:
+            HistV[SlotN].Increment(Val);
+            for (const TFlt& OutVal : OutValV) { HistV[SlotN].Decrement(OutVal); }
+            break;
+        default: break;
+    }
+}
+
+void TKeyed::OnAddRec(const TRec& Rec) {
+    if (Rec.IsFieldNull(KeyFieldId) || Rec.IsFieldNull(TimeFieldId)) { return; }
+    const TStr Key = Rec.GetFieldText(KeyFieldId);
+    const uint64 RecTmMSecs = Rec.GetFieldTmMSecs(TimeFieldId);
+    const int KeyId = KeySlotH.GetKeyId(Key);
+    const int SlotN = (KeyId == -1) ? AddKey(Key) : KeySlotH[KeyId].Val;
+    Update(SlotN, ValReader.GetFlt(Rec), RecTmMSecs);
+    SetTmMSecs(RecTmMSecs);
+}
+
+void TKeyed::LoadState(TSIn& SIn) {
+    KeySlotH.Load(SIn);
+    SlotKeyV.Load(SIn);
+    FreeSlotV.Load(SIn);
+    SlotTmMSecsV.Load(SIn);
+    SlotWinV.Load(SIn);
+    SumV.Load(SIn);
+    MaV.Load(SIn);
+    VarV.Load(SIn);
+    MinV.Load(SIn);
+    MaxV.Load(SIn);
+    EmaV.Load(SIn);
+    TDigestV.Load(SIn);
+    HistV.Load(SIn);
+    TmMSecs.Load(SIn);
+    NextIdleTmMSecs.Load(SIn);
+}
+
+void TKeyed::SaveState(TSOut& SOut) const {
+    KeySlotH.Save(SOut);
+    SlotKeyV.Save(SOut);
+    FreeSlotV.Save(SOut);
+    SlotTmMSecsV.Save(SOut);
+    SlotWinV.Save(SOut);
+    SumV.Save(SOut);
+    MaV.Save(SOut);
+    VarV.Save(SOut);
+    MinV.Save(SOut);
+    MaxV.Save(SOut);
+    EmaV.Save(SOut);
+    TDigestV.Save(SOut);
+    HistV.Save(SOut);
+    TmMSecs.Save(SOut);
+    NextIdleTmMSecs.Save(SOut);
+}
+
+void TKeyed::Reset() {
+    KeySlotH.Clr(); SlotKeyV.Clr(); FreeSlotV.Clr(); SlotTmMSecsV.Clr(); SlotWinV.Clr();
+    SumV.Clr(); MaV.Clr(); VarV.Clr(); MinV.Clr(); MaxV.Clr(); EmaV.Clr(); TDigestV.Clr(); HistV.Clr();
+    TmMSecs = 0; NextIdleTmMSecs = 0;
+}
+
+double TKeyed::GetKeyFlt(const TStr& Key) const {
+    const int SlotN = GetKeySlotN(Key);
+    switch (Stat) {
+        case ksSum: return SumV[SlotN].GetValue();
+        case ksMa: return MaV[SlotN].GetValue();
+        case ksVar: return VarV[SlotN].GetValue();
+        case ksMin: return MinV[SlotN].GetValue();
+        case ksMax: return MaxV[SlotN].GetValue();
+        case ksEma: return EmaV[SlotN].GetValue();
+        default: throw TQmExcept::New("[TKeyed] aggr " + StatNm + " has vector values");
+    }
+}
+
+void TKeyed::GetKeyFltV(const TStr& Key, TFltV& ValV) const {
+    const int SlotN = GetKeySlotN(Key);
+    ValV.Clr();
+    if (Stat == ksWinBuf) {
+        const TSignalProc::TRingBuf<TUInt64FltPr>& WinBuf = SlotWinV[SlotN];
+        for (int ValN = 0; ValN < WinBuf.Len(); ValN++) { ValV.Add(WinBuf[ValN].Val2); }
+    } else if (Stat == ksTDigest) {
+        for (const TFlt& Quantile : QuantileV) { ValV.Add(TDigestV[SlotN]->GetQuantile(Quantile)); }
+    } else if (Stat == ksHist) {
+        HistV[SlotN].GetCountV(ValV);
+    } else {
+        ValV.Add(GetKeyFlt(Key));
+    }
+}
+
+PJsonVal TKeyed::SaveJson(const int& Limit) const {
+    PJsonVal Val = TJsonVal::NewObj();
+    Val->AddToObj("keys", KeySlotH.Len());
+    PJsonVal KeysVal = TJsonVal::NewObj();
+    int Keys = 0, KeyId = KeySlotH.FFirstKeyId();
+    while (KeySlotH.FNextKeyId(KeyId) && (Limit < 0 || Keys < Limit)) {
+        const TStr& Key = KeySlotH.GetKey(KeyId);
+        if (Stat == ksWinBuf || Stat == ksTDigest || Stat == ksHist) {
+            TFltV ValV; GetKeyFltV(Key, ValV);
+            KeysVal->AddToObj(Key, TJsonVal::NewArr(ValV));
+        } else {
+            KeysVal->AddToObj(Key, GetKeyFlt(Key));
+        }
+        Keys++;
+    }
+    Val->AddToObj("values", KeysVal);
+    return Val;
+}
+
 } // TStreamAggrs namespace
 } // TQm namespace
@@ -20,18 +20,147 @@
 namespace TQm {
 
 namespace TAggrs {
-    
+
 ///////////////////////////////
-// QMiner-Aggregator-Count
-class TCount : public TAggr {
+/// Type of values consumed by a fused aggregate
+typedef enum { fvtStr, fvtFlt, fvtTm } TFusedValType;
+
+///////////////////////////////
+/// QMiner-Aggregator-Fused.
+/// Aggregate over values of a single field, reachable from the record set store
+/// through a join sequence. Fused aggregates do not read records themselves, but
+/// are fed values by TFusedAggrExec, which reads each record and join path once
+/// and shares extracted values between all aggregates of a query. Aggregate state
+/// is mergeable, so the executor can compute partial states on several threads.
+class TFusedAggr : public TAggr {
 private:
+    /// Join sequence from record set store to the aggregated field
+    TJoinSeq JoinSeq;
+    /// Aggregated field
+    TInt FieldId;
+
+protected:
     //meta-data
     TStr FieldNm;
     TStr JoinPathStr;
+
+    TFusedAggr(const TWPt<TBase>& Base, const TStr& AggrNm, const TJoinSeq& _JoinSeq,
+        const int& _FieldId, const TStr& _FieldNm);
+
+    /// Parse join sequence and field from aggregate query parameters
+    static void ParseJson(const TWPt<TBase>& Base, const uint& StoreId,
+        const PJsonVal& JsonVal, TJoinSeq& JoinSeq, int& FieldId);
+
+public:
+    /// Join sequence from record set store to the aggregated field
+    const TJoinSeq& GetJoinSeq() const { return JoinSeq; }
+    /// Aggregated field
+    int GetFieldId() const { return FieldId; }
+    /// Type of values the aggregate expects
+    virtual TFusedValType GetValType() const = 0;
+
+    /// Add string value to the aggregate
+    virtual void AddStr(const TStr& Str) { Fail; }
+    /// Add numeric value to the aggregate
+    virtual void AddFlt(const double& Flt) { Fail; }
+    /// Add time value to the aggregate
+    virtual void AddTm(const TTm& Tm) { Fail; }
+
+    /// Create aggregate with same parameters and empty state
+    virtual PAggr Clone() const = 0;
+    /// Merge partial state computed by a clone of this aggregate
+    virtual void Merge(const TFusedAggr& Aggr) = 0;
+    /// Finalize state after all values were added
+    virtual void Finish() { }
+};
+
+///////////////////////////////
+/// QMiner-Aggregator-Fused-Executor.
+/// Computes a set of fused aggregates in a single pass over a record set.
+/// Records are processed in batches. For each batch, every distinct join path
+/// is executed once per record and every distinct (join path, field, value type)
+/// column is read once per record. Columns are then fed to the aggregates,
+/// optionally partitioned across threads, each holding partial aggregate states
+/// which are merged at the end.
+class TFusedAggrExec {
+private:
+    /// Values of one field extracted from a batch of records
+    class TCol {
+    public:
+        /// Index of the join path in JoinIdVH
+        TInt JoinN;
+        /// Field from the end store of the join path
+        TInt FieldId;
+        /// Type of extracted values
+        TFusedValType ValType;
+        /// Reader used for extracting values
+        TFieldReader Reader;
+        /// Extracted values, only one vector used, depending on ValType
+        TStrV StrV;
+        TFltV FltV;
+        TTmV TmV;
+
+        TCol() { }
+        TCol(const int& _JoinN, const int& _FieldId, const TFusedValType& _ValType,
+            const TFieldReader& _Reader): JoinN(_JoinN), FieldId(_FieldId),
+                ValType(_ValType), Reader(_Reader) { }
+
+        /// Number of values in the column
+        int GetVals() const;
+        /// Forget values from the previous batch
+        void Clr() { StrV.Clr(false); FltV.Clr(false); TmV.Clr(false); }
+    };
+
+    /// QMiner base
+    TWPt<TBase> Base;
+    /// Record set over which we aggregate
+    PRecSet RecSet;
+    /// Number of threads used for feeding values to aggregates
+    TInt Threads;
+    /// Number of records read before values are fed to aggregates
+    TInt BatchSize;
+
+    /// Distinct join paths used by the aggregates
+    THash<TIntPrV, TInt> JoinIdVH;
+    /// Distinct value columns used by the aggregates
+    TVec<TCol> ColV;
+    /// Aggregates computed by the executor
+    TVec<TWPt<TFusedAggr> > AggrV;
+    /// Column feeding each of the aggregates
+    TIntV AggrColNV;
+
+    /// Get column for the given join path, field and value type, create one if needed
+    int GetColN(const TJoinSeq& JoinSeq, const int& FieldId, const TFusedValType& ValType);
+    /// Read values for the given range of records into the columns
+    void ReadBatch(const int& MnRecN, const int& MxRecN);
+    /// Feed range of column values to an aggregate
+    static void FeedAggr(const TCol& Col, const int& MnValN, const int& MxValN, TFusedAggr& Aggr);
+
+public:
+    /// Create executor for the given record set
+    TFusedAggrExec(const TWPt<TBase>& _Base, const PRecSet& _RecSet,
+        const int& _Threads = 1, const int& _BatchSize = 4096);
+
+    /// Add aggregate to the plan, aggregate state is computed by Exec
+    void AddAggr(const PAggr& Aggr);
+    /// Number of aggregates in the plan
+    int GetAggrs() const { return AggrV.Len(); }
+    /// Number of columns read for each record
+    int GetCols() const { return ColV.Len(); }
+
+    /// Compute all the aggregates added to the plan
+    void Exec();
+};
+
+///////////////////////////////
+// QMiner-Aggregator-Count
+class TCount : public TFusedAggr {
+private:
     // aggregations
     TInt Count;
     TStrH ValH;
 
+    TCount(const TWPt<TBase>& Base, const TStr& AggrNm, const TJoinSeq& JoinSeq, const int& FieldId);
     TCount(const TWPt<TBase>& Base, const TStr& AggrNm, 
         const PRecSet& RecSet, const PFtrExt& FtrExt);
     TCount(const TWPt<TBase>& Base, const TStr& AggrNm,
@@ -45,6 +174,16 @@ public:
             return new TCount(Base, AggrNm, RecSet, KeyId); }
     static PAggr New(const TWPt<TBase>& Base, const TStr& AggrNm,
         const PRecSet& RecSet, const PJsonVal& JsonVal);
+    /// Create aggregate with empty state, computed by TFusedAggrExec. Returns
+    /// empty pointer when aggregating over an index key, which is not fusable.
+    static PAggr NewFused(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const uint& StoreId, const PJsonVal& JsonVal);
+
+    TFusedValType GetValType() const { return fvtStr; }
+    void AddStr(const TStr& Str) { ValH.AddDat(Str)++; Count++; }
+    PAggr Clone() const { return new TCount(GetBase(), GetAggrNm(), GetJoinSeq(), GetFieldId()); }
+    void Merge(const TFusedAggr& Aggr);
+    void Finish() { ValH.SortByDat(false); }
 
     PJsonVal SaveJson() const;
     
@@ -54,24 +193,62 @@ public:
 
 ///////////////////////////////
 // QMiner-Aggregator-Histogram
-class THistogram : public TAggr {
+// Exact by default, keeping all the values until Finish. With parameter "binned"
+// set to true, the state is bounded: running statistics and a fixed number of
+// fine bins, so frequencies and median are approximate.
+class THistogram : public TFusedAggr {
 private:
-    //meta-data
-    TStr FieldNm;
-    TStr JoinPathStr;
-    // aggregations
-    TFlt Sum;
+    //parameters
+    TInt Buckets;
+    TBool BinnedP;
+    // values collected before Finish, needed to get histogram range (exact)
+    TFltV ValV;
+    // aggregations (exact)
     PMom Mom;
     THist Hist;
-
+    // number of fine bins, even, so two neighbouring bins can be joined when the range grows
+    TInt FineBins;
+    // running statistics, merged across partial states
+    TUInt64 Count;
+    TFlt Sum, Mean, M2;
+    TFlt MnVal, MxVal;
+    // fine bins of width FineWidth starting at FineMn, re-bucketed into the
+    // histogram in Finish; empty while all the values are equal to MnVal
+    TFlt FineMn, FineWidth;
+    TUInt64V FineV;
+    // aggregations (binned)
+    TFlt Median;
+    TFlt BucketSize;
+    TUInt64V BucketV;
+
+    THistogram(const TWPt<TBase>& Base, const TStr& AggrNm, const TJoinSeq& JoinSeq,
+        const int& FieldId, const int& _Buckets, const bool& _BinnedP);
     THistogram(const TWPt<TBase>& Base, const TStr& AggrNm,
         const PRecSet& RecSet, const PFtrExt& FtrExt, const int& Buckets);
+
+    /// Fine bin of the value, the value must be inside the bin range
+    int GetFineN(const double& Val) const;
+    /// Double the width of the fine bins until they cover the value and are at least MnWidth wide
+    void ExtendFine(const double& Val, const double& MnWidth);
+    /// Add Cnt copies of the value to the fine bins, called before the statistics are updated
+    void AddFine(const double& Val, const uint64& Cnt);
+    /// Merge running statistics of Cnt values
+    void AddStats(const uint64& Cnt, const double& _Sum, const double& _Mean,
+        const double& _M2, const double& _MnVal, const double& _MxVal);
 public:
     static PAggr New(const TWPt<TBase>& Base, const TStr& AggrNm, 
         const PRecSet& RecSet, const PFtrExt& FtrExt, const int& Buckets) {
             return new THistogram(Base, AggrNm, RecSet, FtrExt, Buckets); }
     static PAggr New(const TWPt<TBase>& Base, const TStr& AggrNm, 
         const PRecSet& RecSet, const PJsonVal& JsonVal);
+    static PAggr NewFused(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const uint& StoreId, const PJsonVal& JsonVal);
+
+    TFusedValType GetValType() const { return fvtFlt; }
+    void AddFlt(const double& Flt);
+    PAggr Clone() const { return new THistogram(GetBase(), GetAggrNm(), GetJoinSeq(), GetFieldId(), Buckets, BinnedP); }
+    void Merge(const TFusedAggr& Aggr);
+    void Finish();
 
     PJsonVal SaveJson() const;
 
@@ -152,11 +329,8 @@ public:
 
 ///////////////////////////////
 // QMiner-Aggregator-TimeLine
-class TTimeLine : public TAggr {
+class TTimeLine : public TFusedAggr {
 private:
-    //meta-data
-    TStr FieldNm;
-    TStr JoinPathStr;
     // aggregations
     TInt Count;
     TStrH AbsDateH;
@@ -165,7 +339,11 @@ private:
     TStrH HourOfDayH;
 
     PJsonVal GetJsonList(const TStrH& StrH) const;
+    // prepare fixed buckets for month, day of week and hour of day
+    void InitH();
 
+    TTimeLine(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const TJoinSeq& JoinSeq, const int& FieldId);
     TTimeLine(const TWPt<TBase>& Base, const TStr& AggrNm, 
         const PRecSet& RecSet, const PFtrExt& FtrExt);
 public:
@@ -174,6 +352,14 @@ public:
         return new TTimeLine(Base, AggrNm, RecSet, FtrExt); }
     static PAggr New(const TWPt<TBase>& Base, const TStr& AggrNm,
         const PRecSet& RecSet, const PJsonVal& JsonVal);
+    static PAggr NewFused(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const uint& StoreId, const PJsonVal& JsonVal);
+
+    TFusedValType GetValType() const { return fvtTm; }
+    void AddTm(const TTm& Tm);
+    PAggr Clone() const { return new TTimeLine(GetBase(), GetAggrNm(), GetJoinSeq(), GetFieldId()); }
+    void Merge(const TFusedAggr& Aggr);
+    void Finish() { AbsDateH.SortByKey(true); }
 
     PJsonVal SaveJson() const;
     
@@ -183,17 +369,16 @@ public:
 
 ///////////////////////////////
 // QMiner-Aggregator-TimeSpan
-class TTimeSpan : public TAggr {
+class TTimeSpan : public TFusedAggr {
 private:
-    //meta-data
-    TStr FieldNm;
-    TStr JoinPathStr;
     // aggregations
     TUInt64 SlotLen;
     TUInt64H CountsH;
 
     PJsonVal GetJsonList(const TUInt64H& DataH) const;
 
+    TTimeSpan(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const TJoinSeq& JoinSeq, const int& FieldId, const uint64 _SlotLen);
     TTimeSpan(const TWPt<TBase>& Base, const TStr& AggrNm,
         const PRecSet& RecSet, const PFtrExt& FtrExt, const uint64 _SlotLen);
 public:
@@ -203,6 +388,14 @@ public:
     }
     static PAggr New(const TWPt<TBase>& Base, const TStr& AggrNm,
         const PRecSet& RecSet, const PJsonVal& JsonVal);
+    static PAggr NewFused(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const uint& StoreId, const PJsonVal& JsonVal);
+
+    TFusedValType GetValType() const { return fvtTm; }
+    void AddTm(const TTm& Tm) { if (Tm.IsDef()) { CountsH.AddDat(TTm::GetMSecsFromTm(Tm) / SlotLen)++; } }
+    PAggr Clone() const { return new TTimeSpan(GetBase(), GetAggrNm(), GetJoinSeq(), GetFieldId(), SlotLen); }
+    void Merge(const TFusedAggr& Aggr);
+    void Finish() { CountsH.SortByKey(true); }
 
     PJsonVal SaveJson() const;
 
@@ -210,6 +403,293 @@ public:
     static TStr GetType() { return "timespan"; }
 };
 
+///////////////////////////////
+// QMiner-Aggregator-Distinct
+// Approximate number of distinct values, estimated using HyperLogLog sketch.
+// Parameter "precision" sets number of bits for register index (default 14,
+// giving relative standard error of about 0.8% using 16KB of memory).
+class TDistinct : public TFusedAggr {
+private:
+    //parameters
+    TInt Bits;
+    // aggregations
+    TUInt64 Count;
+    TSignalProc::THyperLogLog HyperLogLog;
+
+    TDistinct(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const TJoinSeq& JoinSeq, const int& FieldId, const int& _Bits);
+public:
+    static PAggr New(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const PRecSet& RecSet, const PJsonVal& JsonVal);
+    static PAggr NewFused(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const uint& StoreId, const PJsonVal& JsonVal);
+
+    TFusedValType GetValType() const { return fvtStr; }
+    void AddStr(const TStr& Str) { HyperLogLog.Add(Str); Count++; }
+    PAggr Clone() const { return new TDistinct(GetBase(), GetAggrNm(), GetJoinSeq(), GetFieldId(), Bits); }
+    void Merge(const TFusedAggr& Aggr);
+
+    PJsonVal SaveJson() const;
+
+    // aggregator type name 
+    static TStr GetType() { return "distinct"; }
+};
+
+///////////////////////////////
+// QMiner-Aggregator-TopK
+// Approximate most frequent values, estimated using Count-Min sketch.
+// Parameter "k" sets number of returned values (default 10), "eps" and "delta"
+// set the bound on overestimate of frequencies to eps * count, which holds
+// with probability 1 - delta (defaults 0.001 and 0.01).
+class TTopK : public TFusedAggr {
+private:
+    //parameters
+    TInt TopK;
+    TFlt Eps;
+    TFlt Delta;
+    // aggregations
+    TSignalProc::THeavyHitters HeavyHitters;
+
+    TTopK(const TWPt<TBase>& Base, const TStr& AggrNm, const TJoinSeq& JoinSeq,
+        const int& FieldId, const int& _TopK, const double& _Eps, const double& _Delta);
+public:
+    static PAggr New(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const PRecSet& RecSet, const PJsonVal& JsonVal);
+    static PAggr NewFused(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const uint& StoreId, const PJsonVal& JsonVal);
+
+    TFusedValType GetValType() const { return fvtStr; }
+    void AddStr(const TStr& Str) { HeavyHitters.Add(Str); }
+    PAggr Clone() const { return new TTopK(GetBase(), GetAggrNm(), GetJoinSeq(), GetFieldId(), TopK, Eps, Delta); }
+    void Merge(const TFusedAggr& Aggr);
+
+    PJsonVal SaveJson() const;
+
+    // aggregator type name 
+    static TStr GetType() { return "topk"; }
+};
+
+///////////////////////////////
+// QMiner-Aggregator-Quantiles
+// Approximate quantiles, estimated using t-digest. Parameter "quantiles" gives
+// the list of quantiles to report, "clusters" sets the compression of t-digest
+// (default 100). Count, min and max are exact.
+class TQuantiles : public TFusedAggr {
+private:
+    //parameters
+    TFltV QuantileV;
+    TInt Clusters;
+    // aggregations
+    TUInt64 Count;
+    TFlt MnVal;
+    TFlt MxVal;
+    TSignalProc::TTDigest TDigest;
+    // values not yet added to the digest, flushed in batches
+    TFltV BufValV;
+
+    // number of buffered values that triggers a flush
+    static const int MxBufVals = 1024;
+    // adds buffered values to the digest
+    void FlushBuf();
+
+    TQuantiles(const TWPt<TBase>& Base, const TStr& AggrNm, const TJoinSeq& JoinSeq,
+        const int& FieldId, const TFltV& _QuantileV, const int& _Clusters);
+public:
+    static PAggr New(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const PRecSet& RecSet, const PJsonVal& JsonVal);
+    static PAggr NewFused(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const uint& StoreId, const PJsonVal& JsonVal);
+
+    TFusedValType GetValType() const { return fvtFlt; }
+    void AddFlt(const double& Flt);
+    PAggr Clone() const { return new TQuantiles(GetBase(), GetAggrNm(), GetJoinSeq(), GetFieldId(), QuantileV, Clusters); }
+    void Merge(const TFusedAggr& Aggr);
+    void Finish() { FlushBuf(); TDigest.MergeValues(); }
+
+    PJsonVal SaveJson() const;
+
+    // aggregator type name 
+    static TStr GetType() { return "quantiles"; }
+};
+
+/// Aggregates of value fields computed by group-by
+typedef enum { gbvaCount, gbvaSum, gbvaMin, gbvaMax, gbvaMean, gbvaVar } TGroupByValAggr;
+
+///////////////////////////////
+/// QMiner-Aggregator-GroupBy.
+/// Groups records by one or more key fields and computes aggregates of value
+/// fields for each group. Key and value fields can be reached through join paths,
+/// in which case the first joined record is used. Numeric and time keys can be
+/// bucketed (e.g. "bucket": 3600000 groups datetime field by hour). Records
+/// with a missing key are skipped, missing values are ignored.
+///
+/// Two strategies are available. "hash" (default) keeps groups in an open-addressing
+/// hash table and returns groups in order of first appearance. "sort" collects
+/// keys and values, sorts them by key (skipped when records already come sorted)
+/// and aggregates each run of equal keys in a single streaming pass, returning
+/// groups ordered by key.
+///
+/// Result is a compact table with one row per group:
+/// { "columns": ["sensor", "ts", "value_sum"], "rows": [["a", 1451606400000, 12.5], ...] }
+class TGroupBy : public TAggr {
+private:
+    /// Type of the group key
+    typedef enum { gbktStr, gbktFlt, gbktTm } TKeyType;
+
+    /// Key field; values are encoded into 64-bit codes: strings into dictionary
+    /// ids, numbers into bit patterns of (bucketed) doubles, times into bucket ids
+    class TKeyCol {
+    public:
+        /// Index of the join path in JoinIdVH
+        TInt JoinN;
+        /// Field from the end store of the join path
+        TInt FieldId;
+        /// Name under which key is reported
+        TStr Nm;
+        /// Type of the key
+        TKeyType KeyType;
+        /// Bucket width, 0 for no bucketing (milliseconds for times)
+        TFlt Bucket;
+        /// Reader used for extracting values
+        TFieldReader Reader;
+        /// Dictionary of string keys
+        TStrSet StrSet;
+
+        TKeyCol() { }
+        TKeyCol(const int& _JoinN, const int& _FieldId, const TStr& _Nm, const TKeyType& _KeyType,
+            const double& _Bucket, const TFieldReader& _Reader): JoinN(_JoinN), FieldId(_FieldId),
+                Nm(_Nm), KeyType(_KeyType), Bucket(_Bucket), Reader(_Reader) {
+            // time buckets are whole milliseconds, narrower buckets would truncate to zero
+            QmAssertR(KeyType != gbktTm || Bucket == 0.0 || Bucket >= 1.0,
+                "[TGroupBy] Time bucket of key " + Nm + " must be at least one millisecond");
+        }
+
+        /// Encode key of the given record, returns false when the key is missing
+        bool GetCode(const TRec& Rec, uint64& Code);
+        /// Compare two key codes by their values
+        int Cmp(const uint64& Code1, const uint64& Code2) const;
+        /// Decode key into a json value
+        PJsonVal GetJson(const uint64& Code) const;
+    };
+
+    /// Value field with the aggregate computed over it
+    class TValCol {
+    public:
+        /// Index of the join path in JoinIdVH
+        TInt JoinN;
+        /// Field from the end store of the join path, -1 for counting records
+        TInt FieldId;
+        /// Name under which aggregate is reported
+        TStr Nm;
+        /// Aggregate computed over the field
+        TGroupByValAggr ValAggr;
+        /// Reader used for extracting values
+        TFieldReader Reader;
+
+        TValCol() { }
+        TValCol(const int& _JoinN, const int& _FieldId, const TStr& _Nm,
+            const TGroupByValAggr& _ValAggr, const TFieldReader& _Reader): JoinN(_JoinN),
+                FieldId(_FieldId), Nm(_Nm), ValAggr(_ValAggr), Reader(_Reader) { }
+    };
+
+    /// Open-addressing hash table mapping composite keys to group ids. Keys are
+    /// kept in one flat vector in order of insertion, slots hold group ids and
+    /// collisions are resolved by linear probing.
+    class TGroupH {
+    private:
+        /// Number of codes in a key
+        TInt KeyLen;
+        /// Keys of all groups, KeyLen codes per group
+        TUInt64V KeyV;
+        /// Hash of each group key, so resizing does not need to rehash
+        TUInt64V HashV;
+        /// Slots, holding group id or -1 when empty; length is a power of two
+        TIntV SlotV;
+
+        /// Hash of a composite key
+        uint64 GetHash(const TUInt64V& Key) const;
+        /// Check if group has the given key
+        bool IsKey(const int& GroupN, const TUInt64V& Key) const;
+        /// Double the number of slots
+        void Resize();
+
+    public:
+        TGroupH(const int& _KeyLen = 1, const int& ExpGroups = 1024);
+
+        /// Get group id for the key, new group is created if key not yet seen
+        int AddKey(const TUInt64V& Key);
+        /// Number of groups
+        int Len() const { return HashV.Len(); }
+        /// Keys of all groups, in order of group ids
+        const TUInt64V& GetKeyV() const { return KeyV; }
+    };
+
+    /// Order of (key, values) rows for the sort strategy
+    class TRowCmp {
+    private:
+        const TVec<TKeyCol>& KeyColV;
+        const TUInt64V& KeyV;
+    public:
+        TRowCmp(const TVec<TKeyCol>& _KeyColV, const TUInt64V& _KeyV):
+            KeyColV(_KeyColV), KeyV(_KeyV) { }
+        int Cmp(const int& RowN1, const int& RowN2) const;
+        bool operator()(const TInt& RowN1, const TInt& RowN2) const {
+            const int CmpRes = Cmp(RowN1, RowN2);
+            return (CmpRes != 0) ? (CmpRes < 0) : (RowN1 < RowN2); }
+    };
+
+    /// Distinct join paths used by key and value fields
+    THash<TIntPrV, TInt> JoinIdVH;
+    /// Key fields
+    TVec<TKeyCol> KeyColV;
+    /// Value fields
+    TVec<TValCol> ValColV;
+    /// Use sort instead of hash strategy
+    TBool SortP;
+
+    /// Number of groups
+    TInt Groups;
+    /// Group keys, KeyColV.Len() codes per group
+    TUInt64V GroupKeyV;
+    /// Per group and value field state, ValColV.Len() entries per group
+    TFltV CountV, SumV, SqSumV, MnV, MxV;
+
+    /// Get index of the join path, add it if not yet seen
+    int GetJoinN(const TJoinSeq& JoinSeq);
+    /// Get end record of each join path for the given record
+    void GetJoinRecV(const TRec& Rec, TVec<TRec>& JoinRecV) const;
+    /// Read keys of the record, returns false if any of the keys is missing
+    bool ReadKey(const TVec<TRec>& JoinRecV, TUInt64V& Key);
+    /// Read values of the record, ValPV marks which values are present
+    void ReadVal(const TVec<TRec>& JoinRecV, TFltV& ValV, TBoolV& ValPV) const;
+    /// Add empty state for a new group
+    void AddGroup();
+    /// Update group state with present values
+    void UpdateGroup(const int& GroupN, const TFltV& ValV, const TBoolV& ValPV);
+    /// Aggregate value of group state, null when not defined
+    PJsonVal GetValJson(const int& GroupN, const int& ValColN) const;
+
+    /// Hash strategy
+    void ExecHash(const PRecSet& RecSet);
+    /// Sort strategy
+    void ExecSort(const PRecSet& RecSet);
+
+    TGroupBy(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const PRecSet& RecSet, const PJsonVal& JsonVal);
+public:
+    static PAggr New(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const PRecSet& RecSet, const PJsonVal& JsonVal) {
+            return new TGroupBy(Base, AggrNm, RecSet, JsonVal); }
+
+    /// Number of groups
+    int GetGroups() const { return Groups; }
+
+    PJsonVal SaveJson() const;
+
+    // aggregator type name 
+    static TStr GetType() { return "groupby"; }
+};
+
 } // TAggrs namespace
 
 namespace TStreamAggrs {
@@ -243,6 +723,7 @@ public:
     bool IsInit() const { return Buffer.IsInit(); }
     /// Resets the aggregate
     void Reset() { Buffer.Reset(); }
+    bool IsThreadSafe() const { return true; }
 
     /// Serilization to JSon
     PJsonVal SaveJson(const int& Limit) const;
@@ -258,7 +739,8 @@ public:
 /// Wrapper for exposing time series to signal processing aggregates 
 class TTimeSeriesTick : public TStreamAggr,
                         public TStreamAggrOut::ITm,
-                        public TStreamAggrOut::IFlt {
+                        public TStreamAggrOut::IFlt,
+                        public TStreamAggrOut::IFltTmBatch {
 private:
     /// ID of the field from which we collect time points
     TInt TimeFieldId;
@@ -271,10 +753,16 @@ private:
     TUInt64 TmMSecs;
     /// Last extracted value
     TFlt TickVal;
+    /// Values extracted in the last batch
+    TFltV BatchValV;
+    /// Timestamps extracted in the last batch
+    TUInt64V BatchTmMSecsV;
     
 protected:
     /// On new record we update value and timestamp
     void OnAddRec(const TRec& Rec);
+    /// Extract values and timestamps from the whole batch
+    void OnAddRecs(const PRecSet& RecSet);
     /// On new timestamp we update timestamp
     void OnTime(const uint64& TmMsec);
     /// No on step supported
@@ -295,11 +783,18 @@ public:
     bool IsInit() const { return InitP; }
     /// Resets the model state
     void Reset() { InitP = false; TickVal = 0.0; TmMSecs = 0; }
+    bool IsThreadSafe() const { return true; }
 
     /// Time of last extracted value    
     uint64 GetTmMSecs() const { return TmMSecs; }
     /// Last extracted value
     double GetFlt() const { return TickVal; }
+    /// Values extracted in the last batch
+    void GetBatchFltV(TFltV& ValV) const { ValV = BatchValV; }
+    /// Timestamps extracted in the last batch
+    void GetBatchTmMSecsV(TUInt64V& MSecsV) const { MSecsV = BatchTmMSecsV; }
+    /// Downstream aggregates can read all batch values
+    bool IsBatchable() const { return true; }
 
     // serialization to JSon
     PJsonVal SaveJson(const int& Limit) const;
@@ -340,9 +835,9 @@ private:
     /// Current timestamp
     TUInt64 TmMSecs;
     /// Current window buffer
-    TQQueue<TPair<TUInt64, TVal> > WindowQ;
+    TSignalProc::TRingBuf<TPair<TUInt64, TVal> > WindowQ;
     /// Current delay buffer
-    TQQueue<TPair<TUInt64, TVal> > DelayQ;
+    TSignalProc::TRingBuf<TPair<TUInt64, TVal> > DelayQ;
     
     /// New values from last trigger
     TVec<TVal> InValV;
@@ -358,6 +853,11 @@ protected:
     virtual TVal GetVal() const = 0;
     
 private:
+    /// Copy vector, reusing memory of the destination
+    template <class TElt>
+    static void CopyV(const TVec<TElt>& SrcV, TVec<TElt>& DstV) {
+        DstV.Reserve(SrcV.Len(), SrcV.Len());
+        for (int ValN = 0; ValN < SrcV.Len(); ValN++) { DstV[ValN] = SrcV[ValN]; } }
     /// Read new value from the input aggregate and adds it to the delay
     void UpdateVal();
      /// Read new timestamp from the input aggregate and move aggregates accordingly
@@ -366,6 +866,8 @@ private:
 protected:
     /// Get input aggregate
     const TWPt<TStreamAggr>& GetInAggr() const { return InAggr; }
+    /// Get list of input aggregates
+    void GetInAggrNmV(TStrV& InAggrNmV) const { InAggrNmV.Add(InAggr->GetAggrNm()); }
     
     /// Stream aggregate update function called when a record is added
     void OnAddRec(const TRec& Rec);
@@ -386,6 +888,7 @@ public:
     bool IsInit() const { return InitP; }
     /// Resets the model state
     void Reset();
+    bool IsThreadSafe() const { return true; }
 
     // ITm
     /// time stamp of the last record
@@ -393,15 +896,15 @@ public:
 
     // IValIO
     /// new values that just entered the buffer (needed if delay is nonzero)
-    void GetInValV(TVec<TVal>& ValV) const { ValV = InValV; }
+    void GetInValV(TVec<TVal>& ValV) const { CopyV(InValV, ValV); }
     /// old values that fall out of the buffer
-    void GetOutValV(TVec<TVal>& ValV) const { ValV = OutValV; }
+    void GetOutValV(TVec<TVal>& ValV) const { CopyV(OutValV, ValV); }
 
     // ITmIO
     /// new timestamps that just entered the buffer (needed if delay is nonzero)
-    void GetInTmMSecsV(TUInt64V& MSecsV) const { MSecsV = InTmMSecsV; }
+    void GetInTmMSecsV(TUInt64V& MSecsV) const { CopyV(InTmMSecsV, MSecsV); }
     /// old timestamps that fall out of the buffer
-    void GetOutTmMSecsV(TUInt64V& MSecsV) const { MSecsV = OutTmMSecsV; }
+    void GetOutTmMSecsV(TUInt64V& MSecsV) const { CopyV(OutTmMSecsV, MSecsV); }
 
     // IValV
     /// get buffer length
@@ -512,9 +1015,45 @@ private:
     TUInt64 D;
     /// last timestamp
     TUInt64 Timestamp;
+
+    // OUT-OF-ORDER RECORDS
+    /// IDs of records which arrived with timestamp older than the last one. The A/B/C/D
+    /// intervals skip them, and they are tracked by timestamp in the vectors below.
+    TUInt64Set LateRecIdSet;
+    /// Late records waiting for the delay to pass, sorted by (timestamp, ID)
+    TVec<TUInt64Pr> LatePendingV;
+    /// Late records in the buffer, sorted by (timestamp, ID)
+    TVec<TUInt64Pr> LateWinV;
+    /// Late records that just entered the buffer
+    TVec<TUInt64Pr> LateInV;
+    /// Late records that just fell out of the buffer
+    TVec<TUInt64Pr> LateOutV;
+    /// Number of late records which arrived after the buffer already passed them
+    TUInt64 LateDropped;
+    /// True when late records affect the buffer and the ID vectors below are used
+    /// instead of the A/B/C/D intervals
+    TBool LateP;
+    /// IDs of records that just entered the buffer
+    TUInt64V InRecIdV;
+    /// IDs of records that just fell out of the buffer
+    TUInt64V OutRecIdV;
+    /// IDs of records in the buffer, sorted by timestamp
+    TUInt64V WinRecIdV;
+
+    // RECORD CACHE
+    /// Keep timestamps and values of records in memory, so records are read from
+    /// the store only once and can fall out of the buffer after the store forgot them
+    TBool CacheP;
+    /// ID of the first cached record
+    TUInt64 CacheFirstRecId;
+    /// Timestamps and values of records with consecutive IDs starting with CacheFirstRecId
+    TSignalProc::TRingBuf<TPair<TUInt64, TVal> > CacheV;
+
 protected:
     /// Stream aggregate update function called when a record is added
     void OnAddRec(const TRec& Rec);
+    /// Move the buffer to the last record in the batch in one step
+    void OnAddRecs(const PRecSet& RecSet);
     /// Stream aggregate that forgets records when time is updated
     void OnTime(const uint64& TmMsec);
     /// Just a expection-throwing placeholder
@@ -532,6 +1071,9 @@ public:
     bool IsInit() const { return InitP; }
     /// Resets the model state
     void Reset();
+    bool IsThreadSafe() const { return true; }
+    /// Batch results in one step with all the batch records in the in/out intervals
+    bool IsBatchable() const { return true; }
 
     // INTERFACE
     
@@ -553,9 +1095,9 @@ public:
     
     // IValV
     /// get buffer length
-    int GetVals() const { EAssertR(IsInit(), "WinBuf not initialized yet!"); return (int)(D - B); }
+    int GetVals() const { EAssertR(IsInit(), "WinBuf not initialized yet!"); return LateP ? WinRecIdV.Len() : (int)(D - B); }
     /// get value at
-    void GetVal(const int& ElN, TVal& Val) const { Val = GetRecVal(B + ElN); }
+    void GetVal(const int& ElN, TVal& Val) const { Val = GetBufVal(LateP ? WinRecIdV[ElN].Val : B + ElN); }
     /// get float vector of all values in the buffer (IFltVec interface)
     void GetValV(TVec<TVal>& ValV) const;
 
@@ -563,7 +1105,7 @@ public:
     /// get buffer length
     int GetTmLen() const { return GetVals(); }
     /// get timestamp at
-    uint64 GetTm(const int& ElN) const { return Time(B + ElN); }
+    uint64 GetTm(const int& ElN) const { return Time(LateP ? WinRecIdV[ElN].Val : B + ElN); }
     /// get timestamp vector of all timestamps in the buffer (ITmVec interface)
     void GetTmV(TUInt64V& MSecsV) const;
 
@@ -576,7 +1118,18 @@ public:
     void Print(const bool& PrintState = false);
 private:
     /// Extract timestamp from the given record
-    uint64 Time(const uint64& RecId) const { return Store->GetFieldTmMSecs(RecId, TimeFieldId); }
+    uint64 Time(const uint64& RecId) const {
+        return IsCached(RecId) ? CacheV[int(RecId - CacheFirstRecId)].Val1.Val : Store->GetFieldTmMSecs(RecId, TimeFieldId); }
+    /// Value of the given record, from cache when possible
+    TVal GetBufVal(const uint64& RecId) const {
+        return IsCached(RecId) ? CacheV[int(RecId - CacheFirstRecId)].Val2 : GetRecVal(RecId); }
+    /// Check if record's timestamp is cached
+    bool IsCached(const uint64& RecId) const {
+        return CacheP && CacheFirstRecId <= RecId && RecId < CacheFirstRecId + CacheV.Len(); }
+    /// Cache timestamp and value of a new record
+    void CacheRec(const uint64& RecId, const uint64& RecTmMSecs);
+    /// Forget cached records which cannot be accessed anymore
+    void TrimCache();
     /// Check if record id valid
     bool InStore(const uint64& RecId) const { return Store->IsRecId(RecId); }
     /// Check if record id before the store.first
@@ -588,10 +1141,27 @@ private:
         return !BeforeBuffer(RecId, LastRecTmMSecs) && !AfterBuffer(RecId, LastRecTmMSecs); }
     /// Check if record id older than current buffer window
     bool BeforeBuffer(const uint64& RecId, const uint64& LastRecTmMSecs) const {
-        return  BeforeStore(RecId) || (InStore(RecId) && (Time(RecId) < LastRecTmMSecs - DelayMSecs - WinSizeMSecs)); }
+        if (IsCached(RecId)) { return BeforeBufferTm(Time(RecId), LastRecTmMSecs); }
+        return  BeforeStore(RecId) || (InStore(RecId) && BeforeBufferTm(Time(RecId), LastRecTmMSecs)); }
     /// Check if record id newer then the current buffer window
     bool AfterBuffer(const uint64& RecId, const uint64& LastRecTmMSecs) const {
-        return AfterStore(RecId) || (InStore(RecId) && (Time(RecId) > LastRecTmMSecs - DelayMSecs)); }
+        if (IsCached(RecId)) { return AfterBufferTm(Time(RecId), LastRecTmMSecs); }
+        return AfterStore(RecId) || (InStore(RecId) && AfterBufferTm(Time(RecId), LastRecTmMSecs)); }
+    /// Check if timestamp older than current buffer window
+    bool BeforeBufferTm(const uint64& TmMSecs, const uint64& LastRecTmMSecs) const {
+        return TmMSecs < LastRecTmMSecs - DelayMSecs - WinSizeMSecs; }
+    /// Check if timestamp newer than current buffer window
+    bool AfterBufferTm(const uint64& TmMSecs, const uint64& LastRecTmMSecs) const {
+        return TmMSecs > LastRecTmMSecs - DelayMSecs; }
+    /// Check if record arrived out of order and is skipped by the intervals
+    bool IsLateRec(const uint64& RecId) const {
+        return !LateRecIdSet.Empty() && (IsCached(RecId) || InStore(RecId)) && LateRecIdSet.IsKey(RecId); }
+    /// Remember record which arrived with timestamp older than the last one
+    void AddLateRec(const uint64& RecId, const uint64& RecTmMSecs);
+    /// Move late records in and out of the buffer and collect IDs of changed records
+    void UpdateLate();
+    /// Add IDs from the interval which did not arrive late
+    void AddInOrderRecIdV(const uint64& StartId, const uint64& EndId, TUInt64V& RecIdV) const;
     /// Debug printout
     void PrintInterval(const uint64& StartId, const uint64& EndId, const TStr& Label = "", const TStr& ModCode = "39") const;
 };
@@ -647,6 +1217,9 @@ public:
     /// Save state of stream aggregate to stream
     void SaveState(TSOut& SOut) const;
 
+    /// Feature space is updated with each record
+    bool IsThreadSafe() const { return false; }
+
     /// Stream aggregator type name
     static TStr GetType() { return "timeSeriesWinBufFeatureSpace"; }
     /// Stream aggregator type name
@@ -675,9 +1248,20 @@ private:
     /// signal we are maintaining on the stream
     TSignalType Signal;
 
+    /// Values entering the window in the last step
+    TFltV InValV;
+    /// Timestamps of values entering the window in the last step
+    TUInt64V InTmMSecsV;
+    /// Values leaving the window in the last step
+    TFltV OutValV;
+    /// Timestamps of values leaving the window in the last step
+    TUInt64V OutTmMSecsV;
+
 protected:
     /// Update signal based on the changes from the input
     void OnStep();
+    /// Input window reports all the batch changes at once, so one step is enough
+    void OnAddRecs(const PRecSet& RecSet) { OnStep(); }
     /// Json constructor
     TWinAggr(const TWPt<TBase>& Base, const PJsonVal& ParamVal);
 
@@ -695,6 +1279,9 @@ public:
     bool IsInit() const { return Signal.IsInit(); }
     /// Resets the aggregate
     void Reset() { Signal.Reset(); }
+    bool IsThreadSafe() const { return true; }
+    /// Signal is updated from the window in/out changes
+    bool IsBatchable() const { return true; }
     /// Get current signal value
     double GetFlt() const { return Signal.GetValue(); }
     /// Get latest time stamp
@@ -757,9 +1344,20 @@ private:
     /// signal we are maintaining on the stream    
     TSignalType Signal;
 
+    /// Vectors entering the window in the last step
+    TVec<TIntFltKdV> InValV;
+    /// Timestamps of vectors entering the window in the last step
+    TUInt64V InTmMSecsV;
+    /// Vectors leaving the window in the last step
+    TVec<TIntFltKdV> OutValV;
+    /// Timestamps of vectors leaving the window in the last step
+    TUInt64V OutTmMSecsV;
+
 protected:
     /// Update strema aggregate
     void OnStep();
+    /// Input window reports all the batch changes at once, so one step is enough
+    void OnAddRecs(const PRecSet& RecSet) { OnStep(); }
     /// Json constructor
     TWinAggrSpVec(const TWPt<TBase>& Base, const PJsonVal& ParamVal);
 
@@ -777,6 +1375,9 @@ public:
     bool IsInit() const { return Signal.IsInit(); }
     /// Resets the aggregate
     void Reset() { Signal.Reset(); }
+    bool IsThreadSafe() const { return true; }
+    /// Signal is updated from the window in/out changes
+    bool IsBatchable() const { return true; }
     /// Number of values in the output vector
     int GetVals() const { return Signal.GetValue().Len(); }
     /// Get ElN-th output value
@@ -814,6 +1415,8 @@ private:
     TWPt<TStreamAggrOut::ITm> InAggrTm;
     /// Input aggregate casted to time series
     TWPt<TStreamAggrOut::IFlt> InAggrFlt;
+    /// Input aggregate casted to batch of values (can be NULL)
+    TWPt<TStreamAggrOut::IFltTmBatch> InAggrBatch;
     
     /// EMA indicator
     TSignalProc::TEma Ema;
@@ -821,6 +1424,8 @@ private:
 protected:
     /// Update EMA
     void OnStep();
+    /// Update EMA with all the values from the input batch
+    void OnAddRecs(const PRecSet& RecSet);
 
     /// Json constructor
     TEma(const TWPt<TBase>& Base, const PJsonVal& ParamVal);
@@ -837,6 +1442,9 @@ public:
     bool IsInit() const { return Ema.IsInit(); }
     /// Resets the aggregate
     void Reset() { Ema.Reset(); }
+    bool IsThreadSafe() const { return true; }
+    /// Batchable when input exposes all the batch values
+    bool IsBatchable() const { return !InAggrBatch.Empty(); }
     /// Latest value
     double GetFlt() const { return Ema.GetValue(); }
     /// Timestamp of the latest value
@@ -888,6 +1496,7 @@ public:
     bool IsInit() const { return Ema.IsInit(); }
     /// Resets the aggregate
     void Reset() { Ema.Reset(); }
+    bool IsThreadSafe() const { return true; }
     /// Get number of values in the output vector
     int GetVals() const { return Ema.GetValue().Len(); }
     /// Get ElN-th value from the output vector
@@ -947,6 +1556,7 @@ public:
     bool IsInit() const { return TmMSecs != TUInt64::Mn; }
     /// Resets the aggregate
     void Reset();
+    bool IsThreadSafe() const { return true; }
     /// Current values
     double GetFlt() const { return IsAboveP; }
     /// Current timestamp
@@ -988,6 +1598,8 @@ private:
 protected:
     /// Update covariance
     void OnStep();
+    /// Input windows report all the batch changes at once, so one step is enough
+    void OnAddRecs(const PRecSet& RecSet) { OnStep(); }
 
     /// Json constructor
     TCov(const TWPt<TBase>& Base, const PJsonVal& ParamVal);
@@ -1004,6 +1616,9 @@ public:
     bool IsInit() const { return InAggrX->IsInit() && InAggrY->IsInit(); }
     /// Resets the aggregate
     void Reset() { Cov.Reset(); }
+    bool IsThreadSafe() const { return true; }
+    /// Covariance is updated from the window in/out changes
+    bool IsBatchable() const { return true; }
     /// Get latest covariance
     double GetFlt() const { return Cov.GetCov(); }
     /// Get time of latest covariance
@@ -1051,6 +1666,8 @@ private:
 protected:
     /// Update current correlation values
     void OnStep();
+    /// Correlation only depends on the latest input values
+    void OnAddRecs(const PRecSet& RecSet) { OnStep(); }
 
     /// Initialize from json
     TCorr(const TWPt<TBase>& Base, const PJsonVal& ParamVal);
@@ -1067,6 +1684,9 @@ public:
     bool IsInit() const;
     /// Resets the aggregate
     void Reset() { TmMSecs = 0;  Corr = 0; }
+    bool IsThreadSafe() const { return true; }
+    /// Correlation only depends on the latest input values
+    bool IsBatchable() const { return true; }
     /// Return current correlation value
     double GetFlt() const { return Corr; }
     /// Return current timestamp
@@ -1144,6 +1764,23 @@ private:
     // used as an output to the store
     TTriple<TUInt64, TFltV, TUInt64> PrevInterpPt;
 
+    /// Input point waiting for reordering: interpolator, value and record ID
+    typedef TTriple<TInt, TFlt, TUInt64> TInPt;
+    /// Reorder input points by timestamp before merging (when `allowedLateness` is given)
+    TBool ReorderP;
+    /// Input points waiting for the watermark
+    TSignalProc::TReorderBuf<TInPt> ReorderBuf;
+
+    /// Number of leading interpolators known to interpolate at NextInterpTm.
+    /// Adding points keeps interpolators ready, so each check resumes where the last one stopped.
+    TInt ReadyInterps;
+    /// Timestamp of the last point merged from each input
+    TUInt64V InLastTmV;
+    /// Timestamp of the last point merged from any input
+    TUInt64 LastTm;
+    /// ID of the `source` join in the output store, -1 when there is none
+    TInt SourceJoinId;
+
 public:
     /// Json constructor
     TMerger(const TWPt<TQm::TBase>& Base, const PJsonVal& ParamVal);
@@ -1151,6 +1788,8 @@ public:
 
     void Reset() { throw TQmExcept::New("TMerger::Reset() not implemented!"); }
     void CreateStore(const TStr& NewStoreNm, const TStr& NewTimeFieldNm);
+    /// Merge all input points waiting for reordering, e.g. at the end of a stream
+    void Flush();
 
     PJsonVal SaveJson(const int& Limit) const;
 
@@ -1177,11 +1816,21 @@ private:
 
 protected:
     void OnAddRec(const TQm::TRec& Rec);
+    /// Merge a batch of records from one store, looking up its field maps once
+    void OnAddRecs(const TQm::PRecSet& RecSet);
     void OnTime(const uint64& TmMsec);
     void OnStep();
 
+public:
+    /// Merger reads records directly and has no input aggregates
+    bool IsBatchable() const { return true; }
+
 private:
     void OnAddRec(const TQm::TRec& Rec,  const int& FieldMapIdx);
+    // merges input point, in order of timestamps
+    void Merge(const int& InterpIdx, const uint64& RecTm, const TFlt& RecVal, const uint64& RecId);
+    // merges input points which passed the watermark
+    void MergeReordered();
     // adds a new record to the specified buffer
     void AddToBuff(const int& BuffIdx, const uint64 RecTm, const TFlt& Val);
     // shifts all the buffers so that the second value is greater then the current interpolation time
@@ -1191,9 +1840,11 @@ private:
     // adds the record to the output store
     void AddToStore(const TFltV& InterpValV, const uint64 InterpTm, const uint64& RecId);
     // checks if the record can be added to the output store and adds it
-    void AddRec(const TFltV& InterpValV, const uint64 InterpTm, const TQm::TRec& Rec);
+    void AddRec(const TFltV& InterpValV, const uint64 InterpTm, const uint64& RecId);
     // checks if the conditions for interpolation are true in this iteration
     bool CanInterpolate();
+    // sets the next interpolation time, interpolators need to be checked again
+    void SetNextInterpTm(const uint64& InterpTm) { NextInterpTm = InterpTm; ReadyInterps = 0; }
     // updates the next interpolation time
     void UpdateNextInterpTm();
     // updates the next interpolation time in the interpolators
@@ -1226,13 +1877,38 @@ private:
 
     // berfore first update
     TBool UpdatedP;
-    
+    // ID of the `source` join in the output store, -1 when there is none
+    TInt SourceJoinId;
+
+    /// Columnar mode (`columnar` parameter): all fields are interpolated together,
+    /// for a span of output ticks at a time, instead of one interpolator per field
+    TBool ColumnarP;
+    /// Columnar mode: indices of fields, grouped by interpolator type, linear first,
+    /// then previous and current point
+    TIntV ColFieldNV;
+    /// Columnar mode: number of linear and previous point fields in ColFieldNV
+    TInt LinearFlds, PrevFlds;
+    /// Columnar mode: output field names, ordered as ColFieldNV
+    TStrV ColFieldNmV;
+    /// Columnar mode: number of input points seen, up to 2
+    TInt Points;
+    /// Columnar mode: timestamps of the last two input points
+    TUInt64 PrevTmMSecs, LastTmMSecs;
+    /// Columnar mode: values of the last two input points, ordered as ColFieldNV
+    TFltV PrevValV, LastValV;
+    /// Columnar mode: interpolated values, one row of fields per output tick
+    TFltV SpanValV;
+
 protected:  
     void OnAddRec(const TRec& Rec);
     void OnTime(const uint64& TmMsec);
     void OnStep();
     
 private:
+    // adds record in columnar mode
+    void OnAddRecColumnar(const TRec& Rec);
+    // interpolates all fields for ticks starting at StartMSecs into SpanValV
+    void InterpolateSpan(const uint64& StartMSecs, const int& Ticks);
     // refreshes the interpolators to the specified time
     void RefreshInterpolators(const uint64& Tm);
     bool CanInterpolate();
@@ -1259,6 +1935,68 @@ public:
     TStr Type() const { return GetType(); }
 };
 
+///////////////////////////////
+/// Reorder buffer.
+/// Copies records from the input store to the output store sorted by timestamp,
+/// so window buffers, mergers and resamplers on the output store see records in
+/// order. Records are held until the watermark, which trails the largest timestamp
+/// seen so far by `allowedLateness` milliseconds, passes them. Records older than the
+/// watermark are late: with `lateRecords: 'drop'` (default) they are ignored, with
+/// `'forward'` they are copied out of order and handled by window buffers as late
+/// records. At most `maxPending` records are held, when exceeded the oldest ones are
+/// released early. Fields with the same name in both stores are copied.
+class TReorderBuffer : public TStreamAggr {
+private:
+    /// Input store
+    TWPt<TStore> InStore;
+    /// Input time field
+    TInt TimeFieldId;
+    /// Output store
+    TWPt<TStore> OutStore;
+    /// Fields copied to the output store, as pairs of input and output field IDs
+    TIntPrV FieldIdPrV;
+    /// Copy late records to the output store instead of ignoring them
+    TBool ForwardLateP;
+    /// Pending record IDs
+    TSignalProc::TReorderBuf<TUInt64> ReorderBuf;
+    /// Number of late records copied to the output store
+    TUInt64 ForwardedLate;
+
+    /// Copy record to the output store
+    void AddToOutStore(const uint64& RecId);
+    /// Copy records which passed the watermark to the output store
+    void Release();
+
+protected:
+    void OnAddRec(const TRec& Rec);
+    /// Move watermark to the given time minus allowed lateness
+    void OnTime(const uint64& TmMsec);
+    void OnStep() { throw TQmExcept::New("TReorderBuffer::OnStep() not supported"); }
+
+    TReorderBuffer(const TWPt<TBase>& Base, const PJsonVal& ParamVal);
+
+public:
+    static PStreamAggr New(const TWPt<TBase>& Base, const PJsonVal& ParamVal);
+
+    /// Copy all pending records to the output store, e.g. at the end of a stream
+    void Flush();
+    /// Forget pending records
+    void Reset();
+
+    /// Load stream aggregate state from stream
+    void LoadState(TSIn& SIn);
+    /// Save state of stream aggregate to stream
+    void SaveState(TSOut& SOut) const;
+
+    /// Number of pending records, watermark and number of late records
+    PJsonVal SaveJson(const int& Limit) const;
+
+    /// Stream aggregator type name
+    static TStr GetType() { return "reorderBuffer"; }
+    /// Stream aggregator type name
+    TStr Type() const { return GetType(); }
+};
+
 ///////////////////////////////
 /// Dense feature extractor stream aggregate.
 /// Calls GetFullV on feature space and returns result.
@@ -1320,6 +2058,8 @@ private:
     TWPt<TStreamAggrOut::IFlt> InAggrFlt;
     /// Input windowed time series (can be NULL if the input is a timeseries aggregate)
     TWPt<TStreamAggrOut::IFltIO> InAggrFltIO;
+    /// Input batch of values (can be NULL)
+    TWPt<TStreamAggrOut::IFltTmBatch> InAggrBatch;
 
     /// Is buffered input aggregate provided?
     TBool BufferedP;
@@ -1330,6 +2070,8 @@ private:
 protected:
     /// Update histogram
     void OnStep();
+    /// Update histogram with all the values from the input batch
+    void OnAddRecs(const PRecSet& RecSet);
     
     /// JSON constructor
     TOnlineHistogram(const TWPt<TBase>& Base, const PJsonVal& ParamVal);
@@ -1342,12 +2084,17 @@ public:
     bool IsInit() const { return Model.IsInit(); }
     /// Resets the aggregate
     void Reset() { Model.Reset(); }
+    bool IsThreadSafe() const { return true; }
+    /// Batchable when input is buffered or exposes all the batch values
+    bool IsBatchable() const { return BufferedP || !InAggrBatch.Empty(); }
     /// Load from stream
     void LoadState(TSIn& SIn);
     /// Store state into stream
     void SaveState(TSOut& SOut) const;
     /// serilization to JSon
     PJsonVal SaveJson(const int& Limit) const { return Model.SaveJson(); }
+    /// Get list of input aggregates
+    void GetInAggrNmV(TStrV& InAggrNmV) const { InAggrNmV.Add(InAggr->GetAggrNm()); }
 
     /// returns the number of bins 
     int GetVals() const { return Model.GetBins(); }
@@ -1377,6 +2124,8 @@ private:
     TWPt<TStreamAggr> InAggr;
     /// Input timeseries
     TWPt<TStreamAggrOut::IFlt> InAggrFlt;
+    /// Input batch of values (can be NULL)
+    TWPt<TStreamAggrOut::IFltTmBatch> InAggrBatch;
     
     /// TDigest model
     TSignalProc::TTDigest Model;
@@ -1386,6 +2135,8 @@ private:
 protected:
     /// Update the model
     void OnStep();
+    /// Update the model with all the values from the input batch
+    void OnAddRecs(const PRecSet& RecSet);
     /// Add new data to statistics
     void Add(const TFlt& Val);
 
@@ -1404,6 +2155,9 @@ public:
     bool IsInit() const { return Model.IsInit(); }
     /// Resets the aggregate
     void Reset() { }    
+    bool IsThreadSafe() const { return true; }
+    /// Batchable when input exposes all the batch values
+    bool IsBatchable() const { return !InAggrBatch.Empty(); }
     /// returns the number of clusters
     int GetVals() const { return Model.GetClusters(); }
     /// get current Quantile value vector
@@ -1461,6 +2215,7 @@ public:
     bool IsInit() const { return InAggrX->IsInit() && InAggrY->IsInit(); }
     /// Reset
     void Reset() { ChiSquare.Reset(); }
+    bool IsThreadSafe() const { return true; }
     /// Get current Chi2 value
     double GetFlt() const { return ChiSquare.GetChi2(); }
 
@@ -1528,6 +2283,7 @@ public:
     bool IsInit() const { return true; }
     /// Reset the histogram model
     void Reset() { Model.Reset(); }
+    bool IsThreadSafe() const { return true; }
 
     /// returns the number of bins 
     int GetVals() const { return Model.GetBins(); }
@@ -1535,6 +2291,8 @@ public:
     void GetVal(const int& ElN, TFlt& Val) const { Val = ValV[ElN]; }
     /// returns the vector of frequencies
     void GetValV(TFltV& _ValV) const { _ValV = ValV; }
+    /// Get list of input aggregates
+    void GetInAggrNmV(TStrV& InAggrNmV) const { InAggrNmV.Add(InAggr->GetAggrNm()); }
 
     /// serilization to JSon
     PJsonVal SaveJson(const int& Limit) const;
@@ -1584,6 +2342,7 @@ public:
     bool IsInit() const { return InAggrX->IsInit() && InAggrY->IsInit(); }
     /// resets the aggregate
     void Reset() { }
+    bool IsThreadSafe() const { return true; }
     
     /// returns the number of bins 
     int GetVals() const { return InAggrValX->GetVals(); }
@@ -1591,6 +2350,9 @@ public:
     void GetVal(const int& ElN, TFlt& Val) const { Val = ValV[ElN]; }
     /// returns the vector of frequencies
     void GetValV(TFltV& _ValV) const { _ValV = ValV; }
+    /// Get list of input aggregates
+    void GetInAggrNmV(TStrV& InAggrNmV) const { InAggrNmV.Add(InAggrX->GetAggrNm());
+        InAggrNmV.Add(InAggrY->GetAggrNm()); }
     
     /// serialization to JSon
     PJsonVal SaveJson(const int& Limit) const;
@@ -1660,6 +2422,11 @@ public:
     bool IsInit() const { return InAggrX->IsInit() && InAggrY->IsInit(); }
     /// Resets the aggregate
     void Reset();
+    /// Thread safe when the record filter is
+    bool IsThreadSafe() const { return Filter->IsThreadSafe(); }
+    /// Get list of input aggregates
+    void GetInAggrNmV(TStrV& InAggrNmV) const { InAggrNmV.Add(InAggrX->GetAggrNm());
+        InAggrNmV.Add(InAggrY->GetAggrNm()); }
 
     /// JSON serialization
     PJsonVal SaveJson(const int& Limit) const { return Result; }
@@ -1710,6 +2477,165 @@ public:
     TStr Type() const { return GetType(); }
 };
 
+///////////////////////////////
+/// Keyed stream aggregate.
+/// Partitions records by the value of a key field and keeps a separate statistic for
+/// each key, instead of one aggregate object per key. Supported statistics are window
+/// values ("winBuf"), windowed "sum", "ma", "var", "min" and "max", "ema", "tdigest" and
+/// "histogram" (windowed when `winsize` is given). Windows move with the records of
+/// their key. State of all keys is kept in slot vectors, slots of removed keys are
+/// reused. Keys without records for `idleTimeout` milliseconds are removed.
+class TKeyed : public TStreamAggr, public TStreamAggrOut::IKeyed {
+private:
+    /// Statistic kept for each key
+    typedef enum { ksWinBuf, ksSum, ksMa, ksVar, ksMin, ksMax, ksEma, ksTDigest, ksHist } TKeyedStat;
+
+    /// T-digest of one key. Allocated separately, since empty t-digests are not small.
+    /// Values are added to the t-digest in batches, since each merge into centroids
+    /// is linear in their number; the batch is flushed before the t-digest is read.
+    class TKeyTDigest {
+    private:
+        TCRef CRef;
+        /// Number of buffered values that triggers a flush
+        static const int MxBufVals = 64;
+        /// Values not yet added to the t-digest
+        mutable TFltV BufValV;
+        mutable TSignalProc::TTDigest TDigest;
+
+        /// Add buffered values to the t-digest
+        void Flush() const {
+            if (BufValV.Empty()) { return; }
+            TDigest.UpdateV(BufValV); BufValV.Clr(false);
+        }
+    public:
+        TKeyTDigest(const PJsonVal& ParamVal): TDigest(ParamVal) { }
+        TKeyTDigest(TSIn& SIn) { TDigest.LoadState(SIn); }
+        static TPt<TKeyTDigest> New(const PJsonVal& ParamVal) { return new TKeyTDigest(ParamVal); }
+        static TPt<TKeyTDigest> Load(TSIn& SIn) { return new TKeyTDigest(SIn); }
+        void Save(TSOut& SOut) const { Flush(); TDigest.SaveState(SOut); }
+
+        void Add(const double& Val) {
+            BufValV.Add(Val);
+            if (BufValV.Len() >= MxBufVals) { Flush(); }
+        }
+        double GetQuantile(const double& Quantile) const { Flush(); return TDigest.GetQuantile(Quantile); }
+
+        friend class TPt<TKeyTDigest>;
+    };
+    typedef TPt<TKeyTDigest> PKeyTDigest;
+
+    /// Input store
+    TWPt<TStore> Store;
+    /// Key field ID
+    TInt KeyFieldId;
+    /// Time field ID
+    TInt TimeFieldId;
+    /// Value field reader
+    TFieldReader ValReader;
+    /// Statistic kept for each key
+    TKeyedStat Stat;
+    /// Name of the statistic
+    TStr StatNm;
+    /// Parameters for statistics of new keys
+    PJsonVal StatParamVal;
+    /// Window size in milliseconds, zero when values are not windowed
+    TUInt64 WinSizeMSecs;
+    /// Keys without records for this many milliseconds are removed, zero keeps all keys
+    TUInt64 IdleMSecs;
+    /// Quantiles reported for t-digests
+    TFltV QuantileV;
+
+    /// Slot of each key
+    TStrIntH KeySlotH;
+    /// Key of each slot, empty for free slots
+    TStrV SlotKeyV;
+    /// Free slots, used first for new keys
+    TIntV FreeSlotV;
+    /// Timestamp of the last record of each slot
+    TUInt64V SlotTmMSecsV;
+    /// Window of (timestamp, value) pairs of each slot
+    TVec<TSignalProc::TRingBuf<TUInt64FltPr> > SlotWinV;
+    /// Statistic of each slot, only the vector of the selected statistic is used
+    TVec<TSignalProc::TSum> SumV;
+    TVec<TSignalProc::TMa> MaV;
+    TVec<TSignalProc::TVar> VarV;
+    TVec<TSignalProc::TMin> MinV;
+    TVec<TSignalProc::TMax> MaxV;
+    TVec<TSignalProc::TEma> EmaV;
+    TVec<PKeyTDigest> TDigestV;
+    TVec<TSignalProc::TOnlineHistogram> HistV;
+    /// Largest timestamp seen so far
+    TUInt64 TmMSecs;
+    /// Time of the next check for idle keys
+    TUInt64 NextIdleTmMSecs;
+    /// Values that fell out of the window in the last update
+    TFltV OutValV;
+    /// Timestamps of values that fell out of the window in the last update
+    TUInt64V OutTmMSecsV;
+
+    /// Get slot of the key, reusing a free slot or adding a new one for new keys
+    int AddKey(const TStr& Key);
+    /// Set slot's statistic to the initial state
+    void InitSlot(const int& SlotN);
+    /// Remove key and free its slot
+    void DelKey(const TStr& Key);
+    /// Remove keys without records for IdleMSecs
+    void DelIdleKeys();
+    /// Get slot of an existing key
+    int GetKeySlotN(const TStr& Key) const;
+    /// Add value to the slot's window and statistic
+    void Update(const int& SlotN, const double& Val, const uint64& ValTmMSecs);
+    /// Move time forward and remove idle keys
+    void SetTmMSecs(const uint64& _TmMSecs);
+
+protected:
+    /// Update statistic of the record's key
+    void OnAddRec(const TRec& Rec);
+    /// Remove idle keys
+    void OnTime(const uint64& TmMsec) { SetTmMSecs(TmMsec); }
+    /// Just a expection-throwing placeholder
+    void OnStep() { throw TQmExcept::New("TKeyed::OnStep() not supported"); }
+
+    /// JSON based constructor
+    TKeyed(const TWPt<TBase>& Base, const PJsonVal& ParamVal);
+public:
+    /// Smart pointer constructor
+    static PStreamAggr New(const TWPt<TBase>& Base, const PJsonVal& ParamVal);
+
+    /// Load stream aggregate state from stream
+    void LoadState(TSIn& SIn);
+    /// Save state of stream aggregate to stream
+    void SaveState(TSOut& SOut) const;
+
+    /// Did we see any key
+    bool IsInit() const { return !KeySlotH.Empty(); }
+    /// Removes all keys
+    void Reset();
+    bool IsThreadSafe() const { return true; }
+
+    // IKeyed
+    /// Number of keys
+    int GetKeys() const { return KeySlotH.Len(); }
+    /// Get all keys
+    void GetKeyV(TStrV& KeyV) const { KeySlotH.GetKeyV(KeyV); }
+    /// Do we have state for the key
+    bool IsKey(const TStr& Key) const { return KeySlotH.IsKey(Key); }
+    /// Current value of the key's statistic
+    double GetKeyFlt(const TStr& Key) const;
+    /// Window values, t-digest quantiles or histogram counts of the key
+    void GetKeyFltV(const TStr& Key, TFltV& ValV) const;
+    /// Timestamp of the key's last record
+    uint64 GetKeyTmMSecs(const TStr& Key) const { return SlotTmMSecsV[GetKeySlotN(Key)]; }
+
+    /// Serialization to JSON, values of at most Limit keys
+    PJsonVal SaveJson(const int& Limit) const;
+
+    /// Stream aggregator type name
+    static TStr GetType() { return "keyed"; }
+    /// Stream aggregator type name
+    TStr Type() const { return GetType(); }
+};
+
 ///////////////////////////////
 /// Template class implementation 
 #include "qminer_aggr.hpp"
@@ -10,9 +10,9 @@ void TWinBufMem<TVal>::UpdateVal() {
 
 template <class TVal>
 void TWinBufMem<TVal>::UpdateTime() {
-    // first we clear existing in/out placeholders
-    InValV.Clr(); InTmMSecsV.Clr();
-    OutValV.Clr(); OutTmMSecsV.Clr();
+    // first we clear existing in/out placeholders, keeping their memory
+    InValV.Clr(false); InTmMSecsV.Clr(false);
+    OutValV.Clr(false); OutTmMSecsV.Clr(false);
     // update the current timestamps
     TmMSecs = InAggrTm->GetTmMSecs();
     // first we move things from delay to window
@@ -24,7 +24,7 @@ void TWinBufMem<TVal>::UpdateTime() {
         InValV.Add(DelayQ.Front().Val2);
         InTmMSecsV.Add(DelayQ.Front().Val1);
         // remove the front element from the delay queue
-        DelayQ.Pop();
+        DelayQ.PopFront();
     }
     // then we remove old stuff from window
     const uint64 StartWinMSecs = TmMSecs - DelayMSecs - WinSizeMSecs;
@@ -33,7 +33,7 @@ void TWinBufMem<TVal>::UpdateTime() {
         OutValV.Add(WindowQ.Front().Val2);
         OutTmMSecsV.Add(WindowQ.Front().Val1);
         // remove from the window
-        WindowQ.Pop();
+        WindowQ.PopFront();
     }
 }
 
@@ -109,17 +109,17 @@ void TWinBufMem<TVal>::Reset() {
 
 template <class TVal>
 void TWinBufMem<TVal>::GetValV(TVec<TVal>& ValV) const {
-    ValV.Gen(WindowQ.Len(), 0);
+    ValV.Reserve(WindowQ.Len(), WindowQ.Len());
     for (int ElN = 0; ElN < WindowQ.Len(); ElN++) {
-        ValV.Add(WindowQ[ElN].Val2);
+        ValV[ElN] = WindowQ[ElN].Val2;
     }
 }
 
 template <class TVal>
 void TWinBufMem<TVal>::GetTmV(TUInt64V& ValV) const {
-    ValV.Gen(WindowQ.Len(), 0);
+    ValV.Reserve(WindowQ.Len(), WindowQ.Len());
     for (int ElN = 0; ElN < WindowQ.Len(); ElN++) {
-        ValV.Add(WindowQ[ElN].Val1);
+        ValV[ElN] = WindowQ[ElN].Val1;
     }
 }
 
@@ -139,27 +139,52 @@ PJsonVal TWinBufMem<TVal>::SaveJson(const int& Limit) const {
 // Time series window buffer.
 template <class TVal>
 void TWinBuf<TVal>::OnAddRec(const TRec& Rec) {
-    InitP = true;
-
     uint64 Timestamp_ = Rec.GetFieldTmMSecs(TimeFieldId);
+    CacheRec(Rec.GetRecId(), Timestamp_);
+    // records older than the last one are handled separately from the intervals
+    if (InitP && Timestamp_ < Timestamp) { AddLateRec(Rec.GetRecId(), Timestamp_); }
+
+    InitP = true;
     OnTime(Timestamp_);
 }
 
+template <class TVal>
+void TWinBuf<TVal>::OnAddRecs(const PRecSet& RecSet) {
+    if (RecSet->Empty()) { return; }
+    // find records arriving out of order and the largest timestamp
+    uint64 MxTimestamp = Timestamp;
+    for (int RecN = 0; RecN < RecSet->GetRecs(); RecN++) {
+        const uint64 RecId = RecSet->GetRecId(RecN);
+        const uint64 RecTmMSecs = Store->GetFieldTmMSecs(RecId, TimeFieldId);
+        CacheRec(RecId, RecTmMSecs);
+        if ((InitP || RecN > 0) && RecTmMSecs < MxTimestamp) {
+            AddLateRec(RecId, RecTmMSecs);
+        } else {
+            MxTimestamp = RecTmMSecs;
+        }
+    }
+    InitP = true;
+    // moving to the largest timestamp covers the whole batch: forget interval
+    // grows from A and update interval from C to include all the records
+    OnTime(MxTimestamp);
+}
+
 template <class TVal>
 void TWinBuf<TVal>::OnTime(const uint64& TmMsec) {
     InitP = true;
 
-    Timestamp = TmMsec;
+    // buffer never moves back, late records are added by AddLateRec
+    if (TmMsec > Timestamp) { Timestamp = TmMsec; }
 
     A = B;
     // B = first record ID in the buffer, or first record ID after the buffer (indicates an empty buffer)
-    while (BeforeBuffer(B, Timestamp)) {
+    while (BeforeBuffer(B, Timestamp) || IsLateRec(B)) {
         B++;
     }
 
     C = D;
     // D = the first record ID after the buffer
-    while (!AfterBuffer(D, Timestamp)) {
+    while (!AfterBuffer(D, Timestamp) || IsLateRec(D)) {
         D++;
     }
 
@@ -167,11 +192,105 @@ void TWinBuf<TVal>::OnTime(const uint64& TmMsec) {
     // (both incomming and outgoing at the same time)
     // C + Skip, D - 1
     for (uint64 RecId = C; RecId < D; RecId++) {
-        RecUpdate(RecId);
+        if (!IsLateRec(RecId)) { RecUpdate(RecId); }
     }
+    UpdateLate();
+    TrimCache();
     //Print(true);
 }
 
+template <class TVal>
+void TWinBuf<TVal>::AddLateRec(const uint64& RecId, const uint64& RecTmMSecs) {
+    LateRecIdSet.AddKey(RecId);
+    // the next update decides if it enters the buffer or was already passed by it
+    LatePendingV.AddSorted(TUInt64Pr(RecTmMSecs, RecId));
+}
+
+template <class TVal>
+void TWinBuf<TVal>::UpdateLate() {
+    LateInV.Clr(false); LateOutV.Clr(false);
+    if (!LateRecIdSet.Empty()) {
+        // intervals will not visit records before A again
+        TUInt64V OldRecIdV;
+        int KeyId = LateRecIdSet.FFirstKeyId();
+        while (LateRecIdSet.FNextKeyId(KeyId)) {
+            if (LateRecIdSet.GetKey(KeyId) < A) { OldRecIdV.Add(LateRecIdSet.GetKey(KeyId)); }
+        }
+        for (const uint64 RecId : OldRecIdV) { LateRecIdSet.DelKey(RecId); }
+        LateRecIdSet.Defrag();
+    }
+    // late records falling out of the buffer
+    int OutN = 0;
+    while (OutN < LateWinV.Len() && BeforeBufferTm(LateWinV[OutN].Val1, Timestamp)) { OutN++; }
+    if (OutN > 0) {
+        LateWinV.GetSubValV(0, OutN - 1, LateOutV);
+        LateWinV.Del(0, OutN - 1);
+    }
+    // late records entering the buffer, unless they also fell out already
+    int InN = 0;
+    while (InN < LatePendingV.Len() && !AfterBufferTm(LatePendingV[InN].Val1, Timestamp)) {
+        const TUInt64Pr& TmRecId = LatePendingV[InN];
+        if (BeforeBufferTm(TmRecId.Val1, Timestamp)) {
+            LateDropped++;
+        } else {
+            LateInV.Add(TmRecId);
+            LateWinV.AddSorted(TmRecId);
+            RecUpdate(TmRecId.Val2);
+        }
+        InN++;
+    }
+    if (InN > 0) { LatePendingV.Del(0, InN - 1); }
+    // collect IDs of changed records when late records are involved
+    LateP = !LateRecIdSet.Empty() || !LateWinV.Empty() || !LateInV.Empty() || !LateOutV.Empty();
+    InRecIdV.Clr(false); OutRecIdV.Clr(false); WinRecIdV.Clr(false);
+    if (!LateP) { return; }
+    AddInOrderRecIdV(TMath::Mx(B.Val, C.Val), D, InRecIdV);
+    for (const TUInt64Pr& TmRecId : LateInV) { InRecIdV.Add(TmRecId.Val2); }
+    AddInOrderRecIdV(A, TMath::Mn(B.Val, C.Val), OutRecIdV);
+    for (const TUInt64Pr& TmRecId : LateOutV) { OutRecIdV.Add(TmRecId.Val2); }
+    // merge records from the interval with late records by timestamp
+    TUInt64V BufRecIdV; AddInOrderRecIdV(B, D, BufRecIdV);
+    int BufRecN = 0, LateRecN = 0;
+    while (BufRecN < BufRecIdV.Len() || LateRecN < LateWinV.Len()) {
+        if (LateRecN == LateWinV.Len() || (BufRecN < BufRecIdV.Len() &&
+                Time(BufRecIdV[BufRecN]) <= LateWinV[LateRecN].Val1)) {
+            WinRecIdV.Add(BufRecIdV[BufRecN++]);
+        } else {
+            WinRecIdV.Add(LateWinV[LateRecN++].Val2);
+        }
+    }
+}
+
+template <class TVal>
+void TWinBuf<TVal>::AddInOrderRecIdV(const uint64& StartId, const uint64& EndId, TUInt64V& RecIdV) const {
+    for (uint64 RecId = StartId; RecId < EndId; RecId++) {
+        if (!LateRecIdSet.IsKey(RecId)) { RecIdV.Add(RecId); }
+    }
+}
+
+template <class TVal>
+void TWinBuf<TVal>::CacheRec(const uint64& RecId, const uint64& RecTmMSecs) {
+    if (!CacheP) { return; }
+    // records arrive with consecutive IDs, start over if some were skipped
+    if (!CacheV.Empty() && RecId != CacheFirstRecId + CacheV.Len()) { CacheV.Clr(); }
+    if (CacheV.Empty()) { CacheFirstRecId = RecId; }
+    // read the value now, the record can leave the store before it leaves the buffer
+    CacheV.Push(TPair<TUInt64, TVal>(RecTmMSecs, GetRecVal(RecId)));
+}
+
+template <class TVal>
+void TWinBuf<TVal>::TrimCache() {
+    if (CacheV.Empty()) { return; }
+    // records before A are not visited again, except for late records
+    uint64 MnRecId = A;
+    for (const TUInt64Pr& TmRecId : LatePendingV) { MnRecId = TMath::Mn(MnRecId, TmRecId.Val2.Val); }
+    for (const TUInt64Pr& TmRecId : LateWinV) { MnRecId = TMath::Mn(MnRecId, TmRecId.Val2.Val); }
+    for (const TUInt64Pr& TmRecId : LateOutV) { MnRecId = TMath::Mn(MnRecId, TmRecId.Val2.Val); }
+    while (!CacheV.Empty() && CacheFirstRecId < MnRecId) {
+        CacheV.PopFront(); CacheFirstRecId++;
+    }
+}
+
 template <class TVal>
 TWinBuf<TVal>::TWinBuf(const TWPt<TBase>& Base, const PJsonVal& ParamVal) : TStreamAggr(Base, ParamVal) {
     // parse out input and output fields
@@ -185,29 +304,67 @@ TWinBuf<TVal>::TWinBuf(const TWPt<TBase>& Base, const PJsonVal& ParamVal) : TStr
     ParamVal->AssertObjKeyNum("winsize", __FUNCTION__);
     WinSizeMSecs = ParamVal->GetObjUInt64("winsize");
     DelayMSecs = ParamVal->GetObjUInt64("delay", 0);
+    CacheP = ParamVal->GetObjBool("cache", false);
     // make sure parameters make sense
     QmAssertR(Store->GetFieldDesc(TimeFieldId).IsTm(), "[Window buffer] field " + TimeFieldNm + " not of type 'datetime'");
 }
 
 template <class TVal>
 void TWinBuf<TVal>::LoadState(TSIn& SIn) {
+    // state saved before late records and the cache starts with the initialization
+    // flag (zero or one byte), newer state starts with the format marker -1
+    const bool FormatP = ((uchar)SIn.PeekCh() == 0xFF);
+    if (FormatP) { TInt Format(SIn); }
     InitP.Load(SIn);
     A.Load(SIn);
     B.Load(SIn);
     C.Load(SIn);
     D.Load(SIn);
     Timestamp.Load(SIn);
+    if (FormatP) {
+        LateRecIdSet.Load(SIn);
+        LatePendingV.Load(SIn);
+        LateWinV.Load(SIn);
+        LateInV.Load(SIn);
+        LateOutV.Load(SIn);
+        LateDropped.Load(SIn);
+        LateP.Load(SIn);
+        InRecIdV.Load(SIn);
+        OutRecIdV.Load(SIn);
+        WinRecIdV.Load(SIn);
+        CacheFirstRecId.Load(SIn);
+        CacheV.Load(SIn);
+    } else {
+        // no late records, values are read from the store
+        LateRecIdSet.Clr(); LatePendingV.Clr(); LateWinV.Clr();
+        LateInV.Clr(); LateOutV.Clr(); LateDropped = 0;
+        LateP = false; InRecIdV.Clr(); OutRecIdV.Clr(); WinRecIdV.Clr();
+        CacheFirstRecId = 0; CacheV.Clr();
+    }
     TestValid(); // checks if the buffer exists in store
 }
 
 template <class TVal>
 void TWinBuf<TVal>::SaveState(TSOut& SOut) const {
+    TInt(-1).Save(SOut);
     InitP.Save(SOut);
     A.Save(SOut);
     B.Save(SOut);
     C.Save(SOut);
     D.Save(SOut);
     Timestamp.Save(SOut);
+    LateRecIdSet.Save(SOut);
+    LatePendingV.Save(SOut);
+    LateWinV.Save(SOut);
+    LateInV.Save(SOut);
+    LateOutV.Save(SOut);
+    LateDropped.Save(SOut);
+    LateP.Save(SOut);
+    InRecIdV.Save(SOut);
+    OutRecIdV.Save(SOut);
+    WinRecIdV.Save(SOut);
+    CacheFirstRecId.Save(SOut);
+    CacheV.Save(SOut);
 }
 
 template <class TVal>
@@ -218,33 +375,47 @@ void TWinBuf<TVal>::Reset() {
     C = Store->GetRecs() == 0 ? 0 : Store->GetLastRecId() + 1;
     D = Store->GetRecs() == 0 ? 0 : Store->GetLastRecId() + 1;
     Timestamp = 0;
+    LateRecIdSet.Clr(); LatePendingV.Clr(); LateWinV.Clr();
+    LateInV.Clr(); LateOutV.Clr(); LateDropped = 0;
+    LateP = false; InRecIdV.Clr(); OutRecIdV.Clr(); WinRecIdV.Clr();
+    CacheFirstRecId = 0; CacheV.Clr();
 }
 
 template <class TVal>
 void TWinBuf<TVal>::GetInValV(TVec<TVal>& ValV) const {
     EAssertR(IsInit(), "WinBuf not initialized yet!");
+    if (LateP) {
+        ValV.Reserve(InRecIdV.Len(), InRecIdV.Len());
+        for (int RecN = 0; RecN < InRecIdV.Len(); RecN++) { ValV[RecN] = GetBufVal(InRecIdV[RecN]); }
+        return;
+    }
     int Skip = B > C ? int(B - C) : 0;
     int UpdateRecords = int(D - C) - Skip;
-    if (ValV.Len() != UpdateRecords) { ValV.Gen(UpdateRecords); }
+    ValV.Reserve(UpdateRecords, UpdateRecords);
     // iterate
-    if (UpdateRecords > 0) {
+    if (!CacheP && UpdateRecords > 0) {
         EAssertR(Store->IsRecId(C + Skip) && Store->IsRecId(C + Skip + UpdateRecords - 1), 
             "WinBuf::GetInValV record not in store! Possible reason: store is windowed and window is too "
             "small and it does not fully contain the buffer");
     }
     for (int RecN = 0; RecN < UpdateRecords; RecN++) {
-        ValV[RecN] = GetRecVal(C + Skip + RecN);
+        ValV[RecN] = GetBufVal(C + Skip + RecN);
     }
 }
 
 template <class TVal>
 void TWinBuf<TVal>::GetInTmMSecsV(TUInt64V& MSecsV) const {
     EAssertR(IsInit(), "WinBuf not initialized yet!");
+    if (LateP) {
+        MSecsV.Reserve(InRecIdV.Len(), InRecIdV.Len());
+        for (int RecN = 0; RecN < InRecIdV.Len(); RecN++) { MSecsV[RecN] = Time(InRecIdV[RecN]); }
+        return;
+    }
     int Skip = B > C ? int(B - C) : 0;
     int UpdateRecords = int(D - C) - Skip;
-    if (MSecsV.Len() != UpdateRecords) { MSecsV.Gen(UpdateRecords); }
+    MSecsV.Reserve(UpdateRecords, UpdateRecords);
     // iterate
-    if (UpdateRecords > 0) {
+    if (!CacheP && UpdateRecords > 0) {
         EAssertR(Store->IsRecId(C + Skip) && Store->IsRecId(C + Skip + UpdateRecords - 1),
             "WinBuf::GetInTmMSecsV record not in store! Possible reason: store is windowed and window is too "
             "small and it does not fully contain the buffer");
@@ -257,28 +428,38 @@ void TWinBuf<TVal>::GetInTmMSecsV(TUInt64V& MSecsV) const {
 template <class TVal>
 void TWinBuf<TVal>::GetOutValV(TVec<TVal>& ValV) const {
     EAssertR(IsInit(), "WinBuf not initialized yet!");
+    if (LateP) {
+        ValV.Reserve(OutRecIdV.Len(), OutRecIdV.Len());
+        for (int RecN = 0; RecN < OutRecIdV.Len(); RecN++) { ValV[RecN] = GetBufVal(OutRecIdV[RecN]); }
+        return;
+    }
     int Skip = B > C ? int(B - C) : 0;
     int DropRecords = int(B - A) - Skip;
-    if (ValV.Len() != DropRecords) { ValV.Gen(DropRecords); }
+    ValV.Reserve(DropRecords, DropRecords);
     // iterate
-    if (DropRecords > 0) {
+    if (!CacheP && DropRecords > 0) {
         EAssertR(Store->IsRecId(A) && Store->IsRecId(A + DropRecords - 1),
             "WinBuf::GetOutValV record not in store! Possible reason: store is windowed and window is too "
             "small and it does not fully contain the buffer");
     }
     for (int RecN = 0; RecN < DropRecords; RecN++) {
-        ValV[RecN] = GetRecVal(A + RecN);
+        ValV[RecN] = GetBufVal(A + RecN);
     }
 }
 
 template <class TVal>
 void TWinBuf<TVal>::GetOutTmMSecsV(TUInt64V& MSecsV) const {
     EAssertR(IsInit(), "WinBuf not initialized yet!");
+    if (LateP) {
+        MSecsV.Reserve(OutRecIdV.Len(), OutRecIdV.Len());
+        for (int RecN = 0; RecN < OutRecIdV.Len(); RecN++) { MSecsV[RecN] = Time(OutRecIdV[RecN]); }
+        return;
+    }
     int Skip = B > C ? int(B - C) : 0;
     int DropRecords = int(B - A) - Skip;
-    if (MSecsV.Len() != DropRecords) { MSecsV.Gen(DropRecords); }
+    MSecsV.Reserve(DropRecords, DropRecords);
     // iterate
-    if (DropRecords > 0) {
+    if (!CacheP && DropRecords > 0) {
         EAssertR(Store->IsRecId(A) && Store->IsRecId(A + DropRecords - 1),
             "WinBuf::GetOutTmMSecsV record not in store! Possible reason: store is windowed and window is too "
             "small and it does not fully contain the buffer");
@@ -292,9 +473,9 @@ template <class TVal>
 void TWinBuf<TVal>::GetValV(TVec<TVal>& ValV) const {
     EAssertR(IsInit(), "WinBuf not initialized yet!");
     int Len = GetVals();
-    if (ValV.Empty()) { ValV.Gen(Len); }
+    ValV.Reserve(Len, Len);
     // iterate
-    if (Len > 0) {
+    if (Len > 0 && !LateP && !CacheP) {
         EAssertR(Store->IsRecId(B) && Store->IsRecId(B + Len - 1),
             "WinBuf::GetValV record not in store! Possible reason: store is windowed and window is too "
             "small and it does not fully contain the buffer");
@@ -308,9 +489,9 @@ template <class TVal>
 void TWinBuf<TVal>::GetTmV(TUInt64V& MSecsV) const {
     EAssertR(IsInit(), "WinBuf not initialized yet!");
     int Len = GetVals();
-    MSecsV.Gen(Len);
+    MSecsV.Reserve(Len, Len);
     // iterate
-    if (Len > 0) {
+    if (Len > 0 && !LateP && !CacheP) {
         EAssertR(Store->IsRecId(B) && Store->IsRecId(B + Len - 1),
             "WinBuf::GetTmV record not in store! Possible reason: store is windowed and window is too "
             "small and it does not fully contain the buffer");
@@ -329,6 +510,12 @@ PJsonVal TWinBuf<TVal>::SaveJson(const int& Limit) const {
     Val->AddToObj("C", C);
     Val->AddToObj("D", D);
     Val->AddToObj("timestamp", TTm::GetTmFromMSecs(Timestamp).GetWebLogDateTimeStr(true, "T"));
+    PJsonVal LateVal = TJsonVal::NewObj();
+    LateVal->AddToObj("pending", LatePendingV.Len());
+    LateVal->AddToObj("inBuffer", LateWinV.Len());
+    LateVal->AddToObj("dropped", LateDropped);
+    Val->AddToObj("late", LateVal);
+    if (CacheP) { Val->AddToObj("cached", CacheV.Len()); }
     return Val;
 }
 
@@ -336,9 +523,10 @@ template <class TVal>
 bool TWinBuf<TVal>::TestValid() const {
     // non-initialized model is valid
     if (!InitP()) { return true; }
-    uint64 LastRecTmMSecs = Time(Store->GetLastRecId());
+    // last record can be late, in which case the buffer follows the largest timestamp
+    uint64 LastRecTmMSecs = LateP ? Timestamp.Val : Time(Store->GetLastRecId());
     for (uint64 RecId = B; RecId < D; RecId++) {
-        if (!InBuffer(RecId, LastRecTmMSecs)) { return false; }
+        if (!IsLateRec(RecId) && !InBuffer(RecId, LastRecTmMSecs)) { return false; }
     }
     return true;
 }
@@ -395,10 +583,11 @@ void TWinBuf<TVal>::PrintInterval(const uint64& StartId, const uint64& EndId, co
 template <class TSignalType>
 void TWinAggr<TSignalType>::OnStep() {
     if (InAggr->IsInit()) {
-        TFltV InValV; InAggrFltIO->GetInValV(InValV);
-        TUInt64V InTmMSecsV; InAggrTmIO->GetInTmMSecsV(InTmMSecsV);
-        TFltV OutValV; InAggrFltIO->GetOutValV(OutValV);
-        TUInt64V OutTmMSecsV; InAggrTmIO->GetOutTmMSecsV(OutTmMSecsV);
+        // scratch vectors are members, so their memory is reused between steps
+        InAggrFltIO->GetInValV(InValV);
+        InAggrTmIO->GetInTmMSecsV(InTmMSecsV);
+        InAggrFltIO->GetOutValV(OutValV);
+        InAggrTmIO->GetOutTmMSecsV(OutTmMSecsV);
         Signal.Update(InValV, InTmMSecsV, OutValV, OutTmMSecsV);
     }
 }
@@ -426,10 +615,11 @@ PJsonVal TWinAggr<TSignalType>::SaveJson(const int& Limit) const {
 template <class TSignalType>
 void TWinAggrSpVec<TSignalType>::OnStep() {
     if (InAggr->IsInit()) {
-        TVec<TIntFltKdV> InValV; InAggrSparseVecIO->GetInValV(InValV);
-        TUInt64V InTmMSecsV; InAggrTmIO->GetInTmMSecsV(InTmMSecsV);
-        TVec<TIntFltKdV> OutValV; InAggrSparseVecIO->GetOutValV(OutValV);
-        TUInt64V OutTmMSecsV; InAggrTmIO->GetOutTmMSecsV(OutTmMSecsV);
+        // scratch vectors are members, so their memory is reused between steps
+        InAggrSparseVecIO->GetInValV(InValV);
+        InAggrTmIO->GetInTmMSecsV(InTmMSecsV);
+        InAggrSparseVecIO->GetOutValV(OutValV);
+        InAggrTmIO->GetOutTmMSecsV(OutTmMSecsV);
         Signal.Update(InValV, InTmMSecsV, OutValV, OutTmMSecsV);
     };
 }
@@ -257,6 +257,21 @@ uint TJoinSeq::GetEndStoreId(const TWPt<TBase>& Base) const {
     return GetEndStore(Base)->GetStoreId();
 }
 
+bool TJoinSeq::PrepConcurrentRead(const TWPt<TBase>& Base) const {
+    uint LastStoreId = StartStoreId;
+    for (int JoinIdN = 0; JoinIdN < JoinIdV.Len(); JoinIdN++) {
+        TWPt<TStore> Store = Base->GetStoreByStoreId(LastStoreId);
+        const TJoinDesc& JoinDesc = Store->GetJoinDesc(JoinIdV[JoinIdN].Val1);
+        // index joins go through index cache, which is not thread safe
+        if (JoinDesc.IsIndexJoin()) { return false; }
+        // joined store must support concurrent reads
+        TWPt<TStore> JoinStore = JoinDesc.GetJoinStore(Base);
+        if (!JoinStore->PrepConcurrentRead()) { return false; }
+        LastStoreId = JoinStore->GetStoreId();
+    }
+    return true;
+}
+
 TStr TJoinSeq::GetJoinPathStr(const TWPt<TBase>& Base, const TStr& SepStr) const {
     if (Empty()) { return TStr(); }
     TStr JoinPathStr;
@@ -2210,13 +2225,13 @@ PRecSet TRec::DoJoin(const TWPt<TBase>& Base, const TJoinSeq& JoinSeq) const {
 }
 
 TRec TRec::DoSingleJoin(const TWPt<TBase>& Base, const int& JoinId) const {
-    PStore JoinStore = Store->GetJoinDesc(JoinId).GetJoinStore(Base);
+    TWPt<TStore> JoinStore = Store->GetJoinDesc(JoinId).GetJoinStore(Base);
     return TRec(JoinStore, GetFieldJoinRecId(JoinId), GetFieldJoinFq(JoinId));
 }
 
 TRec TRec::DoSingleJoin(const TWPt<TBase>& Base, const TStr& JoinNm) const {
     const int& JoinId = Store->GetJoinId(JoinNm);
-    PStore JoinStore = Store->GetJoinDesc(JoinId).GetJoinStore(Base);
+    TWPt<TStore> JoinStore = Store->GetJoinDesc(JoinId).GetJoinStore(Base);
     return TRec(JoinStore, GetFieldJoinRecId(JoinId), GetFieldJoinFq(JoinId));
 }
 
@@ -3515,134 +3530,134 @@ void TRecSet::FilterByFq(const int& MinFq, const int& MaxFq) {
     FilterBy<TRecFilterByRecFq>(TRecFilterByRecFq(Store->GetBase(), MinFq, MaxFq));
 }
 
-void TRecSet::FilterByFieldBool(const int& FieldId, const bool& Val) {
+void TRecSet::FilterByFieldBool(const int& FieldId, const bool& Val, const int& Threads) {
     // get store and field type
     const TFieldDesc& Desc = Store->GetFieldDesc(FieldId);
     QmAssertR(Desc.IsBool(), "Wrong field type, boolean expected");
     // apply the filter
-    FilterBy<TRecFilterByFieldBool>(TRecFilterByFieldBool(Store->GetBase(), FieldId, Val));
+    FilterBy<TRecFilterByFieldBool>(TRecFilterByFieldBool(Store->GetBase(), FieldId, Val), Threads);
 }
 
-void TRecSet::FilterByFieldInt(const int& FieldId, const int& MinVal, const int& MaxVal) {
+void TRecSet::FilterByFieldInt(const int& FieldId, const int& MinVal, const int& MaxVal, const int& Threads) {
     // get store and field type
     const TFieldDesc& Desc = Store->GetFieldDesc(FieldId);
     QmAssertR(Desc.IsInt() || (Desc.IsStr() && Desc.IsCodebook()), "Wrong field type, integer or codebook string expected");
     // apply the filter
-    FilterBy<TRecFilterByFieldInt>(TRecFilterByFieldInt(Store->GetBase(), FieldId, MinVal, MaxVal));
+    FilterBy<TRecFilterByFieldInt>(TRecFilterByFieldInt(Store->GetBase(), FieldId, MinVal, MaxVal), Threads);
 }
 
-void TRecSet::FilterByFieldInt16(const int& FieldId, const int16& MinVal, const int16& MaxVal) {
+void TRecSet::FilterByFieldInt16(const int& FieldId, const int16& MinVal, const int16& MaxVal, const int& Threads) {
     // get store and field type
     const TFieldDesc& Desc = Store->GetFieldDesc(FieldId);
     QmAssertR(Desc.IsInt16(), "Wrong field type, integer expected");
     // apply the filter
-    FilterBy<TRecFilterByFieldInt16>(TRecFilterByFieldInt16(Store->GetBase(), FieldId, MinVal, MaxVal));
+    FilterBy<TRecFilterByFieldInt16>(TRecFilterByFieldInt16(Store->GetBase(), FieldId, MinVal, MaxVal), Threads);
 }
 
-void TRecSet::FilterByFieldInt64(const int& FieldId, const int64& MinVal, const int64& MaxVal) {
+void TRecSet::FilterByFieldInt64(const int& FieldId, const int64& MinVal, const int64& MaxVal, const int& Threads) {
     // get store and field type
     const TFieldDesc& Desc = Store->GetFieldDesc(FieldId);
     QmAssertR(Desc.IsInt64(), "Wrong field type, integer expected");
     // apply the filter
-    FilterBy<TRecFilterByFieldInt64>(TRecFilterByFieldInt64(Store->GetBase(), FieldId, MinVal, MaxVal));
+    FilterBy<TRecFilterByFieldInt64>(TRecFilterByFieldInt64(Store->GetBase(), FieldId, MinVal, MaxVal), Threads);
 }
 
-void TRecSet::FilterByFieldByte(const int& FieldId, const uchar& MinVal, const uchar& MaxVal) {
+void TRecSet::FilterByFieldByte(const int& FieldId, const uchar& MinVal, const uchar& MaxVal, const int& Threads) {
     // get store and field type
     const TFieldDesc& Desc = Store->GetFieldDesc(FieldId);
     QmAssertR(Desc.IsByte(), "Wrong field type, integer expected");
     // apply the filter
-    FilterBy<TRecFilterByFieldByte>(TRecFilterByFieldByte(Store->GetBase(), FieldId, MinVal, MaxVal));
+    FilterBy<TRecFilterByFieldByte>(TRecFilterByFieldByte(Store->GetBase(), FieldId, MinVal, MaxVal), Threads);
 }
 
-void TRecSet::FilterByFieldUInt(const int& FieldId, const uint& MinVal, const uint& MaxVal) {
+void TRecSet::FilterByFieldUInt(const int& FieldId, const uint& MinVal, const uint& MaxVal, const int& Threads) {
     // get store and field type
     const TFieldDesc& Desc = Store->GetFieldDesc(FieldId);
     QmAssertR(Desc.IsUInt(), "Wrong field type, integer expected");
     // apply the filter
-    FilterBy<TRecFilterByFieldUInt>(TRecFilterByFieldUInt(Store->GetBase(), FieldId, MinVal, MaxVal));
+    FilterBy<TRecFilterByFieldUInt>(TRecFilterByFieldUInt(Store->GetBase(), FieldId, MinVal, MaxVal), Threads);
 }
 
-void TRecSet::FilterByFieldUInt16(const int& FieldId, const uint16& MinVal, const uint16& MaxVal) {
+void TRecSet::FilterByFieldUInt16(const int& FieldId, const uint16& MinVal, const uint16& MaxVal, const int& Threads) {
     // get store and field type
     const TFieldDesc& Desc = Store->GetFieldDesc(FieldId);
     QmAssertR(Desc.IsUInt16(), "Wrong field type, integer expected");
     // apply the filter
-    FilterBy<TRecFilterByFieldUInt16>(TRecFilterByFieldUInt16(Store->GetBase(), FieldId, MinVal, MaxVal));
+    FilterBy<TRecFilterByFieldUInt16>(TRecFilterByFieldUInt16(Store->GetBase(), FieldId, MinVal, MaxVal), Threads);
 }
 
-void TRecSet::FilterByFieldFlt(const int& FieldId, const double& MinVal, const double& MaxVal) {
+void TRecSet::FilterByFieldFlt(const int& FieldId, const double& MinVal, const double& MaxVal, const int& Threads) {
     // get store and field type
     const TFieldDesc& Desc = Store->GetFieldDesc(FieldId);
     QmAssertR(Desc.IsFlt(), "Wrong field type, numeric expected");
     // apply the filter
-    FilterBy<TRecFilterByFieldFlt>(TRecFilterByFieldFlt(Store->GetBase(), FieldId, MinVal, MaxVal));
+    FilterBy<TRecFilterByFieldFlt>(TRecFilterByFieldFlt(Store->GetBase(), FieldId, MinVal, MaxVal), Threads);
 }
 
-void TRecSet::FilterByFieldSFlt(const int& FieldId, const float& MinVal, const float& MaxVal) {
+void TRecSet::FilterByFieldSFlt(const int& FieldId, const float& MinVal, const float& MaxVal, const int& Threads) {
     // get store and field type
     const TFieldDesc& Desc = Store->GetFieldDesc(FieldId);
     QmAssertR(Desc.IsFlt(), "Wrong field type, numeric expected");
     // apply the filter
-    FilterBy<TRecFilterByFieldSFlt>(TRecFilterByFieldSFlt(Store->GetBase(), FieldId, MinVal, MaxVal));
+    FilterBy<TRecFilterByFieldSFlt>(TRecFilterByFieldSFlt(Store->GetBase(), FieldId, MinVal, MaxVal), Threads);
 }
 
-void TRecSet::FilterByFieldUInt64(const int& FieldId, const uint64& MinVal, const uint64& MaxVal) {
+void TRecSet::FilterByFieldUInt64(const int& FieldId, const uint64& MinVal, const uint64& MaxVal, const int& Threads) {
     // get store and field type
     const TFieldDesc& Desc = Store->GetFieldDesc(FieldId);
     QmAssertR(Desc.IsUInt64(), "Wrong field type, integer expected");
     // apply the filter
-    FilterBy<TRecFilterByFieldUInt64>(TRecFilterByFieldUInt64(Store->GetBase(), FieldId, MinVal, MaxVal));
+    FilterBy<TRecFilterByFieldUInt64>(TRecFilterByFieldUInt64(Store->GetBase(), FieldId, MinVal, MaxVal), Threads);
 }
 
-void TRecSet::FilterByFieldStr(const int& FieldId, const TStr& FldVal) {
+void TRecSet::FilterByFieldStr(const int& FieldId, const TStr& FldVal, const int& Threads) {
     // get store and field type
     const TFieldDesc& Desc = Store->GetFieldDesc(FieldId);
     QmAssertR(Desc.IsStr(), "Wrong field type, string expected");
     // apply the filter
-    FilterBy<TRecFilterByFieldStr>(TRecFilterByFieldStr(Store->GetBase(), FieldId, FldVal));
+    FilterBy<TRecFilterByFieldStr>(TRecFilterByFieldStr(Store->GetBase(), FieldId, FldVal), Threads);
 }
 
-void TRecSet::FilterByFieldStr(const int& FieldId, const TStr& FldVal, const TStr& FldValMax) {
+void TRecSet::FilterByFieldStr(const int& FieldId, const TStr& FldVal, const TStr& FldValMax, const int& Threads) {
     // get store and field type
     const TFieldDesc& Desc = Store->GetFieldDesc(FieldId);
     QmAssertR(Desc.IsStr(), "Wrong field type, string expected");
     // apply the filter
-    FilterBy<TRecFilterByFieldStrRange>(TRecFilterByFieldStrRange(Store->GetBase(), FieldId, FldVal, FldValMax));
+    FilterBy<TRecFilterByFieldStrRange>(TRecFilterByFieldStrRange(Store->GetBase(), FieldId, FldVal, FldValMax), Threads);
 }
 
-void TRecSet::FilterByFieldStr(const int& FieldId, const TStrSet& ValSet) {
+void TRecSet::FilterByFieldStr(const int& FieldId, const TStrSet& ValSet, const int& Threads) {
     // get store and field type
     const TFieldDesc& Desc = Store->GetFieldDesc(FieldId);
     QmAssertR(Desc.IsStr(), "Wrong field type, string expected");
     // apply the filter
-    FilterBy<TRecFilterByFieldStrSet>(TRecFilterByFieldStrSet(Store->GetBase(), FieldId, ValSet));
+    FilterBy<TRecFilterByFieldStrSet>(TRecFilterByFieldStrSet(Store->GetBase(), FieldId, ValSet), Threads);
 }
 
-void TRecSet::FilterByFieldTm(const int& FieldId, const uint64& MinVal, const uint64& MaxVal) {
+void TRecSet::FilterByFieldTm(const int& FieldId, const uint64& MinVal, const uint64& MaxVal, const int& Threads) {
     // get store and field type
     const TFieldDesc& Desc = Store->GetFieldDesc(FieldId);
     QmAssertR(Desc.IsTm() || Desc.IsUInt64(), "Wrong field type, time expected");
     // apply the filter
-    FilterBy<TRecFilterByFieldTm>(TRecFilterByFieldTm(Store->GetBase(), FieldId, MinVal, MaxVal));
+    FilterBy<TRecFilterByFieldTm>(TRecFilterByFieldTm(Store->GetBase(), FieldId, MinVal, MaxVal), Threads);
 }
 
-void TRecSet::FilterByFieldTm(const int& FieldId, const TTm& MinVal, const TTm& MaxVal) {
+void TRecSet::FilterByFieldTm(const int& FieldId, const TTm& MinVal, const TTm& MaxVal, const int& Threads) {
     // get store and field type
     const TFieldDesc& Desc = Store->GetFieldDesc(FieldId);
     QmAssertR(Desc.IsTm(), "Wrong field type, time expected");
     // apply the filter
-    FilterBy<TRecFilterByFieldTm>(TRecFilterByFieldTm(Store->GetBase(), FieldId, MinVal, MaxVal));
+    FilterBy<TRecFilterByFieldTm>(TRecFilterByFieldTm(Store->GetBase(), FieldId, MinVal, MaxVal), Threads);
 }
 
-void TRecSet::FilterByFieldSafe(const int& FieldId, const uint64& MinVal, const uint64& MaxVal) {
+void TRecSet::FilterByFieldSafe(const int& FieldId, const uint64& MinVal, const uint64& MaxVal, const int& Threads) {
     // get store and field type
     const TFieldDesc& Desc = Store->GetFieldDesc(FieldId);
     QmAssertR(Desc.IsTm() || Desc.IsUInt64() || Desc.IsInt64() || Desc.IsUInt() ||
               Desc.IsInt() || Desc.IsUInt16() || Desc.IsInt16() || Desc.IsByte(),
               "Wrong field type, numeric field expected");
     // apply the filter
-    FilterBy<TRecFilterByFieldIntSafe>(TRecFilterByFieldIntSafe(Store->GetBase(), FieldId, MinVal, MaxVal));
+    FilterBy<TRecFilterByFieldIntSafe>(TRecFilterByFieldIntSafe(Store->GetBase(), FieldId, MinVal, MaxVal), Threads);
 }
 
 void TRecSet::FilterByIndexJoin(const TWPt<TBase>& Base, const int& JoinId, const uint64& MinVal, const uint64& MaxVal) {
@@ -3652,6 +3667,15 @@ void TRecSet::FilterByIndexJoin(const TWPt<TBase>& Base, const int& JoinId, cons
     FilterBy<TRecFilterByIndexJoin>(TRecFilterByIndexJoin(Store, JoinId, MinVal, MaxVal));
 }
 
+int TRecSet::GetScanThreads(const int& Threads) const {
+    // not worth splitting small sets
+    if (Threads <= 1 || GetRecs() < 2 * ScanChunkSize) { return 1; }
+    // store needs to support concurrent reads
+    if (!Store->PrepConcurrentRead()) { return 1; }
+    // no point having more threads than chunks
+    return TInt::GetMn(Threads, (GetRecs() + ScanChunkSize - 1) / ScanChunkSize);
+}
+
 TVec<PRecSet> TRecSet::SplitByFieldTm(const int& FieldId, const uint64& DiffMSecs) const {
     // get store and field type
     const TFieldDesc& Desc = Store->GetFieldDesc(FieldId);
@@ -5101,6 +5125,309 @@ bool TQuery::IsOk(const TWPt<TBase>& Base, TStr& MsgStr) const {
     }
 }
 
+///////////////////////////////
+// QMiner-Query-View
+TQueryView::TQueryView(const TWPt<TBase>& _Base, const TStr& _ViewNm, const PJsonVal& _QueryVal):
+        Base(_Base), ViewNm(_ViewNm), QueryVal(_QueryVal), IncrementalP(false), StaleP(true) {
+
+    Trigger = new TTrigger(this);
+    Exec();
+}
+
+TQueryView::TQueryView(const TWPt<TBase>& _Base, TSIn& SIn): Base(_Base), ViewNm(SIn) {
+    QueryVal = TJsonVal::GetValFromStr(TStr(SIn));
+    StaleP.Load(SIn);
+    RecIdSet.Load(SIn);
+    // parse the query and register triggers
+    Query = TQuery::New(Base, QueryVal);
+    Store = Query->GetStore(Base);
+    IncrementalP = IsIncremental(Base, Query->GetQueryItem());
+    Trigger = new TTrigger(this);
+    AddTriggers();
+    // incremental view must start from fresh results
+    if (IncrementalP && StaleP) { Exec(); }
+}
+
+TQueryView::~TQueryView() {
+    DelTriggers();
+}
+
+void TQueryView::Exec() {
+    // parse the query again, so we pick up words which were not in the vocabulary before
+    Query = TQuery::New(Base, QueryVal);
+    Store = Query->GetStore(Base);
+    const bool NewIncrementalP = IsIncremental(Base, Query->GetQueryItem());
+    // update triggers when the mode changed
+    if (TriggerStoreV.Empty() || NewIncrementalP != IncrementalP) {
+        DelTriggers();
+        IncrementalP = NewIncrementalP;
+        AddTriggers();
+    }
+    // execute the query, without sorting and limit, and remember the records
+    PRecSet ResSet = Base->Search(Query->GetQueryItem());
+    RecIdSet.Gen(ResSet->GetRecs());
+    for (int RecN = 0; RecN < ResSet->GetRecs(); RecN++) {
+        RecIdSet.AddKey(ResSet->GetRecId(RecN));
+    }
+    StaleP = false;
+    RecSet.Clr();
+}
+
+void TQueryView::AddTriggers() {
+    if (IncrementalP) {
+        // changes in the result store are enough
+        Store->AddTrigger(Trigger);
+        TriggerStoreV.Add(Store);
+    } else {
+        // any change can affect the results
+        for (int StoreN = 0; StoreN < Base->GetStores(); StoreN++) {
+            TWPt<TStore> TriggerStore = Base->GetStoreByStoreN(StoreN);
+            TriggerStore->AddTrigger(Trigger);
+            TriggerStoreV.Add(TriggerStore);
+        }
+    }
+}
+
+void TQueryView::DelTriggers() {
+    for (int StoreN = 0; StoreN < TriggerStoreV.Len(); StoreN++) {
+        TriggerStoreV[StoreN]->DelTrigger(Trigger);
+    }
+    TriggerStoreV.Clr();
+}
+
+void TQueryView::OnAdd(const TRec& Rec) {
+    if (!IncrementalP) { StaleP = true; RecSet.Clr(); return; }
+    if (IsMatch(Base, Query->GetQueryItem(), Rec)) {
+        RecIdSet.AddKey(Rec.GetRecId());
+        RecSet.Clr();
+    }
+}
+
+void TQueryView::OnUpdate(const TRec& Rec) {
+    if (!IncrementalP) { StaleP = true; RecSet.Clr(); return; }
+    const uint64 RecId = Rec.GetRecId();
+    const bool MatchP = IsMatch(Base, Query->GetQueryItem(), Rec);
+    if (MatchP && !RecIdSet.IsKey(RecId)) {
+        RecIdSet.AddKey(RecId);
+        RecSet.Clr();
+    } else if (!MatchP && RecIdSet.IsKey(RecId)) {
+        RecIdSet.DelKey(RecId);
+        RecSet.Clr();
+    }
+}
+
+void TQueryView::OnDelete(const TRec& Rec) {
+    if (!IncrementalP) { StaleP = true; RecSet.Clr(); return; }
+    const uint64 RecId = Rec.GetRecId();
+    if (RecIdSet.IsKey(RecId)) {
+        RecIdSet.DelKey(RecId);
+        RecSet.Clr();
+    }
+}
+
+bool TQueryView::IsIncremental(const TWPt<TBase>& Base, const TQueryItem& QueryItem) {
+    if (QueryItem.IsLeafGix() || QueryItem.IsLeafGixSmall()) {
+        // wildchar is resolved against vocabulary at parse time
+        if (QueryItem.IsWildChar()) { return false; }
+        // words not yet in vocabulary are resolved only at parse time
+        if (!QueryItem.IsWordIds()) { return false; }
+        TKeyWordV KeyWordV; QueryItem.GetKeyWordV(KeyWordV);
+        for (int KeyWordN = 0; KeyWordN < KeyWordV.Len(); KeyWordN++) {
+            if (KeyWordV[KeyWordN].Val2 == TUInt64::Mx) { return false; }
+        }
+        // we must be able to read the words from the record fields
+        const TIndexKey& Key = Base->GetIndexVoc()->GetKey(QueryItem.GetKeyId());
+        if (Key.IsInternal() || !Key.IsFields()) { return false; }
+        const TWPt<TStore>& KeyStore = Base->GetStoreByStoreId(Key.GetStoreId());
+        for (int FieldN = 0; FieldN < Key.GetFields(); FieldN++) {
+            const TFieldDesc& FieldDesc = KeyStore->GetFieldDesc(Key.GetFieldId(FieldN));
+            const bool ValueP = Key.IsValue() && (FieldDesc.IsStr() || FieldDesc.IsStrV() || FieldDesc.IsTm());
+            const bool TextP = Key.IsText() && FieldDesc.IsStr();
+            if (!ValueP && !TextP) { return false; }
+        }
+        return true;
+    } else if (QueryItem.IsRange()) {
+        const TIndexKey& Key = Base->GetIndexVoc()->GetKey(QueryItem.GetKeyId());
+        return !Key.IsInternal() && Key.IsFields();
+    } else if (QueryItem.IsAnd() || QueryItem.IsOr() || QueryItem.IsNot()) {
+        for (int ItemN = 0; ItemN < QueryItem.GetItems(); ItemN++) {
+            if (!IsIncremental(Base, QueryItem.GetItem(ItemN))) { return false; }
+        }
+        return true;
+    } else if (QueryItem.IsStore()) {
+        return true;
+    }
+    // joins, geo-location, records and record sets
+    return false;
+}
+
+void TQueryView::GetRecWordIdV(const TWPt<TBase>& Base, const int& KeyId,
+        const TRec& Rec, TUInt64V& WordIdV) {
+
+    const TWPt<TIndexVoc>& IndexVoc = Base->GetIndexVoc();
+    const TIndexKey& Key = IndexVoc->GetKey(KeyId);
+    const TWPt<TStore>& RecStore = Rec.GetStore();
+    WordIdV.Clr();
+    for (int FieldN = 0; FieldN < Key.GetFields(); FieldN++) {
+        const int FieldId = Key.GetFieldId(FieldN);
+        if (Rec.IsFieldNull(FieldId)) { continue; }
+        const TFieldDesc& FieldDesc = RecStore->GetFieldDesc(FieldId);
+        TStrV StrV;
+        if (FieldDesc.IsStr() && Key.IsText()) {
+            // same tokenization as used by the indexer
+            TUInt64V TextWordIdV;
+            IndexVoc->GetWordIdV(KeyId, Rec.GetFieldStr(FieldId), TextWordIdV);
+            WordIdV.AddV(TextWordIdV);
+        } else if (FieldDesc.IsStr()) {
+            StrV.Add(Rec.GetFieldStr(FieldId));
+        } else if (FieldDesc.IsStrV()) {
+            Rec.GetFieldStrV(FieldId, StrV);
+        } else if (FieldDesc.IsTm()) {
+            StrV.Add(TUInt64::GetStr(Rec.GetFieldTmMSecs(FieldId)));
+        }
+        for (int StrN = 0; StrN < StrV.Len(); StrN++) {
+            if (IndexVoc->IsWordStr(KeyId, StrV[StrN])) {
+                WordIdV.Add(IndexVoc->GetWordId(KeyId, StrV[StrN]));
+            }
+        }
+    }
+}
+
+bool TQueryView::IsLeafMatch(const TWPt<TBase>& Base, const TQueryItem& QueryItem, const TRec& Rec) {
+    const int KeyId = QueryItem.GetKeyId();
+    TUInt64V RecWordIdV; GetRecWordIdV(Base, KeyId, Rec, RecWordIdV);
+    if (QueryItem.IsEqual() || QueryItem.IsNotEqual()) {
+        // record must have all the words
+        TKeyWordV KeyWordV; QueryItem.GetKeyWordV(KeyWordV);
+        bool AllP = true;
+        for (int KeyWordN = 0; KeyWordN < KeyWordV.Len() && AllP; KeyWordN++) {
+            AllP = RecWordIdV.IsIn(KeyWordV[KeyWordN].Val2);
+        }
+        return QueryItem.IsEqual() ? AllP : !AllP;
+    }
+    // greater or less, compared the same way as by TIndexWordVoc::GetAllGreater* and GetAllLess*
+    const TWPt<TIndexVoc>& IndexVoc = Base->GetIndexVoc();
+    const TIndexKey& Key = IndexVoc->GetKey(KeyId);
+    const uint64 StartWordId = QueryItem.GetWordId();
+    const TStr StartWordStr = IndexVoc->GetWordStr(KeyId, StartWordId);
+    const double StartWordFlt = Key.IsSortByFlt() ? StartWordStr.GetFlt() : 0.0;
+    for (int WordN = 0; WordN < RecWordIdV.Len(); WordN++) {
+        const uint64 WordId = RecWordIdV[WordN];
+        int Cmp = 0;
+        if (Key.IsSortById()) {
+            Cmp = (WordId > StartWordId) ? 1 : ((WordId < StartWordId) ? -1 : 0);
+        } else if (Key.IsSortByStr()) {
+            const TStr WordStr = IndexVoc->GetWordStr(KeyId, WordId);
+            Cmp = (WordStr > StartWordStr) ? 1 : ((WordStr < StartWordStr) ? -1 : 0);
+        } else if (Key.IsSortByFlt()) {
+            const double WordFlt = IndexVoc->GetWordStr(KeyId, WordId).GetFlt();
+            Cmp = (WordFlt > StartWordFlt) ? 1 : ((WordFlt < StartWordFlt) ? -1 : 0);
+        }
+        if (QueryItem.IsGreater() && Cmp > 0) { return true; }
+        if (QueryItem.IsLess() && Cmp < 0) { return true; }
+    }
+    return false;
+}
+
+/// Check if value falls into the inclusive range, as used by TBTreeIndex::SearchRange
+template <class TVal, class TRange>
+inline bool IsInRange(const TVal& Val, const TRange& MnMx) {
+    return (MnMx.Val1.Val <= Val) && (Val <= MnMx.Val2.Val);
+}
+
+bool TQueryView::IsRangeMatch(const TWPt<TBase>& Base, const TQueryItem& QueryItem, const TRec& Rec) {
+    const TIndexKey& Key = Base->GetIndexVoc()->GetKey(QueryItem.GetKeyId());
+    for (int FieldN = 0; FieldN < Key.GetFields(); FieldN++) {
+        const int FieldId = Key.GetFieldId(FieldN);
+        if (Rec.IsFieldNull(FieldId)) { continue; }
+        bool MatchP = false;
+        if (QueryItem.IsRangeByte()) {
+            MatchP = IsInRange(Rec.GetFieldByte(FieldId), QueryItem.GetRangeByteMinMax());
+        } else if (QueryItem.IsRangeInt()) {
+            MatchP = IsInRange(Rec.GetFieldInt(FieldId), QueryItem.GetRangeIntMinMax());
+        } else if (QueryItem.IsRangeInt16()) {
+            MatchP = IsInRange(Rec.GetFieldInt16(FieldId), QueryItem.GetRangeInt16MinMax());
+        } else if (QueryItem.IsRangeInt64()) {
+            MatchP = IsInRange(Rec.GetFieldInt64(FieldId), QueryItem.GetRangeInt64MinMax());
+        } else if (QueryItem.IsRangeUInt()) {
+            MatchP = IsInRange(Rec.GetFieldUInt(FieldId), QueryItem.GetRangeUIntMinMax());
+        } else if (QueryItem.IsRangeUInt16()) {
+            MatchP = IsInRange(Rec.GetFieldUInt16(FieldId), QueryItem.GetRangeUInt16MinMax());
+        } else if (QueryItem.IsRangeUInt64()) {
+            MatchP = IsInRange(Rec.GetFieldUInt64(FieldId), QueryItem.GetRangeUInt64MinMax());
+        } else if (QueryItem.IsRangeTm()) {
+            MatchP = IsInRange(Rec.GetFieldTmMSecs(FieldId), QueryItem.GetRangeUInt64MinMax());
+        } else if (QueryItem.IsRangeFlt()) {
+            MatchP = IsInRange(Rec.GetFieldFlt(FieldId), QueryItem.GetRangeFltMinMax());
+        } else if (QueryItem.IsRangeSFlt()) {
+            MatchP = IsInRange(Rec.GetFieldSFlt(FieldId), QueryItem.GetRangeSFltMinMax());
+        }
+        if (MatchP) { return true; }
+    }
+    return false;
+}
+
+bool TQueryView::IsMatch(const TWPt<TBase>& Base, const TQueryItem& QueryItem, const TRec& Rec) {
+    if (QueryItem.IsLeafGix() || QueryItem.IsLeafGixSmall()) {
+        return IsLeafMatch(Base, QueryItem, Rec);
+    } else if (QueryItem.IsRange()) {
+        return IsRangeMatch(Base, QueryItem, Rec);
+    } else if (QueryItem.IsAnd()) {
+        for (int ItemN = 0; ItemN < QueryItem.GetItems(); ItemN++) {
+            if (!IsMatch(Base, QueryItem.GetItem(ItemN), Rec)) { return false; }
+        }
+        return true;
+    } else if (QueryItem.IsOr()) {
+        for (int ItemN = 0; ItemN < QueryItem.GetItems(); ItemN++) {
+            if (IsMatch(Base, QueryItem.GetItem(ItemN), Rec)) { return true; }
+        }
+        return false;
+    } else if (QueryItem.IsNot()) {
+        return !IsMatch(Base, QueryItem.GetItem(0), Rec);
+    } else if (QueryItem.IsStore()) {
+        return Rec.GetStoreId() == QueryItem.GetStoreId();
+    }
+    throw TQmExcept::New("QueryView: query item can not be evaluated on a record");
+}
+
+void TQueryView::Save(TSOut& SOut) const {
+    ViewNm.Save(SOut);
+    TJsonVal::GetStrFromVal(QueryVal).Save(SOut);
+    StaleP.Save(SOut);
+    RecIdSet.Save(SOut);
+}
+
+int TQueryView::GetRecs() {
+    if (StaleP) { Exec(); }
+    return RecIdSet.Len();
+}
+
+bool TQueryView::IsRecId(const uint64& RecId) {
+    if (StaleP) { Exec(); }
+    return RecIdSet.IsKey(RecId);
+}
+
+PRecSet TQueryView::GetRecSet() {
+    if (StaleP) { Exec(); }
+    if (RecSet.Empty()) {
+        TUInt64V RecIdV; RecIdSet.GetKeyV(RecIdV);
+        if (!RecIdV.IsSorted()) { RecIdV.Sort(); }
+        RecSet = TRecSet::New(Store, RecIdV);
+        if (Query->IsSort()) { Query->Sort(Base, RecSet); }
+        if (Query->IsLimit()) { RecSet = Query->GetLimit(RecSet); }
+    }
+    return RecSet;
+}
+
+PJsonVal TQueryView::GetJson() const {
+    PJsonVal ResVal = TJsonVal::NewObj();
+    ResVal->AddToObj("name", ViewNm);
+    ResVal->AddToObj("query", QueryVal);
+    ResVal->AddToObj("store", Store->GetStoreNm());
+    ResVal->AddToObj("incremental", IncrementalP.Val);
+    return ResVal;
+}
+
 ///////////////////////////////
 // GeoIndex
 TIntPr TGeoIndex::GetLocId(const TFltPr& Loc) const {
@@ -6335,13 +6662,18 @@ int TIndex::PartialFlush(const int& WndInMsec) {
 ///////////////////////////////
 // QMiner-Aggregator
 TFunRouter<PAggr, TAggr::TNewF> TAggr::NewRouter;
+TFunRouter<PAggr, TAggr::TNewFusedF> TAggr::NewFusedRouter;
 
 void TAggr::Init() {
-    Register<TAggrs::TCount>();
-    Register<TAggrs::THistogram>();
+    RegisterFused<TAggrs::TCount>();
+    RegisterFused<TAggrs::THistogram>();
     Register<TAggrs::TKeywords>();
-    Register<TAggrs::TTimeLine>();
-    Register<TAggrs::TTimeSpan>();
+    RegisterFused<TAggrs::TTimeLine>();
+    RegisterFused<TAggrs::TTimeSpan>();
+    RegisterFused<TAggrs::TDistinct>();
+    RegisterFused<TAggrs::TTopK>();
+    RegisterFused<TAggrs::TQuantiles>();
+    Register<TAggrs::TGroupBy>();
 #ifdef OG_AGGR_DOC_ATLAS
     Register<TAggrs::TDocAtlas>();
 #endif
@@ -6353,6 +6685,35 @@ PAggr TAggr::New(const TWPt<TBase>& Base, const PRecSet& RecSet, const TQueryAgg
     return NewRouter.Fun(QueryAggr.GetType())(Base, QueryAggr.GetNm(), RecSet, QueryAggr.GetParamVal());
 }
 
+void TAggr::New(const TWPt<TBase>& Base, const PRecSet& RecSet,
+        const TVec<TQueryAggr>& QueryAggrV, TVec<PAggr>& AggrV) {
+
+    // number of threads for the fused aggregates
+    int Threads = 1;
+    for (int QueryAggrN = 0; QueryAggrN < QueryAggrV.Len(); QueryAggrN++) {
+        const PJsonVal& ParamVal = QueryAggrV[QueryAggrN].GetParamVal();
+        Threads = TInt::GetMx(Threads, ParamVal->GetObjInt("threads", 1));
+    }
+    // prepare aggregates, the ones which can be fused are computed later in one pass
+    TAggrs::TFusedAggrExec FusedExec(Base, RecSet, Threads);
+    AggrV.Clr(); AggrV.Reserve(QueryAggrV.Len());
+    for (int QueryAggrN = 0; QueryAggrN < QueryAggrV.Len(); QueryAggrN++) {
+        const TQueryAggr& QueryAggr = QueryAggrV[QueryAggrN];
+        PAggr Aggr;
+        if (NewFusedRouter.IsType(QueryAggr.GetType())) {
+            Aggr = NewFusedRouter.Fun(QueryAggr.GetType())(Base, QueryAggr.GetNm(),
+                RecSet->GetStoreId(), QueryAggr.GetParamVal());
+        }
+        if (Aggr.Empty()) {
+            // not fusable, compute right away
+            AggrV.Add(New(Base, RecSet, QueryAggr));
+        } else {
+            FusedExec.AddAggr(Aggr); AggrV.Add(Aggr);
+        }
+    }
+    FusedExec.Exec();
+}
+
 ///////////////////////////////
 // QMiner-Stream-Aggregator
 TFunRouter<PStreamAggr, TStreamAggr::TNewF> TStreamAggr::NewRouter;
@@ -6375,6 +6736,7 @@ void TStreamAggr::Init() {
     Register<TStreamAggrs::TCorr>();
     Register<TStreamAggrs::TMerger>();
     Register<TStreamAggrs::TResampler>();
+    Register<TStreamAggrs::TReorderBuffer>();
     Register<TStreamAggrs::TOnlineHistogram>();
     Register<TStreamAggrs::TTDigest>();
     Register<TStreamAggrs::TChiSquare>();
@@ -6384,6 +6746,7 @@ void TStreamAggr::Init() {
     Register<TStreamAggrs::TRecFilterAggr>();    
     Register<TStreamAggrs::TEmaSpVec>();
     Register<TStreamAggrs::TWinBufSpVecSum>();
+    Register<TStreamAggrs::TKeyed>();
 }
 
 TStreamAggr::TStreamAggr(const TWPt<TBase>& _Base, const TStr& _AggrNm): Base(_Base), AggrNm(_AggrNm) {
@@ -6409,6 +6772,12 @@ PStreamAggr TStreamAggr::New(const TWPt<TBase>& Base, const TStr& TypeNm, const
     return NewRouter.Fun(TypeNm)(Base, ParamVal);
 }
 
+void TStreamAggr::OnAddRecs(const PRecSet& RecSet) {
+    for (int RecN = 0; RecN < RecSet->GetRecs(); RecN++) {
+        OnAddRec(RecSet->GetRec(RecN));
+    }
+}
+
 void TStreamAggr::LoadState(TSIn& SIn) {
     throw TQmExcept::New("TStreamAggr::_Load not implemented:" + GetAggrNm());
 };
@@ -6417,13 +6786,175 @@ void TStreamAggr::SaveState(TSOut& SOut) const {
     throw TQmExcept::New("TStreamAggr::_Save not implemented:" + GetAggrNm());
 };
 
+///////////////////////////////
+// Latency-Histogram
+int TLatencyHist::GetBucketN(const uint64& Val) {
+    // values with up to SubBucketBits+1 bits are counted exactly
+    if (Val < (2 << SubBucketBits)) { return (int)Val; }
+    // position of the highest bit
+    int HiBit = SubBucketBits + 1; uint64 HiVal = Val >> (SubBucketBits + 2);
+    while (HiVal > 0 && HiBit < MxValBits) { HiBit++; HiVal >>= 1; }
+    if (HiVal > 0) { return GetBucketN((uint64(1) << (MxValBits + 1)) - 1); }
+    // next SubBucketBits bits below the highest select the sub-bucket
+    const int SubBucketN = (int)(Val >> (HiBit - SubBucketBits));
+    return ((HiBit - SubBucketBits) << SubBucketBits) + SubBucketN;
+}
+
+uint64 TLatencyHist::GetBucketMxVal(const int& BucketN) {
+    if (BucketN < (2 << SubBucketBits)) { return (uint64)BucketN; }
+    const int Shift = (BucketN >> SubBucketBits) - 1;
+    const uint64 SubBucketN = (uint64)((BucketN & ((1 << SubBucketBits) - 1)) + (1 << SubBucketBits));
+    return ((SubBucketN + 1) << Shift) - 1;
+}
+
+void TLatencyHist::Add(const uint64& CallTicks) {
+    if (CountV.Empty()) { CountV.Gen(GetBuckets()); CountV.PutAll(0); }
+    Calls++; Ticks += CallTicks;
+    if (CallTicks > MxTicks) { MxTicks = CallTicks; }
+    CountV[GetBucketN(CallTicks)]++;
+}
+
+uint64 TLatencyHist::GetPercentile(const double& Share) const {
+    if (Calls == 0) { return 0; }
+    // number of calls which must be at or below the returned latency
+    const uint64 MnCalls = TMath::Mx<uint64>(1, (uint64)ceil(Share * double(Calls)));
+    uint64 SumCalls = 0;
+    for (int BucketN = 0; BucketN < CountV.Len(); BucketN++) {
+        SumCalls += CountV[BucketN];
+        if (SumCalls >= MnCalls) { return TMath::Mn<uint64>(GetBucketMxVal(BucketN), MxTicks); }
+    }
+    return MxTicks;
+}
+
+PJsonVal TLatencyHist::GetJson() const {
+    const double MSecsPerTick = 1000.0 / double(TTm::GetPerfTimerFq());
+    PJsonVal StatVal = TJsonVal::NewObj();
+    StatVal->AddToObj("calls", Calls);
+    StatVal->AddToObj("totalMSecs", double(Ticks) * MSecsPerTick);
+    StatVal->AddToObj("avgMSecs", (Calls > 0) ? double(Ticks) * MSecsPerTick / double(Calls) : 0.0);
+    StatVal->AddToObj("p50MSecs", double(GetPercentile(0.5)) * MSecsPerTick);
+    StatVal->AddToObj("p90MSecs", double(GetPercentile(0.9)) * MSecsPerTick);
+    StatVal->AddToObj("p99MSecs", double(GetPercentile(0.99)) * MSecsPerTick);
+    StatVal->AddToObj("p999MSecs", double(GetPercentile(0.999)) * MSecsPerTick);
+    StatVal->AddToObj("maxMSecs", double(MxTicks) * MSecsPerTick);
+    // number of calls the aggregate can handle per second, judging by time spent in it
+    StatVal->AddToObj("callsPerSec", (Ticks > 0) ? double(Calls) / (double(Ticks) * MSecsPerTick / 1000.0) : 0.0);
+    return StatVal;
+}
+
 ///////////////////////////////
 // QMiner-Stream-Aggregator-Set
+const char* TStreamAggrSet::CallNmV[sacMx] = {
+    "onAddRec", "onAddRecs", "onUpdateRec", "onDeleteRec", "onTime", "onStep" };
+
+void TStreamAggrSet::InitSchedule() {
+    const int Aggrs = StreamAggrV.Len();
+    // map aggregate names to positions in the set
+    THash<TStr, TInt> AggrNmToNH;
+    for (int AggrN = 0; AggrN < Aggrs; AggrN++) {
+        AggrNmToNH.AddDat(StreamAggrV[AggrN]->GetAggrNm(), AggrN);
+    }
+    // collect edges from inputs to aggregates; inputs outside the set are ignored
+    TVec<TIntV> OutAggrNVV(Aggrs); TIntV InDegV(Aggrs); InDegV.PutAll(0);
+    for (int AggrN = 0; AggrN < Aggrs; AggrN++) {
+        TIntSet InAggrNSet;
+        TStrV InAggrNmV; StreamAggrV[AggrN]->GetInAggrNmV(InAggrNmV);
+        for (const TStr& InAggrNm : InAggrNmV) {
+            if (AggrNmToNH.IsKey(InAggrNm)) { InAggrNSet.AddKey(AggrNmToNH.GetDat(InAggrNm)); }
+        }
+        // aggregates which are not thread-safe can have undeclared dependencies,
+        // so they wait for all aggregates added before them
+        if (!StreamAggrV[AggrN]->IsThreadSafe()) {
+            for (int InAggrN = 0; InAggrN < AggrN; InAggrN++) { InAggrNSet.AddKey(InAggrN); }
+        }
+        InAggrNSet.DelIfKey(AggrN);
+        int KeyId = InAggrNSet.FFirstKeyId();
+        while (InAggrNSet.FNextKeyId(KeyId)) {
+            OutAggrNVV[InAggrNSet.GetKey(KeyId)].Add(AggrN);
+            InDegV[AggrN]++;
+        }
+    }
+    // topological sort, level of an aggregate is the longest path from a source
+    TIntV LevelV(Aggrs); LevelV.PutAll(0);
+    TIntV QueueV; int MxLevel = -1;
+    for (int AggrN = 0; AggrN < Aggrs; AggrN++) {
+        if (InDegV[AggrN] == 0) { QueueV.Add(AggrN); }
+    }
+    for (int QueueN = 0; QueueN < QueueV.Len(); QueueN++) {
+        const int AggrN = QueueV[QueueN];
+        MxLevel = TInt::GetMx(MxLevel, LevelV[AggrN]);
+        for (const int OutAggrN : OutAggrNVV[AggrN]) {
+            LevelV[OutAggrN] = TInt::GetMx(LevelV[OutAggrN], LevelV[AggrN] + 1);
+            if (--InDegV[OutAggrN] == 0) { QueueV.Add(OutAggrN); }
+        }
+    }
+    // check if we can read stores from several threads
+    bool ConcurrentP = true;
+    for (int StoreN = 0; StoreN < Base->GetStores(); StoreN++) {
+        ConcurrentP = Base->GetStoreByStoreN(StoreN)->PrepConcurrentRead() && ConcurrentP;
+    }
+    ParLevelV.Clr(); SerLevelV.Clr();
+    if (QueueV.Len() < Aggrs) {
+        // cycle in declared dependencies, fall back to insertion order
+        TEnv::Logger->OnStatusFmt("[TStreamAggrSet] Cyclic dependencies in %s, updating serially",
+            GetAggrNm().CStr());
+        for (int AggrN = 0; AggrN < Aggrs; AggrN++) {
+            ParLevelV.Add(TIntV()); SerLevelV.Add(TIntV::GetV(AggrN));
+        }
+        return;
+    }
+    // group by levels, each level keeps insertion order
+    ParLevelV.Gen(MxLevel + 1); SerLevelV.Gen(MxLevel + 1);
+    for (int AggrN = 0; AggrN < Aggrs; AggrN++) {
+        const bool ParP = ConcurrentP && StreamAggrV[AggrN]->IsThreadSafe();
+        (ParP ? ParLevelV : SerLevelV)[LevelV[AggrN]].Add(AggrN);
+    }
+}
+
+template <class TFun>
+void TStreamAggrSet::ExecAggr(const int& AggrN, const TStreamAggrCall& Call, const TFun& Fun) {
+    StreamAggrV[AggrN]->SetUpdated();
+    if (!StatP) { Fun(StreamAggrV[AggrN]); return; }
+    const uint64 StartTicks = TTm::GetPerfTimerTicks();
+    Fun(StreamAggrV[AggrN]);
+    StatV[AggrN * sacMx + Call].Add(TTm::GetPerfTimerTicks() - StartTicks);
+}
+
+template <class TFun>
+void TStreamAggrSet::Exec(const TStreamAggrCall& Call, const TFun& Fun) {
+    if (Threads <= 1) {
+        for (int AggrN = 0; AggrN < StreamAggrV.Len(); AggrN++) { ExecAggr(AggrN, Call, Fun); }
+        return;
+    }
+    if (ParLevelV.Empty()) { InitSchedule(); }
+    for (int LevelN = 0; LevelN < ParLevelV.Len(); LevelN++) {
+        const TIntV& ParAggrNV = ParLevelV[LevelN];
+        if (ParAggrNV.Len() == 1) {
+            ExecAggr(ParAggrNV[0], Call, Fun);
+        } else if (ParAggrNV.Len() > 1) {
+            // keep exception of each aggregate, so we rethrow the same one as serial update
+            TVec<PExcept> ExceptV(ParAggrNV.Len());
+            #pragma omp parallel for num_threads(TInt::GetMn(Threads, ParAggrNV.Len())) schedule(dynamic, 1)
+            for (int ParAggrN = 0; ParAggrN < ParAggrNV.Len(); ParAggrN++) {
+                try {
+                    ExecAggr(ParAggrNV[ParAggrN], Call, Fun);
+                } catch (PExcept Except) {
+                    ExceptV[ParAggrN] = Except;
+                }
+            }
+            for (const PExcept& Except : ExceptV) {
+                if (!Except.Empty()) { throw Except; }
+            }
+        }
+        for (const int AggrN : SerLevelV[LevelN]) { ExecAggr(AggrN, Call, Fun); }
+    }
+}
+
 TStreamAggrSet::TStreamAggrSet(const TWPt<TBase>& _Base, const TStr& _AggrNm):
-    TStreamAggr(_Base, _AggrNm) { }
+    TStreamAggr(_Base, _AggrNm), Threads(1) { }
 
 TStreamAggrSet::TStreamAggrSet(const TWPt<TBase>& _Base, const PJsonVal& ParamVal):
-        TStreamAggr(_Base, ParamVal) {
+        TStreamAggr(_Base, ParamVal), Threads(1) {
 
     // get list of arrays
     QmAssertR(ParamVal->IsObjKey("aggregates"), "[TStreamAggrSet] Expecting array of aggregates");
@@ -6440,6 +6971,8 @@ TStreamAggrSet::TStreamAggrSet(const TWPt<TBase>& _Base, const PJsonVal& ParamVa
         // get it and add it to the set
         AddStreamAggr(Base->GetStreamAggr(SubAggrNm));
     }
+    // optional parallel updates
+    SetThreads(ParamVal->GetObjInt("threads", 1));
 }
 
 PStreamAggr TStreamAggrSet::New(const TWPt<TBase>& Base) {
@@ -6467,12 +7000,51 @@ void TStreamAggrSet::AddStreamAggr(const PStreamAggr& StreamAggr) {
     QmAssertR(Base->IsStreamAggr(StreamAggr->GetAggrNm()),
         "[TStreamAggrSet] Unregistered stream aggregate " + StreamAggr->GetAggrNm());
     StreamAggrV.Add(StreamAggr());
+    StatV.Reserve(StatV.Len() + sacMx);
+    for (int CallN = 0; CallN < sacMx; CallN++) { StatV.Add(); }
+    // dependency graph changed
+    ParLevelV.Clr(); SerLevelV.Clr();
 }
 
 const TWPt<TStreamAggr>& TStreamAggrSet::GetStreamAggr(const int& StreamAggrN) const {
     return StreamAggrV[StreamAggrN];
 }
 
+void TStreamAggrSet::SetThreads(const int& _Threads) {
+    QmAssertR(_Threads > 0, "[TStreamAggrSet] Number of threads must be positive");
+    Threads = _Threads;
+    ParLevelV.Clr(); SerLevelV.Clr();
+}
+
+void TStreamAggrSet::SetStatP(const bool& _StatP) {
+    if (_StatP && !StatP) {
+        for (TLatencyHist& Stat : StatV) { Stat.Clr(); }
+    }
+    StatP = _StatP;
+}
+
+PJsonVal TStreamAggrSet::GetStatJson() const {
+    const double MSecsPerTick = 1000.0 / double(TTm::GetPerfTimerFq());
+    PJsonVal StatVal = TJsonVal::NewArr();
+    for (int AggrN = 0; AggrN < StreamAggrV.Len(); AggrN++) {
+        PJsonVal AggrVal = TJsonVal::NewObj();
+        AggrVal->AddToObj("name", StreamAggrV[AggrN]->GetAggrNm());
+        AggrVal->AddToObj("type", StreamAggrV[AggrN]->Type());
+        // totals over all calls, details only for calls which happened
+        uint64 Calls = 0, Ticks = 0;
+        for (int CallN = 0; CallN < sacMx; CallN++) {
+            const TLatencyHist& Stat = StatV[AggrN * sacMx + CallN];
+            if (Stat.GetCalls() == 0) { continue; }
+            Calls += Stat.GetCalls(); Ticks += Stat.GetTicks();
+            AggrVal->AddToObj(CallNmV[CallN], Stat.GetJson());
+        }
+        AggrVal->AddToObj("calls", Calls);
+        AggrVal->AddToObj("totalMSecs", double(Ticks) * MSecsPerTick);
+        StatVal->AddToArr(AggrVal);
+    }
+    return StatVal;
+}
+
 TStrV TStreamAggrSet::GetStreamAggrNmV() const {
     TStrV StreamAggrNmV;
     for (const TWPt<TStreamAggr>& StreamAggr: StreamAggrV) {
@@ -6483,38 +7055,48 @@ TStrV TStreamAggrSet::GetStreamAggrNmV() const {
 
 void TStreamAggrSet::Reset() {
     for (TWPt<TStreamAggr>& StreamAggr : StreamAggrV) {
+        StreamAggr->SetUpdated();
         StreamAggr->Reset();
     }
 }
 
 void TStreamAggrSet::OnStep() {
-    for (TWPt<TStreamAggr>& StreamAggr : StreamAggrV) {
-        StreamAggr->OnStep();
-    }
+    Exec(sacStep, [](TWPt<TStreamAggr>& StreamAggr) { StreamAggr->OnStep(); });
 }
 
 void TStreamAggrSet::OnTime(const uint64& TmMsec) {
-    for (TWPt<TStreamAggr>& StreamAggr : StreamAggrV) {
-        StreamAggr->OnTime(TmMsec);
-    }
+    Exec(sacTime, [&TmMsec](TWPt<TStreamAggr>& StreamAggr) { StreamAggr->OnTime(TmMsec); });
 }
 
 void TStreamAggrSet::OnAddRec(const TRec& Rec) {
-    for (TWPt<TStreamAggr>& StreamAggr : StreamAggrV) {
-        StreamAggr->OnAddRec(Rec);
+    Exec(sacAddRec, [&Rec](TWPt<TStreamAggr>& StreamAggr) { StreamAggr->OnAddRec(Rec); });
+}
+
+void TStreamAggrSet::OnAddRecs(const PRecSet& RecSet) {
+    if (IsBatchable()) {
+        // each aggregate consumes the whole batch in one step
+        Exec(sacAddRecs, [&RecSet](TWPt<TStreamAggr>& StreamAggr) { StreamAggr->OnAddRecs(RecSet); });
+    } else {
+        // some aggregates depend on per-record state of their inputs
+        for (int RecN = 0; RecN < RecSet->GetRecs(); RecN++) {
+            OnAddRec(RecSet->GetRec(RecN));
+        }
     }
 }
 
-void TStreamAggrSet::OnUpdateRec(const TRec& Rec) {
-    for (TWPt<TStreamAggr>& StreamAggr : StreamAggrV) {
-        StreamAggr->OnUpdateRec(Rec);
+bool TStreamAggrSet::IsBatchable() const {
+    for (const TWPt<TStreamAggr>& StreamAggr : StreamAggrV) {
+        if (!StreamAggr->IsBatchable()) { return false; }
     }
+    return true;
+}
+
+void TStreamAggrSet::OnUpdateRec(const TRec& Rec) {
+    Exec(sacUpdateRec, [&Rec](TWPt<TStreamAggr>& StreamAggr) { StreamAggr->OnUpdateRec(Rec); });
 }
 
 void TStreamAggrSet::OnDeleteRec(const TRec& Rec) {
-    for (TWPt<TStreamAggr>& StreamAggr : StreamAggrV) {
-        StreamAggr->OnDeleteRec(Rec);
-    }
+    Exec(sacDeleteRec, [&Rec](TWPt<TStreamAggr>& StreamAggr) { StreamAggr->OnDeleteRec(Rec); });
 }
 
 void TStreamAggrSet::PrintStat() const {
@@ -6533,23 +7115,197 @@ PJsonVal TStreamAggrSet::SaveJson(const int& Limit) const {
 
 ///////////////////////////////
 // QMiner-Stream-Aggregator-Trigger
-TStreamAggrTrigger::TStreamAggrTrigger(const TWPt<TStreamAggr>& _StreamAggr):
-    StreamAggr(_StreamAggr) {}
+TStreamAggrTrigger::TStreamAggrTrigger(const TWPt<TStreamAggr>& _StreamAggr,
+    const int& _BatchSize): StreamAggr(_StreamAggr) { SetBatchSize(_BatchSize); }
 
-PStoreTrigger TStreamAggrTrigger::New(const TWPt<TStreamAggr>& StreamAggr) {
-    return new TStreamAggrTrigger(StreamAggr);
+PStoreTrigger TStreamAggrTrigger::New(const TWPt<TStreamAggr>& StreamAggr, const int& BatchSize) {
+    return new TStreamAggrTrigger(StreamAggr, BatchSize);
 }
 
 void TStreamAggrTrigger::OnAdd(const TRec& Rec) {
-    StreamAggr->OnAddRec(Rec);
+    const uint64 StartTicks = StatP ? TTm::GetPerfTimerTicks() : 0;
+    if (BatchSize <= 1) {
+        StreamAggr->OnAddRec(Rec);
+    } else {
+        // records from triggers always come from the store and have IDs
+        BatchRecIdV.Add(Rec.GetRecId());
+        if (BatchRecIdV.Len() >= BatchSize) { Flush(); }
+    }
+    if (StatP) { AddStat.Add(TTm::GetPerfTimerTicks() - StartTicks); }
 }
 
 void TStreamAggrTrigger::OnUpdate(const TRec& Rec) {
+    const uint64 StartTicks = StatP ? TTm::GetPerfTimerTicks() : 0;
+    Flush();
     StreamAggr->OnUpdateRec(Rec);
+    if (StatP) { UpdateStat.Add(TTm::GetPerfTimerTicks() - StartTicks); }
 }
 
 void TStreamAggrTrigger::OnDelete(const TRec& Rec) {
+    const uint64 StartTicks = StatP ? TTm::GetPerfTimerTicks() : 0;
+    // called before the record is deleted, so pending records are still in the store
+    Flush();
     StreamAggr->OnDeleteRec(Rec);
+    if (StatP) { DeleteStat.Add(TTm::GetPerfTimerTicks() - StartTicks); }
+}
+
+void TStreamAggrTrigger::SetBatchSize(const int& _BatchSize) {
+    QmAssertR(_BatchSize > 0, "[TStreamAggrTrigger] Batch size must be positive");
+    Flush();
+    BatchSize = _BatchSize;
+    BatchRecIdV.Reserve(BatchSize, 0);
+}
+
+void TStreamAggrTrigger::Flush() {
+    if (BatchRecIdV.Empty()) { return; }
+    PRecSet RecSet = TRecSet::New(Store, BatchRecIdV);
+    // clear before forwarding, aggregates can add records to other stores
+    BatchRecIdV.Clr(false);
+    StreamAggr->OnAddRecs(RecSet);
+}
+
+void TStreamAggrTrigger::SetStatP(const bool& _StatP) {
+    if (_StatP && !StatP) {
+        AddStat.Clr(); UpdateStat.Clr(); DeleteStat.Clr();
+        StatStartTicks = TTm::GetPerfTimerTicks();
+    }
+    StatP = _StatP;
+}
+
+PJsonVal TStreamAggrTrigger::GetStatJson() const {
+    PJsonVal StatVal = TJsonVal::NewObj();
+    StatVal->AddToObj("batchSize", BatchSize);
+    StatVal->AddToObj("records", AddStat.GetCalls());
+    // throughput of the store as seen by the aggregates, including time outside of them
+    const double Secs = double(TTm::GetPerfTimerTicks() - StatStartTicks) / double(TTm::GetPerfTimerFq());
+    StatVal->AddToObj("recordsPerSec", (StatP && Secs > 0.0) ? double(AddStat.GetCalls()) / Secs : 0.0);
+    StatVal->AddToObj("onAdd", AddStat.GetJson());
+    if (UpdateStat.GetCalls() > 0) { StatVal->AddToObj("onUpdate", UpdateStat.GetJson()); }
+    if (DeleteStat.GetCalls() > 0) { StatVal->AddToObj("onDelete", DeleteStat.GetJson()); }
+    return StatVal;
+}
+
+///////////////////////////////
+// QMiner-Stream-Aggregate-Snapshot
+const int TStreamAggrSnap::Version = 1;
+
+TStreamAggrSnap::TStreamAggrSnap(const TStr& _FPath): FPath(TStr::GetNrFPath(_FPath)) {
+    if (TFile::Exists(GetIdxFNm())) { LoadIdx(); }
+}
+
+void TStreamAggrSnap::LoadIdx() {
+    TFIn FIn(GetIdxFNm());
+    TStr MagicStr(FIn); TInt SnapVersion(FIn);
+    QmAssertR(MagicStr == "QMSA", "[TStreamAggrSnap] Not a stream aggregate snapshot: " + FPath);
+    QmAssertR(SnapVersion <= Version, "[TStreamAggrSnap] Unsupported snapshot version "
+        + SnapVersion.GetStr() + " in " + FPath);
+    Gen.Load(FIn); NextChunkN.Load(FIn); ChunkH.Load(FIn);
+}
+
+void TStreamAggrSnap::SaveIdx() const {
+    // write next to the old index and swap, so the index is never half written
+    const TStr TmpFNm = GetIdxFNm() + ".tmp";
+    {
+        TFOut FOut(TmpFNm);
+        TStr("QMSA").Save(FOut); TInt(Version).Save(FOut);
+        Gen.Save(FOut); NextChunkN.Save(FOut); ChunkH.Save(FOut);
+    }
+#ifdef GLib_WIN
+    // rename does not replace existing files on windows
+    TFile::Del(GetIdxFNm(), false);
+#endif
+    TFile::Rename(TmpFNm, GetIdxFNm());
+}
+
+bool TStreamAggrSnap::Exists(const TStr& FPath) {
+    return TFile::Exists(TStr::GetNrFPath(FPath) + "StreamAggrSnap.idx");
+}
+
+PJsonVal TStreamAggrSnap::Save(const TWPt<TBase>& Base, const TStrV& AggrNmV) {
+    if (!TDir::Exists(FPath)) { TDir::GenDir(FPath); }
+    // write new chunks for changed aggregates, old chunks stay valid until the index is replaced
+    THash<TStr, TChunk> NewChunkH;
+    PJsonVal WrittenVal = TJsonVal::NewArr(), ReusedVal = TJsonVal::NewArr();
+    uint64 WrittenLen = 0;
+    for (const TStr& AggrNm : AggrNmV) {
+        QmAssertR(!NewChunkH.IsKey(AggrNm), "[TStreamAggrSnap] Aggregate listed twice: " + AggrNm);
+        TWPt<TStreamAggr> StreamAggr = Base->GetStreamAggr(AggrNm);
+        if (ChunkH.IsKey(AggrNm) && ChunkH.GetDat(AggrNm).IsClean(StreamAggr)) {
+            NewChunkH.AddDat(AggrNm, ChunkH.GetDat(AggrNm));
+            ReusedVal->AddToArr(AggrNm);
+            continue;
+        }
+        TMOut MOut; StreamAggr->SaveState(MOut);
+        TChunk& Chunk = NewChunkH.AddDat(AggrNm);
+        Chunk.AggrType = StreamAggr->Type();
+        Chunk.FNm = "StreamAggr" + TUInt64::GetStr(NextChunkN++) + ".dat";
+        Chunk.Gen = Gen + 1;
+        Chunk.Len = (uint64)MOut.Len();
+        Chunk.Cs = TCs::GetCsFromBf(MOut.GetBfAddr(), MOut.Len()).Get();
+        Chunk.StreamAggr = StreamAggr;
+        Chunk.Updates = StreamAggr->GetUpdates();
+        {
+            TFOut FOut(FPath + Chunk.FNm);
+            FOut.PutBf(MOut.GetBfAddr(), MOut.Len());
+        }
+        WrittenVal->AddToArr(AggrNm);
+        WrittenLen += Chunk.Len;
+    }
+    // chunks replaced or dropped by the new snapshot
+    TStrV OldFNmV;
+    int KeyId = ChunkH.FFirstKeyId();
+    while (ChunkH.FNextKeyId(KeyId)) {
+        const TStr& AggrNm = ChunkH.GetKey(KeyId);
+        const TStr& FNm = ChunkH[KeyId].FNm;
+        if (!NewChunkH.IsKey(AggrNm) || NewChunkH.GetDat(AggrNm).FNm != FNm) { OldFNmV.Add(FNm); }
+    }
+    // commit
+    Gen++; ChunkH = NewChunkH; SaveIdx();
+    for (const TStr& FNm : OldFNmV) { TFile::Del(FPath + FNm, false); }
+
+    PJsonVal ResVal = TJsonVal::NewObj();
+    ResVal->AddToObj("generation", Gen);
+    ResVal->AddToObj("written", WrittenVal);
+    ResVal->AddToObj("reused", ReusedVal);
+    ResVal->AddToObj("bytes", WrittenLen);
+    return ResVal;
+}
+
+PJsonVal TStreamAggrSnap::Load(const TWPt<TBase>& Base, const bool& MMapP) {
+    PJsonVal LoadedVal = TJsonVal::NewArr(), SkippedVal = TJsonVal::NewArr();
+    int KeyId = ChunkH.FFirstKeyId();
+    while (ChunkH.FNextKeyId(KeyId)) {
+        const TStr& AggrNm = ChunkH.GetKey(KeyId);
+        TChunk& Chunk = ChunkH[KeyId];
+        if (!Base->IsStreamAggr(AggrNm)) { SkippedVal->AddToArr(AggrNm); continue; }
+        TWPt<TStreamAggr> StreamAggr = Base->GetStreamAggr(AggrNm);
+        QmAssertR(StreamAggr->Type() == Chunk.AggrType, "[TStreamAggrSnap] Aggregate " + AggrNm
+            + " is of type " + StreamAggr->Type() + ", snapshot has " + Chunk.AggrType);
+        // get the whole chunk in memory, so we can check it before parsing
+        const TStr ChunkFNm = FPath + Chunk.FNm;
+        PSIn SIn; char* Bf = NULL;
+        if (MMapP) {
+            TMMapIn* MMapIn = new TMMapIn(ChunkFNm);
+            SIn = MMapIn; Bf = MMapIn->GetBfAddr();
+        } else {
+            TFIn FIn(ChunkFNm); const int BfL = FIn.Len();
+            Bf = new char[BfL]; FIn.GetBf(Bf, BfL);
+            SIn = TMIn::New(Bf, BfL, true);
+        }
+        QmAssertR((uint64)SIn->Len() == Chunk.Len && TCs::GetCsFromBf(Bf, SIn->Len()).Get() == Chunk.Cs,
+            "[TStreamAggrSnap] Corrupted state of aggregate " + AggrNm + " in " + ChunkFNm);
+        StreamAggr->LoadState(*SIn);
+        // loaded state matches the chunk
+        Chunk.StreamAggr = StreamAggr;
+        Chunk.Updates = StreamAggr->GetUpdates();
+        LoadedVal->AddToArr(AggrNm);
+    }
+
+    PJsonVal ResVal = TJsonVal::NewObj();
+    ResVal->AddToObj("generation", Gen);
+    ResVal->AddToObj("loaded", LoadedVal);
+    ResVal->AddToObj("skipped", SkippedVal);
+    return ResVal;
 }
 
 ///////////////////////////////
@@ -6795,6 +7551,7 @@ TBase::TBase(const TStr& _FPath, const int64& IndexCacheSize, const int& SplitLe
     StoreV.Gen(TEnv::GetMxStores()); StoreV.PutAll(NULL);
     // initialize empty stream aggregate bases for each store
     StreamAggrSetV.Gen(TEnv::GetMxStores()); StreamAggrSetV.PutAll(NULL);
+    StreamAggrTriggerV.Gen(TEnv::GetMxStores()); StreamAggrTriggerV.PutAll(NULL);
 }
 
 TBase::TBase(const TStr& _FPath, const TFAccess& _FAccess, const int64& IndexCacheSize,
@@ -6824,12 +7581,15 @@ TBase::TBase(const TStr& _FPath, const TFAccess& _FAccess, const int64& IndexCac
     StoreV.Gen(TEnv::GetMxStores()); StoreV.PutAll(NULL);
     // initialize empty stream aggregate bases for each store
     StreamAggrSetV.Gen(TEnv::GetMxStores()); StreamAggrSetV.PutAll(NULL);
+    StreamAggrTriggerV.Gen(TEnv::GetMxStores()); StreamAggrTriggerV.PutAll(NULL);
 
     // load the base properties
     LoadBaseConf(_FPath);
 }
 
 TBase::~TBase() {
+    // let aggregates see records still waiting in batches
+    FlushStreamAggrs();
     if (FAccess != faRdOnly) {
         TEnv::Logger->OnStatus("Saving index vocabulary ... ");
 
@@ -6837,9 +7597,19 @@ TBase::~TBase() {
         IndexVoc->Save(IndexVocFOut);
 
         SaveBaseConf(FPath);
+
+        TEnv::Logger->OnStatus("Saving query views ... ");
+        TFOut QueryViewFOut(GetQueryViewFNm(FPath));
+        TInt(QueryViewH.Len()).Save(QueryViewFOut);
+        int QueryViewKeyId = QueryViewH.FFirstKeyId();
+        while (QueryViewH.FNextKeyId(QueryViewKeyId)) {
+            QueryViewH[QueryViewKeyId]->Save(QueryViewFOut);
+        }
     } else {
         TEnv::Logger->OnStatus("No saving of qminer base neccessary!");
     }
+    // views remove their triggers, so they must go before the stores
+    QueryViewH.Clr();
 }
 
 bool TBase::Exists(const TStr& FPath) {
@@ -6849,6 +7619,15 @@ bool TBase::Exists(const TStr& FPath) {
 }
 
 void TBase::Init() {
+    // load query views, now that all the stores are in place
+    if (FAccess != faCreate && TFile::Exists(GetQueryViewFNm(FPath))) {
+        TFIn QueryViewFIn(GetQueryViewFNm(FPath));
+        const int QueryViews = TInt(QueryViewFIn);
+        for (int QueryViewN = 0; QueryViewN < QueryViews; QueryViewN++) {
+            PQueryView QueryView = TQueryView::Load(this, QueryViewFIn);
+            QueryViewH.AddDat(QueryView->GetViewNm(), QueryView);
+        }
+    }
     InitP = true;
 }
 
@@ -6868,9 +7647,14 @@ void TBase::AddStore(const PStore& NewStore) {
     // register aggregate to keep afloat
     AddStreamAggr(StreamAggrSet);
     // create trigger for the aggregate base
-    NewStore->AddTrigger(TStreamAggrTrigger::New(StreamAggrSet));
+    PStoreTrigger StreamAggrTrigger = TStreamAggrTrigger::New(StreamAggrSet);
+    NewStore->AddTrigger(StreamAggrTrigger);
+    StreamAggrTriggerV[StoreId] = dynamic_cast<TStreamAggrTrigger*>(StreamAggrTrigger());
     // remember the aggregate base for the store
     StreamAggrSetV[StoreId] = dynamic_cast<TStreamAggrSet*>(StreamAggrSet());
+    // measure the new store as well when statistics are enabled
+    StreamAggrTriggerV[StoreId]->SetStatP(StreamAggrStatP);
+    StreamAggrSetV[StoreId]->SetStatP(StreamAggrStatP);
 }
 
 const TWPt<TStore> TBase::GetStoreByStoreN(const int& StoreN) const {
@@ -6911,11 +7695,95 @@ TWPt<TStreamAggrSet> TBase::GetStreamAggrSet(const uint& StoreId) const {
     return dynamic_cast<TStreamAggrSet*>(StreamAggrSetV[(int)StoreId]());
 }
 
+int TBase::GetStreamAggrBatchSize(const uint& StoreId) const {
+    QmAssertR(IsStoreId(StoreId), "Unknown store ID: " + TUInt::GetStr(StoreId));
+    return StreamAggrTriggerV[(int)StoreId]->GetBatchSize();
+}
+
+void TBase::SetStreamAggrBatchSize(const uint& StoreId, const int& BatchSize) {
+    QmAssertR(IsStoreId(StoreId), "Unknown store ID: " + TUInt::GetStr(StoreId));
+    StreamAggrTriggerV[(int)StoreId]->SetBatchSize(BatchSize);
+}
+
+void TBase::FlushStreamAggrs() {
+    // flushing can add records to other stores (e.g. merger), which can start new batches
+    bool PendingP = true;
+    while (PendingP) {
+        PendingP = false;
+        for (TWPt<TStreamAggrTrigger>& StreamAggrTrigger : StreamAggrTriggerV) {
+            if (StreamAggrTrigger.Empty() || !StreamAggrTrigger->IsPending()) { continue; }
+            StreamAggrTrigger->Flush(); PendingP = true;
+        }
+    }
+}
+
+void TBase::SetStreamAggrStatP(const bool& StatP) {
+    StreamAggrStatP = StatP;
+    for (int StoreN = 0; StoreN < GetStores(); StoreN++) {
+        const uint StoreId = GetStoreByStoreN(StoreN)->GetStoreId();
+        StreamAggrTriggerV[(int)StoreId]->SetStatP(StatP);
+        StreamAggrSetV[(int)StoreId]->SetStatP(StatP);
+    }
+}
+
+PJsonVal TBase::GetStreamAggrStats() const {
+    PJsonVal StatVal = TJsonVal::NewArr();
+    for (int StoreN = 0; StoreN < GetStores(); StoreN++) {
+        const TWPt<TStore> Store = GetStoreByStoreN(StoreN);
+        PJsonVal StoreVal = StreamAggrTriggerV[(int)Store->GetStoreId()]->GetStatJson();
+        StoreVal->AddToObj("store", Store->GetStoreNm());
+        StoreVal->AddToObj("aggregates", StreamAggrSetV[(int)Store->GetStoreId()]->GetStatJson());
+        StatVal->AddToArr(StoreVal);
+    }
+    return StatVal;
+}
+
+PJsonVal TBase::SaveStreamAggrState(const TStr& SnapFPath, const TStrV& AggrNmV) {
+    // state must include records still waiting in batches
+    FlushStreamAggrs();
+    const TStr SnapKey = TStr::GetNrFPath(SnapFPath);
+    if (!StreamAggrSnapH.IsKey(SnapKey)) {
+        StreamAggrSnapH.AddDat(SnapKey, TStreamAggrSnap::New(SnapKey));
+    }
+    PStreamAggrSnap Snap = StreamAggrSnapH.GetDat(SnapKey);
+    const TStrV SnapAggrNmV = AggrNmV.Empty() ? Snap->GetAggrNmV() : AggrNmV;
+    QmAssertR(!SnapAggrNmV.Empty(), "No stream aggregates given for snapshot " + SnapKey);
+    return Snap->Save(this, SnapAggrNmV);
+}
+
+PJsonVal TBase::LoadStreamAggrState(const TStr& SnapFPath, const bool& MMapP) {
+    const TStr SnapKey = TStr::GetNrFPath(SnapFPath);
+    QmAssertR(TStreamAggrSnap::Exists(SnapKey), "Stream aggregate snapshot does not exist: " + SnapKey);
+    // records waiting in batches belong to the state we are replacing
+    FlushStreamAggrs();
+    PStreamAggrSnap Snap = TStreamAggrSnap::New(SnapKey);
+    PJsonVal ResVal = Snap->Load(this, MMapP);
+    StreamAggrSnapH.AddDat(SnapKey, Snap);
+    return ResVal;
+}
+
+TWPt<TQueryView> TBase::AddQueryView(const TStr& ViewNm, const PJsonVal& QueryVal) {
+    QmAssertR(!IsQueryView(ViewNm), "Query view with this name already exists: " + ViewNm);
+    PQueryView QueryView = TQueryView::New(this, ViewNm, QueryVal);
+    QueryViewH.AddDat(ViewNm, QueryView);
+    return QueryView;
+}
+
+TWPt<TQueryView> TBase::GetQueryView(const TStr& ViewNm) const {
+    QmAssertR(IsQueryView(ViewNm), "Unknown query view: " + ViewNm);
+    return QueryViewH.GetDat(ViewNm);
+}
+
+void TBase::DelQueryView(const TStr& ViewNm) {
+    QmAssertR(IsQueryView(ViewNm), "Unknown query view: " + ViewNm);
+    QueryViewH.DelKey(ViewNm);
+}
+
 void TBase::Aggr(PRecSet& RecSet, const TQueryAggrV& QueryAggrV) {
     if (RecSet->Empty()) { return; }
-    for (int QueryAggrN = 0; QueryAggrN < QueryAggrV.Len(); QueryAggrN++) {
-        const TQueryAggr& Aggr = QueryAggrV[QueryAggrN];
-        RecSet->AddAggr(TAggr::New(this, RecSet, Aggr));
+    TVec<PAggr> AggrV; TAggr::New(this, RecSet, QueryAggrV, AggrV);
+    for (int AggrN = 0; AggrN < AggrV.Len(); AggrN++) {
+        RecSet->AddAggr(AggrV[AggrN]);
     }
 }
 
@@ -7326,6 +8194,7 @@ PJsonVal TBase::GetStats() {
     res->AddToObj("gix_stats", GixStatsToJson(gix_stats));
     res->AddToObj("gix_blob", BlobBsStatsToJson(gix_blob_stats));
     res->AddToObj("access", GetFAccess());
+    if (StreamAggrStatP) { res->AddToObj("streamAggrs", GetStreamAggrStats()); }
     return res;
 }
 
@@ -227,6 +227,9 @@ public:
     uint GetEndStoreId(const TWPt<TBase>& Base) const;
     /// Get join sequence
     const TIntPrV& GetJoinIdV() const { return JoinIdV; }
+    /// Prepare stores on the join path for concurrent reads. Returns false when
+    /// path includes index joins or stores which cannot be read concurrently.
+    bool PrepConcurrentRead(const TWPt<TBase>& Base) const;
 
     /// Readable string representation of join sequence
     TStr GetJoinPathStr(const TWPt<TBase>& Base, const TStr& SepStr = ".") const;
@@ -634,6 +637,10 @@ public:
     virtual bool HasFirstRecId() const { return false; }
     /// Is the last record id getter implemented?
     virtual bool HasLastRecId() const { return false; }
+    /// Prepare store for reading field values from several threads at the same time.
+    /// Returns false when the store cannot serve concurrent reads (e.g. uses disk cache),
+    /// in which case callers must fall back to a single thread.
+    virtual bool PrepConcurrentRead() { return false; }
 
     /// Add new record provided as JSon
     virtual uint64 AddRec(const PJsonVal& RecVal, const bool& TriggerEvents=true) = 0;
@@ -1223,6 +1230,9 @@ public:
 
     /// Calls the filter, default keeps all records
     virtual bool Filter(const TRec& Rec) const { return true; }
+    /// True when filter can be called from several threads at the same time,
+    /// filters have to opt in after checking they only read the record
+    virtual bool IsThreadSafe() const { return false; }
 
     /// Filter type name
     static TStr GetType() { return "trivial"; }
@@ -1250,6 +1260,8 @@ public:
 
     /// Process every (Skip+1)-th record
     bool Filter(const TRec& Rec) const;
+    /// Counts calls, so the order of records matters
+    bool IsThreadSafe() const { return false; }
 
     /// Filter type name 
     static TStr GetType() { return "subsampling"; }
@@ -1308,6 +1320,8 @@ public:
     
     /// Filter function
     bool Filter(const TRec& Rec) const;
+    /// Only reads record id and the set
+    bool IsThreadSafe() const { return true; }
 
     /// Filter type name 
     static TStr GetType() { return "recordId"; }
@@ -1332,6 +1346,8 @@ public:
 
     /// Filter function
     bool Filter(const TRec& Rec) const;
+    /// Only reads record frequency
+    bool IsThreadSafe() const { return true; }
     
     /// Filter type name 
     static TStr GetType() { return "recordFq"; }
@@ -1359,6 +1375,9 @@ protected:
 public:
     /// JSON constructor
     static PRecFilter New(const TWPt<TBase>& Base, const PJsonVal& ParamVal);
+    /// Specializations only read the field value, concurrent reads are
+    /// prepared by the record set scan (TStore::PrepConcurrentRead)
+    bool IsThreadSafe() const { return true; }
     
     /// Filter type name 
     static TStr GetType() { return "field"; }
@@ -1622,6 +1641,8 @@ public:
     static PRecFilter New(const TWPt<TBase>& Base, const PJsonVal& ParamVal);
     /// Filter function
     bool Filter(const TRec& Rec) const;
+    /// Index lookups go through a shared cache
+    bool IsThreadSafe() const { return false; }
     /// Filter type name
     static TStr GetType() { return "indexJoin"; }
     /// Filter type name
@@ -1773,6 +1794,9 @@ private:
     friend class TIndex;
     friend class TBase;
 public:
+    /// Number of records a thread takes at once during parallel scans
+    static const int ScanChunkSize = 4096;
+
     /// Create empty set for a given store
     static PRecSet New(const TWPt<TStore>& Store);
     /// Create record set with one record
@@ -1857,41 +1881,48 @@ public:
     /// Filter records to keep only the ones with weight between `MinFq' and `MaxFq'
     void FilterByFq(const int& MinFq, const int& MaxFq);
     /// Filter records to keep only the ones that match the boolean value
-    void FilterByFieldBool(const int& FieldId, const bool& Val);
+    void FilterByFieldBool(const int& FieldId, const bool& Val, const int& Threads = 1);
     /// Filter records to keep only the ones with values of a given field within given range
-    void FilterByFieldInt(const int& FieldId, const int& MinVal, const int& MaxVal);
+    void FilterByFieldInt(const int& FieldId, const int& MinVal, const int& MaxVal, const int& Threads = 1);
     /// Filter records to keep only the ones with values of a given field within given range
-    void FilterByFieldInt16(const int& FieldId, const int16& MinVal, const int16& MaxVal);
+    void FilterByFieldInt16(const int& FieldId, const int16& MinVal, const int16& MaxVal, const int& Threads = 1);
     /// Filter records to keep only the ones with values of a given field within given range
-    void FilterByFieldInt64(const int& FieldId, const int64& MinVal, const int64& MaxVal);
+    void FilterByFieldInt64(const int& FieldId, const int64& MinVal, const int64& MaxVal, const int& Threads = 1);
     /// Filter records to keep only the ones with values of a given field within given range
-    void FilterByFieldByte(const int& FieldId, const uchar& MinVal, const uchar& MaxVal);
+    void FilterByFieldByte(const int& FieldId, const uchar& MinVal, const uchar& MaxVal, const int& Threads = 1);
     /// Filter records to keep only the ones with values of a given field within given range
-    void FilterByFieldUInt(const int& FieldId, const uint& MinVal, const uint& MaxVal);
+    void FilterByFieldUInt(const int& FieldId, const uint& MinVal, const uint& MaxVal, const int& Threads = 1);
     /// Filter records to keep only the ones with values of a given field within given range
-    void FilterByFieldUInt16(const int& FieldId, const uint16& MinVal, const uint16& MaxVal);
+    void FilterByFieldUInt16(const int& FieldId, const uint16& MinVal, const uint16& MaxVal, const int& Threads = 1);
     /// Filter records to keep only the ones with values of a given field within given range
-    void FilterByFieldFlt(const int& FieldId, const double& MinVal, const double& MaxVal);
+    void FilterByFieldFlt(const int& FieldId, const double& MinVal, const double& MaxVal, const int& Threads = 1);
     /// Filter records to keep only the ones with values of a given field within given range
-    void FilterByFieldSFlt(const int& FieldId, const float& MinVal, const float& MaxVal);
+    void FilterByFieldSFlt(const int& FieldId, const float& MinVal, const float& MaxVal, const int& Threads = 1);
     /// Filter records to keep only the ones with values of a given field within given range
-    void FilterByFieldUInt64(const int& FieldId, const uint64& MinVal, const uint64& MaxVal);
+    void FilterByFieldUInt64(const int& FieldId, const uint64& MinVal, const uint64& MaxVal, const int& Threads = 1);
     /// Filter records to keep only the ones with values of a given field equal to `FldVal'
-    void FilterByFieldStr(const int& FieldId, const TStr& FldVal);
+    void FilterByFieldStr(const int& FieldId, const TStr& FldVal, const int& Threads = 1);
     /// Filter records to keep only the ones with values of a given field between `FldValMin' and `FldValMax' (both inclusive)
-    void FilterByFieldStr(const int& FieldId, const TStr& FldValMin, const TStr& FldValMax);
+    void FilterByFieldStr(const int& FieldId, const TStr& FldValMin, const TStr& FldValMax, const int& Threads = 1);
     /// Filter records to keep only the ones with values of a given field present in `ValSet'
-    void FilterByFieldStr(const int& FieldId, const TStrSet& ValSet);
+    void FilterByFieldStr(const int& FieldId, const TStrSet& ValSet, const int& Threads = 1);
     /// Filter records to keep only the ones with values of a given field within given range
-    void FilterByFieldTm(const int& FieldId, const uint64& MinVal, const uint64& MaxVal);
+    void FilterByFieldTm(const int& FieldId, const uint64& MinVal, const uint64& MaxVal, const int& Threads = 1);
     /// Filter records to keep only the ones with values of a given field within given range
-    void FilterByFieldTm(const int& FieldId, const TTm& MinVal, const TTm& MaxVal);
+    void FilterByFieldTm(const int& FieldId, const TTm& MinVal, const TTm& MaxVal, const int& Threads = 1);
     /// Filter records to keep only the ones with values of a given field within given range
-    void FilterByFieldSafe(const int& FieldId, const uint64& MinVal, const uint64& MaxVal);
+    void FilterByFieldSafe(const int& FieldId, const uint64& MinVal, const uint64& MaxVal, const int& Threads = 1);
     /// Filter records to keep only the ones with join-record within given range
     void FilterByIndexJoin(const TWPt<TBase>& Base, const int& JoinId, const uint64& MinVal, const uint64& MaxVal);
     /// Filter records to keep only the ones with values of a given field within given range
     template <class TFilter> void FilterBy(const TFilter& Filter);
+    /// Filter records using several threads. Records are split into chunks which are
+    /// filtered in parallel, order of records is preserved. Falls back to single thread
+    /// when filter or store do not support concurrent access.
+    template <class TFilter> void FilterBy(const TFilter& Filter, const int& Threads);
+    /// Number of threads that can be used to scan records of this set. Prepares store
+    /// for concurrent reads and returns 1 when this is not possible.
+    int GetScanThreads(const int& Threads) const;
     
     /// Split records into several whenever value of two consecutive records above threshold
     TVec<PRecSet> SplitByFieldTm(const int& FieldId, const uint64& DiffMSecs) const;
@@ -1977,6 +2008,34 @@ void TRecSet::FilterBy(const TFilter& Filter) {
     RecIdFqV = NewRecIdFqV;
 }
 
+template <class TFilter>
+void TRecSet::FilterBy(const TFilter& Filter, const int& Threads) {
+    // check if we can go parallel
+    const int ScanThreads = Filter.IsThreadSafe() ? GetScanThreads(Threads) : 1;
+    if (ScanThreads <= 1) { FilterBy(Filter); return; }
+    // mark records which pass the filter, chunks are processed in parallel
+    const int Recs = GetRecs();
+    TBoolV KeepV(Recs); std::exception_ptr Except;
+    #pragma omp parallel for num_threads(ScanThreads) schedule(dynamic, ScanChunkSize)
+    for (int RecN = 0; RecN < Recs; RecN++) {
+        try {
+            KeepV[RecN] = Filter.Filter(GetRec(RecN));
+        } catch (...) {
+            #pragma omp critical
+            { if (!Except) { Except = std::current_exception(); } }
+        }
+    }
+    // exceptions cannot leave parallel region, so we rethrow the first one here
+    if (Except) { std::rethrow_exception(Except); }
+    // collect records that pass the filter in the original order
+    TUInt64IntKdV NewRecIdFqV(Recs, 0);
+    for (int RecN = 0; RecN < Recs; RecN++) {
+        if (KeepV[RecN]) { NewRecIdFqV.Add(RecIdFqV[RecN]); }
+    }
+    // overwrite old result vector with filtered list
+    RecIdFqV = NewRecIdFqV;
+}
+
 template <class TSplitter> 
 TVec<PRecSet> TRecSet::SplitBy(const TSplitter& Splitter) const {
     TRecSetV ResV;
@@ -2746,6 +2805,119 @@ public:
 };
 typedef TPt<TQuery> PQuery;
 
+///////////////////////////////
+/// Materialized Query View.
+/// Named result of a query, which is kept current through store triggers.
+/// When the query consists only of index leafs, ranges, boolean operators
+/// and store items, each added, updated or deleted record is checked against
+/// the query predicate and the view is updated in place. Other queries
+/// (joins, geo-location, record sets, words not yet in vocabulary) mark
+/// the view as stale on any change and re-execute the query on next access.
+/// Records added with TriggerEvents set to false are not seen by the view.
+class TQueryView {
+private:
+    // smart-pointer
+    TCRef CRef;
+    friend class TPt<TQueryView>;
+
+    /// Trigger forwarding store changes to the view
+    class TTrigger : public TStoreTrigger {
+    private:
+        /// View which we keep current
+        TWPt<TQueryView> View;
+    public:
+        TTrigger(const TWPt<TQueryView>& _View): View(_View) { }
+        void OnAdd(const TRec& Rec) { View->OnAdd(Rec); }
+        void OnUpdate(const TRec& Rec) { View->OnUpdate(Rec); }
+        void OnDelete(const TRec& Rec) { View->OnDelete(Rec); }
+    };
+
+    /// Base
+    TWPt<TBase> Base;
+    /// View name
+    TStr ViewNm;
+    /// Query definition, as given by the user
+    PJsonVal QueryVal;
+    /// Parsed query
+    PQuery Query;
+    /// Store with the query results
+    TWPt<TStore> Store;
+    /// True when view can be updated by checking only the changed record
+    TBool IncrementalP;
+    /// True when non-incremental view needs to re-execute the query
+    TBool StaleP;
+    /// Records matching the query
+    TUInt64Set RecIdSet;
+    /// Cached record set, cleared on each change
+    PRecSet RecSet;
+    /// Trigger registered with the stores
+    PStoreTrigger Trigger;
+    /// Stores on which the trigger is registered
+    TVec<TWPt<TStore> > TriggerStoreV;
+
+    TQueryView(const TWPt<TBase>& _Base, const TStr& _ViewNm, const PJsonVal& _QueryVal);
+    TQueryView(const TWPt<TBase>& _Base, TSIn& SIn);
+
+    /// Parse the query, register triggers and execute the query
+    void Exec();
+    /// Register trigger with result store (incremental) or with all stores (stale)
+    void AddTriggers();
+    /// Remove trigger from all the stores
+    void DelTriggers();
+
+    /// Record was added to a store
+    void OnAdd(const TRec& Rec);
+    /// Record was updated in a store
+    void OnUpdate(const TRec& Rec);
+    /// Record is about to be deleted from a store
+    void OnDelete(const TRec& Rec);
+
+    /// Check if query can be evaluated on a single record
+    static bool IsIncremental(const TWPt<TBase>& Base, const TQueryItem& QueryItem);
+    /// Collect words, under given key, of the record
+    static void GetRecWordIdV(const TWPt<TBase>& Base, const int& KeyId,
+        const TRec& Rec, TUInt64V& WordIdV);
+    /// Check if the record matches leaf query item
+    static bool IsLeafMatch(const TWPt<TBase>& Base, const TQueryItem& QueryItem, const TRec& Rec);
+    /// Check if the record matches range query item
+    static bool IsRangeMatch(const TWPt<TBase>& Base, const TQueryItem& QueryItem, const TRec& Rec);
+    /// Check if the record matches the query item
+    static bool IsMatch(const TWPt<TBase>& Base, const TQueryItem& QueryItem, const TRec& Rec);
+
+public:
+    /// Create new view and execute the query
+    static TPt<TQueryView> New(const TWPt<TBase>& Base, const TStr& ViewNm, const PJsonVal& QueryVal) {
+        return new TQueryView(Base, ViewNm, QueryVal); }
+    /// Load view from input stream
+    static TPt<TQueryView> Load(const TWPt<TBase>& Base, TSIn& SIn) {
+        return new TQueryView(Base, SIn); }
+    ~TQueryView();
+
+    /// Save view to output stream
+    void Save(TSOut& SOut) const;
+
+    /// Get view name
+    const TStr& GetViewNm() const { return ViewNm; }
+    /// Get query definition
+    const PJsonVal& GetQueryVal() const { return QueryVal; }
+    /// Get the result store
+    const TWPt<TStore>& GetStore() const { return Store; }
+    /// Check if view is maintained incrementally
+    bool IsIncremental() const { return IncrementalP; }
+
+    /// Number of records in the view
+    int GetRecs();
+    /// Check if record is part of the view
+    bool IsRecId(const uint64& RecId);
+    /// Get view as a record set, sorted and limited as specified by the query.
+    /// Returned record set is shared and should not be modified.
+    PRecSet GetRecSet();
+
+    /// Get view description as json
+    PJsonVal GetJson() const;
+};
+typedef TPt<TQueryView> PQueryView;
+
 ///////////////////////////////
 // GeoIndex
 class TGeoIndex; typedef TPt<TGeoIndex> PGeoIndex;
@@ -3265,6 +3437,11 @@ private:
         const PRecSet& RecSet, const PJsonVal& ParamVal);
     /// Stream aggregate descriptions
     static TFunRouter<PAggr, TNewF> NewRouter;   
+    /// New constructor delegate for aggregates with empty state, computed by TAggrs::TFusedAggrExec
+    typedef PAggr (*TNewFusedF)(const TWPt<TBase>& Base, const TStr& AggrNm,
+        const uint& StoreId, const PJsonVal& ParamVal);
+    /// Fused aggregate descriptions
+    static TFunRouter<PAggr, TNewFusedF> NewFusedRouter;
 public:
     /// Register default aggregates
     static void Init();
@@ -3272,6 +3449,11 @@ public:
     template <class TObj> static void Register() { 
         NewRouter.Register(TObj::GetType(), TObj::New);
     }
+    /// Register new aggregate, which can also be computed by TAggrs::TFusedAggrExec
+    template <class TObj> static void RegisterFused() { 
+        NewRouter.Register(TObj::GetType(), TObj::New);
+        NewFusedRouter.Register(TObj::GetType(), TObj::NewFused);
+    }
 
 private:
     /// QMiner Base pointer
@@ -3289,6 +3471,14 @@ public:
     /// @param RecSet    Record collection on which to compute the aggregates
     /// @param QueryAggr Aggregate query details (e.g. type, parameters)
     static PAggr New(const TWPt<TBase>& Base, const PRecSet& RecSet, const TQueryAggr& QueryAggr); 
+    /// Create new aggregates for a list of aggregate queries. Aggregates which support it
+    /// are computed together, in one pass over the record set. The number of threads
+    /// used is the largest value of optional parameter `threads` among the queries.
+    /// @param RecSet      Record collection on which to compute the aggregates
+    /// @param QueryAggrV  Aggregate queries
+    /// @param AggrV       Computed aggregates, in the same order as queries
+    static void New(const TWPt<TBase>& Base, const PRecSet& RecSet,
+        const TVec<TQueryAggr>& QueryAggrV, TVec<PAggr>& AggrV);
     virtual ~TAggr() { }
     
     /// Get aggreagte name
@@ -3325,6 +3515,10 @@ protected:
     /// Stream aggreagte name
     const TStr AggrNm;
 
+private:
+    /// Number of updates, used to find aggregates changed since the last snapshot
+    TUInt64 Updates;
+
 protected:
     /// Create new stream aggregate from JSon parameters
     TStreamAggr(const TWPt<TBase>& _Base, const TStr& _AggrNm);
@@ -3352,6 +3546,16 @@ public:
     const TStr& GetAggrNm() const { return AggrNm; }
     /// Is the aggregate initialized. Used for aggregates, which require some time to get started.
     virtual bool IsInit() const { return true; }
+    /// True when the aggregate only changes its own state and reads from its inputs
+    /// and stores, so it can be updated in parallel with aggregates it does not depend on.
+    /// Inputs must be reported by GetInAggrNmV. Aggregates which are not thread-safe are
+    /// updated serially, after all the aggregates added before them.
+    virtual bool IsThreadSafe() const { return false; }
+    /// Note the aggregate is about to change its state. Called by stream aggregate
+    /// sets and other callers before passing updates to the aggregate.
+    void SetUpdated() { Updates++; }
+    /// Number of updates so far, unchanged count means unchanged state
+    uint64 GetUpdates() const { return Updates; }
 
     /// Reset the state of the aggregate
     virtual void Reset() = 0;
@@ -3362,6 +3566,12 @@ public:
     virtual void OnTime(const uint64& TmMsec) { OnStep(); }
     /// Add new record to the aggregate
     virtual void OnAddRec(const TRec& Rec) { OnStep(); }
+    /// Add a batch of new records to the aggregate. Default calls OnAddRec for each record.
+    virtual void OnAddRecs(const PRecSet& RecSet);
+    /// True when OnAddRecs updates the aggregate in one step, assuming its input
+    /// aggregates were also updated with the whole batch. Aggregates that need to
+    /// observe the state of their inputs after each record must return false.
+    virtual bool IsBatchable() const { return false; }
     /// Recored already added to the aggregate is being updated
     virtual void OnUpdateRec(const TRec& Rec) { }
     /// Recored already added to the aggregate is being deleted from the store 
@@ -3442,6 +3652,13 @@ namespace TStreamAggrOut {
     };
     typedef IValIO<TFlt> IFltIO;
 
+    /// values and timestamps read in the last OnAddRecs call
+    class IFltTmBatch {
+    public:
+        virtual void GetBatchFltV(TFltV& ValV) const = 0;
+        virtual void GetBatchTmMSecsV(TUInt64V& MSecsV) const = 0;
+    };
+
     class ITmIO {
     public:
         // incomming
@@ -3471,16 +3688,103 @@ namespace TStreamAggrOut {
         // get feature space
         virtual PFtrSpace GetFtrSpace() const = 0;
     };
+
+    /// values kept separately for each key
+    class IKeyed {
+    public:
+        virtual int GetKeys() const = 0;
+        virtual void GetKeyV(TStrV& KeyV) const = 0;
+        virtual bool IsKey(const TStr& Key) const = 0;
+        virtual double GetKeyFlt(const TStr& Key) const = 0;
+        virtual void GetKeyFltV(const TStr& Key, TFltV& ValV) const = 0;
+        virtual uint64 GetKeyTmMSecs(const TStr& Key) const = 0;
+    };
 }
+///////////////////////////////
+/// Latency histogram.
+/// Counts calls in buckets of exponentially growing width, each split into
+/// linear sub-buckets as in HDR histograms. Percentiles are reported with
+/// relative error below 1/16, regardless of the magnitude of latencies.
+class TLatencyHist {
+private:
+    /// Number of bits of each value resolved by linear sub-buckets
+    static const int SubBucketBits = 4;
+    /// Values with more bits are counted in the last bucket
+    static const int MxValBits = 40;
+    /// Number of calls
+    TUInt64 Calls;
+    /// Time spent in all calls, in performance timer ticks
+    TUInt64 Ticks;
+    /// Time spent in the longest call, in performance timer ticks
+    TUInt64 MxTicks;
+    /// Number of calls in each bucket, allocated with the first call
+    TUInt64V CountV;
+
+    /// Bucket of the given value
+    static int GetBucketN(const uint64& Val);
+    /// Largest value falling into the bucket
+    static uint64 GetBucketMxVal(const int& BucketN);
+    /// Number of buckets
+    static int GetBuckets() { return GetBucketN(TUInt64::Mx) + 1; }
+
+public:
+    /// Record a call
+    void Add(const uint64& CallTicks);
+    /// Forget all calls
+    void Clr() { Calls = 0; Ticks = 0; MxTicks = 0; CountV.Clr(); }
+
+    /// Number of calls
+    uint64 GetCalls() const { return Calls; }
+    /// Time spent in all calls, in performance timer ticks
+    uint64 GetTicks() const { return Ticks; }
+    /// Upper bound on the latency of given share of calls (e.g. 0.99), in performance timer ticks
+    uint64 GetPercentile(const double& Share) const;
+
+    /// Serialize to JSon, times in milliseconds
+    PJsonVal GetJson() const;
+};
+
 ///////////////////////////////
 /// Stream aggregator set.
 /// Holds a set of stream aggregates and triggers them all on call.
-/// Aggregates are triggered in the same order as they are added to the set.
+/// By default aggregates are triggered in the same order as they are added to the set.
+/// With more than one thread, the set orders aggregates by the dependency graph given
+/// by GetInAggrNmV and updates independent thread-safe aggregates in parallel.
+/// Aggregates that are not thread-safe wait for all aggregates added before them, so
+/// results are the same as with serial updates.
+/// When statistics are enabled, the set measures latency of each call to each aggregate.
 class TStreamAggrSet : public TStreamAggr {
+private:
+    /// Calls to aggregates which are measured separately
+    typedef enum { sacAddRec, sacAddRecs, sacUpdateRec, sacDeleteRec, sacTime, sacStep, sacMx } TStreamAggrCall;
+    /// Names of the calls in statistics
+    static const char* CallNmV[sacMx];
+
 protected:
     /// List of aggregates triggered in step
     TVec<TWPt<TStreamAggr>> StreamAggrV;
-    
+
+private:
+    /// Number of threads for updating independent aggregates, 1 means serial updates
+    TInt Threads;
+    /// Aggregates grouped by level in the dependency graph, which can run in parallel.
+    /// Empty when the graph needs to be rebuilt.
+    TVec<TIntV> ParLevelV;
+    /// Aggregates from the same level which must run serially, after the parallel ones
+    TVec<TIntV> SerLevelV;
+    /// Measure latency of calls to aggregates
+    TBool StatP;
+    /// Latency of calls, sacMx histograms for each aggregate in StreamAggrV
+    TVec<TLatencyHist> StatV;
+
+    /// Build dependency graph and group aggregates by levels
+    void InitSchedule();
+    /// Call function on the aggregate and record time when statistics are enabled
+    template <class TFun> void ExecAggr(const int& AggrN, const TStreamAggrCall& Call, const TFun& Fun);
+    /// Call function on all the aggregates, in order of the dependency graph
+    template <class TFun> void Exec(const TStreamAggrCall& Call, const TFun& Fun);
+
+protected:
     /// Create empty aggregate base
     TStreamAggrSet(const TWPt<TBase>& _Base, const TStr& _AggrNm);
     /// Create empty aggregate base from json
@@ -3503,6 +3807,17 @@ public:
     const TWPt<TStreamAggr>& GetStreamAggr(const int& StreamAggrN) const;
     /// Get list of all aggregates
     TStrV GetStreamAggrNmV() const;
+
+    /// Number of threads used for updating independent aggregates
+    int GetThreads() const { return Threads; }
+    /// Set number of threads used for updating independent aggregates, 1 for serial updates
+    void SetThreads(const int& _Threads);
+    /// Are we measuring latency of calls to aggregates
+    bool IsStatP() const { return StatP; }
+    /// Enable or disable measuring latency of calls, enabling starts with empty statistics
+    void SetStatP(const bool& _StatP);
+    /// Call counts and latency percentiles of each aggregate in the set
+    PJsonVal GetStatJson() const;
     
     /// Reset all aggregates in the set
     void Reset();
@@ -3513,6 +3828,11 @@ public:
     void OnTime(const uint64& TmMsec);
     /// Add new record to the aggregates
     void OnAddRec(const TRec& Rec);
+    /// Add a batch of records to the aggregates. When all aggregates are batchable
+    /// each gets the whole batch, otherwise records are dispatched one by one.
+    void OnAddRecs(const PRecSet& RecSet);
+    /// Batchable when all the aggregates in the set are batchable
+    bool IsBatchable() const;
     /// Recored already added to the aggregates is being updated
     void OnUpdateRec(const TRec& Rec);
     /// Recored already added to the aggregates is being deleted from the store 
@@ -3529,25 +3849,143 @@ public:
 };
 
 ///////////////////////////////
-/// Store trigger that pushes updates to stream aggregates
+/// Store trigger that pushes updates to stream aggregates.
+/// With batch size above one, added records are collected and forwarded to
+/// the aggregate with OnAddRecs once the batch is full. Pending records are
+/// flushed before any update or delete, so the aggregate sees changes in order.
 class TStreamAggrTrigger : public TStoreTrigger {
 private:
     /// Pointer to stream aggregate we forward records to
     TWPt<TStreamAggr> StreamAggr;
+    /// Store to which the trigger is attached
+    TWPt<TStore> Store;
+    /// Number of records collected before forwarding them to the aggregate
+    TInt BatchSize;
+    /// Records added since the last flush
+    TUInt64V BatchRecIdV;
+    /// Measure latency of updates
+    TBool StatP;
+    /// Time when statistics were enabled, in performance timer ticks
+    TUInt64 StatStartTicks;
+    /// Latency of updates triggered by added, updated and deleted records
+    TLatencyHist AddStat, UpdateStat, DeleteStat;
 
     /// Create new trigger for given stream aggregate
-    TStreamAggrTrigger(const TWPt<TStreamAggr>& StreamAggr);
+    TStreamAggrTrigger(const TWPt<TStreamAggr>& StreamAggr, const int& _BatchSize);
 public:
     /// Create new trigger for given stream aggregate
-    static PStoreTrigger New(const TWPt<TStreamAggr>& StreamAggr);
+    static PStoreTrigger New(const TWPt<TStreamAggr>& StreamAggr, const int& BatchSize = 1);
 
-    /// new record added to the store, call stream aggregate OnAddRec
+    /// remember the store, needed to create record sets from batches
+    void Init(const TWPt<TStore>& _Store) { Store = _Store; }
+    /// new record added to the store, call stream aggregate OnAddRec or add to batch
     void OnAdd(const TRec& Rec);
     /// record is updated in the store, call stream aggregate OnUpdateRec
     void OnUpdate(const TRec& Rec);
     /// record is deleted from the store, call stream aggregate OnDeleteRec
     void OnDelete(const TRec& Rec);
+
+    /// Number of records collected before forwarding them to the aggregate
+    int GetBatchSize() const { return BatchSize; }
+    /// Set batch size, flushes any pending records
+    void SetBatchSize(const int& _BatchSize);
+    /// Are there records waiting to be forwarded to the aggregate
+    bool IsPending() const { return !BatchRecIdV.Empty(); }
+    /// Forward pending records to the aggregate
+    void Flush();
+
+    /// Are we measuring latency of updates
+    bool IsStatP() const { return StatP; }
+    /// Enable or disable measuring latency of updates, enabling starts with empty statistics
+    void SetStatP(const bool& _StatP);
+    /// Number of records and latency of updates, with throughput since statistics were enabled
+    PJsonVal GetStatJson() const;
+};
+
+///////////////////////////////
+/// Incremental snapshot of stream aggregate states.
+/// Snapshot is a folder with a versioned index and one chunk file with the
+/// state of each aggregate. Saving writes new chunks only for aggregates which
+/// were updated since their chunk was written, and keeps the other chunks. The
+/// index is replaced last, so an interrupted save leaves the previous snapshot
+/// intact. Loading can map chunk files into memory instead of reading them.
+class TStreamAggrSnap {
+private:
+    // smart-pointer
+    TCRef CRef;
+    friend class TPt<TStreamAggrSnap>;
+
+    /// Version of the snapshot format written by this code
+    static const int Version;
+
+    /// Chunk with the state of one aggregate
+    class TChunk {
+    public:
+        /// Aggregate type, must match when loading
+        TStr AggrType;
+        /// Chunk file name, relative to the snapshot folder
+        TStr FNm;
+        /// Snapshot generation in which the chunk was written
+        TUInt64 Gen;
+        /// Length of the state in bytes
+        TUInt64 Len;
+        /// Checksum of the state
+        TInt Cs;
+        /// Aggregate last written to or read from the chunk, not saved
+        TWPt<TStreamAggr> StreamAggr;
+        /// Number of aggregate updates at that time, not saved
+        TUInt64 Updates;
+
+    public:
+        TChunk() { }
+        TChunk(TSIn& SIn): AggrType(SIn), FNm(SIn), Gen(SIn), Len(SIn), Cs(SIn) { }
+        void Save(TSOut& SOut) const {
+            AggrType.Save(SOut); FNm.Save(SOut); Gen.Save(SOut); Len.Save(SOut); Cs.Save(SOut); }
+
+        /// True when aggregate did not change since it was written to or read from the chunk
+        bool IsClean(const TWPt<TStreamAggr>& _StreamAggr) const {
+            return StreamAggr() == _StreamAggr() && Updates == _StreamAggr->GetUpdates(); }
+    };
+
+    /// Snapshot folder
+    TStr FPath;
+    /// Number of completed saves
+    TUInt64 Gen;
+    /// Number used in the name of the next chunk file
+    TUInt64 NextChunkN;
+    /// Chunks of the current snapshot, by aggregate name
+    THash<TStr, TChunk> ChunkH;
+
+    TStreamAggrSnap(const TStr& _FPath);
+
+    /// Index file name
+    TStr GetIdxFNm() const { return FPath + "StreamAggrSnap.idx"; }
+    /// Read the index, when the snapshot exists
+    void LoadIdx();
+    /// Write the index, replacing the old one
+    void SaveIdx() const;
+
+public:
+    /// Open snapshot in the given folder, empty when it does not exist yet
+    static TPt<TStreamAggrSnap> New(const TStr& FPath) { return new TStreamAggrSnap(FPath); }
+    /// Check if there is a snapshot in the given folder
+    static bool Exists(const TStr& FPath);
+
+    /// Snapshot folder
+    const TStr& GetFPath() const { return FPath; }
+    /// Number of completed saves
+    uint64 GetGen() const { return Gen; }
+    /// Names of the aggregates in the snapshot
+    TStrV GetAggrNmV() const { TStrV NmV; ChunkH.GetKeyV(NmV); return NmV; }
+
+    /// Save states of the given aggregates, the snapshot keeps only these.
+    /// Returns generation and names of written and reused chunks.
+    PJsonVal Save(const TWPt<TBase>& Base, const TStrV& AggrNmV);
+    /// Load states of aggregates from the snapshot, skipping the ones
+    /// not present in the base. Returns names of loaded and skipped aggregates.
+    PJsonVal Load(const TWPt<TBase>& Base, const bool& MMapP);
 };
+typedef TPt<TStreamAggrSnap> PStreamAggrSnap;
 
 ///////////////////////////////
 // QMiner-Base
@@ -3581,6 +4019,14 @@ private:
     THash<TStr, PStreamAggr> StreamAggrH;
     /// Stream aggregate sets for each store
     TVec<TWPt<TStreamAggrSet>> StreamAggrSetV;
+    /// Triggers forwarding store records to stream aggregate sets, indexed by store ID
+    TVec<TWPt<TStreamAggrTrigger>> StreamAggrTriggerV;
+    /// Measure latency of stream aggregates, also applied to stores added later
+    TBool StreamAggrStatP;
+    /// Materialized query views
+    THash<TStr, PQueryView> QueryViewH;
+    /// Stream aggregate snapshots used by this base, by folder
+    THash<TStr, PStreamAggrSnap> StreamAggrSnapH;
     
     /// Name validates used for validating field, join and key names
     TNmValidator NmValidator;
@@ -3594,6 +4040,8 @@ private:
 
     /// Get config name for base located on a given path
     static TStr GetConfFNm(const TStr& FPath) { return FPath + "Base.json"; }
+    /// Get file name with query views for base located on a given path
+    static TStr GetQueryViewFNm(const TStr& FPath) { return FPath + "QueryViews.dat"; }
     /// Load base config
     void LoadBaseConf(const TStr& FPath);
     /// Save base config
@@ -3667,6 +4115,35 @@ public:
     TStrV GetStreamAggrNmV() const { TStrV NmV; StreamAggrH.GetKeyV(NmV); return NmV; }
     /// Get stream aggregate set for the given store
     TWPt<TStreamAggrSet> GetStreamAggrSet(const uint& StoreId) const;
+    /// Get number of records collected before stream aggregates of the store are updated
+    int GetStreamAggrBatchSize(const uint& StoreId) const;
+    /// Set number of records collected before stream aggregates of the store are updated
+    void SetStreamAggrBatchSize(const uint& StoreId, const int& BatchSize);
+    /// Forward records waiting in batches to stream aggregates of all stores
+    void FlushStreamAggrs();
+    /// Are we measuring latency of stream aggregates
+    bool IsStreamAggrStatP() const { return StreamAggrStatP; }
+    /// Enable or disable measuring latency of stream aggregates of all stores
+    void SetStreamAggrStatP(const bool& StatP);
+    /// Latency and throughput of stream aggregates, for each store
+    PJsonVal GetStreamAggrStats() const;
+    /// Save states of the given aggregates to an incremental snapshot in the folder.
+    /// Only aggregates updated since the previous save to the same folder are written.
+    /// Empty list keeps the aggregates from the previous snapshot.
+    PJsonVal SaveStreamAggrState(const TStr& SnapFPath, const TStrV& AggrNmV = TStrV());
+    /// Load states of aggregates from the snapshot in the folder
+    PJsonVal LoadStreamAggrState(const TStr& SnapFPath, const bool& MMapP = true);
+
+    /// Check if base has query view with the given name
+    bool IsQueryView(const TStr& ViewNm) const { return QueryViewH.IsKey(ViewNm); }
+    /// Create new materialized query view
+    TWPt<TQueryView> AddQueryView(const TStr& ViewNm, const PJsonVal& QueryVal);
+    /// Get query view with the given name
+    TWPt<TQueryView> GetQueryView(const TStr& ViewNm) const;
+    /// Delete query view with the given name
+    void DelQueryView(const TStr& ViewNm);
+    /// Get list of all query views
+    TStrV GetQueryViewNmV() const { TStrV NmV; QueryViewH.GetKeyV(NmV); return NmV; }
 
     /// Aggregate given recordset and add aggregates to the record set
     void Aggr(PRecSet& RecSet, const TQueryAggrV& QueryAggrV);
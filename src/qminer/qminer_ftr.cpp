@@ -115,6 +115,14 @@ void TFtrExt::AddFullV(const TRec& Rec, TFltV& FullV, int& Offset) const {
     }
 }
 
+bool TFtrExt::PrepConcurrentRead() const {
+    int KeyId = JoinSeqH.FFirstKeyId();
+    while (JoinSeqH.FNextKeyId(KeyId)) {
+        if (!JoinSeqH[KeyId].PrepConcurrentRead(Base)) { return false; }
+    }
+    return true;
+}
+
 void TFtrExt::ExtractStrV(const TRec& FtrRec, TStrV& StrV) const { 
     throw TQmExcept::New("ExtractStrV not implemented!"); 
 }
@@ -294,25 +302,93 @@ void TFtrSpace::GetFullV(const TRec& Rec, TFltV& FullV, const int& FtrExtN) cons
     }
 }
 
-void TFtrSpace::GetSpVV(const PRecSet& RecSet, TVec<TIntFltKdV>& SpVV, const int& FtrExtN) const {
+int TFtrSpace::GetScanThreads(const PRecSet& RecSet, const int& Threads, const int& FtrExtN) const {
+    // check if record set is big enough and its store supports concurrent reads
+    const int ScanThreads = RecSet->GetScanThreads(Threads);
+    if (ScanThreads <= 1) { return 1; }
+    // check feature extractors
+    for (int _FtrExtN = 0; _FtrExtN < FtrExtV.Len(); _FtrExtN++) {
+        if (FtrExtN >= 0 && FtrExtN != _FtrExtN) { continue; }
+        if (!FtrExtV[_FtrExtN]->PrepConcurrentRead()) { return 1; }
+    }
+    return ScanThreads;
+}
+
+void TFtrSpace::GetSpVV(const PRecSet& RecSet, TVec<TIntFltKdV>& SpVV, const int& FtrExtN, const int& Threads) const {
     TEnv::Logger->OnStatusFmt("Creating sparse feature vectors from %d records", RecSet->GetRecs());
+    const int ScanThreads = GetScanThreads(RecSet, Threads, FtrExtN);
+    if (ScanThreads > 1) {
+        // make space for new vectors and fill them in parallel
+        const int Recs = RecSet->GetRecs(), FirstRecN = SpVV.Len();
+        SpVV.Reserve(FirstRecN + Recs);
+        for (int RecN = 0; RecN < Recs; RecN++) { SpVV.Add(); }
+        std::exception_ptr Except;
+        #pragma omp parallel for num_threads(ScanThreads) schedule(dynamic, TRecSet::ScanChunkSize)
+        for (int RecN = 0; RecN < Recs; RecN++) {
+            try {
+                GetSpV(RecSet->GetRec(RecN), SpVV[FirstRecN + RecN], FtrExtN);
+            } catch (...) {
+                #pragma omp critical
+                { if (!Except) { Except = std::current_exception(); } }
+            }
+        }
+        if (Except) { std::rethrow_exception(Except); }
+        return;
+    }
     for (int RecN = 0; RecN < RecSet->GetRecs(); RecN++) {
         if (RecN % 10000 == 0) { TEnv::Logger->OnStatusFmt("%d\r", RecN); }
         SpVV.Add(TIntFltKdV()); GetSpV(RecSet->GetRec(RecN), SpVV.Last(), FtrExtN);
     }
 }
 
-void TFtrSpace::GetFullVV(const PRecSet& RecSet, TVec<TFltV>& FullVV, const int& FtrExtN) const {
+void TFtrSpace::GetFullVV(const PRecSet& RecSet, TVec<TFltV>& FullVV, const int& FtrExtN, const int& Threads) const {
     TEnv::Logger->OnStatusFmt("Creating full feature vectors from %d records", RecSet->GetRecs());
+    const int ScanThreads = GetScanThreads(RecSet, Threads, FtrExtN);
+    if (ScanThreads > 1) {
+        // make space for new vectors and fill them in parallel
+        const int Recs = RecSet->GetRecs(), FirstRecN = FullVV.Len();
+        FullVV.Reserve(FirstRecN + Recs);
+        for (int RecN = 0; RecN < Recs; RecN++) { FullVV.Add(); }
+        std::exception_ptr Except;
+        #pragma omp parallel for num_threads(ScanThreads) schedule(dynamic, TRecSet::ScanChunkSize)
+        for (int RecN = 0; RecN < Recs; RecN++) {
+            try {
+                GetFullV(RecSet->GetRec(RecN), FullVV[FirstRecN + RecN], FtrExtN);
+            } catch (...) {
+                #pragma omp critical
+                { if (!Except) { Except = std::current_exception(); } }
+            }
+        }
+        if (Except) { std::rethrow_exception(Except); }
+        return;
+    }
     for (int RecN = 0; RecN < RecSet->GetRecs(); RecN++) {
         if (RecN % 10000 == 0) { TEnv::Logger->OnStatusFmt("%d\r", RecN); }
         FullVV.Add(TFltV()); GetFullV(RecSet->GetRec(RecN), FullVV.Last(), FtrExtN);
     }
 }
 
-void TFtrSpace::GetFullVV(const PRecSet& RecSet, TFltVV& FullVV, const int& FtrExtN) const {
+void TFtrSpace::GetFullVV(const PRecSet& RecSet, TFltVV& FullVV, const int& FtrExtN, const int& Threads) const {
     TEnv::Logger->OnStatusFmt("Creating full feature vectors from %d records", RecSet->GetRecs());
-    if (FtrExtN < 0) {
+    const int ScanThreads = GetScanThreads(RecSet, Threads, FtrExtN);
+    if (ScanThreads > 1) {
+        // each record writes its own column, so chunks can be filled in parallel
+        const int Recs = RecSet->GetRecs();
+        if (FtrExtN >= 0) { EAssert(FtrExtN < FtrExtV.Len()); }
+        FullVV.Gen((FtrExtN < 0) ? GetDim() : FtrExtV[FtrExtN]->GetDim(), Recs);
+        std::exception_ptr Except;
+        #pragma omp parallel for num_threads(ScanThreads) schedule(dynamic, TRecSet::ScanChunkSize)
+        for (int RecN = 0; RecN < Recs; RecN++) {
+            try {
+                TFltV Temp; GetFullV(RecSet->GetRec(RecN), Temp, FtrExtN);
+                FullVV.SetCol(RecN, Temp);
+            } catch (...) {
+                #pragma omp critical
+                { if (!Except) { Except = std::current_exception(); } }
+            }
+        }
+        if (Except) { std::rethrow_exception(Except); }
+    } else if (FtrExtN < 0) {
         FullVV.Gen(GetDim(), RecSet->GetRecs());
         TFltV Temp(GetDim());
         for (int RecN = 0; RecN < RecSet->GetRecs(); RecN++) {
@@ -470,6 +546,60 @@ PBowDocBs TFtrSpace::MakeBowDocBs(const PRecSet& FtrRecSet) {
     return BowDocBs;
 }
 
+///////////////////////////////////////////////
+// Feature batch source
+TFtrSpaceBatchSrc::TFtrSpaceBatchSrc(const PFtrSpace& _FtrSpace, const PRecSet& _RecSet,
+        const bool& _SparseP, const int& _FtrExtN, const int& Threads):
+            FtrSpace(_FtrSpace), RecSet(_RecSet), FtrExtN(_FtrExtN), SparseP(_SparseP) {
+
+    QmAssertR(FtrExtN < FtrSpace->GetFtrExts(), "TFtrSpaceBatchSrc: invalid feature extractor index");
+    ScanThreads = FtrSpace->GetScanThreads(RecSet, Threads, FtrExtN);
+}
+
+PFtrBatchSrc TFtrSpaceBatchSrc::New(const PFtrSpace& FtrSpace, const PRecSet& RecSet,
+        const bool& SparseP, const int& FtrExtN, const int& Threads) {
+
+    return new TFtrSpaceBatchSrc(FtrSpace, RecSet, SparseP, FtrExtN, Threads);
+}
+
+int TFtrSpaceBatchSrc::GetDim() const {
+    return (FtrExtN < 0) ? FtrSpace->GetDim() : FtrSpace->GetFtrExtDim(FtrExtN);
+}
+
+void TFtrSpaceBatchSrc::GetBatch(const TIntV& InstNV, TFltVV& BatchVV) const {
+    const int Insts = InstNV.Len();
+    BatchVV.Gen(GetDim(), Insts);
+    // each record writes its own column, so batches can be filled in parallel
+    std::exception_ptr Except;
+    #pragma omp parallel for num_threads(ScanThreads.Val) if(Insts >= TRecSet::ScanChunkSize) schedule(static)
+    for (int InstN = 0; InstN < Insts; InstN++) {
+        try {
+            TFltV FullV; FtrSpace->GetFullV(RecSet->GetRec(InstNV[InstN]), FullV, FtrExtN);
+            BatchVV.SetCol(InstN, FullV);
+        } catch (...) {
+            #pragma omp critical
+            { if (!Except) { Except = std::current_exception(); } }
+        }
+    }
+    if (Except) { std::rethrow_exception(Except); }
+}
+
+void TFtrSpaceBatchSrc::GetBatch(const TIntV& InstNV, TVec<TIntFltKdV>& BatchVV) const {
+    const int Insts = InstNV.Len();
+    BatchVV.Gen(Insts);
+    std::exception_ptr Except;
+    #pragma omp parallel for num_threads(ScanThreads.Val) if(Insts >= TRecSet::ScanChunkSize) schedule(static)
+    for (int InstN = 0; InstN < Insts; InstN++) {
+        try {
+            FtrSpace->GetSpV(RecSet->GetRec(InstNV[InstN]), BatchVV[InstN], FtrExtN);
+        } catch (...) {
+            #pragma omp critical
+            { if (!Except) { Except = std::current_exception(); } }
+        }
+    }
+    if (Except) { std::rethrow_exception(Except); }
+}
+
 namespace TFtrExts {
 
 ///////////////////////////////////////////////
@@ -1700,6 +1830,11 @@ bool TPair::Update(const TRec& FtrRec) {
     return true;
 }
 
+bool TPair::PrepConcurrentRead() const {
+    return TFtrExt::PrepConcurrentRead() &&
+        FtrExt1->PrepConcurrentRead() && FtrExt2->PrepConcurrentRead();
+}
+
 void TPair::AddSpV(const TRec& FtrRec, TIntFltKdV& SpV, int& Offset) const {
     // extract feature values using each extractor
     TIntV FtrIdV1; GetFtrIdV_RdOnly(FtrRec, FtrExt1, FtrIdV1);
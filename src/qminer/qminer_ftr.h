@@ -93,6 +93,9 @@ public:
     virtual void AddSpV(const TRec& Rec, TIntFltKdV& SpV, int& Offset) const = 0;
     /// Attaches features to a given full feature vectors with a given offset
     virtual void AddFullV(const TRec& Rec, TFltV& FullV, int& Offset) const;
+    /// Prepares joined stores for extraction from several threads at the same time.
+    /// Returns false when extraction must run on a single thread.
+    virtual bool PrepConcurrentRead() const;
 
     // deprecated, to be removed
     virtual double __GetVal(const double& InVal) const { printf("__GetVal is DEPRECATED\n"); throw TQmExcept::New("TFtrExt::GetVal not implemented"); };
@@ -177,12 +180,14 @@ public:
     void GetSpV(const TRec& Rec, TIntFltKdV& SpV, const int& FtrExtN = -1) const;
     /// Extract full feature vector from a record
     void GetFullV(const TRec& Rec, TFltV& FullV, const int& FtrExtN = -1) const;
+    /// Number of threads that can be used to extract features from the record set
+    int GetScanThreads(const PRecSet& RecSet, const int& Threads, const int& FtrExtN = -1) const;
     /// Extracting sparse feature vectors from a record set
-    void GetSpVV(const PRecSet& RecSet, TVec<TIntFltKdV>& SpVV, const int& FtrExtN = -1) const;
+    void GetSpVV(const PRecSet& RecSet, TVec<TIntFltKdV>& SpVV, const int& FtrExtN = -1, const int& Threads = 1) const;
     /// Extracting full feature vectors from a record set
-    void GetFullVV(const PRecSet& RecSet, TVec<TFltV>& FullVV, const int& FtrExtN = -1) const;
+    void GetFullVV(const PRecSet& RecSet, TVec<TFltV>& FullVV, const int& FtrExtN = -1, const int& Threads = 1) const;
     /// Extracting full feature vectors (columns) from a record set
-    void GetFullVV(const PRecSet& RecSet, TFltVV& FullVV, const int& FtrExtN = -1) const;
+    void GetFullVV(const PRecSet& RecSet, TFltVV& FullVV, const int& FtrExtN = -1, const int& Threads = 1) const;
     /// Compute sparse centroid of a given record set
     void GetCentroidSpV(const PRecSet& RecSet, TIntFltKdV& CentroidSpV, const bool& NormalizeP = true) const;
     /// Compute full centroid of a given record set
@@ -225,6 +230,39 @@ public:
 };
 typedef TPt<TFtrSpace> PFtrSpace;
 
+///////////////////////////////////////////////
+/// Feature batch source over a record set. Feature vectors are extracted
+/// when a batch is requested, so learners can go over large record sets
+/// without keeping the whole feature matrix in memory. Large batches
+/// are extracted in parallel when the store and extractors allow it.
+class TFtrSpaceBatchSrc : public TFtrBatchSrc {
+private:
+    /// Feature space used for extraction
+    PFtrSpace FtrSpace;
+    /// Records, the n-th instance is the n-th record
+    PRecSet RecSet;
+    /// Feature extractor to use (-1 for all)
+    TInt FtrExtN;
+    /// Return sparse batches
+    TBool SparseP;
+    /// Number of threads used to extract large batches
+    TInt ScanThreads;
+
+    TFtrSpaceBatchSrc(const PFtrSpace& _FtrSpace, const PRecSet& _RecSet, const bool& _SparseP,
+        const int& _FtrExtN, const int& Threads);
+public:
+    /// Create batch source over the records in RecSet
+    static PFtrBatchSrc New(const PFtrSpace& FtrSpace, const PRecSet& RecSet, const bool& SparseP,
+        const int& FtrExtN = -1, const int& Threads = 1);
+
+    int GetInsts() const { return RecSet->GetRecs(); }
+    int GetDim() const;
+    bool IsSparse() const { return SparseP; }
+
+    void GetBatch(const TIntV& InstNV, TFltVV& BatchVV) const;
+    void GetBatch(const TIntV& InstNV, TVec<TIntFltKdV>& BatchVV) const;
+};
+
 ///////////////////////////////////////////////
 /// Implemented feature extractors.
 namespace TFtrExts {
@@ -289,6 +327,8 @@ public:
     bool Update(const TRec& Rec) { return false; }
     void AddSpV(const TRec& Rec, TIntFltKdV& SpV, int& Offset) const;
     void AddFullV(const TRec& Rec, TFltV& FullV, int& Offset) const;
+    // random generator is shared, so extraction cannot be parallel
+    bool PrepConcurrentRead() const { return false; }
 
     // flat feature extraction
     void ExtractFltV(const TRec& FtrRec, TFltV& FltV) const;
@@ -601,6 +641,8 @@ public:
     bool Update(const TRec& Rec);
     void AddSpV(const TRec& Rec, TIntFltKdV& SpV, int& Offset) const;
     void AddFullV(const TRec& Rec, TFltV& FullV, int& Offset) const;
+    // tokenizers and stemmers keep internal state, so extraction cannot be parallel
+    bool PrepConcurrentRead() const { return false; }
 
     // flat feature extraction
     void ExtractStrV(const TRec& Rec, TStrV& StrV) const;
@@ -695,6 +737,8 @@ public:
     bool Update(const TRec& FtrRec);
     void AddSpV(const TRec& FtrRec, TIntFltKdV& SpV, int& Offset) const;
     //void AddFullV(const TRec& Rec, TFltV& FullV, int& Offset) const;
+    // parallel only when both feature extractors are
+    bool PrepConcurrentRead() const;
 
     // flat feature extraction
     void ExtractStrV(const TRec& FtrRec, TStrV& StrV) const;
@@ -3080,6 +3080,14 @@ uint64 TStoreImpl::GetLastRecId() const {
         (DataMemP ? DataMem.GetLastValId() : DataCache.GetLastValId());
 }
 
+bool TStoreImpl::PrepConcurrentRead() {
+    // disk cache loads and evicts blocks on read, so it cannot be shared between threads
+    if (DataCacheP) { return false; }
+    // make sure in-memory records are deserialized, so reads do not modify storage
+    if (DataMemP) { DataMem.LoadAll(); }
+    return true;
+}
+
 PStoreIter TStoreImpl::BackwardIter() const {
     if (Empty()) { return TStoreIterVec::New(); }
     return DataMemP ? 
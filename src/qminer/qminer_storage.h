@@ -955,6 +955,8 @@ public:
     bool HasFirstRecId() const { return true; }
     /// Is the last record id getter implemented?
     bool HasLastRecId() const { return true; }
+    /// Loads all in-memory records; fails when some fields are stored in disk cache
+    bool PrepConcurrentRead();
 
     /// Add new record
     uint64 AddRec(const PJsonVal& RecVal, const bool& TriggerEvents = true);
@@ -0,0 +1,404 @@
+/**
+* Copyright (c) 2015, Jozef Stefan Institute, Quintelligence d.o.o. and contributors
+* All rights reserved.
+*
+* This source code is licensed under the FreeBSD license found in the
+* LICENSE file in the root directory of this source tree.
+*/
+
+#include <base.h>
+///////////////////////////////////////////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+
+#ifdef WIN32
+#ifdef _DEBUG
+#define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
+#define new DEBUG_NEW
+#endif
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+	void GenRndMat(const int& Rows, const int& Cols, TRnd& Rnd, TFltVV& Mat) {
+		Mat.Gen(Rows, Cols);
+		for (int RowN = 0; RowN < Rows; RowN++) {
+			for (int ColN = 0; ColN < Cols; ColN++) {
+				Mat(RowN, ColN) = Rnd.GetUniDev() - 0.5;
+			}
+		}
+	}
+
+	// C := op(A) * op(B), three loops
+	void NaiveMultiply(const TFltVV& A, const TFltVV& B, const bool& TransA, const bool& TransB, TFltVV& C) {
+		const int Rows = TransA ? A.GetCols() : A.GetRows();
+		const int Depth = TransA ? A.GetRows() : A.GetCols();
+		const int Cols = TransB ? B.GetRows() : B.GetCols();
+		C.Gen(Rows, Cols);
+		for (int RowN = 0; RowN < Rows; RowN++) {
+			for (int ColN = 0; ColN < Cols; ColN++) {
+				double Sum = 0.0;
+				for (int ElN = 0; ElN < Depth; ElN++) {
+					Sum += (TransA ? A(ElN, RowN) : A(RowN, ElN)) * (TransB ? B(ColN, ElN) : B(ElN, ColN));
+				}
+				C(RowN, ColN) = Sum;
+			}
+		}
+	}
+
+	double MaxDiff(const TFltVV& A, const TFltVV& B) {
+		EXPECT_EQ(A.GetRows(), B.GetRows());
+		EXPECT_EQ(A.GetCols(), B.GetCols());
+		double Diff = 0.0;
+		for (int RowN = 0; RowN < A.GetRows(); RowN++) {
+			for (int ColN = 0; ColN < A.GetCols(); ColN++) {
+				Diff = TFlt::GetMx(Diff, TFlt::Abs(A(RowN, ColN) - B(RowN, ColN)));
+			}
+		}
+		return Diff;
+	}
+}
+
+TEST(TLinAlgKernel, Gemm) {
+	try {
+		TRnd Rnd(1);
+		// sizes around the register tile and cache block edges
+		const int SizeV[][3] = { { 1, 1, 1 }, { 3, 7, 5 }, { 4, 8, 1 }, { 5, 9, 17 },
+			{ 97, 33, 260 }, { 130, 270, 300 }, { 200, 2100, 20 } };
+		for (const auto& Size : SizeV) {
+			for (int TransN = 0; TransN < 4; TransN++) {
+				const bool TransA = (TransN & 1) != 0, TransB = (TransN & 2) != 0;
+				TFltVV A, B;
+				GenRndMat(TransA ? Size[2] : Size[0], TransA ? Size[0] : Size[2], Rnd, A);
+				GenRndMat(TransB ? Size[1] : Size[2], TransB ? Size[2] : Size[1], Rnd, B);
+				TFltVV Expected; NaiveMultiply(A, B, TransA, TransB, Expected);
+				TFltVV C(Size[0], Size[1]);
+				TLinAlg::Multiply(A, B, C, TransA ? TLinAlg::TRANS : TLinAlg::NOTRANS,
+					TransB ? TLinAlg::TRANS : TLinAlg::NOTRANS);
+				EXPECT_LT(MaxDiff(C, Expected), 1e-10);
+			}
+		}
+	} catch (PExcept& Except) {
+		printf("Error: %s", Except->GetStr());
+		throw Except;
+	}
+}
+
+TEST(TLinAlgKernel, GemmAlphaBeta) {
+	try {
+		TRnd Rnd(2);
+		TFltVV A, B, C, D;
+		GenRndMat(50, 40, Rnd, A); GenRndMat(40, 30, Rnd, B); GenRndMat(30, 50, Rnd, C);
+		// D = 2 * A * B - 0.5 * C'
+		D.Gen(50, 30); TLinAlg::Gemm(2.0, A, B, -0.5, C, D, TLinAlg::GEMM_C_T);
+		TFltVV Expected; NaiveMultiply(A, B, false, false, Expected);
+		for (int RowN = 0; RowN < Expected.GetRows(); RowN++) {
+			for (int ColN = 0; ColN < Expected.GetCols(); ColN++) {
+				Expected(RowN, ColN) = 2.0 * Expected(RowN, ColN) - 0.5 * C(ColN, RowN);
+			}
+		}
+		EXPECT_LT(MaxDiff(D, Expected), 1e-10);
+	} catch (PExcept& Except) {
+		printf("Error: %s", Except->GetStr());
+		throw Except;
+	}
+}
+
+TEST(TLinAlgKernel, GemmColMajor) {
+	try {
+		TRnd Rnd(3);
+		TFltVV A, B; GenRndMat(37, 21, Rnd, A); GenRndMat(21, 45, Rnd, B);
+		TFltVV Expected; NaiveMultiply(A, B, false, false, Expected);
+		TVVec<TFlt, int, true> ColA(37, 21, true), ColB(21, 45, true), ColC(37, 45, true);
+		for (int RowN = 0; RowN < 37; RowN++) {
+			for (int ColN = 0; ColN < 21; ColN++) { ColA(RowN, ColN) = A(RowN, ColN); }
+		}
+		for (int RowN = 0; RowN < 21; RowN++) {
+			for (int ColN = 0; ColN < 45; ColN++) { ColB(RowN, ColN) = B(RowN, ColN); }
+		}
+		TLinAlg::Multiply(ColA, ColB, ColC);
+		for (int RowN = 0; RowN < 37; RowN++) {
+			for (int ColN = 0; ColN < 45; ColN++) {
+				EXPECT_NEAR(ColC(RowN, ColN), Expected(RowN, ColN), 1e-10);
+			}
+		}
+	} catch (PExcept& Except) {
+		printf("Error: %s", Except->GetStr());
+		throw Except;
+	}
+}
+
+TEST(TLinAlgKernel, Gemv) {
+	try {
+		TRnd Rnd(4);
+		TFltVV A; GenRndMat(301, 77, Rnd, A);
+		TFltV x(77), xt(301);
+		for (int ElN = 0; ElN < x.Len(); ElN++) { x[ElN] = Rnd.GetUniDev(); }
+		for (int ElN = 0; ElN < xt.Len(); ElN++) { xt[ElN] = Rnd.GetUniDev(); }
+		// y := A * x
+		TFltV y(301); TLinAlg::Multiply(A, x, y);
+		for (int RowN = 0; RowN < A.GetRows(); RowN++) {
+			double Sum = 0.0;
+			for (int ColN = 0; ColN < A.GetCols(); ColN++) { Sum += A(RowN, ColN) * x[ColN]; }
+			EXPECT_NEAR(y[RowN], Sum, 1e-10);
+		}
+		// y := 2 * A' * x + 3 * y
+		TFltV yt(77); yt.PutAll(1.0);
+		TLinAlg::Multiply(A, xt, yt, TLinAlg::TRANS, 2.0, 3.0);
+		for (int ColN = 0; ColN < A.GetCols(); ColN++) {
+			double Sum = 0.0;
+			for (int RowN = 0; RowN < A.GetRows(); RowN++) { Sum += A(RowN, ColN) * xt[RowN]; }
+			EXPECT_NEAR(yt[ColN], 2.0 * Sum + 3.0, 1e-10);
+		}
+	} catch (PExcept& Except) {
+		printf("Error: %s", Except->GetStr());
+		throw Except;
+	}
+}
+
+TEST(TLinAlgKernel, Syrk) {
+	try {
+		TRnd Rnd(5);
+		TFltVV A; GenRndMat(333, 150, Rnd, A);
+		TFltVV Expected; NaiveMultiply(A, A, true, false, Expected);
+		// A' * A goes through SYRK
+		TFltVV C(150, 150); TLinAlg::MultiplyT(A, A, C);
+		EXPECT_LT(MaxDiff(C, Expected), 1e-10);
+		for (int RowN = 0; RowN < C.GetRows(); RowN++) {
+			for (int ColN = 0; ColN < RowN; ColN++) {
+				EXPECT_EQ(C(RowN, ColN), C(ColN, RowN));
+			}
+		}
+	} catch (PExcept& Except) {
+		printf("Error: %s", Except->GetStr());
+		throw Except;
+	}
+}
+
+TEST(TLinAlg, AddGram) {
+	try {
+		TRnd Rnd(6);
+		TFltVV A; GenRndMat(170, 400, Rnd, A);
+		TFltVV B; GenRndMat(170, 90, Rnd, B);
+		TFltVV Expected, ExpectedB; NaiveMultiply(A, A, false, true, Expected);
+		NaiveMultiply(B, B, false, true, ExpectedB);
+		// the Gram matrix is accumulated over two chunks of columns
+		TFltVV G(170, 170);
+		TLinAlg::AddGram(A, G);
+		TLinAlg::AddGram(B, G);
+		for (int RowN = 0; RowN < G.GetRows(); RowN++) {
+			for (int ColN = 0; ColN < G.GetCols(); ColN++) {
+				Expected(RowN, ColN) += ExpectedB(RowN, ColN);
+			}
+		}
+		EXPECT_LT(MaxDiff(G, Expected), 1e-10);
+		for (int RowN = 0; RowN < G.GetRows(); RowN++) {
+			for (int ColN = 0; ColN < RowN; ColN++) {
+				EXPECT_EQ(G(RowN, ColN), G(ColN, RowN));
+			}
+		}
+	} catch (PExcept& Except) {
+		printf("Error: %s", Except->GetStr());
+		throw Except;
+	}
+}
+
+TEST(TLinAlgKernel, SparseDense) {
+	try {
+		// A = [1 0 2; 0 3 0] in coordinate form, B is 3 x 2
+		TTriple<TIntV, TIntV, TFltV> A;
+		A.Val1.Add(0); A.Val2.Add(0); A.Val3.Add(1.0);
+		A.Val1.Add(0); A.Val2.Add(2); A.Val3.Add(2.0);
+		A.Val1.Add(1); A.Val2.Add(1); A.Val3.Add(3.0);
+		TFltVV B(3, 2);
+		B(0, 0) = 1; B(0, 1) = 2; B(1, 0) = 3; B(1, 1) = 4; B(2, 0) = 5; B(2, 1) = 6;
+		TFltVV C(2, 2); TLinAlg::MultiplySF(A, B, C);
+		EXPECT_EQ(C(0, 0), 11.0); EXPECT_EQ(C(0, 1), 14.0);
+		EXPECT_EQ(C(1, 0), 9.0); EXPECT_EQ(C(1, 1), 12.0);
+		// the same matrix in CSR form
+		TTriple<TIntV, TIntV, TFltV> CsrA;
+		CsrA.Val1.Add(0); CsrA.Val1.Add(2); CsrA.Val1.Add(3);
+		CsrA.Val2 = A.Val2; CsrA.Val3 = A.Val3;
+		TFltVV CsrC(2, 2); TLinAlg::MultiplySF(CsrA, B, CsrC, "N", 1);
+		EXPECT_EQ(MaxDiff(C, CsrC), 0.0);
+	} catch (PExcept& Except) {
+		printf("Error: %s", Except->GetStr());
+		throw Except;
+	}
+}
+
+namespace {
+	// random sparse column matrix with about Density * Rows nonzeros per column
+	void GenRndSpMat(const int& Rows, const int& Cols, const double& Density, TRnd& Rnd,
+			TVec<TIntFltKdV>& SpMat, TFltVV& Mat) {
+		SpMat.Gen(Cols); Mat.Gen(Rows, Cols);
+		for (int ColN = 0; ColN < Cols; ColN++) {
+			for (int RowN = 0; RowN < Rows; RowN++) {
+				if (Rnd.GetUniDev() < Density) {
+					const double Val = Rnd.GetUniDev() - 0.5;
+					SpMat[ColN].Add(TIntFltKd(RowN, Val));
+					Mat(RowN, ColN) = Val;
+				}
+			}
+		}
+	}
+}
+
+TEST(TCompressedSparseMatrix, Convert) {
+	try {
+		TRnd Rnd(7);
+		TVec<TIntFltKdV> SpMat; TFltVV Mat;
+		GenRndSpMat(50, 30, 0.1, Rnd, SpMat, Mat);
+		// an empty last row must be kept when the number of rows is given
+		TCompressedSparseMatrix CsMat(SpMat, 51);
+		EXPECT_EQ(CsMat.GetRows(), 51);
+		EXPECT_EQ(CsMat.GetCols(), 30);
+		TVec<TIntFltKdV> ColSpVV; CsMat.GetColSpVV(ColSpVV);
+		EXPECT_TRUE(ColSpVV == SpMat);
+		TVec<TIntFltKdV> RowSpVV; CsMat.GetRowSpVV(RowSpVV);
+		EXPECT_EQ(RowSpVV.Len(), 51);
+		EXPECT_EQ(RowSpVV.Last().Len(), 0);
+		for (int RowN = 0; RowN < 50; RowN++) {
+			for (int ElN = 0; ElN < RowSpVV[RowN].Len(); ElN++) {
+				const TIntFltKd& El = RowSpVV[RowN][ElN];
+				EXPECT_EQ(Mat(RowN, El.Key), El.Dat);
+				if (ElN > 0) { EXPECT_LT(RowSpVV[RowN][ElN - 1].Key, El.Key); }
+			}
+		}
+		EXPECT_ANY_THROW(TCompressedSparseMatrix(SpMat, 10));
+
+		TMOut MOut; CsMat.Save(MOut);
+		TCompressedSparseMatrix LoadMat; LoadMat.Load(*MOut.GetSIn());
+		EXPECT_EQ(LoadMat.GetNnz(), CsMat.GetNnz());
+		TVec<TIntFltKdV> LoadRowSpVV; LoadMat.GetRowSpVV(LoadRowSpVV);
+		EXPECT_TRUE(LoadRowSpVV == RowSpVV);
+	} catch (PExcept& Except) {
+		printf("Error: %s", Except->GetStr());
+		throw Except;
+	}
+}
+
+TEST(TCompressedSparseMatrix, Multiply) {
+	try {
+		TRnd Rnd(8);
+		// large enough to run in parallel
+		TVec<TIntFltKdV> SpMat; TFltVV Mat;
+		GenRndSpMat(400, 300, 0.05, Rnd, SpMat, Mat);
+		TCompressedSparseMatrix CsMat(SpMat, 400);
+
+		TFltVV B, BT, Expected, Result;
+		GenRndMat(300, 64, Rnd, B);
+		NaiveMultiply(Mat, B, false, false, Expected);
+		CsMat.Multiply(B, Result);
+		EXPECT_LT(MaxDiff(Result, Expected), 1e-12);
+		GenRndMat(400, 64, Rnd, BT);
+		NaiveMultiply(Mat, BT, true, false, Expected);
+		Result.Clr(); CsMat.MultiplyT(BT, Result);
+		EXPECT_LT(MaxDiff(Result, Expected), 1e-12);
+
+		// vectors and single columns
+		TFltV x(300), y(400), Res(400), ResT(300);
+		for (int ElN = 0; ElN < x.Len(); ElN++) { x[ElN] = B(ElN, 3); }
+		for (int ElN = 0; ElN < y.Len(); ElN++) { y[ElN] = BT(ElN, 5); }
+		CsMat.Multiply(x, Res);
+		CsMat.MultiplyT(y, ResT);
+		TFltV ColRes(400), ColResT(300);
+		CsMat.Multiply(B, 3, ColRes);
+		CsMat.MultiplyT(BT, 5, ColResT);
+		for (int RowN = 0; RowN < 400; RowN++) {
+			double Sum = 0.0;
+			for (int ColN = 0; ColN < 300; ColN++) { Sum += Mat(RowN, ColN) * x[ColN]; }
+			EXPECT_NEAR(Res[RowN], Sum, 1e-12);
+			EXPECT_EQ(ColRes[RowN], Res[RowN]);
+		}
+		for (int ColN = 0; ColN < 300; ColN++) {
+			double Sum = 0.0;
+			for (int RowN = 0; RowN < 400; RowN++) { Sum += Mat(RowN, ColN) * y[RowN]; }
+			EXPECT_NEAR(ResT[ColN], Sum, 1e-12);
+			EXPECT_EQ(ColResT[ColN], ResT[ColN]);
+		}
+
+		// the transposed view swaps the products
+		CsMat.Transpose();
+		EXPECT_EQ(CsMat.GetRows(), 300);
+		TFltV TRes(300); CsMat.Multiply(y, TRes);
+		for (int ColN = 0; ColN < 300; ColN++) { EXPECT_EQ(TRes[ColN], ResT[ColN]); }
+	} catch (PExcept& Except) {
+		printf("Error: %s", Except->GetStr());
+		throw Except;
+	}
+}
+
+TEST(TCompressedSparseMatrix, TLinAlgSparseDense) {
+	try {
+		TRnd Rnd(9);
+		TVec<TIntFltKdV> SpMat; TFltVV Mat;
+		GenRndSpMat(200, 150, 0.1, Rnd, SpMat, Mat);
+		TFltVV B, BT, D, Expected, Result;
+		GenRndMat(150, 40, Rnd, B);
+		GenRndMat(200, 40, Rnd, BT);
+		GenRndMat(30, 200, Rnd, D);
+		// A * B
+		NaiveMultiply(Mat, B, false, false, Expected);
+		TLinAlg::Multiply(SpMat, B, Result, 200);
+		EXPECT_LT(MaxDiff(Result, Expected), 1e-12);
+		// A' * B
+		NaiveMultiply(Mat, BT, true, false, Expected);
+		Result.Clr(); TLinAlg::MultiplyT(SpMat, BT, Result);
+		EXPECT_LT(MaxDiff(Result, Expected), 1e-12);
+		// D * A
+		NaiveMultiply(D, Mat, false, false, Expected);
+		Result.Clr(); TLinAlg::Multiply(D, SpMat, Result);
+		EXPECT_LT(MaxDiff(Result, Expected), 1e-12);
+		// BT' * A
+		NaiveMultiply(BT, Mat, true, false, Expected);
+		Result.Clr(); TLinAlg::MultiplyT(BT, SpMat, Result);
+		EXPECT_LT(MaxDiff(Result, Expected), 1e-12);
+		// A' * A
+		NaiveMultiply(Mat, Mat, true, false, Expected);
+		Result.Clr(); TLinAlg::MultiplyT(SpMat, SpMat, Result);
+		EXPECT_LT(MaxDiff(Result, Expected), 1e-12);
+	} catch (PExcept& Except) {
+		printf("Error: %s", Except->GetStr());
+		throw Except;
+	}
+}
+
+// micro-benchmark, reports timings of the naive loops, the kernels and BLAS (when compiled in);
+// disabled by default, run with --gtest_also_run_disabled_tests --gtest_filter=*Benchmark
+TEST(TLinAlgKernel, DISABLED_Benchmark) {
+	try {
+		printf("micro-kernel: %s\n", TLinAlgKernel::GetSimdNm().CStr());
+		TRnd Rnd(6);
+		const int Size = 512;
+		TFltVV A, B; GenRndMat(Size, Size, Rnd, A); GenRndMat(Size, Size, Rnd, B);
+		const double Flops = 2.0 * Size * Size * Size;
+
+		uint64 StartMSecs = TTm::GetCurUniMSecs();
+		TFltVV Naive; NaiveMultiply(A, B, false, false, Naive);
+		const double NaiveSecs = (TTm::GetCurUniMSecs() - StartMSecs) / 1000.0;
+
+		StartMSecs = TTm::GetCurUniMSecs();
+		TFltVV C(Size, Size);
+		TLinAlgKernel::Gemm(false, false, Size, Size, Size, 1.0, &A(0, 0).Val, Size,
+			&B(0, 0).Val, Size, 0.0, &C(0, 0).Val, Size);
+		const double KernelSecs = (TTm::GetCurUniMSecs() - StartMSecs) / 1000.0;
+		EXPECT_LT(MaxDiff(C, Naive), 1e-9);
+
+		printf("gemm %dx%d naive:  %.3fs (%.2f GFLOPS)\n", Size, Size, NaiveSecs, Flops / TFlt::GetMx(NaiveSecs, 1e-3) / 1e9);
+		printf("gemm %dx%d kernel: %.3fs (%.2f GFLOPS)\n", Size, Size, KernelSecs, Flops / TFlt::GetMx(KernelSecs, 1e-3) / 1e9);
+#ifdef BLAS
+		StartMSecs = TTm::GetCurUniMSecs();
+		TFltVV BlasC(Size, Size);
+		cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, Size, Size, Size, 1.0,
+			&A(0, 0).Val, Size, &B(0, 0).Val, Size, 0.0, &BlasC(0, 0).Val, Size);
+		const double BlasSecs = (TTm::GetCurUniMSecs() - StartMSecs) / 1000.0;
+		EXPECT_LT(MaxDiff(C, BlasC), 1e-9);
+		printf("gemm %dx%d blas:   %.3fs (%.2f GFLOPS)\n", Size, Size, BlasSecs, Flops / TFlt::GetMx(BlasSecs, 1e-3) / 1e9);
+#endif
+	} catch (PExcept& Except) {
+		printf("Error: %s", Except->GetStr());
+		throw Except;
+	}
+}
@@ -18,7 +18,10 @@ describe("Kmeans test", function () {
         it("should return empty parameter values", function () {
             var KMeans = new analytics.KMeans();
             var params = KMeans.getParams();
-            assert.equal(Object.keys(params).length, 6);
+            assert.equal(Object.keys(params).length, 9);
+            assert.equal(params.batchSize, 0);
+            assert.equal(params.init, "random");
+            assert.equal(params.threads, 1);
         });
         it("should return parameter values", function () {
             var KMeans = new analytics.KMeans({ iter: 100, k: 2, verbose: false });
@@ -1041,6 +1044,47 @@ describe("Kmeans test", function () {
         })
     });
 
+    describe("Mini-batch and parallel init test", function () {
+        var X = new la.Matrix([[1, 1.1, 0.9, -5, -5.2, -4.8, 1, 1.2], [1, 0.8, 1.1, -5, -4.9, -5.1, 1.1, 0.9]]);
+        it("should set and return the batch parameters", function () {
+            var KMeans = new analytics.KMeans({ k: 2, batchSize: 4, init: "kmeans||", threads: 2 });
+            var params = KMeans.getParams();
+            assert.equal(params.batchSize, 4);
+            assert.equal(params.init, "kmeans||");
+            assert.equal(params.threads, 2);
+        });
+        it("should throw for an unknown init method", function () {
+            assert.throws(function () {
+                var KMeans = new analytics.KMeans({ k: 2, init: "foo" });
+            });
+        });
+        it("should fit with mini-batches, dense matrix", function () {
+            var KMeans = new analytics.KMeans({ k: 2, batchSize: 4, iter: 100, init: "kmeans||" });
+            KMeans.fit(X);
+            var model = KMeans.getModel();
+            assert.equal(model.C.rows, 2);
+            assert.equal(model.C.cols, 2);
+            assert.equal(model.idxv.length, 8);
+            assert.equal(model.idxv[0], model.idxv[1]);
+            assert.equal(model.idxv[3], model.idxv[4]);
+            assert.notEqual(model.idxv[0], model.idxv[3]);
+        });
+        it("should fit with mini-batches, sparse matrix", function () {
+            var KMeans = new analytics.KMeans({ k: 2, batchSize: 4, iter: 100, centroidType: "Sparse" });
+            KMeans.fit(X.sparse());
+            var model = KMeans.getModel();
+            assert.equal(model.C.cols, 2);
+            assert.equal(model.idxv.length, 8);
+        });
+        it("should separate the clusters with kmeans|| init", function () {
+            var KMeans = new analytics.KMeans({ k: 2, init: "kmeans||" });
+            KMeans.fit(X);
+            var idxv = KMeans.getModel().idxv;
+            assert.equal(idxv[0], idxv[7]);
+            assert.notEqual(idxv[0], idxv[5]);
+        });
+    });
+
     describe('Serialization Tests', function () {
         it('should serialize and deserialize', function () {
             var KMeans = new analytics.KMeans({ k: 3 });
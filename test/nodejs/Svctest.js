@@ -93,6 +93,11 @@ describe("SVC test", function () {
             assert.equal(SVCjSon.maxTime, 1);
             assert.eqtol(SVCjSon.minDiff, 1e-6);
             assert.equal(SVCjSon.verbose, false);
+            assert.equal(SVCjSon.threads, 1);
+            assert.equal(SVCjSon.hogwild, false);
+            assert.equal(SVCjSon.shrinking, false);
+            assert.equal(SVCjSon.validationFraction, 0);
+            assert.equal(SVCjSon.validationPatience, 5);
         })
 
         it("should return the parameters of the default SVC model as Json, without some key values", function () {
@@ -275,6 +280,109 @@ describe("SVC test", function () {
         })
     });
 
+    describe('Parallel Fit Tests', function () {
+        var matrix = new la.Matrix([[0, 1, -1, 0, 2, -2], [1, 0, 0, -1, 1, -1]]);
+        var vec = new la.Vector([1, 1, -1, -1, 1, -1]);
+        it('should create the same model for any number of threads', function () {
+            var SVC1 = new analytics.SVC({ threads: 1, shrinking: true });
+            var SVC3 = new analytics.SVC({ threads: 3, shrinking: true });
+            SVC1.fit(matrix, vec);
+            SVC3.fit(matrix, vec);
+            assert.eqtol(SVC1.weights.minus(SVC3.weights).norm(), 0, 1e-12);
+            assert.equal(SVC1.predict(new la.Vector([2, 2])), 1);
+            assert.equal(SVC1.predict(new la.Vector([-2, -2])), -1);
+        })
+        it('should create a model with hogwild updates on a sparse matrix', function () {
+            var SVC = new analytics.SVC({ threads: 2, hogwild: true });
+            SVC.fit(matrix.sparse(), vec);
+            assert.equal(SVC.predict(new la.Vector([2, 2])), 1);
+            assert.equal(SVC.predict(new la.Vector([-2, -2])), -1);
+        })
+        it('should create a model with early stopping', function () {
+            var SVC = new analytics.SVC({ threads: 2, validationFraction: 0.3, validationPatience: 2 });
+            SVC.fit(matrix, vec);
+            assert.equal(SVC.weights.length, 2);
+        })
+        it('should throw an exception for an invalid validation fraction', function () {
+            assert.throws(function () {
+                var SVC = new analytics.SVC({ validationFraction: 1 });
+            });
+        })
+        it('should fit the model asynchronously', function (done) {
+            var SVC = new analytics.SVC({ threads: 2 });
+            SVC.fitAsync(matrix, vec, function (err) {
+                if (err) { return done(err); }
+                try {
+                    assert.equal(SVC.predict(new la.Vector([2, 2])), 1);
+                    done();
+                } catch (e) {
+                    done(e);
+                }
+            });
+        })
+        it('should return an error asynchronously for an unknown algorithm', function (done) {
+            var SVC = new analytics.SVC({ algorithm: 'foo' });
+            SVC.fitAsync(matrix, vec, function (err) {
+                assert.ok(err != null);
+                done();
+            });
+        })
+    });
+
+    describe('Record Set Fit Tests', function () {
+        var qm = require('qminer');
+        var base = undefined;
+        var ftrSpace = undefined;
+        var points = [[0, 1], [1, 0], [-1, 0], [0, -1], [2, 1], [-2, -1]];
+        var vec = new la.Vector([1, 1, -1, -1, 1, -1]);
+        beforeEach(function () {
+            base = new qm.Base({
+                mode: 'createClean',
+                schema: [{
+                    name: 'Points',
+                    fields: [{ name: 'X', type: 'float' }, { name: 'Y', type: 'float' }]
+                }]
+            });
+            for (var i = 0; i < points.length; i++) {
+                base.store('Points').push({ X: points[i][0], Y: points[i][1] });
+            }
+            ftrSpace = new qm.FeatureSpace(base, [
+                { type: 'numeric', source: 'Points', field: 'X' },
+                { type: 'numeric', source: 'Points', field: 'Y' }
+            ]);
+        });
+        afterEach(function () {
+            base.close();
+        });
+
+        it('should create the same model as when fitting the feature matrix', function () {
+            var recSet = base.store('Points').allRecords;
+            var SVC1 = new analytics.SVC();
+            var SVC2 = new analytics.SVC();
+            SVC1.fit(ftrSpace.extractMatrix(recSet), vec);
+            SVC2.fit(recSet, ftrSpace, vec);
+            assert.eqtol(SVC1.weights.minus(SVC2.weights).norm(), 0, 1e-8);
+        })
+        it('should fit a record set asynchronously', function (done) {
+            var SVC = new analytics.SVC({ threads: 2 });
+            SVC.fitAsync(base.store('Points').allRecords, ftrSpace, vec, function (err) {
+                if (err) { return done(err); }
+                try {
+                    assert.equal(SVC.predict(new la.Vector([2, 2])), 1);
+                    done();
+                } catch (e) {
+                    done(e);
+                }
+            });
+        })
+        it('should throw an exception if the feature space is missing', function () {
+            var SVC = new analytics.SVC();
+            assert.throws(function () {
+                SVC.fit(base.store('Points').allRecords, vec);
+            });
+        })
+    });
+
     describe('Predict Tests', function () {
         it('should not throw an exception', function () {
             var matrix = new la.Matrix([[1, -1], [0, 0]]);
@@ -87,6 +87,11 @@ describe("SVR test", function () {
             assert.equal(SVRjSon.maxTime, 1);
             assert.eqtol(SVRjSon.minDiff, 1e-6);
             assert.equal(SVRjSon.verbose, false);
+            assert.equal(SVRjSon.threads, 1);
+            assert.equal(SVRjSon.hogwild, false);
+            assert.equal(SVRjSon.shrinking, false);
+            assert.equal(SVRjSon.validationFraction, 0);
+            assert.equal(SVRjSon.validationPatience, 5);
         })
 
         it("should return the parameters of the default SVR model as Json, without some key values", function () {
@@ -266,6 +271,30 @@ describe("SVR test", function () {
             assert.eqtol(weights[1], 1, 1e-1);
         })
     });
+    describe('Parallel Fit Tests', function () {
+        var matrix = new la.Matrix([[1, 0, -1, 0, 2], [0, 1, 0, -1, 1]]);
+        var vec = new la.Vector([1, 1, -1, -1, 3]);
+        it('should create the same model for any number of threads', function () {
+            var SVR1 = new analytics.SVR({ threads: 1, shrinking: true });
+            var SVR4 = new analytics.SVR({ threads: 4, shrinking: true });
+            SVR1.fit(matrix, vec);
+            SVR4.fit(matrix.sparse(), vec);
+            assert.eqtol(SVR1.weights.minus(SVR4.weights).norm(), 0, 1e-12);
+        })
+        it('should fit the model asynchronously', function (done) {
+            var SVR = new analytics.SVR({ threads: 2, hogwild: true });
+            SVR.fitAsync(matrix, vec, function (err) {
+                if (err) { return done(err); }
+                try {
+                    assert.equal(SVR.weights.length, 2);
+                    done();
+                } catch (e) {
+                    done(e);
+                }
+            });
+        })
+    });
+
     describe('Predict Tests', function () {
         it('should not throw an exception for giving the correct values', function () {
             var matrix = new la.Matrix([[1, -1], [1, 1]]);
@@ -373,6 +402,42 @@ describe("SVR test", function () {
             });
         })
     });
+    describe('Record Set Fit Tests', function () {
+        var qm = require('qminer');
+        var base = undefined;
+        var ftrSpace = undefined;
+        var points = [[0, 1], [1, 0], [-1, 0], [0, -1], [2, 1], [-2, -1]];
+        var vec = new la.Vector([1, 1, -1, -1, 3, -3]);
+        beforeEach(function () {
+            base = new qm.Base({
+                mode: 'createClean',
+                schema: [{
+                    name: 'Points',
+                    fields: [{ name: 'X', type: 'float' }, { name: 'Y', type: 'float' }]
+                }]
+            });
+            for (var i = 0; i < points.length; i++) {
+                base.store('Points').push({ X: points[i][0], Y: points[i][1] });
+            }
+            ftrSpace = new qm.FeatureSpace(base, [
+                { type: 'numeric', source: 'Points', field: 'X' },
+                { type: 'numeric', source: 'Points', field: 'Y' }
+            ]);
+        });
+        afterEach(function () {
+            base.close();
+        });
+
+        it('should create the same model as when fitting the feature matrix', function () {
+            var recSet = base.store('Points').allRecords;
+            var SVR1 = new analytics.SVR({ c: 10 });
+            var SVR2 = new analytics.SVR({ c: 10 });
+            SVR1.fit(ftrSpace.extractMatrix(recSet), vec);
+            SVR2.fit(recSet, ftrSpace, vec);
+            assert.eqtol(SVR1.weights.minus(SVR2.weights).norm(), 0, 1e-8);
+            assert.eqtol(SVR1.predict(new la.Vector([2, 2])), SVR2.predict(new la.Vector([2, 2])), 1e-8);
+        })
+    });
     describe('DecisionFunction Tests', function () {
         it('should not return an exception for the given correct values', function () {
             var matrix = new la.Matrix([[1, -1], [1, 1]]);
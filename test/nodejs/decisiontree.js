@@ -0,0 +1,129 @@
+var assert = require('../../src/nodejs/scripts/assert.js');
+var qm = require('qminer');
+var analytics = qm.analytics;
+var la = qm.la;
+var fs = qm.fs;
+
+// instances on a grid, the class is 1 when x0 > x1
+function getData(n) {
+    var X = new la.Matrix({ rows: 2, cols: n * n });
+    var y = new la.Vector();
+    for (var i = 0; i < n; i++) {
+        for (var j = 0; j < n; j++) {
+            var col = i * n + j;
+            X.put(0, col, i);
+            X.put(1, col, j);
+            y.push(i > j ? 1 : 0);
+        }
+    }
+    return { X: X, y: y };
+}
+
+function accuracy(tree, data) {
+    var pred = tree.predict(data.X);
+    var correct = 0;
+    for (var i = 0; i < data.y.length; i++) {
+        if ((pred[i] > 0.5 ? 1 : 0) == data.y[i]) { correct++; }
+    }
+    return correct / data.y.length;
+}
+
+describe('Decision Tree Tests', function () {
+
+    describe('Constructor Tests', function () {
+        it('should create a tree with the default parameters', function () {
+            var tree = new analytics.DecisionTree();
+            var param = tree.getParams();
+            assert.equal(param.splitCriteria, 'infoGain');
+            assert.equal(param.minExamples, 0);
+            assert.equal(param.minPosProb, 0);
+            assert.equal(param.minNegProb, 0);
+            assert.equal(param.calcCorr, false);
+            assert.equal(param.maxBins, 0);
+        })
+        it('should create a tree out of the given parameters', function () {
+            var tree = new analytics.DecisionTree({ splitCriteria: 'gainRatio', minExamples: 5, minClassProb: 0.1, maxBins: 64 });
+            var param = tree.getParams();
+            assert.equal(param.splitCriteria, 'gainRatio');
+            assert.equal(param.minExamples, 5);
+            assert.equal(param.minPosProb, 0.1);
+            assert.equal(param.minNegProb, 0.1);
+            assert.equal(param.maxBins, 64);
+        })
+        it('should throw an exception if the split criteria is unknown', function () {
+            assert.throws(function () {
+                var tree = new analytics.DecisionTree({ splitCriteria: 'gini' });
+            });
+        })
+        it('should throw an exception if there are too many bins', function () {
+            assert.throws(function () {
+                var tree = new analytics.DecisionTree({ maxBins: 1000 });
+            });
+        })
+    });
+
+    describe('SetParams Tests', function () {
+        it('should keep the parameters which are not given', function () {
+            var tree = new analytics.DecisionTree({ minExamples: 5 });
+            tree.setParams({ maxBins: 32 });
+            var param = tree.getParams();
+            assert.equal(param.minExamples, 5);
+            assert.equal(param.maxBins, 32);
+        })
+    });
+
+    describe('Fit Tests', function () {
+        it('should separate the classes with exact splits', function () {
+            var data = getData(20);
+            var tree = new analytics.DecisionTree();
+            tree.fit(data.X, data.y);
+            assert.equal(accuracy(tree, data), 1);
+        })
+        it('should separate the classes with histogram splits', function () {
+            var data = getData(20);
+            var tree = new analytics.DecisionTree({ maxBins: 256 });
+            tree.fit(data.X, data.y);
+            assert.equal(accuracy(tree, data), 1);
+        })
+        it('should cut between the values when each value has its own bin', function () {
+            var data = getData(10);
+            var exact = new analytics.DecisionTree();
+            var hist = new analytics.DecisionTree({ maxBins: 10 });
+            exact.fit(data.X, data.y);
+            hist.fit(data.X, data.y);
+            var model = hist.getModel();
+            assert.deepEqual(model.cut, exact.getModel().cut);
+            assert.equal(model.examples, 100);
+            assert.equal(model.children.length, 2);
+        })
+        it('should fit with fewer bins than values', function () {
+            var data = getData(30);
+            var tree = new analytics.DecisionTree({ maxBins: 8 });
+            tree.fit(data.X, data.y);
+            assert(accuracy(tree, data) > 0.8);
+        })
+        it('should predict a single vector', function () {
+            var data = getData(10);
+            var tree = new analytics.DecisionTree({ maxBins: 16 });
+            tree.fit(data.X, data.y);
+            assert.equal(tree.predict(new la.Vector([8, 1])), 1);
+            assert.equal(tree.predict(new la.Vector([1, 8])), 0);
+        })
+    });
+
+    describe('Save Tests', function () {
+        it('should save and load the tree', function () {
+            var data = getData(10);
+            var tree = new analytics.DecisionTree({ maxBins: 16 });
+            tree.fit(data.X, data.y);
+
+            var fout = fs.openWrite('decisiontree_test.bin');
+            tree.save(fout);
+            fout.close();
+
+            var tree2 = new analytics.DecisionTree(fs.openRead('decisiontree_test.bin'));
+            assert.deepEqual(tree2.getParams(), tree.getParams());
+            assert.deepEqual(tree2.getModel(), tree.getModel());
+        })
+    });
+});
@@ -1878,5 +1878,28 @@ describe('Feature Space Tests', function () {
             assert.eqtol(mat.at(0, 10), 2);
             assert.eqtol(mat.at(2, 10), 1);
         })
+        it('should return the same matrices when extracting on several threads', function () {
+            // records are processed in chunks, so we need a larger store to go parallel
+            for (var i = 0; i < 10000; i++) {
+                Store.push({ Value: i % 100, Category: ["a", "b", "c"][i % 3], Values: [i % 7, 1.0],
+                    Categories: ["a"], Date: "2014-10-20T00:11:22", Text: "" });
+            }
+            var ftr = new qm.FeatureSpace(base, [
+                { type: "numeric", source: "FtrSpaceTest", field: "Value", normalize: true },
+                { type: "categorical", source: "FtrSpaceTest", field: "Category", values: ["a", "b", "c"] }
+            ]);
+            var rs = Store.allRecords;
+            ftr.updateRecords(rs);
+
+            var mat = ftr.extractMatrix(rs);
+            var mat4 = ftr.extractMatrix(rs, -1, 4);
+            assert.equal(mat4.cols, rs.length);
+            assert.eqtol(mat.minus(mat4).frob(), 0);
+
+            var spMat = ftr.extractSparseMatrix(rs);
+            var spMat4 = ftr.extractSparseMatrix(rs, -1, 4);
+            assert.equal(spMat4.cols, rs.length);
+            assert.eqtol(spMat.minus(spMat4).frob(), 0);
+        })
     });
 })
@@ -125,6 +125,17 @@ describe('Logistic Regression Tests', function () {
                     logreg.fit(mat, vec);
                 });
             })
+            it('should converge to the same weights with a warm start', function () {
+                var mat = new la.Matrix([[1, 2, -1, 0, 3, -2], [1, -1, 2, 1, 0, -1]]);
+                var vec = new la.Vector([1, 1, 0, 1, 0, 0]);
+                var warm = new analytics.LogReg({ lambda: 1 });
+                warm.fit(mat, vec);
+                warm.setParams({ lambda: 0.5 });
+                warm.fit(mat, vec, 1e-8, true);
+                var cold = new analytics.LogReg({ lambda: 0.5 });
+                cold.fit(mat, vec, 1e-8);
+                assert.eqtol(warm.weights.minus(cold.weights).norm(), 0, 1e-5);
+            })
         });
 
         describe('Predict Tests', function () {
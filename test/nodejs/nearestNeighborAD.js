@@ -221,4 +221,30 @@ describe('NearestNeighborAD Tests', function () {
             assert.eqtol(model.threshold, 8);
         })
     });
+
+    describe('Approximate Index Tests', function () {
+        it('should return the index parameters', function () {
+            var neighbor = new analytics.NearestNeighborAD({ windowSize: 50, ann: { efSearch: 10 } });
+            var params = neighbor.getParams();
+            assert.equal(params.ann.efSearch, 10);
+            assert.equal(params.ann.M, 16);
+            assert.equal(params.ann.efConstruction, 100);
+            var exact = new analytics.NearestNeighborAD({ windowSize: 50 });
+            assert.equal(exact.getParams().ann, undefined);
+        })
+        it('should find the same nearest neighbors as the exact search', function () {
+            var exact = new analytics.NearestNeighborAD({ windowSize: 100 });
+            var approx = new analytics.NearestNeighborAD({ windowSize: 100, ann: { efSearch: 20 } });
+            // points on a grid, the window keeps the last 100 of them
+            for (var i = 0; i < 300; i++) {
+                var vec = new la.SparseVector([[0, i % 17], [1, Math.floor(i / 17)]]);
+                exact.partialFit(vec);
+                approx.partialFit(vec);
+            }
+            assert.eqtol(approx.getModel().threshold, exact.getModel().threshold);
+            var test = new la.SparseVector([[0, 3.2], [1, 14.9]]);
+            assert.eqtol(approx.decisionFunction(test), exact.decisionFunction(test));
+            assert.equal(approx.predict(test), exact.predict(test));
+        })
+    });
 });
@@ -80,6 +80,21 @@ describe('NNet Tests', function () {
             assert.equal(params.tFuncHidden, "sigmoid");
             assert.equal(params.tFuncOut, "tanHyper");
         })
+        it('should give the optimizer and batch size parameters', function () {
+            var nnet = new analytics.NNet({ layout: [2, 3, 1], tFuncHidden: "relu", optimizer: "adam", batchSize: 2 });
+            var params = nnet.getParams();
+            assert.equal(params.tFuncHidden, "relu");
+            assert.equal(params.optimizer, "adam");
+            assert.equal(params.batchSize, 2);
+            var nnet2 = new analytics.NNet();
+            assert.equal(nnet2.getParams().optimizer, "sgd");
+            assert.equal(nnet2.getParams().batchSize, 0);
+        })
+        it('should throw an exception if the optimizer is unknown', function () {
+            assert.throws(function () {
+                var nnet = new analytics.NNet({ optimizer: "rmsprop" });
+            });
+        })
     });
 
     describe('SetParams Tests', function () {
@@ -101,6 +116,13 @@ describe('NNet Tests', function () {
             assert.equal(params.tFuncHidden, "sigmoid");
             assert.equal(params.tFuncOut, "tanHyper");
         })
+        it('should change the optimizer and batch size', function () {
+            var nnet = new analytics.NNet();
+            nnet.setParams({ optimizer: "adam", batchSize: 16 });
+            var params = nnet.getParams();
+            assert.equal(params.optimizer, "adam");
+            assert.equal(params.batchSize, 16);
+        })
         it('should throw an exception if no parameter is given', function () {
             var nnet = new analytics.NNet();
             assert.throws(function () {
@@ -229,6 +251,32 @@ describe('NNet Tests', function () {
             var prediction = nnet.predict(test);
             assert(prediction > 0);
         })
+        it('should return the predictions of the matrix columns', function () {
+            var nnet = new analytics.NNet({ layout: [2, 3, 1] });
+            var matIn = new la.Matrix([[1, 0, 2], [0, 1, 1]]);
+            var matOut = new la.Matrix([[1, -1, 0.5]]);
+            nnet.fit(matIn, matOut);
+            var predictions = nnet.predict(matIn);
+            assert.equal(predictions.rows, 1);
+            assert.equal(predictions.cols, 3);
+            for (var i = 0; i < 3; i++) {
+                var prediction = nnet.predict(matIn.getCol(i));
+                assert.equal(predictions.at(0, i), prediction[0]);
+            }
+        })
+        it('should learn XOR with adam and mini batches', function () {
+            var nnet = new analytics.NNet({ layout: [2, 4, 1], learnRate: 0.05, tFuncHidden: "tanHyper",
+                tFuncOut: "sigmoid", optimizer: "adam", batchSize: 2 });
+            var matIn = new la.Matrix([[0, 0, 1, 1], [0, 1, 0, 1]]);
+            var matOut = new la.Matrix([[0, 1, 1, 0]]);
+            for (var epoch = 0; epoch < 2000; epoch++) {
+                nnet.fit(matIn, matOut);
+            }
+            var predictions = nnet.predict(matIn);
+            for (var i = 0; i < 4; i++) {
+                assert(Math.abs(predictions.at(0, i) - matOut.at(0, i)) < 0.2);
+            }
+        })
         it('should throw an exception if the given vector length is greater than of the models', function () {
             var nnet = new analytics.NNet();
             var vecIn = new la.Vector([10]);
@@ -32,15 +32,16 @@ describe('Query-aggregates tests ', function () {
             "fields": [
                 { "name": "title", "type": "string", "store" : "cache" },
                 { "name": "src", "type": "string", "store" : "cache" },
-                { "name": "ts", "type": "datetime", "store": "cache" }
+                { "name": "ts", "type": "datetime", "store": "cache" },
+                { "name": "val", "type": "float", "store": "cache" }
             ]
         });
         store = base.store(store_name);
         
-        store.push({title: "title1", src: "src1", ts: now});
-        store.push({title: "title2", src: "src1", ts: now + 2 * 60 * 1000 });
-        store.push({title: "title3", src: "src2", ts: now + 7 * 60 * 1000 });
-        store.push({title: "title4", src: "src3", ts: now + 14 * 60 * 1000 });
+        store.push({title: "title1", src: "src1", ts: now, val: 1 });
+        store.push({title: "title2", src: "src1", ts: now + 2 * 60 * 1000, val: 2 });
+        store.push({title: "title3", src: "src2", ts: now + 7 * 60 * 1000, val: 3 });
+        store.push({title: "title4", src: "src3", ts: now + 14 * 60 * 1000, val: 4 });
     });
     afterEach(function () {
         base.close();
@@ -93,4 +94,133 @@ describe('Query-aggregates tests ', function () {
             assert.equal(aggr2.slots[2].slot, slot2);
         }
     })
-})
\ No newline at end of file
+
+    //////////////////
+    it('should give same results when aggregates are computed on several threads', function () {
+
+        var rs = base.search({ $from : store_name });
+        var aggrs = [
+            { type: "count", field: "src", name: "aggr_src" },
+            { type: "count", field: "title", name: "aggr_title" },
+            { type: "timespan", field: "ts", name: "aggr_ts", slot_length: 5 * 60 * 1000 }
+        ];
+        var aggrs1 = rs.aggr(aggrs);
+        aggrs[0].threads = 3;
+        var aggrs3 = rs.aggr(aggrs);
+
+        assert.equal(aggrs3.length, 3);
+        for (var i = 0; i < aggrs1[0].values.length; i++) {
+            assert.equal(aggrs3[0].values[i].value, aggrs1[0].values[i].value);
+            assert.equal(aggrs3[0].values[i].frequency, aggrs1[0].values[i].frequency);
+        }
+        assert.equal(aggrs3[1].values.length, 4);
+        assert.equal(aggrs3[2].slots.length, 3);
+        for (var i = 0; i < aggrs1[2].slots.length; i++) {
+            assert.equal(aggrs3[2].slots[i].slot, aggrs1[2].slots[i].slot);
+            assert.equal(aggrs3[2].slots[i].count, aggrs1[2].slots[i].count);
+        }
+    })
+
+    //////////////////
+    it('should execute approximate aggregates', function () {
+
+        var rs = base.search({ $from : store_name });
+        var aggrs = rs.aggr([
+            { type: "distinct", field: "src", name: "aggr_distinct" },
+            { type: "topk", field: "src", name: "aggr_topk", k: 2 },
+            { type: "quantiles", field: "val", name: "aggr_quantiles", quantiles: [0, 0.5, 1] }
+        ]);
+        assert.equal(aggrs.length, 3);
+        {
+            var aggr0 = aggrs[0];
+            assert.equal(aggr0.type, "distinct");
+            assert.equal(aggr0.count, 4);
+            assert.equal(aggr0.distinct, 3);
+            assert(aggr0.relErr > 0);
+        }
+        {
+            var aggr1 = aggrs[1];
+            assert.equal(aggr1.type, "topk");
+            assert.equal(aggr1.count, 4);
+            assert.equal(aggr1.values.length, 2);
+            assert.equal(aggr1.values[0].value, "src1");
+            assert.equal(aggr1.values[0].frequency, 2);
+            assert.equal(aggr1.values[1].frequency, 1);
+        }
+        {
+            var aggr2 = aggrs[2];
+            assert.equal(aggr2.type, "quantiles");
+            assert.equal(aggr2.count, 4);
+            assert.equal(aggr2.min, 1);
+            assert.equal(aggr2.max, 4);
+            assert.equal(aggr2.quantiles.length, 3);
+            assert.equal(aggr2.quantiles[0].value, 1);
+            assert(1 <= aggr2.quantiles[1].value && aggr2.quantiles[1].value <= 4);
+            assert.equal(aggr2.quantiles[2].value, 4);
+        }
+    })
+
+    //////////////////
+    it('should execute exact histogram', function () {
+
+        var histogram = { type: "histogram", field: "val", name: "aggr_hist", buckets: 3 };
+        // even number of values: 1, 2, 3, 4
+        var aggr0 = base.search({ $from : store_name }).aggr([histogram])[0];
+        assert.equal(aggr0.type, "histogram");
+        assert.equal(aggr0.count, 4);
+        assert.equal(aggr0.median, 2.5);
+        assert.equal(aggr0.values.length, 3);
+        assert.deepEqual(aggr0.values.map(function (bucket) { return bucket.frequency; }), [2, 1, 1]);
+        // odd number of values: 1, 2, 3, 4, 4
+        store.push({title: "title5", src: "src3", ts: now + 15 * 60 * 1000, val: 4 });
+        var aggr1 = base.search({ $from : store_name }).aggr([histogram])[0];
+        assert.equal(aggr1.count, 5);
+        assert.equal(aggr1.median, 3);
+        assert.deepEqual(aggr1.values.map(function (bucket) { return bucket.frequency; }), [2, 1, 2]);
+        // binned histogram keeps only the bucket counts
+        var aggr2 = base.search({ $from : store_name }).aggr([
+            { type: "histogram", field: "val", name: "aggr_hist", buckets: 3, binned: true }
+        ])[0];
+        assert.equal(aggr2.count, 5);
+        assert.equal(aggr2.values.length, 3);
+        assert.equal(aggr2.values.reduce(function (sum, bucket) { return sum + bucket.frequency; }, 0), 5);
+        assert(1 <= aggr2.median && aggr2.median <= 4);
+    })
+
+    //////////////////
+    it('should execute group-by', function () {
+
+        var rs = base.search({ $from : store_name });
+        var aggrs = rs.aggr([
+            { type: "groupby", name: "aggr_src", keys: ["src"],
+                values: [{ field: "val", aggr: "sum" }, { aggr: "count" }] },
+            { type: "groupby", name: "aggr_src_sort", keys: ["src"], strategy: "sort",
+                values: [{ field: "val", aggr: "sum" }, { aggr: "count" }] },
+            { type: "groupby", name: "aggr_ts", keys: [{ field: "ts", bucket: 5 * 60 * 1000 }],
+                values: [{ field: "val", aggr: "max", name: "max" }] }
+        ]);
+        assert.equal(aggrs.length, 3);
+        {
+            var aggr0 = aggrs[0];
+            assert.equal(aggr0.type, "groupby");
+            assert.equal(aggr0.groups, 3);
+            assert.deepEqual(aggr0.columns, ["src", "val_sum", "count"]);
+            assert.deepEqual(aggr0.rows[0], ["src1", 3, 2]);
+            assert.deepEqual(aggr0.rows[1], ["src2", 3, 1]);
+            assert.deepEqual(aggr0.rows[2], ["src3", 4, 1]);
+        }
+        {
+            var aggr1 = aggrs[1];
+            assert.deepEqual(aggr1.columns, aggrs[0].columns);
+            assert.deepEqual(aggr1.rows, aggrs[0].rows);
+        }
+        {
+            var aggr2 = aggrs[2];
+            assert.deepEqual(aggr2.columns, ["ts", "max"]);
+            assert.equal(aggr2.rows.length, 3);
+            assert.deepEqual(aggr2.rows[0], [slot0, 2]);
+            assert.deepEqual(aggr2.rows[1], [slot1, 3]);
+            assert.deepEqual(aggr2.rows[2], [slot2, 4]);
+        }
+    })
+})
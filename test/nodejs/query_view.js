@@ -0,0 +1,98 @@
+/**
+ * Copyright (c) 2015, Jozef Stefan Institute, Quintelligence d.o.o. and contributors
+ * All rights reserved.
+ *
+ * This source code is licensed under the FreeBSD license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// console.log(__filename)
+var assert = require('../../src/nodejs/scripts/assert.js'); //adds assert.run function
+var qm = require('qminer');
+
+describe('Materialized query view tests', function () {
+    var base = undefined;
+    var store = undefined;
+
+    var queries = {
+        src: { $from: 'ViewTest', Src: 'src3' },
+        range: { $from: 'ViewTest', Value: { $gt: 10, $lt: 40 } },
+        or: { $from: 'ViewTest', $or: [{ Src: 'src1' }, { Value: { $gt: 90 } }] },
+        not: { $from: 'ViewTest', $not: { Src: 'src2' } },
+        unknown: { $from: 'ViewTest', Src: 'src8' }
+    };
+
+    function push(n, mod) {
+        for (var i = 0; i < n; i++) {
+            store.push({ Src: 'src' + (i % mod), Value: (i * 37) % 100 });
+        }
+    }
+
+    function check() {
+        for (var name in queries) {
+            var expected = base.search(queries[name]);
+            var view = base.view(name);
+            assert.equal(view.length, expected.length);
+            for (var i = 0; i < expected.length; i++) {
+                assert.equal(view[i].$id, expected[i].$id);
+            }
+        }
+    }
+
+    beforeEach(function () {
+        qm.delLock();
+        base = new qm.Base({ mode: 'createClean' });
+        base.createStore({
+            'name': 'ViewTest',
+            'fields': [
+              { 'name': 'Src', 'type': 'string' },
+              { 'name': 'Value', 'type': 'int' }
+            ],
+            'joins': [],
+            'keys': [
+                { field: 'Src', type: 'value' },
+                { field: 'Value', type: 'linear' }
+            ]
+        });
+        store = base.store('ViewTest');
+        push(10, 7);
+        for (var name in queries) {
+            base.createView(name, queries[name]);
+        }
+    });
+    afterEach(function () {
+        base.close();
+    });
+
+    it('should match search results after adding records', function () {
+        assert.deepEqual(base.getViewNames().sort(), Object.keys(queries).sort());
+        check();
+        push(1000, 9);
+        check();
+    })
+
+    it('should match search results after deleting records', function () {
+        push(1000, 9);
+        store.clear(300);
+        check();
+    })
+
+    it('should be kept after reopening the base', function () {
+        push(500, 9);
+        base.close();
+        base = new qm.Base({ mode: 'open' });
+        store = base.store('ViewTest');
+        check();
+        push(500, 9);
+        check();
+    })
+
+    it('should delete view', function () {
+        base.deleteView('src');
+        assert.equal(base.view('src'), null);
+        assert.equal(base.getViewNames().length, Object.keys(queries).length - 1);
+        assert.throws(function () {
+            base.deleteView('src');
+        });
+    })
+});
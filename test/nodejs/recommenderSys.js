@@ -27,6 +27,8 @@ describe("RecommenderSys tests", function () {
             assert.equal(params.tol, 1e-3);
             assert.equal(params.k, 2);
             assert.equal(params.verbose, false);
+            assert.equal(params.algorithm, 'cfo');
+            assert.eqtol(params.lambda, 0.01);
         })
         it("should create the object with the given parameters", function () {
             var recSys = new analytics.RecommenderSys({ iter: 100, tol: 1e-3, k: 20, verbose: true });
@@ -148,6 +150,54 @@ describe("RecommenderSys tests", function () {
         })
     });
 
+    describe("ALS tests", function () {
+        var mat = new la.Matrix([[1, 0.5, 0, 1], [0, 3, 0, 0], [0, 0.5, 0, 3], [0, 0, 0.4, 1]]);
+        it("should throw an exception if the algorithm is unknown", function () {
+            assert.throws(function () {
+                var recSys = new analytics.RecommenderSys({ algorithm: 'sgd' });
+            });
+        })
+        it("should fit the model, dense matrix", function () {
+            var recSys = new analytics.RecommenderSys({ algorithm: 'als', iter: 50 });
+            recSys.fit(mat);
+            var model = recSys.getModel();
+            assert.equal(model.U.rows, 4);
+            assert.equal(model.U.cols, 2);
+            assert.equal(model.V.rows, 2);
+            assert.equal(model.V.cols, 4);
+            assert(model.loss.length > 0 && model.loss.length <= 50);
+            for (var i = 1; i < model.loss.length; i++) {
+                assert(model.loss[i] <= model.loss[i - 1] + 1e-12);
+            }
+        })
+        it("should approximate the observed ratings, sparse matrix", function () {
+            var recSys = new analytics.RecommenderSys({ algorithm: 'als', iter: 200, tol: 1e-8 });
+            var spMat = new la.SparseMatrix([[[0, 1]], [[0, 0.5], [1, 3], [2, 0.5]], [[3, 0.4]], [[0, 1], [2, 3], [3, 1]]]);
+            recSys.fit(spMat);
+            var model = recSys.getModel();
+            // the observed ratings are approximated well
+            var approx = model.U.multiply(model.V);
+            assert.eqtol(approx.at(1, 1), 3, 0.1);
+            assert.eqtol(approx.at(2, 3), 3, 0.1);
+            assert.equal(model.U.rows, 4);
+        })
+        it("should fit the model asynchronously", function (done) {
+            var recSys = new analytics.RecommenderSys({ algorithm: 'als', iter: 50 });
+            recSys.fitAsync(mat, function (err) {
+                if (err) { done(err); return; }
+                assert.equal(recSys.getModel().V.cols, 4);
+                done();
+            });
+        })
+        it("should clear the loss when fitting with cfo", function () {
+            var recSys = new analytics.RecommenderSys({ algorithm: 'als', iter: 50 });
+            recSys.fit(mat);
+            recSys.setParams({ algorithm: 'cfo', iter: 100 });
+            recSys.fit(mat);
+            assert.equal(recSys.getModel().loss.length, 0);
+        })
+    });
+
     describe("GetModel tests", function () {
         it("should not throw an exception", function () {
             var recSys = new analytics.RecommenderSys();
@@ -206,6 +256,8 @@ describe("RecommenderSys tests", function () {
             assert.equal(params.k, params2.k);
             assert.equal(params.tol, params2.tol);
             assert.equal(params.verbose, params2.verbose);
+            assert.equal(params.algorithm, params2.algorithm);
+            assert.equal(params.lambda, params2.lambda);
             assert.eqtol(model.U.minus(model2.U).frob(), 0);
             assert.eqtol(model.V.minus(model2.V).frob(), 0);
         });
@@ -255,6 +255,73 @@ describe('Ridge Regression Tests', function () {
             });
         })
     });
+    describe('Record Set Fit Tests', function () {
+        var qm = require('qminer');
+        var base = undefined;
+        beforeEach(function () {
+            base = new qm.Base({
+                mode: 'createClean',
+                schema: [{
+                    name: 'Points',
+                    fields: [{ name: 'X', type: 'float' }, { name: 'Y', type: 'float' }]
+                }]
+            });
+            base.store('Points').push({ X: 1, Y: 1 });
+            base.store('Points').push({ X: 2, Y: -1 });
+        });
+        afterEach(function () {
+            base.close();
+        });
+        it('should fit the model on a record set and a feature space', function () {
+            var ftrSpace = new qm.FeatureSpace(base, [
+                { type: 'numeric', source: 'Points', field: 'X' },
+                { type: 'numeric', source: 'Points', field: 'Y' }
+            ]);
+            var RR = new analytics.RidgeReg();
+            RR.fit(base.store('Points').allRecords, ftrSpace, new la.Vector([3, 3]));
+            assert.eqtol(RR.weights[0], 2, 1e-8);
+            assert.eqtol(RR.weights[1], 1, 1e-8);
+        })
+        it('should fit the model on a record set with fewer records than features', function () {
+            var ftrSpace = new qm.FeatureSpace(base, [
+                { type: 'numeric', source: 'Points', field: 'X' },
+                { type: 'numeric', source: 'Points', field: 'Y' }
+            ]);
+            var recSet = base.store('Points').allRecords.trunc(1);
+            var RR1 = new analytics.RidgeReg();
+            var RR2 = new analytics.RidgeReg();
+            RR1.fit(ftrSpace.extractMatrix(recSet), new la.Vector([2]));
+            RR2.fit(recSet, ftrSpace, new la.Vector([2]));
+            assert.eqtol(RR2.weights[0], 1, 1e-8);
+            assert.eqtol(RR2.weights[1], 1, 1e-8);
+            assert.eqtol(RR1.weights.minus(RR2.weights).norm(), 0, 1e-8);
+        })
+    });
+    describe('Regularization Path Tests', function () {
+        var A = new la.Matrix([[1, 2, 0, 1, 3], [1, -1, 2, 0, 1], [0, 1, 1, 2, -1]]);
+        var b = new la.Vector([3, 3, 1, 2, 0]);
+        it('should return the same weights as separate fits', function () {
+            var gammas = [0.1, 1, 10];
+            var RR = new analytics.RidgeReg({ gamma: 1 });
+            RR.fit(A, b);
+            var W = RR.regularizationPath(gammas);
+            assert.equal(W.rows, 3);
+            assert.equal(W.cols, 3);
+            for (var i = 0; i < gammas.length; i++) {
+                var RR2 = new analytics.RidgeReg({ gamma: gammas[i] });
+                RR2.fit(A, b);
+                assert.eqtol(W.getCol(i).minus(RR2.weights).norm(), 0, 1e-8);
+            }
+        })
+        it('should refit the model when gamma is changed', function () {
+            var RR = new analytics.RidgeReg({ gamma: 1 });
+            RR.fit(A, b);
+            RR.setParams({ gamma: 5 });
+            var RR2 = new analytics.RidgeReg({ gamma: 5 });
+            RR2.fit(A, b);
+            assert.eqtol(RR.weights.minus(RR2.weights).norm(), 0, 1e-8);
+        })
+    });
     describe('Serialization Tests', function () {
         it('should serialize and deserialize', function () {
             var RR = new analytics.RidgeReg();
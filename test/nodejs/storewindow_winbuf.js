@@ -44,4 +44,51 @@ describe('Windowed store and window buffer', function () {
             });
         });
     });
-});
\ No newline at end of file
+});
+describe('Windowed store and cached window buffer', function () {
+    var base = undefined;
+    var store = undefined;
+    beforeEach(function () {
+        base = new qm.Base({
+            mode: 'createClean',
+            schema: [{
+                name: 'Function',
+                fields: [
+                    { name: 'Time', type: 'datetime' },
+                    { name: 'X', type: 'float' }
+                ],
+                window: 3
+            }]
+        });
+        store = base.store('Function');
+    });
+    afterEach(function () {
+        base.close();
+    });
+
+    it('should keep values of records removed from the store', function () {
+        var winX = store.addStreamAggr({
+            type: 'timeSeriesWinBuf',
+            timestamp: 'Time',
+            value: 'X',
+            winsize: 1000,
+            cache: true
+        });
+        var sum = store.addStreamAggr({ type: 'winBufSum', inAggr: winX.name });
+
+        store.push({ Time: '2015-06-10T14:13:32.001', X: 1 });
+        store.push({ Time: '2015-06-10T14:13:32.002', X: 2 });
+        store.push({ Time: '2015-06-10T14:13:32.003', X: 3 });
+        store.push({ Time: '2015-06-10T14:13:32.004', X: 4 });
+        base.garbageCollect();
+        assert.equal(store.length, 3);
+
+        assert.deepEqual(winX.getValueVector().toArray(), [1, 2, 3, 4]);
+        assert.equal(sum.getFloat(), 10);
+        // records fall out of the buffer without reading them from the store
+        store.push({ Time: '2015-06-10T14:13:33.003', X: 5 });
+        base.garbageCollect();
+        assert.deepEqual(winX.getValueVector().toArray(), [3, 4, 5]);
+        assert.equal(sum.getFloat(), 12);
+    });
+});
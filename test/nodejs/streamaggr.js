@@ -8,6 +8,9 @@
 
 var qm = require('qminer');
 var assert = require('../../src/nodejs/scripts/assert.js');
+var fs = require('fs');
+var os = require('os');
+var path = require('path');
 
 
 describe('Stream Aggregator Tests', function () {
@@ -3360,6 +3363,88 @@ describe('Resampler Tests', function () {
             assert.eqtol(out[2].Value, 17.5);
             assert.equal(out[2].Time.getTime(), new Date('2015-07-08T14:30:20.0').getTime());
         })
+        it('should interpolate the same in columnar mode', function () {
+            var aggr = {
+                name: 'ResAggr',
+                store: 'Function',
+                type: 'resampler',
+                outStore: 'outStore',
+                timestamp: 'Time',
+                fields: [{
+                    name: 'Value',
+                    interpolator: 'linear'
+                }],
+                createStore: false,
+                interval: 5 * 1000,
+                columnar: true
+            };
+            var res = store.addStreamAggr(aggr);
+            store.push({ Value: 10, Time: '2015-07-08T14:30:00.0' });
+            assert.equal(out.length, 1);
+            assert.eqtol(out[0].Value, 10);
+
+            store.push({ Value: 20, Time: '2015-07-08T14:30:20.0' });
+            assert.equal(out.length, 5);
+            for (var i = 1; i < 5; i++) {
+                assert.eqtol(out[i].Value, 10 + 2.5 * i);
+                assert.equal(out[i].Time.getTime(), new Date('2015-07-08T14:30:00.0').getTime() + i * 5000);
+            }
+        })
+        it('should load state saved before the columnar mode', function () {
+            var aggr = {
+                name: 'ResAggr',
+                store: 'Function',
+                type: 'resampler',
+                outStore: 'outStore',
+                timestamp: 'Time',
+                fields: [{
+                    name: 'Value',
+                    interpolator: 'linear'
+                }],
+                createStore: false,
+                interval: 10 * 1000
+            };
+            var res = store.addStreamAggr(aggr);
+            store.push({ Value: 10, Time: '2015-07-08T14:30:00.0' });
+            store.push({ Value: 15, Time: '2015-07-08T14:30:15.0' });
+            var fnm = path.join(os.tmpdir(), 'qm_resampler_state.bin');
+            var fout = qm.fs.openWrite(fnm);
+            res.save(fout);
+            fout.close();
+            // old layout has no format marker and no columnar state, which is the
+            // number of points, two timestamps and two empty vectors
+            var state = fs.readFileSync(fnm);
+            assert.equal(state.readInt32LE(0), -1);
+            fs.writeFileSync(fnm, state.slice(4, state.length - (4 + 2 * 8 + 2 * 8)));
+            var fin = qm.fs.openRead(fnm);
+            res.load(fin);
+            fin.close();
+            fs.unlinkSync(fnm);
+
+            store.push({ Value: 20, Time: '2015-07-08T14:30:25.0' });
+            assert.equal(out.length, 3);
+            assert.eqtol(out[2].Value, 17.5);
+            assert.equal(out[2].Time.getTime(), new Date('2015-07-08T14:30:20.0').getTime());
+        })
+        it('should throw an exception in columnar mode for an unsupported interpolator', function () {
+            var aggr = {
+                name: 'ResAggr',
+                store: 'Function',
+                type: 'resampler',
+                outStore: 'outStore',
+                timestamp: 'Time',
+                fields: [{
+                    name: 'Value',
+                    interpolator: 'next'
+                }],
+                createStore: false,
+                interval: 5 * 1000,
+                columnar: true
+            };
+            assert.throws(function () {
+                store.addStreamAggr(aggr);
+            });
+        })
     });
     describe('Property Tests', function () {
         it('should return the name of the resampler aggregator', function () {
@@ -3602,6 +3687,26 @@ describe('Merger Tests', function () {
                 base.store("Temperature").push({ Celcius: 28.3, Time: '2014-01-01T00:00:01.000' });
             });
         })
+        it('should report how far behind each input is', function () {
+            var aggr = {
+                name: 'MergerAggr',
+                type: 'merger',
+                outStore: 'Merged',
+                createStore: false,
+                timestamp: 'Time',
+                fields: [
+                    { source: 'Cars', inField: 'NumberOfCars', outField: 'NumberOfCars', interpolation: 'linear', timestamp: 'Time' },
+                    { source: 'Temperature', inField: 'Celcius', outField: 'Celcius', interpolation: 'linear', timestamp: 'Time' }
+                ]
+            };
+            var merger = new qm.StreamAggr(base, aggr);
+            base.store("Cars").push({ NumberOfCars: 5, Time: '2014-01-01T00:00:00.000' });
+            base.store("Temperature").push({ Celcius: 28.3, Time: '2014-01-01T00:00:01.000' });
+            base.store("Temperature").push({ Celcius: 29.7, Time: '2014-01-01T00:00:04.000' });
+            assert.deepEqual(merger.saveJson().lag, { NumberOfCars: 4000, Celcius: 0 });
+            base.store("Cars").push({ NumberOfCars: 15, Time: '2014-01-01T00:00:05.000' });
+            assert.deepEqual(merger.saveJson().lag, { NumberOfCars: 0, Celcius: 1000 });
+        })
     });
 });
 
@@ -4503,3 +4608,403 @@ describe('Stream aggregate set tests', function () {
     });
     
 });
+
+describe('Stream aggregate batching tests', function () {
+    var base = undefined;
+    var store = undefined;
+    var aggrs = undefined;
+    var time = new Date('2015-06-10T14:13:45.0').getTime();
+
+    function createBase() {
+        base = new qm.Base({
+            mode: "createClean",
+            schema: [
+            {
+                name: "Test",
+                fields: [
+                    { "name": "Value", "type": "float" },
+                    { "name": "Date", "type": "datetime" }
+                ]
+            }]
+        });
+        store = base.store('Test');
+        aggrs = {
+            tick: store.addStreamAggr({ type: "timeSeriesTick", store: "Test", timestamp: "Date", value: "Value" }),
+            winbuf: store.addStreamAggr({ type: "timeSeriesWinBuf", store: "Test", timestamp: "Date", value: "Value", winsize: 5000 })
+        };
+        aggrs.ema = store.addStreamAggr({ type: "ema", inAggr: aggrs.tick.name, emaType: "previous", interval: 3000, initWindow: 0 });
+        aggrs.sum = store.addStreamAggr({ type: "winBufSum", inAggr: aggrs.winbuf.name });
+        aggrs.max = store.addStreamAggr({ type: "winBufMax", inAggr: aggrs.winbuf.name });
+    }
+
+    function push(from, to) {
+        for (var i = from; i < to; i++) {
+            store.push({ Value: (i * 37) % 100, Date: new Date(time + i * 700).toISOString() });
+        }
+    }
+
+    beforeEach(function () {
+        createBase();
+    });
+    afterEach(function () {
+        base.close();
+    });
+
+    it('should give the same results as per-record updates', function () {
+        push(0, 20);
+        var expected = { ema: aggrs.ema.getFloat(), sum: aggrs.sum.getFloat(), max: aggrs.max.getFloat() };
+        // start again with batches
+        base.close();
+        createBase();
+        store.setStreamAggrBatchSize(3);
+        push(0, 17);
+        // only full batches reached the aggregates so far
+        assert.equal(aggrs.sum.getTimestamp() - 11644473600000, time + 14 * 700);
+        push(17, 20);
+        base.flushStreamAggrs();
+        assert.equal(aggrs.sum.getTimestamp() - 11644473600000, time + 19 * 700);
+        assert.equal(aggrs.sum.getFloat(), expected.sum);
+        assert.equal(aggrs.max.getFloat(), expected.max);
+        assert.equal(aggrs.ema.getFloat(), expected.ema);
+    });
+
+    it('should flush pending records before changing batch size', function () {
+        store.setStreamAggrBatchSize(100);
+        push(0, 5);
+        assert.equal(aggrs.tick.init, false);
+        store.setStreamAggrBatchSize(1);
+        assert.equal(aggrs.tick.getFloat(), (4 * 37) % 100);
+        assert.throws(function () { store.setStreamAggrBatchSize(0); });
+    });
+});
+
+describe('Stream aggregate parallel update tests', function () {
+    var base = undefined;
+    var store = undefined;
+    var aggrs = undefined;
+    var time = new Date('2015-06-10T14:13:45.0').getTime();
+
+    function createBase(threads) {
+        base = new qm.Base({
+            mode: "createClean",
+            schema: [
+            {
+                name: "Test",
+                fields: [
+                    { "name": "Value", "type": "float" },
+                    { "name": "Date", "type": "datetime" }
+                ]
+            }]
+        });
+        store = base.store('Test');
+        aggrs = {
+            tick: store.addStreamAggr({ type: "timeSeriesTick", store: "Test", timestamp: "Date", value: "Value" }),
+            winbuf1: store.addStreamAggr({ type: "timeSeriesWinBuf", store: "Test", timestamp: "Date", value: "Value", winsize: 5000 }),
+            winbuf2: store.addStreamAggr({ type: "timeSeriesWinBuf", store: "Test", timestamp: "Date", value: "Value", winsize: 2000 })
+        };
+        aggrs.ema = store.addStreamAggr({ type: "ema", inAggr: aggrs.tick.name, emaType: "previous", interval: 3000, initWindow: 0 });
+        aggrs.sum = store.addStreamAggr({ type: "winBufSum", inAggr: aggrs.winbuf1.name });
+        aggrs.max = store.addStreamAggr({ type: "winBufMax", inAggr: aggrs.winbuf2.name });
+        aggrs.ma = store.addStreamAggr({ type: "ma", inAggr: aggrs.winbuf2.name });
+        store.setStreamAggrThreads(threads);
+    }
+
+    function push(from, to) {
+        for (var i = from; i < to; i++) {
+            store.push({ Value: (i * 37) % 100, Date: new Date(time + i * 700).toISOString() });
+        }
+    }
+
+    afterEach(function () {
+        base.close();
+    });
+
+    it('should give the same results as serial updates', function () {
+        createBase(1);
+        push(0, 100);
+        var expected = { ema: aggrs.ema.getFloat(), sum: aggrs.sum.getFloat(), max: aggrs.max.getFloat(), ma: aggrs.ma.getFloat() };
+        base.close();
+        createBase(4);
+        push(0, 100);
+        assert.equal(aggrs.sum.getFloat(), expected.sum);
+        assert.equal(aggrs.max.getFloat(), expected.max);
+        assert.equal(aggrs.ma.getFloat(), expected.ma);
+        assert.equal(aggrs.ema.getFloat(), expected.ema);
+    });
+
+    it('should report time spent in aggregates', function () {
+        createBase(2);
+        base.setStreamAggrStats(true);
+        push(0, 10);
+        var stats = store.getStreamAggrStats();
+        assert.equal(stats.length, 7);
+        for (var i = 0; i < stats.length; i++) {
+            assert.equal(stats[i].calls, 10);
+            assert.equal(stats[i].onAddRec.calls, 10);
+            assert(stats[i].totalMSecs >= 0);
+        }
+        assert.throws(function () { store.setStreamAggrThreads(0); });
+    });
+
+    it('should include latency percentiles in base statistics', function () {
+        createBase(1);
+        push(0, 5);
+        assert.equal(base.getStats().streamAggrs, undefined);
+        base.setStreamAggrStats(true);
+        push(5, 105);
+        var stats = base.getStats().streamAggrs;
+        assert.equal(stats.length, 1);
+        assert.equal(stats[0].store, 'Test');
+        assert.equal(stats[0].records, 100);
+        assert.equal(stats[0].aggregates.length, 7);
+        for (var i = 0; i < stats[0].aggregates.length; i++) {
+            var onAddRec = stats[0].aggregates[i].onAddRec;
+            assert.equal(onAddRec.calls, 100);
+            assert(onAddRec.p50MSecs <= onAddRec.p99MSecs);
+            assert(onAddRec.p99MSecs <= onAddRec.maxMSecs);
+        }
+        // disabling keeps the statistics, but stops counting
+        base.setStreamAggrStats(false);
+        push(105, 110);
+        assert.equal(store.getStreamAggrStats()[0].calls, 100);
+    });
+});
+
+describe('Out-of-order record tests', function () {
+    var base = undefined;
+    var time = new Date('2015-06-10T14:13:45.0').getTime();
+    // offsets in seconds, records arrive up to 3 seconds late
+    var offsets = [1, 3, 2, 5, 4, 9, 7, 8, 6, 12, 10, 11, 15, 13, 14];
+
+    beforeEach(function () {
+        base = new qm.Base({
+            mode: "createClean",
+            schema: [
+            { name: "Raw", fields: [{ name: "Value", type: "float" }, { name: "Time", type: "datetime" }] },
+            { name: "Sorted", fields: [{ name: "Value", type: "float" }, { name: "Time", type: "datetime" }] }
+            ]
+        });
+    });
+    afterEach(function () {
+        base.close();
+    });
+
+    it('should include late records in the time series window', function () {
+        var store = base.store('Raw');
+        var winbuf = store.addStreamAggr({ type: "timeSeriesWinBuf", store: "Raw", timestamp: "Time", value: "Value", winsize: 4000 });
+        var sum = store.addStreamAggr({ type: "winBufSum", inAggr: winbuf.name });
+        var max = store.addStreamAggr({ type: "winBufMax", inAggr: winbuf.name });
+        var maxOffset = 0;
+        for (var i = 0; i < offsets.length; i++) {
+            store.push({ Value: offsets[i], Time: new Date(time + offsets[i] * 1000).toISOString() });
+            maxOffset = Math.max(maxOffset, offsets[i]);
+            // window holds records from the last 4 seconds, regardless of arrival order
+            var expected = offsets.slice(0, i + 1).filter(function (offset) { return offset >= maxOffset - 4; });
+            assert.equal(sum.getFloat(), expected.reduce(function (a, b) { return a + b; }, 0));
+            assert.equal(max.getFloat(), maxOffset);
+            assert.equal(winbuf.getFloatVector().length, expected.length);
+        }
+    });
+
+    it('should copy records to the output store in order of time', function () {
+        var reorder = base.store('Raw').addStreamAggr({
+            type: "reorderBuffer", store: "Raw", outStore: "Sorted", timestamp: "Time", allowedLateness: 3000
+        });
+        for (var i = 0; i < offsets.length; i++) {
+            base.store('Raw').push({ Value: offsets[i], Time: new Date(time + offsets[i] * 1000).toISOString() });
+        }
+        // records within 3 seconds of the newest one are still waiting
+        var sorted = base.store('Sorted');
+        assert.equal(sorted.length, 12);
+        for (var i = 0; i < sorted.length; i++) {
+            assert.equal(sorted[i].Value, i + 1);
+        }
+        // too late for the watermark
+        base.store('Raw').push({ Value: 0, Time: new Date(time).toISOString() });
+        var state = reorder.saveJson();
+        assert.equal(state.pending, 3);
+        assert.equal(state.late, 1);
+        assert.equal(sorted.length, 12);
+    });
+
+    it('should load window buffer state saved before late records were supported', function () {
+        var store = base.store('Raw');
+        var winbuf = store.addStreamAggr({ type: "timeSeriesWinBuf", store: "Raw", timestamp: "Time", value: "Value", winsize: 4000 });
+        for (var i = 0; i < 10; i++) {
+            store.push({ Value: i, Time: new Date(time + i * 1000).toISOString() });
+        }
+        var fnm = path.join(os.tmpdir(), 'qm_winbuf_state.bin');
+        var fout = qm.fs.openWrite(fnm);
+        winbuf.save(fout);
+        fout.close();
+        // old layout is the initialization flag, record IDs A, B, C and D and the last
+        // timestamp, without the format marker and the state of late records and cache
+        var state = fs.readFileSync(fnm);
+        assert.equal(state.readInt32LE(0), -1);
+        fs.writeFileSync(fnm, state.slice(4, 4 + 1 + 5 * 8));
+        var loaded = store.addStreamAggr({ type: "timeSeriesWinBuf", store: "Raw", timestamp: "Time", value: "Value", winsize: 4000 });
+        var fin = qm.fs.openRead(fnm);
+        loaded.load(fin);
+        fin.close();
+        fs.unlinkSync(fnm);
+        assert.deepEqual(loaded.getFloatVector().toArray(), winbuf.getFloatVector().toArray());
+        // loaded buffer keeps moving with new records
+        store.push({ Value: 10, Time: new Date(time + 10000).toISOString() });
+        assert.deepEqual(loaded.getFloatVector().toArray(), winbuf.getFloatVector().toArray());
+        assert.deepEqual(loaded.getFloatVector().toArray(), [6, 7, 8, 9, 10]);
+    });
+});
+
+describe('Keyed stream aggregate tests', function () {
+    var base = undefined;
+    var store = undefined;
+    var time = new Date('2015-06-10T14:13:45.0').getTime();
+
+    beforeEach(function () {
+        base = new qm.Base({
+            mode: "createClean",
+            schema: [{
+                name: "Readings",
+                fields: [
+                    { name: "Device", type: "string" },
+                    { name: "Value", type: "float" },
+                    { name: "Time", type: "datetime" }
+                ]
+            }]
+        });
+        store = base.store('Readings');
+    });
+    afterEach(function () {
+        base.close();
+    });
+
+    function push(device, value, offset) {
+        store.push({ Device: device, Value: value, Time: new Date(time + offset).toISOString() });
+    }
+
+    it('should keep a separate window for each key', function () {
+        var ma = store.addStreamAggr({
+            type: 'keyed', store: 'Readings', key: 'Device', timestamp: 'Time', value: 'Value', aggr: 'ma', winsize: 2000
+        });
+        var values = store.addStreamAggr({
+            type: 'keyed', store: 'Readings', key: 'Device', timestamp: 'Time', value: 'Value', aggr: 'winBuf', winsize: 2000
+        });
+        push('a', 1, 0);
+        push('b', 10, 500);
+        push('a', 3, 1000);
+        push('b', 20, 1500);
+        push('a', 5, 3000);
+        assert.deepEqual(ma.getKeys().sort(), ['a', 'b']);
+        // 'a' window moved to its last record, value 1 fell out
+        assert.equal(ma.getKeyFloat('a'), 4);
+        assert.equal(ma.getKeyFloat('b'), 15);
+        assert.deepEqual(values.getKeyFloatVector('a').toArray(), [3, 5]);
+        assert.deepEqual(values.getKeyFloatVector('b').toArray(), [10, 20]);
+        assert.equal(ma.getKeyTimestamp('a'), time + 3000);
+        assert.throws(function () { ma.getKeyFloat('c'); });
+        assert.throws(function () { values.getKeyFloat('a'); });
+    });
+
+    it('should remove idle keys', function () {
+        var sum = store.addStreamAggr({
+            type: 'keyed', store: 'Readings', key: 'Device', timestamp: 'Time', value: 'Value',
+            aggr: 'sum', winsize: 10000, idleTimeout: 5000
+        });
+        push('a', 1, 0);
+        push('b', 2, 1000);
+        push('b', 3, 7000);
+        assert.deepEqual(sum.getKeys(), ['b']);
+        assert.equal(sum.getKeyFloat('b'), 5);
+        // a new record starts a new state
+        push('a', 4, 8000);
+        assert.equal(sum.getKeyFloat('a'), 4);
+        assert.equal(sum.saveJson().keys, 2);
+    });
+
+    it('should throw for missing or unknown parameters', function () {
+        assert.throws(function () {
+            store.addStreamAggr({ type: 'keyed', store: 'Readings', key: 'Device', timestamp: 'Time', value: 'Value', aggr: 'ma' });
+        });
+        assert.throws(function () {
+            store.addStreamAggr({ type: 'keyed', store: 'Readings', key: 'Device', timestamp: 'Time', value: 'Value', aggr: 'median', winsize: 1000 });
+        });
+    });
+});
+
+describe('Stream aggregate snapshot tests', function () {
+    var time = new Date('2015-06-10T14:13:45.0').getTime();
+    var schema = [{
+        name: 'Ticks',
+        fields: [{ name: 'Value', type: 'float' }, { name: 'Time', type: 'datetime' }]
+    }, {
+        name: 'Other',
+        fields: [{ name: 'Value', type: 'float' }, { name: 'Time', type: 'datetime' }]
+    }];
+
+    function addAggrs(base) {
+        base.store('Ticks').addStreamAggr({
+            name: 'window', type: 'timeSeriesWinBuf', store: 'Ticks', timestamp: 'Time', value: 'Value', winsize: 2000
+        });
+        base.store('Ticks').addStreamAggr({ name: 'sum', type: 'winBufSum', inAggr: 'window' });
+        base.store('Other').addStreamAggr({
+            name: 'tick', type: 'timeSeriesTick', store: 'Other', timestamp: 'Time', value: 'Value'
+        });
+    }
+
+    function push(base, storeName, n, offset) {
+        for (var i = 0; i < n; i++) {
+            base.store(storeName).push({ Value: i, Time: new Date(time + offset + i * 300).toISOString() });
+        }
+    }
+
+    // snapshot is a flat folder with an index and one file per aggregate
+    var snapshot = path.join(os.tmpdir(), 'qm_snapshot_' + process.pid);
+    afterEach(function () {
+        if (!fs.existsSync(snapshot)) { return; }
+        fs.readdirSync(snapshot).forEach(function (file) { fs.unlinkSync(path.join(snapshot, file)); });
+        fs.rmdirSync(snapshot);
+    });
+
+    it('should save only changed aggregates and load them after restart', function () {
+        var base = new qm.Base({ mode: 'createClean', schema: schema });
+        addAggrs(base);
+        push(base, 'Ticks', 20, 0);
+        push(base, 'Other', 5, 0);
+        var res = base.saveStreamAggrState(snapshot, ['window', 'sum', 'tick']);
+        assert.deepEqual(res.written.sort(), ['sum', 'tick', 'window']);
+        // nothing changed
+        res = base.saveStreamAggrState(snapshot);
+        assert.equal(res.written.length, 0);
+        assert.equal(res.reused.length, 3);
+        // only aggregates on the 'Ticks' store changed
+        push(base, 'Ticks', 5, 6000);
+        res = base.saveStreamAggrState(snapshot);
+        assert.deepEqual(res.written.sort(), ['sum', 'window']);
+        assert.deepEqual(res.reused, ['tick']);
+        var sum = base.getStreamAggr('sum').getFloat();
+        var window = base.getStreamAggr('window').getFloatVector().toArray();
+        var tick = base.getStreamAggr('tick').getFloat();
+        base.close();
+
+        base = new qm.Base({ mode: 'open' });
+        addAggrs(base);
+        res = base.loadStreamAggrState(snapshot);
+        assert.equal(res.generation, 3);
+        assert.deepEqual(res.loaded.sort(), ['sum', 'tick', 'window']);
+        assert.equal(base.getStreamAggr('sum').getFloat(), sum);
+        assert.deepEqual(base.getStreamAggr('window').getFloatVector().toArray(), window);
+        assert.equal(base.getStreamAggr('tick').getFloat(), tick);
+        // loaded aggregates are not written again
+        res = base.saveStreamAggrState(snapshot);
+        assert.equal(res.written.length, 0);
+        base.close();
+    });
+
+    it('should throw when the snapshot does not exist', function () {
+        var base = new qm.Base({ mode: 'createClean', schema: schema });
+        addAggrs(base);
+        assert.throws(function () { base.loadStreamAggrState(path.join(snapshot, 'missing')); });
+        assert.throws(function () { base.saveStreamAggrState(snapshot, ['missing']); });
+        base.close();
+    });
+});